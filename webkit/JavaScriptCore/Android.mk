@@ -45,6 +45,7 @@ LOCAL_SRC_FILES := \
 	profiler/ProfileGenerator.cpp \
 	profiler/ProfileNode.cpp \
 	profiler/Profiler.cpp \
+	profiler/SamplingProfiler.cpp \
 	\
 	runtime/ArgList.cpp \
 	runtime/Arguments.cpp \
@@ -109,11 +110,14 @@ LOCAL_SRC_FILES := \
 	runtime/ObjectConstructor.cpp \
 	runtime/ObjectPrototype.cpp \
 	runtime/Operations.cpp \
+	runtime/ParallelMarker.cpp \
 	runtime/PropertyDescriptor.cpp \
+	runtime/PropertyLookupCache.cpp \
 	runtime/PropertyNameArray.cpp \
 	runtime/PropertySlot.cpp \
 	runtime/PrototypeFunction.cpp \
 	runtime/RegExp.cpp \
+	runtime/RegExpCache.cpp \
 	runtime/RegExpConstructor.cpp \
 	runtime/RegExpObject.cpp \
 	runtime/RegExpPrototype.cpp \
@@ -139,15 +143,18 @@ LOCAL_SRC_FILES := \
 	wtf/ByteArray.cpp \
 	wtf/CurrentTime.cpp \
 	wtf/DateMath.cpp \
+	wtf/FastDtoa.cpp \
 	wtf/FastMalloc.cpp \
 	wtf/HashTable.cpp \
 	wtf/MainThread.cpp \
 	wtf/RandomNumber.cpp \
 	wtf/RefCountedLeakCounter.cpp \
+	wtf/SlabAllocator.cpp \
 	wtf/TCSystemAlloc.cpp \
 	wtf/ThreadIdentifierDataPthreads.cpp \
 	wtf/Threading.cpp \
 	wtf/ThreadingPthreads.cpp \
+	wtf/ThreadPool.cpp \
 	\
 	wtf/TypeTraits.cpp \
 	wtf/dtoa.cpp \
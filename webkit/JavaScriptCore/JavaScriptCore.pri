@@ -116,6 +116,7 @@ SOURCES += \
     profiler/ProfileGenerator.cpp \
     profiler/ProfileNode.cpp \
     profiler/Profiler.cpp \
+    profiler/SamplingProfiler.cpp \
     runtime/ArgList.cpp \
     runtime/Arguments.cpp \
     runtime/ArrayConstructor.cpp \
@@ -181,12 +182,15 @@ SOURCES += \
     runtime/ObjectConstructor.cpp \
     runtime/ObjectPrototype.cpp \
     runtime/Operations.cpp \
+    runtime/ParallelMarker.cpp \
     runtime/PropertyDescriptor.cpp \
+    runtime/PropertyLookupCache.cpp \
     runtime/PropertyNameArray.cpp \
     runtime/PropertySlot.cpp \
     runtime/PrototypeFunction.cpp \
     runtime/RegExpConstructor.cpp \
     runtime/RegExp.cpp \
+    runtime/RegExpCache.cpp \
     runtime/RegExpObject.cpp \
     runtime/RegExpPrototype.cpp \
     runtime/ScopeChain.cpp \
@@ -204,6 +208,7 @@ SOURCES += \
     wtf/CurrentTime.cpp \
     wtf/DateMath.cpp \
     wtf/dtoa.cpp \
+    wtf/FastDtoa.cpp \
     wtf/FastMalloc.cpp \
     wtf/HashTable.cpp \
     wtf/MainThread.cpp \
@@ -211,8 +216,10 @@ SOURCES += \
     wtf/qt/ThreadingQt.cpp \
     wtf/RandomNumber.cpp \
     wtf/RefCountedLeakCounter.cpp \
+    wtf/SlabAllocator.cpp \
     wtf/ThreadingNone.cpp \
     wtf/Threading.cpp \
+    wtf/ThreadPool.cpp \
     wtf/TypeTraits.cpp \
     wtf/unicode/CollatorDefault.cpp \
     wtf/unicode/icu/CollatorICU.cpp \
@@ -1383,6 +1383,11 @@ public:
         m_formatter.vfpOp(0x0bc0eebd | singleRegisterMask(sd, 28, 6) | doubleRegisterMask(fm, 21, 16));
     }
 
+    void vdiv_F64(FPRegisterID rd, FPRegisterID rn, FPRegisterID rm)
+    {
+        m_formatter.vfpOp(0x0b00ee80 | doubleRegisterMask(rd, 6, 28) | doubleRegisterMask(rn, 23, 0) | doubleRegisterMask(rm, 21, 16));
+    }
+
     void vldr(FPRegisterID rd, RegisterID rn, int32_t imm)
     {
         vmem(rd, rn, imm, true);
@@ -200,6 +200,12 @@ public:
         m_assembler.smull(dest, dataTempRegister, src, dataTempRegister);
     }
 
+    void neg32(RegisterID srcDest)
+    {
+        m_assembler.mov(dataTempRegister, ARMThumbImmediate::makeUInt16(0));
+        m_assembler.sub(srcDest, dataTempRegister, srcDest);
+    }
+
     void not32(RegisterID srcDest)
     {
         m_assembler.mvn(srcDest, srcDest);
@@ -451,7 +457,7 @@ public:
     // generic, or decide that the MacroAssembler cannot practically be used to abstracted these
     // operations, and make clients go directly to the m_assembler to plant truncation instructions.
     // In short, FIXME:.
-    bool supportsFloatingPointTruncate() const { return false; }
+    bool supportsFloatingPointTruncate() const { return true; }
 
     void loadDouble(ImplicitAddress address, FPRegisterID dest)
     {
@@ -468,6 +474,12 @@ public:
         m_assembler.vldr(dest, base, offset);
     }
 
+    void loadDouble(void* address, FPRegisterID dest)
+    {
+        move(ImmPtr(address), addressTempRegister);
+        m_assembler.vldr(dest, addressTempRegister, 0);
+    }
+
     void storeDouble(FPRegisterID src, ImplicitAddress address)
     {
         RegisterID base = address.base;
@@ -516,12 +528,41 @@ public:
         mulDouble(fpTempRegister, dest);
     }
 
+    void divDouble(FPRegisterID src, FPRegisterID dest)
+    {
+        m_assembler.vdiv_F64(dest, dest, src);
+    }
+
+    void divDouble(Address src, FPRegisterID dest)
+    {
+        loadDouble(src, fpTempRegister);
+        divDouble(fpTempRegister, dest);
+    }
+
     void convertInt32ToDouble(RegisterID src, FPRegisterID dest)
     {
         m_assembler.vmov(fpTempRegister, src);
         m_assembler.vcvt_F64_S32(dest, fpTempRegister);
     }
 
+    void convertInt32ToDouble(Address src, FPRegisterID dest)
+    {
+        load32(src, dataTempRegister);
+        convertInt32ToDouble(dataTempRegister, dest);
+    }
+
+    void convertInt32ToDouble(AbsoluteAddress src, FPRegisterID dest)
+    {
+        load32(src.m_ptr, dataTempRegister);
+        convertInt32ToDouble(dataTempRegister, dest);
+    }
+
+    void zeroDouble(FPRegisterID srcDest)
+    {
+        m_assembler.mov(dataTempRegister, ARMThumbImmediate::makeUInt16(0));
+        convertInt32ToDouble(dataTempRegister, srcDest);
+    }
+
     Jump branchDouble(DoubleCondition cond, FPRegisterID left, FPRegisterID right)
     {
         m_assembler.vcmp_F64(left, right);
@@ -546,10 +587,37 @@ public:
         return makeBranch(cond);
     }
 
-    Jump branchTruncateDoubleToInt32(FPRegisterID, RegisterID)
+    // Truncates 'src' to an integer, and places the resulting 'dest'.
+    // vcvt saturates values that are out of range, so branch if the result
+    // is INT_MIN or INT_MAX. NaN converts to 0, which is what ToInt32 wants.
+    Jump branchTruncateDoubleToInt32(FPRegisterID src, RegisterID dest)
     {
-        ASSERT_NOT_REACHED();
-        return jump();
+        m_assembler.vcvt_S32_F64(fpTempRegister, src);
+        m_assembler.vmov(dest, fpTempRegister);
+
+        Jump isIntMin = branch32(Equal, dest, Imm32(0x80000000));
+        Jump notSaturated = branch32(NotEqual, dest, Imm32(0x7fffffff));
+        isIntMin.link(this);
+        Jump result = jump();
+        notSaturated.link(this);
+        return result;
+    }
+
+    // Convert 'src' to an integer, and places the resulting 'dest'.
+    // If the result is not representable as a 32 bit value, branch.
+    // May also branch for some values that are representable in 32 bits
+    // (specifically, in this case, 0).
+    void branchConvertDoubleToInt32(FPRegisterID src, RegisterID dest, JumpList& failureCases, FPRegisterID fpTemp)
+    {
+        m_assembler.vcvt_S32_F64(fpTempRegister, src);
+        m_assembler.vmov(dest, fpTempRegister);
+
+        // Convert the integer result back to double & compare to the original value - if not equal or unordered (NaN) then jump.
+        m_assembler.vcvt_F64_S32(fpTemp, fpTempRegister);
+        failureCases.append(branchDouble(DoubleNotEqualOrUnordered, src, fpTemp));
+
+        // If the result is zero, it might have been -0.0, and 0.0 equals to -0.0
+        failureCases.append(branchTest32(Zero, dest));
     }
 
 
@@ -865,6 +933,14 @@ public:
         return branch32(NotEqual, addressTempRegister, dataTempRegister);
     }
 
+    Jump branchOr32(Condition cond, RegisterID src, RegisterID dest)
+    {
+        ASSERT((cond == Signed) || (cond == Zero) || (cond == NonZero));
+        or32(src, dest);
+        compare32(dest, Imm32(0));
+        return Jump(makeBranch(cond));
+    }
+
     Jump branchSub32(Condition cond, RegisterID src, RegisterID dest)
     {
         ASSERT((cond == Overflow) || (cond == Signed) || (cond == Zero) || (cond == NonZero));
@@ -937,6 +1013,23 @@ public:
         m_assembler.mov(dest, ARMThumbImmediate::makeUInt16(0));
     }
 
+    // Thumb-2 has no byte registers, so these compare the whole word.
+    void set8(Condition cond, RegisterID left, RegisterID right, RegisterID dest)
+    {
+        set32(cond, left, right, dest);
+    }
+
+    void set8(Condition cond, Address left, RegisterID right, RegisterID dest)
+    {
+        load32(left, dataTempRegister);
+        set32(cond, dataTempRegister, right, dest);
+    }
+
+    void set8(Condition cond, RegisterID left, Imm32 right, RegisterID dest)
+    {
+        set32(cond, left, right, dest);
+    }
+
     // FIXME:
     // The mask should be optional... paerhaps the argument order should be
     // dest-src, operations always have a dest? ... possibly not true, considering
@@ -950,6 +1043,11 @@ public:
         m_assembler.mov(dest, ARMThumbImmediate::makeUInt16(0));
     }
 
+    void setTest8(Condition cond, Address address, Imm32 mask, RegisterID dest)
+    {
+        setTest32(cond, address, mask, dest);
+    }
+
 
     DataLabel32 moveWithPatch(Imm32 imm, RegisterID dst)
     {
@@ -145,6 +145,13 @@ namespace JSC {
         Structure* structure;
         unsigned offset;
         unsigned bytecodeOffset;
+        // The Structure check and property load in the JIT code, which are
+        // patched to match structure and offset.
+        CodeLocationDataLabelPtr structureLabel;
+        CodeLocationDataLabel32 offsetLabel;
+#if USE(JSVALUE32_64)
+        CodeLocationDataLabel32 tagOffsetLabel;
+#endif
     };
 
     // This structure is used to map from a call return location
@@ -369,6 +376,7 @@ namespace JSC {
 
         void addGlobalResolveInfo(unsigned globalResolveInstruction) { m_globalResolveInfos.append(GlobalResolveInfo(globalResolveInstruction)); }
         GlobalResolveInfo& globalResolveInfo(int index) { return m_globalResolveInfos[index]; }
+        size_t numberOfGlobalResolveInfos() const { return m_globalResolveInfos.size(); }
         bool hasGlobalResolveInfoAtBytecodeOffset(unsigned bytecodeOffset);
 
         size_t numberOfCallLinkInfos() const { return m_callLinkInfos.size(); }
@@ -8,7 +8,7 @@
 #include "Structure.h"
 #include <wtf/VectorTraits.h>
 
-#define POLYMORPHIC_LIST_CACHE_SIZE 8
+#define POLYMORPHIC_LIST_CACHE_SIZE 16
 
 namespace JSC {
 
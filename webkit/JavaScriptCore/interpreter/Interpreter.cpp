@@ -1020,6 +1020,11 @@ NEVER_INLINE void Interpreter::tryCacheGetByID(CallFrame* callFrame, CodeBlock*
         JSObject* baseObject = asObject(slot.slotBase());
         size_t offset = slot.cachedOffset();
 
+        if (baseObject->structure()->isThrashingDictionary()) {
+            vPC[0] = getOpcode(op_get_by_id_generic);
+            return;
+        }
+
         // Since we're accessing a prototype in a loop, it's a good bet that it
         // should not be treated as a dictionary.
         if (baseObject->structure()->isDictionary()) {
@@ -3,8 +3,15 @@
 #include "config.h"
 #include "RegisterFile.h"
 
+#include <algorithm>
+#include <wtf/CurrentTime.h>
+
+using std::max;
+
 namespace JSC {
 
+const double RegisterFile::excessCapacityReleaseInterval = 1.0;
+
 RegisterFile::~RegisterFile()
 {
 #if HAVE(MMAP)
@@ -19,15 +26,44 @@ RegisterFile::~RegisterFile()
 #endif
 }
 
+void RegisterFile::releaseExcessCapacityIfIdle()
+{
+    // m_maxUsed stays put, so an unwind after the interval still releases
+    // what this spike touched.
+    if (currentTime() - m_lastRelease < excessCapacityReleaseInterval)
+        return;
+    releaseExcessCapacity();
+}
+
 void RegisterFile::releaseExcessCapacity()
 {
-#if HAVE(MMAP) && HAVE(MADV_FREE) && !HAVE(VIRTUALALLOC)
-    while (madvise(m_start, (m_max - m_start) * sizeof(Register), MADV_FREE) == -1 && errno == EAGAIN) { }
+    // Keep enough committed for ordinary scripts, rounded to whole commit
+    // chunks so that the released range starts on a page boundary.
+    Register* keep = max(m_end, m_start + maxExcessCapacity);
+    size_t keepSize = roundUpAllocationSize(reinterpret_cast<char*>(keep) - reinterpret_cast<char*>(m_buffer), commitSize);
+    char* releaseStart = reinterpret_cast<char*>(m_buffer) + keepSize;
+    m_lastRelease = currentTime();
+
+#if HAVE(MMAP) && (HAVE(MADV_FREE) || HAVE(MADV_DONTNEED)) && !HAVE(VIRTUALALLOC)
+    char* releaseEnd = reinterpret_cast<char*>(m_maxUsed);
+    if (releaseStart < releaseEnd) {
+#if HAVE(MADV_FREE)
+        while (madvise(releaseStart, releaseEnd - releaseStart, MADV_FREE) == -1 && errno == EAGAIN) { }
+#else
+        // The register file is private anonymous memory, so the pages read
+        // back as zero on the next fault, which is all a fresh one would be.
+        while (madvise(releaseStart, releaseEnd - releaseStart, MADV_DONTNEED) == -1 && errno == EAGAIN) { }
+#endif
+    }
 #elif HAVE(VIRTUALALLOC)
-    VirtualFree(m_start, (m_max - m_start) * sizeof(Register), MEM_DECOMMIT);
-    m_commitEnd = m_start;
+    char* commitEnd = reinterpret_cast<char*>(m_commitEnd);
+    if (releaseStart < commitEnd) {
+        VirtualFree(releaseStart, commitEnd - releaseStart, MEM_DECOMMIT);
+        m_commitEnd = reinterpret_cast<Register*>(releaseStart);
+    }
 #endif
-    m_maxUsed = m_start;
+    if (m_maxUsed > keep)
+        m_maxUsed = keep;
 }
 
 } // namespace JSC
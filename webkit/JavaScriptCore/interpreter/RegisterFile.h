@@ -44,6 +44,10 @@ namespace JSC {
         static const size_t commitSize = 1 << 14;
         // Allow 8k of excess registers before we start trying to reap the registerfile
         static const ptrdiff_t maxExcessCapacity = 8 * 1024;
+        // Seconds to wait after releasing capacity before doing so again when
+        // the stack unwinds, so that a script that keeps recursing deeply
+        // doesn't fault the same pages back in over and over.
+        static const double excessCapacityReleaseInterval;
 
         RegisterFile(size_t capacity = defaultCapacity, size_t maxGlobals = defaultMaxGlobals);
         ~RegisterFile();
@@ -67,15 +71,23 @@ namespace JSC {
         void markGlobals(MarkStack& markStack, Heap* heap) { heap->markConservatively(markStack, lastGlobal(), m_start); }
         void markCallFrames(MarkStack& markStack, Heap* heap) { heap->markConservatively(markStack, m_start, m_end); }
 
-    private:
+        // Gives back the pages above the first maxExcessCapacity registers
+        // (or above the live frames, if deeper) that have been touched since
+        // the last release.
         void releaseExcessCapacity();
+
+    private:
+        void releaseExcessCapacityIfIdle();
+
         size_t m_numGlobals;
         const size_t m_maxGlobals;
         Register* m_start;
         Register* m_end;
         Register* m_max;
         Register* m_buffer;
+        // high-water mark since capacity was last released
         Register* m_maxUsed;
+        double m_lastRelease;
 
 #if HAVE(VIRTUALALLOC)
         Register* m_commitEnd;
@@ -94,6 +106,7 @@ namespace JSC {
         , m_end(0)
         , m_max(0)
         , m_buffer(0)
+        , m_lastRelease(0)
         , m_globalObject(0)
     {
         // Verify that our values will play nice with mmap and VirtualAlloc.
@@ -155,7 +168,7 @@ namespace JSC {
             return;
         m_end = newEnd;
         if (m_end == m_start && (m_maxUsed - m_start) > maxExcessCapacity)
-            releaseExcessCapacity();
+            releaseExcessCapacityIfIdle();
     }
 
     inline bool RegisterFile::grow(Register* newEnd)
@@ -6,11 +6,14 @@
 
 #include <errno.h>
 
-#if ENABLE(ASSEMBLER) && OS(DARWIN) && CPU(X86_64)
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
 
 #include "TCSpinLock.h"
+#include <algorithm>
+#if OS(DARWIN)
 #include <mach/mach_init.h>
 #include <mach/vm_map.h>
+#endif
 #include <sys/mman.h>
 #include <unistd.h>
 #include <wtf/AVLTree.h>
@@ -23,6 +26,15 @@ namespace JSC {
 #define TWO_GB (2u * 1024u * 1024u * 1024u)
 #define SIXTEEN_MB (16u * 1024u * 1024u)
 
+#if CPU(X86_64)
+// All JIT code has to be within reach of a 32-bit relative call.
+#define FIXED_VM_POOL_SIZE TWO_GB
+#else
+// Only address space is reserved; pages are committed as code is written
+// to them. Code that doesn't fit goes into separate mappings.
+#define FIXED_VM_POOL_SIZE SIXTEEN_MB
+#endif
+
 // FreeListEntry describes a free chunk of memory, stored in the freeList.
 struct FreeListEntry {
     FreeListEntry(void* pointer, size_t size)
@@ -257,8 +269,10 @@ public:
     FixedVMPoolAllocator(size_t commonSize, size_t totalHeapSize)
         : m_commonSize(commonSize)
         , m_countFreedSinceLastCoalesce(0)
+        , m_coalesceLimit(std::min<size_t>(SIXTEEN_MB, totalHeapSize / 16))
         , m_totalHeapSize(totalHeapSize)
     {
+#if OS(DARWIN)
         // Cook up an address to allocate at, using the following recipe:
         //   17 bits of zero, stay in userspace kids.
         //   26 bits of randomness for ASLR.
@@ -271,8 +285,11 @@ public:
         intptr_t randomLocation = arc4random() & ((1 << 25) - 1);
         randomLocation += (1 << 24);
         randomLocation <<= 21;
+#else
+        intptr_t randomLocation = 0;
+#endif
         m_base = mmap(reinterpret_cast<void*>(randomLocation), m_totalHeapSize, INITIAL_PROTECTION_FLAGS, MAP_PRIVATE | MAP_ANON, VM_TAG_FOR_EXECUTABLEALLOCATOR_MEMORY, 0);
-        if (!m_base)
+        if (m_base == MAP_FAILED)
             CRASH();
 
         // For simplicity, we keep all memory in m_freeList in a 'released' state.
@@ -284,6 +301,7 @@ public:
         m_freeList.insert(new FreeListEntry(m_base, m_totalHeapSize));
     }
 
+    // Returns 0 if no free chunk is large enough.
     void* alloc(size_t size)
     {
         void* result;
@@ -304,9 +322,9 @@ public:
                 coalesceFreeSpace();
                 // Did that free up a large enough chunk?
                 entry = m_freeList.search(size, m_freeList.GREATER_EQUAL);
-                // No?...  *BOOM!*
+                // No?...  Leave it to the caller.
                 if (!entry)
-                    CRASH();
+                    return 0;
             }
             ASSERT(entry->size != m_commonSize);
 
@@ -361,23 +379,21 @@ public:
             addToFreeList(new FreeListEntry(pointer, size));
 
         // Do some housekeeping.  Every time we reach a point that
-        // 16MB of allocations have been freed, sweep m_freeList
+        // m_coalesceLimit of allocations have been freed, sweep m_freeList
         // coalescing any neighboring fragments.
         m_countFreedSinceLastCoalesce += size;
-        if (m_countFreedSinceLastCoalesce >= SIXTEEN_MB) {
+        if (m_countFreedSinceLastCoalesce >= m_coalesceLimit) {
             m_countFreedSinceLastCoalesce = 0;
             coalesceFreeSpace();
         }
     }
 
-private:
-
-#ifndef NDEBUG
     bool isWithinVMPool(void* pointer, size_t size)
     {
         return pointer >= m_base && (reinterpret_cast<char*>(pointer) + size <= reinterpret_cast<char*>(m_base) + m_totalHeapSize);
     }
-#endif
+
+private:
 
     // Freed space from the most common sized allocations will be held in this list, ...
     const size_t m_commonSize;
@@ -388,6 +404,7 @@ private:
 
     // This is used for housekeeping, to trigger defragmentation of the freed lists.
     size_t m_countFreedSinceLastCoalesce;
+    const size_t m_coalesceLimit;
 
     void* m_base;
     size_t m_totalHeapSize;
@@ -406,8 +423,18 @@ ExecutablePool::Allocation ExecutablePool::systemAlloc(size_t size)
   SpinLockHolder lock_holder(&spinlock);
 
     if (!allocator)
-        allocator = new FixedVMPoolAllocator(JIT_ALLOCATOR_LARGE_ALLOC_SIZE, TWO_GB);
-    ExecutablePool::Allocation alloc = {reinterpret_cast<char*>(allocator->alloc(size)), size};
+        allocator = new FixedVMPoolAllocator(JIT_ALLOCATOR_LARGE_ALLOC_SIZE, FIXED_VM_POOL_SIZE);
+    void* pages = allocator->alloc(size);
+#if !CPU(X86_64)
+    if (!pages) {
+        pages = mmap(0, size, INITIAL_PROTECTION_FLAGS, MAP_PRIVATE | MAP_ANON, VM_TAG_FOR_EXECUTABLEALLOCATOR_MEMORY, 0);
+        if (pages == MAP_FAILED)
+            pages = 0;
+    }
+#endif
+    if (!pages)
+        CRASH();
+    ExecutablePool::Allocation alloc = {reinterpret_cast<char*>(pages), size};
     return alloc;
 }
 
@@ -416,6 +443,11 @@ void ExecutablePool::systemRelease(const ExecutablePool::Allocation& allocation)
   SpinLockHolder lock_holder(&spinlock);
 
     ASSERT(allocator);
+    if (!allocator->isWithinVMPool(allocation.pages, allocation.size)) {
+        int result = munmap(allocation.pages, allocation.size);
+        ASSERT_UNUSED(result, !result);
+        return;
+    }
     allocator->free(allocation.pages, allocation.size);
 }
 
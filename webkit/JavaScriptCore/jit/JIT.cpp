@@ -171,9 +171,6 @@ void JIT::privateCompileMainPass()
 
         switch (m_interpreter->getOpcodeID(currentInstruction->u.opcode)) {
         DEFINE_BINARY_OP(op_del_by_val)
-#if USE(JSVALUE32)
-        DEFINE_BINARY_OP(op_div)
-#endif
         DEFINE_BINARY_OP(op_in)
         DEFINE_BINARY_OP(op_less)
         DEFINE_BINARY_OP(op_lesseq)
@@ -205,9 +202,7 @@ void JIT::privateCompileMainPass()
         DEFINE_OP(op_create_arguments)
         DEFINE_OP(op_debug)
         DEFINE_OP(op_del_by_id)
-#if !USE(JSVALUE32)
         DEFINE_OP(op_div)
-#endif
         DEFINE_OP(op_end)
         DEFINE_OP(op_enter)
         DEFINE_OP(op_enter_with_activation)
@@ -358,9 +353,7 @@ void JIT::privateCompileSlowCases()
         DEFINE_SLOWCASE_OP(op_construct)
         DEFINE_SLOWCASE_OP(op_construct_verify)
         DEFINE_SLOWCASE_OP(op_convert_this)
-#if !USE(JSVALUE32)
         DEFINE_SLOWCASE_OP(op_div)
-#endif
         DEFINE_SLOWCASE_OP(op_eq)
         DEFINE_SLOWCASE_OP(op_get_by_id)
         DEFINE_SLOWCASE_OP(op_get_by_val)
@@ -526,6 +519,16 @@ JITCode JIT::privateCompile()
         info.hotPathOther = patchBuffer.locationOfNearCall(m_callStructureStubCompilationInfo[i].hotPathOther);
     }
 #endif
+    ASSERT(m_globalResolveCompilationInfo.size() == m_codeBlock->numberOfGlobalResolveInfos());
+    for (unsigned i = 0; i < m_globalResolveCompilationInfo.size(); ++i) {
+        GlobalResolveInfo& info = m_codeBlock->globalResolveInfo(i);
+        info.structureLabel = patchBuffer.locationOf(m_globalResolveCompilationInfo[i].structureToCompare);
+        info.offsetLabel = patchBuffer.locationOf(m_globalResolveCompilationInfo[i].offset);
+#if USE(JSVALUE32_64)
+        info.tagOffsetLabel = patchBuffer.locationOf(m_globalResolveCompilationInfo[i].tagOffset);
+#endif
+    }
+
     unsigned methodCallCount = m_methodCallCompilationInfo.size();
     m_codeBlock->addMethodCallLinkInfos(methodCallCount);
     for (unsigned i = 0; i < methodCallCount; ++i) {
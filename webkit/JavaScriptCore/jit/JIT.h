@@ -134,6 +134,14 @@ namespace JSC {
         MacroAssembler::Call callReturnLocation;
     };
 
+    struct GlobalResolveCompilationInfo {
+        MacroAssembler::DataLabelPtr structureToCompare;
+        MacroAssembler::DataLabel32 offset;
+#if USE(JSVALUE32_64)
+        MacroAssembler::DataLabel32 tagOffset;
+#endif
+    };
+
     struct MethodCallCompilationInfo {
         MethodCallCompilationInfo(unsigned propertyAccessIndex)
             : propertyAccessIndex(propertyAccessIndex)
@@ -303,6 +311,7 @@ namespace JSC {
         static void patchGetByIdSelf(CodeBlock* codeblock, StructureStubInfo*, Structure*, size_t cachedOffset, ReturnAddressPtr returnAddress);
         static void patchPutByIdReplace(CodeBlock* codeblock, StructureStubInfo*, Structure*, size_t cachedOffset, ReturnAddressPtr returnAddress);
         static void patchMethodCallProto(CodeBlock* codeblock, MethodCallLinkInfo&, JSFunction*, Structure*, JSObject*, ReturnAddressPtr);
+        static void patchResolveGlobal(CodeBlock* codeblock, GlobalResolveInfo&);
 
         static void compilePatchGetArrayLength(JSGlobalData* globalData, CodeBlock* codeBlock, ReturnAddressPtr returnAddress)
         {
@@ -483,6 +492,31 @@ namespace JSC {
         // sequencePutById
         static const int sequencePutByIdInstructionSpace = 36;
         static const int sequencePutByIdConstantSpace = 4;
+#elif CPU(ARM_THUMB2)
+        // These architecture specific value are used to enable patching - see comment on op_put_by_id.
+        static const int patchOffsetPutByIdStructure = 10;
+        static const int patchOffsetPutByIdExternalLoad = 26;
+        static const int patchLengthPutByIdExternalLoad = 12;
+        static const int patchOffsetPutByIdPropertyMapOffset1 = 46;
+        static const int patchOffsetPutByIdPropertyMapOffset2 = 58;
+        // These architecture specific value are used to enable patching - see comment on op_get_by_id.
+        static const int patchOffsetGetByIdStructure = 10;
+        static const int patchOffsetGetByIdBranchToSlowCase = 26;
+        static const int patchOffsetGetByIdExternalLoad = 26;
+        static const int patchLengthGetByIdExternalLoad = 12;
+        static const int patchOffsetGetByIdPropertyMapOffset1 = 46;
+        static const int patchOffsetGetByIdPropertyMapOffset2 = 58;
+        static const int patchOffsetGetByIdPutResult = 62;
+#if ENABLE(OPCODE_SAMPLING)
+        #error "OPCODE_SAMPLING is not yet supported"
+#else
+        static const int patchOffsetGetByIdSlowCaseCall = 30;
+#endif
+        static const int patchOffsetOpCallCompareToJump = 16;
+
+        static const int patchOffsetMethodCheckProtoObj = 24;
+        static const int patchOffsetMethodCheckProtoStruct = 34;
+        static const int patchOffsetMethodCheckPutFunction = 58;
 #else
 #error "JSVALUE32_64 not supported on this platform."
 #endif
@@ -540,6 +574,7 @@ namespace JSC {
         void compileBinaryArithOpSlowCase(OpcodeID, Vector<SlowCaseEntry>::iterator&, unsigned dst, unsigned src1, unsigned src2, OperandTypes, bool op1HasImmediateIntFastCase, bool op2HasImmediateIntFastCase);
 #else
         void compileBinaryArithOpSlowCase(OpcodeID, Vector<SlowCaseEntry>::iterator&, unsigned dst, unsigned src1, unsigned src2, OperandTypes);
+        void emitLoadNumberAsDouble(RegisterID src, unsigned virtualRegisterIndex, ResultType, FPRegisterID dest);
 #endif
 
 #if ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
@@ -550,6 +585,9 @@ namespace JSC {
         void compileGetDirectOffset(JSObject* base, RegisterID temp, RegisterID result, size_t cachedOffset);
         void compileGetDirectOffset(RegisterID base, RegisterID result, RegisterID structure, RegisterID offset, RegisterID scratch);
         void compilePutDirectOffset(RegisterID base, RegisterID value, Structure* structure, size_t cachedOffset);
+#if ENABLE(JSC_GENERATIONAL_GC)
+        void emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2);
+#endif
 
 #if CPU(X86_64)
         // These architecture specific value are used to enable patching - see comment on op_put_by_id.
@@ -905,6 +943,7 @@ namespace JSC {
         Vector<PropertyStubCompilationInfo> m_propertyAccessCompilationInfo;
         Vector<StructureStubCompilationInfo> m_callStructureStubCompilationInfo;
         Vector<MethodCallCompilationInfo> m_methodCallCompilationInfo;
+        Vector<GlobalResolveCompilationInfo> m_globalResolveCompilationInfo;
         Vector<JumpTable> m_jmpTable;
 
         unsigned m_bytecodeIndex;
@@ -2775,6 +2775,97 @@ void JIT::emitSlow_op_sub(Instruction* currentInstruction, Vector<SlowCaseEntry>
     compileBinaryArithOpSlowCase(op_sub, iter, currentInstruction[1].u.operand, currentInstruction[2].u.operand, currentInstruction[3].u.operand, OperandTypes::fromInt(currentInstruction[4].u.operand));
 }
 
+// Loads the immediate integer or JSNumberCell in 'src' as a double, leaving
+// 'src' untouched in case the cell is reused for the result.
+void JIT::emitLoadNumberAsDouble(RegisterID src, unsigned virtualRegisterIndex, ResultType type, FPRegisterID dest)
+{
+    Jump isImmediate = emitJumpIfImmediateInteger(src);
+    if (!type.definitelyIsNumber()) {
+        emitJumpSlowCaseIfNotJSCell(src, virtualRegisterIndex);
+        addSlowCase(checkStructure(src, m_globalData->numberStructure.get()));
+    }
+    loadDouble(Address(src, OBJECT_OFFSETOF(JSNumberCell, m_value)), dest);
+    Jump loaded = jump();
+    isImmediate.link(this);
+    move(src, regT2);
+    emitFastArithImmToInt(regT2);
+    convertInt32ToDouble(regT2, dest);
+    loaded.link(this);
+}
+
+void JIT::emit_op_div(Instruction* currentInstruction)
+{
+    unsigned dst = currentInstruction[1].u.operand;
+    unsigned op1 = currentInstruction[2].u.operand;
+    unsigned op2 = currentInstruction[3].u.operand;
+    OperandTypes types = OperandTypes::fromInt(currentInstruction[4].u.operand);
+
+    if (!supportsFloatingPoint() || !types.first().mightBeNumber() || !types.second().mightBeNumber()) {
+        JITStubCall stubCall(this, cti_op_div);
+        stubCall.addArgument(op1, regT2);
+        stubCall.addArgument(op2, regT2);
+        stubCall.call(dst);
+        return;
+    }
+
+    emitGetVirtualRegisters(op1, regT0, op2, regT1);
+    emitLoadNumberAsDouble(regT0, op1, types.first(), fpRegT0);
+    emitLoadNumberAsDouble(regT1, op2, types.second(), fpRegT1);
+    divDouble(fpRegT1, fpRegT0);
+
+    // Results that fit an immediate integer need no allocation.
+    JumpList notImmediate;
+    branchConvertDoubleToInt32(fpRegT0, regT2, notImmediate, fpRegT1);
+    notImmediate.append(branchAdd32(Overflow, regT2, regT2));
+    emitFastArithReTagImmediate(regT2, regT0);
+    emitPutVirtualRegister(dst);
+    Jump done = jump();
+
+    // Otherwise store into a reusable operand's cell, or box it in the stub.
+    notImmediate.link(this);
+    if (types.second().isReusable()) {
+        addSlowCase(emitJumpIfNotJSCell(regT1));
+        storeDouble(fpRegT0, Address(regT1, OBJECT_OFFSETOF(JSNumberCell, m_value)));
+        move(regT1, regT0);
+        emitPutVirtualRegister(dst);
+    } else if (types.first().isReusable()) {
+        addSlowCase(emitJumpIfNotJSCell(regT0));
+        storeDouble(fpRegT0, Address(regT0, OBJECT_OFFSETOF(JSNumberCell, m_value)));
+        emitPutVirtualRegister(dst);
+    } else
+        addSlowCase(jump());
+
+    done.link(this);
+}
+
+void JIT::emitSlow_op_div(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    unsigned dst = currentInstruction[1].u.operand;
+    unsigned op1 = currentInstruction[2].u.operand;
+    unsigned op2 = currentInstruction[3].u.operand;
+    OperandTypes types = OperandTypes::fromInt(currentInstruction[4].u.operand);
+
+    if (!supportsFloatingPoint() || !types.first().mightBeNumber() || !types.second().mightBeNumber())
+        return;
+
+    if (!types.first().definitelyIsNumber()) {
+        linkSlowCaseIfNotJSCell(iter, op1);
+        linkSlowCase(iter);
+    }
+    if (!types.second().definitelyIsNumber()) {
+        linkSlowCaseIfNotJSCell(iter, op2);
+        linkSlowCase(iter);
+    }
+    linkSlowCase(iter);
+
+    // The operands are still in their virtual registers; nothing above has
+    // overwritten them.
+    JITStubCall stubCall(this, cti_op_div);
+    stubCall.addArgument(op1, regT2);
+    stubCall.addArgument(op2, regT2);
+    stubCall.call(dst);
+}
+
 #endif // USE(JSVALUE64)
 
 /* ------------------------------ END: OP_ADD, OP_SUB, OP_MUL ------------------------------ */
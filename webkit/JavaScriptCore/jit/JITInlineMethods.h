@@ -697,6 +697,22 @@ ALWAYS_INLINE void JIT::emitJumpSlowCaseIfNotJSCell(RegisterID reg, int vReg)
         emitJumpSlowCaseIfNotJSCell(reg);
 }
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+// Dirties the card holding owner; see Heap::writeBarrier.
+ALWAYS_INLINE void JIT::emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2)
+{
+    // scratch2 = card index * sizeof(uint32_t)
+    move(owner, scratch2);
+    andPtr(Imm32(BLOCK_OFFSET_MASK & ~(CARD_SIZE - 1)), scratch2);
+    rshift32(Imm32(CARD_SHIFT - 2), scratch2);
+
+    move(owner, scratch1);
+    andPtr(Imm32(static_cast<int32_t>(BLOCK_MASK)), scratch1);
+    addPtr(scratch2, scratch1);
+    store32(Imm32(1), Address(scratch1, OBJECT_OFFSETOF(CollectorBlock, cards)));
+}
+#endif
+
 #if USE(JSVALUE64)
 ALWAYS_INLINE JIT::Jump JIT::emitJumpIfImmediateNumber(RegisterID reg)
 {
@@ -12,6 +12,7 @@
 #include "JSFunction.h"
 #include "JSPropertyNameIterator.h"
 #include "LinkBuffer.h"
+#include "RepatchBuffer.h"
 
 namespace JSC {
 
@@ -118,7 +119,7 @@ void JIT::privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executable
     loadPtr(Address(regT2, OBJECT_OFFSETOF(FunctionExecutable, m_jitCode)), regT0);
     jump(regT0);
 
-#if CPU(X86) || CPU(ARM_TRADITIONAL)
+#if CPU(X86) || CPU(ARM)
     Label nativeCallThunk = align();
     preserveReturnAddressAfterCall(regT0);
     emitPutToCallFrameHeader(regT0, RegisterFile::ReturnPC); // Push return address
@@ -229,7 +230,7 @@ void JIT::privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executable
     // so pull them off now
     addPtr(Imm32(NativeCallFrameSize - sizeof(NativeFunctionCalleeSignature)), stackPointerRegister);
 
-#elif CPU(ARM_TRADITIONAL)
+#elif CPU(ARM)
     emitGetFromCallFrameHeader32(RegisterFile::ArgumentCount, regT0);
 
     // Allocate stack space for our arglist
@@ -658,25 +659,22 @@ void JIT::emit_op_resolve_skip(Instruction* currentInstruction)
 
 void JIT::emit_op_resolve_global(Instruction* currentInstruction)
 {
-    // FIXME: Optimize to use patching instead of so many memory accesses.
-
     unsigned dst = currentInstruction[1].u.operand;
     void* globalObject = currentInstruction[2].u.jsCell;
-    
-    unsigned currentIndex = m_globalResolveInfoIndex++;
-    void* structureAddress = &(m_codeBlock->globalResolveInfo(currentIndex).structure);
-    void* offsetAddr = &(m_codeBlock->globalResolveInfo(currentIndex).offset);
 
-    // Verify structure.
+    m_globalResolveInfoIndex++;
+    GlobalResolveCompilationInfo info;
+
+    // Verify structure. cti_op_resolve_global patches in the Structure and
+    // offset it caches.
     move(ImmPtr(globalObject), regT0);
-    loadPtr(structureAddress, regT1);
-    addSlowCase(branchPtr(NotEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure))));
+    addSlowCase(branchPtrWithPatch(NotEqual, Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)), info.structureToCompare, ImmPtr(reinterpret_cast<void*>(patchGetByIdDefaultStructure))));
 
     // Load property.
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSGlobalObject, m_externalStorage)), regT2);
-    load32(offsetAddr, regT3);
-    load32(BaseIndex(regT2, regT3, TimesEight), regT0); // payload
-    load32(BaseIndex(regT2, regT3, TimesEight, 4), regT1); // tag
+    info.offset = load32WithAddressOffsetPatch(Address(regT2, patchGetByIdDefaultOffset), regT0); // payload
+    info.tagOffset = load32WithAddressOffsetPatch(Address(regT2, patchGetByIdDefaultOffset), regT1); // tag
+    m_globalResolveCompilationInfo.append(info);
     emitStore(dst, regT1, regT0);
     map(m_bytecodeIndex + OPCODE_LENGTH(op_resolve_global), dst, regT1, regT0);
 }
@@ -697,6 +695,16 @@ void JIT::emitSlow_op_resolve_global(Instruction* currentInstruction, Vector<Slo
     stubCall.call(dst);
 }
 
+void JIT::patchResolveGlobal(CodeBlock* codeBlock, GlobalResolveInfo& globalResolveInfo)
+{
+    RepatchBuffer repatchBuffer(codeBlock);
+
+    int offset = sizeof(JSValue) * globalResolveInfo.offset;
+    repatchBuffer.repatch(globalResolveInfo.structureLabel, globalResolveInfo.structure);
+    repatchBuffer.repatch(globalResolveInfo.offsetLabel, offset); // payload
+    repatchBuffer.repatch(globalResolveInfo.tagOffsetLabel, offset + 4); // tag
+}
+
 void JIT::emit_op_not(Instruction* currentInstruction)
 {
     unsigned dst = currentInstruction[1].u.operand;
@@ -1979,18 +1987,23 @@ void JIT::emit_op_construct(Instruction* currentInstruction)
 
 void JIT::emit_op_get_global_var(Instruction* currentInstruction)
 {
-    JSVariableObject* globalObject = static_cast<JSVariableObject*>(currentInstruction[2].u.jsCell);
-    move(ImmPtr(globalObject), regT0);
-    emitGetVariableObjectRegister(regT0, currentInstruction[3].u.operand, regT0);
+    JSGlobalObject* globalObject = static_cast<JSGlobalObject*>(currentInstruction[2].u.jsCell);
+    ASSERT(globalObject->isGlobalObject());
+
+    // The global object's data never moves, so load its registers pointer directly.
+    loadPtr(&globalObject->d()->registers, regT0);
+    loadPtr(Address(regT0, currentInstruction[3].u.operand * sizeof(Register)), regT0);
     emitPutVirtualRegister(currentInstruction[1].u.operand);
 }
 
 void JIT::emit_op_put_global_var(Instruction* currentInstruction)
 {
     emitGetVirtualRegister(currentInstruction[3].u.operand, regT1);
-    JSVariableObject* globalObject = static_cast<JSVariableObject*>(currentInstruction[1].u.jsCell);
-    move(ImmPtr(globalObject), regT0);
-    emitPutVariableObjectRegister(regT1, regT0, currentInstruction[2].u.operand);
+    JSGlobalObject* globalObject = static_cast<JSGlobalObject*>(currentInstruction[1].u.jsCell);
+    ASSERT(globalObject->isGlobalObject());
+
+    loadPtr(&globalObject->d()->registers, regT0);
+    storePtr(regT1, Address(regT0, currentInstruction[2].u.operand * sizeof(Register)));
 }
 
 void JIT::emit_op_get_scoped_var(Instruction* currentInstruction)
@@ -2126,19 +2139,18 @@ void JIT::emit_op_resolve_global(Instruction* currentInstruction)
     Identifier* ident = &m_codeBlock->identifier(currentInstruction[3].u.operand);
     
     unsigned currentIndex = m_globalResolveInfoIndex++;
-    void* structureAddress = &(m_codeBlock->globalResolveInfo(currentIndex).structure);
-    void* offsetAddr = &(m_codeBlock->globalResolveInfo(currentIndex).offset);
+    GlobalResolveCompilationInfo info;
 
-    // Check Structure of global object
+    // Check Structure of global object. cti_op_resolve_global patches in the
+    // Structure and offset it caches.
     move(ImmPtr(globalObject), regT0);
-    loadPtr(structureAddress, regT1);
-    Jump noMatch = branchPtr(NotEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure))); // Structures don't match
+    Jump noMatch = branchPtrWithPatch(NotEqual, Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)), info.structureToCompare, ImmPtr(reinterpret_cast<void*>(patchGetByIdDefaultStructure))); // Structures don't match
 
     // Load cached property
     // Assume that the global object always uses external storage.
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSGlobalObject, m_externalStorage)), regT0);
-    load32(offsetAddr, regT1);
-    loadPtr(BaseIndex(regT0, regT1, ScalePtr), regT0);
+    info.offset = loadPtrWithAddressOffsetPatch(Address(regT0, patchGetByIdDefaultOffset), regT0);
+    m_globalResolveCompilationInfo.append(info);
     emitPutVirtualRegister(currentInstruction[1].u.operand);
     Jump end = jump();
 
@@ -2152,6 +2164,14 @@ void JIT::emit_op_resolve_global(Instruction* currentInstruction)
     end.link(this);
 }
 
+void JIT::patchResolveGlobal(CodeBlock* codeBlock, GlobalResolveInfo& globalResolveInfo)
+{
+    RepatchBuffer repatchBuffer(codeBlock);
+
+    repatchBuffer.repatch(globalResolveInfo.structureLabel, globalResolveInfo.structure);
+    repatchBuffer.repatch(globalResolveInfo.offsetLabel, static_cast<int>(sizeof(JSValue) * globalResolveInfo.offset));
+}
+
 void JIT::emit_op_not(Instruction* currentInstruction)
 {
     emitGetVirtualRegister(currentInstruction[2].u.operand, regT0);
@@ -432,9 +432,19 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     int base = currentInstruction[1].u.operand;
     int value = currentInstruction[3].u.operand;
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    emitLoad(base, regT1, regT0);
+    emitJumpSlowCaseIfNotJSCell(base, regT1);
+    // Kept out of the patchable sequence so that its offsets do not change.
+    // The barrier uses the value's registers as scratch, so load it after.
+    emitWriteBarrier(regT0, regT2, regT3);
+    unmap();
+    emitLoad(value, regT3, regT2);
+#else
     emitLoad2(base, regT1, regT0, value, regT3, regT2);
 
     emitJumpSlowCaseIfNotJSCell(base, regT1);
+#endif
 
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
@@ -470,6 +480,13 @@ void JIT::emitSlow_op_put_by_id(Instruction* currentInstruction, Vector<SlowCase
     linkSlowCaseIfNotJSCell(iter, base);
     linkSlowCase(iter);
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // The value is not loaded yet if the base was not a cell.
+    int value = currentInstruction[3].u.operand;
+    unmap();
+    emitLoad2(base, regT1, regT0, value, regT3, regT2);
+#endif
+
     JITStubCall stubCall(this, cti_op_put_by_id);
     stubCall.addArgument(regT1, regT0);
     stubCall.addArgument(ImmPtr(&(m_codeBlock->identifier(ident))));
@@ -562,6 +579,9 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
     add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)));
+#if ENABLE(JSC_GENERATIONAL_GC)
+    emitWriteBarrier(regT0, regT2, regT3);
+#endif
  
     load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*)), regT3);
     load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*) + 4), regT2);
@@ -1391,6 +1411,11 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     // Jump to a slow case if either the base object is an immediate, or if the Structure does not match.
     emitJumpSlowCaseIfNotJSCell(regT0, baseVReg);
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // Kept out of the patchable sequence so that its offsets do not change.
+    emitWriteBarrier(regT0, regT2, regT3);
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -1516,6 +1541,10 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
     add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)));
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // Before the store, which may replace regT0 with the property storage.
+    emitWriteBarrier(regT0, regT2, regT3);
+#endif
 
     // write the value
     compilePutDirectOffset(regT0, regT1, newStructure, cachedOffset);
@@ -863,6 +863,11 @@ NEVER_INLINE void JITThunks::tryCacheGetByID(CallFrame* callFrame, CodeBlock* co
         JSObject* slotBaseObject = asObject(slot.slotBase());
         size_t offset = slot.cachedOffset();
         
+        if (slotBaseObject->structure()->isThrashingDictionary()) {
+            ctiPatchCallByReturnAddress(codeBlock, returnAddress, FunctionPtr(cti_op_get_by_id_generic));
+            return;
+        }
+
         // Since we're accessing a prototype in a loop, it's a good bet that it
         // should not be treated as a dictionary.
         if (slotBaseObject->structure()->isDictionary()) {
@@ -1162,16 +1167,27 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_generic)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+// Used by the get_by_id sites that have gone megamorphic: looks the property
+// up in the global (Structure, name) cache before doing a full get.
+static inline JSValue getByIdMegamorphic(CallFrame* callFrame, JSValue baseValue, const Identifier& ident)
+{
+    PropertyLookupCache& cache = callFrame->globalData().propertyLookupCache;
+    JSValue result;
+    if (cache.get(baseValue, ident, result))
+        return result;
+
+    PropertySlot slot(baseValue);
+    result = baseValue.get(callFrame, ident, slot);
+    if (!callFrame->hadException())
+        cache.add(baseValue, ident, slot);
+    return result;
+}
+
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    CallFrame* callFrame = stackFrame.callFrame;
-    Identifier& ident = stackFrame.args[1].identifier();
-
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(callFrame, ident, slot);
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1262,7 +1278,8 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_method_check)
     if (baseValue.isCell()
         && slot.isCacheable()
         && !(structure = asCell(baseValue)->structure())->isUncacheableDictionary()
-        && (slotBaseObject = asObject(slot.slotBase()))->getPropertySpecificValue(callFrame, ident, specific)
+        && !(slotBaseObject = asObject(slot.slotBase()))->structure()->isThrashingDictionary()
+        && slotBaseObject->getPropertySpecificValue(callFrame, ident, specific)
         && specific
         ) {
 
@@ -1423,7 +1440,8 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list)
 
     if (slot.slotBase() == baseValue)
         ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_fail));
-    else if (slot.slotBase() == asCell(baseValue)->structure()->prototypeForLookup(callFrame)) {
+    else if (slot.slotBase() == asCell(baseValue)->structure()->prototypeForLookup(callFrame)
+        && !slotBaseObject->structure()->isThrashingDictionary()) {
         ASSERT(!asCell(baseValue)->structure()->isDictionary());
         // Since we're accessing a prototype in a loop, it's a good bet that it
         // should not be treated as a dictionary.
@@ -1459,9 +1477,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1471,9 +1487,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -2270,6 +2284,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_resolve_global)
             globalObject->structure()->ref();
             globalResolveInfo.structure = globalObject->structure();
             globalResolveInfo.offset = slot.cachedOffset();
+            JIT::patchResolveGlobal(callFrame->codeBlock(), globalResolveInfo);
             return JSValue::encode(result);
         }
 
@@ -12,6 +12,7 @@
 #include <limits.h>
 #include <string.h>
 #include <wtf/Assertions.h>
+#include <wtf/StringHashFunctions.h>
 
 using namespace WTF;
 using namespace Unicode;
@@ -119,6 +120,8 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     m_lineNumber = source.firstLine();
     m_delimited = false;
     m_lastToken = -1;
+    m_functionHeaderState = NotInFunctionHeader;
+    m_skippedFunctionBodyDepth = 0;
 
     const UChar* data = source.provider()->data();
 
@@ -182,11 +185,55 @@ ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, s
     return &m_arena->makeIdentifier(m_globalData, characters, length);
 }
 
+ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, size_t length, unsigned hash)
+{
+    return &m_arena->makeIdentifier(m_globalData, characters, length, hash);
+}
+
 inline bool Lexer::lastTokenWasRestrKeyword() const
 {
     return m_lastToken == CONTINUE || m_lastToken == BREAK || m_lastToken == RETURN || m_lastToken == THROW;
 }
 
+// Tracks "function name(a, b) {" from the token stream, which is all the
+// grammar allows before a function body, and then the braces of the body.
+// The parser only checks the syntax of these bodies (the _NoNode rules).
+inline void Lexer::updateFunctionBodyState(int token)
+{
+    if (m_skippedFunctionBodyDepth) {
+        if (token == OPENBRACE)
+            ++m_skippedFunctionBodyDepth;
+        else if (token == CLOSEBRACE)
+            --m_skippedFunctionBodyDepth;
+        return;
+    }
+
+    if (token == FUNCTION) {
+        m_functionHeaderState = AfterFunction;
+        return;
+    }
+
+    switch (m_functionHeaderState) {
+        case NotInFunctionHeader:
+            return;
+        case AfterFunction:
+            if (token == IDENT)
+                return;
+            m_functionHeaderState = token == '(' ? InParameters : NotInFunctionHeader;
+            return;
+        case InParameters:
+            if (token == IDENT || token == ',')
+                return;
+            m_functionHeaderState = token == ')' ? AfterParameters : NotInFunctionHeader;
+            return;
+        case AfterParameters:
+            if (token == OPENBRACE)
+                m_skippedFunctionBodyDepth = 1;
+            m_functionHeaderState = NotInFunctionHeader;
+            return;
+    }
+}
+
 static NEVER_INLINE bool isNonASCIIIdentStart(int c)
 {
     return category(c) & (Letter_Uppercase | Letter_Lowercase | Letter_Titlecase | Letter_Modifier | Letter_Other);
@@ -553,7 +600,7 @@ startString: {
         }
         shift1();
     }
-    lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
+    lvalp->ident = inSkippedFunctionBody() ? &m_globalData->propertyNames->emptyIdentifier : makeIdentifier(stringStart, currentCharacter() - stringStart);
     shift1();
     m_atLineStart = false;
     m_delimited = false;
@@ -640,11 +687,15 @@ startIdentifierWithBackslash:
 
 startIdentifierOrKeyword: {
     const UChar* identifierStart = currentCharacter();
+    StringHasher hasher;
+    hasher.addCharacter(m_current);
     shift1();
-    while (isIdentPart(m_current))
+    while (isIdentPart(m_current)) {
+        hasher.addCharacter(m_current);
         shift1();
+    }
     if (LIKELY(m_current != '\\')) {
-        lvalp->ident = makeIdentifier(identifierStart, currentCharacter() - identifierStart);
+        lvalp->ident = makeIdentifier(identifierStart, currentCharacter() - identifierStart, hasher.hash());
         goto doneIdentifierOrKeyword;
     }
     m_buffer16.append(identifierStart, currentCharacter() - identifierStart);
@@ -816,9 +867,13 @@ startNumber:
     // Fall through into doneNumber.
 
 doneNumber:
-    // Null-terminate string for strtod.
-    m_buffer8.append('\0');
-    lvalp->doubleValue = WTF::strtod(m_buffer8.data(), 0);
+    if (inSkippedFunctionBody())
+        lvalp->doubleValue = 0;
+    else {
+        // Null-terminate string for strtod.
+        m_buffer8.append('\0');
+        lvalp->doubleValue = WTF::strtod(m_buffer8.data(), 0);
+    }
     m_buffer8.resize(0);
 
     // Fall through into doneNumeric.
@@ -860,7 +915,7 @@ doneString:
     shift1();
     m_atLineStart = false;
     m_delimited = false;
-    lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
+    lvalp->ident = inSkippedFunctionBody() ? &m_globalData->propertyNames->emptyIdentifier : makeIdentifier(m_buffer16.data(), m_buffer16.size());
     m_buffer16.resize(0);
     token = STRING;
 
@@ -874,6 +929,7 @@ returnToken: {
     llocp->last_column = currentOffset();
 
     m_lastToken = token;
+    updateFunctionBodyState(token);
     return token;
 }
 
@@ -61,9 +61,16 @@ namespace JSC {
         const UChar* currentCharacter() const;
 
         const Identifier* makeIdentifier(const UChar* characters, size_t length);
+        const Identifier* makeIdentifier(const UChar* characters, size_t length, unsigned hash);
 
         bool lastTokenWasRestrKeyword() const;
 
+        // Function bodies are only syntax checked when first seen and are
+        // parsed again when compiled, so the values of the literals in them
+        // are never used.
+        bool inSkippedFunctionBody() const { return m_skippedFunctionBodyDepth; }
+        void updateFunctionBodyState(int token);
+
         static const size_t initialReadBufferCapacity = 32;
 
         int m_lineNumber;
@@ -74,6 +81,11 @@ namespace JSC {
         bool m_delimited; // encountered delimiter like "'" and "}" on last run
         int m_lastToken;
 
+        enum FunctionHeaderState { NotInFunctionHeader, AfterFunction, InParameters, AfterParameters };
+        FunctionHeaderState m_functionHeaderState;
+        // brace depth within the outermost skipped function body
+        unsigned m_skippedFunctionBodyDepth;
+
         const SourceCode* m_source;
         const UChar* m_code;
         const UChar* m_codeStart;
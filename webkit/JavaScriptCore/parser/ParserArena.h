@@ -13,21 +13,55 @@ namespace JSC {
 
     class IdentifierArena : public FastAllocBase {
     public:
+        IdentifierArena()
+        {
+            clearRecentIdentifiers();
+        }
+
         ALWAYS_INLINE const Identifier& makeIdentifier(JSGlobalData*, const UChar* characters, size_t length);
+        // hash must be UString::Rep::computeHash(characters, length)
+        ALWAYS_INLINE const Identifier& makeIdentifier(JSGlobalData*, const UChar* characters, size_t length, unsigned hash);
         const Identifier& makeNumericIdentifier(JSGlobalData*, double number);
 
-        void clear() { m_identifiers.clear(); }
+        void clear()
+        {
+            m_identifiers.clear();
+            clearRecentIdentifiers();
+        }
         bool isEmpty() const { return m_identifiers.isEmpty(); }
 
     private:
         typedef SegmentedVector<Identifier, 64> IdentifierVector;
         IdentifierVector m_identifiers;
+
+        // The last identifier made for each hash bucket, so that names a
+        // source repeats, like this, length or prototype, are found
+        // without going to the identifier table.
+        static const size_t recentIdentifierCount = 64;
+        void clearRecentIdentifiers()
+        {
+            for (size_t i = 0; i < recentIdentifierCount; ++i)
+                m_recentIdentifiers[i] = 0;
+        }
+        const Identifier* m_recentIdentifiers[recentIdentifierCount];
     };
 
     ALWAYS_INLINE const Identifier& IdentifierArena::makeIdentifier(JSGlobalData* globalData, const UChar* characters, size_t length)
     {
-        m_identifiers.append(Identifier(globalData, characters, length));
-        return m_identifiers.last();
+        return makeIdentifier(globalData, characters, length, UString::Rep::computeHash(characters, length));
+    }
+
+    ALWAYS_INLINE const Identifier& IdentifierArena::makeIdentifier(JSGlobalData* globalData, const UChar* characters, size_t length, unsigned hash)
+    {
+        const Identifier*& recent = m_recentIdentifiers[hash & (recentIdentifierCount - 1)];
+        if (recent) {
+            UString::Rep* rep = recent->ustring().rep();
+            if (rep->hash() == hash && Identifier::equal(rep, characters, length))
+                return *recent;
+        }
+        m_identifiers.append(Identifier(globalData, characters, length, hash));
+        recent = &m_identifiers.last();
+        return *recent;
     }
 
     inline const Identifier& IdentifierArena::makeNumericIdentifier(JSGlobalData* globalData, double number)
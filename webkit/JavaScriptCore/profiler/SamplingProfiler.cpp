@@ -0,0 +1,69 @@
+#include "config.h"
+#include "SamplingProfiler.h"
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "Profiler.h"
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+SamplingProfiler::SamplingProfiler()
+    : m_isRunning(false)
+    , m_sampleInterval(defaultSampleInterval)
+    , m_sampleCount(0)
+{
+}
+
+void SamplingProfiler::start(unsigned sampleInterval)
+{
+    ASSERT(sampleInterval);
+    m_counts.clear();
+    m_sampleCount = 0;
+    m_sampleInterval = sampleInterval;
+    m_isRunning = true;
+}
+
+static CallIdentifier callIdentifierForFrame(CallFrame* frame)
+{
+    if (JSFunction* callee = frame->callee())
+        return Profiler::createCallIdentifier(frame, callee, "", 0);
+
+    // Global and eval code have no callee.
+    CodeBlock* codeBlock = frame->codeBlock();
+    if (!codeBlock)
+        return Profiler::createCallIdentifier(frame, JSValue(), "", 0);
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    return Profiler::createCallIdentifier(frame, JSValue(), executable->sourceURL(), executable->lineNo());
+}
+
+void SamplingProfiler::sample(ExecState* exec)
+{
+    ASSERT(m_isRunning);
+    ++m_sampleCount;
+
+    // A recursive function counts once towards its total per sample.
+    Vector<CallIdentifier, 16> seen;
+    unsigned depth = 0;
+    for (CallFrame* frame = exec; frame && depth < maximumStackDepth; frame = frame->callerFrame()->removeHostCallFrameFlag(), ++depth) {
+        CallIdentifier identifier = callIdentifierForFrame(frame);
+        Counts& counts = m_counts.add(identifier, Counts()).first->second;
+        if (!depth)
+            ++counts.self;
+
+        bool alreadyCounted = false;
+        for (size_t i = 0; i < seen.size(); ++i) {
+            if (seen[i] == identifier) {
+                alreadyCounted = true;
+                break;
+            }
+        }
+        if (alreadyCounted)
+            continue;
+        seen.append(identifier);
+        ++counts.total;
+    }
+}
+
+} // namespace JSC
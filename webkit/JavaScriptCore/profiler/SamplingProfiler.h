@@ -0,0 +1,58 @@
+#ifndef SamplingProfiler_h
+#define SamplingProfiler_h
+
+#include "CallIdentifier.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+
+namespace JSC {
+
+    class ExecState;
+
+    // Finds where JavaScript spends its time by looking at the call stack
+    // every sampleInterval() milliseconds of execution, rather than hooking
+    // every call and return the way Profiler does, so that it is cheap enough
+    // to leave running in a real session. Samples are taken when the
+    // TimeoutChecker checks in, which happens on loop back edges; time spent
+    // in code without loops is counted against the next loop that runs.
+    class SamplingProfiler : public Noncopyable {
+    public:
+        struct Counts {
+            Counts() : self(0), total(0) { }
+
+            // Samples taken while the function was the innermost one
+            unsigned self;
+            // Samples taken while the function was anywhere on the stack
+            unsigned total;
+        };
+        typedef HashMap<CallIdentifier, Counts> CountMap;
+
+        static const unsigned defaultSampleInterval = 10;
+
+        SamplingProfiler();
+
+        // Discards the counts of the previous run.
+        void start(unsigned sampleInterval = defaultSampleInterval);
+        void stop() { m_isRunning = false; }
+        bool isRunning() const { return m_isRunning; }
+
+        unsigned sampleInterval() const { return m_sampleInterval; }
+
+        void sample(ExecState*);
+
+        unsigned sampleCount() const { return m_sampleCount; }
+        const CountMap& counts() const { return m_counts; }
+
+    private:
+        // Deeper frames are left out of the total counts.
+        static const unsigned maximumStackDepth = 64;
+
+        bool m_isRunning;
+        unsigned m_sampleInterval;
+        unsigned m_sampleCount;
+        CountMap m_counts;
+    };
+
+} // namespace JSC
+
+#endif // SamplingProfiler_h
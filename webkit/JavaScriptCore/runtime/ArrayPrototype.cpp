@@ -96,6 +96,15 @@ static JSValue getProperty(ExecState* exec, JSObject* obj, unsigned index)
     return slot.getValue(exec, index);
 }
 
+// Reads index straight from the storage vector when it's there, and
+// through getProperty for holes and values in the sparse map.
+static inline JSValue getArrayIndex(ExecState* exec, JSArray* array, unsigned index)
+{
+    if (LIKELY(array->canGetIndex(index)))
+        return array->getIndex(index);
+    return getProperty(exec, array, index);
+}
+
 static void putProperty(ExecState* exec, JSObject* obj, const Identifier& propertyName, JSValue value)
 {
     PutPropertySlot slot;
@@ -338,6 +347,8 @@ JSValue JSC_HOST_CALL arrayProtoFuncShift(ExecState* exec, JSObject*, JSValue th
         result = jsUndefined();
     } else {
         result = thisObj->get(exec, 0);
+        if (isJSArray(&exec->globalData(), thisObj) && asArray(thisObj)->spliceDense(0, 1, ArgList()))
+            return result;
         for (unsigned k = 1; k < length; k++) {
             if (JSValue obj = getProperty(exec, thisObj, k))
                 thisObj->put(exec, k - 1, obj);
@@ -481,6 +492,13 @@ JSValue JSC_HOST_CALL arrayProtoFuncSplice(ExecState* exec, JSObject*, JSValue t
     }
     resObj->setLength(deleteCount);
 
+    if (isJSArray(&exec->globalData(), thisObj)) {
+        ArgList items;
+        args.getSlice(2, items);
+        if (asArray(thisObj)->spliceDense(begin, deleteCount, items))
+            return result;
+    }
+
     unsigned additionalArgs = std::max<int>(args.size() - 2, 0);
     if (additionalArgs != deleteCount) {
         if (additionalArgs < deleteCount) {
@@ -515,6 +533,8 @@ JSValue JSC_HOST_CALL arrayProtoFuncUnShift(ExecState* exec, JSObject*, JSValue
     // 15.4.4.13
     unsigned length = thisObj->get(exec, exec->propertyNames().length).toUInt32(exec);
     unsigned nrArgs = args.size();
+    if (isJSArray(&exec->globalData(), thisObj) && asArray(thisObj)->spliceDense(0, 0, args))
+        return jsNumber(exec, length + nrArgs);
     if (nrArgs) {
         for (unsigned k = length; k > 0; --k) {
             if (JSValue v = getProperty(exec, thisObj, k - 1))
@@ -551,9 +571,9 @@ JSValue JSC_HOST_CALL arrayProtoFuncFilter(ExecState* exec, JSObject*, JSValue t
         JSArray* array = asArray(thisObj);
         CachedCall cachedCall(exec, f, 3, exec->exceptionSlot());
         for (; k < length && !exec->hadException(); ++k) {
-            if (!array->canGetIndex(k))
-                break;
-            JSValue v = array->getIndex(k);
+            JSValue v = getArrayIndex(exec, array, k);
+            if (!v)
+                continue;
             cachedCall.setThis(applyThis);
             cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
@@ -563,8 +583,7 @@ JSValue JSC_HOST_CALL arrayProtoFuncFilter(ExecState* exec, JSObject*, JSValue t
             if (result.toBoolean(exec))
                 resultArray->put(exec, filterIndex++, v);
         }
-        if (k == length)
-            return resultArray;
+        return resultArray;
     }
     for (; k < length && !exec->hadException(); ++k) {
         PropertySlot slot(thisObj);
@@ -609,16 +628,18 @@ JSValue JSC_HOST_CALL arrayProtoFuncMap(ExecState* exec, JSObject*, JSValue this
         JSArray* array = asArray(thisObj);
         CachedCall cachedCall(exec, f, 3, exec->exceptionSlot());
         for (; k < length && !exec->hadException(); ++k) {
-            if (UNLIKELY(!array->canGetIndex(k)))
-                break;
+            JSValue v = getArrayIndex(exec, array, k);
+            if (!v)
+                continue;
 
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
 
             resultArray->JSArray::put(exec, k, cachedCall.call());
         }
+        return resultArray;
     }
     for (; k < length && !exec->hadException(); ++k) {
         PropertySlot slot(thisObj);
@@ -666,17 +687,19 @@ JSValue JSC_HOST_CALL arrayProtoFuncEvery(ExecState* exec, JSObject*, JSValue th
         JSArray* array = asArray(thisObj);
         CachedCall cachedCall(exec, f, 3, exec->exceptionSlot());
         for (; k < length && !exec->hadException(); ++k) {
-            if (UNLIKELY(!array->canGetIndex(k)))
-                break;
-            
+            JSValue v = getArrayIndex(exec, array, k);
+            if (!v)
+                continue;
+
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
             JSValue result = cachedCall.call();
             if (!result.toBoolean(cachedCall.newCallFrame(exec)))
                 return jsBoolean(false);
         }
+        return result;
     }
     for (; k < length && !exec->hadException(); ++k) {
         PropertySlot slot(thisObj);
@@ -720,16 +743,18 @@ JSValue JSC_HOST_CALL arrayProtoFuncForEach(ExecState* exec, JSObject*, JSValue
         JSArray* array = asArray(thisObj);
         CachedCall cachedCall(exec, f, 3, exec->exceptionSlot());
         for (; k < length && !exec->hadException(); ++k) {
-            if (UNLIKELY(!array->canGetIndex(k)))
-                break;
+            JSValue v = getArrayIndex(exec, array, k);
+            if (!v)
+                continue;
 
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
 
             cachedCall.call();
         }
+        return jsUndefined();
     }
     for (; k < length && !exec->hadException(); ++k) {
         PropertySlot slot(thisObj);
@@ -767,17 +792,19 @@ JSValue JSC_HOST_CALL arrayProtoFuncSome(ExecState* exec, JSObject*, JSValue thi
         JSArray* array = asArray(thisObj);
         CachedCall cachedCall(exec, f, 3, exec->exceptionSlot());
         for (; k < length && !exec->hadException(); ++k) {
-            if (UNLIKELY(!array->canGetIndex(k)))
-                break;
-            
+            JSValue v = getArrayIndex(exec, array, k);
+            if (!v)
+                continue;
+
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
             JSValue result = cachedCall.call();
             if (result.toBoolean(cachedCall.newCallFrame(exec)))
                 return jsBoolean(true);
         }
+        return result;
     }
     for (; k < length && !exec->hadException(); ++k) {
         PropertySlot slot(thisObj);
@@ -958,6 +985,13 @@ JSValue JSC_HOST_CALL arrayProtoFuncIndexOf(ExecState* exec, JSObject*, JSValue
     }
 
     JSValue searchElement = args.at(0);
+    if (isJSArray(&exec->globalData(), thisObj)) {
+        JSArray* array = asArray(thisObj);
+        for (; index < length && array->canGetIndex(index); ++index) {
+            if (JSValue::strictEqual(exec, searchElement, array->getIndex(index)))
+                return jsNumber(exec, index);
+        }
+    }
     for (; index < length; ++index) {
         JSValue e = getProperty(exec, thisObj, index);
         if (!e)
@@ -989,6 +1023,13 @@ JSValue JSC_HOST_CALL arrayProtoFuncLastIndexOf(ExecState* exec, JSObject*, JSVa
         index = static_cast<int>(d);
 
     JSValue searchElement = args.at(0);
+    if (isJSArray(&exec->globalData(), thisObj)) {
+        JSArray* array = asArray(thisObj);
+        for (; index >= 0 && array->canGetIndex(index); --index) {
+            if (JSValue::strictEqual(exec, searchElement, array->getIndex(index)))
+                return jsNumber(exec, index);
+        }
+    }
     for (; index >= 0; --index) {
         JSValue e = getProperty(exec, thisObj, index);
         if (!e)
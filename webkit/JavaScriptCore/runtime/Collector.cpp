@@ -17,11 +17,13 @@
 #include "JSZombie.h"
 #include "MarkStack.h"
 #include "Nodes.h"
+#include "ParallelMarker.h"
 #include "Tracing.h"
 #include <algorithm>
 #include <limits.h>
 #include <setjmp.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -79,6 +81,7 @@
 #define COLLECT_ON_EVERY_ALLOCATION 0
 
 using std::max;
+using std::min;
 
 namespace JSC {
 
@@ -87,6 +90,15 @@ namespace JSC {
 const size_t GROWTH_FACTOR = 2;
 const size_t LOW_WATER_FACTOR = 4;
 const size_t ALLOCATIONS_PER_COLLECTION = 3600;
+#if ENABLE(JSC_GENERATIONAL_GC)
+// A full collection runs once the cells that survived young collections have
+// grown this many times over what survived the last full one.
+const size_t OLD_GENERATION_GROWTH = 2;
+#endif
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+// cells traced between checks of the time limit
+const size_t INCREMENTAL_MARKING_CELLS = 256;
+#endif
 // This value has to be a macro to be used in max() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_ARRAY_SIZE (static_cast<size_t>(14))
@@ -123,6 +135,9 @@ public:
 
 Heap::Heap(JSGlobalData* globalData)
     : m_markListSet(0)
+#if ENABLE(JSC_PARALLEL_MARKING)
+    , m_parallelMarker(0)
+#endif
 #if ENABLE(JSC_MULTIPLE_THREADS)
     , m_registeredThreads(0)
     , m_currentThreadRegistrar(0)
@@ -130,6 +145,11 @@ Heap::Heap(JSGlobalData* globalData)
     , m_globalData(globalData)
 {
     ASSERT(globalData);
+
+    m_policy.targetSize = 0;
+    m_policy.growthPercent = 100;
+    m_policy.shrinkPercent = 25;
+    m_policy.maxExtraCost = maxExtraCost;
     
 #if OS(SYMBIAN)
     // Symbian OpenC supports mmap but currently not the MAP_ANON flag.
@@ -178,8 +198,16 @@ void Heap::destroy()
     delete m_markListSet;
     m_markListSet = 0;
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    stopIncrementalMarking();
+#endif
     freeBlocks();
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+    delete m_parallelMarker;
+    m_parallelMarker = 0;
+#endif
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
     if (m_currentThreadRegistrar) {
         int error = pthread_key_delete(m_currentThreadRegistrar);
@@ -357,7 +385,7 @@ void Heap::recordExtraCost(size_t cost)
     // if a large value survives one garbage collection, there is not much point to
     // collecting more frequently as long as it stays alive.
 
-    if (m_heap.extraCost > maxExtraCost && m_heap.extraCost > m_heap.usedBlocks * BLOCK_SIZE / 2) {
+    if (m_heap.extraCost > m_policy.maxExtraCost && m_heap.extraCost > m_heap.usedBlocks * BLOCK_SIZE / 2) {
         // If the last iteration through the heap deallocated blocks, we need
         // to clean up remaining garbage before marking. Otherwise, the conservative
         // marking mechanism might follow a pointer to unmapped memory.
@@ -391,16 +419,19 @@ allocate:
     do {
         ASSERT(m_heap.nextBlock < m_heap.usedBlocks);
         Block* block = reinterpret_cast<Block*>(m_heap.blocks[m_heap.nextBlock]);
+        // Garbage is destroyed a block at a time as allocation reaches it,
+        // rather than all at once after marking.
+        if (!m_heap.nextCell) {
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+            if (shouldStartIncrementalMarking())
+                startIncrementalMarking();
+#endif
+            sweepBlock(block);
+        }
         do {
             ASSERT(m_heap.nextCell < HeapConstants::cellsPerBlock);
             if (!block->marked.get(m_heap.nextCell)) { // Always false for the last cell in the block
                 Cell* cell = block->cells + m_heap.nextCell;
-
-                m_heap.operationInProgress = Allocation;
-                JSCell* imp = reinterpret_cast<JSCell*>(cell);
-                imp->~JSCell();
-                m_heap.operationInProgress = NoOperation;
-
                 ++m_heap.nextCell;
                 return cell;
             }
@@ -419,10 +450,16 @@ void Heap::resizeBlocks()
     m_heap.didShrink = false;
 
     size_t usedCellCount = markedCells();
-    size_t minCellCount = usedCellCount + max(ALLOCATIONS_PER_COLLECTION, usedCellCount);
+    size_t freeCellCount = usedCellCount / 100 * m_policy.growthPercent;
+    if (m_policy.targetSize) {
+        size_t targetCellCount = m_policy.targetSize / BLOCK_SIZE * HeapConstants::cellsPerBlock;
+        if (usedCellCount + freeCellCount > targetCellCount)
+            freeCellCount = targetCellCount > usedCellCount ? targetCellCount - usedCellCount : 0;
+    }
+    size_t minCellCount = usedCellCount + max(ALLOCATIONS_PER_COLLECTION, freeCellCount);
     size_t minBlockCount = (minCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
 
-    size_t maxCellCount = 1.25f * minCellCount;
+    size_t maxCellCount = minCellCount + minCellCount / 100 * m_policy.shrinkPercent;
     size_t maxBlockCount = (maxCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
 
     if (m_heap.usedBlocks < minBlockCount)
@@ -709,6 +746,7 @@ inline bool isPointerAligned(void* p)
 
 // Cell size needs to be a power of two for isPossibleCell to be valid.
 COMPILE_ASSERT(sizeof(CollectorCell) % 2 == 0, Collector_cell_size_is_power_of_two);
+COMPILE_ASSERT(sizeof(CollectorBlock) <= BLOCK_SIZE, CollectorBlock_fits_in_block);
 
 #if USE(JSVALUE32)
 static bool isHalfCellAligned(void *p)
@@ -768,7 +806,9 @@ void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
                 if (blocks[block] != blockAddr)
                     continue;
                 markStack.append(reinterpret_cast<JSCell*>(xAsBits));
+#if !ENABLE(JSC_PARALLEL_MARKING)
                 markStack.drain();
+#endif
             }
         }
     }
@@ -1007,7 +1047,9 @@ void Heap::markProtectedObjects(MarkStack& markStack)
     ProtectCountSet::iterator end = m_protectedValues.end();
     for (ProtectCountSet::iterator it = m_protectedValues.begin(); it != end; ++it) {
         markStack.append(it->first);
+#if !ENABLE(JSC_PARALLEL_MARKING)
         markStack.drain();
+#endif
     }
 }
 
@@ -1022,6 +1064,10 @@ void Heap::clearMarkBits(CollectorBlock* block)
     // allocate assumes that the last cell in every block is marked.
     block->marked.clearAll();
     block->marked.set(HeapConstants::cellsPerBlock - 1);
+#if ENABLE(JSC_GENERATIONAL_GC)
+    block->remembered.clearAll();
+    memset(block->cards, 0, sizeof(block->cards));
+#endif
 }
 
 size_t Heap::markedCells(size_t startBlock, size_t startCell) const
@@ -1072,7 +1118,134 @@ void Heap::sweep()
     m_heap.operationInProgress = NoOperation;
 }
 
-void Heap::markRoots()
+#if ENABLE(JSC_GENERATIONAL_GC)
+void Heap::markRememberedCells(MarkStack& markStack)
+{
+    const size_t cellsPerCard = CARD_SIZE / CELL_SIZE;
+    for (size_t i = 0; i < m_heap.usedBlocks; ++i) {
+        CollectorBlock* block = m_heap.blocks[i];
+
+        // Cells written to since the last collection. A card can start part
+        // way into the block header, past the last cell, so clamp to the
+        // sentinel, which has no children.
+        for (size_t card = 0; card < CARDS_PER_BLOCK; ++card) {
+            if (!block->cards[card])
+                continue;
+            block->cards[card] = 0;
+            size_t first = card * cellsPerCard;
+            size_t last = min(first + cellsPerCard, HeapConstants::cellsPerBlock - 1);
+            for (size_t cell = first; cell < last; ++cell) {
+                if (block->marked.get(cell))
+                    markStack.appendChildren(reinterpret_cast<JSCell*>(block->cells + cell));
+            }
+        }
+
+        // Cells that mark slots written without the write barrier.
+        for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+            uint32_t bits = block->remembered.bits[word];
+            for (size_t cell = word << 5; bits; bits >>= 1, ++cell) {
+                if (bits & 1)
+                    markStack.appendChildren(reinterpret_cast<JSCell*>(block->cells + cell));
+            }
+        }
+    }
+}
+#endif
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+bool Heap::shouldStartIncrementalMarking() const
+{
+    // Start once allocation is three quarters of the way through the heap,
+    // leaving the rest to allocate from while marking runs.
+    if (m_heap.isMarkingIncrementally || !m_heap.nextBlock || m_heap.nextBlock != m_heap.usedBlocks * 3 / 4)
+        return false;
+    // Allocation goes on reusing the cells that the last collection left
+    // unmarked, so the mark bits must not be cleared.
+    if (nextCollectionType() != YoungCollection)
+        return false;
+    return m_globalData->clientData && m_globalData->clientData->scheduleIncrementalMarking();
+}
+
+void Heap::startIncrementalMarking()
+{
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Collection;
+    m_heap.isMarkingIncrementally = true;
+
+    // Only queue the old cells to trace; the roots are marked by the pause
+    // that ends the cycle, since the mutator changes them in between slices.
+    markRememberedCells(m_globalData->markStack);
+
+    m_heap.operationInProgress = NoOperation;
+}
+
+void Heap::stopIncrementalMarking()
+{
+    if (!m_heap.isMarkingIncrementally)
+        return;
+    m_heap.isMarkingIncrementally = false;
+    m_globalData->markStack.clear();
+}
+
+bool Heap::markIncrementally(double timeLimit)
+{
+    if (!m_heap.isMarkingIncrementally)
+        return true;
+
+    ASSERT(JSLock::lockCount() > 0);
+    ASSERT(JSLock::currentThreadIsHoldingLock());
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Collection;
+
+    MarkStack& markStack = m_globalData->markStack;
+    double deadline = currentTime() + timeLimit;
+    bool done;
+    do
+        done = markStack.drainIncrementally(INCREMENTAL_MARKING_CELLS);
+    while (!done && currentTime() < deadline);
+
+    m_heap.operationInProgress = NoOperation;
+    if (!done)
+        return false;
+
+    // What is left is the pause of a young collection: the roots, and the
+    // cells written to or remembered since the cycle started.
+    reset();
+    return true;
+}
+#endif
+
+CollectionType Heap::nextCollectionType() const
+{
+#if ENABLE(JSC_GENERATIONAL_GC)
+    size_t threshold = OLD_GENERATION_GROWTH * max(m_heap.cellsAfterFullCollection, ALLOCATIONS_PER_COLLECTION);
+    if (markedCells() < threshold)
+        return YoungCollection;
+#endif
+    return FullCollection;
+}
+
+void Heap::sweepBlock(CollectorBlock* block)
+{
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Allocation;
+
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+    // The last cell is the sentinel, and is always marked.
+    for (size_t i = 0; i < HeapConstants::cellsPerBlock - 1; ++i) {
+        if (block->marked.get(i))
+            continue;
+        JSCell* cell = reinterpret_cast<JSCell*>(block->cells + i);
+        cell->~JSCell();
+        // allocate skips the destructor call for cells this has swept, and
+        // marking may still find this cell conservatively.
+        new (cell) JSCell(dummyMarkableCellStructure);
+    }
+
+    m_heap.operationInProgress = NoOperation;
+}
+
+void Heap::markRoots(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance) {
@@ -1089,6 +1262,18 @@ void Heap::markRoots()
 
     MarkStack& markStack = m_globalData->markStack;
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // A young collection keeps the mark bits from the last collection, so
+    // cells that survived it are treated as live without being traced.
+    if (collectionType == YoungCollection) {
+        markRememberedCells(markStack);
+#if !ENABLE(JSC_PARALLEL_MARKING)
+        markStack.drain();
+#endif
+    } else
+#else
+    UNUSED_PARAM(collectionType);
+#endif
     // Reset mark bits.
     clearMarkBits();
 
@@ -1109,6 +1294,14 @@ void Heap::markRoots()
     if (m_globalData->firstStringifierToMark)
         JSONObject::markStringifiers(markStack, m_globalData->firstStringifierToMark);
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+    // With parallel marking the roots above are only queued, so that all the
+    // markers can trace from them together.
+    if (!m_parallelMarker)
+        m_parallelMarker = new ParallelMarker(m_globalData->jsArrayVPtr);
+    m_parallelMarker->drain(markStack);
+#endif
+
     // Mark the small strings cache last, since it will clear itself if nothing
     // else has marked it.
     m_globalData->smallStrings.markChildren(markStack);
@@ -1116,6 +1309,11 @@ void Heap::markRoots()
     markStack.drain();
     markStack.compact();
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    if (collectionType == FullCollection)
+        m_heap.cellsAfterFullCollection = markedCells();
+#endif
+
     m_heap.operationInProgress = NoOperation;
 }
 
@@ -1225,7 +1423,16 @@ void Heap::reset()
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
-    markRoots();
+    CollectionType collectionType = nextCollectionType();
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    // An incremental cycle ends in the young collection it started as, even
+    // if the cells it has marked so far would call for a full one.
+    if (m_heap.isMarkingIncrementally) {
+        m_heap.isMarkingIncrementally = false;
+        collectionType = YoungCollection;
+    }
+#endif
+    markRoots(collectionType);
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -1251,7 +1458,11 @@ void Heap::collectAllGarbage()
     if (m_heap.didShrink)
         sweep();
 
-    markRoots();
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    // The full collection clears the marks set so far.
+    stopIncrementalMarking();
+#endif
+    markRoots(FullCollection);
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -1259,12 +1470,30 @@ void Heap::collectAllGarbage()
     m_heap.nextBlock = 0;
     m_heap.nextNumber = 0;
     m_heap.extraCost = 0;
+#if ENABLE(JSC_ZOMBIES)
     sweep();
+#endif
     resizeBlocks();
 
     JAVASCRIPTCORE_GC_END();
 }
 
+void Heap::releaseFreeMemory()
+{
+    collectAllGarbage();
+
+    // Allocation would otherwise leave the garbage in the blocks that stay
+    // to be destroyed as it reaches them.
+    sweep();
+
+    size_t usedBlockCount = (markedCells() + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+    size_t neededBlocks = max(static_cast<size_t>(1), usedBlockCount);
+    if (m_heap.usedBlocks > neededBlocks)
+        shrinkBlocks(neededBlocks);
+
+    m_globalData->interpreter->registerFile().releaseExcessCapacity();
+}
+
 LiveObjectIterator Heap::primaryHeapBegin()
 {
     return LiveObjectIterator(m_heap, 0);
@@ -26,9 +26,14 @@ namespace JSC {
     class JSValue;
     class MarkedArgumentBuffer;
     class MarkStack;
+    class ParallelMarker;
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
 
+    // A young collection keeps the mark bits of the last one and only traces
+    // cells allocated since, plus the old cells they may be reachable from.
+    enum CollectionType { FullCollection, YoungCollection };
+
     class LiveObjectIterator;
 
     struct CollectorHeap {
@@ -44,6 +49,9 @@ namespace JSC {
         size_t extraCost;
         bool didShrink;
 
+        size_t cellsAfterFullCollection;
+        bool isMarkingIncrementally;
+
         OperationInProgress operationInProgress;
     };
 
@@ -59,11 +67,37 @@ namespace JSC {
         bool isBusy(); // true if an allocation or collection is in progress
         void collectAllGarbage();
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Allocation starts an incremental marking cycle once most of the
+        // heap is in use, and asks JSGlobalData::ClientData to schedule it.
+        // Each call marks for about timeLimit seconds. It returns true once
+        // the cycle is over, the last call having finished the collection.
+        bool markIncrementally(double timeLimit);
+        bool isMarkingIncrementally() const { return m_heap.isMarkingIncrementally; }
+#endif
+
         static const size_t minExtraCost = 256;
         static const size_t maxExtraCost = 1024 * 1024;
 
         void reportExtraMemoryCost(size_t cost);
 
+        // How the heap is sized after each collection. Percentages are of
+        // the cells that survived it.
+        struct Policy {
+            size_t targetSize;          // bytes; 0 for none. Past it, the heap
+                                        // only grows by the minimum needed
+            unsigned growthPercent;     // free cells to leave; 100 doubles
+            unsigned shrinkPercent;     // blocks beyond this much over what
+                                        // growthPercent calls for are freed
+            size_t maxExtraCost;        // extra cost that forces a collection
+        };
+        const Policy& policy() const { return m_policy; }
+        void setPolicy(const Policy& policy) { m_policy = policy; }
+
+        // Collects, runs every pending destructor, and frees all the blocks
+        // the surviving cells don't need, for low memory notifications.
+        void releaseFreeMemory();
+
         size_t objectCount() const;
         struct Statistics {
             size_t size;
@@ -87,6 +121,22 @@ namespace JSC {
 
         static bool isCellMarked(const JSCell*);
         static void markCell(JSCell*);
+#if ENABLE(JSC_PARALLEL_MARKING)
+        // Marks cell; returns false if it was already marked.
+        static bool testAndMarkCell(JSCell*);
+#endif
+
+        // Must be called after storing value into one of owner's slots. With
+        // ENABLE(JSC_GENERATIONAL_GC) it dirties the card holding owner, so
+        // that the next young collection traces owner again; otherwise it does
+        // nothing. The second form is for cells marked outside a collection.
+        static void writeBarrier(const JSCell* owner, JSValue value);
+        static void writeBarrier(const JSCell* owner);
+#if ENABLE(JSC_GENERATIONAL_GC)
+        // Old cells whose children are not all stored through the write
+        // barrier are traced again by every young collection.
+        static void rememberCell(const JSCell*);
+#endif
 
         void markConservatively(MarkStack&, void* start, void* end);
 
@@ -101,8 +151,12 @@ namespace JSC {
     private:
         void reset();
         void sweep();
+        void sweepBlock(CollectorBlock*);
         static CollectorBlock* cellBlock(const JSCell*);
         static size_t cellOffset(const JSCell*);
+#if ENABLE(JSC_GENERATIONAL_GC)
+        static size_t cardOffset(const JSCell*);
+#endif
 
         friend class JSGlobalData;
         Heap(JSGlobalData*);
@@ -123,7 +177,16 @@ namespace JSC {
 
         void addToStatistics(Statistics&) const;
 
-        void markRoots();
+        CollectionType nextCollectionType() const;
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        bool shouldStartIncrementalMarking() const;
+        void startIncrementalMarking();
+        void stopIncrementalMarking();
+#endif
+        void markRoots(CollectionType);
+#if ENABLE(JSC_GENERATIONAL_GC)
+        void markRememberedCells(MarkStack&);
+#endif
         void markProtectedObjects(MarkStack&);
         void markCurrentThreadConservatively(MarkStack&);
         void markCurrentThreadConservativelyInternal(MarkStack&);
@@ -133,11 +196,16 @@ namespace JSC {
         typedef HashCountedSet<JSCell*> ProtectCountSet;
 
         CollectorHeap m_heap;
+        Policy m_policy;
 
         ProtectCountSet m_protectedValues;
 
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+        ParallelMarker* m_parallelMarker;
+#endif
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
         void makeUsableFromMultipleThreads();
 
@@ -178,7 +246,19 @@ namespace JSC {
     const size_t SMALL_CELL_SIZE = CELL_SIZE / 2;
     const size_t CELL_MASK = CELL_SIZE - 1;
     const size_t CELL_ALIGN_MASK = ~CELL_MASK;
-    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*)) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // The write barrier dirties one card per CARD_SIZE bytes of a block. Cards
+    // are words so that the JIT can set them with a plain 32 bit store.
+    const size_t CARD_SHIFT = 9;
+    const size_t CARD_SIZE = 1 << CARD_SHIFT;
+    const size_t CARDS_PER_BLOCK = BLOCK_SIZE >> CARD_SHIFT;
+    const size_t CARD_BYTES = CARDS_PER_BLOCK * sizeof(uint32_t);
+    const size_t BITMAPS_PER_BLOCK = 2; // marked and remembered
+#else
+    const size_t CARD_BYTES = 0;
+    const size_t BITMAPS_PER_BLOCK = 1;
+#endif
+    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*) - CARD_BYTES) * 8 * CELL_SIZE / (8 * CELL_SIZE + BITMAPS_PER_BLOCK) / CELL_SIZE; // one bitmap byte can represent 8 cells.
     
     const size_t BITMAP_SIZE = (CELLS_PER_BLOCK + 7) / 8;
     const size_t BITMAP_WORDS = (BITMAP_SIZE + 3) / sizeof(uint32_t);
@@ -187,6 +267,15 @@ namespace JSC {
         uint32_t bits[BITMAP_WORDS];
         bool get(size_t n) const { return !!(bits[n >> 5] & (1 << (n & 0x1F))); } 
         void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
+#if ENABLE(JSC_PARALLEL_MARKING)
+        // Like set, but safe against other threads setting bits in the same
+        // word. Returns false if the bit was already set.
+        bool testAndSet(size_t n)
+        {
+            int mask = 1 << (n & 0x1F);
+            return !(WTF::atomicOr(reinterpret_cast<int volatile*>(&bits[n >> 5]), mask) & mask);
+        }
+#endif
         void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
         void clearAll() { memset(bits, 0, sizeof(bits)); }
         size_t count(size_t startCell = 0)
@@ -217,6 +306,10 @@ namespace JSC {
     public:
         CollectorCell cells[CELLS_PER_BLOCK];
         CollectorBitmap marked;
+#if ENABLE(JSC_GENERATIONAL_GC)
+        CollectorBitmap remembered;
+        uint32_t cards[CARDS_PER_BLOCK];
+#endif
         Heap* heap;
     };
 
@@ -244,8 +337,44 @@ namespace JSC {
 
     inline void Heap::markCell(JSCell* cell)
     {
+#if ENABLE(JSC_PARALLEL_MARKING)
+        cellBlock(cell)->marked.testAndSet(cellOffset(cell));
+#else
         cellBlock(cell)->marked.set(cellOffset(cell));
+#endif
+    }
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+    inline bool Heap::testAndMarkCell(JSCell* cell)
+    {
+        return cellBlock(cell)->marked.testAndSet(cellOffset(cell));
     }
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC)
+    inline size_t Heap::cardOffset(const JSCell* cell)
+    {
+        return (reinterpret_cast<uintptr_t>(cell) & BLOCK_OFFSET_MASK) >> CARD_SHIFT;
+    }
+
+    inline void Heap::writeBarrier(const JSCell* owner)
+    {
+        cellBlock(owner)->cards[cardOffset(owner)] = 1;
+    }
+
+    inline void Heap::rememberCell(const JSCell* cell)
+    {
+#if ENABLE(JSC_PARALLEL_MARKING)
+        cellBlock(cell)->remembered.testAndSet(cellOffset(cell));
+#else
+        cellBlock(cell)->remembered.set(cellOffset(cell));
+#endif
+    }
+#else
+    inline void Heap::writeBarrier(const JSCell*)
+    {
+    }
+#endif
 
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
@@ -140,17 +140,21 @@ PassRefPtr<UString::Rep> Identifier::add(ExecState* exec, const char* c)
 struct UCharBuffer {
     const UChar* s;
     unsigned int length;
+    unsigned hash;
 };
 
 struct UCharBufferTranslator {
     static unsigned hash(const UCharBuffer& buf)
     {
-        return UString::Rep::computeHash(buf.s, buf.length);
+        ASSERT(buf.hash == UString::Rep::computeHash(buf.s, buf.length));
+        return buf.hash;
     }
 
     static bool equal(UString::Rep* str, const UCharBuffer& buf)
     {
-        return Identifier::equal(str, buf.s, buf.length);
+        // Identifiers always have their hash computed, and comparing it
+        // first keeps collisions from touching the characters.
+        return str->existingHash() == buf.hash && Identifier::equal(str, buf.s, buf.length);
     }
 
     static void translate(UString::Rep*& location, const UCharBuffer& buf, unsigned hash)
@@ -165,6 +169,11 @@ struct UCharBufferTranslator {
 };
 
 PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const UChar* s, int length)
+{
+    return add(globalData, s, length, length > 1 ? UString::Rep::computeHash(s, length) : 0);
+}
+
+PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const UChar* s, int length, unsigned hash)
 {
     if (length == 1) {
         UChar c = s[0];
@@ -175,7 +184,7 @@ PassRefPtr<UString::Rep> Identifier::add(JSGlobalData* globalData, const UChar*
         UString::Rep::empty().hash();
         return &UString::Rep::empty();
     }
-    UCharBuffer buf = {s, length}; 
+    UCharBuffer buf = { s, length, hash };
     pair<HashSet<UString::Rep*>::iterator, bool> addResult = globalData->identifierTable->add<UCharBuffer, UCharBufferTranslator>(buf);
 
     // If the string is newly-translated, then we need to adopt it.
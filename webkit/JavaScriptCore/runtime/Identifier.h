@@ -23,6 +23,8 @@ namespace JSC {
 
         Identifier(JSGlobalData* globalData, const char* s) : _ustring(add(globalData, s)) { } // Only to be used with string literals.
         Identifier(JSGlobalData* globalData, const UChar* s, int length) : _ustring(add(globalData, s, length)) { }
+        // hash must be UString::Rep::computeHash(s, length)
+        Identifier(JSGlobalData* globalData, const UChar* s, int length, unsigned hash) : _ustring(add(globalData, s, length, hash)) { }
         Identifier(JSGlobalData* globalData, UString::Rep* rep) : _ustring(add(globalData, rep)) { } 
         Identifier(JSGlobalData* globalData, const UString& s) : _ustring(add(globalData, s.rep())) { }
 
@@ -72,6 +74,7 @@ namespace JSC {
 
         static PassRefPtr<UString::Rep> add(ExecState*, const UChar*, int length);
         static PassRefPtr<UString::Rep> add(JSGlobalData*, const UChar*, int length);
+        static PassRefPtr<UString::Rep> add(JSGlobalData*, const UChar*, int length, unsigned hash);
 
         static PassRefPtr<UString::Rep> add(ExecState* exec, UString::Rep* r)
         {
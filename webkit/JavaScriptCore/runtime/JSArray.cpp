@@ -723,6 +723,106 @@ void JSArray::sort(ExecState* exec)
     checkConsistency(SortConsistencyCheck);
 }
 
+class ArraySortComparator {
+public:
+    ArraySortComparator(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+        : m_exec(exec)
+        , m_compareFunction(compareFunction)
+        , m_compareCallType(callType)
+        , m_compareCallData(callData)
+        , m_globalThisValue(exec->globalThisValue())
+    {
+        if (callType == CallTypeJS)
+            m_cachedCall.set(new CachedCall(exec, asFunction(compareFunction), 2, exec->exceptionSlot()));
+    }
+
+    // true if b has to be ordered before a
+    bool greaterThan(JSValue a, JSValue b)
+    {
+        if (m_exec->hadException())
+            return false;
+
+        double compareResult;
+        if (m_cachedCall) {
+            m_cachedCall->setThis(m_globalThisValue);
+            m_cachedCall->setArgument(0, a);
+            m_cachedCall->setArgument(1, b);
+            compareResult = m_cachedCall->call().toNumber(m_cachedCall->newCallFrame(m_exec));
+        } else {
+            MarkedArgumentBuffer arguments;
+            arguments.append(a);
+            arguments.append(b);
+            compareResult = call(m_exec, m_compareFunction, m_compareCallType, m_compareCallData, m_globalThisValue, arguments).toNumber(m_exec);
+        }
+        return compareResult > 0;
+    }
+
+private:
+    ExecState* m_exec;
+    JSValue m_compareFunction;
+    CallType m_compareCallType;
+    const CallData& m_compareCallData;
+    JSValue m_globalThisValue;
+    OwnPtr<CachedCall> m_cachedCall;
+};
+
+void JSArray::mergeSortVector(ExecState* exec, JSValue compareFunction, CallType callType, const CallData& callData)
+{
+    ASSERT(!m_storage->m_sparseValueMap);
+
+    unsigned lengthNotIncludingUndefined = compactForSorting();
+    if (lengthNotIncludingUndefined < 2)
+        return;
+
+    // The compare function can change the array under us, so sort copies
+    // of the values, and keep them alive in a MarkedArgumentBuffer while
+    // the compare function runs.
+    Vector<JSValue> values(lengthNotIncludingUndefined);
+    Vector<JSValue> scratch(lengthNotIncludingUndefined);
+    if (!values.begin() || !scratch.begin()) {
+        throwOutOfMemoryError(exec);
+        return;
+    }
+    MarkedArgumentBuffer protectedValues;
+    for (unsigned i = 0; i < lengthNotIncludingUndefined; ++i) {
+        values[i] = m_storage->m_vector[i];
+        protectedValues.append(values[i]);
+    }
+
+    // A bottom up merge sort, which is stable and, unlike the AVL tree
+    // the sparse case uses, needs only one comparison per run boundary
+    // for input that is already in order.
+    ArraySortComparator comparator(exec, compareFunction, callType, callData);
+    JSValue* source = values.begin();
+    JSValue* destination = scratch.begin();
+    for (unsigned width = 1; width < lengthNotIncludingUndefined; width *= 2) {
+        for (unsigned low = 0; low < lengthNotIncludingUndefined; low += 2 * width) {
+            unsigned middle = min(low + width, lengthNotIncludingUndefined);
+            unsigned high = min(low + 2 * width, lengthNotIncludingUndefined);
+            unsigned i = low;
+            unsigned j = middle;
+            unsigned k = low;
+            if (middle < high && comparator.greaterThan(source[middle - 1], source[middle])) {
+                while (i < middle && j < high)
+                    destination[k++] = comparator.greaterThan(source[i], source[j]) ? source[j++] : source[i++];
+            }
+            while (i < middle)
+                destination[k++] = source[i++];
+            while (j < high)
+                destination[k++] = source[j++];
+        }
+        std::swap(source, destination);
+    }
+
+    // FIXME: If the compare function changed the array, the values copied
+    // back here may not be the ones it now holds.
+    unsigned copyLength = min(lengthNotIncludingUndefined, min(m_storage->m_length, m_vectorLength));
+    for (unsigned i = 0; i < copyLength; ++i)
+        m_storage->m_vector[i] = source[i];
+
+    checkConsistency(SortConsistencyCheck);
+}
+
 struct AVLTreeNodeForArrayCompare {
     JSValue value;
 
@@ -816,6 +916,11 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
     if (!m_storage->m_length)
         return;
 
+    if (!m_storage->m_sparseValueMap) {
+        mergeSortVector(exec, compareFunction, callType, callData);
+        return;
+    }
+
     unsigned usedVectorLength = min(m_storage->m_length, m_vectorLength);
 
     AVLTree<AVLTreeAbstractorForArrayCompare, 44> tree; // Depth 44 is enough for 2^31 items
@@ -910,6 +1015,38 @@ void JSArray::sort(ExecState* exec, JSValue compareFunction, CallType callType,
     checkConsistency(SortConsistencyCheck);
 }
 
+bool JSArray::spliceDense(unsigned begin, unsigned deleteCount, const ArgList& items)
+{
+    checkConsistency();
+
+    ArrayStorage* storage = m_storage;
+    unsigned length = storage->m_length;
+    if (storage->m_sparseValueMap || length > m_vectorLength || storage->m_numValuesInVector != length)
+        return false;
+
+    ASSERT(begin <= length && deleteCount <= length - begin);
+    unsigned itemCount = items.size();
+    unsigned newLength = length - deleteCount + itemCount;
+    if (newLength > m_vectorLength) {
+        if (newLength > MAX_STORAGE_VECTOR_LENGTH || !increaseVectorLength(newLength))
+            return false;
+        storage = m_storage;
+    }
+
+    JSValue* vector = storage->m_vector;
+    memmove(vector + begin + itemCount, vector + begin + deleteCount, (length - begin - deleteCount) * sizeof(JSValue));
+    for (unsigned i = 0; i < itemCount; ++i)
+        vector[begin + i] = items.at(i);
+    for (unsigned i = newLength; i < length; ++i)
+        vector[i] = JSValue();
+
+    storage->m_length = newLength;
+    storage->m_numValuesInVector = newLength;
+
+    checkConsistency();
+    return true;
+}
+
 void JSArray::fillArgList(ExecState* exec, MarkedArgumentBuffer& args)
 {
     JSValue* vector = m_storage->m_vector;
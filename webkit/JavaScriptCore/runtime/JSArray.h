@@ -45,6 +45,11 @@ namespace JSC {
         void push(ExecState*, JSValue);
         JSValue pop();
 
+        // Replaces the deleteCount values at begin with items, moving the
+        // values after them in one go. Returns false, without changing the
+        // array, unless every index below length() is in the storage vector.
+        bool spliceDense(unsigned begin, unsigned deleteCount, const ArgList& items);
+
         bool canGetIndex(unsigned i) { return i < m_vectorLength && m_storage->m_vector[i]; }
         JSValue getIndex(unsigned i)
         {
@@ -95,6 +100,7 @@ namespace JSC {
         bool increaseVectorLength(unsigned newLength);
         
         unsigned compactForSorting();
+        void mergeSortVector(ExecState*, JSValue compareFunction, CallType, const CallData&);
 
         enum ConsistencyCheckType { NormalConsistencyCheck, DestructorConsistencyCheck, SortConsistencyCheck };
         void checkConsistency(ConsistencyCheckType = NormalConsistencyCheck);
@@ -153,6 +159,11 @@ namespace JSC {
 #endif
             return;
         }
+#if ENABLE(JSC_GENERATIONAL_GC)
+        // Overridden markChildren may trace slots that are written without
+        // the write barrier, so young collections trace these cells again.
+        Heap::rememberCell(cell);
+#endif
         if (cell->vptr() == m_jsArrayVPtr) {
             asArray(cell)->markChildrenDirect(*this);
             return;
@@ -202,6 +213,38 @@ namespace JSC {
                 markChildren(m_values.removeLast());
         }
     }
+
+    inline bool MarkStack::drainIncrementally(size_t cellLimit)
+    {
+        ASSERT(m_markSets.isEmpty());
+        for (size_t i = 0; i < cellLimit && !m_values.isEmpty(); ++i) {
+            markChildren(m_values.removeLast());
+            // Mark sets point into storage that the mutator may reallocate
+            // before the next call, so they are never left on the stack.
+            drainMarkSets();
+        }
+        return m_values.isEmpty();
+    }
+
+    inline void MarkStack::drainMarkSets()
+    {
+        while (!m_markSets.isEmpty()) {
+            MarkSet current = m_markSets.removeLast();
+            for (JSValue* value = current.m_values; value != current.m_end; ++value) {
+                if (*value)
+                    append(*value);
+            }
+        }
+    }
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+    inline bool MarkStack::canMarkChildrenOnAnyThread(JSCell* cell)
+    {
+        // Both only read the cell's prototype and storage; overridden
+        // markChildren may read DOM or other state owned by the main thread.
+        return !cell->structure()->typeInfo().overridesMarkChildren() || cell->vptr() == m_jsArrayVPtr;
+    }
+#endif
     
 } // namespace JSC
 
@@ -309,9 +309,15 @@ namespace JSC {
     {
         ASSERT(!m_isCheckingForDefaultMarkViolation);
         ASSERT(cell);
+#if ENABLE(JSC_PARALLEL_MARKING)
+        // Another marking thread may be appending the same cell.
+        if (!Heap::testAndMarkCell(cell))
+            return;
+#else
         if (Heap::isCellMarked(cell))
             return;
         Heap::markCell(cell);
+#endif
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
@@ -323,6 +329,25 @@ namespace JSC {
             append(value.asCell());
     }
 
+    inline void MarkStack::appendChildren(JSCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+
+#if ENABLE(JSC_GENERATIONAL_GC)
+    inline void Heap::writeBarrier(const JSCell* owner, JSValue value)
+    {
+        if (value.isCell())
+            writeBarrier(owner);
+    }
+#else
+    inline void Heap::writeBarrier(const JSCell*, JSValue)
+    {
+    }
+#endif
+
     inline Heap* Heap::heap(JSValue v)
     {
         if (!v.isCell())
@@ -10,6 +10,9 @@
 #include "JSValue.h"
 #include "MarkStack.h"
 #include "NumericStrings.h"
+#include "PropertyLookupCache.h"
+#include "RegExpCache.h"
+#include "SamplingProfiler.h"
 #include "SmallStrings.h"
 #include "TimeoutChecker.h"
 #include "WeakRandom.h"
@@ -37,6 +40,9 @@ namespace JSC {
     struct HashTable;
     struct Instruction;    
 
+    // DST offsets for the last few years asked about, one direct mapped
+    // slot per year. Each year is worked out with localtime once, after
+    // which lookups are plain arithmetic.
     struct DSTOffsetCache {
         DSTOffsetCache()
         {
@@ -45,22 +51,35 @@ namespace JSC {
         
         void reset()
         {
-            offset = 0.0;
-            start = 0.0;
-            end = -1.0;
-            increment = 0.0;
+            for (size_t i = 0; i < yearCount; ++i)
+                years[i].year = 0;
         }
 
-        double offset;
-        double start;
-        double end;
-        double increment;
+        // Relies on there being at most one offset change per month.
+        struct Year {
+            int year; // 0 for an unused slot
+            double utcOffset;
+            // the offset at the start of each month
+            double monthOffset[12];
+            // when the offset changes within each month, in ms since the
+            // epoch, or +Infinity if it doesn't, and the offset after that
+            double changeTime[12];
+            double changeOffset[12];
+        };
+
+        static const size_t yearCount = 4;
+        Year years[yearCount];
     };
 
     class JSGlobalData : public RefCounted<JSGlobalData> {
     public:
         struct ClientData {
             virtual ~ClientData() = 0;
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+            // Should arrange for heap.markIncrementally() to be called from
+            // the event loop until it returns true. Returns false if it can't.
+            virtual bool scheduleIncrementalMarking() { return false; }
+#endif
         };
 
         static bool sharedInstanceExists();
@@ -115,10 +134,13 @@ namespace JSC {
         SmallStrings smallStrings;
         NumericStrings numericStrings;
         DateInstanceCache dateInstanceCache;
+        PropertyLookupCache propertyLookupCache;
         
 #if ENABLE(ASSEMBLER)
         ExecutableAllocator executableAllocator;
 #endif
+        // After executableAllocator, so that the RegExps' code is freed first.
+        RegExpCache regExpCache;
 
         Lexer* lexer;
         Parser* parser;
@@ -127,6 +149,8 @@ namespace JSC {
         JITThunks jitStubs;
 #endif
         TimeoutChecker timeoutChecker;
+        // Sampled by timeoutChecker, which checks in more often while it runs
+        SamplingProfiler samplingProfiler;
         Heap heap;
 
         JSValue exception;
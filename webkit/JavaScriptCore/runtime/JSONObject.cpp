@@ -68,6 +68,7 @@ private:
     friend class Holder;
 
     static void appendQuotedString(StringBuilder&, const UString&);
+    PassRefPtr<PropertyNameArrayData> ownPropertyNames(JSObject*);
 
     JSValue toJSON(JSValue, const PropertyNameForFunctionCall&);
 
@@ -90,6 +91,8 @@ private:
 
     HashSet<JSObject*> m_holderCycleDetector;
     Vector<Holder, 16> m_holderStack;
+    // The property names of objects whose Structure alone determines them.
+    HashMap<RefPtr<Structure>, RefPtr<PropertyNameArrayData> > m_structurePropertyNames;
     UString m_repeatedGap;
     UString m_indent;
 };
@@ -252,9 +255,6 @@ void Stringifier::appendQuotedString(StringBuilder& builder, const UString& valu
 {
     int length = value.size();
 
-    // String length plus 2 for quote marks plus 8 so we can accomodate a few escaped characters.
-    builder.reserveCapacity(builder.size() + length + 2 + 8);
-
     builder.append('"');
 
     const UChar* data = value.data();
@@ -306,6 +306,26 @@ void Stringifier::appendQuotedString(StringBuilder& builder, const UString& valu
     builder.append('"');
 }
 
+PassRefPtr<PropertyNameArrayData> Stringifier::ownPropertyNames(JSObject* object)
+{
+    // Objects that don't add property names of their own have exactly the
+    // names their Structure holds, so objects of the same shape can share
+    // one list.
+    Structure* structure = object->structure();
+    bool isCacheable = !structure->typeInfo().overridesGetPropertyNames() && !structure->isDictionary();
+    if (isCacheable) {
+        if (PropertyNameArrayData* propertyNames = m_structurePropertyNames.get(structure))
+            return propertyNames;
+    }
+
+    PropertyNameArray objectPropertyNames(m_exec);
+    object->getOwnPropertyNames(m_exec, objectPropertyNames);
+    RefPtr<PropertyNameArrayData> propertyNames = objectPropertyNames.releaseData();
+    if (isCacheable)
+        m_structurePropertyNames.set(structure, propertyNames);
+    return propertyNames.release();
+}
+
 inline JSValue Stringifier::toJSON(JSValue value, const PropertyNameForFunctionCall& propertyName)
 {
     ASSERT(!m_exec->hadException());
@@ -476,11 +496,8 @@ bool Stringifier::Holder::appendNextProperty(Stringifier& stringifier, StringBui
         } else {
             if (stringifier.m_usingArrayReplacer)
                 m_propertyNames = stringifier.m_arrayReplacerPropertyNames.data();
-            else {
-                PropertyNameArray objectPropertyNames(exec);
-                m_object->getOwnPropertyNames(exec, objectPropertyNames);
-                m_propertyNames = objectPropertyNames.releaseData();
-            }
+            else
+                m_propertyNames = stringifier.ownPropertyNames(m_object);
             m_size = m_propertyNames->propertyNameVector().size();
             builder.append('{');
         }
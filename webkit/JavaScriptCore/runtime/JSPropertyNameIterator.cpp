@@ -43,9 +43,8 @@ JSPropertyNameIterator* JSPropertyNameIterator::create(ExecState* exec, JSObject
 
     JSPropertyNameIterator* jsPropertyNameIterator = new (exec) JSPropertyNameIterator(exec, propertyNames.data(), numCacheableSlots);
 
-    if (o->structure()->isDictionary())
-        return jsPropertyNameIterator;
-
+    // Dictionaries are cached too: adding or removing one of their
+    // properties drops the cache, see Structure::invalidateEnumerationCache.
     if (o->structure()->typeInfo().overridesGetPropertyNames())
         return jsPropertyNameIterator;
     
@@ -59,7 +59,6 @@ namespace JSC {
 
     inline void Structure::setEnumerationCache(JSPropertyNameIterator* enumerationCache)
     {
-        ASSERT(!isDictionary());
         m_enumerationCache = enumerationCache;
     }
 
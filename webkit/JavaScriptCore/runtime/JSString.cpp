@@ -8,6 +8,10 @@
 #include "Operations.h"
 #include "StringObject.h"
 #include "StringPrototype.h"
+#include <algorithm>
+
+using std::max;
+using std::min;
 
 namespace JSC {
 
@@ -119,6 +123,322 @@ void JSString::resolveRope(ExecState* exec) const
     }
 }
 
+// Visits the strings in a rope from left to right, skipping those that end
+// before start.
+class RopeStringIterator {
+public:
+    RopeStringIterator(JSString::Rope::Fiber* fibers, unsigned fiberCount, unsigned start)
+        : m_position(0)
+        , m_start(start)
+    {
+        for (unsigned i = fiberCount; i; --i)
+            m_workQueue.append(fibers[i - 1]);
+    }
+
+    // Returns 0 after the last string. position is the offset of the string in the rope.
+    UString::Rep* next(unsigned& position)
+    {
+        while (!m_workQueue.isEmpty()) {
+            JSString::Rope::Fiber fiber = m_workQueue.last();
+            m_workQueue.removeLast();
+
+            unsigned length = fiber.isString() ? fiber.string()->size() : fiber.rope()->stringLength();
+            if (m_position + length <= m_start) {
+                m_position += length;
+                continue;
+            }
+            if (fiber.isString()) {
+                position = m_position;
+                m_position += length;
+                return fiber.string();
+            }
+            JSString::Rope* rope = fiber.rope();
+            for (unsigned i = rope->ropeLength(); i; --i)
+                m_workQueue.append(rope->fibers(i - 1));
+        }
+        return 0;
+    }
+
+private:
+    Vector<JSString::Rope::Fiber, 32> m_workQueue;
+    unsigned m_position;
+    unsigned m_start;
+};
+
+UChar JSString::characterAt(ExecState* exec, unsigned index)
+{
+    ASSERT(index < m_stringLength);
+
+    if (isRope()) {
+        // Walk down to the string holding the character, unless that takes
+        // so long that resolving the rope for the next access too is cheaper.
+        unsigned offset = index;
+        Rope::Fiber* fibers = m_fibers;
+        unsigned fiberCount = m_ropeLength;
+        unsigned i = 0;
+        for (unsigned budget = s_maxFibersToWalk; i < fiberCount && budget; --budget) {
+            Rope::Fiber& fiber = fibers[i];
+            if (fiber.isString()) {
+                UString::Rep* string = fiber.string();
+                if (offset < static_cast<unsigned>(string->size()))
+                    return string->data()[offset];
+                offset -= string->size();
+                ++i;
+                continue;
+            }
+            Rope* rope = fiber.rope();
+            if (offset >= rope->stringLength()) {
+                offset -= rope->stringLength();
+                ++i;
+                continue;
+            }
+            fibers = &rope->fibers(0);
+            fiberCount = rope->ropeLength();
+            i = 0;
+        }
+    }
+
+    const UString& string = value(exec);
+    if (index >= static_cast<unsigned>(string.size()))
+        return 0; // out of memory resolving the rope
+    return string.data()[index];
+}
+
+JSString* JSString::substring(ExecState* exec, unsigned offset, unsigned length)
+{
+    ASSERT(offset + length <= m_stringLength);
+
+    if (!offset && length == m_stringLength)
+        return this;
+    if (!isRope())
+        return jsSubstring(exec, m_value, offset, length);
+    if (!length)
+        return jsEmptyString(exec);
+    if (length == 1)
+        return jsSingleCharacterString(exec, characterAt(exec, offset));
+
+    // Share the strings of the rope that the substring covers, rather than
+    // resolve the whole rope.
+    unsigned end = offset + length;
+    RopeStringIterator iterator(m_fibers, m_ropeLength, offset);
+    unsigned position;
+    UString::Rep* string = iterator.next(position);
+    ASSERT(string);
+    if (position + string->size() >= end)
+        return jsSubstring(exec, UString(string), offset - position, length);
+
+    Vector<UString, s_maxSubstringFibers> strings;
+    for (; string && position < end; string = iterator.next(position)) {
+        if (strings.size() == s_maxSubstringFibers)
+            break;
+        unsigned from = max(offset, position) - position;
+        unsigned to = min(end, position + string->size()) - position;
+        if (!from && to == static_cast<unsigned>(string->size()))
+            strings.append(UString(string));
+        else
+            strings.append(UString(UString::Rep::create(string, from, to - from)));
+    }
+
+    if (!string || position >= end) {
+        if (RefPtr<Rope> rope = Rope::createOrNull(strings.size())) {
+            unsigned index = 0;
+            for (size_t i = 0; i < strings.size(); ++i)
+                rope->append(index, strings[i]);
+            ASSERT(rope->stringLength() == length);
+            JSGlobalData* globalData = &exec->globalData();
+            return new (globalData) JSString(globalData, rope.release());
+        }
+    }
+
+    const UString& resolved = value(exec);
+    if (end > static_cast<unsigned>(resolved.size()))
+        return jsEmptyString(exec); // out of memory resolving the rope
+    return jsSubstring(exec, resolved, offset, length);
+}
+
+int JSString::find(ExecState*, const UString& pattern, int start)
+{
+    ASSERT(start >= 0 && static_cast<unsigned>(start) <= m_stringLength);
+
+    if (!isRope())
+        return m_value.find(pattern, start);
+
+    unsigned patternLength = pattern.size();
+    if (!patternLength)
+        return start;
+    const UChar* patternData = pattern.data();
+
+    // The last patternLength - 1 characters seen, which is where matches that
+    // run on into the next string start.
+    Vector<UChar, 32> tail;
+    unsigned tailPosition = 0;
+
+    RopeStringIterator iterator(m_fibers, m_ropeLength, start);
+    unsigned position;
+    while (UString::Rep* string = iterator.next(position)) {
+        const UChar* data = string->data();
+        unsigned length = string->size();
+
+        // A match that starts in the tail but needs more than this string
+        // still starts in the next tail, so is tried then.
+        unsigned i = static_cast<unsigned>(start) > tailPosition ? start - tailPosition : 0;
+        for (; i < tail.size(); ++i) {
+            unsigned fromTail = tail.size() - i;
+            if (patternLength - fromTail > length)
+                continue;
+            if (!memcmp(tail.data() + i, patternData, fromTail * sizeof(UChar)) && !memcmp(data, patternData + fromTail, (patternLength - fromTail) * sizeof(UChar)))
+                return tailPosition + i;
+        }
+
+        if (length >= patternLength) {
+            int match = UString(string).find(pattern, static_cast<unsigned>(start) > position ? start - position : 0);
+            if (match >= 0)
+                return position + match;
+        }
+
+        if (length >= patternLength - 1) {
+            tail.clear();
+            tail.append(data + length - (patternLength - 1), patternLength - 1);
+            tailPosition = position + length - (patternLength - 1);
+        } else {
+            if (tail.isEmpty())
+                tailPosition = position;
+            tail.append(data, length);
+            if (tail.size() > patternLength - 1) {
+                size_t excess = tail.size() - (patternLength - 1);
+                tail.remove(0, excess);
+                tailPosition += excess;
+            }
+        }
+    }
+    return -1;
+}
+
+// Fibonacci numbers from F(2). A rope of depth n is balanced if it is at
+// least F(n + 2) characters long.
+static const unsigned fibonacci[] = {
+    1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987, 1597, 2584, 4181, 6765, 10946, 17711, 28657,
+    46368, 75025, 121393, 196418, 317811, 514229, 832040, 1346269, 2178309, 3524578, 5702887, 9227465, 14930352,
+    24157817, 39088169, 63245986, 102334155, 165580141, 267914296, 433494437, 701408733, 1134903170, 1836311903,
+    2971215073u
+};
+// Slot i of the forest holds a fiber between fibonacci[i] and fibonacci[i + 1]
+// characters long, or nothing. Higher slots hold earlier parts of the string.
+static const size_t forestSize = sizeof(fibonacci) / sizeof(fibonacci[0]) - 1;
+
+static inline unsigned fiberLength(JSString::Rope::Fiber fiber)
+{
+    return fiber.isString() ? fiber.string()->size() : fiber.rope()->stringLength();
+}
+
+static inline bool isNull(JSString::Rope::Fiber fiber)
+{
+    return !fiber.nonFiber();
+}
+
+static inline bool isBalanced(JSString::Rope* rope)
+{
+    return rope->depth() <= forestSize && rope->stringLength() >= fibonacci[rope->depth()];
+}
+
+// Takes over the references to left and right. Returns a null fiber if out of memory.
+static JSString::Rope::Fiber concatenate(JSString::Rope::Fiber left, JSString::Rope::Fiber right)
+{
+    RefPtr<JSString::Rope> rope = JSString::Rope::createOrNull(2);
+    if (rope) {
+        unsigned index = 0;
+        rope->append(index, left);
+        rope->append(index, right);
+    }
+    left.deref();
+    right.deref();
+    if (!rope)
+        return JSString::Rope::Fiber();
+    return JSString::Rope::Fiber(rope.release().releaseRef());
+}
+
+// Takes over the reference to fiber. Returns false if out of memory.
+static bool addToForest(JSString::Rope::Fiber* forest, JSString::Rope::Fiber fiber)
+{
+    unsigned length = fiberLength(fiber);
+
+    // Everything in the slots below the one for fiber comes before it.
+    JSString::Rope::Fiber sum;
+    size_t i = 0;
+    for (; i + 1 < forestSize && length >= fibonacci[i + 1]; ++i) {
+        if (isNull(forest[i]))
+            continue;
+        sum = isNull(sum) ? forest[i] : concatenate(forest[i], sum);
+        forest[i] = JSString::Rope::Fiber();
+        if (isNull(sum)) {
+            fiber.deref();
+            return false;
+        }
+    }
+    sum = isNull(sum) ? fiber : concatenate(sum, fiber);
+
+    // Carry the sum up until it fits in an empty slot.
+    for (; !isNull(sum); ++i) {
+        if (!isNull(forest[i])) {
+            sum = concatenate(forest[i], sum);
+            forest[i] = JSString::Rope::Fiber();
+            if (isNull(sum))
+                break;
+        }
+        if (i + 1 == forestSize || fiberLength(sum) < fibonacci[i + 1]) {
+            forest[i] = sum;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rebuilds a deep rope as per Boehm, Atkinson and Plass, "Ropes: an
+// Alternative to Strings". Balanced parts of the rope are reused as they
+// are, so rebalancing a string built by appending only visits what was
+// appended since it was last rebalanced.
+void JSString::balanceRope()
+{
+    ASSERT(m_ropeLength == 1 && m_fibers[0].isRope());
+    if (isBalanced(m_fibers[0].rope()))
+        return;
+
+    Rope::Fiber forest[forestSize];
+    bool succeeded = true;
+
+    Vector<Rope::Fiber, 32> workQueue;
+    workQueue.append(m_fibers[0]);
+    while (succeeded && !workQueue.isEmpty()) {
+        Rope::Fiber fiber = workQueue.last();
+        workQueue.removeLast();
+        if (fiber.isRope() && !isBalanced(fiber.rope())) {
+            Rope* rope = fiber.rope();
+            for (unsigned i = rope->ropeLength(); i; --i)
+                workQueue.append(rope->fibers(i - 1));
+            continue;
+        }
+        if (fiberLength(fiber))
+            succeeded = addToForest(forest, fiber.ref());
+    }
+
+    Rope::Fiber balanced;
+    for (size_t i = 0; i < forestSize; ++i) {
+        if (isNull(forest[i]))
+            continue;
+        if (succeeded)
+            balanced = isNull(balanced) ? forest[i] : concatenate(forest[i], balanced);
+        else
+            forest[i].deref();
+        succeeded = succeeded && !isNull(balanced);
+    }
+
+    // Keep the rope as it is if we ran out of memory.
+    if (!succeeded || isNull(balanced))
+        return;
+    m_fibers[0].deref();
+    m_fibers[0] = balanced;
+}
+
 JSValue JSString::toPrimitive(ExecState*, PreferredPrimitiveType) const
 {
     return const_cast<JSString*>(this);
@@ -202,7 +522,7 @@ bool JSString::getStringPropertyDescriptor(ExecState* exec, const Identifier& pr
     bool isStrictUInt32;
     unsigned i = propertyName.toStrictUInt32(&isStrictUInt32);
     if (isStrictUInt32 && i < m_stringLength) {
-        descriptor.setDescriptor(jsSingleCharacterSubstring(exec, value(exec), i), DontDelete | ReadOnly);
+        descriptor.setDescriptor(getIndex(exec, i), DontDelete | ReadOnly);
         return true;
     }
     
@@ -116,6 +116,8 @@ namespace JSC {
             {
                 m_fibers[index++] = fiber;
                 m_stringLength += fiber.refAndGetLength();
+                if (fiber.isRope() && fiber.rope()->depth() >= m_depth)
+                    m_depth = fiber.rope()->depth() + 1;
             }
             void append(unsigned &index, const UString& string)
             {
@@ -134,14 +136,17 @@ namespace JSC {
 
             unsigned ropeLength() { return m_ropeLength; }
             unsigned stringLength() { return m_stringLength; }
+            // 1 for a Rope of strings, one more than its deepest Rope otherwise.
+            unsigned depth() { return m_depth; }
             Fiber& fibers(unsigned index) { return m_fibers[index]; }
 
         private:
-            Rope(unsigned ropeLength) : m_ropeLength(ropeLength), m_stringLength(0) {}
+            Rope(unsigned ropeLength) : m_ropeLength(ropeLength), m_stringLength(0), m_depth(1) {}
             void* operator new(size_t, void* inPlace) { return inPlace; }
             
             unsigned m_ropeLength;
             unsigned m_stringLength;
+            unsigned m_depth;
             Fiber m_fibers[1];
         };
 
@@ -175,6 +180,8 @@ namespace JSC {
             , m_ropeLength(1)
         {
             m_fibers[0] = rope.releaseRef();
+            if (UNLIKELY(m_fibers[0].rope()->depth() > s_maxRopeDepth))
+                balanceRope();
         }
         // This constructor constructs a new string by concatenating s1 & s2.
         // This should only be called with ropeLength <= 3.
@@ -277,6 +284,11 @@ namespace JSC {
         bool canGetIndex(unsigned i) { return i < m_stringLength; }
         JSString* getIndex(ExecState*, unsigned);
 
+        // These work on a rope without resolving it where they can.
+        UChar characterAt(ExecState*, unsigned index);
+        JSString* substring(ExecState*, unsigned offset, unsigned length);
+        int find(ExecState*, const UString& pattern, int start);
+
         static PassRefPtr<Structure> createStructure(JSValue proto) { return Structure::create(proto, TypeInfo(StringType, OverridesGetOwnPropertySlot | NeedsThisConversion), AnonymousSlotCount); }
 
     private:
@@ -288,6 +300,7 @@ namespace JSC {
         }
 
         void resolveRope(ExecState*) const;
+        void balanceRope();
 
         void appendStringInConstruct(unsigned& index, const UString& string)
         {
@@ -335,6 +348,13 @@ namespace JSC {
         virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
 
         static const unsigned s_maxInternalRopeLength = 3;
+        // Ropes deeper than this are rebalanced when they are created, which
+        // keeps walking them cheap however the string was built.
+        static const unsigned s_maxRopeDepth = 32;
+        // characterAt resolves the rope rather than walk more fibers than this.
+        static const unsigned s_maxFibersToWalk = 64;
+        // substring resolves the rope rather than share more strings than this.
+        static const unsigned s_maxSubstringFibers = 32;
 
         // A string is represented either by a UString or a Rope.
         unsigned m_stringLength;
@@ -410,7 +430,9 @@ namespace JSC {
     inline JSString* JSString::getIndex(ExecState* exec, unsigned i)
     {
         ASSERT(canGetIndex(i));
-        return jsSingleCharacterSubstring(&exec->globalData(), value(exec), i);
+        if (isRope())
+            return jsSingleCharacterString(exec, characterAt(exec, i));
+        return jsSingleCharacterSubstring(&exec->globalData(), m_value, i);
     }
 
     inline JSString* jsString(JSGlobalData* globalData, const UString& s)
@@ -480,7 +502,7 @@ namespace JSC {
         bool isStrictUInt32;
         unsigned i = propertyName.toStrictUInt32(&isStrictUInt32);
         if (isStrictUInt32 && i < m_stringLength) {
-            slot.setValue(jsSingleCharacterSubstring(exec, value(exec), i));
+            slot.setValue(getIndex(exec, i));
             return true;
         }
 
@@ -490,7 +512,7 @@ namespace JSC {
     ALWAYS_INLINE bool JSString::getStringPropertySlot(ExecState* exec, unsigned propertyName, PropertySlot& slot)
     {
         if (propertyName < m_stringLength) {
-            slot.setValue(jsSingleCharacterSubstring(exec, value(exec), propertyName));
+            slot.setValue(getIndex(exec, propertyName));
             return true;
         }
 
@@ -111,7 +111,20 @@ template <LiteralParser::ParserMode mode> static inline bool isSafeStringCharact
 template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType LiteralParser::Lexer::lexString(LiteralParserToken& token)
 {
     ++m_ptr;
-    const UChar* runStart;
+    const UChar* runStart = m_ptr;
+    while (m_ptr < m_end && isSafeStringCharacter<mode>(*m_ptr))
+        ++m_ptr;
+    if (m_ptr < m_end && *m_ptr == '"') {
+        // Most strings have no escapes, so can be used straight from the source.
+        token.stringBuffer = runStart;
+        token.stringLength = m_ptr - runStart;
+        token.stringToken = UString();
+        token.type = TokString;
+        token.end = ++m_ptr;
+        return TokString;
+    }
+
+    m_ptr = runStart;
     StringBuilder builder;
     do {
         runStart = m_ptr;
@@ -178,6 +191,8 @@ template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType Litera
         return TokError;
 
     token.stringToken = builder.build();
+    token.stringBuffer = token.stringToken.data();
+    token.stringLength = token.stringToken.size();
     token.type = TokString;
     token.end = ++m_ptr;
     return TokString;
@@ -201,6 +216,7 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
 
     if (m_ptr < m_end && *m_ptr == '-') // -?
         ++m_ptr;
+    const UChar* integerStart = m_ptr;
     
     // (0 | [1-9][0-9]*)
     if (m_ptr < m_end && *m_ptr == '0') // 0
@@ -212,6 +228,7 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
             ++m_ptr;
     } else
         return TokError;
+    const UChar* integerEnd = m_ptr;
 
     // ('.' [0-9]+)?
     if (m_ptr < m_end && *m_ptr == '.') {
@@ -244,6 +261,17 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     
     token.type = TokNumber;
     token.end = m_ptr;
+
+    // Integers short enough to be exact in a double don't need strtod.
+    static const int maximumExactIntegerLength = 15;
+    if (integerEnd == m_ptr && integerEnd - integerStart <= maximumExactIntegerLength) {
+        double result = 0;
+        for (const UChar* digit = integerStart; digit < integerEnd; ++digit)
+            result = result * 10 + (*digit - '0');
+        token.numberToken = integerStart == token.start ? result : -result;
+        return TokNumber;
+    }
+
     Vector<char, 64> buffer(token.end - token.start + 1);
     int i;
     for (i = 0; i < token.end - token.start; i++) {
@@ -257,6 +285,23 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     return TokNumber;
 }
 
+UString LiteralParser::stringValue(const Lexer::LiteralParserToken& token)
+{
+    if (!token.stringToken.isNull())
+        return token.stringToken;
+    return UString(token.stringBuffer, token.stringLength);
+}
+
+JSValue LiteralParser::finishArray(MarkedArgumentBuffer& elementStack, Vector<size_t, 16>& arrayStartStack)
+{
+    size_t start = arrayStartStack.last();
+    arrayStartStack.removeLast();
+    JSArray* array = constructArray(m_exec, ArgList(elementStack.begin() + start, elementStack.size() - start));
+    while (elementStack.size() > start)
+        elementStack.removeLast();
+    return array;
+}
+
 JSValue LiteralParser::parse(ParserState initialState)
 {
     ParserState state = initialState;
@@ -264,12 +309,15 @@ JSValue LiteralParser::parse(ParserState initialState)
     JSValue lastValue;
     Vector<ParserState, 16> stateStack;
     Vector<Identifier, 16> identifierStack;
+    // The elements of the arrays being parsed, which are only created once
+    // they are complete and so their length is known.
+    MarkedArgumentBuffer elementStack;
+    Vector<size_t, 16> arrayStartStack;
     while (1) {
         switch(state) {
             startParseArray:
             case StartParseArray: {
-                JSArray* array = constructEmptyArray(m_exec);
-                objectStack.append(array);
+                arrayStartStack.append(elementStack.size());
                 // fallthrough
             }
             doParseArrayStartExpression:
@@ -279,8 +327,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                     if (lastToken == TokComma)
                         return JSValue();
                     m_lexer.next();
-                    lastValue = objectStack.last();
-                    objectStack.removeLast();
+                    lastValue = finishArray(elementStack, arrayStartStack);
                     break;
                 }
 
@@ -288,7 +335,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                 goto startParseExpression;
             }
             case DoParseArrayEndExpression: {
-                 asArray(objectStack.last())->push(m_exec, lastValue);
+                elementStack.append(lastValue);
                 
                 if (m_lexer.currentToken().type == TokComma)
                     goto doParseArrayStartExpression;
@@ -297,8 +344,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                     return JSValue();
                 
                 m_lexer.next();
-                lastValue = objectStack.last();
-                objectStack.removeLast();
+                lastValue = finishArray(elementStack, arrayStartStack);
                 break;
             }
             startParseObject:
@@ -315,7 +361,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                         return JSValue();
                     
                     m_lexer.next();
-                    identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
+                    identifierStack.append(Identifier(m_exec, identifierToken.stringBuffer, identifierToken.stringLength));
                     stateStack.append(DoParseObjectEndExpression);
                     goto startParseExpression;
                 } else if (type != TokRBrace) 
@@ -337,7 +383,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                     return JSValue();
 
                 m_lexer.next();
-                identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
+                identifierStack.append(Identifier(m_exec, identifierToken.stringBuffer, identifierToken.stringLength));
                 stateStack.append(DoParseObjectEndExpression);
                 goto startParseExpression;
             }
@@ -364,7 +410,7 @@ JSValue LiteralParser::parse(ParserState initialState)
                     case TokString: {
                         Lexer::LiteralParserToken stringToken = m_lexer.currentToken();
                         m_lexer.next();
-                        lastValue = jsString(m_exec, stringToken.stringToken);
+                        lastValue = jsString(m_exec, stringValue(stringToken));
                         break;
                     }
                     case TokNumber: {
@@ -9,6 +9,8 @@
 
 namespace JSC {
 
+    class MarkedArgumentBuffer;
+
     class LiteralParser {
     public:
         typedef enum { StrictJSON, NonStrictJSON } ParserMode;
@@ -43,6 +45,11 @@ namespace JSC {
                 TokenType type;
                 const UChar* start;
                 const UChar* end;
+                // The characters of a string, without quotes. When the string
+                // has no escapes these point into the source, and stringToken
+                // is null.
+                const UChar* stringBuffer;
+                unsigned stringLength;
                 UString stringToken;
                 double numberToken;
             };
@@ -77,6 +84,8 @@ namespace JSC {
         
         class StackGuard;
         JSValue parse(ParserState);
+        static UString stringValue(const Lexer::LiteralParserToken&);
+        JSValue finishArray(MarkedArgumentBuffer& elementStack, Vector<size_t, 16>& arrayStartStack);
 
         ExecState* m_exec;
         LiteralParser::Lexer m_lexer;
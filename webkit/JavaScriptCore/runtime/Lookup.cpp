@@ -17,8 +17,7 @@ void HashTable::createTable(JSGlobalData* globalData) const
         entries[i].setKey(0);
     for (int i = 0; values[i].key; ++i) {
         UString::Rep* identifier = Identifier::add(globalData, values[i].key).releaseRef();
-        int hashIndex = identifier->existingHash() & compactHashSizeMask;
-        HashEntry* entry = &entries[hashIndex];
+        HashEntry* entry = &entries[hashIndex(identifier)];
 
         if (entry->key()) {
             while (entry->next()) {
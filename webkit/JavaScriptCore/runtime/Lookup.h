@@ -93,6 +93,14 @@ namespace JSC {
 
         const HashTableValue* values; // Fixed values generated by script.
         mutable const HashEntry* table; // Table allocated at runtime.
+        // Where the slot starts in a key's hash. The script picks it, when it
+        // can, so that no two keys share a slot.
+        int hashShift;
+
+        ALWAYS_INLINE int hashIndex(UString::Rep* key) const
+        {
+            return (key->existingHash() >> hashShift) & compactHashSizeMask;
+        }
 
         ALWAYS_INLINE void initializeIfNeeded(JSGlobalData* globalData) const
         {
@@ -126,7 +134,7 @@ namespace JSC {
         {
             ASSERT(table);
 
-            const HashEntry* entry = &table[identifier.ustring().rep()->existingHash() & compactHashSizeMask];
+            const HashEntry* entry = &table[hashIndex(identifier.ustring().rep())];
 
             if (!entry->key())
                 return 0;
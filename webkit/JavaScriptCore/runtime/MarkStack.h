@@ -9,6 +9,7 @@
 namespace JSC {
 
     class JSGlobalData;
+    class ParallelMarker;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -25,6 +26,8 @@ namespace JSC {
 
         ALWAYS_INLINE void append(JSValue);
         void append(JSCell*);
+        // Traces the children of a cell that is already marked.
+        void appendChildren(JSCell*);
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -38,6 +41,15 @@ namespace JSC {
         }
 
         inline void drain();
+        // Traces at most about cellLimit queued cells. Returns true if the
+        // stack is empty.
+        inline bool drainIncrementally(size_t cellLimit);
+        // Drops everything queued, for a collection that clears the marks.
+        void clear()
+        {
+            m_values.clear();
+            m_markSets.clear();
+        }
         void compact();
 
         ~MarkStack()
@@ -47,7 +59,15 @@ namespace JSC {
         }
 
     private:
+#if ENABLE(JSC_PARALLEL_MARKING)
+        friend class ParallelMarker;
+        // true for cells that a helper thread may trace
+        bool canMarkChildrenOnAnyThread(JSCell*);
+#endif
         void markChildren(JSCell*);
+        // Marks the contents of the mark sets, queueing the cells found
+        // rather than tracing them.
+        void drainMarkSets();
 
         struct MarkSet {
             MarkSet(JSValue* values, JSValue* end, MarkSetProperties properties)
@@ -124,6 +144,8 @@ namespace JSC {
 
             inline size_t size() { return m_top; }
 
+            inline void clear() { m_top = 0; }
+
             inline void shrinkAllocation(size_t size)
             {
                 ASSERT(size <= m_allocated);
@@ -336,6 +336,9 @@ namespace JSC {
 
             cell = asCell(v);
 
+            if (cell->structure()->isThrashingDictionary())
+                return 0;
+
             // Since we're accessing a prototype in a loop, it's a good bet that it
             // should not be treated as a dictionary.
             if (cell->structure()->isDictionary()) {
@@ -0,0 +1,162 @@
+#include "config.h"
+#include "ParallelMarker.h"
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+
+#include "JSArray.h"
+#include "JSCell.h"
+#include <algorithm>
+#if OS(UNIX)
+#include <unistd.h>
+#endif
+
+using std::min;
+
+namespace JSC {
+
+// helper threads on top of the collecting one
+static const unsigned maxHelperThreads = 3;
+// cells moved into or out of the shared pool at a time
+static const size_t shareChunkSize = 64;
+
+static unsigned helperThreadCount()
+{
+#if OS(UNIX)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 1)
+        return min(static_cast<unsigned>(cores - 1), maxHelperThreads);
+#endif
+    return 0;
+}
+
+ParallelMarker::ParallelMarker(void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_activeHelpers(0)
+    , m_waitingMarkers(0)
+    , m_shuttingDown(false)
+{
+    unsigned count = helperThreadCount();
+    for (unsigned i = 0; i < count; ++i) {
+        ThreadIdentifier thread = createThread(helperThreadMain, this, "JavaScriptCore::Marking");
+        if (thread)
+            m_helpers.append(thread);
+    }
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_shuttingDown = true;
+        m_workAvailable.broadcast();
+    }
+    for (size_t i = 0; i < m_helpers.size(); ++i)
+        waitForThreadCompletion(m_helpers[i], 0);
+}
+
+void* ParallelMarker::helperThreadMain(void* marker)
+{
+    static_cast<ParallelMarker*>(marker)->runHelper();
+    return 0;
+}
+
+void ParallelMarker::runHelper()
+{
+    MarkStack markStack(m_jsArrayVPtr);
+    Vector<JSCell*> collectorThreadCells;
+
+    m_lock.lock();
+    while (true) {
+        ++m_waitingMarkers;
+        m_helperWaiting.signal();
+        while (!m_shuttingDown && !takeShared(markStack))
+            m_workAvailable.wait(m_lock);
+        --m_waitingMarkers;
+        if (m_shuttingDown)
+            break;
+        ++m_activeHelpers;
+        m_lock.unlock();
+
+        while (true) {
+            markStack.drainMarkSets();
+            if (markStack.m_values.isEmpty())
+                break;
+            if (markStack.m_values.size() > 2 * shareChunkSize && wantsWork())
+                share(markStack);
+            JSCell* cell = markStack.m_values.removeLast();
+            if (markStack.canMarkChildrenOnAnyThread(cell))
+                markStack.markChildren(cell);
+            else
+                collectorThreadCells.append(cell);
+        }
+
+        m_lock.lock();
+        m_collectorThreadCells.append(collectorThreadCells);
+        collectorThreadCells.clear();
+        --m_activeHelpers;
+    }
+    m_lock.unlock();
+}
+
+void ParallelMarker::share(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    for (size_t count = markStack.m_values.size() / 2; count; --count)
+        m_sharedCells.append(markStack.m_values.removeLast());
+    m_workAvailable.broadcast();
+    m_helperWaiting.signal();
+}
+
+bool ParallelMarker::takeShared(MarkStack& markStack)
+{
+    if (m_sharedCells.isEmpty())
+        return false;
+    for (size_t count = min(m_sharedCells.size(), shareChunkSize); count; --count) {
+        markStack.m_values.append(m_sharedCells.last());
+        m_sharedCells.removeLast();
+    }
+    return true;
+}
+
+bool ParallelMarker::takeWork(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    while (true) {
+        if (!m_collectorThreadCells.isEmpty()) {
+            for (size_t i = 0; i < m_collectorThreadCells.size(); ++i)
+                markStack.m_values.append(m_collectorThreadCells[i]);
+            m_collectorThreadCells.clear();
+            return true;
+        }
+        if (takeShared(markStack))
+            return true;
+        if (!m_activeHelpers)
+            return false;
+        ++m_waitingMarkers;
+        m_helperWaiting.wait(m_lock);
+        --m_waitingMarkers;
+    }
+}
+
+void ParallelMarker::drain(MarkStack& markStack)
+{
+    if (m_helpers.isEmpty()) {
+        markStack.drain();
+        return;
+    }
+
+    do {
+        while (true) {
+            markStack.drainMarkSets();
+            if (markStack.m_values.isEmpty())
+                break;
+            if (markStack.m_values.size() > 2 * shareChunkSize && wantsWork())
+                share(markStack);
+            markStack.markChildren(markStack.m_values.removeLast());
+        }
+    } while (takeWork(markStack));
+}
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_PARALLEL_MARKING)
@@ -0,0 +1,62 @@
+#ifndef ParallelMarker_h
+#define ParallelMarker_h
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+
+#include "MarkStack.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class JSCell;
+
+    // Helper threads that trace the collector's mark stack alongside the
+    // thread doing the collection. Helpers only trace cells whose children
+    // can be marked without running code outside JSC, that is plain objects
+    // and arrays; anything with its own markChildren is handed back to
+    // the collecting thread. Idle markers take work from a shared pool,
+    // which busy markers fill with half of their stacks.
+    class ParallelMarker : Noncopyable {
+    public:
+        ParallelMarker(void* jsArrayVPtr);
+        ~ParallelMarker();
+
+        // Empties markStack, with help from the helper threads if there are
+        // any. Must be called from the thread doing the collection.
+        void drain(MarkStack& markStack);
+
+    private:
+        static void* helperThreadMain(void*);
+        void runHelper();
+
+        // true if some marker is waiting for work
+        bool wantsWork() const { return m_waitingMarkers > 0; }
+        void share(MarkStack&);
+        // Moves up to a chunk of shared cells onto markStack. Call with
+        // m_lock held.
+        bool takeShared(MarkStack&);
+        // Waits for helpers to hand back cells or run out of work. Returns
+        // false once marking is done.
+        bool takeWork(MarkStack&);
+
+        void* m_jsArrayVPtr;
+
+        Mutex m_lock;
+        ThreadCondition m_workAvailable;
+        ThreadCondition m_helperWaiting;
+        Vector<JSCell*> m_sharedCells;
+        Vector<JSCell*> m_collectorThreadCells;
+
+        Vector<ThreadIdentifier> m_helpers;
+        unsigned m_activeHelpers;
+        volatile int m_waitingMarkers;
+        bool m_shuttingDown;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_PARALLEL_MARKING)
+
+#endif // ParallelMarker_h
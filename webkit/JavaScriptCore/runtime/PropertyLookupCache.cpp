@@ -0,0 +1,83 @@
+#include "config.h"
+#include "PropertyLookupCache.h"
+
+#include "JSObject.h"
+#include "PropertySlot.h"
+#include "Structure.h"
+
+namespace JSC {
+
+PropertyLookupCache::CacheEntry::CacheEntry()
+    : offset(0)
+{
+}
+
+PropertyLookupCache::PropertyLookupCache()
+{
+}
+
+PropertyLookupCache::~PropertyLookupCache()
+{
+}
+
+void PropertyLookupCache::reset()
+{
+    for (size_t i = 0; i < cacheSize; ++i)
+        m_cache[i] = CacheEntry();
+}
+
+static inline bool isCacheableStructure(Structure* structure)
+{
+    return !structure->isDictionary() && !structure->typeInfo().overridesGetOwnPropertySlot();
+}
+
+bool PropertyLookupCache::get(JSValue baseValue, const Identifier& propertyName, JSValue& result)
+{
+    if (!baseValue.isObject())
+        return false;
+    JSObject* base = asObject(baseValue);
+    Structure* structure = base->structure();
+    UString::Rep* name = propertyName.ustring().rep();
+    CacheEntry& entry = lookup(structure, name);
+    if (entry.base != structure || entry.name != name)
+        return false;
+
+    if (!entry.prototype) {
+        result = base->getDirectOffset(entry.offset);
+        return true;
+    }
+    // The base Structure fixes the prototype, but not the prototype's own
+    // Structure.
+    JSObject* prototype = asObject(structure->storedPrototype());
+    if (prototype->structure() != entry.prototype)
+        return false;
+    result = prototype->getDirectOffset(entry.offset);
+    return true;
+}
+
+void PropertyLookupCache::add(JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot)
+{
+    if (!baseValue.isObject() || !slot.isCacheable())
+        return;
+    Structure* structure = asObject(baseValue)->structure();
+    if (!isCacheableStructure(structure))
+        return;
+
+    Structure* prototypeStructure = 0;
+    if (slot.slotBase() != baseValue) {
+        if (slot.slotBase() != structure->storedPrototype())
+            return;
+        prototypeStructure = asObject(slot.slotBase())->structure();
+        if (!isCacheableStructure(prototypeStructure))
+            return;
+    }
+
+    UString::Rep* name = propertyName.ustring().rep();
+    CacheEntry& entry = lookup(structure, name);
+    entry.base = structure;
+    entry.name = name;
+    entry.prototype = prototypeStructure;
+    entry.offset = slot.cachedOffset();
+}
+
+} // namespace JSC
@@ -0,0 +1,58 @@
+#ifndef PropertyLookupCache_h
+#define PropertyLookupCache_h
+
+#include "UString.h"
+#include <wtf/HashFunctions.h>
+#include <wtf/RefPtr.h>
+
+namespace JSC {
+
+    class Identifier;
+    class JSValue;
+    class PropertySlot;
+    class Structure;
+
+    // Remembers where get_by_id found a property, keyed by the base object's
+    // Structure and the property name, for the sites whose inline caches
+    // have given up on. Only own properties and properties of the direct
+    // prototype are cached, and only for objects that don't override
+    // getOwnPropertySlot. Entries hold a reference to their Structures and
+    // name so that neither can be reused for something else while cached.
+    class PropertyLookupCache {
+    public:
+        // Out of line so that users of the header don't need the Structure
+        // definition.
+        PropertyLookupCache();
+        ~PropertyLookupCache();
+
+        // Sets result and returns true on a hit.
+        bool get(JSValue baseValue, const Identifier& propertyName, JSValue& result);
+        // Records the lookup that filled slot, if it can be cached.
+        void add(JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot);
+
+        void reset();
+
+    private:
+        static const size_t cacheSize = 256;
+
+        struct CacheEntry {
+            CacheEntry();
+
+            RefPtr<Structure> base;
+            RefPtr<UString::Rep> name;
+            // 0 for an own property
+            RefPtr<Structure> prototype;
+            size_t offset;
+        };
+
+        CacheEntry& lookup(Structure* structure, UString::Rep* name)
+        {
+            return m_cache[(PtrHash<Structure*>::hash(structure) + name->existingHash()) & (cacheSize - 1)];
+        }
+
+        CacheEntry m_cache[cacheSize];
+    };
+
+} // namespace JSC
+
+#endif // PropertyLookupCache_h
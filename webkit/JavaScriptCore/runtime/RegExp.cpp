@@ -2,6 +2,7 @@
 
 #include "config.h"
 #include "RegExp.h"
+#include "JSGlobalData.h"
 #include "Lexer.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,15 +36,6 @@ namespace JSC {
 using namespace WREC;
 #endif
 
-inline RegExp::RegExp(JSGlobalData* globalData, const UString& pattern)
-    : m_pattern(pattern)
-    , m_flagBits(0)
-    , m_constructionError(0)
-    , m_numSubpatterns(0)
-{
-    compile(globalData);
-}
-
 inline RegExp::RegExp(JSGlobalData* globalData, const UString& pattern, const UString& flags)
     : m_pattern(pattern)
     , m_flagBits(0)
@@ -67,14 +59,24 @@ RegExp::~RegExp()
 {
     jsRegExpFree(m_regExp);
 }
+#elif ENABLE(YARR_JIT) && DUMP_REGEXP_JIT_STATS
+RegExp::~RegExp()
+{
+    fprintf(stderr, "RegExp /%s/: %u matches by %s\n", m_pattern.UTF8String().c_str(), m_regExpJITCode.executionCount(), m_regExpJITCode.getFallback() ? "PCRE" : "the JIT");
+}
 #endif
 
 PassRefPtr<RegExp> RegExp::create(JSGlobalData* globalData, const UString& pattern)
 {
-    return adoptRef(new RegExp(globalData, pattern));
+    return globalData->regExpCache.lookupOrCreate(globalData, pattern, UString());
 }
 
 PassRefPtr<RegExp> RegExp::create(JSGlobalData* globalData, const UString& pattern, const UString& flags)
+{
+    return globalData->regExpCache.lookupOrCreate(globalData, pattern, flags);
+}
+
+PassRefPtr<RegExp> RegExp::createUncached(JSGlobalData* globalData, const UString& pattern, const UString& flags)
 {
     return adoptRef(new RegExp(globalData, pattern, flags));
 }
@@ -11,6 +11,10 @@
 #include "yarr/RegexJIT.h"
 #include "yarr/RegexInterpreter.h"
 
+// Prints how often each pattern was matched, and whether by the JIT or by
+// PCRE, when the RegExp is destroyed.
+#define DUMP_REGEXP_JIT_STATS 0
+
 struct JSRegExp;
 
 namespace JSC {
@@ -21,7 +25,7 @@ namespace JSC {
     public:
         static PassRefPtr<RegExp> create(JSGlobalData* globalData, const UString& pattern);
         static PassRefPtr<RegExp> create(JSGlobalData* globalData, const UString& pattern, const UString& flags);
-#if !ENABLE(YARR)
+#if !ENABLE(YARR) || (ENABLE(YARR_JIT) && DUMP_REGEXP_JIT_STATS)
         ~RegExp();
 #endif
 
@@ -38,7 +42,9 @@ namespace JSC {
         unsigned numSubpatterns() const { return m_numSubpatterns; }
 
     private:
-        RegExp(JSGlobalData* globalData, const UString& pattern);
+        friend class RegExpCache;
+        static PassRefPtr<RegExp> createUncached(JSGlobalData*, const UString& pattern, const UString& flags);
+
         RegExp(JSGlobalData* globalData, const UString& pattern, const UString& flags);
 
         void compile(JSGlobalData*);
@@ -0,0 +1,60 @@
+#include "config.h"
+#include "RegExpCache.h"
+
+#include "RegExp.h"
+
+namespace JSC {
+
+enum { Global = 1, IgnoreCase = 2, Multiline = 4 };
+
+static unsigned flagBits(const UString& flags)
+{
+    unsigned bits = 0;
+    if (flags.find('g') != -1)
+        bits |= Global;
+    if (flags.find('i') != -1)
+        bits |= IgnoreCase;
+    if (flags.find('m') != -1)
+        bits |= Multiline;
+    return bits;
+}
+
+static unsigned flagBits(const RegExp* regExp)
+{
+    return (regExp->global() ? Global : 0) | (regExp->ignoreCase() ? IgnoreCase : 0) | (regExp->multiline() ? Multiline : 0);
+}
+
+RegExpCache::RegExpCache()
+{
+}
+
+RegExpCache::~RegExpCache()
+{
+}
+
+PassRefPtr<RegExp> RegExpCache::lookupOrCreate(JSGlobalData* globalData, const UString& pattern, const UString& flags)
+{
+    if (pattern.size() > maxCacheablePatternLength)
+        return RegExp::createUncached(globalData, pattern, flags);
+
+    pair<RegExpMap::iterator, bool> result = m_regExps[flagBits(flags)].add(pattern.rep(), 0);
+    if (!result.second) {
+        RegExp* regExp = result.first->second.get();
+        m_recentlyUsed.remove(regExp);
+        m_recentlyUsed.add(regExp);
+        return regExp;
+    }
+
+    RefPtr<RegExp> regExp = RegExp::createUncached(globalData, pattern, flags);
+    result.first->second = regExp;
+    m_recentlyUsed.add(regExp.get());
+
+    if (m_recentlyUsed.size() > cacheSize) {
+        RegExp* leastRecentlyUsed = *m_recentlyUsed.begin();
+        m_recentlyUsed.remove(m_recentlyUsed.begin());
+        m_regExps[flagBits(leastRecentlyUsed)].remove(leastRecentlyUsed->pattern().rep());
+    }
+    return regExp.release();
+}
+
+} // namespace JSC
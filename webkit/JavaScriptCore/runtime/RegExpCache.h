@@ -0,0 +1,42 @@
+#ifndef RegExpCache_h
+#define RegExpCache_h
+
+#include "UString.h"
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+
+namespace JSC {
+
+    class JSGlobalData;
+    class RegExp;
+
+    // Shares compiled RegExps between everything that asks for the same
+    // pattern and flags, so that code building regular expressions from
+    // strings compiles each one once. A RegExp doesn't change once it is
+    // compiled; matching state lives in RegExpObject and RegExpConstructor.
+    // Holds at most cacheSize RegExps, dropping the least recently used.
+    class RegExpCache : Noncopyable {
+    public:
+        RegExpCache();
+        ~RegExpCache();
+
+        PassRefPtr<RegExp> lookupOrCreate(JSGlobalData*, const UString& pattern, const UString& flags);
+
+    private:
+        static const size_t cacheSize = 64;
+        // Longer patterns are compiled each time rather than cached.
+        static const int maxCacheablePatternLength = 256;
+        // one map for each combination of the g, i and m flags
+        static const unsigned flagCombinations = 8;
+
+        typedef HashMap<RefPtr<UString::Rep>, RefPtr<RegExp> > RegExpMap;
+        RegExpMap m_regExps[flagCombinations];
+        // least recently used first
+        ListHashSet<RegExp*> m_recentlyUsed;
+    };
+
+} // namespace JSC
+
+#endif // RegExpCache_h
@@ -113,6 +113,7 @@ Structure::Structure(JSValue prototype, const TypeInfo& typeInfo, unsigned anony
     , m_attributesInPrevious(0)
     , m_specificFunctionThrashCount(0)
     , m_anonymousSlotCount(anonymousSlotCount)
+    , m_dictionaryFlattenCount(0)
 {
     ASSERT(m_prototype);
     ASSERT(m_prototype.isObject() || m_prototype.isNull());
@@ -359,6 +360,7 @@ PassRefPtr<Structure> Structure::addPropertyTransition(Structure* structure, con
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
+    transition->m_dictionaryFlattenCount = structure->m_dictionaryFlattenCount;
 
     if (structure->m_propertyTable) {
         if (structure->m_isPinnedPropertyTable)
@@ -407,6 +409,7 @@ PassRefPtr<Structure> Structure::changePrototypeTransition(Structure* structure,
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
+    transition->m_dictionaryFlattenCount = structure->m_dictionaryFlattenCount;
 
     // Don't set m_offset, as one can not transition to this.
 
@@ -427,6 +430,7 @@ PassRefPtr<Structure> Structure::despecifyFunctionTransition(Structure* structur
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount + 1;
+    transition->m_dictionaryFlattenCount = structure->m_dictionaryFlattenCount;
 
     // Don't set m_offset, as one can not transition to this.
 
@@ -452,6 +456,7 @@ PassRefPtr<Structure> Structure::getterSetterTransition(Structure* structure)
     transition->m_hasGetterSetterProperties = transition->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
+    transition->m_dictionaryFlattenCount = structure->m_dictionaryFlattenCount;
 
     // Don't set m_offset, as one can not transition to this.
 
@@ -473,6 +478,7 @@ PassRefPtr<Structure> Structure::toDictionaryTransition(Structure* structure, Di
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
+    transition->m_dictionaryFlattenCount = structure->m_dictionaryFlattenCount;
     
     structure->materializePropertyMapIfNecessary();
     transition->m_propertyTable = structure->copyPropertyTable();
@@ -529,15 +535,27 @@ PassRefPtr<Structure> Structure::flattenDictionaryStructure(JSObject* object)
             delete m_propertyTable->deletedOffsets;
             m_propertyTable->deletedOffsets = 0;
         }
+
+        if (m_dictionaryFlattenCount < maxDictionaryFlattenCount)
+            ++m_dictionaryFlattenCount;
     }
 
     m_dictionaryKind = NoneDictionaryKind;
     return this;
 }
 
+void Structure::invalidateEnumerationCache()
+{
+    // A dictionary changes its properties in place, so any cached
+    // enumeration of them has to go.
+    if (m_enumerationCache)
+        m_enumerationCache->setCachedStructure(0);
+    m_enumerationCache = 0;
+}
+
 size_t Structure::addPropertyWithoutTransition(const Identifier& propertyName, unsigned attributes, JSCell* specificValue)
 {
-    ASSERT(!m_enumerationCache);
+    invalidateEnumerationCache();
 
     if (m_specificFunctionThrashCount == maxSpecificFunctionThrashCount)
         specificValue = 0;
@@ -556,7 +574,7 @@ size_t Structure::addPropertyWithoutTransition(const Identifier& propertyName, u
 size_t Structure::removePropertyWithoutTransition(const Identifier& propertyName)
 {
     ASSERT(isUncacheableDictionary());
-    ASSERT(!m_enumerationCache);
+    invalidateEnumerationCache();
 
     materializePropertyMapIfNecessary();
 
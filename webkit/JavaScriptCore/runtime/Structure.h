@@ -68,6 +68,10 @@ namespace JSC {
         
         bool isDictionary() const { return m_dictionaryKind != NoneDictionaryKind; }
         bool isUncacheableDictionary() const { return m_dictionaryKind == UncachedDictionaryKind; }
+        // An object that keeps going back into dictionary mode after being
+        // flattened is being used as a hash table; flattening it again would
+        // only reorder its storage for inline caches that won't hold.
+        bool isThrashingDictionary() const { return isUncacheableDictionary() && m_dictionaryFlattenCount == maxDictionaryFlattenCount; }
 
         const TypeInfo& typeInfo() const { return m_typeInfo; }
 
@@ -128,6 +132,8 @@ namespace JSC {
         } DictionaryKind;
         static PassRefPtr<Structure> toDictionaryTransition(Structure*, DictionaryKind);
 
+        void invalidateEnumerationCache();
+
         size_t put(const Identifier& propertyName, unsigned attributes, JSCell* specificValue);
         size_t remove(const Identifier& propertyName);
 
@@ -166,6 +172,7 @@ namespace JSC {
         static const signed char noOffset = -1;
 
         static const unsigned maxSpecificFunctionThrashCount = 3;
+        static const unsigned maxDictionaryFlattenCount = 2;
 
         TypeInfo m_typeInfo;
 
@@ -201,7 +208,8 @@ namespace JSC {
 #endif
         unsigned m_specificFunctionThrashCount : 2;
         unsigned m_anonymousSlotCount : 5;
-        // 5 free bits
+        unsigned m_dictionaryFlattenCount : 2;
+        // 3 free bits
     };
 
     inline size_t Structure::get(const Identifier& propertyName)
@@ -100,9 +100,17 @@ bool TimeoutChecker::didTimeOut(ExecState* exec)
     m_timeExecuting += timeDiff;
     m_timeAtLastCheck = currentTime;
     
+    SamplingProfiler& samplingProfiler = exec->globalData().samplingProfiler;
+    unsigned interval = intervalBetweenChecks;
+    if (samplingProfiler.isRunning()) {
+        samplingProfiler.sample(exec);
+        interval = samplingProfiler.sampleInterval();
+    }
+
     // Adjust the tick threshold so we get the next checkTimeout call in the
-    // interval specified in intervalBetweenChecks.
-    m_ticksUntilNextCheck = static_cast<unsigned>((static_cast<float>(intervalBetweenChecks) / timeDiff) * m_ticksUntilNextCheck);
+    // interval specified in intervalBetweenChecks, or the sampling interval
+    // while the sampling profiler runs.
+    m_ticksUntilNextCheck = static_cast<unsigned>((static_cast<float>(interval) / timeDiff) * m_ticksUntilNextCheck);
     // If the new threshold is 0 reset it to the default threshold. This can happen if the timeDiff is higher than the
     // preferred script check time interval.
     if (m_ticksUntilNextCheck == 0)
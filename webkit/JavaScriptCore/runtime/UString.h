@@ -582,7 +582,7 @@ namespace WTF {
 
     template<> struct StrHash<JSC::UString::Rep*> {
         static unsigned hash(const JSC::UString::Rep* key) { return key->hash(); }
-        static bool equal(const JSC::UString::Rep* a, const JSC::UString::Rep* b) { return JSC::equal(a, b); }
+        static bool equal(const JSC::UString::Rep* a, const JSC::UString::Rep* b) { return a == b || (a->hash() == b->hash() && JSC::equal(a, b)); }
         static const bool safeToCompareToEmptyOrDeleted = false;
     };
 
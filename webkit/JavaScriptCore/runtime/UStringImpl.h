@@ -79,7 +79,16 @@ public:
     {
         ASSERT(rep);
         rep->checkConsistency();
-        return adoptRef(new UStringImpl(rep->m_data + offset, length, rep->bufferOwnerString()));
+        UStringImpl* ownerRep = rep->bufferOwnerString();
+        // Copy substrings that are short, or a small part of their base string,
+        // rather than keep the whole base string alive for them.
+        if (length <= s_maxLengthToCopySubstring || length < ownerRep->m_length / s_minSubstringFractionToShare) {
+            UChar* data;
+            RefPtr<UStringImpl> copy = createUninitialized(length, data);
+            copyChars(data, rep->m_data + offset, length);
+            return copy.release();
+        }
+        return adoptRef(new UStringImpl(rep->m_data + offset, length, ownerRep));
     }
 
     static PassRefPtr<UStringImpl> create(PassRefPtr<SharedUChar> sharedBuffer, UChar* buffer, int length)
@@ -239,6 +248,10 @@ private:
     // This number must be at least 2 to avoid sharing empty, null as well as 1 character strings from SmallStrings.
     static const int s_minLengthToShare = 10;
     static const unsigned s_copyCharsInlineCutOff = 20;
+    // Substrings at most this long are copied rather than shared.
+    static const int s_maxLengthToCopySubstring = 32;
+    // Substrings shorter than 1 / this of their base string are copied rather than shared.
+    static const int s_minSubstringFractionToShare = 8;
     static const uintptr_t s_bufferOwnershipMask = 3;
     static const uintptr_t s_reportedCostBit = 4;
     // We initialize and increment/decrement the refCount for all normal (non-static) strings by the value 2.
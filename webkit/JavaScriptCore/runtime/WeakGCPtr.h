@@ -45,8 +45,11 @@ public:
 private:
     void assign(T* ptr)
     {
-        if (ptr)
+        if (ptr) {
             Heap::markCell(ptr);
+            // ptr is marked without its children being traced
+            Heap::writeBarrier(ptr);
+        }
         m_ptr = ptr;
     }
 
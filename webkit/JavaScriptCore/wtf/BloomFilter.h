@@ -0,0 +1,70 @@
+#ifndef BloomFilter_h
+#define BloomFilter_h
+
+#include <wtf/Assertions.h>
+#include <string.h>
+
+namespace WTF {
+
+    // A counting Bloom filter with 8 bit counters, taking 2^keyBits bytes.
+    // Keys are hashes; two slots are taken from each, so the hashes should be
+    // well distributed over at least 16 + keyBits bits. The filter can claim
+    // to contain a key that was never added, but never the other way round.
+    template <unsigned keyBits>
+    class BloomFilter {
+    public:
+        static const size_t tableSize = 1 << keyBits;
+        static const unsigned keyMask = (1 << keyBits) - 1;
+        static const unsigned char maximumCount = 0xFF;
+
+        BloomFilter() { clear(); }
+
+        void add(unsigned hash);
+        // Removing a key that wasn't added corrupts the filter.
+        void remove(unsigned hash);
+
+        bool mayContain(unsigned hash) const { return firstSlot(hash) && secondSlot(hash); }
+
+        // Counters that overflowed stay saturated when their keys are removed,
+        // so the filter has to be cleared to forget them.
+        void clear() { memset(m_table, 0, sizeof(m_table)); }
+
+    private:
+        unsigned char& firstSlot(unsigned hash) { return m_table[hash & keyMask]; }
+        unsigned char& secondSlot(unsigned hash) { return m_table[(hash >> 16) & keyMask]; }
+        const unsigned char& firstSlot(unsigned hash) const { return m_table[hash & keyMask]; }
+        const unsigned char& secondSlot(unsigned hash) const { return m_table[(hash >> 16) & keyMask]; }
+
+        unsigned char m_table[tableSize];
+    };
+
+    template <unsigned keyBits>
+    inline void BloomFilter<keyBits>::add(unsigned hash)
+    {
+        unsigned char& first = firstSlot(hash);
+        unsigned char& second = secondSlot(hash);
+        if (first < maximumCount)
+            ++first;
+        if (second < maximumCount)
+            ++second;
+    }
+
+    template <unsigned keyBits>
+    inline void BloomFilter<keyBits>::remove(unsigned hash)
+    {
+        unsigned char& first = firstSlot(hash);
+        unsigned char& second = secondSlot(hash);
+        ASSERT(first);
+        ASSERT(second);
+        // A saturated counter has lost track of how many keys share it.
+        if (first < maximumCount)
+            --first;
+        if (second < maximumCount)
+            --second;
+    }
+
+} // namespace WTF
+
+using WTF::BloomFilter;
+
+#endif // BloomFilter_h
@@ -115,6 +115,25 @@ int msToYear(double ms)
     return approxYear;
 }
 
+// Splits days since 1970-01-01 into a year, a 0 based month and a 1 based
+// day of the month with integer arithmetic only, by counting from March
+// of the 400 year era the day falls in.
+static inline void daysToCivilDate(int days, int& year, int& month, int& monthDay)
+{
+    static const int daysFromMarch0000To1970 = 719468;
+    static const int daysPerEra = 146097;
+
+    int fromMarch0000 = days + daysFromMarch0000To1970;
+    int era = (fromMarch0000 >= 0 ? fromMarch0000 : fromMarch0000 - (daysPerEra - 1)) / daysPerEra;
+    int dayOfEra = fromMarch0000 - era * daysPerEra;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / (daysPerEra - 1)) / 365;
+    int dayOfYearFromMarch = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthFromMarch = (5 * dayOfYearFromMarch + 2) / 153;
+    monthDay = dayOfYearFromMarch - (153 * monthFromMarch + 2) / 5 + 1;
+    month = monthFromMarch < 10 ? monthFromMarch + 2 : monthFromMarch - 10;
+    year = yearOfEra + era * 400 + (month < 2);
+}
+
 int dayInYear(double ms, int year)
 {
     return static_cast<int>(msToDays(ms) - daysFrom1970ToYear(year));
@@ -778,6 +797,37 @@ double timeClip(double t)
 #if USE(JSC)
 namespace JSC {
 
+static void calculateDSTOffsetsForYear(int year, double utcOffset, DSTOffsetCache::Year& table)
+{
+    table.year = year;
+    table.utcOffset = utcOffset;
+
+    double monthStart = dateToDaysFrom1970(year, 0, 1) * msPerDay;
+    double offset = calculateDSTOffsetSimple(monthStart / msPerSecond, utcOffset);
+    for (int month = 0; month < 12; ++month) {
+        double nextMonthStart = dateToDaysFrom1970(year, month + 1, 1) * msPerDay;
+        double nextOffset = calculateDSTOffsetSimple(nextMonthStart / msPerSecond, utcOffset);
+        table.monthOffset[month] = offset;
+        table.changeTime[month] = std::numeric_limits<double>::infinity();
+        table.changeOffset[month] = nextOffset;
+        if (nextOffset != offset) {
+            // Binary search for the first second with the new offset.
+            double low = monthStart / msPerSecond;
+            double high = nextMonthStart / msPerSecond;
+            while (high - low > 1) {
+                double middle = floor((low + high) / 2);
+                if (calculateDSTOffsetSimple(middle, utcOffset) == offset)
+                    low = middle;
+                else
+                    high = middle;
+            }
+            table.changeTime[month] = high * msPerSecond;
+        }
+        monthStart = nextMonthStart;
+        offset = nextOffset;
+    }
+}
+
 // Get the DST offset for the time passed in.
 //
 // NOTE: The implementation relies on the fact that no time zones have
@@ -785,59 +835,30 @@ namespace JSC {
 // If this function is called with NaN it returns NaN.
 static double getDSTOffset(ExecState* exec, double ms, double utcOffset)
 {
-    DSTOffsetCache& cache = exec->globalData().dstOffsetCache;
-    double start = cache.start;
-    double end = cache.end;
-
-    if (start <= ms) {
-        // If the time fits in the cached interval, return the cached offset.
-        if (ms <= end) return cache.offset;
-
-        // Compute a possible new interval end.
-        double newEnd = end + cache.increment;
-
-        if (ms <= newEnd) {
-            double endOffset = calculateDSTOffset(newEnd, utcOffset);
-            if (cache.offset == endOffset) {
-                // If the offset at the end of the new interval still matches
-                // the offset in the cache, we grow the cached time interval
-                // and return the offset.
-                cache.end = newEnd;
-                cache.increment = msPerMonth;
-                return endOffset;
-            } else {
-                double offset = calculateDSTOffset(ms, utcOffset);
-                if (offset == endOffset) {
-                    // The offset at the given time is equal to the offset at the
-                    // new end of the interval, so that means that we've just skipped
-                    // the point in time where the DST offset change occurred. Updated
-                    // the interval to reflect this and reset the increment.
-                    cache.start = ms;
-                    cache.end = newEnd;
-                    cache.increment = msPerMonth;
-                } else {
-                    // The interval contains a DST offset change and the given time is
-                    // before it. Adjust the increment to avoid a linear search for
-                    // the offset change point and change the end of the interval.
-                    cache.increment /= 3;
-                    cache.end = ms;
-                }
-                // Update the offset in the cache and return it.
-                cache.offset = offset;
-                return offset;
-            }
-        }
+    if (isnan(ms))
+        return NaN;
+
+    // As in calculateDSTOffset, use the same day of a year localtime has
+    // no historical DST information for.
+    int year = msToYear(ms);
+    int equivalentYear = equivalentYearForDST(year);
+    if (year != equivalentYear) {
+        bool leapYear = isLeapYear(year);
+        int dayInYearLocal = dayInYear(ms, year);
+        int dayInMonth = dayInMonthFromDayInYear(dayInYearLocal, leapYear);
+        int month = monthFromDayInYear(dayInYearLocal, leapYear);
+        double day = dateToDaysFrom1970(equivalentYear, month, dayInMonth);
+        ms = (day * msPerDay) + msToMilliseconds(ms);
     }
 
-    // Compute the DST offset for the time and shrink the cache interval
-    // to only contain the time. This allows fast repeated DST offset
-    // computations for the same time.
-    double offset = calculateDSTOffset(ms, utcOffset);
-    cache.offset = offset;
-    cache.start = ms;
-    cache.end = ms;
-    cache.increment = msPerMonth;
-    return offset;
+    DSTOffsetCache::Year& table = exec->globalData().dstOffsetCache.years[equivalentYear % DSTOffsetCache::yearCount];
+    if (table.year != equivalentYear || table.utcOffset != utcOffset)
+        calculateDSTOffsetsForYear(equivalentYear, utcOffset, table);
+
+    int month = monthFromDayInYear(dayInYear(ms, equivalentYear), isLeapYear(equivalentYear));
+    if (ms >= table.changeTime[month])
+        return table.changeOffset[month];
+    return table.monthOffset[month];
 }
 
 double getUTCOffset(ExecState* exec)
@@ -875,14 +896,17 @@ void msToGregorianDateTime(ExecState* exec, double ms, bool outputIsUTC, Gregori
         ms += dstOff + utcOff;
     }
 
-    const int year = msToYear(ms);
+    int year;
+    int month;
+    int monthDay;
+    daysToCivilDate(static_cast<int>(msToDays(ms)), year, month, monthDay);
     tm.second   =  msToSeconds(ms);
     tm.minute   =  msToMinutes(ms);
     tm.hour     =  msToHours(ms);
     tm.weekDay  =  msToWeekDay(ms);
-    tm.yearDay  =  dayInYear(ms, year);
-    tm.monthDay =  dayInMonthFromDayInYear(tm.yearDay, isLeapYear(year));
-    tm.month    =  monthFromDayInYear(tm.yearDay, isLeapYear(year));
+    tm.yearDay  =  monthToDayInYear(month, isLeapYear(year)) + monthDay - 1;
+    tm.monthDay =  monthDay;
+    tm.month    =  month;
     tm.year     =  year - 1900;
     tm.isDST    =  dstOff != 0.0;
     tm.utcOffset = static_cast<long>((dstOff + utcOff) / WTF::msPerSecond);
@@ -0,0 +1,300 @@
+#include "config.h"
+#include "FastDtoa.h"
+
+#include "Assertions.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace WTF {
+
+// A 64 bit significand with a binary exponent, f * 2^e.
+struct DiyFp {
+    DiyFp() : f(0), e(0) { }
+    DiyFp(uint64_t significand, int exponent) : f(significand), e(exponent) { }
+
+    uint64_t f;
+    int e;
+};
+
+// The upper 64 bits of the 128 bit product, rounded.
+static inline DiyFp multiply(const DiyFp& x, const DiyFp& y)
+{
+    const uint64_t mask32 = 0xFFFFFFFFu;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32) + (1U << 31);
+    return DiyFp(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+static inline DiyFp normalize(DiyFp value)
+{
+    ASSERT(value.f);
+    while (!(value.f & 0xFFC0000000000000ULL)) {
+        value.f <<= 10;
+        value.e -= 10;
+    }
+    while (!(value.f & 0x8000000000000000ULL)) {
+        value.f <<= 1;
+        value.e -= 1;
+    }
+    return value;
+}
+
+static const uint64_t doubleSignificandMask = 0x000FFFFFFFFFFFFFULL;
+static const uint64_t doubleHiddenBit = 0x0010000000000000ULL;
+static const int doubleExponentBias = 0x3FF + 52;
+static const int doubleDenormalExponent = 1 - doubleExponentBias;
+
+static inline DiyFp doubleToDiyFp(double value)
+{
+    union {
+        double d;
+        uint64_t bits;
+    } u;
+    u.d = value;
+    uint64_t significand = u.bits & doubleSignificandMask;
+    int biasedExponent = static_cast<int>(u.bits >> 52) & 0x7FF;
+    if (!biasedExponent)
+        return DiyFp(significand, doubleDenormalExponent);
+    return DiyFp(significand + doubleHiddenBit, biasedExponent - doubleExponentBias);
+}
+
+// The points halfway between value and its neighbours, with the same
+// exponent as the normalized upper one.
+static inline void normalizedBoundaries(const DiyFp& value, DiyFp& lower, DiyFp& upper)
+{
+    upper = normalize(DiyFp((value.f << 1) + 1, value.e - 1));
+    // The gap below a power of two is half the size of the one above it.
+    if (value.f == doubleHiddenBit && value.e != doubleDenormalExponent)
+        lower = DiyFp((value.f << 2) - 1, value.e - 2);
+    else
+        lower = DiyFp((value.f << 1) - 1, value.e - 1);
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+}
+
+struct CachedPower {
+    uint64_t significand;
+    int16_t binaryExponent;
+    int16_t decimalExponent;
+};
+
+// Normalized, rounded 10^k for k = -348, -340, ..., 340.
+static const CachedPower cachedPowers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220, -348 },
+    { 0xbaaee17fa23ebf76ULL, -1193, -340 },
+    { 0x8b16fb203055ac76ULL, -1166, -332 },
+    { 0xcf42894a5dce35eaULL, -1140, -324 },
+    { 0x9a6bb0aa55653b2dULL, -1113, -316 },
+    { 0xe61acf033d1a45dfULL, -1087, -308 },
+    { 0xab70fe17c79ac6caULL, -1060, -300 },
+    { 0xff77b1fcbebcdc4fULL, -1034, -292 },
+    { 0xbe5691ef416bd60cULL, -1007, -284 },
+    { 0x8dd01fad907ffc3cULL, -980, -276 },
+    { 0xd3515c2831559a83ULL, -954, -268 },
+    { 0x9d71ac8fada6c9b5ULL, -927, -260 },
+    { 0xea9c227723ee8bcbULL, -901, -252 },
+    { 0xaecc49914078536dULL, -874, -244 },
+    { 0x823c12795db6ce57ULL, -847, -236 },
+    { 0xc21094364dfb5637ULL, -821, -228 },
+    { 0x9096ea6f3848984fULL, -794, -220 },
+    { 0xd77485cb25823ac7ULL, -768, -212 },
+    { 0xa086cfcd97bf97f4ULL, -741, -204 },
+    { 0xef340a98172aace5ULL, -715, -196 },
+    { 0xb23867fb2a35b28eULL, -688, -188 },
+    { 0x84c8d4dfd2c63f3bULL, -661, -180 },
+    { 0xc5dd44271ad3cdbaULL, -635, -172 },
+    { 0x936b9fcebb25c996ULL, -608, -164 },
+    { 0xdbac6c247d62a584ULL, -582, -156 },
+    { 0xa3ab66580d5fdaf6ULL, -555, -148 },
+    { 0xf3e2f893dec3f126ULL, -529, -140 },
+    { 0xb5b5ada8aaff80b8ULL, -502, -132 },
+    { 0x87625f056c7c4a8bULL, -475, -124 },
+    { 0xc9bcff6034c13053ULL, -449, -116 },
+    { 0x964e858c91ba2655ULL, -422, -108 },
+    { 0xdff9772470297ebdULL, -396, -100 },
+    { 0xa6dfbd9fb8e5b88fULL, -369, -92 },
+    { 0xf8a95fcf88747d94ULL, -343, -84 },
+    { 0xb94470938fa89bcfULL, -316, -76 },
+    { 0x8a08f0f8bf0f156bULL, -289, -68 },
+    { 0xcdb02555653131b6ULL, -263, -60 },
+    { 0x993fe2c6d07b7facULL, -236, -52 },
+    { 0xe45c10c42a2b3b06ULL, -210, -44 },
+    { 0xaa242499697392d3ULL, -183, -36 },
+    { 0xfd87b5f28300ca0eULL, -157, -28 },
+    { 0xbce5086492111aebULL, -130, -20 },
+    { 0x8cbccc096f5088ccULL, -103, -12 },
+    { 0xd1b71758e219652cULL, -77, -4 },
+    { 0x9c40000000000000ULL, -50, 4 },
+    { 0xe8d4a51000000000ULL, -24, 12 },
+    { 0xad78ebc5ac620000ULL, 3, 20 },
+    { 0x813f3978f8940984ULL, 30, 28 },
+    { 0xc097ce7bc90715b3ULL, 56, 36 },
+    { 0x8f7e32ce7bea5c70ULL, 83, 44 },
+    { 0xd5d238a4abe98068ULL, 109, 52 },
+    { 0x9f4f2726179a2245ULL, 136, 60 },
+    { 0xed63a231d4c4fb27ULL, 162, 68 },
+    { 0xb0de65388cc8ada8ULL, 189, 76 },
+    { 0x83c7088e1aab65dbULL, 216, 84 },
+    { 0xc45d1df942711d9aULL, 242, 92 },
+    { 0x924d692ca61be758ULL, 269, 100 },
+    { 0xda01ee641a708deaULL, 295, 108 },
+    { 0xa26da3999aef774aULL, 322, 116 },
+    { 0xf209787bb47d6b85ULL, 348, 124 },
+    { 0xb454e4a179dd1877ULL, 375, 132 },
+    { 0x865b86925b9bc5c2ULL, 402, 140 },
+    { 0xc83553c5c8965d3dULL, 428, 148 },
+    { 0x952ab45cfa97a0b3ULL, 455, 156 },
+    { 0xde469fbd99a05fe3ULL, 481, 164 },
+    { 0xa59bc234db398c25ULL, 508, 172 },
+    { 0xf6c69a72a3989f5cULL, 534, 180 },
+    { 0xb7dcbf5354e9beceULL, 561, 188 },
+    { 0x88fcf317f22241e2ULL, 588, 196 },
+    { 0xcc20ce9bd35c78a5ULL, 614, 204 },
+    { 0x98165af37b2153dfULL, 641, 212 },
+    { 0xe2a0b5dc971f303aULL, 667, 220 },
+    { 0xa8d9d1535ce3b396ULL, 694, 228 },
+    { 0xfb9b7cd9a4a7443cULL, 720, 236 },
+    { 0xbb764c4ca7a44410ULL, 747, 244 },
+    { 0x8bab8eefb6409c1aULL, 774, 252 },
+    { 0xd01fef10a657842cULL, 800, 260 },
+    { 0x9b10a4e5e9913129ULL, 827, 268 },
+    { 0xe7109bfba19c0c9dULL, 853, 276 },
+    { 0xac2820d9623bf429ULL, 880, 284 },
+    { 0x80444b5e7aa7cf85ULL, 907, 292 },
+    { 0xbf21e44003acdd2dULL, 933, 300 },
+    { 0x8e679c2f5e44ff8fULL, 960, 308 },
+    { 0xd433179d9c8cb841ULL, 986, 316 },
+    { 0x9e19db92b4e31ba9ULL, 1013, 324 },
+    { 0xeb96bf6ebadf77d9ULL, 1039, 332 },
+    { 0xaf87023b9bf0ee6bULL, 1066, 340 }
+};
+
+static const int cachedPowersOffset = 348;
+static const int cachedPowersDecimalDistance = 8;
+
+// The range Grisu needs the scaled value's exponent in, so that the
+// integral part of the scaled value fits in 32 bits.
+static const int minimalTargetExponent = -60;
+static const int maximalTargetExponent = -32;
+
+// Returns the cached 10^decimalExponent whose product with a number with
+// binary exponent exponent has an exponent in the target range.
+static inline DiyFp cachedPowerForExponent(int exponent, int* decimalExponent)
+{
+    int minimalExponent = minimalTargetExponent - (exponent + 64);
+    int k = static_cast<int>(ceil((minimalExponent + 63) * 0.30102999566398114));
+    int index = (cachedPowersOffset + k - 1) / cachedPowersDecimalDistance + 1;
+    ASSERT(index >= 0 && index < static_cast<int>(sizeof(cachedPowers) / sizeof(cachedPowers[0])));
+    const CachedPower& power = cachedPowers[index];
+    ASSERT(minimalExponent <= power.binaryExponent);
+    ASSERT(power.binaryExponent <= maximalTargetExponent - (exponent + 64));
+    *decimalExponent = power.decimalExponent;
+    return DiyFp(power.significand, power.binaryExponent);
+}
+
+// Moves the last digit of buffer towards the scaled value w, while staying
+// inside the safe interval, and checks that the result is guaranteed to be
+// the closest shortest representation. distanceTooHighW is too_high - w;
+// rest is too_high - buffer; tenKappa is the weight of the last digit; unit
+// is the uncertainty, all in the same scale.
+static bool roundWeed(char* buffer, int length, uint64_t distanceTooHighW, uint64_t unsafeInterval, uint64_t rest, uint64_t tenKappa, uint64_t unit)
+{
+    uint64_t smallDistance = distanceTooHighW - unit;
+    uint64_t bigDistance = distanceTooHighW + unit;
+    while (rest < smallDistance
+        && unsafeInterval - rest >= tenKappa
+        && (rest + tenKappa < smallDistance || smallDistance - rest >= rest + tenKappa - smallDistance)) {
+        --buffer[length - 1];
+        rest += tenKappa;
+    }
+    // If the digit could equally be moved closer to the other end of the
+    // uncertainty, we can't tell which one is right.
+    if (rest < bigDistance
+        && unsafeInterval - rest >= tenKappa
+        && (rest + tenKappa < bigDistance || bigDistance - rest > rest + tenKappa - bigDistance))
+        return false;
+    return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+}
+
+// Generates the shortest digits of a number in [low, high], all scaled so
+// that their exponent is in the target range. kappa is set so that the
+// value is buffer * 10^kappa in that scale.
+static bool digitGen(const DiyFp& low, const DiyFp& w, const DiyFp& high, char* buffer, int* length, int* kappa)
+{
+    ASSERT(low.e == w.e && w.e == high.e);
+    ASSERT(minimalTargetExponent <= w.e && w.e <= maximalTargetExponent);
+    // low, w and high are imprecise by up to one unit; widen the interval
+    // by that and prove afterwards that the result is still inside the
+    // narrow one.
+    uint64_t unit = 1;
+    DiyFp tooLow(low.f - unit, low.e);
+    DiyFp tooHigh(high.f + unit, high.e);
+    uint64_t unsafeInterval = tooHigh.f - tooLow.f;
+    int oneShift = -w.e;
+    uint64_t oneMask = (static_cast<uint64_t>(1) << oneShift) - 1;
+    uint32_t integrals = static_cast<uint32_t>(tooHigh.f >> oneShift);
+    uint64_t fractionals = tooHigh.f & oneMask;
+
+    uint32_t divisor = 1;
+    *kappa = 1;
+    while (divisor <= integrals / 10) {
+        divisor *= 10;
+        ++*kappa;
+    }
+    *length = 0;
+
+    while (*kappa > 0) {
+        buffer[(*length)++] = static_cast<char>('0' + integrals / divisor);
+        integrals %= divisor;
+        --*kappa;
+        uint64_t rest = (static_cast<uint64_t>(integrals) << oneShift) + fractionals;
+        if (rest < unsafeInterval)
+            return roundWeed(buffer, *length, tooHigh.f - w.f, unsafeInterval, rest, static_cast<uint64_t>(divisor) << oneShift, unit);
+        divisor /= 10;
+    }
+
+    while (true) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+        buffer[(*length)++] = static_cast<char>('0' + (fractionals >> oneShift));
+        fractionals &= oneMask;
+        --*kappa;
+        if (fractionals < unsafeInterval)
+            return roundWeed(buffer, *length, (tooHigh.f - w.f) * unit, unsafeInterval, fractionals, oneMask + 1, unit);
+    }
+}
+
+bool fastDtoa(double value, char* buffer, int* length, int* decimalPoint)
+{
+    ASSERT(value > 0 && !isinf(value));
+
+    DiyFp v = doubleToDiyFp(value);
+    DiyFp lower;
+    DiyFp upper;
+    normalizedBoundaries(v, lower, upper);
+    DiyFp w = normalize(v);
+
+    int powerExponent;
+    DiyFp power = cachedPowerForExponent(w.e, &powerExponent);
+    DiyFp scaledW = multiply(w, power);
+    DiyFp scaledLower = multiply(lower, power);
+    DiyFp scaledUpper = multiply(upper, power);
+
+    int kappa;
+    if (!digitGen(scaledLower, scaledW, scaledUpper, buffer, length, &kappa))
+        return false;
+    buffer[*length] = '\0';
+    *decimalPoint = *length + kappa - powerExponent;
+    return true;
+}
+
+} // namespace WTF
@@ -0,0 +1,16 @@
+#ifndef FastDtoa_h
+#define FastDtoa_h
+
+namespace WTF {
+
+    // Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly and
+    // Accurately with Integers") for the shortest digits that round trip
+    // to a positive, finite double. Writes them, NUL terminated, to buffer,
+    // which must hold 18 characters, and sets decimalPoint the way dtoa()
+    // does. Returns false for the roughly 0.5% of doubles it can't prove
+    // shortest, in which case the caller must fall back to dtoa().
+    bool fastDtoa(double, char* buffer, int* length, int* decimalPoint);
+
+} // namespace WTF
+
+#endif // FastDtoa_h
@@ -599,10 +599,19 @@ static const int kMaxFreeListLength = 256;
 
 // Lower and upper bounds on the per-thread cache sizes
 static const size_t kMinThreadCacheSize = kMaxSize * 2;
+#if OS(ANDROID)
+// Phones can't spare megabytes per thread for caches.
+static const size_t kMaxThreadCacheSize = 256 << 10;
+#else
 static const size_t kMaxThreadCacheSize = 2 << 20;
+#endif
 
 // Default bound on the total amount of thread caches
+#if OS(ANDROID)
+static const size_t kDefaultOverallThreadCacheSize = 2 << 20;
+#else
 static const size_t kDefaultOverallThreadCacheSize = 16 << 20;
+#endif
 
 // For all span-lengths < kMaxPages we keep an exact-size list.
 // REQUIRED: kMaxPages >= kMinSystemAlloc;
@@ -1247,7 +1256,11 @@ template <> class MapSelector<32> {
 static const int kScavengeTimerDelayInSeconds = 5;
 
 // Number of free committed pages that we want to keep around.
+#if OS(ANDROID)
+static const size_t kMinimumFreeCommittedPageCount = 128;
+#else
 static const size_t kMinimumFreeCommittedPageCount = 512;
+#endif
 
 // During a scavenge, we'll release up to a fraction of the free committed pages.
 #if OS(WINDOWS)
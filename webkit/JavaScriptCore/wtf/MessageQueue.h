@@ -23,7 +23,7 @@ namespace WTF {
     template<typename DataType>
     class MessageQueue : public Noncopyable {
     public:
-        MessageQueue() : m_killed(false) { }
+        MessageQueue() : m_killed(false), m_waitingThreads(0) { }
         ~MessageQueue();
 
         void append(PassOwnPtr<DataType>);
@@ -53,6 +53,10 @@ namespace WTF {
         ThreadCondition m_condition;
         Deque<DataType*> m_queue;
         bool m_killed;
+        // Signalling is a system call on some platforms even when no thread
+        // waits, so it is skipped then; a busy reader takes a burst of
+        // messages with a single wakeup, or none.
+        unsigned m_waitingThreads;
     };
 
     template<typename DataType>
@@ -66,7 +70,8 @@ namespace WTF {
     {
         MutexLocker lock(m_mutex);
         m_queue.append(message.release());
-        m_condition.signal();
+        if (m_waitingThreads)
+            m_condition.signal();
     }
 
     // Returns true if the queue was empty before the item was added.
@@ -76,7 +81,8 @@ namespace WTF {
         MutexLocker lock(m_mutex);
         bool wasEmpty = m_queue.isEmpty();
         m_queue.append(message.release());
-        m_condition.signal();
+        if (m_waitingThreads)
+            m_condition.signal();
         return wasEmpty;
     }
 
@@ -85,7 +91,8 @@ namespace WTF {
     {
         MutexLocker lock(m_mutex);
         m_queue.prepend(message.release());
-        m_condition.signal();
+        if (m_waitingThreads)
+            m_condition.signal();
     }
 
     template<typename DataType>
@@ -105,8 +112,11 @@ namespace WTF {
         bool timedOut = false;
 
         DequeConstIterator<DataType*> found = m_queue.end();
-        while (!m_killed && !timedOut && (found = m_queue.findIf(predicate)) == m_queue.end())
+        while (!m_killed && !timedOut && (found = m_queue.findIf(predicate)) == m_queue.end()) {
+            ++m_waitingThreads;
             timedOut = !m_condition.timedWait(m_mutex, absoluteTime);
+            --m_waitingThreads;
+        }
 
         ASSERT(!timedOut || absoluteTime != infiniteTime());
 
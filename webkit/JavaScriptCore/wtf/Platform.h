@@ -552,7 +552,6 @@
 #if PLATFORM(ANDROID)
 #define WTF_USE_PTHREADS 1
 #define WTF_PLATFORM_SKIA 1
-#define USE_SYSTEM_MALLOC 1
 #define ENABLE_MAC_JAVA_BRIDGE 1
 #define LOG_DISABLED 1
 #define ENABLE_TEXT_CARET 1
@@ -676,6 +675,7 @@
 
 #define HAVE_ERRNO_H 1
 #define HAVE_LANGINFO_H 0
+#define HAVE_MADV_DONTNEED 1
 #define HAVE_MMAP 1
 #define HAVE_SBRK 1
 #define HAVE_STRINGS_H 1
@@ -798,6 +798,9 @@
 #if !defined(WTF_USE_JSVALUE64) && !defined(WTF_USE_JSVALUE32) && !defined(WTF_USE_JSVALUE32_64)
 #if (CPU(X86_64) && (OS(UNIX) || OS(WINDOWS))) || CPU(IA64) || CPU(ALPHA)
 #define WTF_USE_JSVALUE64 1
+#elif CPU(ARM) && PLATFORM(ANDROID)
+/* Keeps doubles out of the heap, so numeric code doesn't allocate a cell per result. */
+#define WTF_USE_JSVALUE32_64 1
 #elif CPU(ARM) || CPU(PPC64)
 #define WTF_USE_JSVALUE32 1
 #elif OS(WINDOWS) && COMPILER(MINGW)
@@ -938,6 +941,11 @@
 #define ENABLE_ASSEMBLER_WX_EXCLUSIVE 0
 #endif
 
+/* Allocate JIT code from one reserved region, reusing the memory of freed code */
+#if ENABLE(ASSEMBLER) && ((OS(DARWIN) && CPU(X86_64)) || (PLATFORM(ANDROID) && CPU(ARM)))
+#define ENABLE_EXECUTABLE_ALLOCATOR_FIXED 1
+#endif
+
 #if !defined(ENABLE_PAN_SCROLLING) && OS(WINDOWS)
 #define ENABLE_PAN_SCROLLING 1
 #endif
@@ -991,4 +999,39 @@
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Generational collection keeps the cells that survive a collection marked,
+   so that most collections only trace what was allocated since the last one.
+   The JIT emits the write barrier for put_by_id and its transition stubs. */
+#if !defined(ENABLE_JSC_GENERATIONAL_GC)
+#if PLATFORM(ANDROID)
+#define ENABLE_JSC_GENERATIONAL_GC 1
+#else
+#define ENABLE_JSC_GENERATIONAL_GC 0
+#endif
+#endif
+
+/* Incremental marking traces young collections in slices that the embedder
+   runs from its event loop. It relies on the generational write barrier. */
+#if !defined(ENABLE_JSC_INCREMENTAL_MARKING)
+#if ENABLE(JSC_GENERATIONAL_GC) && PLATFORM(ANDROID)
+#define ENABLE_JSC_INCREMENTAL_MARKING 1
+#else
+#define ENABLE_JSC_INCREMENTAL_MARKING 0
+#endif
+#endif
+
+#if ENABLE(JSC_INCREMENTAL_MARKING) && !ENABLE(JSC_GENERATIONAL_GC)
+#error "JSC_INCREMENTAL_MARKING requires JSC_GENERATIONAL_GC"
+#endif
+
+/* Parallel marking traces the heap on helper threads as well as the one
+   collecting, for multi-core devices. */
+#if !defined(ENABLE_JSC_PARALLEL_MARKING)
+#define ENABLE_JSC_PARALLEL_MARKING 0
+#endif
+
+#if ENABLE(JSC_PARALLEL_MARKING) && !(OS(ANDROID) || OS(DARWIN) || COMPILER(GCC))
+#error "JSC_PARALLEL_MARKING needs WTF::atomicOr"
+#endif
+
 #endif /* WTF_Platform_h */
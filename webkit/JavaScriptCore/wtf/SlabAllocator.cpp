@@ -0,0 +1,104 @@
+#include "config.h"
+#include "SlabAllocator.h"
+
+#include "Assertions.h"
+#include "FastMalloc.h"
+#include "TCSpinLock.h"
+
+namespace WTF {
+
+static const size_t slabSize = 4096;
+static const size_t sizeClassShift = 3;
+static const size_t maxSlabObjectSize = 256;
+static const size_t sizeClassCount = maxSlabObjectSize >> sizeClassShift;
+
+struct FreeObject {
+    FreeObject* next;
+};
+
+struct SizeClass {
+    FreeObject* freeList;
+    size_t liveObjects;
+    size_t slabCount;
+};
+
+// Allocation is a few instructions, so one lock for all size classes is
+// cheaper than keeping one per class.
+static SpinLock slabLock = SPINLOCK_INITIALIZER;
+static SizeClass sizeClasses[sizeClassCount];
+
+static inline size_t sizeClassIndex(size_t size)
+{
+    ASSERT(size && size <= maxSlabObjectSize);
+    return (size - 1) >> sizeClassShift;
+}
+
+static inline size_t objectSizeForSizeClass(size_t index)
+{
+    return (index + 1) << sizeClassShift;
+}
+
+static void addSlab(SizeClass& sizeClass, size_t objectSize)
+{
+    char* slab = static_cast<char*>(fastMalloc(slabSize));
+    // Thread the free list in address order, so that objects allocated
+    // together end up next to each other.
+    for (size_t i = slabSize / objectSize; i--; ) {
+        FreeObject* object = reinterpret_cast<FreeObject*>(slab + i * objectSize);
+        object->next = sizeClass.freeList;
+        sizeClass.freeList = object;
+    }
+    ++sizeClass.slabCount;
+}
+
+void* slabAllocate(size_t size)
+{
+    if (size > maxSlabObjectSize)
+        return fastMalloc(size);
+    if (!size)
+        size = 1;
+
+    size_t index = sizeClassIndex(size);
+    SpinLockHolder holder(&slabLock);
+    SizeClass& sizeClass = sizeClasses[index];
+    if (!sizeClass.freeList)
+        addSlab(sizeClass, objectSizeForSizeClass(index));
+    FreeObject* object = sizeClass.freeList;
+    sizeClass.freeList = object->next;
+    ++sizeClass.liveObjects;
+    return object;
+}
+
+void slabFree(void* p, size_t size)
+{
+    if (!p)
+        return;
+    if (size > maxSlabObjectSize) {
+        fastFree(p);
+        return;
+    }
+    if (!size)
+        size = 1;
+
+    SpinLockHolder holder(&slabLock);
+    SizeClass& sizeClass = sizeClasses[sizeClassIndex(size)];
+    ASSERT(sizeClass.liveObjects);
+    FreeObject* object = static_cast<FreeObject*>(p);
+    object->next = sizeClass.freeList;
+    sizeClass.freeList = object;
+    --sizeClass.liveObjects;
+}
+
+SlabAllocatorStatistics slabAllocatorStatistics()
+{
+    SlabAllocatorStatistics statistics = { 0, 0, 0 };
+    SpinLockHolder holder(&slabLock);
+    for (size_t i = 0; i < sizeClassCount; ++i) {
+        statistics.liveObjects += sizeClasses[i].liveObjects;
+        statistics.liveBytes += sizeClasses[i].liveObjects * objectSizeForSizeClass(i);
+        statistics.slabBytes += sizeClasses[i].slabCount * slabSize;
+    }
+    return statistics;
+}
+
+} // namespace WTF
@@ -0,0 +1,41 @@
+#ifndef SlabAllocator_h
+#define SlabAllocator_h
+
+#include <new>
+#include <stddef.h>
+
+namespace WTF {
+
+    // Allocates small objects from 4KB slabs, with one pool per 8 byte size
+    // class, so that the small objects WebCore creates by the million don't
+    // each pay malloc's per-allocation overhead. Larger sizes go to
+    // fastMalloc. Slabs are kept once allocated; freed objects are reused by
+    // later allocations of the same size class.
+    void* slabAllocate(size_t);
+    void slabFree(void*, size_t);
+
+    struct SlabAllocatorStatistics {
+        size_t liveObjects;
+        size_t liveBytes;
+        // Everything held in slabs, live or free. What isn't live is lost
+        // to fragmentation until objects of the same size class reuse it.
+        size_t slabBytes;
+    };
+    SlabAllocatorStatistics slabAllocatorStatistics();
+
+} // namespace WTF
+
+using WTF::SlabAllocatorStatistics;
+using WTF::slabAllocatorStatistics;
+
+// Put at the top of a class to allocate its instances with slabAllocate.
+// delete passes the size of the object back, so classes whose instances
+// are deleted through a base class pointer need a virtual destructor.
+#define WTF_MAKE_SLAB_ALLOCATED \
+public: \
+    void* operator new(size_t, void* p) { return p; } \
+    void* operator new(size_t size) { return WTF::slabAllocate(size); } \
+    void operator delete(void* p, size_t size) { WTF::slabFree(p, size); } \
+private:
+
+#endif // SlabAllocator_h
@@ -9,6 +9,64 @@ namespace WTF {
 // Golden ratio - arbitrary start value to avoid mapping all 0's to all 0's
 static const unsigned stringHashingStartValue = 0x9e3779b9U;
 
+// Computes the same hash as stringHash() one character at a time, for
+// when the characters are being scanned anyway.
+class StringHasher {
+public:
+    StringHasher()
+        : m_hash(stringHashingStartValue)
+        , m_hasPendingCharacter(false)
+        , m_pendingCharacter(0)
+    {
+    }
+
+    void addCharacter(UChar character)
+    {
+        if (!m_hasPendingCharacter) {
+            m_pendingCharacter = character;
+            m_hasPendingCharacter = true;
+            return;
+        }
+        m_hash += m_pendingCharacter;
+        unsigned tmp = (character << 11) ^ m_hash;
+        m_hash = (m_hash << 16) ^ tmp;
+        m_hash += m_hash >> 11;
+        m_hasPendingCharacter = false;
+    }
+
+    unsigned hash() const
+    {
+        unsigned hash = m_hash;
+
+        // Handle end case
+        if (m_hasPendingCharacter) {
+            hash += m_pendingCharacter;
+            hash ^= hash << 11;
+            hash += hash >> 17;
+        }
+
+        // Force "avalanching" of final 127 bits
+        hash ^= hash << 3;
+        hash += hash >> 5;
+        hash ^= hash << 2;
+        hash += hash >> 15;
+        hash ^= hash << 10;
+
+        hash &= 0x7fffffff;
+
+        // See stringHash() for why 0 isn't returned.
+        if (hash == 0)
+            hash = 0x40000000;
+
+        return hash;
+    }
+
+private:
+    unsigned m_hash;
+    bool m_hasPendingCharacter;
+    UChar m_pendingCharacter;
+};
+
 // stringHash methods based on Paul Hsieh's SuperFastHash.
 // http://www.azillionmonkeys.com/qed/hash.html
 // char* data is interpreted as latin-encoded (zero extended to 16 bits).
@@ -136,4 +194,6 @@ inline unsigned stringHash(const char* data)
 
 } // namespace WTF
 
+using WTF::StringHasher;
+
 #endif // WTF_StringHashFunctions_h
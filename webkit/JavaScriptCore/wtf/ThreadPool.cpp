@@ -0,0 +1,165 @@
+#include "config.h"
+#include "ThreadPool.h"
+
+#include "Deque.h"
+#include "Noncopyable.h"
+#include "Threading.h"
+#include "Vector.h"
+#include <algorithm>
+#if OS(UNIX)
+#include <unistd.h>
+#endif
+
+namespace WTF {
+
+static const unsigned minWorkerThreads = 2;
+static const unsigned maxWorkerThreads = 4;
+static const unsigned priorityCount = LowBackgroundPriority + 1;
+
+struct BackgroundTask {
+    BackgroundFunction* function;
+    void* context;
+};
+
+class ThreadPool;
+
+struct BackgroundWorker : Noncopyable {
+    BackgroundWorker(ThreadPool* pool) : pool(pool), thread(0) { }
+
+    ThreadPool* pool;
+    ThreadIdentifier thread;
+    Mutex lock;
+    Deque<BackgroundTask> queues[priorityCount];
+};
+
+class ThreadPool : public Noncopyable {
+public:
+    ThreadPool();
+
+    void dispatch(BackgroundFunction*, void* context, BackgroundPriority);
+
+private:
+    static void* workerThreadMain(void*);
+    void runWorker(BackgroundWorker*);
+    bool take(BackgroundWorker*, BackgroundTask&);
+    static bool takeFrom(BackgroundWorker*, unsigned priority, BackgroundTask&);
+
+    Vector<BackgroundWorker*> m_workers;
+    Mutex m_lock;
+    ThreadCondition m_workAvailable;
+    // dispatched minus taken; briefly negative when a task is taken before
+    // its dispatch is counted
+    int m_pendingTasks;
+    unsigned m_nextWorker;
+};
+
+static unsigned workerThreadCount()
+{
+    unsigned count = minWorkerThreads;
+#if OS(UNIX)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0)
+        count = std::max(count, static_cast<unsigned>(cores));
+#endif
+    return std::min(count, maxWorkerThreads);
+}
+
+ThreadPool::ThreadPool()
+    : m_pendingTasks(0)
+    , m_nextWorker(0)
+{
+    unsigned count = workerThreadCount();
+    for (unsigned i = 0; i < count; ++i)
+        m_workers.append(new BackgroundWorker(this));
+    // The workers never exit, so nothing waits for or detaches them.
+    for (unsigned i = 0; i < count; ++i)
+        m_workers[i]->thread = createThread(workerThreadMain, m_workers[i], "WebKit: Background");
+}
+
+void* ThreadPool::workerThreadMain(void* worker)
+{
+    BackgroundWorker* self = static_cast<BackgroundWorker*>(worker);
+    self->pool->runWorker(self);
+    return 0;
+}
+
+void ThreadPool::dispatch(BackgroundFunction* function, void* context, BackgroundPriority priority)
+{
+    BackgroundTask task = { function, context };
+
+    // Work queued from a worker stays on it, for locality; everything else
+    // is spread round robin.
+    ThreadIdentifier current = currentThread();
+    BackgroundWorker* worker = 0;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        if (m_workers[i]->thread == current) {
+            worker = m_workers[i];
+            break;
+        }
+    }
+
+    MutexLocker locker(m_lock);
+    if (!worker)
+        worker = m_workers[m_nextWorker++ % m_workers.size()];
+    {
+        MutexLocker workerLocker(worker->lock);
+        worker->queues[priority].append(task);
+    }
+    ++m_pendingTasks;
+    m_workAvailable.signal();
+}
+
+bool ThreadPool::takeFrom(BackgroundWorker* worker, unsigned priority, BackgroundTask& task)
+{
+    MutexLocker locker(worker->lock);
+    Deque<BackgroundTask>& queue = worker->queues[priority];
+    if (queue.isEmpty())
+        return false;
+    task = queue.first();
+    queue.removeFirst();
+    return true;
+}
+
+bool ThreadPool::take(BackgroundWorker* self, BackgroundTask& task)
+{
+    for (unsigned priority = 0; priority < priorityCount; ++priority) {
+        if (takeFrom(self, priority, task))
+            return true;
+        for (size_t i = 0; i < m_workers.size(); ++i) {
+            if (m_workers[i] != self && takeFrom(m_workers[i], priority, task))
+                return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runWorker(BackgroundWorker* self)
+{
+    while (true) {
+        BackgroundTask task;
+        if (take(self, task)) {
+            {
+                MutexLocker locker(m_lock);
+                --m_pendingTasks;
+            }
+            task.function(task.context);
+            continue;
+        }
+        MutexLocker locker(m_lock);
+        while (m_pendingTasks <= 0)
+            m_workAvailable.wait(m_lock);
+    }
+}
+
+static ThreadPool& threadPool()
+{
+    AtomicallyInitializedStatic(ThreadPool*, pool = new ThreadPool);
+    return *pool;
+}
+
+void dispatchToBackground(BackgroundFunction* function, void* context, BackgroundPriority priority)
+{
+    threadPool().dispatch(function, context, priority);
+}
+
+} // namespace WTF
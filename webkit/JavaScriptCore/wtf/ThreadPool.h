@@ -0,0 +1,30 @@
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+namespace WTF {
+
+typedef void BackgroundFunction(void*);
+
+enum BackgroundPriority {
+    HighBackgroundPriority,
+    NormalBackgroundPriority,
+    LowBackgroundPriority
+};
+
+// Runs function(context) on one of a small pool of threads shared by all
+// of WebKit, sized to the number of cores. Higher priority work is always
+// taken first; idle threads steal work queued on busy ones. Functions may
+// block, but should not wait on each other, and nothing runs them in any
+// particular order: work that must be serialized has to keep at most one
+// function in flight at a time.
+void dispatchToBackground(BackgroundFunction*, void* context, BackgroundPriority = NormalBackgroundPriority);
+
+} // namespace WTF
+
+using WTF::BackgroundPriority;
+using WTF::HighBackgroundPriority;
+using WTF::NormalBackgroundPriority;
+using WTF::LowBackgroundPriority;
+using WTF::dispatchToBackground;
+
+#endif // ThreadPool_h
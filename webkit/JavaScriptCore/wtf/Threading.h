@@ -77,7 +77,14 @@ typedef pthread_mutex_t PlatformMutex;
 #if HAVE(PTHREAD_RWLOCK)
 typedef pthread_rwlock_t PlatformReadWriteLock;
 #else
-typedef void* PlatformReadWriteLock;
+// For pthreads implementations without rwlocks, such as Android's.
+struct PlatformReadWriteLock {
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_readerCondition;
+    pthread_cond_t m_writerCondition;
+    int m_readers; // -1 while a writer holds the lock
+    unsigned m_waitingWriters;
+};
 #endif
 typedef pthread_cond_t PlatformCondition;
 #elif PLATFORM(GTK)
@@ -111,6 +118,9 @@ typedef void* PlatformReadWriteLock;
 typedef void* PlatformCondition;
 #endif
     
+// With pthreads on a multiprocessor, lock() spins on tryLock() for a short
+// while before blocking, since most critical sections are only a few
+// instructions long and the holder is likely running on another core.
 class Mutex : public Noncopyable {
 public:
     Mutex();
@@ -128,6 +138,8 @@ private:
 
 typedef Locker<Mutex> MutexLocker;
 
+// Readers don't block each other. Without pthread rwlocks, waiting writers
+// take precedence over new readers so that they can't be starved.
 class ReadWriteLock : public Noncopyable {
 public:
     ReadWriteLock();
@@ -177,17 +189,23 @@ inline int atomicDecrement(int volatile* addend) { return InterlockedDecrement(r
 
 inline int atomicIncrement(int volatile* addend) { return OSAtomicIncrement32Barrier(const_cast<int*>(addend)); }
 inline int atomicDecrement(int volatile* addend) { return OSAtomicDecrement32Barrier(const_cast<int*>(addend)); }
+// returns the old value
+inline int atomicOr(int volatile* address, int mask) { return OSAtomicOr32OrigBarrier(mask, reinterpret_cast<uint32_t volatile*>(address)); }
 
 #elif OS(ANDROID)
 
 inline int atomicIncrement(int volatile* addend) { return android_atomic_inc(addend); }
 inline int atomicDecrement(int volatile* addend) { return android_atomic_dec(addend); }
+// returns the old value
+inline int atomicOr(int volatile* address, int mask) { return android_atomic_or(mask, address); }
 
 #elif COMPILER(GCC) && !CPU(SPARC64) // sizeof(_Atomic_word) != sizeof(int) on sparc64 gcc
 #define WTF_USE_LOCKFREE_THREADSAFESHARED 1
 
 inline int atomicIncrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, 1) + 1; }
 inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, -1) - 1; }
+// returns the old value
+inline int atomicOr(int volatile* address, int mask) { return __sync_fetch_and_or(address, mask); }
 
 #endif
 
@@ -276,6 +294,7 @@ void unlockAtomicallyInitializedStaticMutex();
 
 using WTF::Mutex;
 using WTF::MutexLocker;
+using WTF::ReadWriteLock;
 using WTF::ThreadCondition;
 using WTF::ThreadIdentifier;
 using WTF::ThreadSafeShared;
@@ -20,6 +20,10 @@
 #include <sys/time.h>
 #endif
 
+#if OS(UNIX)
+#include <unistd.h>
+#endif
+
 #if OS(ANDROID)
 #include "JNIUtility.h"
 #endif
@@ -30,6 +34,11 @@ typedef HashMap<ThreadIdentifier, pthread_t> ThreadMap;
 
 static Mutex* atomicallyInitializedStaticMutex;
 
+// tryLock() attempts Mutex::lock() makes before blocking. Left at 0 on
+// uniprocessors, where the holder can't make progress while we spin.
+static const unsigned multiprocessorMutexSpinCount = 100;
+static unsigned mutexSpinCount;
+
 #if !OS(DARWIN) || PLATFORM(CHROMIUM) || USE(WEB_THREAD)
 static pthread_t mainThread; // The thread that was the first to call initializeThreading(), which must be the main thread.
 #endif
@@ -48,6 +57,10 @@ void initializeThreading()
         atomicallyInitializedStaticMutex = new Mutex;
         threadMapMutex();
         initializeRandomNumberGenerator();
+#if OS(UNIX)
+        if (sysconf(_SC_NPROCESSORS_ONLN) > 1)
+            mutexSpinCount = multiprocessorMutexSpinCount;
+#endif
 #if !OS(DARWIN) || PLATFORM(CHROMIUM) || USE(WEB_THREAD)
         mainThread = pthread_self();
 #endif
@@ -234,6 +247,10 @@ Mutex::~Mutex()
 
 void Mutex::lock()
 {
+    for (unsigned i = 0; i < mutexSpinCount; ++i) {
+        if (!pthread_mutex_trylock(&m_mutex))
+            return;
+    }
     int result = pthread_mutex_lock(&m_mutex);
     ASSERT_UNUSED(result, !result);
 }
@@ -311,6 +328,80 @@ void ReadWriteLock::unlock()
     int result = pthread_rwlock_unlock(&m_readWriteLock);
     ASSERT_UNUSED(result, !result);
 }
+#else
+ReadWriteLock::ReadWriteLock()
+{
+    pthread_mutex_init(&m_readWriteLock.m_mutex, NULL);
+    pthread_cond_init(&m_readWriteLock.m_readerCondition, NULL);
+    pthread_cond_init(&m_readWriteLock.m_writerCondition, NULL);
+    m_readWriteLock.m_readers = 0;
+    m_readWriteLock.m_waitingWriters = 0;
+}
+
+ReadWriteLock::~ReadWriteLock()
+{
+    ASSERT(!m_readWriteLock.m_readers);
+    pthread_cond_destroy(&m_readWriteLock.m_writerCondition);
+    pthread_cond_destroy(&m_readWriteLock.m_readerCondition);
+    pthread_mutex_destroy(&m_readWriteLock.m_mutex);
+}
+
+void ReadWriteLock::readLock()
+{
+    pthread_mutex_lock(&m_readWriteLock.m_mutex);
+    while (m_readWriteLock.m_readers < 0 || m_readWriteLock.m_waitingWriters)
+        pthread_cond_wait(&m_readWriteLock.m_readerCondition, &m_readWriteLock.m_mutex);
+    ++m_readWriteLock.m_readers;
+    pthread_mutex_unlock(&m_readWriteLock.m_mutex);
+}
+
+bool ReadWriteLock::tryReadLock()
+{
+    pthread_mutex_lock(&m_readWriteLock.m_mutex);
+    bool locked = m_readWriteLock.m_readers >= 0 && !m_readWriteLock.m_waitingWriters;
+    if (locked)
+        ++m_readWriteLock.m_readers;
+    pthread_mutex_unlock(&m_readWriteLock.m_mutex);
+    return locked;
+}
+
+void ReadWriteLock::writeLock()
+{
+    pthread_mutex_lock(&m_readWriteLock.m_mutex);
+    ++m_readWriteLock.m_waitingWriters;
+    while (m_readWriteLock.m_readers)
+        pthread_cond_wait(&m_readWriteLock.m_writerCondition, &m_readWriteLock.m_mutex);
+    --m_readWriteLock.m_waitingWriters;
+    m_readWriteLock.m_readers = -1;
+    pthread_mutex_unlock(&m_readWriteLock.m_mutex);
+}
+
+bool ReadWriteLock::tryWriteLock()
+{
+    pthread_mutex_lock(&m_readWriteLock.m_mutex);
+    bool locked = !m_readWriteLock.m_readers;
+    if (locked)
+        m_readWriteLock.m_readers = -1;
+    pthread_mutex_unlock(&m_readWriteLock.m_mutex);
+    return locked;
+}
+
+void ReadWriteLock::unlock()
+{
+    pthread_mutex_lock(&m_readWriteLock.m_mutex);
+    ASSERT(m_readWriteLock.m_readers);
+    if (m_readWriteLock.m_readers < 0)
+        m_readWriteLock.m_readers = 0;
+    else
+        --m_readWriteLock.m_readers;
+    if (!m_readWriteLock.m_readers) {
+        if (m_readWriteLock.m_waitingWriters)
+            pthread_cond_signal(&m_readWriteLock.m_writerCondition);
+        else
+            pthread_cond_broadcast(&m_readWriteLock.m_readerCondition);
+    }
+    pthread_mutex_unlock(&m_readWriteLock.m_mutex);
+}
 #endif  // HAVE(PTHREAD_RWLOCK)
 
 ThreadCondition::ThreadCondition()
@@ -0,0 +1,91 @@
+#ifndef VectorSizeProfile_h
+#define VectorSizeProfile_h
+
+// Set to 1 to have each PROFILE_VECTOR_SIZE print, at exit, a histogram of
+// the sizes its vector had when it went out of scope. Use it to pick
+// inline capacities for temporaries.
+#define DUMP_VECTOR_SIZE_PROFILE 0
+
+#if DUMP_VECTOR_SIZE_PROFILE
+
+#include "Noncopyable.h"
+#include <stdio.h>
+
+namespace WTF {
+
+    class VectorSizeProfile : Noncopyable {
+    public:
+        VectorSizeProfile(const char* site)
+            : m_site(site)
+            , m_count(0)
+            , m_maxSize(0)
+        {
+            for (size_t i = 0; i < bucketCount; ++i)
+                m_buckets[i] = 0;
+        }
+
+        ~VectorSizeProfile()
+        {
+            printf("%s: %lu vectors, largest %lu\n", m_site, static_cast<unsigned long>(m_count), static_cast<unsigned long>(m_maxSize));
+            for (size_t i = 0; i < bucketCount - 1; ++i)
+                printf("    <= %lu: %lu\n", static_cast<unsigned long>(bucketLimit(i)), static_cast<unsigned long>(m_buckets[i]));
+            printf("    more: %lu\n", static_cast<unsigned long>(m_buckets[bucketCount - 1]));
+        }
+
+        void record(size_t size)
+        {
+            size_t bucket = 0;
+            while (bucket < bucketCount - 1 && size > bucketLimit(bucket))
+                ++bucket;
+            ++m_buckets[bucket];
+            ++m_count;
+            if (size > m_maxSize)
+                m_maxSize = size;
+        }
+
+    private:
+        // 0, 1, 2, 4, ..., 256 and everything larger
+        static const size_t bucketCount = 11;
+        static size_t bucketLimit(size_t bucket) { return bucket ? 1 << (bucket - 1) : 0; }
+
+        const char* m_site;
+        size_t m_count;
+        size_t m_maxSize;
+        size_t m_buckets[bucketCount];
+    };
+
+    // Records the size of a vector into a VectorSizeProfile when it goes
+    // out of scope.
+    class VectorSizeRecorder : Noncopyable {
+    public:
+        template<typename VectorType> VectorSizeRecorder(VectorSizeProfile& profile, const VectorType& vector)
+            : m_profile(profile)
+            , m_vector(&vector)
+            , m_size(&sizeOf<VectorType>)
+        {
+        }
+
+        ~VectorSizeRecorder() { m_profile.record(m_size(m_vector)); }
+
+    private:
+        template<typename VectorType> static size_t sizeOf(const void* vector) { return static_cast<const VectorType*>(vector)->size(); }
+
+        VectorSizeProfile& m_profile;
+        const void* m_vector;
+        size_t (*m_size)(const void*);
+    };
+
+} // namespace WTF
+
+// Place right after the declaration of a local vector.
+#define PROFILE_VECTOR_SIZE(vector) \
+    static WTF::VectorSizeProfile vector##SizeProfile(__FILE__ ": " #vector); \
+    WTF::VectorSizeRecorder vector##SizeRecorder(vector##SizeProfile, vector)
+
+#else
+
+#define PROFILE_VECTOR_SIZE(vector)
+
+#endif // DUMP_VECTOR_SIZE_PROFILE
+
+#endif // VectorSizeProfile_h
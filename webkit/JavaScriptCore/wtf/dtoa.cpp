@@ -18,6 +18,7 @@
 #include <string.h>
 #include <wtf/AlwaysInline.h>
 #include <wtf/Assertions.h>
+#include <wtf/FastDtoa.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/MathExtras.h>
 #include <wtf/Vector.h>
@@ -1760,6 +1761,13 @@ void dtoa(DtoaBuffer result, double dd, int ndigits, int* decpt, int* sign, char
         return;
     }
 
+    int fastLength;
+    if (fastDtoa(dval(&u), result, &fastLength, decpt)) {
+        if (rve)
+            *rve = result + fastLength;
+        return;
+    }
+
 #ifdef SET_INEXACT
     try_quick = oldinexact = get_inexact();
     inexact = 1;
@@ -850,6 +850,41 @@ class RegexGenerator : private MacroAssembler {
         }
     }
 
+    void generateBackReference(TermGenerationState& state)
+    {
+        const RegisterID characterPosition = regT0;
+        const RegisterID character = regT1;
+        PatternTerm& term = state.term();
+        unsigned subpatternId = term.subpatternId;
+
+        storeToFrame(index, term.frameLocation);
+
+        // Compare the characters the subpattern matched, one at a time. The
+        // loop ends straight away for a subpattern that hasn't matched (or
+        // hasn't finished matching), whose start or end is still -1, so it
+        // matches the empty string.
+        load32(Address(output, (subpatternId << 1) * sizeof(int)), characterPosition);
+        JumpList failures;
+        Label loop(this);
+        Jump matched = branch32(GreaterThanOrEqual, characterPosition, Address(output, ((subpatternId << 1) + 1) * sizeof(int)));
+        failures.append(atEndOfInput());
+        readCharacter(state.inputOffset(), character);
+        failures.append(branch16(NotEqual, BaseIndex(input, characterPosition, TimesTwo), character));
+        add32(Imm32(1), characterPosition);
+        add32(Imm32(1), index);
+        jump().linkTo(loop, this);
+
+        // A back reference can only match one way, so backtracking into it
+        // just undoes the match.
+        Label backtrackBegin(this);
+        failures.link(this);
+        loadFromFrame(term.frameLocation, index);
+        state.jumpToBacktrack(jump(), this);
+
+        matched.link(this);
+        state.setBacktrackGenerated(backtrackBegin);
+    }
+
     void generateParenthesesSingle(TermGenerationState& state)
     {
         const RegisterID indexTemporary = regT0;
@@ -1055,7 +1090,10 @@ class RegexGenerator : private MacroAssembler {
             break;
 
         case PatternTerm::TypeBackReference:
-            m_generationFailed = true;
+            if (!m_pattern.m_ignoreCase && (term.quantityType == QuantifierFixedCount) && (term.quantityCount == 1))
+                generateBackReference(state);
+            else
+                m_generationFailed = true;
             break;
 
         case PatternTerm::TypeForwardReference:
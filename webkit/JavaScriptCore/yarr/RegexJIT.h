@@ -33,6 +33,7 @@ class RegexCodeBlock {
 public:
     RegexCodeBlock()
         : m_fallback(0)
+        , m_executionCount(0)
     {
     }
 
@@ -45,6 +46,11 @@ public:
     JSRegExp* getFallback() { return m_fallback; }
     void setFallback(JSRegExp* fallback) { m_fallback = fallback; }
 
+    // Matches run so far, by PCRE if the pattern has a fallback and by the
+    // JIT code otherwise.
+    unsigned executionCount() const { return m_executionCount; }
+    void didExecute() { ++m_executionCount; }
+
     bool operator!() { return !m_ref.m_code.executableAddress(); }
     void set(MacroAssembler::CodeRef ref) { m_ref = ref; }
 
@@ -56,12 +62,14 @@ public:
 private:
     MacroAssembler::CodeRef m_ref;
     JSRegExp* m_fallback;
+    unsigned m_executionCount;
 };
 
 void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& pattern, unsigned& numSubpatterns, const char*& error, bool ignoreCase = false, bool multiline = false);
 
 inline int executeRegex(RegexCodeBlock& jitObject, const UChar* input, unsigned start, unsigned length, int* output, int outputArraySize)
 {
+    jitObject.didExecute();
     if (JSRegExp* fallback = jitObject.getFallback())
         return (jsRegExpExecute(fallback, input, length, start, output, outputArraySize) < 0) ? -1 : output[0];
 
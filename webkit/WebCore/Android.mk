@@ -260,6 +260,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	loader/CachedScript.cpp \
 	loader/CrossOriginAccessControl.cpp \
 	loader/CrossOriginPreflightResultCache.cpp \
+	loader/DiskCache.cpp \
 	loader/DocLoader.cpp \
 	loader/DocumentLoader.cpp \
 	loader/DocumentThreadableLoader.cpp \
@@ -485,6 +486,8 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/image-decoders/skia/ImageDecoderSkia.cpp \
 	platform/image-decoders/gif/GIFImageDecoder.cpp \
 	platform/image-decoders/gif/GIFImageReader.cpp \
+	platform/image-decoders/jpeg/JPEGImageDecoder.cpp \
+	platform/image-decoders/png/PNGImageDecoder.cpp \
 	\
 	platform/mock/GeolocationServiceMock.cpp \
 	\
@@ -531,6 +534,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/text/TextCodecICU.cpp \
 	platform/text/TextCodecLatin1.cpp \
 	platform/text/TextCodecUTF16.cpp \
+	platform/text/TextCodecUTF8.cpp \
 	platform/text/TextCodecUserDefined.cpp \
 	platform/text/TextEncoding.cpp \
 	platform/text/TextEncodingDetectorICU.cpp \
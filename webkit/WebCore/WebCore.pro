@@ -694,6 +694,7 @@ SOURCES += \
     loader/CachedXSLStyleSheet.cpp \
     loader/CrossOriginAccessControl.cpp \
     loader/CrossOriginPreflightResultCache.cpp \
+    loader/DiskCache.cpp \
     loader/DocLoader.cpp \
     loader/DocumentLoader.cpp \
     loader/DocumentThreadableLoader.cpp \
@@ -851,6 +852,7 @@ SOURCES += \
     platform/text/TextCodecLatin1.cpp \
     platform/text/TextCodecUserDefined.cpp \
     platform/text/TextCodecUTF16.cpp \
+    platform/text/TextCodecUTF8.cpp \
     platform/text/TextEncoding.cpp \
     platform/text/TextEncodingDetectorNone.cpp \
     platform/text/TextEncodingRegistry.cpp \
@@ -1397,6 +1399,7 @@ HEADERS += \
     loader/Cache.h \
     loader/CrossOriginAccessControl.h \
     loader/CrossOriginPreflightResultCache.h \
+    loader/DiskCache.h \
     loader/DocLoader.h \
     loader/DocumentLoader.h \
     loader/DocumentThreadableLoader.h \
@@ -1559,6 +1562,7 @@ HEADERS += \
     platform/sql/SQLiteStatement.h \
     platform/sql/SQLiteTransaction.h \
     platform/sql/SQLValue.h \
+    platform/text/ASCIIFastPath.h \
     platform/text/AtomicString.h \
     platform/text/Base64.h \
     platform/text/BidiContext.h \
@@ -1572,6 +1576,7 @@ HEADERS += \
     platform/text/TextCodecLatin1.h \
     platform/text/TextCodecUserDefined.h \
     platform/text/TextCodecUTF16.h \
+    platform/text/TextCodecUTF8.h \
     platform/text/TextEncoding.h \
     platform/text/TextEncodingRegistry.h \
     platform/text/TextStream.h \
@@ -17,6 +17,11 @@ using namespace JSC;
 
 namespace WebCore {
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+// Long enough to make progress, short enough not to delay a frame
+static const double markSliceTime = 0.004;
+#endif
+
 static void* collect(void*)
 {
     JSLock lock(SilenceAssertionsOnly);
@@ -32,6 +37,9 @@ GCController& gcController()
 
 GCController::GCController()
     : m_GCTimer(this, &GCController::gcTimerFired)
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    , m_markTimer(this, &GCController::markTimerFired)
+#endif
 {
 }
 
@@ -51,6 +59,32 @@ void GCController::garbageCollectNow()
     collect(0);
 }
 
+size_t GCController::garbageCollectAndReleaseMemoryNow()
+{
+    m_GCTimer.stop();
+    JSLock lock(SilenceAssertionsOnly);
+    Heap& heap = JSDOMWindow::commonJSGlobalData()->heap;
+    size_t size = heap.statistics().size;
+    heap.releaseFreeMemory();
+    size_t newSize = heap.statistics().size;
+    return size > newSize ? size - newSize : 0;
+}
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+void GCController::scheduleIncrementalMarking()
+{
+    if (!m_markTimer.isActive())
+        m_markTimer.startOneShot(0);
+}
+
+void GCController::markTimerFired(Timer<GCController>*)
+{
+    JSLock lock(SilenceAssertionsOnly);
+    if (!JSDOMWindow::commonJSGlobalData()->heap.markIncrementally(markSliceTime))
+        m_markTimer.startOneShot(0);
+}
+#endif
+
 void GCController::garbageCollectOnAlternateThreadForDebugging(bool waitUntilDone)
 {
 #if USE(PTHREADS)
@@ -14,14 +14,29 @@ namespace WebCore {
     public:
         void garbageCollectSoon();
         void garbageCollectNow(); // It's better to call garbageCollectSoon, unless you have a specific reason not to.
+        // For low memory: also gives the blocks that are left empty back to the system.
+        // Returns how many bytes the heap shrank by.
+        size_t garbageCollectAndReleaseMemoryNow();
 
         void garbageCollectOnAlternateThreadForDebugging(bool waitUntilDone); // Used for stress testing.
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Runs the heap's incremental marking in slices between other timers
+        // until the collection is done.
+        void scheduleIncrementalMarking();
+#endif
+
     private:
         GCController(); // Use gcController() instead
         void gcTimerFired(Timer<GCController>*);
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        void markTimerFired(Timer<GCController>*);
+#endif
         
         Timer<GCController> m_GCTimer;
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        Timer<GCController> m_markTimer;
+#endif
     };
 
     // Function to obtain the global GC controller.
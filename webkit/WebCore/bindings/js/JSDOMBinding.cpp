@@ -12,6 +12,7 @@
 #include "ExceptionBase.h"
 #include "ExceptionCode.h"
 #include "Frame.h"
+#include "GCController.h"
 #include "HTMLAudioElement.h"
 #include "HTMLCanvasElement.h"
 #include "HTMLImageElement.h"
@@ -179,6 +180,18 @@ private:
     HashSet<DOMWrapperWorld*>::iterator m_end;
 };
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+bool WebCoreJSClientData::scheduleIncrementalMarking()
+{
+    // GCController's timers run on the main thread, so worker heaps keep
+    // collecting in a single pause.
+    if (!isMainThread())
+        return false;
+    gcController().scheduleIncrementalMarking();
+    return true;
+}
+#endif
+
 DOMWrapperWorld* normalWorld(JSC::JSGlobalData& globalData)
 {
     JSGlobalData::ClientData* clientData = globalData.clientData;
@@ -254,8 +267,15 @@ bool hasCachedDOMNodeWrapperUnchecked(Document* document, Node* node)
 
 JSNode* getCachedDOMNodeWrapper(JSC::ExecState* exec, Document* document, Node* node)
 {
-    if (document)
-        return document->getWrapperCache(currentWorld(exec))->get(node);
+    if (document) {
+        DOMWrapperWorld* world = currentWorld(exec);
+        if (world->isNormal()) {
+            // Like the cache, don't hand out a wrapper awaiting destruction.
+            DOMObject* wrapper = node->wrapper();
+            return wrapper && Heap::isCellMarked(wrapper) ? static_cast<JSNode*>(wrapper) : 0;
+        }
+        return document->getWrapperCache(world)->get(node);
+    }
     return static_cast<JSNode*>(DOMObjectWrapperMapFor(exec).get(node));
 }
 
@@ -283,6 +303,9 @@ void forgetDOMObject(DOMObject* wrapper, void* objectHandle)
 
 void forgetDOMNode(JSNode* wrapper, Node* node, Document* document)
 {
+    if (node->wrapper() == wrapper)
+        node->clearWrapper();
+
     if (!document) {
         forgetDOMObject(wrapper, node);
         return;
@@ -306,7 +329,20 @@ void cacheDOMNodeWrapper(JSC::ExecState* exec, Document* document, Node* node, J
         return;
     }
     willCacheWrapper(wrapper);
-    document->getWrapperCache(currentWorld(exec))->set(node, wrapper);
+    DOMWrapperWorld* world = currentWorld(exec);
+    document->getWrapperCache(world)->set(node, wrapper);
+    if (world->isNormal())
+        node->setWrapper(wrapper);
+}
+
+// Every node in a cache has a live wrapper holding a reference to it.
+static void clearNodeWrappers(JSWrapperCache* wrappers)
+{
+    JSWrapperCache::iterator end = wrappers->uncheckedEnd();
+    for (JSWrapperCache::iterator it = wrappers->uncheckedBegin(); it != end; ++it) {
+        if (it->first->wrapper() == it->second)
+            it->first->clearWrapper();
+    }
 }
 
 void forgetAllDOMNodesForDocument(Document* document)
@@ -315,6 +351,8 @@ void forgetAllDOMNodesForDocument(Document* document)
     JSWrapperCacheMap& wrapperCacheMap = document->wrapperCacheMap();
     JSWrapperCacheMap::const_iterator wrappersMapEnd = wrapperCacheMap.end();
     for (JSWrapperCacheMap::const_iterator wrappersMapIter = wrapperCacheMap.begin(); wrappersMapIter != wrappersMapEnd; ++wrappersMapIter) {
+        if (wrappersMapIter->first->isNormal())
+            clearNodeWrappers(wrappersMapIter->second);
         delete wrappersMapIter->second;
         wrappersMapIter->first->forgetDocument(document);
     }
@@ -324,6 +362,8 @@ void forgetWorldOfDOMNodesForDocument(Document* document, DOMWrapperWorld* world
 {
     JSWrapperCache* wrappers = document->wrapperCacheMap().take(world);
     ASSERT(wrappers); // 'world' should only know about 'document' if 'document' knows about 'world'!
+    if (world->isNormal())
+        clearNodeWrappers(wrappers);
     delete wrappers;
 }
 
@@ -187,6 +187,10 @@ namespace WebCore {
 
         DOMWrapperWorld* normalWorld() { return m_normalWorld.get(); }
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        virtual bool scheduleIncrementalMarking();
+#endif
+
         void getAllWorlds(Vector<DOMWrapperWorld*>& worlds)
         {
             copyToVector(m_worldSet, worlds);
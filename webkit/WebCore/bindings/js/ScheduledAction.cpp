@@ -15,6 +15,9 @@
 #include "ScriptSourceCode.h"
 #include "ScriptValue.h"
 #include <runtime/JSLock.h>
+#ifdef ANDROID_INSTRUMENT
+#include <interpreter/Interpreter.h>
+#endif
 
 #if ENABLE(WORKERS)
 #include "JSWorkerContext.h"
@@ -30,15 +33,26 @@ ScheduledAction* ScheduledAction::create(ExecState* exec, const ArgList& args, D
 {
     JSValue v = args.at(0);
     CallData callData;
+    ScheduledAction* action;
     if (v.getCallData(callData) == CallTypeNone) {
         UString string = v.toString(exec);
         if (exec->hadException())
             return 0;
-        return new ScheduledAction(string, isolatedWorld);
+        action = new ScheduledAction(string, isolatedWorld);
+    } else {
+        ArgList argsTail;
+        args.getSlice(2, argsTail);
+        action = new ScheduledAction(v, argsTail, isolatedWorld);
     }
-    ArgList argsTail;
-    args.getSlice(2, argsTail);
-    return new ScheduledAction(v, argsTail, isolatedWorld);
+#ifdef ANDROID_INSTRUMENT
+    int signedLineNumber;
+    intptr_t sourceID;
+    UString sourceURL;
+    JSValue function;
+    exec->interpreter()->retrieveLastCaller(exec, signedLineNumber, sourceID, sourceURL, function);
+    action->m_sourceURL = sourceURL;
+#endif
+    return action;
 }
 
 ScheduledAction::ScheduledAction(JSValue function, const ArgList& args, DOMWrapperWorld* isolatedWorld)
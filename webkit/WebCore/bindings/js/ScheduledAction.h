@@ -29,6 +29,11 @@ namespace WebCore {
 
         void execute(ScriptExecutionContext*);
 
+#ifdef ANDROID_INSTRUMENT
+        // the script that called setTimeout or setInterval
+        const String& sourceURL() const { return m_sourceURL; }
+#endif
+
     private:
         ScheduledAction(JSC::JSValue function, const JSC::ArgList&, DOMWrapperWorld* isolatedWorld);
         ScheduledAction(const String& code, DOMWrapperWorld* isolatedWorld)
@@ -47,6 +52,9 @@ namespace WebCore {
         Vector<JSC::ProtectedJSValue> m_args;
         String m_code;
         RefPtr<DOMWrapperWorld> m_isolatedWorld;
+#ifdef ANDROID_INSTRUMENT
+        String m_sourceURL;
+#endif
     };
 
 } // namespace WebCore
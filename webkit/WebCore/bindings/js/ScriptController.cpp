@@ -22,6 +22,9 @@
 #include "XSSAuditor.h"
 #include "npruntime_impl.h"
 #include "runtime_root.h"
+#if PLATFORM(ANDROID)
+#include "TraceBuffer.h"
+#endif
 #include <debugger/Debugger.h>
 #include <runtime/InitializeThreading.h>
 #include <runtime/JSLock.h>
@@ -75,6 +78,9 @@ ScriptController::~ScriptController()
 
 ScriptValue ScriptController::evaluateInWorld(const ScriptSourceCode& sourceCode, DOMWrapperWorld* world)
 {
+#if PLATFORM(ANDROID)
+    android::TraceBufferAuto trace(android::TraceBuffer::JavaScriptTrace);
+#endif
     const SourceCode& jsSourceCode = sourceCode.jsSourceCode();
     String sourceURL = jsSourceCode.provider()->url();
 
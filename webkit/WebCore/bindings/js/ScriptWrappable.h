@@ -5,9 +5,21 @@
 
 namespace WebCore {
 
+class DOMObject;
+
+// Holds the object's wrapper in the normal world, so that finding it doesn't
+// take a hash lookup. JSDOMBinding keeps it in step with the wrapper caches,
+// which are still what the collector walks.
 class ScriptWrappable {
 public:
-    ScriptWrappable() { }
+    ScriptWrappable() : m_wrapper(0) { }
+
+    DOMObject* wrapper() const { return m_wrapper; }
+    void setWrapper(DOMObject* wrapper) { m_wrapper = wrapper; }
+    void clearWrapper() { m_wrapper = 0; }
+
+private:
+    DOMObject* m_wrapper;
 };
 
 } // namespace WebCore
@@ -30,6 +30,12 @@ namespace WebCore {
         virtual ~ScheduledAction();
         virtual void execute(ScriptExecutionContext*);
 
+#ifdef ANDROID_INSTRUMENT
+        // the script that called setTimeout or setInterval
+        const String& sourceURL() const { return m_sourceURL; }
+        void setSourceURL(const String& url) { m_sourceURL = url; }
+#endif
+
     private:
         void execute(V8Proxy*);
 #if ENABLE(WORKERS)
@@ -41,6 +47,9 @@ namespace WebCore {
         int m_argc;
         v8::Persistent<v8::Value>* m_argv;
         ScriptSourceCode m_code;
+#ifdef ANDROID_INSTRUMENT
+        String m_sourceURL;
+#endif
     };
 
 } // namespace WebCore
@@ -46,6 +46,10 @@
 #include "TimeCounter.h"
 #endif
 
+#if PLATFORM(ANDROID)
+#include "TraceBuffer.h"
+#endif
+
 #if PLATFORM(ANDROID)
 #include "CString.h"
 #endif
@@ -389,6 +393,9 @@ v8::Local<v8::Value> V8Proxy::runScript(v8::Handle<v8::Script> script, bool isIn
 v8::Local<v8::Value> V8Proxy::runScriptInternal(v8::Handle<v8::Script> script, bool isInlineCode)
 #endif
 {
+#if PLATFORM(ANDROID)
+    android::TraceBufferAuto trace(android::TraceBuffer::JavaScriptTrace);
+#endif
     if (script.IsEmpty())
         return notHandledByInterceptor();
 
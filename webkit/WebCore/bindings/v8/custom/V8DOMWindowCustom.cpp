@@ -102,9 +102,20 @@ v8::Handle<v8::Value> WindowSetTimeoutImpl(const v8::Arguments& args, bool singl
 
         delete[] params;
 
+#ifdef ANDROID_INSTRUMENT
+        String sourceURL;
+        if (V8Proxy::sourceName(sourceURL))
+            action->setSourceURL(sourceURL);
+#endif
         id = DOMTimer::install(scriptContext, action, timeout, singleShot);
     } else {
-        id = DOMTimer::install(scriptContext, new ScheduledAction(V8Proxy::context(imp->frame()), functionString), timeout, singleShot);
+        ScheduledAction* action = new ScheduledAction(V8Proxy::context(imp->frame()), functionString);
+#ifdef ANDROID_INSTRUMENT
+        String sourceURL;
+        if (V8Proxy::sourceName(sourceURL))
+            action->setSourceURL(sourceURL);
+#endif
+        id = DOMTimer::install(scriptContext, action, timeout, singleShot);
     }
 
     return v8::Integer::New(id);
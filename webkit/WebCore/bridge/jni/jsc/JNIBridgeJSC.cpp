@@ -42,6 +42,10 @@ JavaField::JavaField(JNIEnv* env, jobject aField)
     m_name = JavaString(env, fieldName);
 
     m_field = new JObjectWrapper(aField);
+
+    // Looked up on first use.
+    m_getterMethodID = 0;
+    m_setterMethodID = 0;
 }
 
 JSValue JavaArray::convertJObjectToArray(ExecState* exec, jobject anObject, const char* type, PassRefPtr<RootObject> rootObject)
@@ -52,6 +56,20 @@ JSValue JavaArray::convertJObjectToArray(ExecState* exec, jobject anObject, cons
     return new (exec) RuntimeArray(exec, new JavaArray(anObject, type, rootObject));
 }
 
+// A field only ever uses the accessors of java.lang.reflect.Field for its
+// own type, so the caller keeps a single ID for getting and one for setting.
+static jmethodID fieldMethodID(JNIEnv* env, jobject field, jmethodID& cachedID, const char* name, const char* sig)
+{
+    if (cachedID)
+        return cachedID;
+
+    if (jclass cls = env->GetObjectClass(field)) {
+        cachedID = env->GetMethodID(cls, name, sig);
+        env->DeleteLocalRef(cls);
+    }
+    return cachedID;
+}
+
 jvalue JavaField::dispatchValueFromInstance(ExecState* exec, const JavaInstance* instance, const char* name, const char* sig, JNIType returnType) const
 {
     jobject jinstance = instance->javaInstance();
@@ -60,20 +78,16 @@ jvalue JavaField::dispatchValueFromInstance(ExecState* exec, const JavaInstance*
     jvalue result;
 
     memset(&result, 0, sizeof(jvalue));
-    jclass cls = env->GetObjectClass(fieldJInstance);
-    if (cls) {
-        jmethodID mid = env->GetMethodID(cls, name, sig);
-        if (mid) {
-            RootObject* rootObject = instance->rootObject();
-            if (rootObject && rootObject->nativeHandle()) {
-                JSValue exceptionDescription;
-                jvalue args[1];
-
-                args[0].l = jinstance;
-                dispatchJNICall(exec, rootObject->nativeHandle(), fieldJInstance, false, returnType, mid, args, result, 0, exceptionDescription);
-                if (exceptionDescription)
-                    throwError(exec, GeneralError, exceptionDescription.toString(exec));
-            }
+    if (jmethodID mid = fieldMethodID(env, fieldJInstance, m_getterMethodID, name, sig)) {
+        RootObject* rootObject = instance->rootObject();
+        if (rootObject && rootObject->nativeHandle()) {
+            JSValue exceptionDescription;
+            jvalue args[1];
+
+            args[0].l = jinstance;
+            dispatchJNICall(exec, rootObject->nativeHandle(), fieldJInstance, false, returnType, mid, args, result, 0, exceptionDescription);
+            if (exceptionDescription)
+                throwError(exec, GeneralError, exceptionDescription.toString(exec));
         }
     }
     return result;
@@ -142,22 +156,18 @@ void JavaField::dispatchSetValueToInstance(ExecState* exec, const JavaInstance*
     jobject fieldJInstance = m_field->m_instance;
     JNIEnv* env = getJNIEnv();
 
-    jclass cls = env->GetObjectClass(fieldJInstance);
-    if (cls) {
-        jmethodID mid = env->GetMethodID(cls, name, sig);
-        if (mid) {
-            RootObject* rootObject = instance->rootObject();
-            if (rootObject && rootObject->nativeHandle()) {
-                JSValue exceptionDescription;
-                jvalue args[2];
-                jvalue result;
-
-                args[0].l = jinstance;
-                args[1] = javaValue;
-                dispatchJNICall(exec, rootObject->nativeHandle(), fieldJInstance, false, void_type, mid, args, result, 0, exceptionDescription);
-                if (exceptionDescription)
-                    throwError(exec, GeneralError, exceptionDescription.toString(exec));
-            }
+    if (jmethodID mid = fieldMethodID(env, fieldJInstance, m_setterMethodID, name, sig)) {
+        RootObject* rootObject = instance->rootObject();
+        if (rootObject && rootObject->nativeHandle()) {
+            JSValue exceptionDescription;
+            jvalue args[2];
+            jvalue result;
+
+            args[0].l = jinstance;
+            args[1] = javaValue;
+            dispatchJNICall(exec, rootObject->nativeHandle(), fieldJInstance, false, void_type, mid, args, result, 0, exceptionDescription);
+            if (exceptionDescription)
+                throwError(exec, GeneralError, exceptionDescription.toString(exec));
         }
     }
 }
@@ -33,6 +33,8 @@ private:
     JavaString m_type;
     JNIType m_JNIType;
     RefPtr<JObjectWrapper> m_field;
+    mutable jmethodID m_getterMethodID;
+    mutable jmethodID m_setterMethodID;
 };
 
 class JavaArray : public Array {
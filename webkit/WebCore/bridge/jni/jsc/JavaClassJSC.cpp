@@ -9,10 +9,43 @@
 #include "JSDOMWindow.h"
 #include <runtime/Identifier.h>
 #include <runtime/JSLock.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/Vector.h>
 
 using namespace JSC::Bindings;
 
+static Vector<JavaClass*>& sharedClasses()
+{
+    DEFINE_STATIC_LOCAL(Vector<JavaClass*>, classes, ());
+    return classes;
+}
+
+JavaClass* JavaClass::classForInstance(jobject anInstance)
+{
+    JNIEnv* env = getJNIEnv();
+    jclass instanceClass = env->GetObjectClass(anInstance);
+
+    // Few enough classes cross the bridge that a scan is cheaper than
+    // asking Java for something to hash.
+    Vector<JavaClass*>& classes = sharedClasses();
+    size_t size = classes.size();
+    for (size_t i = 0; i < size; ++i) {
+        if (env->IsSameObject(instanceClass, classes[i]->m_javaClass)) {
+            env->DeleteLocalRef(instanceClass);
+            return classes[i];
+        }
+    }
+    env->DeleteLocalRef(instanceClass);
+
+    // A class that couldn't be reflected on is kept as well, since instances
+    // don't own their class.
+    JavaClass* aClass = new JavaClass(anInstance);
+    classes.append(aClass);
+    return aClass;
+}
+
 JavaClass::JavaClass(jobject anInstance)
+    : m_javaClass(0)
 {
     jobject aClass = callJNIMethod<jobject>(anInstance, "getClass", "()Ljava/lang/Class;");
 
@@ -22,6 +55,9 @@ JavaClass::JavaClass(jobject anInstance)
         return;
     }
 
+    JNIEnv* env = getJNIEnv();
+    m_javaClass = env->NewGlobalRef(aClass);
+
     if (jstring className = (jstring)callJNIMethod<jobject>(aClass, "getName", "()Ljava/lang/String;")) {
         const char* classNameC = getCharactersFromJString(className);
         m_name = fastStrDup(classNameC);
@@ -30,7 +66,6 @@ JavaClass::JavaClass(jobject anInstance)
         m_name = fastStrDup("<Unknown>");
 
     int i;
-    JNIEnv* env = getJNIEnv();
 
     // Get the fields
     if (jarray fields = (jarray)callJNIMethod<jobject>(aClass, "getFields", "()[Ljava/lang/reflect/Field;")) {
@@ -74,6 +109,8 @@ JavaClass::JavaClass(jobject anInstance)
 
 JavaClass::~JavaClass()
 {
+    if (m_javaClass)
+        getJNIEnv()->DeleteGlobalRef(m_javaClass);
     fastFree(const_cast<char*>(m_name));
 
     JSLock lock(SilenceAssertionsOnly);
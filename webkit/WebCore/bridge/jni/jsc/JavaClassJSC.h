@@ -14,7 +14,11 @@ namespace Bindings {
 
 class JavaClass : public Class {
 public:
-    JavaClass(jobject);
+    // Classes are shared by all the instances of a Java class and kept for
+    // the life of the process, so that reflecting on the class and looking
+    // up its method IDs happen once however many objects cross the bridge.
+    static JavaClass* classForInstance(jobject);
+
     ~JavaClass();
 
     virtual MethodList methodsNamed(const Identifier&, Instance*) const;
@@ -25,6 +29,9 @@ public:
     bool isStringClass() const;
 
 private:
+    JavaClass(jobject);
+
+    jobject m_javaClass;
     const char* m_name;
     FieldMap m_fields;
     MethodListMap m_methods;
@@ -14,6 +14,7 @@
 #include <runtime/ArgList.h>
 #include <runtime/Error.h>
 #include <runtime/JSLock.h>
+#include <wtf/Vector.h>
 
 #if PLATFORM(ANDROID)
 #include <assert.h>
@@ -45,7 +46,6 @@ JavaInstance::JavaInstance(jobject instance, PassRefPtr<RootObject> rootObject)
 
 JavaInstance::~JavaInstance()
 {
-    delete m_class;
 }
 
 #define NUM_LOCAL_REFS 64
@@ -63,7 +63,7 @@ void JavaInstance::virtualEnd()
 Class* JavaInstance::getClass() const
 {
     if (!m_class)
-        m_class = new JavaClass (m_instance->m_instance);
+        m_class = JavaClass::classForInstance(m_instance->m_instance);
     return m_class;
 }
 
@@ -99,7 +99,6 @@ JSValue JavaInstance::booleanValue() const
 JSValue JavaInstance::invokeMethod(ExecState* exec, const MethodList& methodList, const ArgList &args)
 {
     int i, count = args.size();
-    jvalue* jArgs;
     JSValue resultValue;
     Method* method = 0;
     size_t numMethods = methodList.size();
@@ -125,10 +124,8 @@ JSValue JavaInstance::invokeMethod(ExecState* exec, const MethodList& methodList
     const JavaMethod* jMethod = static_cast<const JavaMethod*>(method);
     JS_LOG("call %s %s on %p\n", UString(jMethod->name()).UTF8String().c_str(), jMethod->signature(), m_instance->m_instance);
 
-    if (count > 0)
-        jArgs = (jvalue*)malloc(count * sizeof(jvalue));
-    else
-        jArgs = 0;
+    Vector<jvalue, 8> jArgVector(count);
+    jvalue* jArgs = jArgVector.data();
 
     for (i = 0; i < count; i++) {
         JavaParameter* aParameter = jMethod->parameterAt(i);
@@ -153,7 +150,6 @@ JSValue JavaInstance::invokeMethod(ExecState* exec, const MethodList& methodList
         handled = dispatchJNICall(exec, rootObject->nativeHandle(), obj, jMethod->isStatic(), jMethod->JNIReturnType(), jMethod->methodID(obj), jArgs, result, callingURL, exceptionDescription);
         if (exceptionDescription) {
             throwError(exec, GeneralError, exceptionDescription.toString(exec));
-            free(jArgs);
             return jsUndefined();
         }
     }
@@ -276,8 +272,6 @@ JSValue JavaInstance::invokeMethod(ExecState* exec, const MethodList& methodList
         break;
     }
 
-    free(jArgs);
-
     return resultValue;
 }
 
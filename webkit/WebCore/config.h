@@ -104,6 +104,7 @@
 #define ENABLE_EVENT_SOURCE 0
 #undef ENABLE_APPLICATION_INSTALLED
 #define ENABLE_APPLICATION_INSTALLED 1
+#define ENABLE_DISK_CACHE 1
 
 // Uses composited RenderLayers for fixed elements
 #undef ENABLE_COMPOSITED_FIXED_ELEMENTS // Disabled by default in Platform.h
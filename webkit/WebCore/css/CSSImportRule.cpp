@@ -57,7 +57,7 @@ void CSSImportRule::setCSSStyleSheet(const String& href, const KURL& baseURL, co
 #endif
 
     String sheetText = sheet->sheetText(enforceMIMEType, &validMIMEType);
-    m_styleSheet->parseString(sheetText, strict);
+    m_cachedSheet->parseSheet(m_styleSheet.get(), sheetText, strict);
 
     if (!parent || !parent->doc() || !parent->doc()->securityOrigin()->canRequest(baseURL))
         crossOriginCSS = true;
@@ -12,7 +12,8 @@ class CSSInheritedValue : public CSSValue {
 public:
     static PassRefPtr<CSSInheritedValue> create()
     {
-        return adoptRef(new CSSInheritedValue);
+        static CSSInheritedValue* inheritedValue = new CSSInheritedValue;
+        return inheritedValue;
     }
 
     virtual String cssText() const;
@@ -3,10 +3,13 @@
 #include "config.h"
 #include "CSSMutableStyleDeclaration.h"
 
+#include "CSSBorderImageValue.h"
+#include "CSSFontFaceSrcValue.h"
 #include "CSSImageValue.h"
 #include "CSSParser.h"
 #include "CSSPropertyLonghand.h"
 #include "CSSPropertyNames.h"
+#include "CSSReflectValue.h"
 #include "CSSRule.h"
 #include "CSSStyleSheet.h"
 #include "CSSValueKeywords.h"
@@ -799,6 +802,87 @@ PassRefPtr<CSSMutableStyleDeclaration> CSSMutableStyleDeclaration::copy() const
     return adoptRef(new CSSMutableStyleDeclaration(0, m_properties, m_variableDependentValueCount));
 }
 
+// Image values hold the image they loaded through the first DocLoader that
+// asked, and font sources the SVG font element they resolved to, so both
+// are copied along with the values that contain them. Everything else is
+// left alone after parsing and is shared, as the cached primitive values
+// already are between documents.
+static PassRefPtr<CSSValue> copyValueForSharing(int propertyID, CSSValue* value)
+{
+    if (value->isVariableDependentValue() || value->isImageGeneratorValue())
+        return 0;
+
+    if (value->isImageValue()) {
+        // Cursor images also hold the element of the SVG cursor they use.
+        if (propertyID == CSSPropertyCursor)
+            return 0;
+        CSSImageValue* image = static_cast<CSSImageValue*>(value);
+        if (image->primitiveType() == CSSPrimitiveValue::CSS_IDENT)
+            return CSSImageValue::create();
+        return CSSImageValue::create(image->getStringValue());
+    }
+
+    if (value->isValueList() && !value->isWebKitCSSTransformValue()) {
+        CSSValueList* list = static_cast<CSSValueList*>(value);
+        RefPtr<CSSValueList> copy = list->isSpaceSeparated() ? CSSValueList::createSpaceSeparated() : CSSValueList::createCommaSeparated();
+        for (size_t i = 0; i < list->length(); ++i) {
+            RefPtr<CSSValue> item = copyValueForSharing(propertyID, list->itemWithoutBoundsCheck(i));
+            if (!item)
+                return 0;
+            copy->append(item.release());
+        }
+        return copy.release();
+    }
+
+    if (value->isPrimitiveValue() || value->cssValueType() != CSSValue::CSS_CUSTOM)
+        return value;
+
+    switch (propertyID) {
+    case CSSPropertySrc: {
+        CSSFontFaceSrcValue* source = static_cast<CSSFontFaceSrcValue*>(value);
+        RefPtr<CSSFontFaceSrcValue> copy = source->isLocal() ? CSSFontFaceSrcValue::createLocal(source->resource()) : CSSFontFaceSrcValue::create(source->resource());
+        copy->setFormat(source->format());
+        return copy.release();
+    }
+    case CSSPropertyWebkitBorderImage:
+    case CSSPropertyWebkitMaskBoxImage: {
+        CSSBorderImageValue* borderImage = static_cast<CSSBorderImageValue*>(value);
+        RefPtr<CSSValue> image = copyValueForSharing(propertyID, borderImage->imageValue());
+        if (!image)
+            return 0;
+        return CSSBorderImageValue::create(image.release(), borderImage->m_imageSliceRect, borderImage->m_horizontalSizeRule, borderImage->m_verticalSizeRule);
+    }
+    case CSSPropertyWebkitBoxReflect: {
+        CSSReflectValue* reflect = static_cast<CSSReflectValue*>(value);
+        RefPtr<CSSValue> mask;
+        if (reflect->mask()) {
+            mask = copyValueForSharing(CSSPropertyWebkitMaskBoxImage, reflect->mask());
+            if (!mask)
+                return 0;
+        }
+        return CSSReflectValue::create(reflect->direction(), reflect->offset(), mask.release());
+    }
+    }
+    return value;
+}
+
+PassRefPtr<CSSMutableStyleDeclaration> CSSMutableStyleDeclaration::copyForSharing(CSSRule* parentRule) const
+{
+    if (m_variableDependentValueCount)
+        return 0;
+
+    Vector<CSSProperty> properties;
+    properties.reserveInitialCapacity(m_properties.size());
+    for (unsigned i = 0; i < m_properties.size(); ++i) {
+        const CSSProperty& property = m_properties[i];
+        RefPtr<CSSValue> value = copyValueForSharing(property.id(), property.value());
+        if (!value)
+            return 0;
+        properties.append(CSSProperty(property.id(), value.release(), property.isImportant(), property.shorthandID(), property.isImplicit()));
+    }
+    return adoptRef(new CSSMutableStyleDeclaration(parentRule, properties, 0));
+}
+
 const CSSProperty* CSSMutableStyleDeclaration::findPropertyWithId(int propertyID) const
 {    
     for (int n = m_properties.size() - 1 ; n >= 0; --n) {
@@ -9,6 +9,7 @@
 #include "KURLHash.h"
 #include "PlatformString.h"
 #include <wtf/ListHashSet.h>
+#include <wtf/SlabAllocator.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
@@ -38,6 +39,7 @@ private:
 };
 
 class CSSMutableStyleDeclaration : public CSSStyleDeclaration {
+    WTF_MAKE_SLAB_ALLOCATED
 public:
     static PassRefPtr<CSSMutableStyleDeclaration> create()
     {
@@ -83,6 +85,10 @@ public:
     virtual String removeProperty(int propertyID, ExceptionCode&);
 
     virtual PassRefPtr<CSSMutableStyleDeclaration> copy() const;
+    // Like copy(), but for use by another document: values that remember the
+    // document that used them are copied too. Returns 0 for declarations
+    // with values that can't be copied.
+    PassRefPtr<CSSMutableStyleDeclaration> copyForSharing(CSSRule* parentRule) const;
 
     bool setProperty(int propertyID, int value, bool important = false, bool notifyChanged = true);
     bool setProperty(int propertyID, const String& value, bool important = false, bool notifyChanged = true);
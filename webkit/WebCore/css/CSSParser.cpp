@@ -47,6 +47,8 @@
 #include "WebKitCSSKeyframeRule.h"
 #include "WebKitCSSKeyframesRule.h"
 #include "WebKitCSSTransformValue.h"
+#include <wtf/ThreadPool.h>
+#include <wtf/Threading.h>
 #include <wtf/dtoa.h>
 
 #if ENABLE(DASHBOARD_SUPPORT)
@@ -96,6 +98,107 @@ static bool equalIgnoringCase(const CSSParserString& a, const char* b)
     return !b[a.length];
 }
 
+// Style sheets at least this many characters long are tokenized on another
+// thread while they are parsed.
+static const unsigned minimumLengthForBackgroundLexing = 32 * 1024;
+
+// Runs the tokenizer over a style sheet on a background thread, handing
+// tokens to the parser in batches as it goes. Rules can't be built off the
+// main thread, since they hold AtomicStrings and other objects that belong
+// to it, but the tokenizer only touches CSSParser's tokenizer fields and the
+// characters of tokens it hasn't handed over yet. The parser leaves both
+// alone until the tokenizer is done or has been taken back.
+class CSSBackgroundLexer : public ThreadSafeShared<CSSBackgroundLexer> {
+public:
+    struct Token {
+        int type;
+        UChar* characters;
+        int length;
+    };
+
+    static PassRefPtr<CSSBackgroundLexer> create(CSSParser* parser) { return adoptRef(new CSSBackgroundLexer(parser)); }
+
+    void start();
+    // Returns false once the parser's thread owns the tokenizer again,
+    // either because the background thread never got to it or because it
+    // has run out of tokens. The parser should tokenize from there itself.
+    bool next(Token&);
+    // Stops the background thread and waits for it to let go of the parser.
+    void finish();
+
+private:
+    CSSBackgroundLexer(CSSParser*);
+
+    static void lexOnBackgroundThread(void*);
+    void run();
+
+    CSSParser* m_parser;
+
+    Mutex m_lock;
+    ThreadCondition m_stateChanged;
+    enum State { Waiting, Lexing, Done, Abandoned };
+    State m_state;
+    bool m_stopRequested;
+    Vector<Token> m_sharedTokens;
+
+    // Only used by the parser's thread
+    Vector<Token> m_tokens;
+    size_t m_nextToken;
+};
+
+CSSBackgroundLexer::CSSBackgroundLexer(CSSParser* parser)
+    : m_parser(parser)
+    , m_state(Waiting)
+    , m_stopRequested(false)
+    , m_nextToken(0)
+{
+}
+
+void CSSBackgroundLexer::start()
+{
+    ref();
+    dispatchToBackground(lexOnBackgroundThread, this, HighBackgroundPriority);
+}
+
+void CSSBackgroundLexer::lexOnBackgroundThread(void* context)
+{
+    CSSBackgroundLexer* lexer = static_cast<CSSBackgroundLexer*>(context);
+    lexer->run();
+    lexer->deref();
+}
+
+bool CSSBackgroundLexer::next(Token& token)
+{
+    if (m_nextToken == m_tokens.size()) {
+        MutexLocker locker(m_lock);
+        if (m_state == Waiting) {
+            m_state = Abandoned;
+            return false;
+        }
+        while (m_sharedTokens.isEmpty() && m_state == Lexing)
+            m_stateChanged.wait(m_lock);
+        if (m_sharedTokens.isEmpty())
+            return false;
+        m_tokens.swap(m_sharedTokens);
+        m_sharedTokens.clear();
+        m_nextToken = 0;
+    }
+    token = m_tokens[m_nextToken++];
+    return true;
+}
+
+void CSSBackgroundLexer::finish()
+{
+    MutexLocker locker(m_lock);
+    if (m_state == Waiting) {
+        m_state = Abandoned;
+        return;
+    }
+    m_stopRequested = true;
+    while (m_state == Lexing)
+        m_stateChanged.wait(m_lock);
+}
+
 static bool hasPrefix(const char* string, unsigned length, const char* prefix)
 {
     for (unsigned i = 0; i < length; ++i) {
@@ -211,7 +314,15 @@ void CSSParser::parseSheet(CSSStyleSheet* sheet, const String& string)
     m_defaultNamespace = starAtom; // Reset the default namespace.
     
     setupParser("", string, "");
+    if (string.length() >= minimumLengthForBackgroundLexing) {
+        m_backgroundLexer = CSSBackgroundLexer::create(this);
+        m_backgroundLexer->start();
+    }
     cssyyparse(this);
+    if (m_backgroundLexer) {
+        m_backgroundLexer->finish();
+        m_backgroundLexer = 0;
+    }
     m_rule = 0;
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::record(android::TimeCounter::CSSParseTimeCounter, __FUNCTION__);
@@ -4662,16 +4773,60 @@ static inline int yyerror(const char*) { return 1; }
 
 #include "CSSGrammar.h"
 
+void CSSBackgroundLexer::run()
+{
+    {
+        MutexLocker locker(m_lock);
+        if (m_state != Waiting)
+            return;
+        m_state = Lexing;
+    }
+
+    // Start with a small batch so that the parser isn't kept waiting.
+    size_t batchSize = 16;
+    Vector<Token> tokens;
+    while (true) {
+        Token token;
+        m_parser->lex();
+        token.characters = m_parser->text(&token.length);
+        token.type = m_parser->token();
+        tokens.append(token);
+        if (token.type != END_TOKEN && tokens.size() < batchSize)
+            continue;
+
+        MutexLocker locker(m_lock);
+        m_sharedTokens.append(tokens);
+        tokens.clear();
+        batchSize = 256;
+        if (token.type == END_TOKEN || m_stopRequested) {
+            m_state = Done;
+            m_stateChanged.signal();
+            return;
+        }
+        m_stateChanged.signal();
+    }
+}
+
 int CSSParser::lex(void* yylvalWithoutType)
 {
     YYSTYPE* yylval = static_cast<YYSTYPE*>(yylvalWithoutType);
     int length;
-    
-    lex();
-
-    UChar* t = text(&length);
+    UChar* t;
+    int tokenType;
+
+    CSSBackgroundLexer::Token token;
+    if (m_backgroundLexer && m_backgroundLexer->next(token)) {
+        t = token.characters;
+        length = token.length;
+        tokenType = token.type;
+    } else {
+        m_backgroundLexer = 0;
+        lex();
+        t = text(&length);
+        tokenType = token();
+    }
 
-    switch (token()) {
+    switch (tokenType) {
     case WHITESPACE:
     case SGML_CD:
     case INCLUDES:
@@ -4737,7 +4892,7 @@ int CSSParser::lex(void* yylvalWithoutType)
         break;
     }
 
-    return token();
+    return tokenType;
 }
 
 static inline bool isCSSWhitespace(UChar c)
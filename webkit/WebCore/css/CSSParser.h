@@ -9,10 +9,12 @@
 #include "CSSSelectorList.h"
 #include "MediaQuery.h"
 #include <wtf/HashSet.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
 
+    class CSSBackgroundLexer;
     class CSSMutableStyleDeclaration;
     class CSSPrimitiveValue;
     class CSSProperty;
@@ -234,6 +236,10 @@ namespace WebCore {
         int yyTok;
         int yy_start;
 
+        // Set while another thread runs the tokenizer ahead of the parser;
+        // the tokenizer fields above are its until it is done.
+        RefPtr<CSSBackgroundLexer> m_backgroundLexer;
+
         bool m_allowImportRules;
         bool m_allowVariablesRules;
         bool m_allowNamespaceDeclarations;
@@ -16,6 +16,7 @@
 #include "Rect.h"
 #include "RenderStyle.h"
 #include <wtf/ASCIICType.h>
+#include <wtf/MathExtras.h>
 #include <wtf/StdLibExtras.h>
 
 #if ENABLE(DASHBOARD_SUPPORT)
@@ -72,25 +73,45 @@ PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::createColor(unsigned rgbValue)
 
 PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::create(double value, UnitTypes type)
 {
-    // Small integers are very common. Try to share them.
+    // Small integers are very common. Try to share them. Negative ones
+    // mostly turn up in margins and offsets, so fewer of those are kept.
     const int cachedIntegerCount = 128;
+    const int cachedNegativeIntegerCount = 16;
     // Other common primitive types have UnitTypes smaller than this.
     const int maxCachedUnitType = CSS_PX;
     typedef RefPtr<CSSPrimitiveValue>(* IntegerValueCache)[maxCachedUnitType + 1];
-    static IntegerValueCache integerValueCache = new RefPtr<CSSPrimitiveValue>[cachedIntegerCount][maxCachedUnitType + 1];
-    if (type <= maxCachedUnitType && value >= 0 && value < cachedIntegerCount) {
+    static IntegerValueCache integerValueCache = new RefPtr<CSSPrimitiveValue>[cachedNegativeIntegerCount + cachedIntegerCount][maxCachedUnitType + 1];
+    if (type > maxCachedUnitType || !isfinite(value))
+        return adoptRef(new CSSPrimitiveValue(value, type));
+
+    if (value >= -cachedNegativeIntegerCount && value < cachedIntegerCount) {
         int intValue = static_cast<int>(value);
         if (value == intValue) {
-            RefPtr<CSSPrimitiveValue> primitiveValue = integerValueCache[intValue][type];
+            RefPtr<CSSPrimitiveValue> primitiveValue = integerValueCache[intValue + cachedNegativeIntegerCount][type];
             if (!primitiveValue) {
                 primitiveValue = adoptRef(new CSSPrimitiveValue(value, type));
-                integerValueCache[intValue][type] = primitiveValue;
+                integerValueCache[intValue + cachedNegativeIntegerCount][type] = primitiveValue;
             }
             return primitiveValue.release();
         }
     }
 
-    return adoptRef(new CSSPrimitiveValue(value, type));
+    // Values like 1.5em, 33.3% or 960px repeat across a style sheet too,
+    // but there are too many of them to keep for good.
+    typedef HashMap<double, RefPtr<CSSPrimitiveValue> > ValueCache;
+    static ValueCache* valueCaches = new ValueCache[maxCachedUnitType + 1];
+    ValueCache& valueCache = valueCaches[type];
+    RefPtr<CSSPrimitiveValue> primitiveValue = valueCache.get(value);
+    if (primitiveValue)
+        return primitiveValue.release();
+    primitiveValue = adoptRef(new CSSPrimitiveValue(value, type));
+    // Just wipe out the cache and start rebuilding when it gets too big.
+    const int maxValueCacheSize = 256;
+    if (valueCache.size() >= maxValueCacheSize)
+        valueCache.clear();
+    valueCache.add(value, primitiveValue);
+
+    return primitiveValue.release();
 }
 
 PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::create(const String& value, UnitTypes type)
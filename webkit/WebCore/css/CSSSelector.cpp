@@ -495,6 +495,29 @@ void CSSSelector::setTagHistory(CSSSelector* tagHistory)
         m_data.m_tagHistory = tagHistory; 
 }
 
+CSSSelector* CSSSelector::copy() const
+{
+    CSSSelector* selector = fastNew<CSSSelector>(m_tag);
+    selector->m_value = m_value;
+    selector->m_relation = m_relation;
+    selector->m_match = m_match;
+    selector->m_pseudoType = m_pseudoType;
+    selector->m_parsedNth = m_parsedNth;
+    if (m_hasRareData) {
+        selector->createRareData();
+        RareData* rareData = selector->m_data.m_rareData;
+        rareData->m_attribute = m_data.m_rareData->m_attribute;
+        rareData->m_argument = m_data.m_rareData->m_argument;
+        rareData->m_a = m_data.m_rareData->m_a;
+        rareData->m_b = m_data.m_rareData->m_b;
+        if (CSSSelector* simpleSelector = m_data.m_rareData->m_simpleSelector.get())
+            rareData->m_simpleSelector.set(simpleSelector->copy());
+    }
+    if (CSSSelector* history = tagHistory())
+        selector->setTagHistory(history->copy());
+    return selector;
+}
+
 const QualifiedName& CSSSelector::attribute() const
 { 
     switch (m_match) {
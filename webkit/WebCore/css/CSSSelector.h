@@ -179,6 +179,10 @@ namespace WebCore {
         CSSSelector* tagHistory() const { return m_hasRareData ? m_data.m_rareData->m_tagHistory.get() : m_data.m_tagHistory; }
         void setTagHistory(CSSSelector* tagHistory);
 
+        // Returns a new selector, allocated with fastNew like the parser's,
+        // that matches the same elements. The caller owns it.
+        CSSSelector* copy() const;
+
         bool hasTag() const { return m_tag != anyQName(); }
         bool hasAttribute() const { return m_match == Id || m_match == Class || (m_hasRareData && m_data.m_rareData->m_attribute != anyQName()); }
         
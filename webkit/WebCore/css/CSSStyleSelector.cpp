@@ -30,6 +30,7 @@
 #include "FontValue.h"
 #include "Frame.h"
 #include "FrameView.h"
+#include "HTMLAnchorElement.h"
 #include "HTMLDocument.h"
 #include "HTMLElement.h"
 #include "HTMLInputElement.h"
@@ -342,13 +343,28 @@ public:
     CSSRuleDataList* getClassRules(AtomicStringImpl* key) { m_classRules.checkConsistency(); return m_classRules.get(key); }
     CSSRuleDataList* getTagRules(AtomicStringImpl* key) { m_tagRules.checkConsistency(); return m_tagRules.get(key); }
     CSSRuleDataList* getUniversalRules() { return m_universalRules; }
+
+    unsigned classUse(const AtomicString&) const;
+    unsigned idUse(const AtomicString&) const;
     
 public:
+    void collectIdentifierUses(CSSSelector*, bool inSubject);
+
     AtomRuleMap m_idRules;
     AtomRuleMap m_classRules;
     AtomRuleMap m_tagRules;
     CSSRuleDataList* m_universalRules;
     unsigned m_ruleCount;
+
+    // The CSSStyleSelector::IdentifierAffects* bits of each class and id in
+    // the selectors. Case is ignored so that the quirks mode folding of
+    // classes and ids doesn't have to be taken into account.
+    typedef HashMap<AtomicString, unsigned, CaseFoldingHash> IdentifierUseMap;
+    IdentifierUseMap m_classUses;
+    IdentifierUseMap m_idUses;
+    // Attribute selectors on class or id can match any change to them.
+    bool m_hasClassAttributeSelectors;
+    bool m_hasIdAttributeSelectors;
 };
 
 static CSSRuleSet* defaultStyle;
@@ -389,6 +405,7 @@ CSSStyleSelector::CSSStyleSelector(Document* doc, StyleSheetList* styleSheets, C
     : m_backgroundData(BackgroundFillLayer)
     , m_checker(doc, strictParsing)
     , m_fontSelector(CSSFontSelector::create(doc))
+    , m_styleRecalcInProgress(false)
 {
     init();
         
@@ -677,7 +694,7 @@ void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleI
         CSSStyleRule* rule = d->rule();
         const AtomicString& localName = m_element->localName();
         const AtomicString& selectorLocalName = d->selector()->m_tag.localName();
-        if ((localName == selectorLocalName || selectorLocalName == starAtom) && checkSelector(d->selector())) {
+        if ((localName == selectorLocalName || selectorLocalName == starAtom) && !ancestorFilterRejects(d) && checkSelector(d->selector())) {
             // If the rule has no properties to apply, then ignore it.
             CSSMutableStyleDeclaration* decl = rule->declaration();
             if (!decl || !decl->length())
@@ -816,6 +833,145 @@ void CSSStyleSelector::initForStyleResolve(Element* e, RenderStyle* parentStyle,
     m_ruleList = 0;
 
     m_fontDirty = false;
+
+    if (m_styleRecalcInProgress) {
+        Node* parent = e ? e->parentNode() : 0;
+        updateAncestorFilter(parent && parent->isElementNode() ? static_cast<Element*>(parent) : 0);
+    }
+}
+
+// Salts keep a tag, an ID and a class with the same name apart in the filter.
+static const unsigned tagNameSalt = 13;
+static const unsigned idAttributeSalt = 17;
+static const unsigned classAttributeSalt = 19;
+
+void CSSRuleData::collectDescendantSelectorIdentifierHashes()
+{
+    unsigned* hash = m_descendantSelectorIdentifierHashes;
+    unsigned* end = hash + maximumIdentifierCount;
+
+    // The rightmost compound selector is matched against the element itself.
+    // Compound selectors to the left of a sibling combinator match siblings of
+    // the element or of an ancestor, which aren't in the filter.
+    CSSSelector* selector = m_selector;
+    CSSSelector::Relation relation = selector->relation();
+    bool matchesAncestor = false;
+    for (selector = selector->tagHistory(); selector && hash != end; selector = selector->tagHistory()) {
+        if (relation == CSSSelector::Descendant || relation == CSSSelector::Child)
+            matchesAncestor = true;
+        else if (relation != CSSSelector::SubSelector)
+            matchesAncestor = false;
+
+        if (matchesAncestor) {
+            if (selector->m_match == CSSSelector::Id)
+                *hash++ = selector->m_value.impl()->hash() * idAttributeSalt;
+            else if (selector->m_match == CSSSelector::Class)
+                *hash++ = selector->m_value.impl()->hash() * classAttributeSalt;
+            if (hash != end && selector->hasTag()) {
+                const AtomicString& localName = selector->m_tag.localName();
+                if (localName != starAtom)
+                    *hash++ = localName.impl()->hash() * tagNameSalt;
+            }
+        }
+        relation = selector->relation();
+    }
+    *hash = 0;
+}
+
+void CSSStyleSelector::setStyleRecalcInProgress(bool inProgress)
+{
+    m_styleRecalcInProgress = inProgress;
+    if (!inProgress) {
+        m_ancestors.clear();
+        m_ancestorIdentifierHashes.clear();
+        m_ancestorIdentifierFilter.clear();
+        m_styleSharingCache.clear();
+    }
+}
+
+bool CSSStyleSelector::ancestorFilterRejects(const CSSRuleData* ruleData) const
+{
+    if (!m_styleRecalcInProgress)
+        return false;
+    for (const unsigned* hash = ruleData->descendantSelectorIdentifierHashes(); *hash; ++hash) {
+        if (!m_ancestorIdentifierFilter.mayContain(*hash))
+            return true;
+    }
+    return false;
+}
+
+void CSSStyleSelector::pushAncestor(Element* element)
+{
+    ASSERT(m_ancestors.isEmpty() ? !element->parentNode() || !element->parentNode()->isElementNode() : element->parentNode() == m_ancestors.last().element);
+
+    Ancestor ancestor;
+    ancestor.element = element;
+    ancestor.identifierHashesStart = m_ancestorIdentifierHashes.size();
+    m_ancestors.append(ancestor);
+
+    m_ancestorIdentifierHashes.append(element->localName().impl()->hash() * tagNameSalt);
+    if (element->hasID() && !element->getIDAttribute().isNull())
+        m_ancestorIdentifierHashes.append(element->getIDAttribute().impl()->hash() * idAttributeSalt);
+    if (element->isStyledElement() && element->hasClass()) {
+        const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+        size_t count = classNames.size();
+        for (size_t i = 0; i < count; ++i)
+            m_ancestorIdentifierHashes.append(classNames[i].impl()->hash() * classAttributeSalt);
+    }
+
+    size_t size = m_ancestorIdentifierHashes.size();
+    for (size_t i = ancestor.identifierHashesStart; i < size; ++i)
+        m_ancestorIdentifierFilter.add(m_ancestorIdentifierHashes[i]);
+}
+
+void CSSStyleSelector::popAncestor()
+{
+    size_t start = m_ancestors.last().identifierHashesStart;
+    size_t size = m_ancestorIdentifierHashes.size();
+    for (size_t i = start; i < size; ++i)
+        m_ancestorIdentifierFilter.remove(m_ancestorIdentifierHashes[i]);
+    m_ancestorIdentifierHashes.shrink(start);
+    m_ancestors.removeLast();
+}
+
+void CSSStyleSelector::updateAncestorFilter(Element* parent)
+{
+    if (!parent) {
+        while (!m_ancestors.isEmpty())
+            popAncestor();
+        return;
+    }
+
+    // A recalc visits the tree depth first, so parent is usually already on
+    // top, or is the child of the element on top.
+    if (!m_ancestors.isEmpty()) {
+        Element* top = m_ancestors.last().element;
+        if (top == parent)
+            return;
+        if (parent->parentNode() == top) {
+            pushAncestor(parent);
+            return;
+        }
+    }
+
+    // Otherwise the traversal came back up, to parent or past it.
+    while (!m_ancestors.isEmpty() && m_ancestors.last().element != parent)
+        popAncestor();
+    if (!m_ancestors.isEmpty())
+        return;
+
+    Vector<Element*, 32> chain;
+    for (Node* node = parent; node && node->isElementNode(); node = node->parentNode())
+        chain.append(static_cast<Element*>(node));
+    for (size_t i = chain.size(); i; --i)
+        pushAncestor(chain[i - 1]);
+}
+
+static inline LinkHash linkHash(Document* document, Node* link, const AtomicString& attribute)
+{
+    if (link->hasTagName(aTag) || link->hasTagName(areaTag))
+        return static_cast<HTMLAnchorElement*>(link)->visitedLinkHash();
+    return visitedLinkHash(document->baseURL(), attribute);
 }
 
 static inline const AtomicString* linkAttribute(Node* node)
@@ -881,7 +1037,7 @@ PseudoState CSSStyleSelector::SelectorChecker::checkPseudoState(Element* element
     if (!hash)
         return PseudoLink;
 #else
-    LinkHash hash = visitedLinkHash(m_document->baseURL(), *attr);
+    LinkHash hash = linkHash(m_document, element, *attr);
     if (!hash)
         return PseudoLink;
 #endif
@@ -1056,6 +1212,54 @@ RenderStyle* CSSStyleSelector::locateSharedStyle()
     return 0;
 }
 
+RenderStyle* CSSStyleSelector::locateCachedSharedStyle(RenderStyle* parentStyle)
+{
+    if (!m_styleRecalcInProgress || !parentStyle)
+        return 0;
+    if (!m_styledElement || m_styledElement->inlineStyleDecl() || m_styledElement->hasID() || m_styledElement->document()->usesSiblingRules())
+        return 0;
+
+    // Elements whose parents share a style object have ancestors that were
+    // found equivalent all the way up to a common one, the same as the cousins
+    // locateSharedStyle() finds, so they can share style in the same way.
+    size_t size = m_styleSharingCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        Element* candidate = m_styleSharingCache[i].get();
+        if (candidate == m_element)
+            continue;
+        Node* parent = candidate->parentNode();
+        if (!parent || parent->renderStyle() != parentStyle || !canShareStyleWithElement(candidate))
+            continue;
+        if (i) {
+            RefPtr<Element> protector = candidate;
+            m_styleSharingCache.remove(i);
+            m_styleSharingCache.insert(0, protector.release());
+        }
+        return candidate->renderStyle();
+    }
+    return 0;
+}
+
+void CSSStyleSelector::addToStyleSharingCache(Element* element)
+{
+    if (!m_styleRecalcInProgress || !element->isStyledElement() || element->hasID() || static_cast<StyledElement*>(element)->inlineStyleDecl())
+        return;
+
+    size_t size = m_styleSharingCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        if (m_styleSharingCache[i] == element) {
+            m_styleSharingCache.remove(i);
+            --size;
+            break;
+        }
+    }
+    if (size == styleSharingCacheSize)
+        m_styleSharingCache.removeLast();
+    // Holding a reference keeps an element that leaves the tree during the
+    // recalc from being destroyed while it's in the cache.
+    m_styleSharingCache.insert(0, element);
+}
+
 void CSSStyleSelector::matchUARules(int& firstUARule, int& lastUARule)
 {
     // First we match rules from the user agent sheet.
@@ -1129,6 +1333,10 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     initElementAndPseudoState(e);
     if (allowSharing) {
         RenderStyle* sharedStyle = locateSharedStyle();
+        if (!sharedStyle) {
+            Node* parent = e->parentNode();
+            sharedStyle = locateCachedSharedStyle(defaultParent ? defaultParent : parent ? parent->renderStyle() : 0);
+        }
         if (sharedStyle)
             return sharedStyle;
     }
@@ -1302,6 +1510,9 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     if (m_style->hasPseudoStyle(FIRST_LETTER))
         m_style->setUnique();
 
+    if (allowSharing && !m_style->unique())
+        addToStyleSharingCache(e);
+
     // Now return the style.
     return m_style.release();
 }
@@ -2727,6 +2938,8 @@ CSSRuleSet::CSSRuleSet()
 {
     m_universalRules = 0;
     m_ruleCount = 0;
+    m_hasClassAttributeSelectors = false;
+    m_hasIdAttributeSelectors = false;
 }
 
 CSSRuleSet::~CSSRuleSet()
@@ -2751,8 +2964,53 @@ void CSSRuleSet::addToRuleSet(AtomicStringImpl* key, AtomRuleMap& map,
         rules->append(m_ruleCount++, rule, sel);
 }
 
+void CSSRuleSet::collectIdentifierUses(CSSSelector* selector, bool inSubject)
+{
+    for (; selector; selector = selector->tagHistory()) {
+        unsigned use = inSubject ? CSSStyleSelector::IdentifierAffectsElement : CSSStyleSelector::IdentifierAffectsOthers;
+        if (selector->m_match == CSSSelector::Id)
+            m_idUses.add(selector->m_value, 0).first->second |= use;
+        else if (selector->m_match == CSSSelector::Class)
+            m_classUses.add(selector->m_value, 0).first->second |= use;
+        else if (selector->hasAttribute()) {
+            const AtomicString& attributeName = selector->attribute().localName();
+            if (equalIgnoringCase(attributeName, classAttr.localName()))
+                m_hasClassAttributeSelectors = true;
+            else if (equalIgnoringCase(attributeName, idAttr.localName()))
+                m_hasIdAttributeSelectors = true;
+        }
+
+        // The argument of :not() is matched against the same element.
+        if (CSSSelector* simpleSelector = selector->simpleSelector())
+            collectIdentifierUses(simpleSelector, inSubject);
+
+        if (selector->relation() != CSSSelector::SubSelector)
+            inSubject = false;
+    }
+}
+
+static unsigned identifierUse(const CSSRuleSet::IdentifierUseMap& uses, bool hasAttributeSelectors, const AtomicString& name)
+{
+    if (hasAttributeSelectors)
+        return CSSStyleSelector::IdentifierAffectsElement | CSSStyleSelector::IdentifierAffectsOthers;
+    CSSRuleSet::IdentifierUseMap::const_iterator it = uses.find(name);
+    return it == uses.end() ? 0 : it->second;
+}
+
+unsigned CSSRuleSet::classUse(const AtomicString& className) const
+{
+    return identifierUse(m_classUses, m_hasClassAttributeSelectors, className);
+}
+
+unsigned CSSRuleSet::idUse(const AtomicString& id) const
+{
+    return identifierUse(m_idUses, m_hasIdAttributeSelectors, id);
+}
+
 void CSSRuleSet::addRule(CSSStyleRule* rule, CSSSelector* sel)
 {
+    collectIdentifierUses(sel, true);
+
     if (sel->m_match == CSSSelector::Id) {
         addToRuleSet(sel->m_value.impl(), m_idRules, rule, sel);
         return;
@@ -6036,6 +6294,28 @@ bool CSSStyleSelector::hasSelectorForAttribute(const AtomicString &attrname)
     return m_selectorAttrs.contains(attrname.impl());
 }
 
+unsigned CSSStyleSelector::classUse(const AtomicString& className) const
+{
+    CSSRuleSet* ruleSets[] = { defaultStyle, defaultQuirksStyle, defaultPrintStyle, defaultViewSourceStyle, m_authorStyle, m_userStyle };
+    unsigned use = 0;
+    for (size_t i = 0; i < sizeof(ruleSets) / sizeof(ruleSets[0]); ++i) {
+        if (ruleSets[i])
+            use |= ruleSets[i]->classUse(className);
+    }
+    return use;
+}
+
+unsigned CSSStyleSelector::idUse(const AtomicString& id) const
+{
+    CSSRuleSet* ruleSets[] = { defaultStyle, defaultQuirksStyle, defaultPrintStyle, defaultViewSourceStyle, m_authorStyle, m_userStyle };
+    unsigned use = 0;
+    for (size_t i = 0; i < sizeof(ruleSets) / sizeof(ruleSets[0]); ++i) {
+        if (ruleSets[i])
+            use |= ruleSets[i]->idUse(id);
+    }
+    return use;
+}
+
 void CSSStyleSelector::addViewportDependentMediaQueryResult(const MediaQueryExp* expr, bool result)
 {
     m_viewportDependentMediaQueryResults.append(new MediaQueryResult(*expr, result));
@@ -6067,7 +6347,7 @@ void CSSStyleSelector::SelectorChecker::visitedStateChanged(LinkHash visitedHash
         return;
     for (Node* node = m_document; node; node = node->traverseNextNode()) {
         const AtomicString* attr = linkAttribute(node);
-        if (attr && visitedLinkHash(m_document->baseURL(), *attr) == visitedHash)
+        if (attr && linkHash(m_document, node, *attr) == visitedHash)
             node->setNeedsStyleRecalc();
     }
 }
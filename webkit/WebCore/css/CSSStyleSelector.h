@@ -8,6 +8,7 @@
 #include "MediaQueryExp.h"
 #include "RenderStyle.h"
 #include "StringHash.h"
+#include <wtf/BloomFilter.h>
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/RefPtr.h>
@@ -75,6 +76,14 @@ public:
 
         static PassRefPtr<RenderStyle> styleForDocument(Document*);
 
+        // During a style recalc, the ancestors of the element being styled
+        // are kept in a Bloom filter that rules out most descendant selectors
+        // without walking up the tree, and recently styled elements are kept
+        // for elements elsewhere in the tree to share style with. Both are
+        // only valid while the DOM doesn't change, so they are dropped when
+        // the recalc ends.
+        void setStyleRecalcInProgress(bool);
+
 #if ENABLE(DATAGRID)
         // Datagrid style computation (uses unique pseudo elements and structures)
         PassRefPtr<RenderStyle> pseudoStyleForDataGridColumn(DataGridColumn*, RenderStyle* parentStyle);
@@ -83,6 +92,8 @@ public:
 
     private:
         RenderStyle* locateSharedStyle();
+        RenderStyle* locateCachedSharedStyle(RenderStyle* parentStyle);
+        void addToStyleSharingCache(Element*);
         Node* locateCousinList(Element* parent, unsigned depth = 1);
         bool canShareStyleWithElement(Node*);
 
@@ -118,6 +129,13 @@ public:
         Color getColorFromPrimitiveValue(CSSPrimitiveValue*);
 
         bool hasSelectorForAttribute(const AtomicString&);
+
+        // How the selectors use a class or id: to match the element that has
+        // it, or to match its descendants or following siblings. Changing a
+        // class or id that isn't used at all can't change any style.
+        enum { IdentifierAffectsElement = 1, IdentifierAffectsOthers = 2 };
+        unsigned classUse(const AtomicString& className) const;
+        unsigned idUse(const AtomicString& id) const;
  
         CSSFontSelector* fontSelector() { return m_fontSelector.get(); }
 
@@ -198,6 +216,11 @@ public:
 
         void init();
 
+        void updateAncestorFilter(Element* parent);
+        void pushAncestor(Element*);
+        void popAncestor();
+        bool ancestorFilterRejects(const CSSRuleData*) const;
+
         void matchUARules(int& firstUARule, int& lastUARule);
         void updateFont();
         void cacheBorderAndBackground();
@@ -267,6 +290,22 @@ public:
         
         HashMap<String, CSSVariablesRule*> m_variablesMap;
         HashMap<CSSMutableStyleDeclaration*, RefPtr<CSSMutableStyleDeclaration> > m_resolvedVariablesDeclarations;
+
+        struct Ancestor {
+            Element* element;
+            // Where the element's identifier hashes start in m_ancestorIdentifierHashes
+            size_t identifierHashesStart;
+        };
+        // Each ancestor is the parent of the one after it.
+        Vector<Ancestor, 32> m_ancestors;
+        Vector<unsigned, 64> m_ancestorIdentifierHashes;
+        BloomFilter<12> m_ancestorIdentifierFilter;
+
+        // Most recently styled first
+        static const size_t styleSharingCacheSize = 16;
+        Vector<RefPtr<Element>, styleSharingCacheSize> m_styleSharingCache;
+
+        bool m_styleRecalcInProgress;
     };
 
     class CSSRuleData : public Noncopyable {
@@ -279,6 +318,7 @@ public:
         {
             if (prev)
                 prev->m_next = this;
+            collectDescendantSelectorIdentifierHashes();
         }
 
         ~CSSRuleData() 
@@ -290,7 +330,16 @@ public:
         CSSSelector* selector() { return m_selector; }
         CSSRuleData* next() { return m_next; }
 
+        // Hashes of tags, IDs and classes that some ancestor must have for the
+        // selector to match, ending with 0.
+        const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
+
     private:
+        void collectDescendantSelectorIdentifierHashes();
+
+        static const unsigned maximumIdentifierCount = 4;
+
+        unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount + 1];
         unsigned m_position;
         CSSStyleRule* m_rule;
         CSSSelector* m_selector;
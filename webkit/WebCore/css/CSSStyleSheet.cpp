@@ -3,10 +3,16 @@
 #include "config.h"
 #include "CSSStyleSheet.h"
 
+#include "CSSCharsetRule.h"
+#include "CSSFontFaceRule.h"
 #include "CSSImportRule.h"
+#include "CSSMediaRule.h"
+#include "CSSMutableStyleDeclaration.h"
 #include "CSSNamespace.h"
 #include "CSSParser.h"
 #include "CSSRuleList.h"
+#include "CSSStyleRule.h"
+#include "MediaList.h"
 #include "Document.h"
 #include "ExceptionCode.h"
 #include "Node.h"
@@ -156,6 +162,80 @@ bool CSSStyleSheet::parseString(const String &string, bool strict)
     return true;
 }
 
+static PassRefPtr<CSSRule> copyRule(CSSRule* rule, CSSStyleSheet* parent)
+{
+    if (rule->isStyleRule()) {
+        CSSStyleRule* styleRule = static_cast<CSSStyleRule*>(rule);
+        RefPtr<CSSStyleRule> copy = CSSStyleRule::create(parent);
+        RefPtr<CSSMutableStyleDeclaration> declaration = styleRule->declaration()->copyForSharing(copy.get());
+        if (!declaration)
+            return 0;
+        Vector<CSSSelector*> selectors;
+        const CSSSelectorList& selectorList = styleRule->selectorList();
+        for (CSSSelector* selector = selectorList.first(); selector; selector = CSSSelectorList::next(selector))
+            selectors.append(selector->copy());
+        copy->adoptSelectorVector(selectors);
+        copy->setDeclaration(declaration.release());
+        return copy.release();
+    }
+
+    if (rule->isMediaRule()) {
+        CSSMediaRule* mediaRule = static_cast<CSSMediaRule*>(rule);
+        RefPtr<CSSRuleList> rules = CSSRuleList::create();
+        CSSRuleList* mediaRules = mediaRule->cssRules();
+        for (unsigned i = 0; i < mediaRules->length(); ++i) {
+            RefPtr<CSSRule> copy = copyRule(mediaRules->item(i), parent);
+            if (!copy)
+                return 0;
+            rules->append(copy.get());
+        }
+        RefPtr<MediaList> media = MediaList::create(mediaRule->media()->mediaText(), false);
+        return CSSMediaRule::create(parent, media.release(), rules.release());
+    }
+
+    if (rule->isFontFaceRule()) {
+        CSSFontFaceRule* fontFaceRule = static_cast<CSSFontFaceRule*>(rule);
+        RefPtr<CSSFontFaceRule> copy = CSSFontFaceRule::create(parent);
+        RefPtr<CSSMutableStyleDeclaration> declaration = fontFaceRule->style()->copyForSharing(copy.get());
+        if (!declaration)
+            return 0;
+        copy->setDeclaration(declaration.release());
+        return copy.release();
+    }
+
+    if (rule->isCharsetRule())
+        return CSSCharsetRule::create(parent, static_cast<CSSCharsetRule*>(rule)->encoding());
+
+    return 0;
+}
+
+bool CSSStyleSheet::copyRules(CSSStyleSheet* other)
+{
+    ASSERT(!length());
+    if (other->m_namespaces)
+        return false;
+
+    // The copied declarations take their mode from the sheet.
+    setStrictParsing(other->useStrictParsing());
+    Vector<RefPtr<CSSRule> > rules;
+    unsigned len = other->length();
+    rules.reserveInitialCapacity(len);
+    for (unsigned i = 0; i < len; ++i) {
+        StyleBase* rule = other->item(i);
+        if (!rule->isRule())
+            return false;
+        RefPtr<CSSRule> copy = copyRule(static_cast<CSSRule*>(rule), this);
+        if (!copy)
+            return false;
+        rules.append(copy.release());
+    }
+
+    for (unsigned i = 0; i < len; ++i)
+        append(rules[i].release());
+    m_hasSyntacticallyValidCSSHeader = other->m_hasSyntacticallyValidCSSHeader;
+    return true;
+}
+
 bool CSSStyleSheet::isLoading()
 {
     unsigned len = length();
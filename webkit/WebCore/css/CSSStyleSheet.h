@@ -62,6 +62,12 @@ public:
     virtual void styleSheetChanged();
 
     virtual bool parseString(const String&, bool strict = true);
+    // Fills this empty sheet with copies of the rules of a sheet parsed
+    // from the same text, for use by another document. Returns false and
+    // leaves the sheet empty if other has rules that aren't copied, that is
+    // anything but style, @media, @font-face and @charset rules, or uses
+    // namespaces.
+    bool copyRules(CSSStyleSheet* other);
 
     virtual bool isLoading();
 
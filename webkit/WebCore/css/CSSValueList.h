@@ -29,6 +29,7 @@ public:
     virtual ~CSSValueList();
 
     size_t length() const { return m_values.size(); }
+    bool isSpaceSeparated() const { return m_isSpaceSeparated; }
     CSSValue* item(unsigned);
     CSSValue* itemWithoutBoundsCheck(unsigned index) { return m_values[index].get(); }
 
@@ -18,6 +18,28 @@ CharacterData::CharacterData(Document* document, const String& text, Constructio
     ASSERT(type == CreateOther || type == CreateText);
 }
 
+// Finds the part of oldText that newText replaces, leaving out what both
+// start and end with, so that only the lines showing it need to be laid out
+// again.
+static void findChangedRange(const StringImpl* oldText, const StringImpl* newText, unsigned& offset, unsigned& oldChangedLength)
+{
+    unsigned oldLength = oldText->length();
+    unsigned newLength = newText->length();
+    unsigned commonLength = oldLength < newLength ? oldLength : newLength;
+    const UChar* oldCharacters = oldText->characters();
+    const UChar* newCharacters = newText->characters();
+
+    unsigned prefixLength = 0;
+    while (prefixLength < commonLength && oldCharacters[prefixLength] == newCharacters[prefixLength])
+        ++prefixLength;
+    unsigned suffixLength = 0;
+    while (suffixLength < commonLength - prefixLength && oldCharacters[oldLength - suffixLength - 1] == newCharacters[newLength - suffixLength - 1])
+        ++suffixLength;
+
+    offset = prefixLength;
+    oldChangedLength = oldLength - prefixLength - suffixLength;
+}
+
 void CharacterData::setData(const String& data, ExceptionCode&)
 {
     StringImpl* dataImpl = data.impl() ? data.impl() : StringImpl::empty();
@@ -31,8 +53,12 @@ void CharacterData::setData(const String& data, ExceptionCode&)
     if ((!renderer() || !rendererIsNeeded(renderer()->style())) && attached()) {
         detach();
         attach();
-    } else if (renderer())
-        toRenderText(renderer())->setTextWithOffset(m_data, 0, oldLength);
+    } else if (renderer()) {
+        unsigned offset;
+        unsigned oldChangedLength;
+        findChangedRange(oldStr.get(), m_data.get(), offset, oldChangedLength);
+        toRenderText(renderer())->setTextWithOffset(m_data, offset, oldChangedLength);
+    }
 
     dispatchModifiedEvent(oldStr.get());
 
@@ -32,6 +32,34 @@ static NodeCallbackQueue* s_postAttachCallbackQueue;
 static size_t s_attachDepth;
 static bool s_shouldReEnableMemoryCacheCallsAfterAttach;
 
+typedef Vector<RefPtr<Node>, 16> NodeVector;
+
+// Collects the nodes that inserting newChild adds: newChild itself, or the
+// children of a fragment. Returns true if a fragment's children have been
+// taken out of it in one go, the way removeChildren() does, rather than
+// one at a time as each is inserted. That is only possible without mutation
+// listeners, which would see the difference, and then the container defers
+// its own childrenChanged() to the end of the insertion as well.
+static bool collectNodesToInsert(Node* newChild, NodeVector& nodes)
+{
+    if (newChild->nodeType() != Node::DOCUMENT_FRAGMENT_NODE) {
+        nodes.append(newChild);
+        return false;
+    }
+    for (Node* child = newChild->firstChild(); child; child = child->nextSibling())
+        nodes.append(child);
+
+    Document* document = newChild->document();
+    if (document->hasListenerType(Document::DOMSUBTREEMODIFIED_LISTENER)
+        || document->hasListenerType(Document::DOMNODEINSERTED_LISTENER)
+        || document->hasListenerType(Document::DOMNODEREMOVED_LISTENER)
+        || document->hasListenerType(Document::DOMNODEINSERTEDINTODOCUMENT_LISTENER)
+        || document->hasListenerType(Document::DOMNODEREMOVEDFROMDOCUMENT_LISTENER))
+        return false;
+    static_cast<ContainerNode*>(newChild)->removeChildren();
+    return true;
+}
+
 void ContainerNode::removeAllChildren()
 {
     removeAllChildrenInContainer<Node, ContainerNode>(this);
@@ -79,13 +107,15 @@ bool ContainerNode::insertBefore(PassRefPtr<Node> newChild, Node* refChild, Exce
     RefPtr<Node> next = refChild;
     RefPtr<Node> refChildPreviousSibling = refChild->previousSibling();
 
-    RefPtr<Node> child = isFragment ? newChild->firstChild() : newChild;
-    while (child) {
-        RefPtr<Node> nextChild = isFragment ? child->nextSibling() : 0;
+    NodeVector nodes;
+    bool batched = collectNodesToInsert(newChild.get(), nodes);
+    int childCountDelta = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node* child = nodes[i].get();
 
         // If child is already present in the tree, first remove it from the old location.
         if (Node* oldParent = child->parentNode())
-            oldParent->removeChild(child.get(), ec);
+            oldParent->removeChild(child, ec);
         if (ec)
             return 0;
 
@@ -110,14 +140,14 @@ bool ContainerNode::insertBefore(PassRefPtr<Node> newChild, Node* refChild, Exce
         forbidEventDispatch();
         Node* prev = next->previousSibling();
         ASSERT(m_lastChild != prev);
-        next->setPreviousSibling(child.get());
+        next->setPreviousSibling(child);
         if (prev) {
             ASSERT(m_firstChild != next);
             ASSERT(prev->nextSibling() == next);
-            prev->setNextSibling(child.get());
+            prev->setNextSibling(child);
         } else {
             ASSERT(m_firstChild == next);
-            m_firstChild = child.get();
+            m_firstChild = child;
         }
         child->setParent(this);
         child->setPreviousSibling(prev);
@@ -125,8 +155,15 @@ bool ContainerNode::insertBefore(PassRefPtr<Node> newChild, Node* refChild, Exce
         allowEventDispatch();
 
         // Dispatch the mutation events.
-        childrenChanged(false, refChildPreviousSibling.get(), next.get(), 1);
-        dispatchChildInsertionEvents(child.get());
+        childCountDelta++;
+        if (!batched)
+            childrenChanged(false, refChildPreviousSibling.get(), next.get(), 1);
+        else if (document()->hasNodeListCaches()) {
+            // Inserting a child can run script, which must not find node
+            // lists that are missing the children inserted so far.
+            notifyNodeListsChildrenChanged();
+        }
+        dispatchChildInsertionEvents(child);
                 
         // Add child to the rendering tree.
         if (attached() && !child->attached() && child->parent() == this) {
@@ -135,10 +172,10 @@ bool ContainerNode::insertBefore(PassRefPtr<Node> newChild, Node* refChild, Exce
             else
                 child->attach();
         }
-
-        child = nextChild.release();
     }
 
+    if (batched && childCountDelta)
+        childrenChanged(false, refChildPreviousSibling.get(), next.get(), childCountDelta);
     dispatchSubtreeModifiedEvent();
     return true;
 }
@@ -179,19 +216,17 @@ bool ContainerNode::replaceChild(PassRefPtr<Node> newChild, Node* oldChild, Exce
     // that no callers call with ref count == 0 and parent = 0 (as of this
     // writing, there are definitely callers who call that way).
 
-    bool isFragment = newChild->nodeType() == DOCUMENT_FRAGMENT_NODE;
-
     // Add the new child(ren)
+    NodeVector nodes;
+    collectNodesToInsert(newChild.get(), nodes);
     int childCountDelta = 0;
-    RefPtr<Node> child = isFragment ? newChild->firstChild() : newChild;
-    while (child) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        RefPtr<Node> child = nodes[i];
+
         // If the new child is already in the right place, we're done.
         if (prev && (prev == child || prev == child->previousSibling()))
             break;
 
-        // For a fragment we have more children to do.
-        RefPtr<Node> nextChild = isFragment ? child->nextSibling() : 0;
-
         // Remove child from its old position.
         if (Node* oldParent = child->parentNode())
             oldParent->removeChild(child.get(), ec);
@@ -248,7 +283,6 @@ bool ContainerNode::replaceChild(PassRefPtr<Node> newChild, Node* oldChild, Exce
         }
 
         prev = child;
-        child = nextChild.release();
     }
 
     if (childCountDelta)
@@ -431,14 +465,15 @@ bool ContainerNode::appendChild(PassRefPtr<Node> newChild, ExceptionCode& ec, bo
 
     // Now actually add the child(ren)
     RefPtr<Node> prev = lastChild();
-    RefPtr<Node> child = isFragment ? newChild->firstChild() : newChild;
-    while (child) {
-        // For a fragment we have more children to do.
-        RefPtr<Node> nextChild = isFragment ? child->nextSibling() : 0;
+    NodeVector nodes;
+    bool batched = collectNodesToInsert(newChild.get(), nodes);
+    int childCountDelta = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node* child = nodes[i].get();
 
         // If child is already present in the tree, first remove it
         if (Node* oldParent = child->parentNode()) {
-            oldParent->removeChild(child.get(), ec);
+            oldParent->removeChild(child, ec);
             if (ec)
                 return 0;
             
@@ -454,15 +489,19 @@ bool ContainerNode::appendChild(PassRefPtr<Node> newChild, ExceptionCode& ec, bo
         child->setParent(this);
         if (m_lastChild) {
             child->setPreviousSibling(m_lastChild);
-            m_lastChild->setNextSibling(child.get());
+            m_lastChild->setNextSibling(child);
         } else
-            m_firstChild = child.get();
-        m_lastChild = child.get();
+            m_firstChild = child;
+        m_lastChild = child;
         allowEventDispatch();
 
         // Dispatch the mutation events
-        childrenChanged(false, prev.get(), 0, 1);
-        dispatchChildInsertionEvents(child.get());
+        childCountDelta++;
+        if (!batched)
+            childrenChanged(false, prev.get(), 0, 1);
+        else if (document()->hasNodeListCaches())
+            notifyNodeListsChildrenChanged();
+        dispatchChildInsertionEvents(child);
 
         // Add child to the rendering tree
         if (attached() && !child->attached() && child->parent() == this) {
@@ -471,10 +510,10 @@ bool ContainerNode::appendChild(PassRefPtr<Node> newChild, ExceptionCode& ec, bo
             else
                 child->attach();
         }
-        
-        child = nextChild.release();
     }
 
+    if (batched && childCountDelta)
+        childrenChanged(false, prev.get(), 0, childCountDelta);
     dispatchSubtreeModifiedEvent();
     return true;
 }
@@ -611,7 +650,10 @@ void ContainerNode::childrenChanged(bool changedByParser, Node* beforeChange, No
     Node::childrenChanged(changedByParser, beforeChange, afterChange, childCountDelta);
     if (!changedByParser && childCountDelta)
         document()->nodeChildrenChanged(this);
-    if (document()->hasNodeListCaches())
+    // CharacterData calls this without naming any children when only its
+    // data changed, which doesn't change what any list holds.
+    bool onlyDataChanged = !beforeChange && !afterChange && !childCountDelta;
+    if (document()->hasNodeListCaches() && !onlyDataChanged)
         notifyNodeListsChildrenChanged();
 }
 
@@ -93,6 +93,7 @@
 #include "SegmentedString.h"
 #include "SelectionController.h"
 #include "Settings.h"
+#include "StaticNodeList.h"
 #include "StringBuffer.h"
 #include "StyleSheetList.h"
 #include "TextEvent.h"
@@ -166,6 +167,10 @@
 #include "TimeCounter.h"
 #endif
 
+#if PLATFORM(ANDROID)
+#include "TraceBuffer.h"
+#endif
+
 #if ENABLE(TOUCH_EVENTS)
 #include "TouchEvent.h"
 #endif
@@ -401,6 +406,8 @@ Document::Document(Frame* frame, bool isXHTML, bool isHTML)
 
     m_frame = frame;
 
+    m_completeURLCacheEncoding = 0;
+
 #if !PLATFORM(ANDROID)
     m_axObjectCache = 0;
 #endif
@@ -470,6 +477,7 @@ void Document::removedLastRef()
         m_activeNode = 0;
         m_titleElement = 0;
         m_documentElement = 0;
+        m_selectorQueryCache.clear();
 
         // removeAllChildren() doesn't always unregister IDs, do it upfront to avoid having stale references in the map.
         m_elementsById.clear();
@@ -915,6 +923,34 @@ Element* Document::getElementById(const AtomicString& elementId) const
     return 0;
 }
 
+PassRefPtr<StaticNodeList> Document::cachedSelectorQuery(Node* rootNode, const String& selectors)
+{
+    if (!m_selectorQueryCache)
+        return 0;
+    if (m_selectorQueryCache->domTreeVersion != m_domtree_version) {
+        // Don't keep nodes alive that may have left the tree since.
+        m_selectorQueryCache.clear();
+        return 0;
+    }
+    if (m_selectorQueryCache->rootNode != rootNode || m_selectorQueryCache->selectors != selectors)
+        return 0;
+    // Each call returns a new list, so copy rather than share.
+    Vector<RefPtr<Node> > result(m_selectorQueryCache->result);
+    return StaticNodeList::adopt(result);
+}
+
+void Document::setCachedSelectorQuery(Node* rootNode, const String& selectors, const Vector<RefPtr<Node> >& result)
+{
+    ASSERT(rootNode->inDocument());
+    ASSERT(rootNode->document() == this);
+    if (!m_selectorQueryCache)
+        m_selectorQueryCache.set(new SelectorQueryCache);
+    m_selectorQueryCache->rootNode = rootNode;
+    m_selectorQueryCache->selectors = selectors;
+    m_selectorQueryCache->domTreeVersion = m_domtree_version;
+    m_selectorQueryCache->result = result;
+}
+
 String Document::readyState() const
 {
     if (Frame* f = frame()) {
@@ -1320,6 +1356,9 @@ bool Document::childNeedsAndNotInStyleRecalc()
 
 void Document::recalcStyle(StyleChange change)
 {
+#if PLATFORM(ANDROID)
+    android::TraceBufferAuto trace(android::TraceBuffer::CalculateStyleTrace);
+#endif
     // we should not enter style recalc while painting
     if (view() && view()->isPainting()) {
         ASSERT(!view()->isPainting());
@@ -1339,6 +1378,11 @@ void Document::recalcStyle(StyleChange change)
     RenderWidget::suspendWidgetHierarchyUpdates();
     if (view())
         view()->pauseScheduledEvents();
+    // Style changes repaint renderer by renderer; collect the rects and
+    // invalidate once when the recalc is done.
+    bool deferringRepaints = view() && page();
+    if (deferringRepaints)
+        view()->beginDeferredRepaints();
     
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::start(android::TimeCounter::CalculateStyleTimeCounter);
@@ -1358,9 +1402,11 @@ void Document::recalcStyle(StyleChange change)
             renderer()->setStyle(documentStyle.release());
     }
 
+    styleSelector()->setStyleRecalcInProgress(true);
     for (Node* n = firstChild(); n; n = n->nextSibling())
         if (change >= Inherit || n->childNeedsStyleRecalc() || n->needsStyleRecalc())
             n->recalcStyle(change);
+    styleSelector()->setStyleRecalcInProgress(false);
 
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::record(android::TimeCounter::CalculateStyleTimeCounter, __FUNCTION__);
@@ -1380,6 +1426,8 @@ bail_out:
     setChildNeedsStyleRecalc(false);
     unscheduleStyleRecalc();
 
+    if (deferringRepaints && page())
+        page()->mainFrame()->view()->endDeferredRepaints();
     if (view())
         view()->resumeScheduledEvents();
     RenderWidget::resumeWidgetHierarchyUpdates();
@@ -2007,6 +2055,7 @@ void Document::setBaseElementURL(const KURL& baseElementURL)
 
 void Document::updateBaseURL()
 {
+    KURL oldBaseURL = m_baseURL;
     // DOM 3 Core: When the Document supports the feature "HTML" [DOM Level 2 HTML], the base URI is computed using
     // first the value of the href attribute of the HTML BASE element if any, and the value of the documentURI attribute
     // from the Document interface otherwise.
@@ -2023,6 +2072,13 @@ void Document::updateBaseURL()
         m_elemSheet->setFinalURL(m_baseURL);
     if (m_mappedElementSheet)
         m_mappedElementSheet->setFinalURL(m_baseURL);
+
+    if (m_baseURL != oldBaseURL) {
+        for (Node* node = this; node; node = node->traverseNextNode()) {
+            if (node->hasTagName(aTag) || node->hasTagName(areaTag))
+                static_cast<HTMLAnchorElement*>(node)->invalidateCachedVisitedLinkHash();
+        }
+    }
 }
 
 String Document::userAgent(const KURL& url) const
@@ -3454,9 +3510,25 @@ KURL Document::completeURL(const String& url) const
     if (url.isNull())
         return KURL();
     const KURL& baseURL = ((m_baseURL.isEmpty() || m_baseURL == blankURL()) && parentDocument()) ? parentDocument()->baseURL() : m_baseURL;
-    if (!m_decoder)
-        return KURL(baseURL, url);
-    return KURL(baseURL, url, m_decoder->encoding());
+
+    // The same few relative URLs tend to be resolved over and over, by style
+    // resolution and by scripts reading href and src.
+    const char* encodingName = m_decoder ? m_decoder->encoding().name() : 0;
+    if (encodingName != m_completeURLCacheEncoding || baseURL != m_completeURLCacheBase) {
+        m_completeURLCache.clear();
+        m_completeURLCacheBase = baseURL;
+        m_completeURLCacheEncoding = encodingName;
+    }
+    HashMap<String, KURL>::iterator it = m_completeURLCache.find(url);
+    if (it != m_completeURLCache.end())
+        return it->second;
+
+    KURL completed = m_decoder ? KURL(baseURL, url, m_decoder->encoding()) : KURL(baseURL, url);
+    static const size_t maximumCompleteURLCacheSize = 64;
+    if (m_completeURLCache.size() >= maximumCompleteURLCacheSize)
+        m_completeURLCache.clear();
+    m_completeURLCache.set(url, completed);
+    return completed;
 }
 
 void Document::setInPageCache(bool flag)
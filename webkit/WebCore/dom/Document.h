@@ -12,6 +12,7 @@
 #include "Document.h"
 #include "DocumentMarker.h"
 #include "ScriptExecutionContext.h"
+#include "StringHash.h"
 #include "Timer.h"
 #if USE(JSC)
 #include <runtime/WeakGCMap.h>
@@ -79,6 +80,7 @@ namespace WebCore {
     class SerializedScriptValue;
     class SegmentedString;
     class Settings;
+    class StaticNodeList;
     class StyleSheet;
     class StyleSheetList;
     class Text;
@@ -788,6 +790,12 @@ public:
     void incDOMTreeVersion() { ++m_domtree_version; }
     unsigned domTreeVersion() const { return m_domtree_version; }
 
+    // The result of the last querySelectorAll() on a node in the document
+    // is kept until the tree version changes, for selectors whose matches
+    // can only change with the tree.
+    PassRefPtr<StaticNodeList> cachedSelectorQuery(Node* rootNode, const String& selectors);
+    void setCachedSelectorQuery(Node* rootNode, const String& selectors, const Vector<RefPtr<Node> >& result);
+
     void setDocType(PassRefPtr<DocumentType>);
 
 #if ENABLE(XPATH)
@@ -984,6 +992,10 @@ private:
     KURL m_url;  // Document.URL: The URL from which this document was retrieved.
     KURL m_baseURL;  // Node.baseURI: The URL to use when resolving relative URLs.
     KURL m_baseElementURL;  // The URL set by the <base> element.
+    // completeURL() results for the last base URL and encoding used
+    mutable HashMap<String, KURL> m_completeURLCache;
+    mutable KURL m_completeURLCacheBase;
+    mutable const char* m_completeURLCacheEncoding;
     KURL m_cookieURL;  // The URL to use for cookie access.
     KURL m_firstPartyForCookies; // The policy URL for third-party cookie blocking.
 
@@ -1036,6 +1048,16 @@ private:
     mutable RefPtr<Element> m_documentElement;
 
     unsigned m_domtree_version;
+
+    struct SelectorQueryCache {
+        // Not a reference, since the node can't go away without changing
+        // the tree version.
+        Node* rootNode;
+        String selectors;
+        unsigned domTreeVersion;
+        Vector<RefPtr<Node> > result;
+    };
+    OwnPtr<SelectorQueryCache> m_selectorQueryCache;
     
     HashSet<NodeIterator*> m_nodeIterators;
     HashSet<Range*> m_ranges;
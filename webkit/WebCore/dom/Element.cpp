@@ -567,10 +567,15 @@ void Element::attributeChanged(Attribute* attr, bool)
 
 void Element::updateAfterAttributeChanged(Attribute* attr)
 {
+    const QualifiedName& attrName = attr->name();
+    // getElementsByName() lists are the only ones that match on attributes
+    // other than class, which StyledElement takes care of.
+    if (attrName == nameAttr && document()->hasNodeListCaches())
+        notifyNodeListsNameAttributeChanged();
+
     if (!AXObjectCache::accessibilityEnabled())
         return;
 
-    const QualifiedName& attrName = attr->name();
     if (attrName == aria_activedescendantAttr) {
         // any change to aria-activedescendant attribute triggers accessibility focus change, but document focus remains intact
         document()->axObjectCache()->handleActiveDescendantChanged(renderer());
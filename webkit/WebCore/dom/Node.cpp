@@ -897,7 +897,7 @@ void Node::unregisterDynamicNodeList(DynamicNodeList* list)
     }
 }
 
-void Node::notifyLocalNodeListsAttributeChanged()
+void Node::notifyLocalNodeListsNameAttributeChanged()
 {
     if (!hasRareData())
         return;
@@ -905,10 +905,7 @@ void Node::notifyLocalNodeListsAttributeChanged()
     if (!data->nodeLists())
         return;
 
-    if (!isAttributeNode())
-        data->nodeLists()->invalidateCachesThatDependOnAttributes();
-    else
-        data->nodeLists()->invalidateCaches();
+    data->nodeLists()->invalidateNameCaches();
 
     if (data->nodeLists()->isEmpty()) {
         data->clearNodeLists();
@@ -916,10 +913,32 @@ void Node::notifyLocalNodeListsAttributeChanged()
     }
 }
 
-void Node::notifyNodeListsAttributeChanged()
+void Node::notifyNodeListsNameAttributeChanged()
 {
     for (Node *n = this; n; n = n->parentNode())
-        n->notifyLocalNodeListsAttributeChanged();
+        n->notifyLocalNodeListsNameAttributeChanged();
+}
+
+void Node::notifyLocalNodeListsClassesChanged(const Vector<AtomicString, 8>& changedClasses)
+{
+    if (!hasRareData())
+        return;
+    NodeRareData* data = rareData();
+    if (!data->nodeLists())
+        return;
+
+    data->nodeLists()->invalidateClassCaches(changedClasses, document()->inCompatMode());
+
+    if (data->nodeLists()->isEmpty()) {
+        data->clearNodeLists();
+        document()->removeNodeListCache();
+    }
+}
+
+void Node::notifyNodeListsClassesChanged(const Vector<AtomicString, 8>& changedClasses)
+{
+    for (Node* n = this; n; n = n->parentNode())
+        n->notifyLocalNodeListsClassesChanged(changedClasses);
 }
 
 void Node::notifyLocalNodeListsChildrenChanged()
@@ -1640,28 +1659,7 @@ PassRefPtr<Element> Node::querySelector(const String& selectors, ExceptionCode&
         return 0;
     }
 
-    CSSStyleSelector::SelectorChecker selectorChecker(document(), strictParsing);
-
-    // FIXME: we could also optimize for the the [id="foo"] case
-    if (strictParsing && inDocument() && querySelectorList.hasOneSelector() && querySelectorList.first()->m_match == CSSSelector::Id) {
-        Element* element = document()->getElementById(querySelectorList.first()->m_value);
-        if (element && (isDocumentNode() || element->isDescendantOf(this)) && selectorChecker.checkSelector(querySelectorList.first(), element))
-            return element;
-        return 0;
-    }
-
-    // FIXME: We can speed this up by implementing caching similar to the one use by getElementById
-    for (Node* n = firstChild(); n; n = n->traverseNextNode(this)) {
-        if (n->isElementNode()) {
-            Element* element = static_cast<Element*>(n);
-            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                if (selectorChecker.checkSelector(selector, element))
-                    return element;
-            }
-        }
-    }
-    
-    return 0;
+    return findFirstSelectorMatch(this, querySelectorList);
 }
 
 PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCode& ec)
@@ -1670,6 +1668,9 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         ec = SYNTAX_ERR;
         return 0;
     }
+    if (RefPtr<StaticNodeList> cachedResult = document()->cachedSelectorQuery(this, selectors))
+        return cachedResult.release();
+
     bool strictParsing = !document()->inCompatMode();
     CSSParser p(strictParsing);
 
@@ -1687,7 +1688,7 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         return 0;
     }
 
-    return createSelectorNodeList(this, querySelectorList);
+    return createSelectorNodeList(this, selectors, querySelectorList);
 }
 
 Document *Node::ownerDocument() const
@@ -2259,15 +2260,30 @@ void NodeListsNodeData::invalidateCaches()
     TagCacheMap::const_iterator tagCachesEnd = m_tagNodeListCaches.end();
     for (TagCacheMap::const_iterator it = m_tagNodeListCaches.begin(); it != tagCachesEnd; ++it)
         it->second->reset();
-    invalidateCachesThatDependOnAttributes();
+    CacheMap::iterator classCachesEnd = m_classNodeListCaches.end();
+    for (CacheMap::iterator it = m_classNodeListCaches.begin(); it != classCachesEnd; ++it)
+        it->second->reset();
+    invalidateNameCaches();
 }
 
-void NodeListsNodeData::invalidateCachesThatDependOnAttributes()
+void NodeListsNodeData::invalidateClassCaches(const Vector<AtomicString, 8>& changedClasses, bool shouldFoldCase)
 {
+    // An element is in a class list when it has all of the list's classes,
+    // so classes the list doesn't ask for can't move elements in or out.
     CacheMap::iterator classCachesEnd = m_classNodeListCaches.end();
-    for (CacheMap::iterator it = m_classNodeListCaches.begin(); it != classCachesEnd; ++it)
-        it->second->reset();
+    for (CacheMap::iterator it = m_classNodeListCaches.begin(); it != classCachesEnd; ++it) {
+        SpaceSplitString classNames(it->first, shouldFoldCase);
+        for (size_t i = 0; i < changedClasses.size(); ++i) {
+            if (classNames.contains(changedClasses[i])) {
+                it->second->reset();
+                break;
+            }
+        }
+    }
+}
 
+void NodeListsNodeData::invalidateNameCaches()
+{
     CacheMap::iterator nameCachesEnd = m_nameNodeListCaches.end();
     for (CacheMap::iterator it = m_nameNodeListCaches.begin(); it != nameCachesEnd; ++it)
         it->second->reset();
@@ -2773,8 +2789,11 @@ void Node::dispatchSubtreeModifiedEvent()
     
     document()->incDOMTreeVersion();
 
-    notifyNodeListsAttributeChanged(); // FIXME: Can do better some day. Really only care about the name attribute changing.
-    
+    // Other nodes tell their lists about changes as they happen, but Attr
+    // replaces its children without going through childrenChanged().
+    if (isAttributeNode())
+        notifyLocalNodeListsChildrenChanged();
+
     if (!document()->hasListenerType(Document::DOMSUBTREEMODIFIED_LISTENER))
         return;
 
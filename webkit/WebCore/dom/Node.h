@@ -472,8 +472,12 @@ public:
     void unregisterDynamicNodeList(DynamicNodeList*);
     void notifyNodeListsChildrenChanged();
     void notifyLocalNodeListsChildrenChanged();
-    void notifyNodeListsAttributeChanged();
-    void notifyLocalNodeListsAttributeChanged();
+    // Attribute changes only affect the lists that match on that attribute,
+    // and a change of classes only the lists for one of the changed classes.
+    void notifyNodeListsNameAttributeChanged();
+    void notifyLocalNodeListsNameAttributeChanged();
+    void notifyNodeListsClassesChanged(const Vector<AtomicString, 8>& changedClasses);
+    void notifyLocalNodeListsClassesChanged(const Vector<AtomicString, 8>& changedClasses);
     
     PassRefPtr<NodeList> getElementsByTagName(const String&);
     PassRefPtr<NodeList> getElementsByTagNameNS(const AtomicString& namespaceURI, const String& localName);
@@ -33,7 +33,8 @@ struct NodeListsNodeData : Noncopyable {
     }
     
     void invalidateCaches();
-    void invalidateCachesThatDependOnAttributes();
+    void invalidateNameCaches();
+    void invalidateClassCaches(const Vector<AtomicString, 8>& changedClasses, bool shouldFoldCase);
     bool isEmpty() const;
 
 private:
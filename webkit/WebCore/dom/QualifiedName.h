@@ -5,6 +5,7 @@
 
 #include "AtomicString.h"
 #include <wtf/HashTraits.h>
+#include <wtf/SlabAllocator.h>
 
 namespace WebCore {
 
@@ -17,6 +18,7 @@ struct QualifiedNameComponents {
 class QualifiedName : public FastAllocBase {
 public:
     class QualifiedNameImpl : public RefCounted<QualifiedNameImpl> {
+        WTF_MAKE_SLAB_ALLOCATED
     public:
         static PassRefPtr<QualifiedNameImpl> create(const AtomicString& prefix, const AtomicString& localName, const AtomicString& namespaceURI)
         {
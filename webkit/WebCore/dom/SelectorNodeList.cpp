@@ -14,34 +14,99 @@ namespace WebCore {
 
 using namespace HTMLNames;
 
-PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
+// Finds the element named by the rightmost #id in the selector that every
+// match has to be, or be inside. Ids behind a sibling combinator don't say
+// anything about the subtree, so the search stops there. Returns false if
+// the selector can't be narrowed down that way.
+static bool findIdentifiedElement(Document* document, CSSSelector* selector, Element*& element, bool& elementIsSubject)
+{
+    elementIsSubject = true;
+    for (; selector; selector = selector->tagHistory()) {
+        if (selector->m_match == CSSSelector::Id) {
+            if (document->containsMultipleElementsWithId(selector->m_value))
+                return false;
+            element = document->getElementById(selector->m_value);
+            return true;
+        }
+        CSSSelector::Relation relation = selector->relation();
+        if (relation == CSSSelector::DirectAdjacent || relation == CSSSelector::IndirectAdjacent)
+            return false;
+        if (relation != CSSSelector::SubSelector)
+            elementIsSubject = false;
+    }
+    return false;
+}
+
+static void collectSelectorMatches(Node* rootNode, const CSSSelectorList& querySelectorList, bool onlyFirst, Vector<RefPtr<Node> >& nodes)
 {
-    Vector<RefPtr<Node> > nodes;
     Document* document = rootNode->document();
     CSSSelector* onlySelector = querySelectorList.hasOneSelector() ? querySelectorList.first() : 0;
     bool strictParsing = !document->inCompatMode();
 
     CSSStyleSelector::SelectorChecker selectorChecker(document, strictParsing);
 
-    if (strictParsing && rootNode->inDocument() && onlySelector && onlySelector->m_match == CSSSelector::Id && !document->containsMultipleElementsWithId(onlySelector->m_value)) {
-        Element* element = document->getElementById(onlySelector->m_value);
-        if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, element))
-            nodes.append(element);
-    } else {
-        for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
-            if (n->isElementNode()) {
-                Element* element = static_cast<Element*>(n);
-                for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                    if (selectorChecker.checkSelector(selector, element)) {
-                        nodes.append(n);
-                        break;
-                    }
+    Node* searchRoot = rootNode;
+    Element* identifiedElement = 0;
+    bool elementIsSubject;
+    if (strictParsing && rootNode->inDocument() && onlySelector && findIdentifiedElement(document, onlySelector, identifiedElement, elementIsSubject)) {
+        if (!identifiedElement)
+            return;
+        if (elementIsSubject) {
+            if ((rootNode->isDocumentNode() || identifiedElement->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, identifiedElement))
+                nodes.append(identifiedElement);
+            return;
+        }
+        // Matches are inside the element, so only the part of the subtree
+        // that is inside both needs looking at.
+        if (identifiedElement->isDescendantOf(rootNode))
+            searchRoot = identifiedElement;
+        else if (identifiedElement != rootNode && !rootNode->isDescendantOf(identifiedElement))
+            return;
+    }
+
+    for (Node* n = searchRoot->firstChild(); n; n = n->traverseNextNode(searchRoot)) {
+        if (n->isElementNode()) {
+            Element* element = static_cast<Element*>(n);
+            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+                if (selectorChecker.checkSelector(selector, element)) {
+                    nodes.append(n);
+                    if (onlyFirst)
+                        return;
+                    break;
                 }
             }
         }
     }
-    
+}
+
+// Pseudo-classes can depend on state that changes without touching the
+// tree, such as hover or form control values, so only selectors without
+// them can have their results kept until the next mutation.
+static bool selectorListDependsOnlyOnTree(const CSSSelectorList& querySelectorList)
+{
+    for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+        for (CSSSelector* simpleSelector = selector; simpleSelector; simpleSelector = simpleSelector->tagHistory()) {
+            if (simpleSelector->m_match == CSSSelector::PseudoClass || simpleSelector->m_match == CSSSelector::PseudoElement)
+                return false;
+        }
+    }
+    return true;
+}
+
+PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const String& selectors, const CSSSelectorList& querySelectorList)
+{
+    Vector<RefPtr<Node> > nodes;
+    collectSelectorMatches(rootNode, querySelectorList, false, nodes);
+    if (rootNode->inDocument() && selectorListDependsOnlyOnTree(querySelectorList))
+        rootNode->document()->setCachedSelectorQuery(rootNode, selectors, nodes);
     return StaticNodeList::adopt(nodes);
 }
 
+Element* findFirstSelectorMatch(Node* rootNode, const CSSSelectorList& querySelectorList)
+{
+    Vector<RefPtr<Node> > nodes;
+    collectSelectorMatches(rootNode, querySelectorList, true, nodes);
+    return nodes.isEmpty() ? 0 : static_cast<Element*>(nodes[0].get());
+}
+
 } // namespace WebCore
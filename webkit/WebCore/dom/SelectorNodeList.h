@@ -8,8 +8,13 @@
 namespace WebCore {
 
     class CSSSelectorList;
+    class Element;
+    class String;
 
-    PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList&);
+    // Also records the result in the document's selector query cache when
+    // it can only change with the tree.
+    PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const String& selectors, const CSSSelectorList&);
+    Element* findFirstSelectorMatch(Node* rootNode, const CSSSelectorList&);
 
 } // namespace WebCore
 
@@ -191,6 +191,42 @@ bool StyledElement::mapToEntry(const QualifiedName& attrName, MappedAttributeEnt
     return true;
 }
 
+static StyleChangeType styleChangeForIdentifierUse(unsigned use)
+{
+    if (use & CSSStyleSelector::IdentifierAffectsOthers)
+        return FullStyleChange;
+    // Like a change to the inline style, this only affects the element itself.
+    if (use & CSSStyleSelector::IdentifierAffectsElement)
+        return InlineStyleChange;
+    return NoStyleChange;
+}
+
+void StyledElement::collectChangedClasses(const AtomicString& newClassString, Vector<AtomicString, 8>& changedClasses) const
+{
+    const SpaceSplitString& oldClasses = mappedAttributes()->classNames();
+    SpaceSplitString newClasses(newClassString, document()->inCompatMode());
+
+    size_t oldCount = oldClasses.size();
+    for (size_t i = 0; i < oldCount; ++i) {
+        if (!newClasses.contains(oldClasses[i]))
+            changedClasses.append(oldClasses[i]);
+    }
+    size_t newCount = newClasses.size();
+    for (size_t i = 0; i < newCount; ++i) {
+        if (!oldClasses.contains(newClasses[i]))
+            changedClasses.append(newClasses[i]);
+    }
+}
+
+StyleChangeType StyledElement::styleChangeForClassChange(const Vector<AtomicString, 8>& changedClasses) const
+{
+    CSSStyleSelector* styleSelector = document()->styleSelector();
+    unsigned use = 0;
+    for (size_t i = 0; i < changedClasses.size(); ++i)
+        use |= styleSelector->classUse(changedClasses[i]);
+    return styleChangeForIdentifierUse(use);
+}
+
 void StyledElement::classAttributeChanged(const AtomicString& newClassString)
 {
     const UChar* characters = newClassString.characters();
@@ -200,6 +236,17 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
         if (!isClassWhitespace(characters[i]))
             break;
     }
+    // Only the classes that were added or removed matter, both to style and
+    // to getElementsByClassName() lists. Detached elements get their style
+    // computed from scratch anyway.
+    bool needsStyleChange = attached();
+    bool needsNodeListChange = document()->hasNodeListCaches();
+    Vector<AtomicString, 8> changedClasses;
+    if (namedAttrMap && (needsStyleChange || needsNodeListChange))
+        collectChangedClasses(i < length ? newClassString : nullAtom, changedClasses);
+    StyleChangeType changeType = FullStyleChange;
+    if (namedAttrMap && needsStyleChange)
+        changeType = styleChangeForClassChange(changedClasses);
     setHasClass(i < length);
     if (namedAttrMap) {
         if (i < length)
@@ -207,7 +254,10 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
         else
             mappedAttributes()->clearClass();
     }
-    setNeedsStyleRecalc();
+    if (changeType != NoStyleChange)
+        setNeedsStyleRecalc(changeType);
+    if (namedAttrMap && needsNodeListChange && !changedClasses.isEmpty())
+        notifyNodeListsClassesChanged(changedClasses);
     dispatchSubtreeModifiedEvent();
 }
 
@@ -216,15 +266,30 @@ void StyledElement::parseMappedAttribute(MappedAttribute *attr)
     if (attr->name() == idAttributeName()) {
         // unique id
         setHasID(!attr->isNull());
+        StyleChangeType changeType = FullStyleChange;
         if (namedAttrMap) {
+            AtomicString oldID = namedAttrMap->id();
             if (attr->isNull())
                 namedAttrMap->setID(nullAtom);
             else if (document()->inCompatMode())
                 namedAttrMap->setID(attr->value().lower());
             else
                 namedAttrMap->setID(attr->value());
+            if (attached()) {
+                const AtomicString& newID = namedAttrMap->id();
+                CSSStyleSelector* styleSelector = document()->styleSelector();
+                unsigned use = 0;
+                if (oldID != newID) {
+                    if (!oldID.isNull())
+                        use |= styleSelector->idUse(oldID);
+                    if (!newID.isNull())
+                        use |= styleSelector->idUse(newID);
+                }
+                changeType = styleChangeForIdentifierUse(use);
+            }
         }
-        setNeedsStyleRecalc();
+        if (changeType != NoStyleChange)
+            setNeedsStyleRecalc(changeType);
     } else if (attr->name() == classAttr)
         classAttributeChanged(attr->value());
     else if (attr->name() == styleAttr) {
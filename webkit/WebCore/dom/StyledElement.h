@@ -63,6 +63,8 @@ protected:
     // parseMappedAttribute (called via setAttribute()) and
     // svgAttributeChanged (called when element.className.baseValue is set)
     void classAttributeChanged(const AtomicString& newClassString);
+    void collectChangedClasses(const AtomicString& newClassString, Vector<AtomicString, 8>& changedClasses) const;
+    StyleChangeType styleChangeForClassChange(const Vector<AtomicString, 8>& changedClasses) const;
     
     virtual void didMoveToNewOwnerDocument();
 
@@ -109,7 +109,7 @@ void XMLTokenizer::write(const SegmentedString& s, bool /*appendData*/)
         return;
     }
     
-    doWrite(s.toString());
+    doWrite(parseString);
     
     // After parsing, go ahead and dispatch image beforeload events.
     ImageLoader::dispatchPendingBeforeLoadEvents();
@@ -154,7 +154,7 @@ bool XMLTokenizer::enterText()
 #if !USE(QXMLSTREAM)
 static inline String toString(const xmlChar* str, unsigned len)
 {
-    return UTF8Encoding().decode(reinterpret_cast<const char*>(str), len);
+    return String::fromUTF8(reinterpret_cast<const char*>(str), len);
 }
 #endif
 
@@ -605,6 +605,15 @@ XMLTokenizer::~XMLTokenizer()
         m_pendingScript->removeClient(this);
 }
 
+static bool isLatin1(const UChar* characters, unsigned length)
+{
+    for (unsigned i = 0; i < length; ++i) {
+        if (characters[i] > 0xFF)
+            return false;
+    }
+    return true;
+}
+
 void XMLTokenizer::doWrite(const String& parseString)
 {
     if (!m_context)
@@ -615,16 +624,33 @@ void XMLTokenizer::doWrite(const String& parseString)
 
     // libXML throws an error if you try to switch the encoding for an empty string.
     if (parseString.length()) {
+        const UChar* characters = parseString.characters();
+        unsigned length = parseString.length();
+
         // Hack around libxml2's lack of encoding overide support by manually
-        // resetting the encoding to UTF-16 before every chunk.  Otherwise libxml
+        // resetting the encoding before every chunk.  Otherwise libxml
         // will detect <?xml version="1.0" encoding="<encoding name>"?> blocks 
         // and switch encodings, causing the parse to fail.
-        const UChar BOM = 0xFEFF;
-        const unsigned char BOMHighByte = *reinterpret_cast<const unsigned char*>(&BOM);
-        xmlSwitchEncoding(context->context(), BOMHighByte == 0xFF ? XML_CHAR_ENCODING_UTF16LE : XML_CHAR_ENCODING_UTF16BE);
+        // Chunks with nothing above U+00FF, which is most of them, go in as
+        // Latin-1: half the bytes, and the cheapest conversion to the UTF-8
+        // libxml parses internally.
+        Vector<char> latin1;
+        if (isLatin1(characters, length)) {
+            latin1.resize(length);
+            for (unsigned i = 0; i < length; ++i)
+                latin1[i] = static_cast<char>(characters[i]);
+            xmlSwitchEncoding(context->context(), XML_CHAR_ENCODING_8859_1);
+        } else {
+            const UChar BOM = 0xFEFF;
+            const unsigned char BOMHighByte = *reinterpret_cast<const unsigned char*>(&BOM);
+            xmlSwitchEncoding(context->context(), BOMHighByte == 0xFF ? XML_CHAR_ENCODING_UTF16LE : XML_CHAR_ENCODING_UTF16BE);
+        }
 
         XMLTokenizerScope scope(m_doc->docLoader());
-        xmlParseChunk(context->context(), reinterpret_cast<const char*>(parseString.characters()), sizeof(UChar) * parseString.length(), 0);
+        if (!latin1.isEmpty())
+            xmlParseChunk(context->context(), latin1.data(), length, 0);
+        else
+            xmlParseChunk(context->context(), reinterpret_cast<const char*>(characters), sizeof(UChar) * length, 0);
     }
     
     if (m_doc->decoder() && m_doc->decoder()->sawError()) {
@@ -637,7 +663,7 @@ void XMLTokenizer::doWrite(const String& parseString)
 
 static inline String toString(const xmlChar* str, unsigned len)
 {
-    return UTF8Encoding().decode(reinterpret_cast<const char*>(str), len);
+    return String::fromUTF8(reinterpret_cast<const char*>(str), len);
 }
 
 static inline String toString(const xmlChar* str)
@@ -645,7 +671,7 @@ static inline String toString(const xmlChar* str)
     if (!str)
         return String();
     
-    return UTF8Encoding().decode(reinterpret_cast<const char*>(str), strlen(reinterpret_cast<const char*>(str)));
+    return String::fromUTF8(reinterpret_cast<const char*>(str));
 }
 
 struct _xmlSAX2Namespace {
@@ -575,10 +575,47 @@ sub printDefinitions
     for my $name (sort keys %$namesRef) {
         my $realName = $name;
         $realName =~ s/_/-/g;
-        print F "    new ((void*)&$name","${shortCamelType}) QualifiedName(nullAtom, \"$realName\", $namespaceURI);\n";
+        my $length = length($realName);
+        my $hash = sprintf("0x%08xU", stringHash($realName));
+        print F "    new ((void*)&$name","${shortCamelType}) QualifiedName(nullAtom, AtomicString::addStatic(\"$realName\", $length, $hash), $namespaceURI);\n";
     }
 }
 
+# Must match WTF::stringHash, so that the names don't have to be hashed at
+# startup.
+sub stringHash
+{
+    my ($string) = @_;
+    my @characters = map { ord } split(//, $string);
+    my $hash = 0x9e3779b9;
+    my $pairs = scalar(@characters) >> 1;
+    my $i = 0;
+
+    for (; $pairs > 0; $pairs--) {
+        $hash = ($hash + $characters[$i]) & 0xffffffff;
+        my $tmp = (($characters[$i + 1] << 11) ^ $hash) & 0xffffffff;
+        $hash = (($hash << 16) & 0xffffffff) ^ $tmp;
+        $i += 2;
+        $hash = ($hash + ($hash >> 11)) & 0xffffffff;
+    }
+
+    if (scalar(@characters) & 1) {
+        $hash = ($hash + $characters[$i]) & 0xffffffff;
+        $hash ^= ($hash << 11) & 0xffffffff;
+        $hash = ($hash + ($hash >> 17)) & 0xffffffff;
+    }
+
+    $hash ^= ($hash << 3) & 0xffffffff;
+    $hash = ($hash + ($hash >> 5)) & 0xffffffff;
+    $hash ^= ($hash << 2) & 0xffffffff;
+    $hash = ($hash + ($hash >> 15)) & 0xffffffff;
+    $hash ^= ($hash << 10) & 0xffffffff;
+
+    $hash &= 0x7fffffff;
+    $hash = 0x40000000 if !$hash;
+    return $hash;
+}
+
 ## ElementFactory routines
 
 sub printFactoryCppFile
@@ -14,6 +14,8 @@
 #include "Frame.h"
 #include "Logging.h"
 #include "HTMLInterchange.h"
+#include "RenderObject.h"
+#include "Text.h"
 #include "htmlediting.h"
 #include "TextIterator.h"
 #include "TypingCommand.h"
@@ -83,6 +85,56 @@ bool InsertTextCommand::performTrivialReplace(const String& text, bool selectIns
     return true;
 }
 
+// Text fields and text areas hold their value in a single block of preserved
+// whitespace, so typing there never needs placeholders removed, whitespace
+// rebalanced or the caret canonicalized, all of which cost a layout.
+bool InsertTextCommand::performTextControlInsertion(const String& text, bool selectInsertedText)
+{
+    if (!endingSelection().isCaret())
+        return false;
+
+    if (text.contains('\t') || text.contains(' ') || text.contains('\n'))
+        return false;
+
+    if (document()->frame()->typingStyle())
+        return false;
+
+    Element* root = endingSelection().rootEditableElement();
+    if (!root || !root->isShadowNode())
+        return false;
+    RenderObject* host = root->shadowAncestorNode()->renderer();
+    if (!host || !host->isTextControl())
+        return false;
+
+    Position start = endingSelection().start();
+    Node* node = start.node();
+    if (!node || !node->isTextNode() || node->parentNode() != root || isTabSpanTextNode(node))
+        return false;
+    if (!node->renderer() || node->renderer()->style()->collapseWhiteSpace())
+        return false;
+
+    // A line break after the caret may be a placeholder that the inserted text makes unnecessary.
+    Text* textNode = static_cast<Text*>(node);
+    int offset = start.deprecatedEditingOffset();
+    if (offset < 0 || static_cast<unsigned>(offset) > textNode->length())
+        return false;
+    if (static_cast<unsigned>(offset) == textNode->length() && textNode->nextSibling())
+        return false;
+
+    insertTextIntoNode(textNode, offset, text);
+    m_charactersAdded += text.length();
+
+    Position endPosition(textNode, offset + text.length());
+    VisibleSelection forcedEndingSelection;
+    if (selectInsertedText)
+        forcedEndingSelection.setWithoutValidation(start, endPosition);
+    else
+        forcedEndingSelection.setWithoutValidation(endPosition, endPosition);
+    setEndingSelection(forcedEndingSelection);
+
+    return true;
+}
+
 void InsertTextCommand::input(const String& text, bool selectInsertedText)
 {
     
@@ -97,7 +149,8 @@ void InsertTextCommand::input(const String& text, bool selectInsertedText)
         if (performTrivialReplace(text, selectInsertedText))
             return;
         deleteSelection(false, true, true, false);
-    }
+    } else if (performTextControlInsertion(text, selectInsertedText))
+        return;
 
     Position startPosition(endingSelection().start());
     
@@ -29,6 +29,7 @@ private:
     Position insertTab(const Position&);
     
     bool performTrivialReplace(const String&, bool selectInsertedText);
+    bool performTextControlInsertion(const String&, bool selectInsertedText);
 
     unsigned m_charactersAdded;
 };
@@ -24,6 +24,7 @@ HTMLAnchorElement::HTMLAnchorElement(const QualifiedName& tagName, Document* doc
     : HTMLElement(tagName, document, CreateElement)
     , m_wasShiftKeyDownOnMouseDown(false)
     , m_linkRelations(0)
+    , m_cachedVisitedLinkHash(0)
 {
 }
 
@@ -250,6 +251,7 @@ void HTMLAnchorElement::setActive(bool down, bool pause)
 void HTMLAnchorElement::parseMappedAttribute(MappedAttribute *attr)
 {
     if (attr->name() == hrefAttr) {
+        invalidateCachedVisitedLinkHash();
         bool wasLink = isLink();
         setIsLink(!attr->isNull());
         if (wasLink != isLink())
@@ -274,6 +276,21 @@ void HTMLAnchorElement::parseMappedAttribute(MappedAttribute *attr)
         HTMLElement::parseMappedAttribute(attr);
 }
 
+void HTMLAnchorElement::didMoveToNewOwnerDocument()
+{
+    invalidateCachedVisitedLinkHash();
+    HTMLElement::didMoveToNewOwnerDocument();
+}
+
+LinkHash HTMLAnchorElement::visitedLinkHash() const
+{
+    // 0 is also the hash of links that can't be visited, which are rare
+    // enough to just hash again.
+    if (!m_cachedVisitedLinkHash)
+        m_cachedVisitedLinkHash = WebCore::visitedLinkHash(document()->baseURL(), getAttribute(hrefAttr));
+    return m_cachedVisitedLinkHash;
+}
+
 void HTMLAnchorElement::accessKeyAction(bool sendToAnyElement)
 {
     // send the mouse button events if the caller specified sendToAnyElement
@@ -4,6 +4,7 @@
 #define HTMLAnchorElement_h
 
 #include "HTMLElement.h"
+#include "LinkHash.h"
 
 namespace WebCore {
 
@@ -70,10 +71,16 @@ public:
     bool hasRel(uint32_t relation) const;
     void setRel(const String&);
 
+    // Kept from one style resolution to the next; resolving the href
+    // against the base URL is most of what looking up :visited costs.
+    LinkHash visitedLinkHash() const;
+    void invalidateCachedVisitedLinkHash() { m_cachedVisitedLinkHash = 0; }
+
 protected:
     HTMLAnchorElement(const QualifiedName&, Document*);
 
     virtual void parseMappedAttribute(MappedAttribute*);
+    virtual void didMoveToNewOwnerDocument();
 
 private:
     virtual HTMLTagStatus endTagRequirement() const { return TagStatusRequired; }
@@ -93,6 +100,7 @@ private:
     RefPtr<Element> m_rootEditableElementForSelectionOnMouseDown;
     bool m_wasShiftKeyDownOnMouseDown;
     uint32_t m_linkRelations;
+    mutable LinkHash m_cachedVisitedLinkHash;
 };
 
 } // namespace WebCore
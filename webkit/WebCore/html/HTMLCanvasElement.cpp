@@ -46,6 +46,9 @@ HTMLCanvasElement::HTMLCanvasElement(const QualifiedName& tagName, Document* doc
     , m_observer(0)
     , m_originClean(true)
     , m_ignoreReset(false)
+#if PLATFORM(ANDROID)
+    , m_repaintTimer(this, &HTMLCanvasElement::repaintTimerFired)
+#endif
     , m_createdImageBuffer(false)
 {
     ASSERT(hasTagName(canvasTag));
@@ -180,13 +183,30 @@ void HTMLCanvasElement::willDraw(const FloatRect& rect)
             return;
 
         m_dirtyRect.unite(r);
+#if PLATFORM(ANDROID)
+        m_repaintRect.unite(r);
+        if (!m_repaintTimer.isActive())
+            m_repaintTimer.startOneShot(0);
+#else
         ro->repaintRectangle(enclosingIntRect(m_dirtyRect));
+#endif
     }
     
     if (m_observer)
         m_observer->canvasChanged(this, rect);
 }
 
+#if PLATFORM(ANDROID)
+void HTMLCanvasElement::repaintTimerFired(Timer<HTMLCanvasElement>*)
+{
+    // Kept apart from m_dirtyRect, which a paint in between would clear
+    // before this repaint is asked for.
+    if (RenderBox* ro = renderBox())
+        ro->repaintRectangle(enclosingIntRect(m_repaintRect));
+    m_repaintRect = FloatRect();
+}
+#endif
+
 void HTMLCanvasElement::reset()
 {
     if (m_ignoreReset)
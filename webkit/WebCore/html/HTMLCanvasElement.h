@@ -10,6 +10,9 @@
 #include "GraphicsContext3D.h"
 #endif
 #include "IntSize.h"
+#if PLATFORM(ANDROID)
+#include "Timer.h"
+#endif
 
 namespace WebCore {
 
@@ -95,6 +98,9 @@ private:
 
     void createImageBuffer() const;
     void reset();
+#if PLATFORM(ANDROID)
+    void repaintTimerFired(Timer<HTMLCanvasElement>*);
+#endif
 
     static const float MaxCanvasArea;
 
@@ -107,6 +113,12 @@ private:
     bool m_originClean;
     bool m_ignoreReset;
     FloatRect m_dirtyRect;
+#if PLATFORM(ANDROID)
+    // Drawing since the last repaint, repainted in one go once the script
+    // drawing it returns rather than after every call
+    FloatRect m_repaintRect;
+    Timer<HTMLCanvasElement> m_repaintTimer;
+#endif
 
     // m_createdImageBuffer means we tried to malloc the buffer.  We didn't necessarily get it.
     mutable bool m_createdImageBuffer;
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "HTMLTokenizer.h"
 
+#include "ASCIIFastPath.h"
 #include "CSSHelper.h"
 #include "Cache.h"
 #include "CachedScript.h"
@@ -36,6 +37,10 @@
 #include "TimeCounter.h"
 #endif
 
+#if PLATFORM(ANDROID)
+#include "TraceBuffer.h"
+#endif
+
 #define PRELOAD_SCANNER_ENABLED 1
 // #define INSTRUMENT_LAYOUT_SCHEDULING 1
 
@@ -118,6 +123,50 @@ static inline bool tagMatch(const char* s1, const UChar* s2, unsigned length)
     return true;
 }
 
+// Characters above '>' never end a run of text or of an attribute value, so
+// plainRunLength() skips them a machine word at a time and only asks the
+// stopper about the others. None of the runs may hold a newline.
+struct TextRunStopper {
+    static bool stopsAt(UChar c) { return c == '<' || c == '&' || c == '\n' || c == '\r'; }
+};
+
+struct PlainTextRunStopper {
+    static bool stopsAt(UChar c) { return c == '\n' || c == '\r'; }
+};
+
+struct QuotedValueRunStopper {
+    static bool stopsAt(UChar c) { return c == '&' || c == '>' || c == '"' || c == '\'' || c == '\n'; }
+};
+
+struct UnquotedValueRunStopper {
+    static bool stopsAt(UChar c) { return c == '&' || c == '>' || isASCIISpace(c); }
+};
+
+// Returns how many of the characters at the start of src can be copied as
+// they are, without looking at them one at a time.
+template<typename Stopper>
+static inline int plainRunLength(const SegmentedString& src)
+{
+    static const int charactersPerWord = sizeof(MachineWord) / sizeof(UChar);
+
+    int length;
+    const UChar* start = src.currentRun(length);
+    const UChar* end = start + length;
+    const UChar* p = start;
+    while (p < end) {
+        if (isAlignedToMachineWord(p)) {
+            while (end - p >= charactersPerWord && !containsCharacterBelow(*reinterpret_cast<const MachineWord*>(p), '>' + 1))
+                p += charactersPerWord;
+            if (p == end)
+                break;
+        }
+        if (*p <= '>' && Stopper::stopsAt(*p))
+            break;
+        ++p;
+    }
+    return p - start;
+}
+
 inline void Token::addAttribute(AtomicString& attrName, const AtomicString& attributeValue, bool viewSourceMode)
 {
     if (!attrName.isEmpty()) {
@@ -133,6 +182,16 @@ inline void Token::addAttribute(AtomicString& attrName, const AtomicString& attr
     attrName = emptyAtom;
 }
 
+inline void HTMLTokenizer::copyRun(SegmentedString& src, int length)
+{
+    if (!length)
+        return;
+    checkBuffer(length);
+    memcpy(m_dest, &*src, length * sizeof(UChar));
+    m_dest += length;
+    src.advancePastNonNewlines(length);
+}
+
 // ----------------------------------------------------------------------------
 
 HTMLTokenizer::HTMLTokenizer(HTMLDocument* doc, bool reportErrors)
@@ -536,7 +595,7 @@ HTMLTokenizer::State HTMLTokenizer::scriptHandler(State state)
 #if PRELOAD_SCANNER_ENABLED
     if (!m_pendingScripts.isEmpty() && !m_executingScript) {
         if (!m_preloadScanner)
-            m_preloadScanner.set(new PreloadScanner(m_doc));
+            m_preloadScanner.set(new PreloadScanner(m_doc, true));
         if (!m_preloadScanner->inProgress()) {
             m_preloadScanner->begin();
             m_preloadScanner->write(m_pendingSrc);
@@ -719,9 +778,12 @@ HTMLTokenizer::State HTMLTokenizer::parseText(SegmentedString& src, State state)
         if (cc == '\r') {
             state.setSkipLF(true);
             *m_dest++ = '\n';
-        } else
+            src.advance(m_lineNumber);
+        } else {
             *m_dest++ = cc;
-        src.advance(m_lineNumber);
+            src.advance(m_lineNumber);
+            copyRun(src, plainRunLength<PlainTextRunStopper>(src));
+        }
     }
 
     return state;
@@ -1233,7 +1295,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 // Now that we've shaved off any invalid / that might have followed the name), make the tag.
                 // FIXME: FireFox and WinIE turn !foo nodes into comments, we ignore comments. (fast/parser/tag-with-exclamation-point.html)
                 if (ptr[0] != '!' || inViewSourceMode()) {
-                    m_currentToken.tagName = AtomicString(ptr);
+                    m_currentToken.tagName = AtomicString::addName(ptr, len);
                     m_currentToken.beginTag = beginTag;
                 }
                 m_dest = m_buffer;
@@ -1270,7 +1332,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 // cases like <input type=checkbox checked/> to work (and accommodates XML-style syntax as per HTML5).
                 if (curchar <= '>' && (curchar >= '<' || isASCIISpace(curchar) || curchar == '/')) {
                     m_cBuffer[cBufferPos] = '\0';
-                    m_attrName = AtomicString(m_cBuffer);
+                    m_attrName = AtomicString::addName(m_cBuffer, cBufferPos);
                     m_dest = m_buffer;
                     *m_dest++ = 0;
                     state.setTagState(SearchEqual);
@@ -1290,7 +1352,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
             }
             if (cBufferPos == CBUFLEN) {
                 m_cBuffer[cBufferPos] = '\0';
-                m_attrName = AtomicString(m_cBuffer);
+                m_attrName = AtomicString::addName(m_cBuffer, cBufferPos);
                 m_dest = m_buffer;
                 *m_dest++ = 0;
                 state.setTagState(SearchEqual);
@@ -1423,6 +1485,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
 
                 *m_dest++ = curchar;
                 src.advance(m_lineNumber);
+                copyRun(src, plainRunLength<QuotedValueRunStopper>(src));
             }
             break;
         case Value:
@@ -1458,6 +1521,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
 
                 *m_dest++ = curchar;
                 src.advance(m_lineNumber);
+                copyRun(src, plainRunLength<UnquotedValueRunStopper>(src));
             }
             break;
         case SearchEnd:
@@ -1620,6 +1684,10 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
 {
     if (!m_buffer)
         return;
+
+#if PLATFORM(ANDROID)
+    android::TraceBufferAuto trace(android::TraceBuffer::ParseTrace);
+#endif
     
     if (m_parserStopped)
         return;
@@ -1643,8 +1711,14 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
     }
     
 #if PRELOAD_SCANNER_ENABLED
-    if (m_preloadScanner && m_preloadScanner->inProgress() && appendData)
-        m_preloadScanner->end();
+    if (m_preloadScanner && m_preloadScanner->inProgress() && appendData) {
+        // The scanner is ahead of us until we reach the end of what has
+        // arrived, so new data goes to it too until then.
+        if (m_src.isEmpty())
+            m_preloadScanner->end();
+        else
+            m_preloadScanner->write(source);
+    }
 #endif
 
     if (!m_src.isEmpty())
@@ -1788,6 +1862,9 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
             state.setDiscardLF(false);
             *m_dest++ = cc;
             m_src.advancePastNonNewline();
+            int runLength = plainRunLength<TextRunStopper>(m_src);
+            copyRun(m_src, runLength);
+            processedCount += runLength;
         }
     }
     
@@ -1805,6 +1882,20 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
 
     m_state = state;
 
+#if PRELOAD_SCANNER_ENABLED
+    // If we yielded before getting through the data that has arrived, look
+    // through the rest for resources to load while we wait, as we do when a
+    // script blocks us.
+    if (appendData && m_timer.isActive() && !m_src.isEmpty() && m_pendingScripts.isEmpty()) {
+        if (!m_preloadScanner)
+            m_preloadScanner.set(new PreloadScanner(m_doc, true));
+        if (!m_preloadScanner->inProgress()) {
+            m_preloadScanner->begin();
+            m_preloadScanner->write(m_src);
+        }
+    }
+#endif
+
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::record(android::TimeCounter::ParsingTimeCounter, __FUNCTION__);
 #endif
@@ -1839,7 +1930,7 @@ void HTMLTokenizer::timerFired(Timer<HTMLTokenizer>*)
         printf("Beginning timer write at time %d\n", m_doc->elapsedTime());
 #endif
 
-    if (m_doc->view() && m_doc->view()->layoutPending() && !m_doc->minimumLayoutDelay()) {
+    if (m_doc->view() && m_doc->view()->layoutPending() && !m_doc->minimumLayoutDelay() && !m_doc->view()->isDeferringLayoutBelowTheFold()) {
         // Restart the timer and let layout win.  This is basically a way of ensuring that the layout
         // timer has higher priority than our timer.
         m_timer.startOneShot(0);
@@ -2102,7 +2193,7 @@ void HTMLTokenizer::executeExternalScriptsIfReady()
 
 void HTMLTokenizer::executeExternalScriptsTimerFired(Timer<HTMLTokenizer>*)
 {
-    if (m_doc->view() && m_doc->view()->layoutPending() && !m_doc->minimumLayoutDelay()) {
+    if (m_doc->view() && m_doc->view()->layoutPending() && !m_doc->minimumLayoutDelay() && !m_doc->view()->isDeferringLayoutBelowTheFold()) {
         // Restart the timer and do layout first.
         m_externalScriptsTimer.startOneShot(0);
         return;
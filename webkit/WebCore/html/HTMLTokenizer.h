@@ -170,6 +170,9 @@ private:
     }
 
     void enlargeBuffer(int len);
+    // Copies the next length characters of src, none of them newlines or
+    // pushed characters, to the buffer.
+    void copyRun(SegmentedString&, int length);
     void enlargeScriptBuffer(int len);
 
     bool continueProcessing(int& processedCount, double startTime, State&);
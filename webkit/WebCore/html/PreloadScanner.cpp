@@ -3,7 +3,6 @@
 #include "config.h"
 #include "PreloadScanner.h"
 
-#include "AtomicString.h"
 #include "CachedCSSStyleSheet.h"
 #include "CachedImage.h"
 #include "CachedResource.h"
@@ -16,8 +15,13 @@
 #include "Frame.h"
 #include "FrameLoader.h"
 #include "HTMLLinkElement.h"
-#include "HTMLNames.h"
+#include "KURL.h"
 #include <wtf/CurrentTime.h>
+#include <wtf/Deque.h>
+#include <wtf/MainThread.h>
+#include <wtf/ThreadPool.h>
+#include <wtf/Threading.h>
+#include <wtf/VectorSizeProfile.h>
 #include <wtf/unicode/Unicode.h>
 
 // Use __GNUC__ instead of PLATFORM(GCC) to stay consistent with the gperf generated c file
@@ -35,17 +39,156 @@ const struct Entity* findEntity(register const char* str, register unsigned int
 
 #define PRELOAD_DEBUG 0
 
+// Longer url() values are given up on, which keeps an unterminated one from
+// collecting the rest of the style sheet.
+static const unsigned maxCSSURLLength = 2048;
+
+// What a background scan is written is copied over to its thread in pieces
+// of at most this many characters, so that end() never waits long for the
+// piece being scanned.
+static const unsigned backgroundScanChunkLength = 8 * 1024;
+
 using namespace WTF;
 
 namespace WebCore {
+
+// Runs a PreloadScanner's tokenizer on the shared thread pool, one chunk at
+// a time and in the order they were written, and passes the requests it
+// finds back to the main thread to issue. Chunks are copies made for the
+// background thread, and the requests it finds only hold Strings it made
+// itself, so nothing is shared with the main thread but the queues below.
+class PreloadScanner::BackgroundScan : public ThreadSafeShared<BackgroundScan> {
+public:
+    static PassRefPtr<BackgroundScan> create(PreloadScanner* scanner) { return adoptRef(new BackgroundScan(scanner)); }
+
+    void append(const SegmentedString&);
+    void takeRequests(Vector<PreloadRequest>&);
+    // Waits for the chunk being scanned, drops the rest and gives the
+    // scanner's tokenizer state back to the main thread.
+    void stop();
+
+private:
+    BackgroundScan(PreloadScanner*);
+
+    static void scanOnBackgroundThread(void*);
+    static void issuePreloadsOnMainThread(void*);
+    void run();
+
+    // Cleared by stop(). Only the main thread changes it, and only while
+    // nothing is being scanned.
+    PreloadScanner* m_scanner;
+
+    Mutex m_lock;
+    ThreadCondition m_scanFinished;
+    Deque<String> m_chunks;
+    Vector<PreloadRequest> m_requests;
+    bool m_scanning;
+    bool m_issueScheduled;
+    bool m_stopped;
+};
+
+PreloadScanner::BackgroundScan::BackgroundScan(PreloadScanner* scanner)
+    : m_scanner(scanner)
+    , m_scanning(false)
+    , m_issueScheduled(false)
+    , m_stopped(false)
+{
+}
+
+void PreloadScanner::BackgroundScan::append(const SegmentedString& source)
+{
+    String string = source.toString();
+    MutexLocker locker(m_lock);
+    if (m_stopped)
+        return;
+    for (unsigned offset = 0; offset < string.length(); offset += backgroundScanChunkLength)
+        m_chunks.append(String(string.characters() + offset, std::min(backgroundScanChunkLength, string.length() - offset)));
+    if (m_scanning || m_chunks.isEmpty())
+        return;
+    m_scanning = true;
+    ref();
+    dispatchToBackground(scanOnBackgroundThread, this);
+}
+
+void PreloadScanner::BackgroundScan::scanOnBackgroundThread(void* context)
+{
+    BackgroundScan* scan = static_cast<BackgroundScan*>(context);
+    scan->run();
+    scan->deref();
+}
+
+void PreloadScanner::BackgroundScan::run()
+{
+    while (true) {
+        String chunk;
+        {
+            MutexLocker locker(m_lock);
+            if (m_stopped || m_chunks.isEmpty()) {
+                m_scanning = false;
+                m_scanFinished.signal();
+                return;
+            }
+            chunk = m_chunks.first();
+            m_chunks.removeFirst();
+        }
+
+#if PRELOAD_DEBUG
+        double startTime = currentTime();
+#endif
+        m_scanner->tokenize(SegmentedString(chunk));
+#if PRELOAD_DEBUG
+        m_scanner->m_timeUsed += currentTime() - startTime;
+#endif
+        if (m_scanner->m_requests.isEmpty())
+            continue;
+
+        MutexLocker locker(m_lock);
+        m_requests.append(m_scanner->m_requests);
+        m_scanner->m_requests.clear();
+        if (!m_issueScheduled) {
+            m_issueScheduled = true;
+            ref();
+            callOnMainThread(issuePreloadsOnMainThread, this);
+        }
+    }
+}
+
+void PreloadScanner::BackgroundScan::issuePreloadsOnMainThread(void* context)
+{
+    BackgroundScan* scan = static_cast<BackgroundScan*>(context);
+    {
+        MutexLocker locker(scan->m_lock);
+        scan->m_issueScheduled = false;
+    }
+    if (scan->m_scanner)
+        scan->m_scanner->issuePreloads();
+    scan->deref();
+}
+
+void PreloadScanner::BackgroundScan::takeRequests(Vector<PreloadRequest>& requests)
+{
+    MutexLocker locker(m_lock);
+    requests.swap(m_requests);
+}
+
+void PreloadScanner::BackgroundScan::stop()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_stopped = true;
+        m_chunks.clear();
+        while (m_scanning)
+            m_scanFinished.wait(m_lock);
+    }
+    m_scanner = 0;
+}
     
-using namespace HTMLNames;
-    
-PreloadScanner::PreloadScanner(Document* doc)
+PreloadScanner::PreloadScanner(Document* doc, bool scanInBackground)
     : m_inProgress(false)
     , m_timeUsed(0)
     , m_bodySeen(false)
     , m_document(doc)
+    , m_scanInBackground(scanInBackground)
 {
 #if PRELOAD_DEBUG
     printf("CREATING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
@@ -54,6 +197,8 @@ PreloadScanner::PreloadScanner(Document* doc)
     
 PreloadScanner::~PreloadScanner()
 {
+    if (m_backgroundScan)
+        m_backgroundScan->stop();
 #if PRELOAD_DEBUG
     printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
     printf("TOTAL TIME USED %.4fs\n", m_timeUsed);
@@ -65,11 +210,20 @@ void PreloadScanner::begin()
     ASSERT(!m_inProgress); 
     reset(); 
     m_inProgress = true; 
+    if (m_scanInBackground)
+        m_backgroundScan = BackgroundScan::create(this);
 }
     
 void PreloadScanner::end() 
 { 
     ASSERT(m_inProgress); 
+    if (m_backgroundScan) {
+        m_backgroundScan->stop();
+        // What was found is still worth loading; the parser will want it
+        // soon.
+        issuePreloads();
+        m_backgroundScan = 0;
+    }
     m_inProgress = false; 
 }
 
@@ -86,26 +240,30 @@ void PreloadScanner::reset()
     m_tagName.clear();
     m_attributeName.clear();
     m_attributeValue.clear();
-    m_lastStartTag = AtomicString();
+    m_lastStartTag.clear();
+    m_lastStartTagIsStyle = false;
     
     m_urlToLoad = String();
     m_charset = String();
-    m_linkIsStyleSheet = false;
+    m_linkRelation = String();
     m_lastCharacterIndex = 0;
     clearLastCharacters();
     
     m_cssState = CSSInitial;
     m_cssRule.clear();
     m_cssRuleValue.clear();
-}
-    
-bool PreloadScanner::scanningBody() const
-{
-    return m_document->body() || m_bodySeen;
+    m_cssInFontFace = false;
+    m_cssFontFacePreloaded = false;
+
+    m_requests.clear();
 }
     
 void PreloadScanner::write(const SegmentedString& source)
 {
+    if (m_backgroundScan) {
+        m_backgroundScan->append(source);
+        return;
+    }
 #if PRELOAD_DEBUG
     double startTime = currentTime();
 #endif
@@ -113,6 +271,53 @@ void PreloadScanner::write(const SegmentedString& source)
 #if PRELOAD_DEBUG
     m_timeUsed += currentTime() - startTime;
 #endif
+    issuePreloads();
+}
+
+void PreloadScanner::addRequest(CachedResource::Type type, const String& url, const String& charset, const String& linkRelation)
+{
+    PreloadRequest request;
+    request.type = type;
+    request.url = url;
+    request.charset = charset;
+    request.linkRelation = linkRelation;
+    request.bodySeen = m_bodySeen;
+    m_requests.append(request);
+}
+
+static bool isStyleSheetRelation(const String& relation)
+{
+    bool styleSheet = false;
+    bool alternate = false;
+    bool icon = false;
+    bool dnsPrefetch = false;
+#ifdef ANDROID_APPLE_TOUCH_ICON
+    bool touchIcon = false;
+    bool precomposedTouchIcon = false;
+    HTMLLinkElement::tokenizeRelAttribute(relation, styleSheet, alternate, icon, touchIcon, precomposedTouchIcon, dnsPrefetch);
+    return styleSheet && !alternate && !icon && !touchIcon && !precomposedTouchIcon && !dnsPrefetch;
+#else
+    HTMLLinkElement::tokenizeRelAttribute(relation, styleSheet, alternate, icon, dnsPrefetch);
+    return styleSheet && !alternate && !icon && !dnsPrefetch;
+#endif
+}
+
+void PreloadScanner::issuePreloads()
+{
+    Vector<PreloadRequest> requests;
+    if (m_backgroundScan)
+        m_backgroundScan->takeRequests(requests);
+    else
+        requests.swap(m_requests);
+
+    bool scanningBody = m_document->body();
+    DocLoader* docLoader = m_document->docLoader();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const PreloadRequest& request = requests[i];
+        if (!request.linkRelation.isNull() && !isStyleSheetRelation(request.linkRelation))
+            continue;
+        docLoader->preload(request.type, request.url, request.charset, scanningBody || request.bodySeen);
+    }
 }
     
 static inline bool isWhitespace(UChar c)
@@ -354,18 +559,20 @@ void PreloadScanner::tokenize(const SegmentedString& source)
             break;
         case CloseTagOpen:
             if (m_contentModel == RCDATA || m_contentModel == CDATA) {
-                if (!m_lastStartTag.length()) {
+                if (m_lastStartTag.isEmpty()) {
                     m_state = Data;
                     continue;
                 }
-                if (m_source.length() < m_lastStartTag.length() + 1)
+                if (m_source.length() < m_lastStartTag.size() + 1)
                     return;
-                Vector<UChar> tmpString;
+                // Holds at most the length of the longest RCDATA/CDATA tag name plus one.
+                Vector<UChar, 32> tmpString;
+                PROFILE_VECTOR_SIZE(tmpString);
                 UChar tmpChar = 0;
                 bool match = true;
-                for (unsigned n = 0; n < m_lastStartTag.length() + 1; n++) {
+                for (unsigned n = 0; n < m_lastStartTag.size() + 1; n++) {
                     tmpChar = Unicode::toLower(*m_source);
-                    if (n < m_lastStartTag.length() && tmpChar != m_lastStartTag[n])
+                    if (n < m_lastStartTag.size() && tmpChar != m_lastStartTag[n])
                         match = false;
                     tmpString.append(tmpChar);
                     m_source.advance();
@@ -664,55 +871,94 @@ void PreloadScanner::tokenize(const SegmentedString& source)
     }
 }
     
+// Names are collected in lower case.
+static bool nameIs(const Vector<UChar, 32>& name, const char* lowercaseName)
+{
+    size_t i = 0;
+    for (; i < name.size(); ++i) {
+        if (!lowercaseName[i] || name[i] != static_cast<unsigned char>(lowercaseName[i]))
+            return false;
+    }
+    return !lowercaseName[i];
+}
+
+// Empty Strings are shared by the thread that makes them, so the tokenizer
+// keeps them out of the state that ends up on the main thread.
+static inline void setURLToLoad(String& urlToLoad, const String& value)
+{
+    String url = deprecatedParseURL(value);
+    if (!url.isEmpty())
+        urlToLoad = url;
+}
+
 void PreloadScanner::processAttribute()
 {
-    AtomicString tag = AtomicString(m_tagName.data(), m_tagName.size());
-    AtomicString attribute = AtomicString(m_attributeName.data(), m_attributeName.size());
-    
-    String value(m_attributeValue.data(), m_attributeValue.size());
-    if (tag == scriptTag || tag == imgTag) {
-        if (attribute == srcAttr && m_urlToLoad.isEmpty())
-            m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == charsetAttr)
+    String value;
+    if (!m_attributeValue.isEmpty())
+        value = String(m_attributeValue.data(), m_attributeValue.size());
+    if (nameIs(m_tagName, "script") || nameIs(m_tagName, "img")) {
+        if (nameIs(m_attributeName, "src") && m_urlToLoad.isEmpty())
+            setURLToLoad(m_urlToLoad, value);
+        else if (nameIs(m_attributeName, "charset"))
             m_charset = value;
-    } else if (tag == linkTag) {
-        if (attribute == hrefAttr && m_urlToLoad.isEmpty())
-            m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == relAttr) {
-            bool styleSheet = false;
-            bool alternate = false;
-            bool icon = false;
-            bool dnsPrefetch = false;
-#ifdef ANDROID_APPLE_TOUCH_ICON
-            bool touchIcon = false;
-            bool precomposedTouchIcon = false;
-            HTMLLinkElement::tokenizeRelAttribute(value, styleSheet, alternate, icon, touchIcon, precomposedTouchIcon, dnsPrefetch);
-            m_linkIsStyleSheet = styleSheet && !alternate && !icon && !touchIcon && !precomposedTouchIcon && !dnsPrefetch;
-#else
-            HTMLLinkElement::tokenizeRelAttribute(value, styleSheet, alternate, icon, dnsPrefetch);
-            m_linkIsStyleSheet = styleSheet && !alternate && !icon && !dnsPrefetch;
-#endif
-        } else if (attribute == charsetAttr)
+    } else if (nameIs(m_tagName, "link")) {
+        if (nameIs(m_attributeName, "href") && m_urlToLoad.isEmpty())
+            setURLToLoad(m_urlToLoad, value);
+        else if (nameIs(m_attributeName, "rel"))
+            m_linkRelation = value;
+        else if (nameIs(m_attributeName, "charset"))
             m_charset = value;
     }
 }
     
 inline void PreloadScanner::emitCharacter(UChar c)
 {
-    if (m_contentModel == CDATA && m_lastStartTag == styleTag) 
+    if (m_contentModel == CDATA && m_lastStartTagIsStyle) 
         tokenizeCSS(c);
 }
     
 inline void PreloadScanner::tokenizeCSS(UChar c)
 {    
-    // We are just interested in @import rules, no need for real tokenization here
-    // Searching for other types of resources is probably low payoff
+    // We are just interested in @import rules and url() values, no need for
+    // real tokenization here
     switch (m_cssState) {
     case CSSInitial:
         if (c == '@')
             m_cssState = CSSRuleStart;
         else if (c == '/')
             m_cssState = CSSMaybeComment;
+        else if (c == 'u' || c == 'U') {
+            m_cssRule.clear();
+            m_cssRule.append('u');
+            m_cssState = CSSMaybeURL;
+        } else if (c == '}')
+            m_cssInFontFace = false;
+        break;
+    case CSSMaybeURL:
+        if (m_cssRule.size() == 1 && (c == 'r' || c == 'R'))
+            m_cssRule.append('r');
+        else if (m_cssRule.size() == 2 && (c == 'l' || c == 'L'))
+            m_cssRule.append('l');
+        else if (m_cssRule.size() == 3 && c == '(') {
+            m_cssRule.clear();
+            m_cssRuleValue.clear();
+            m_cssState = CSSURL;
+        } else {
+            m_cssRule.clear();
+            m_cssState = CSSInitial;
+            tokenizeCSS(c);
+        }
+        break;
+    case CSSURL:
+        if (c == ')') {
+            emitCSSURL();
+            m_cssState = CSSInitial;
+        } else if (m_cssRuleValue.size() < maxCSSURLLength)
+            m_cssRuleValue.append(c);
+        else {
+            m_cssRuleValue.clear();
+            m_cssState = CSSInitial;
+        }
         break;
     case CSSMaybeComment:
         if (c == '*')
@@ -746,6 +992,8 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
             m_cssState = CSSAfterRule;
         else if (c == ';')
             m_cssState = CSSInitial;
+        else if (c == '{')
+            enterCSSBlock();
         else
             m_cssRule.append(c);
         break;
@@ -754,6 +1002,8 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
             ;
         else if (c == ';')
             m_cssState = CSSInitial;
+        else if (c == '{')
+            enterCSSBlock();
         else {
             m_cssState = CSSRuleValue;
             m_cssRuleValue.append(c);
@@ -765,7 +1015,9 @@ inline void PreloadScanner::tokenizeCSS(UChar c)
         else if (c == ';') {
             emitCSSRule();
             m_cssState = CSSInitial;
-        } else 
+        } else if (c == '{')
+            enterCSSBlock();
+        else
             m_cssRuleValue.append(c);
         break;
     case CSSAfterRuleValue:
@@ -787,45 +1039,57 @@ void PreloadScanner::emitTag()
     if (m_closeTag) {
         m_contentModel = PCDATA;
         m_cssState = CSSInitial;
+        m_cssInFontFace = false;
         clearLastCharacters();
         return;
     }
     
-    AtomicString tag(m_tagName.data(), m_tagName.size());
-    m_lastStartTag = tag;
+    m_lastStartTag = m_tagName;
+    m_lastStartTagIsStyle = nameIs(m_tagName, "style");
     
-    if (tag == textareaTag || tag == titleTag)
+    if (nameIs(m_tagName, "textarea") || nameIs(m_tagName, "title"))
         m_contentModel = RCDATA;
-    else if (tag == styleTag || tag == xmpTag || tag == scriptTag || tag == iframeTag || tag == noembedTag || tag == noframesTag)
+    else if (m_lastStartTagIsStyle || nameIs(m_tagName, "xmp") || nameIs(m_tagName, "script") || nameIs(m_tagName, "iframe") || nameIs(m_tagName, "noembed") || nameIs(m_tagName, "noframes"))
         m_contentModel = CDATA;
-    else if (tag == noscriptTag)
+    else if (nameIs(m_tagName, "noscript"))
         // we wouldn't be here if scripts were disabled
         m_contentModel = CDATA;
-    else if (tag == plaintextTag)
+    else if (nameIs(m_tagName, "plaintext"))
         m_contentModel = PLAINTEXT;
     else
         m_contentModel = PCDATA;
     
-    if (tag == bodyTag)
+    if (nameIs(m_tagName, "body"))
         m_bodySeen = true;
     
     if (m_urlToLoad.isEmpty()) {
-        m_linkIsStyleSheet = false;
+        m_linkRelation = String();
         return;
     }
     
-    if (tag == scriptTag)
-        m_document->docLoader()->preload(CachedResource::Script, m_urlToLoad, m_charset, scanningBody());
-    else if (tag == imgTag) 
-        m_document->docLoader()->preload(CachedResource::ImageResource, m_urlToLoad, String(), scanningBody());
-    else if (tag == linkTag && m_linkIsStyleSheet) 
-        m_document->docLoader()->preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset, scanningBody());
+    if (nameIs(m_tagName, "script"))
+        addRequest(CachedResource::Script, m_urlToLoad, m_charset);
+    else if (nameIs(m_tagName, "img")) 
+        addRequest(CachedResource::ImageResource, m_urlToLoad, String());
+    else if (nameIs(m_tagName, "link") && !m_linkRelation.isNull()) 
+        addRequest(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset, m_linkRelation);
 
     m_urlToLoad = String();
     m_charset = String();
-    m_linkIsStyleSheet = false;
+    m_linkRelation = String();
 }
     
+void PreloadScanner::enterCSSBlock()
+{
+    // The block of an @media rule holds ordinary rules, so only @font-face
+    // changes how its url() values are loaded.
+    m_cssInFontFace = equalIgnoringCase(String(m_cssRule.data(), m_cssRule.size()), "font-face");
+    m_cssFontFacePreloaded = false;
+    m_cssRule.clear();
+    m_cssRuleValue.clear();
+    m_cssState = CSSInitial;
+}
+
 void PreloadScanner::emitCSSRule()
 {
     String rule(m_cssRule.data(), m_cssRule.size());
@@ -833,10 +1097,25 @@ void PreloadScanner::emitCSSRule()
         String value(m_cssRuleValue.data(), m_cssRuleValue.size());
         String url = deprecatedParseURL(value);
         if (!url.isEmpty())
-            m_document->docLoader()->preload(CachedResource::CSSStyleSheet, url, String(), scanningBody());
+            addRequest(CachedResource::CSSStyleSheet, url, String());
     }
     m_cssRule.clear();
     m_cssRuleValue.clear();
 }
-                
+
+void PreloadScanner::emitCSSURL()
+{
+    String url = deprecatedParseURL(String(m_cssRuleValue.data(), m_cssRuleValue.size()));
+    m_cssRuleValue.clear();
+    if (url.isEmpty() || protocolIs(url, "data"))
+        return;
+
+    if (!m_cssInFontFace)
+        addRequest(CachedResource::ImageResource, url, String());
+    else if (!m_cssFontFacePreloaded) {
+        addRequest(CachedResource::FontResource, url, String());
+        m_cssFontFacePreloaded = true;
+    }
+}
+
 }
@@ -3,39 +3,59 @@
 #ifndef PreloadScanner_h
 #define PreloadScanner_h
 
-#include "AtomicString.h"
+#include "CachedResource.h"
+#include "PlatformString.h"
 #include "SegmentedString.h"
 #include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
     
-    class CachedResource;
-    class CachedResourceClient;
     class Document;
     
     class PreloadScanner : public Noncopyable {
     public:
-        PreloadScanner(Document*);
+        // A scanner that scans in the background tokenizes what it is written
+        // on the shared thread pool and issues the preloads it finds from the
+        // main thread as they turn up, rather than before write() returns.
+        PreloadScanner(Document*, bool scanInBackground = false);
         ~PreloadScanner();
         void begin();
         void write(const SegmentedString&);
         void end();
         bool inProgress() const { return m_inProgress; }
         
-        bool scanningBody() const;
-        
         static unsigned consumeEntity(SegmentedString&, bool& notEnoughCharacters);
         
     private:
+        class BackgroundScan;
+        friend class BackgroundScan;
+
+        struct PreloadRequest {
+            CachedResource::Type type;
+            String url;
+            String charset;
+            // The rel value of a link, which decides whether it is a style
+            // sheet. Link relations are matched as AtomicStrings, so that
+            // waits for the main thread.
+            String linkRelation;
+            bool bodySeen;
+        };
+
         void tokenize(const SegmentedString&);
         void reset();
+
+        void addRequest(CachedResource::Type, const String& url, const String& charset, const String& linkRelation = String());
+        void issuePreloads();
         
         void emitTag();
         void emitCharacter(UChar);
         
         void tokenizeCSS(UChar);
         void emitCSSRule();
+        void emitCSSURL();
+        void enterCSSBlock();
         
         void processAttribute();
 
@@ -89,11 +109,14 @@ namespace WebCore {
         Vector<UChar, 32> m_tagName;
         Vector<UChar, 32> m_attributeName;
         Vector<UChar> m_attributeValue;
-        AtomicString m_lastStartTag;
+        // Tag names are kept as characters rather than AtomicStrings, which
+        // can't be made off the main thread.
+        Vector<UChar, 32> m_lastStartTag;
+        bool m_lastStartTagIsStyle;
         
         String m_urlToLoad;
         String m_charset;
-        bool m_linkIsStyleSheet;
+        String m_linkRelation;
         
         enum CSSState {
             CSSInitial,
@@ -104,16 +127,30 @@ namespace WebCore {
             CSSRule,
             CSSAfterRule,
             CSSRuleValue,
-            CSSAfterRuleValue
+            CSSAfterRuleValue,
+            CSSMaybeURL,
+            CSSURL
         };
         CSSState m_cssState;
         Vector<UChar, 16> m_cssRule;
         Vector<UChar> m_cssRuleValue;
+        // url() values inside an @font-face rule are fonts rather than images.
+        // Only the first source of each rule is preloaded.
+        bool m_cssInFontFace;
+        bool m_cssFontFacePreloaded;
         
         double m_timeUsed;
         
         bool m_bodySeen;
         Document* m_document;
+
+        // Found by tokenize() and not issued yet
+        Vector<PreloadRequest> m_requests;
+
+        bool m_scanInBackground;
+        // Set from begin() to end() when scanning in the background. The
+        // tokenizer state above belongs to its thread until end() stops it.
+        RefPtr<BackgroundScan> m_backgroundScan;
     };
 
 }
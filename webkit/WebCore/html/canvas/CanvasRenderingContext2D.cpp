@@ -144,6 +144,11 @@ void CanvasRenderingContext2D::setStrokeStyle(PassRefPtr<CanvasStyle> style)
         }
     }
 
+    // Scripts often set the same color before every draw; parsing and
+    // applying it again would change nothing.
+    if (state().m_strokeStyle->isEquivalentColor(*style))
+        return;
+
     state().m_strokeStyle = style;
     GraphicsContext* c = drawingContext();
     if (!c)
@@ -168,6 +173,9 @@ void CanvasRenderingContext2D::setFillStyle(PassRefPtr<CanvasStyle> style)
         }
     }
 
+    if (state().m_fillStyle->isEquivalentColor(*style))
+        return;
+
     state().m_fillStyle = style;
     GraphicsContext* c = drawingContext();
     if (!c)
@@ -293,7 +301,7 @@ float CanvasRenderingContext2D::globalAlpha() const
 
 void CanvasRenderingContext2D::setGlobalAlpha(float alpha)
 {
-    if (!(alpha >= 0 && alpha <= 1))
+    if (!(alpha >= 0 && alpha <= 1) || alpha == state().m_globalAlpha)
         return;
     state().m_globalAlpha = alpha;
     GraphicsContext* c = drawingContext();
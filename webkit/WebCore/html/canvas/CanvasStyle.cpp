@@ -141,6 +141,31 @@ void CanvasStyle::applyStrokeColor(GraphicsContext* context)
     }
 }
 
+bool CanvasStyle::isEquivalentColor(const CanvasStyle& other) const
+{
+    if (m_type != other.m_type)
+        return false;
+    switch (m_type) {
+        case ColorString:
+            return m_color == other.m_color;
+        case ColorStringWithAlpha:
+            return m_color == other.m_color && m_alpha == other.m_alpha;
+        case GrayLevel:
+            return m_grayLevel == other.m_grayLevel && m_alpha == other.m_alpha;
+        case RGBA:
+            return m_red == other.m_red && m_green == other.m_green
+                && m_blue == other.m_blue && m_alpha == other.m_alpha;
+        case CMYKA:
+            return m_cyan == other.m_cyan && m_magenta == other.m_magenta
+                && m_yellow == other.m_yellow && m_black == other.m_black
+                && m_alpha == other.m_alpha;
+        case Gradient:
+        case ImagePattern:
+            return false;
+    }
+    return false;
+}
+
 void CanvasStyle::applyFillColor(GraphicsContext* context)
 {
     if (!context)
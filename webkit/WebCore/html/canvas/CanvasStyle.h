@@ -29,6 +29,10 @@ namespace WebCore {
         void applyFillColor(GraphicsContext*);
         void applyStrokeColor(GraphicsContext*);
 
+        // True if both are the same plain color, so that applying one after
+        // the other changes nothing. Gradients and patterns never are.
+        bool isEquivalentColor(const CanvasStyle&) const;
+
     private:
         CanvasStyle(const String& color);
         CanvasStyle(float grayLevel);
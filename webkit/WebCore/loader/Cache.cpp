@@ -8,14 +8,22 @@
 #include "CachedImage.h"
 #include "CachedScript.h"
 #include "CachedXSLStyleSheet.h"
+#include "DiskCache.h"
 #include "DocLoader.h"
 #include "Document.h"
+#include "Frame.h"
 #include "FrameLoader.h"
 #include "FrameLoaderTypes.h"
 #include "FrameView.h"
 #include "Image.h"
 #include "ResourceHandle.h"
+#include "ResourceRequest.h"
 #include "SecurityOrigin.h"
+#include "Settings.h"
+#include "SharedBuffer.h"
+#if PLATFORM(ANDROID)
+#include "BitmapAllocatorAndroid.h"
+#endif
 #include <stdio.h>
 #include <wtf/CurrentTime.h>
 
@@ -27,6 +35,12 @@ static const int cDefaultCacheCapacity = 8192 * 1024;
 static const double cMinDelayBeforeLiveDecodedPrune = 1; // Seconds.
 static const float cTargetPrunePercentage = .95f; // Percentage of capacity toward which we prune, to avoid immediately pruning again.
 static const double cDefaultDecodedDataDeletionInterval = 0;
+// Decoded data that takes longer than this, in nanoseconds a byte, to
+// rebuild only goes once cheaper decoded data has.
+static const unsigned cExpensiveDecodedDataCost = 10;
+// Reload costs, in microseconds, are counted in units of this for weighing
+// resources against their size.
+static const unsigned cReloadCostUnit = 10000;
 
 Cache* cache()
 {
@@ -93,6 +107,10 @@ CachedResource* Cache::requestResource(DocLoader* docLoader, CachedResource::Typ
         return 0;
     }
     
+#if ENABLE(DISK_CACHE)
+    ResourceResponse diskCacheResponse;
+    RefPtr<SharedBuffer> diskCacheData;
+#endif
     if (!resource) {
         // The resource does not exist. Create it.
         resource = createResource(type, url, charset);
@@ -102,6 +120,10 @@ CachedResource* Cache::requestResource(DocLoader* docLoader, CachedResource::Typ
         // FIXME: CachedResource should just use normal refcounting instead.
         resource->setInCache(true);
         
+#if ENABLE(DISK_CACHE)
+        diskCacheData = lookUpInDiskCache(docLoader, url, diskCacheResponse);
+        if (!diskCacheData)
+#endif
         resource->load(docLoader);
         
         if (resource->errorOccurred()) {
@@ -130,6 +152,12 @@ CachedResource* Cache::requestResource(DocLoader* docLoader, CachedResource::Typ
         resourceAccessed(resource);
     }
 
+#if ENABLE(DISK_CACHE)
+    // Only now that the resource is accounted for can its size change.
+    if (diskCacheData)
+        loadFromDiskCache(resource, diskCacheResponse, diskCacheData.release());
+#endif
+
     return resource;
 }
     
@@ -184,6 +212,65 @@ void Cache::revalidateResource(CachedResource* resource, DocLoader* docLoader)
     newResource->load(docLoader);
 }
     
+#if ENABLE(DISK_CACHE)
+static bool canUseDiskCache(DocLoader* docLoader, const KURL& url)
+{
+    if (!diskCache().isEnabled() || !url.protocolInHTTPFamily())
+        return false;
+    Frame* frame = docLoader->frame();
+    return frame && frame->settings() && !frame->settings()->privateBrowsingEnabled();
+}
+
+PassRefPtr<SharedBuffer> Cache::lookUpInDiskCache(DocLoader* docLoader, const KURL& url, ResourceResponse& response)
+{
+    if (!canUseDiskCache(docLoader, url))
+        return 0;
+    // A reload has to go to the network.
+    CachePolicy cachePolicy = docLoader->cachePolicy();
+    if (cachePolicy == CachePolicyReload || cachePolicy == CachePolicyRevalidate)
+        return 0;
+
+    // The headers the network request would carry, for entries that vary on
+    // them.
+    ResourceRequest request(url);
+    docLoader->frame()->loader()->addExtraFieldsToSubresourceRequest(request);
+    return diskCache().lookup(request, response);
+}
+
+void Cache::loadFromDiskCache(CachedResource* resource, const ResourceResponse& response, PassRefPtr<SharedBuffer> data)
+{
+    // As if the load had finished at once; the resource is then treated like
+    // one found in the memory cache.
+    resource->setResponse(response);
+    String encoding = response.textEncodingName();
+    if (!encoding.isNull())
+        resource->setEncoding(encoding);
+    resource->data(data, true);
+    resource->finish();
+    // Don't keep handing out an entry that can't be decoded.
+    if (resource->errorOccurred())
+        diskCache().remove(resource->url());
+}
+
+void Cache::didLoadResourceFromNetwork(DocLoader* docLoader, const ResourceRequest& request, CachedResource* resource)
+{
+    // Entries are looked up by the URL that was asked for, which a redirected
+    // response doesn't belong to.
+    if (!canUseDiskCache(docLoader, request.url()) || request.url().string() != resource->url())
+        return;
+    const ResourceResponse& response = resource->response();
+    double freshness = resource->freshnessLifetime() - resource->currentAge();
+    // Entries that would go stale before they're likely to be read again
+    // aren't worth the write.
+    static const double minimumFreshness = 60;
+    if (response.httpStatusCode() != 200 || response.cacheControlContainsNoStore() || freshness < minimumFreshness) {
+        diskCache().remove(request.url().string());
+        return;
+    }
+    diskCache().store(request, response, currentTime() + freshness, resource->data());
+}
+#endif
+
 void Cache::revalidationSucceeded(CachedResource* revalidatingResource, const ResourceResponse& response)
 {
     CachedResource* resource = revalidatingResource->resourceToRevalidate();
@@ -264,28 +351,45 @@ void Cache::pruneLiveResources()
     // elapsedTime will evaluate to false as the currentTime will be a lot
     // greater than the current->m_lastDecodedAccessTime.
     // For more details see: https://bugs.webkit.org/show_bug.cgi?id=30209
-    CachedResource* current = m_liveDecodedResources.m_tail;
-    while (current) {
-        CachedResource* prev = current->m_prevInLiveResourcesList;
-        ASSERT(current->hasClients());
-        if (current->isLoaded() && current->decodedSize()) {
-            // Check to see if the remaining resources are too new to prune.
-            double elapsedTime = currentTime - current->m_lastDecodedAccessTime;
-            if (elapsedTime < cMinDelayBeforeLiveDecodedPrune)
-                return;
-
-            // Destroy our decoded data. This will remove us from 
-            // m_liveDecodedResources, and possibly move us to a different LRU 
-            // list in m_allResources.
-            current->destroyDecodedData();
-
-            if (targetSize && m_liveSize <= targetSize)
-                return;
+    // The first pass leaves decoded data that is expensive to rebuild for its
+    // size, such as large photos, for the second.
+    for (int pass = 0; pass < 2; ++pass) {
+        bool includeExpensive = pass;
+        CachedResource* current = m_liveDecodedResources.m_tail;
+        while (current) {
+            CachedResource* prev = current->m_prevInLiveResourcesList;
+            ASSERT(current->hasClients());
+            if (current->isLoaded() && current->decodedSize()) {
+                // Check to see if the remaining resources are too new to prune.
+                double elapsedTime = currentTime - current->m_lastDecodedAccessTime;
+                if (elapsedTime < cMinDelayBeforeLiveDecodedPrune)
+                    break;
+
+                if (includeExpensive || static_cast<unsigned long long>(current->decodedDataCost()) * 1000 <= static_cast<unsigned long long>(current->decodedSize()) * cExpensiveDecodedDataCost) {
+                    // Destroy our decoded data. This will remove us from 
+                    // m_liveDecodedResources, and possibly move us to a different LRU 
+                    // list in m_allResources.
+                    current->destroyDecodedData();
+
+                    if (targetSize && m_liveSize <= targetSize)
+                        return;
+                }
+            }
+            current = prev;
         }
-        current = prev;
     }
 }
 
+unsigned Cache::pruneDeadResourcesForMemoryPressure()
+{
+    unsigned deadSize = m_deadSize;
+    unsigned maxDeadCapacity = m_maxDeadCapacity;
+    m_maxDeadCapacity = m_minDeadCapacity;
+    pruneDeadResources();
+    m_maxDeadCapacity = maxDeadCapacity;
+    return deadSize > m_deadSize ? deadSize - m_deadSize : 0;
+}
+
 void Cache::pruneDeadResources()
 {
     if (!m_pruneEnabled)
@@ -318,6 +422,28 @@ void Cache::pruneDeadResources()
     
     bool canShrinkLRULists = true;
     m_inPruneDeadResources = true;
+
+    // Stale resources take a round trip to revalidate before they can be used
+    // again, which is most of what reloading them would cost, so they go
+    // before any fresh ones.
+    for (int i = size - 1; i >= 0; i--) {
+        CachedResource* current = m_allResources[i].m_tail;
+        while (current) {
+            CachedResource* prev = current->m_prevInAllResourcesList;
+            if (!current->hasClients() && !current->isPreloaded() && !current->isCacheValidator() && current->isLoaded() && current->isExpired()) {
+                evict(current);
+                if (!m_inPruneDeadResources)
+                    return;
+
+                if (targetSize && m_deadSize <= targetSize) {
+                    m_inPruneDeadResources = false;
+                    return;
+                }
+            }
+            current = prev;
+        }
+    }
+
     for (int i = size - 1; i >= 0; i--) {
         // Remove from the tail, since this is the least frequently accessed of the objects.
         CachedResource* current = m_allResources[i].m_tail;
@@ -375,6 +501,11 @@ void Cache::setCapacities(unsigned minDeadBytes, unsigned maxDeadBytes, unsigned
     m_minDeadCapacity = minDeadBytes;
     m_maxDeadCapacity = maxDeadBytes;
     m_capacity = totalBytes;
+#if PLATFORM(ANDROID)
+    // Encoded image data counts against the cache capacity, but decoded
+    // pixels live in the image pool; give them half as much again.
+    BitmapAllocatorAndroid::setDecodedBudget(totalBytes / 2);
+#endif
     prune();
 }
 
@@ -432,11 +563,13 @@ static inline unsigned fastLog2(unsigned i)
 
 Cache::LRUList* Cache::lruListFor(CachedResource* resource)
 {
+    // Resources are bucketed by the bytes they hold per access and per unit
+    // of work it would take to get them back. Pruning starts from the last
+    // bucket, so big, rarely used resources that are cheap to reload go first.
     unsigned accessCount = max(resource->accessCount(), 1U);
-    unsigned queueIndex = fastLog2(resource->size() / accessCount);
-#ifndef NDEBUG
+    unsigned reloadCost = max(resource->reloadCost() / cReloadCostUnit, 1U);
+    unsigned queueIndex = fastLog2(resource->size() / accessCount / reloadCost);
     resource->m_lruIndex = queueIndex;
-#endif
     if (m_allResources.size() <= queueIndex)
         m_allResources.grow(queueIndex + 1);
     return &m_allResources[queueIndex];
@@ -448,16 +581,19 @@ void Cache::removeFromLRUList(CachedResource* resource)
     if (resource->accessCount() == 0)
         return;
 
-#if !ASSERT_DISABLED
-    unsigned oldListIndex = resource->m_lruIndex;
-#endif
+    CachedResource* next = resource->m_nextInAllResourcesList;
+    CachedResource* prev = resource->m_prevInAllResourcesList;
 
-    LRUList* list = lruListFor(resource);
+    // The resource's costs can change while it is in a list, so use the list
+    // it was put in rather than working it out again. Lists past the end of
+    // m_allResources were empty when they were trimmed.
+    unsigned listIndex = resource->m_lruIndex;
+    if (next == 0 && prev == 0 && (listIndex >= m_allResources.size() || m_allResources[listIndex].m_head != resource))
+        return;
 
-#if !ASSERT_DISABLED
-    // Verify that the list we got is the list we want.
-    ASSERT(resource->m_lruIndex == oldListIndex);
+    LRUList* list = &m_allResources[listIndex];
 
+#if !ASSERT_DISABLED
     // Verify that we are in fact in this list.
     bool found = false;
     for (CachedResource* current = list->m_head; current; current = current->m_nextInAllResourcesList) {
@@ -468,12 +604,6 @@ void Cache::removeFromLRUList(CachedResource* resource)
     }
     ASSERT(found);
 #endif
-
-    CachedResource* next = resource->m_nextInAllResourcesList;
-    CachedResource* prev = resource->m_prevInAllResourcesList;
-    
-    if (next == 0 && prev == 0 && list->m_head != resource)
-        return;
     
     resource->m_nextInAllResourcesList = 0;
     resource->m_prevInAllResourcesList = 0;
@@ -508,7 +638,6 @@ void Cache::insertInLRUList(CachedResource* resource)
         
 #ifndef NDEBUG
     // Verify that we are in now in the list like we should be.
-    list = lruListFor(resource);
     bool found = false;
     for (CachedResource* current = list->m_head; current; current = current->m_nextInAllResourcesList) {
         if (current == resource) {
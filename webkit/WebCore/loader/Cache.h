@@ -19,6 +19,9 @@ class CachedCSSStyleSheet;
 class CachedResource;
 class DocLoader;
 class KURL;
+class ResourceRequest;
+class ResourceResponse;
+class SharedBuffer;
 
 // This cache holds subresources used by Web pages: images, scripts, stylesheets, etc.
 
@@ -81,6 +84,12 @@ public:
     void revalidateResource(CachedResource*, DocLoader*);
     void revalidationSucceeded(CachedResource* revalidatingResource, const ResourceResponse&);
     void revalidationFailed(CachedResource* revalidatingResource);
+
+#if ENABLE(DISK_CACHE)
+    // Called when resource has been loaded from the network for request, to
+    // keep it in the disk cache if it may be reused.
+    void didLoadResourceFromNetwork(DocLoader*, const ResourceRequest&, CachedResource*);
+#endif
     
     // Sets the cache's memory capacities, in bytes. These will hold only approximately, 
     // since the decoded cost of resources like scripts and stylesheets is not known.
@@ -104,6 +113,11 @@ public:
         pruneLiveResources();
     }
 
+    // Prunes dead resources down to the minimum dead capacity, which is what
+    // they may use when the cache is under pressure. Returns the number of
+    // bytes freed.
+    unsigned pruneDeadResourcesForMemoryPressure();
+
     void setDeadDecodedDataDeletionInterval(double interval) { m_deadDecodedDataDeletionInterval = interval; }
     double deadDecodedDataDeletionInterval() const { return m_deadDecodedDataDeletionInterval; }
 
@@ -156,6 +170,13 @@ private:
 
     void evict(CachedResource*);
 
+#if ENABLE(DISK_CACHE)
+    // A new resource found in the disk cache is filled from it instead of
+    // being loaded.
+    PassRefPtr<SharedBuffer> lookUpInDiskCache(DocLoader*, const KURL&, ResourceResponse&);
+    void loadFromDiskCache(CachedResource*, const ResourceResponse&, PassRefPtr<SharedBuffer>);
+#endif
+
     // Member variables.
     HashSet<DocLoader*> m_docLoaders;
     Loader m_loader;
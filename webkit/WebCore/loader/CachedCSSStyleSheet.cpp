@@ -3,8 +3,10 @@
 #include "config.h"
 #include "CachedCSSStyleSheet.h"
 
+#include "CSSStyleSheet.h"
 #include "CachedResourceClient.h"
 #include "CachedResourceClientWalker.h"
+#include "Document.h"
 #include "HTTPParsers.h"
 #include "TextResourceDecoder.h"
 #include "loader.h"
@@ -15,6 +17,10 @@ namespace WebCore {
 CachedCSSStyleSheet::CachedCSSStyleSheet(const String& url, const String& charset)
     : CachedResource(url, CSSStyleSheet)
     , m_decoder(TextResourceDecoder::create("text/css", charset))
+    , m_parsedSheetStrict(false)
+    , m_parsedSheetForHTMLDocument(false)
+    , m_parsedSheetTextLength(0)
+    , m_parsedSheetUnshareable(false)
 {
     // Prefer text/css but accept any type (dell.com serves a stylesheet
     // as text/html; see <http://bugs.webkit.org/show_bug.cgi?id=11451>).
@@ -70,6 +76,8 @@ void CachedCSSStyleSheet::data(PassRefPtr<SharedBuffer> data, bool allDataReceiv
 
     m_data = data;
     setEncodedSize(m_data.get() ? m_data->size() : 0);
+    destroyDecodedData();
+    m_parsedSheetUnshareable = false;
     // Decode the data to find out the encoding and keep the sheet text around during checkNotify()
     if (m_data) {
         m_decodedSheetText = m_decoder->decode(m_data->data(), m_data->size());
@@ -98,6 +106,62 @@ void CachedCSSStyleSheet::error()
     checkNotify();
 }
 
+// The parser lowercases attr() names for HTML documents, as it does for the
+// document of the sheet at the root of the import chain.
+static bool isForHTMLDocument(WebCore::CSSStyleSheet* sheet)
+{
+    StyleBase* root = sheet;
+    while (root->parent())
+        root = root->parent();
+    if (!root->isCSSStyleSheet())
+        return false;
+    Document* document = static_cast<WebCore::CSSStyleSheet*>(root)->doc();
+    return document && document->isHTMLDocument();
+}
+
+bool CachedCSSStyleSheet::canShareParsedSheet(WebCore::CSSStyleSheet* sheet, bool strict) const
+{
+    // URLs are completed while parsing, with the sheet's charset.
+    return m_parsedSheet && m_parsedSheetStrict == strict && m_parsedSheetForHTMLDocument == isForHTMLDocument(sheet)
+        && m_parsedSheetCharset == sheet->charset() && sheet->finalURL() == m_response.url();
+}
+
+void CachedCSSStyleSheet::parseSheet(WebCore::CSSStyleSheet* sheet, const String& sheetText, bool strict)
+{
+    if (!sheetText.isEmpty() && canShareParsedSheet(sheet, strict) && sheet->copyRules(m_parsedSheet.get()))
+        return;
+
+    sheet->parseString(sheetText, strict);
+    if (sheetText.isEmpty() || m_parsedSheet || m_parsedSheetUnshareable || sheet->finalURL() != m_response.url())
+        return;
+
+    RefPtr<WebCore::CSSStyleSheet> parsedSheet = WebCore::CSSStyleSheet::create();
+    if (!parsedSheet->copyRules(sheet)) {
+        m_parsedSheetUnshareable = true;
+        return;
+    }
+    m_parsedSheet = parsedSheet.release();
+    m_parsedSheetStrict = strict;
+    m_parsedSheetForHTMLDocument = isForHTMLDocument(sheet);
+    m_parsedSheetCharset = sheet->charset();
+    m_parsedSheetTextLength = sheetText.length();
+    // The rules take a few times the space of the text they came from.
+    setDecodedSize(m_parsedSheetTextLength * sizeof(UChar) * 3);
+}
+
+void CachedCSSStyleSheet::destroyDecodedData()
+{
+    m_parsedSheet = 0;
+    m_parsedSheetTextLength = 0;
+    setDecodedSize(0);
+}
+
+unsigned CachedCSSStyleSheet::decodedDataCost() const
+{
+    // Parsing takes a few tens of nanoseconds a character.
+    return m_parsedSheet ? m_parsedSheetTextLength * 40 / 1000 : 0;
+}
+
 bool CachedCSSStyleSheet::canUseSheet(bool enforceMIMEType, bool* hasValidMIMEType) const
 {
     if (errorOccurred())
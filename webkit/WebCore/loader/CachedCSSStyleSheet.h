@@ -9,6 +9,7 @@
 
 namespace WebCore {
 
+    class CSSStyleSheet;
     class DocLoader;
     class TextResourceDecoder;
 
@@ -19,6 +20,12 @@ namespace WebCore {
 
         const String sheetText(bool enforceMIMEType = true, bool* hasValidMIMEType = 0) const;
 
+        // Fills sheet with the rules of sheetText, the text this returned
+        // from sheetText(). The first sheet parsed is kept as decoded data,
+        // and later sheets in the same mode are given copies of its rules
+        // instead of parsing the text again.
+        void parseSheet(WebCore::CSSStyleSheet*, const String& sheetText, bool strict);
+
         virtual void didAddClient(CachedResourceClient*);
         
         virtual void allClientsRemoved();
@@ -28,16 +35,29 @@ namespace WebCore {
         virtual void data(PassRefPtr<SharedBuffer> data, bool allDataReceived);
         virtual void error();
 
+        virtual void destroyDecodedData();
+        virtual unsigned decodedDataCost() const;
+
         virtual bool schedule() const { return true; }
 
         void checkNotify();
     
     private:
         bool canUseSheet(bool enforceMIMEType, bool* hasValidMIMEType) const;
+        bool canShareParsedSheet(WebCore::CSSStyleSheet*, bool strict) const;
 
     protected:
         RefPtr<TextResourceDecoder> m_decoder;
         String m_decodedSheetText;
+
+        RefPtr<WebCore::CSSStyleSheet> m_parsedSheet;
+        // What the sheets parsed from the text depend on besides the text
+        bool m_parsedSheetStrict;
+        bool m_parsedSheetForHTMLDocument;
+        String m_parsedSheetCharset;
+        unsigned m_parsedSheetTextLength;
+        // Set once a sheet turns out to have rules that can't be copied
+        bool m_parsedSheetUnshareable;
     };
 
 }
@@ -321,6 +321,22 @@ void CachedImage::destroyDecodedData()
         m_image->destroyDecodedData();
 }
 
+unsigned CachedImage::decodedDataCost() const
+{
+    // Roughly what Skia takes to decode a pixel of each format on our
+    // devices; photos are the most expensive for their size.
+    const String& mimeType = m_response.mimeType();
+    unsigned nanosecondsPerPixel;
+    if (equalIgnoringCase(mimeType, "image/jpeg") || equalIgnoringCase(mimeType, "image/jpg"))
+        nanosecondsPerPixel = 60;
+    else if (equalIgnoringCase(mimeType, "image/png"))
+        nanosecondsPerPixel = 30;
+    else
+        nanosecondsPerPixel = 20;
+    // decoded frames are 32 bits per pixel
+    return decodedSize() / 4 * nanosecondsPerPixel / 1000;
+}
+
 void CachedImage::decodedSizeChanged(const Image* image, int delta)
 {
     if (image != m_image)
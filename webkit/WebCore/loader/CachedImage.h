@@ -44,6 +44,7 @@ public:
     
     virtual void allClientsRemoved();
     virtual void destroyDecodedData();
+    virtual unsigned decodedDataCost() const;
 
     virtual void data(PassRefPtr<SharedBuffer> data, bool allDataReceived);
     virtual void error();
@@ -61,8 +61,8 @@ CachedResource::CachedResource(const String& url, Type type)
 
 #ifndef NDEBUG
     m_deleted = false;
-    m_lruIndex = 0;
 #endif
+    m_lruIndex = 0;
     m_errorOccurred = false;
 }
 
@@ -136,6 +136,16 @@ double CachedResource::freshnessLifetime() const
     return 0;
 }
 
+// A round trip on a mobile network, and the time to transfer each kilobyte
+// at a typical 3G rate.
+static const unsigned cFetchLatencyCost = 100000;
+static const unsigned cFetchCostPerKilobyte = 1000;
+
+unsigned CachedResource::reloadCost() const
+{
+    return cFetchLatencyCost + encodedSize() / 1024 * cFetchCostPerKilobyte + decodedDataCost();
+}
+
 void CachedResource::setResponse(const ResourceResponse& response)
 {
     m_response = response;
@@ -93,6 +93,12 @@ public:
     unsigned encodedSize() const { return m_encodedSize; }
     unsigned decodedSize() const { return m_decodedSize; }
     unsigned overheadSize() const;
+
+    // Rough costs, in microseconds, of rebuilding the decoded data once it is
+    // destroyed, and of getting the whole resource back once it is evicted.
+    // The cache weighs these against the memory they would free.
+    virtual unsigned decodedDataCost() const { return 0; }
+    unsigned reloadCost() const;
     
     bool isLoaded() const { return !m_loading; }
     void setLoading(bool b) { m_loading = b; }
@@ -214,8 +220,9 @@ protected:
     bool m_loading;
 #ifndef NDEBUG
     bool m_deleted;
-    unsigned m_lruIndex;
 #endif
+    // the list in Cache::m_allResources this resource was last put in
+    unsigned m_lruIndex;
 
 private:
     CachedResource* m_nextInAllResourcesList;
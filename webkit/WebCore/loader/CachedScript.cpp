@@ -96,6 +96,12 @@ void CachedScript::destroyDecodedData()
         makePurgeable(true);
 }
 
+unsigned CachedScript::decodedDataCost() const
+{
+    // Decoding text takes a few nanoseconds a character.
+    return m_script.length() * 4 / 1000;
+}
+
 void CachedScript::decodedDataDeletionTimerFired(Timer<CachedScript>*)
 {
     destroyDecodedData();
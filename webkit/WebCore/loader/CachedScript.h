@@ -31,6 +31,7 @@ namespace WebCore {
         void checkNotify();
 
         virtual void destroyDecodedData();
+        virtual unsigned decodedDataCost() const;
 
     private:
         void decodedDataDeletionTimerFired(Timer<CachedScript>*);
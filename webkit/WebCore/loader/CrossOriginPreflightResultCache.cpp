@@ -5,15 +5,19 @@
 
 #include "CrossOriginAccessControl.h"
 #include "ResourceResponse.h"
+#include "SQLiteFileSystem.h"
+#include "SQLiteStatement.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
 // These values are at the discretion of the user agent.
 static const unsigned defaultPreflightCacheTimeoutSeconds = 5;
 static const unsigned maxPreflightCacheTimeoutSeconds = 600; // Should be short enough to minimize the risk of using a poisoned cache after switching to a secure network.
+static const char* databaseName = "CrossOriginPreflightResults.db";
 
 static bool parseAccessControlMaxAge(const String& string, unsigned& expiryDelta)
 {
@@ -63,6 +67,37 @@ static bool parseAccessControlAllowList(const String& string, HashSet<String, Ha
     return true;
 }
 
+CrossOriginPreflightResultCacheItem::CrossOriginPreflightResultCacheItem(bool credentials, double absoluteExpiryTime, const String& methods, const String& headers)
+    : m_absoluteExpiryTime(absoluteExpiryTime)
+    , m_credentials(credentials)
+{
+    parseAccessControlAllowList(methods, m_methods);
+    parseAccessControlAllowList(headers, m_headers);
+}
+
+template<class HashType>
+static String joinAccessControlAllowList(const HashSet<String, HashType>& set)
+{
+    Vector<UChar> result;
+    typename HashSet<String, HashType>::const_iterator end = set.end();
+    for (typename HashSet<String, HashType>::const_iterator it = set.begin(); it != end; ++it) {
+        if (!result.isEmpty())
+            result.append(',');
+        result.append(it->characters(), it->length());
+    }
+    return String::adopt(result);
+}
+
+String CrossOriginPreflightResultCacheItem::methods() const
+{
+    return joinAccessControlAllowList(m_methods);
+}
+
+String CrossOriginPreflightResultCacheItem::headers() const
+{
+    return joinAccessControlAllowList(m_headers);
+}
+
 bool CrossOriginPreflightResultCacheItem::parse(const ResourceResponse& response)
 {
     m_methods.clear();
@@ -122,12 +157,19 @@ CrossOriginPreflightResultCache& CrossOriginPreflightResultCache::shared()
 void CrossOriginPreflightResultCache::appendEntry(const String& origin, const KURL& url, CrossOriginPreflightResultCacheItem* preflightResult)
 {
     ASSERT(isMainThread());
-    m_preflightHashMap.set(std::make_pair(origin, url), preflightResult);
+    loadFromDatabase();
+    std::pair<CrossOriginPreflightResultHashMap::iterator, bool> addResult = m_preflightHashMap.add(std::make_pair(origin, url), preflightResult);
+    if (!addResult.second) {
+        delete addResult.first->second;
+        addResult.first->second = preflightResult;
+    }
+    storeInDatabase(origin, url, preflightResult);
 }
 
 bool CrossOriginPreflightResultCache::canSkipPreflight(const String& origin, const KURL& url, bool includeCredentials, const String& method, const HTTPHeaderMap& requestHeaders)
 {
     ASSERT(isMainThread());
+    loadFromDatabase();
     CrossOriginPreflightResultHashMap::iterator cacheIt = m_preflightHashMap.find(std::make_pair(origin, url));
     if (cacheIt == m_preflightHashMap.end())
         return false;
@@ -137,6 +179,7 @@ bool CrossOriginPreflightResultCache::canSkipPreflight(const String& origin, con
 
     delete cacheIt->second;
     m_preflightHashMap.remove(cacheIt);
+    removeFromDatabase(origin, url);
     return false;
 }
 
@@ -145,6 +188,101 @@ void CrossOriginPreflightResultCache::empty()
     ASSERT(isMainThread());
     deleteAllValues(m_preflightHashMap);
     m_preflightHashMap.clear();
+    if (openDatabase())
+        m_database.executeCommand("DELETE FROM PreflightResults");
+}
+
+void CrossOriginPreflightResultCache::setDatabasePath(const String& databasePath)
+{
+    ASSERT(isMainThread());
+    // Take the first non-empty value.
+    if (!m_databaseFile.isEmpty() || databasePath.isEmpty())
+        return;
+    m_databaseFile = SQLiteFileSystem::appendDatabaseFileNameToPath(databasePath, databaseName);
+}
+
+bool CrossOriginPreflightResultCache::openDatabase()
+{
+    if (m_database.isOpen())
+        return true;
+    if (m_databaseFile.isEmpty() || !m_database.open(m_databaseFile))
+        return false;
+
+    // Create the table here, such that even if we've just created the DB,
+    // the commands below should succeed.
+    if (!m_database.executeCommand("CREATE TABLE IF NOT EXISTS PreflightResults ("
+            "origin TEXT NOT NULL, "
+            "url TEXT NOT NULL, "
+            "credentials INTEGER NOT NULL, "
+            "expiryTime REAL NOT NULL, "
+            "methods TEXT, "
+            "headers TEXT, "
+            "UNIQUE (origin, url) ON CONFLICT REPLACE)")) {
+        m_database.close();
+        return false;
+    }
+    return true;
+}
+
+void CrossOriginPreflightResultCache::loadFromDatabase()
+{
+    // Nothing is loaded until a path is set, and only once after that.
+    if (m_databaseLoaded || m_databaseFile.isEmpty())
+        return;
+    m_databaseLoaded = true;
+
+    if (!openDatabase())
+        return;
+
+    double now = currentTime();
+    SQLiteStatement deleteStatement(m_database, "DELETE FROM PreflightResults WHERE expiryTime < ?");
+    if (deleteStatement.prepare() == SQLResultOk) {
+        deleteStatement.bindDouble(1, now);
+        deleteStatement.executeCommand();
+    }
+
+    SQLiteStatement statement(m_database, "SELECT origin, url, credentials, expiryTime, methods, headers FROM PreflightResults");
+    if (statement.prepare() != SQLResultOk)
+        return;
+
+    while (statement.step() == SQLResultRow) {
+        std::pair<String, KURL> key(statement.getColumnText(0), KURL(ParsedURLString, statement.getColumnText(1)));
+        // Results of this process are newer than the stored ones.
+        if (m_preflightHashMap.contains(key))
+            continue;
+        m_preflightHashMap.set(key, new CrossOriginPreflightResultCacheItem(statement.getColumnInt(2),
+            statement.getColumnDouble(3), statement.getColumnText(4), statement.getColumnText(5)));
+    }
+}
+
+void CrossOriginPreflightResultCache::storeInDatabase(const String& origin, const KURL& url, const CrossOriginPreflightResultCacheItem* preflightResult)
+{
+    if (!openDatabase())
+        return;
+
+    SQLiteStatement statement(m_database, "INSERT INTO PreflightResults (origin, url, credentials, expiryTime, methods, headers) VALUES (?, ?, ?, ?, ?, ?)");
+    if (statement.prepare() != SQLResultOk)
+        return;
+    statement.bindText(1, origin);
+    statement.bindText(2, url.string());
+    statement.bindInt64(3, preflightResult->credentials());
+    statement.bindDouble(4, preflightResult->absoluteExpiryTime());
+    statement.bindText(5, preflightResult->methods());
+    statement.bindText(6, preflightResult->headers());
+    statement.executeCommand();
+}
+
+void CrossOriginPreflightResultCache::removeFromDatabase(const String& origin, const KURL& url)
+{
+    if (!openDatabase())
+        return;
+
+    SQLiteStatement statement(m_database, "DELETE FROM PreflightResults WHERE origin = ? AND url = ?");
+    if (statement.prepare() != SQLResultOk)
+        return;
+    statement.bindText(1, origin);
+    statement.bindText(2, url.string());
+    statement.executeCommand();
 }
 
 } // namespace WebCore
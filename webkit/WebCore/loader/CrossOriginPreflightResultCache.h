@@ -1,6 +1,7 @@
 
 
 #include "KURLHash.h"
+#include "SQLiteDatabase.h"
 #include "StringHash.h"
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
@@ -17,12 +18,20 @@ namespace WebCore {
             , m_credentials(credentials)
         {
         }
+        // Recreates a result stored by CrossOriginPreflightResultCache. The
+        // methods and headers are comma separated lists.
+        CrossOriginPreflightResultCacheItem(bool credentials, double absoluteExpiryTime, const String& methods, const String& headers);
 
         bool parse(const ResourceResponse&);
         bool allowsCrossOriginMethod(const String&) const;
         bool allowsCrossOriginHeaders(const HTTPHeaderMap&) const;
         bool allowsRequest(bool includeCredentials, const String& method, const HTTPHeaderMap& requestHeaders) const;
 
+        bool credentials() const { return m_credentials; }
+        double absoluteExpiryTime() const { return m_absoluteExpiryTime; }
+        String methods() const;
+        String headers() const;
+
     private:
         typedef HashSet<String, CaseFoldingHash> HeadersSet;
 
@@ -44,12 +53,26 @@ namespace WebCore {
 
         void empty();
 
+        // Once a path is set, results are also kept in a database there, so
+        // that they outlive the process for as long as their Max-Age allows.
+        // The database is read when the cache is first used.
+        void setDatabasePath(const String&);
+
     private:
-        CrossOriginPreflightResultCache() { }
+        CrossOriginPreflightResultCache() : m_databaseLoaded(false) { }
+
+        bool openDatabase();
+        void loadFromDatabase();
+        void storeInDatabase(const String& origin, const KURL&, const CrossOriginPreflightResultCacheItem*);
+        void removeFromDatabase(const String& origin, const KURL&);
 
         typedef HashMap<std::pair<String, KURL>, CrossOriginPreflightResultCacheItem*> CrossOriginPreflightResultHashMap;
 
         CrossOriginPreflightResultHashMap m_preflightHashMap;
+
+        String m_databaseFile;
+        SQLiteDatabase m_database;
+        bool m_databaseLoaded;
     };
 
 } // namespace WebCore
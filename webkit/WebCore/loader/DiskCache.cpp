@@ -0,0 +1,438 @@
+#include "config.h"
+#include "DiskCache.h"
+
+#if ENABLE(DISK_CACHE)
+
+#include "FileSystem.h"
+#include "HTTPHeaderMap.h"
+#include "ResourceRequest.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <limits>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/ThreadPool.h>
+
+namespace WebCore {
+
+// Each file starts with cEntryMagic and cEntryVersion, followed by the
+// expiration time, the body's offset and length, the URL, the Vary key,
+// the response and then the body. Numbers are 32 bit, host order; strings
+// are a byte length followed by UTF-8.
+static const uint32_t cEntryMagic = 0x43444b57; // "WKDC"
+static const uint32_t cEntryVersion = 1;
+static const unsigned long long cDefaultMaximumSize = 16 * 1024 * 1024;
+// No entry may take more than this fraction of the cache, so that one large
+// resource can't flush everything else.
+static const unsigned cMaximumEntryFraction = 8;
+// Bodies shorter than this are copied out of the mapping instead of keeping
+// it, as a mapping costs at least a page and a kernel VMA.
+static const unsigned cMinimumMappedBodySize = 16 * 1024;
+
+static void appendNumber(Vector<char>& record, uint32_t value)
+{
+    record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendString(Vector<char>& record, const String& string)
+{
+    CString utf8 = string.utf8();
+    appendNumber(record, utf8.length());
+    record.append(utf8.data(), utf8.length());
+}
+
+// Reads an entry out of its mapping, checking every length against the end
+// of the file so that a truncated or corrupt entry reads as a miss.
+class EntryReader {
+public:
+    EntryReader(const char* data, size_t length)
+        : m_position(data)
+        , m_end(data + length)
+    {
+    }
+
+    bool readNumber(uint32_t& value)
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(value))
+            return false;
+        memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool readDouble(double& value)
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(value))
+            return false;
+        memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool readString(String& string)
+    {
+        uint32_t length;
+        if (!readNumber(length) || length > static_cast<size_t>(m_end - m_position))
+            return false;
+        string = String::fromUTF8(m_position, length);
+        m_position += length;
+        return true;
+    }
+
+private:
+    const char* m_position;
+    const char* m_end;
+};
+
+// HashMap reserves 0 and -1; StringImpl hashes are never 0.
+static unsigned entryKey(const String& url)
+{
+    unsigned hash = url.impl()->hash();
+    return hash == std::numeric_limits<unsigned>::max() ? hash - 1 : hash;
+}
+
+// The names and request values of the headers the response varies on, so
+// that an entry is only used for requests that would have got the same
+// response.
+static String varyKey(const ResourceRequest& request, const ResourceResponse& response)
+{
+    String vary = response.httpHeaderField("Vary");
+    if (vary.isEmpty())
+        return "";
+    Vector<String> names;
+    vary.split(',', names);
+    String key;
+    for (size_t i = 0; i < names.size(); ++i) {
+        String name = names[i].stripWhiteSpace().lower();
+        key += name;
+        key += ":";
+        key += request.httpHeaderField(name);
+        key += "\n";
+    }
+    return key;
+}
+
+DiskCache& diskCache()
+{
+    DEFINE_STATIC_LOCAL(DiskCache, cache, ());
+    return cache;
+}
+
+DiskCache::DiskCache()
+    : m_maximumSize(cDefaultMaximumSize)
+    , m_size(0)
+    , m_operationsScheduled(false)
+{
+}
+
+void DiskCache::setCacheDirectory(const String& path)
+{
+    ASSERT(isMainThread());
+    if (!m_cacheDirectory.isNull() || path.isEmpty())
+        return;
+    if (!makeAllDirectories(path))
+        return;
+    m_cacheDirectory = path;
+    m_cacheDirectoryPath = path.utf8();
+
+    // Rebuild the index from the files left by earlier runs. Their
+    // modification times stand in for the last access time, so eviction is
+    // only roughly least recently used across restarts.
+    Vector<String> files = listDirectory(path, "*");
+    for (size_t i = 0; i < files.size(); ++i) {
+        String name = pathGetFileName(files[i]);
+        bool ok = name.length() == 8;
+        unsigned key = ok ? name.toUIntStrict(&ok, 16) : 0;
+        long long size;
+        time_t modificationTime;
+        // anything else is a write that was cut off, or not ours
+        if (!ok || !key || key == std::numeric_limits<unsigned>::max() || !getFileSize(files[i], size) || !getFileModificationTime(files[i], modificationTime)) {
+            deleteFile(files[i]);
+            continue;
+        }
+        Entry entry;
+        entry.size = size;
+        entry.lastAccessTime = modificationTime;
+        m_entries.set(key, entry);
+        m_size += size;
+    }
+    evictEntries(m_maximumSize);
+}
+
+void DiskCache::setMaximumSize(unsigned long long size)
+{
+    ASSERT(isMainThread());
+    m_maximumSize = size;
+    evictEntries(m_maximumSize);
+}
+
+PassRefPtr<SharedBuffer> DiskCache::lookup(const ResourceRequest& request, ResourceResponse& response)
+{
+    ASSERT(isMainThread());
+    if (!isEnabled())
+        return 0;
+
+    String url = request.url().string();
+    unsigned key = entryKey(url);
+    EntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return 0;
+
+    char path[PATH_MAX];
+    filePath(key, path, sizeof(path));
+    // The file isn't there yet if its write is still queued.
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat status;
+    void* region = MAP_FAILED;
+    if (!fstat(fd, &status) && status.st_size > 0)
+        region = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED)
+        return 0;
+    size_t regionLength = status.st_size;
+
+    EntryReader reader(static_cast<const char*>(region), regionLength);
+    uint32_t magic, version, bodyOffset, bodyLength, statusCode, headerCount;
+    double expirationTime;
+    String entryURL, entryVaryKey, statusText, mimeType, encoding;
+    bool ok = reader.readNumber(magic) && magic == cEntryMagic
+        && reader.readNumber(version) && version == cEntryVersion
+        && reader.readDouble(expirationTime)
+        && reader.readNumber(bodyOffset) && reader.readNumber(bodyLength)
+        && bodyOffset <= regionLength && bodyLength <= regionLength - bodyOffset
+        && reader.readString(entryURL);
+
+    // Another URL with the same hash owns the file; leave it alone.
+    if (ok && entryURL != url) {
+        munmap(region, regionLength);
+        return 0;
+    }
+    if (!ok || expirationTime <= currentTime()) {
+        munmap(region, regionLength);
+        removeEntry(key);
+        return 0;
+    }
+
+    ok = reader.readString(entryVaryKey)
+        && reader.readNumber(statusCode)
+        && reader.readString(statusText)
+        && reader.readString(mimeType)
+        && reader.readString(encoding)
+        && reader.readNumber(headerCount);
+    ResourceResponse entryResponse(request.url(), mimeType, bodyLength, encoding, String());
+    entryResponse.setHTTPStatusCode(statusCode);
+    entryResponse.setHTTPStatusText(statusText);
+    for (uint32_t i = 0; ok && i < headerCount; ++i) {
+        String name, value;
+        ok = reader.readString(name) && reader.readString(value);
+        if (ok)
+            entryResponse.setHTTPHeaderField(name, value);
+    }
+    if (!ok) {
+        munmap(region, regionLength);
+        removeEntry(key);
+        return 0;
+    }
+    if (varyKey(request, entryResponse) != entryVaryKey) {
+        munmap(region, regionLength);
+        return 0;
+    }
+
+    it->second.lastAccessTime = currentTime();
+    response = entryResponse;
+    if (bodyLength < cMinimumMappedBodySize) {
+        RefPtr<SharedBuffer> body = SharedBuffer::create(static_cast<const char*>(region) + bodyOffset, bodyLength);
+        munmap(region, regionLength);
+        return body.release();
+    }
+    return SharedBuffer::adoptMappedRegion(region, regionLength, bodyOffset, bodyLength);
+}
+
+void DiskCache::store(const ResourceRequest& request, const ResourceResponse& response, double expirationTime, SharedBuffer* data)
+{
+    ASSERT(isMainThread());
+    if (!isEnabled() || !data)
+        return;
+
+    String url = request.url().string();
+    if (response.httpHeaderField("Vary").stripWhiteSpace() == "*") {
+        remove(url);
+        return;
+    }
+
+    Operation* operation = new Operation;
+    operation->key = entryKey(url);
+    Vector<char>& record = operation->contents;
+    appendNumber(record, cEntryMagic);
+    appendNumber(record, cEntryVersion);
+    record.append(reinterpret_cast<const char*>(&expirationTime), sizeof(expirationTime));
+    // the body's offset and length are filled in below
+    size_t bodyOffsetPosition = record.size();
+    appendNumber(record, 0);
+    appendNumber(record, 0);
+    appendString(record, url);
+    appendString(record, varyKey(request, response));
+    appendNumber(record, response.httpStatusCode());
+    appendString(record, response.httpStatusText());
+    appendString(record, response.mimeType());
+    appendString(record, response.textEncodingName());
+    const HTTPHeaderMap& headers = response.httpHeaderFields();
+    appendNumber(record, headers.size());
+    HTTPHeaderMap::const_iterator end = headers.end();
+    for (HTTPHeaderMap::const_iterator it = headers.begin(); it != end; ++it) {
+        appendString(record, it->first);
+        appendString(record, it->second);
+    }
+
+    uint32_t bodyOffset = record.size();
+    uint32_t bodyLength = data->size();
+    if (bodyOffset + bodyLength > m_maximumSize / cMaximumEntryFraction) {
+        delete operation;
+        remove(url);
+        return;
+    }
+    memcpy(record.data() + bodyOffsetPosition, &bodyOffset, sizeof(bodyOffset));
+    memcpy(record.data() + bodyOffsetPosition + sizeof(bodyOffset), &bodyLength, sizeof(bodyLength));
+    record.reserveCapacity(bodyOffset + bodyLength);
+    const char* segment;
+    unsigned position = 0;
+    while (unsigned length = data->getSomeData(segment, position)) {
+        record.append(segment, length);
+        position += length;
+    }
+
+    EntryMap::iterator it = m_entries.find(operation->key);
+    if (it != m_entries.end()) {
+        m_size -= it->second.size;
+        m_entries.remove(it);
+    }
+    evictEntries(m_maximumSize - record.size());
+    Entry entry;
+    entry.size = record.size();
+    entry.lastAccessTime = currentTime();
+    m_entries.set(operation->key, entry);
+    m_size += entry.size;
+    schedule(operation);
+}
+
+void DiskCache::remove(const String& url)
+{
+    ASSERT(isMainThread());
+    if (!isEnabled())
+        return;
+    unsigned key = entryKey(url);
+    if (m_entries.contains(key))
+        removeEntry(key);
+}
+
+void DiskCache::removeEntry(unsigned key)
+{
+    EntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+    m_size -= it->second.size;
+    m_entries.remove(it);
+
+    Operation* operation = new Operation;
+    operation->key = key;
+    schedule(operation);
+}
+
+void DiskCache::evictEntries(unsigned long long targetSize)
+{
+    // Entries number in the hundreds, so finding the oldest by walking them
+    // all is cheap next to the file operations.
+    while (m_size > targetSize && !m_entries.isEmpty()) {
+        EntryMap::iterator end = m_entries.end();
+        EntryMap::iterator oldest = m_entries.begin();
+        for (EntryMap::iterator it = m_entries.begin(); it != end; ++it) {
+            if (it->second.lastAccessTime < oldest->second.lastAccessTime)
+                oldest = it;
+        }
+        removeEntry(oldest->first);
+    }
+}
+
+void DiskCache::filePath(unsigned key, char* buffer, size_t length) const
+{
+    snprintf(buffer, length, "%s/%08x", m_cacheDirectoryPath.data(), key);
+}
+
+void DiskCache::schedule(Operation* operation)
+{
+    MutexLocker locker(m_operationsLock);
+    m_operations.append(operation);
+    if (m_operationsScheduled)
+        return;
+    // Operations run one at a time so that a removal can't overtake the
+    // write it follows, or the other way round.
+    m_operationsScheduled = true;
+    dispatchToBackground(performOperations, this, LowBackgroundPriority);
+}
+
+void DiskCache::performOperations(void* context)
+{
+    DiskCache* cache = static_cast<DiskCache*>(context);
+    while (true) {
+        Operation* operation;
+        {
+            MutexLocker locker(cache->m_operationsLock);
+            if (cache->m_operations.isEmpty()) {
+                cache->m_operationsScheduled = false;
+                return;
+            }
+            operation = cache->m_operations.first();
+            cache->m_operations.removeFirst();
+        }
+        cache->perform(operation);
+        delete operation;
+    }
+}
+
+void DiskCache::perform(Operation* operation)
+{
+    char path[PATH_MAX];
+    filePath(operation->key, path, sizeof(path));
+    if (operation->contents.isEmpty()) {
+        unlink(path);
+        return;
+    }
+
+    // Write beside the entry and rename over it, so that readers never see
+    // a partial file and mappings of the old one stay valid.
+    char temporaryPath[PATH_MAX];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+    int fd = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+        return;
+    const char* data = operation->contents.data();
+    size_t remaining = operation->contents.size();
+    while (remaining) {
+        ssize_t written = write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        data += written;
+        remaining -= written;
+    }
+    close(fd);
+    if (remaining || rename(temporaryPath, path))
+        unlink(temporaryPath);
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(DISK_CACHE)
@@ -0,0 +1,89 @@
+#ifndef DiskCache_h
+#define DiskCache_h
+
+#if ENABLE(DISK_CACHE)
+
+#include "CString.h"
+#include "PlatformString.h"
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class ResourceRequest;
+class ResourceResponse;
+class SharedBuffer;
+
+// Keeps fresh subresources in files under a directory so that they outlive
+// the memory cache and the process. Each entry is one file, named after a
+// hash of its URL, that holds the response, the request header values named
+// by its Vary header and the body. Bodies are mapped into memory when read
+// rather than copied out of the file. Files are written and removed on a
+// background thread, one operation at a time; lookups happen on the main
+// thread.
+class DiskCache : public Noncopyable {
+public:
+    // Nothing is cached until the directory is set. It can only be set once.
+    void setCacheDirectory(const String&);
+    const String& cacheDirectory() const { return m_cacheDirectory; }
+
+    void setMaximumSize(unsigned long long size);
+    unsigned long long maximumSize() const { return m_maximumSize; }
+
+    bool isEnabled() const { return !m_cacheDirectory.isNull() && m_maximumSize; }
+
+    // Returns the body of the entry for request and fills response, or 0 if
+    // there is no entry that is still fresh and was stored for the same
+    // values of the headers its response varies on.
+    PassRefPtr<SharedBuffer> lookup(const ResourceRequest&, ResourceResponse&);
+    // Replaces the entry for the request's URL. expirationTime is when the
+    // response stops being fresh, in currentTime() terms.
+    void store(const ResourceRequest&, const ResourceResponse&, double expirationTime, SharedBuffer*);
+    void remove(const String& url);
+
+private:
+    DiskCache();
+    friend DiskCache& diskCache();
+
+    struct Entry {
+        unsigned size;
+        double lastAccessTime;
+    };
+    typedef HashMap<unsigned, Entry> EntryMap;
+
+    // A file to write, or to delete when contents is empty
+    struct Operation {
+        unsigned key;
+        Vector<char> contents;
+    };
+
+    void removeEntry(unsigned key);
+    void evictEntries(unsigned long long targetSize);
+    void filePath(unsigned key, char* buffer, size_t length) const;
+
+    void schedule(Operation*);
+    static void performOperations(void*);
+    void perform(Operation*);
+
+    String m_cacheDirectory;
+    CString m_cacheDirectoryPath;
+    unsigned long long m_maximumSize;
+    unsigned long long m_size;
+    EntryMap m_entries;
+
+    Mutex m_operationsLock;
+    Deque<Operation*> m_operations;
+    bool m_operationsScheduled;
+};
+
+DiskCache& diskCache();
+
+} // namespace WebCore
+
+#endif // ENABLE(DISK_CACHE)
+
+#endif // DiskCache_h
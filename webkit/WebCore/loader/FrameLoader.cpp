@@ -3048,9 +3048,11 @@ void FrameLoader::checkLoadCompleteForThisFrame()
                 page->progress()->progressCompleted(m_frame);
 
 #ifdef ANDROID_INSTRUMENT
-            if (!m_frame->tree()->parent() && m_frame->document()->renderArena())
+            if (!m_frame->tree()->parent() && m_frame->document()->renderArena()) {
+                RenderArena* arena = m_frame->document()->renderArena();
                 android::TimeCounter::report(m_URL, cache()->getLiveSize(), cache()->getDeadSize(),
-                        m_frame->document()->renderArena()->reportPoolSize());
+                        arena->reportPoolSize(), arena->liveSize());
+            }
 #endif
             return;
         }
@@ -46,6 +46,8 @@ public:
     void setCurrentItem(HistoryItem*);
     void setCurrentItemTitle(const String&);
 
+    HistoryItem* previousItem() const { return m_previousItem.get(); }
+
     HistoryItem* provisionalItem() const { return m_provisionalItem.get(); }
     void setProvisionalItem(HistoryItem*);
 
@@ -14,6 +14,9 @@ Request::Request(DocLoader* docLoader, CachedResource* object, bool incremental,
     , m_multipart(false)
     , m_shouldDoSecurityCheck(shouldDoSecurityCheck)
     , m_sendResourceLoadCallbacks(sendResourceLoadCallbacks)
+    , m_startTime(0)
+    , m_responseTime(0)
+    , m_renderBlocking(false)
 {
     m_object->setRequest(this);
 }
@@ -28,6 +28,17 @@ namespace WebCore {
 
         SecurityCheckPolicy shouldDoSecurityCheck() const { return m_shouldDoSecurityCheck; }
         bool sendResourceLoadCallbacks() const { return m_sendResourceLoadCallbacks; }
+
+        // When the request was handed to the networking layer and when its
+        // response arrived, or 0 if that has not happened yet
+        double startTime() const { return m_startTime; }
+        void setStartTime(double time) { m_startTime = time; }
+        double responseTime() const { return m_responseTime; }
+        void setResponseTime(double time) { m_responseTime = time; }
+
+        // Whether the resource held up the first paint when it was requested
+        bool isRenderBlocking() const { return m_renderBlocking; }
+        void setIsRenderBlocking(bool b = true) { m_renderBlocking = b; }
         
     private:
         Vector<char> m_buffer;
@@ -37,6 +48,9 @@ namespace WebCore {
         bool m_multipart;
         SecurityCheckPolicy m_shouldDoSecurityCheck;
         bool m_sendResourceLoadCallbacks;
+        double m_startTime;
+        double m_responseTime;
+        bool m_renderBlocking;
     };
 
 } //namespace WebCore
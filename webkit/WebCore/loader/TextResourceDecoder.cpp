@@ -294,6 +294,9 @@ TextResourceDecoder::TextResourceDecoder(const String& mimeType, const TextEncod
     , m_checkedForBOM(false)
     , m_checkedForCSSCharset(false)
     , m_checkedForHeadCharset(false)
+    , m_headCharsetScanOffset(0)
+    , m_headCharsetEnclosingTagName(0)
+    , m_headCharsetInHeadSection(true)
     , m_useLenientXMLDecoding(false)
     , m_sawError(false)
     , m_usesEncodingDetector(usesEncodingDetector)
@@ -506,9 +509,6 @@ bool TextResourceDecoder::checkForHeadCharset(const char* data, size_t len, bool
         return true;
     }
 
-    // This is not completely efficient, since the function might go
-    // through the HTML head several times.
-
     size_t oldSize = m_buffer.size();
     m_buffer.grow(oldSize + len);
     memcpy(m_buffer.data() + oldSize, data, len);
@@ -566,14 +566,20 @@ bool TextResourceDecoder::checkForHeadCharset(const char* data, size_t len, bool
     // Since many sites have charset declarations after <body> or other tags that are disallowed in <head>,
     // we don't bail out until we've checked at least bytesToCheckUnconditionally bytes of input.
 
-    AtomicStringImpl* enclosingTagName = 0;
-    bool inHeadSection = true; // Becomes false when </head> or any tag not allowed in head is encountered.
-
     // the HTTP-EQUIV meta has no effect on XHTML
     if (m_contentType == XML)
         return true;
 
+    // Rather than going through the head again each time data arrives, the
+    // scan picks up at the start of the last thing it couldn't finish.
+    AtomicStringImpl* enclosingTagName = m_headCharsetEnclosingTagName;
+    bool inHeadSection = m_headCharsetInHeadSection; // Becomes false when </head> or any tag not allowed in head is encountered.
+    ptr += m_headCharsetScanOffset;
+
     while (ptr + 3 < pEnd) { // +3 guarantees that "<!--" fits in the buffer - and certainly we aren't going to lose any "charset" that way.
+        m_headCharsetScanOffset = ptr - m_buffer.data();
+        m_headCharsetEnclosingTagName = enclosingTagName;
+        m_headCharsetInHeadSection = inHeadSection;
         if (*ptr == '<') {
             bool end = false;
             ptr++;
@@ -811,6 +817,9 @@ String TextResourceDecoder::flush()
     m_buffer.clear();
     m_codec.clear();
     m_checkedForBOM = false; // Skip BOM again when re-decoding.
+    m_headCharsetScanOffset = 0;
+    m_headCharsetEnclosingTagName = 0;
+    m_headCharsetInHeadSection = true;
     return result;
 }
 
@@ -66,6 +66,11 @@ private:
     bool m_checkedForBOM;
     bool m_checkedForCSSCharset;
     bool m_checkedForHeadCharset;
+    // Where checkForHeadCharset() picks up when more data arrives, and the
+    // state of the scan there.
+    size_t m_headCharsetScanOffset;
+    AtomicStringImpl* m_headCharsetEnclosingTagName;
+    bool m_headCharsetInHeadSection;
     bool m_useLenientXMLDecoding; // Don't stop on XML decoding errors.
     bool m_sawError;
     bool m_usesEncodingDetector;
@@ -14,9 +14,19 @@
 #include "KURL.h"
 #include "SQLiteStatement.h"
 #include "SQLiteTransaction.h"
+#include "SharedBuffer.h"
 #include <wtf/StdLibExtras.h>
 #include <wtf/StringExtras.h>
 
+#if HAVE(MMAP)
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -60,6 +70,87 @@ private:
     Vector<Record> m_records;
 };
 
+// Deletes the resource files written while storing unless the transaction
+// that refers to them commits.
+class ResourceFileJournal : public Noncopyable {
+public:
+    ~ResourceFileJournal()
+    {
+        size_t size = m_paths.size();
+        for (size_t i = 0; i < size; ++i)
+            deleteFile(m_paths[i]);
+    }
+
+    void add(const String& path)
+    {
+        m_paths.append(path);
+    }
+
+    void commit()
+    {
+        m_paths.clear();
+    }
+
+private:
+    Vector<String> m_paths;
+};
+
+static const char resourceFileDirectory[] = "ApplicationCacheResources";
+// Smaller bodies stay in the database, where they cost less than a file.
+static const unsigned minimumResourceFileSize = 16 * 1024;
+
+// FNV-1a, over the whole body; it only has to narrow down the rows whose
+// data is compared byte for byte.
+static unsigned resourceDataHash(const char* data, unsigned size)
+{
+    unsigned hash = 2166136261U;
+    for (unsigned i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+#if HAVE(MMAP)
+// Returns MAP_FAILED if the file is missing or empty.
+static void* mapResourceFile(const String& path, size_t& length)
+{
+    int fd = open(fileSystemRepresentation(path).data(), O_RDONLY);
+    if (fd < 0)
+        return MAP_FAILED;
+    struct stat status;
+    void* region = MAP_FAILED;
+    if (!fstat(fd, &status) && status.st_size > 0) {
+        length = status.st_size;
+        region = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    return region;
+}
+
+static bool writeResourceFile(const String& path, const char* data, size_t size)
+{
+    CString fileSystemPath = fileSystemRepresentation(path);
+    int fd = open(fileSystemPath.data(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+        return false;
+    while (size) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        data += written;
+        size -= written;
+    }
+    close(fd);
+    if (size)
+        unlink(fileSystemPath.data());
+    return !size;
+}
+#endif
+
 static unsigned urlHostHash(const KURL& url)
 {
     unsigned hostStart = url.hostStart();
@@ -361,7 +452,7 @@ int64_t ApplicationCacheStorage::spaceNeeded(int64_t cacheToSave)
     if (!getFileSize(m_cacheFile, fileSize))
         return 0;
 
-    int64_t currentSize = fileSize;
+    int64_t currentSize = fileSize + resourceFilesSize();
 
     // Determine the amount of free space we have available.
     int64_t totalAvailableSize = 0;
@@ -404,7 +495,7 @@ bool ApplicationCacheStorage::executeSQLCommand(const String& sql)
     return result;
 }
 
-static const int schemaVersion = 5;
+static const int schemaVersion = 6;
     
 void ApplicationCacheStorage::verifySchemaVersion()
 {
@@ -462,7 +553,10 @@ void ApplicationCacheStorage::openDatabase(bool createIfDoesNotExist)
     executeSQLCommand("CREATE TABLE IF NOT EXISTS CacheEntries (cache INTEGER NOT NULL ON CONFLICT FAIL, type INTEGER, resource INTEGER NOT NULL)");
     executeSQLCommand("CREATE TABLE IF NOT EXISTS CacheResources (id INTEGER PRIMARY KEY AUTOINCREMENT, url TEXT NOT NULL ON CONFLICT FAIL, "
                       "statusCode INTEGER NOT NULL, responseURL TEXT NOT NULL, mimeType TEXT, textEncodingName TEXT, headers TEXT, data INTEGER NOT NULL ON CONFLICT FAIL)");
-    executeSQLCommand("CREATE TABLE IF NOT EXISTS CacheResourceData (id INTEGER PRIMARY KEY AUTOINCREMENT, data BLOB)");
+    // file names the file under resourceFileDirectory that holds the data instead of the blob.
+    executeSQLCommand("CREATE TABLE IF NOT EXISTS CacheResourceData (id INTEGER PRIMARY KEY AUTOINCREMENT, data BLOB, hash INTEGER, size INTEGER, file TEXT)");
+    executeSQLCommand("CREATE INDEX IF NOT EXISTS CacheResourceDataHashIndex ON CacheResourceData (hash)");
+    executeSQLCommand("CREATE TABLE IF NOT EXISTS DeletedCacheResourceFiles (file TEXT)");
 
     // When a cache is deleted, all its entries and its whitelist should be deleted.
     executeSQLCommand("CREATE TRIGGER IF NOT EXISTS CacheDeleted AFTER DELETE ON Caches"
@@ -479,11 +573,78 @@ void ApplicationCacheStorage::openDatabase(bool createIfDoesNotExist)
                       "  DELETE FROM CacheResources WHERE id = OLD.resource;"
                       " END");
 
-    // When a cache resource is deleted, its data blob should also be deleted.
+    // When a cache resource is deleted, its data blob should also be deleted, unless
+    // identical resources of other caches still share it.
     executeSQLCommand("CREATE TRIGGER IF NOT EXISTS CacheResourceDeleted AFTER DELETE ON CacheResources"
                       " FOR EACH ROW BEGIN"
-                      "  DELETE FROM CacheResourceData WHERE id = OLD.data;"
+                      "  DELETE FROM CacheResourceData WHERE id = OLD.data AND NOT EXISTS (SELECT 1 FROM CacheResources WHERE data = OLD.data);"
                       " END");
+
+    // Files can't be deleted by the database, so deleted data rows leave their file
+    // names behind for removeDeletedResourceFiles().
+    executeSQLCommand("CREATE TRIGGER IF NOT EXISTS CacheResourceDataDeleted AFTER DELETE ON CacheResourceData"
+                      " FOR EACH ROW WHEN OLD.file IS NOT NULL BEGIN"
+                      "  INSERT INTO DeletedCacheResourceFiles (file) VALUES (OLD.file);"
+                      " END");
+
+    // Finish removing files if the last run exited before it could.
+    removeDeletedResourceFiles();
+}
+
+String ApplicationCacheStorage::resourceFilePath(const String& fileName) const
+{
+    return pathByAppendingComponent(pathByAppendingComponent(m_cacheDirectory, resourceFileDirectory), fileName);
+}
+
+PassRefPtr<SharedBuffer> ApplicationCacheStorage::loadResourceFile(const String& fileName)
+{
+#if HAVE(MMAP)
+    size_t length;
+    void* region = mapResourceFile(resourceFilePath(fileName), length);
+    if (region != MAP_FAILED)
+        return SharedBuffer::adoptMappedRegion(region, length, 0, length);
+#else
+    UNUSED_PARAM(fileName);
+#endif
+    return 0;
+}
+
+int64_t ApplicationCacheStorage::resourceFilesSize()
+{
+    if (!m_database.isOpen())
+        return 0;
+
+    SQLiteStatement statement(m_database, "SELECT SUM(size) FROM CacheResourceData WHERE file IS NOT NULL");
+    if (statement.prepare() != SQLResultOk || statement.step() != SQLResultRow)
+        return 0;
+    return statement.getColumnInt64(0);
+}
+
+void ApplicationCacheStorage::setDatabaseMaximumSize()
+{
+    // The files share the quota with the database.
+    m_database.setMaximumSize(max<int64_t>(m_maximumSize - resourceFilesSize(), 0));
+}
+
+void ApplicationCacheStorage::removeDeletedResourceFiles()
+{
+    // The deletions could still be rolled back.
+    if (!m_database.isOpen() || m_database.transactionInProgress())
+        return;
+
+    SQLiteStatement statement(m_database, "SELECT file FROM DeletedCacheResourceFiles");
+    if (statement.prepare() != SQLResultOk)
+        return;
+
+    bool deletedFiles = false;
+    while (statement.step() == SQLResultRow) {
+        deleteFile(resourceFilePath(statement.getColumnText(0)));
+        deletedFiles = true;
+    }
+    statement.finalize();
+
+    if (deletedFiles)
+        executeSQLCommand("DELETE FROM DeletedCacheResourceFiles");
 }
 
 bool ApplicationCacheStorage::executeStatement(SQLiteStatement& statement)
@@ -516,11 +677,12 @@ bool ApplicationCacheStorage::store(ApplicationCacheGroup* group, GroupStorageID
     return true;
 }    
 
-bool ApplicationCacheStorage::store(ApplicationCache* cache, ResourceStorageIDJournal* storageIDJournal)
+bool ApplicationCacheStorage::store(ApplicationCache* cache, ResourceStorageIDJournal* storageIDJournal, ResourceFileJournal* fileJournal)
 {
     ASSERT(cache->storageID() == 0);
     ASSERT(cache->group()->storageID() != 0);
     ASSERT(storageIDJournal);
+    ASSERT(fileJournal);
     
     SQLiteStatement statement(m_database, "INSERT INTO Caches (cacheGroup, size) VALUES (?, ?)");
     if (statement.prepare() != SQLResultOk)
@@ -539,7 +701,7 @@ bool ApplicationCacheStorage::store(ApplicationCache* cache, ResourceStorageIDJo
         ApplicationCache::ResourceMap::const_iterator end = cache->end();
         for (ApplicationCache::ResourceMap::const_iterator it = cache->begin(); it != end; ++it) {
             unsigned oldStorageID = it->second->storageID();
-            if (!store(it->second.get(), cacheStorageID))
+            if (!store(it->second.get(), cacheStorageID, fileJournal))
                 return false;
 
             // Storing the resource succeeded. Log its old storageID in case
@@ -597,10 +759,106 @@ bool ApplicationCacheStorage::store(ApplicationCache* cache, ResourceStorageIDJo
     return true;
 }
 
-bool ApplicationCacheStorage::store(ApplicationCacheResource* resource, unsigned cacheStorageID)
+bool ApplicationCacheStorage::storeResourceData(SharedBuffer* data, ResourceFileJournal* fileJournal, unsigned& dataID)
+{
+    const char* bytes = data->data();
+    unsigned size = data->size();
+    unsigned hash = resourceDataHash(bytes, size);
+
+    // A new version of a cache mostly consists of resources that haven't changed
+    // since the previous one, so look for a copy that is already stored.
+    SQLiteStatement lookupStatement(m_database, "SELECT id, data, file FROM CacheResourceData WHERE hash=? AND size=?");
+    if (lookupStatement.prepare() != SQLResultOk)
+        return false;
+
+    lookupStatement.bindInt64(1, hash);
+    lookupStatement.bindInt64(2, size);
+
+    while (lookupStatement.step() == SQLResultRow) {
+        bool matches = false;
+        String fileName = lookupStatement.getColumnText(2);
+        if (fileName.isEmpty()) {
+            Vector<char> blob;
+            lookupStatement.getColumnBlobAsVector(1, blob);
+            matches = blob.size() == size && (!size || !memcmp(blob.data(), bytes, size));
+        }
+#if HAVE(MMAP)
+        else {
+            size_t length;
+            void* region = mapResourceFile(resourceFilePath(fileName), length);
+            if (region != MAP_FAILED) {
+                matches = length == size && !memcmp(region, bytes, size);
+                munmap(region, length);
+            }
+        }
+#endif
+        if (matches) {
+            dataID = static_cast<unsigned>(lookupStatement.getColumnInt64(0));
+            return true;
+        }
+    }
+
+    bool storeInFile = false;
+#if HAVE(MMAP)
+    if (size >= minimumResourceFileSize) {
+        // The database won't stop the file from exceeding the quota.
+        long long databaseSize = 0;
+        getFileSize(m_cacheFile, databaseSize);
+        if (databaseSize + resourceFilesSize() + size > m_maximumSize) {
+            m_isMaximumSizeReached = true;
+            return false;
+        }
+        storeInFile = true;
+    }
+#endif
+
+    SQLiteStatement dataStatement(m_database, "INSERT INTO CacheResourceData (data, hash, size) VALUES (?, ?, ?)");
+    if (dataStatement.prepare() != SQLResultOk)
+        return false;
+
+    if (size && !storeInFile)
+        dataStatement.bindBlob(1, bytes, size);
+    dataStatement.bindInt64(2, hash);
+    dataStatement.bindInt64(3, size);
+
+    if (!dataStatement.executeCommand())
+        return false;
+
+    dataID = static_cast<unsigned>(m_database.lastInsertRowID());
+
+#if HAVE(MMAP)
+    if (storeInFile) {
+        // Row IDs are never reused, so neither are the file names.
+        String fileName = String::number(dataID);
+        String path = resourceFilePath(fileName);
+        makeAllDirectories(pathByAppendingComponent(m_cacheDirectory, resourceFileDirectory));
+        if (!writeResourceFile(path, bytes, size)) {
+            LOG_ERROR("Could not write application cache resource file %s", path.utf8().data());
+            return false;
+        }
+        fileJournal->add(path);
+
+        SQLiteStatement fileStatement(m_database, "UPDATE CacheResourceData SET file=? WHERE id=?");
+        if (fileStatement.prepare() != SQLResultOk)
+            return false;
+
+        fileStatement.bindText(1, fileName);
+        fileStatement.bindInt64(2, dataID);
+
+        if (!executeStatement(fileStatement))
+            return false;
+    }
+#else
+    UNUSED_PARAM(fileJournal);
+#endif
+    return true;
+}
+
+bool ApplicationCacheStorage::store(ApplicationCacheResource* resource, unsigned cacheStorageID, ResourceFileJournal* fileJournal)
 {
     ASSERT(cacheStorageID);
     ASSERT(!resource->storageID());
+    ASSERT(fileJournal);
     
     openDatabase(true);
     
@@ -608,18 +866,10 @@ bool ApplicationCacheStorage::store(ApplicationCacheResource* resource, unsigned
     if (!m_database.isOpen())
         return false;
 
-    // First, insert the data
-    SQLiteStatement dataStatement(m_database, "INSERT INTO CacheResourceData (data) VALUES (?)");
-    if (dataStatement.prepare() != SQLResultOk)
+    // First, find or insert the data
+    unsigned dataId;
+    if (!storeResourceData(resource->data(), fileJournal, dataId))
         return false;
-    
-    if (resource->data()->size())
-        dataStatement.bindBlob(1, resource->data()->data(), resource->data()->size());
-    
-    if (!dataStatement.executeCommand())
-        return false;
-
-    unsigned dataId = static_cast<unsigned>(m_database.lastInsertRowID());
 
     // Then, insert the resource
     
@@ -698,12 +948,13 @@ bool ApplicationCacheStorage::store(ApplicationCacheResource* resource, Applicat
         return false;
  
     m_isMaximumSizeReached = false;
-    m_database.setMaximumSize(m_maximumSize);
 
     SQLiteTransaction storeResourceTransaction(m_database);
     storeResourceTransaction.begin();
-    
-    if (!store(resource, cache->storageID())) {
+    setDatabaseMaximumSize();
+
+    ResourceFileJournal fileJournal;
+    if (!store(resource, cache->storageID(), &fileJournal)) {
         checkForMaxSizeReached();
         return false;
     }
@@ -720,6 +971,7 @@ bool ApplicationCacheStorage::store(ApplicationCacheResource* resource, Applicat
         return false;
     
     storeResourceTransaction.commit();
+    fileJournal.commit();
     return true;
 }
 
@@ -731,11 +983,11 @@ bool ApplicationCacheStorage::storeNewestCache(ApplicationCacheGroup* group)
         return false;
 
     m_isMaximumSizeReached = false;
-    m_database.setMaximumSize(m_maximumSize);
 
     SQLiteTransaction storeCacheTransaction(m_database);
     
     storeCacheTransaction.begin();
+    setDatabaseMaximumSize();
 
     GroupStorageIDJournal groupStorageIDJournal;
     if (!group->storageID()) {
@@ -754,9 +1006,10 @@ bool ApplicationCacheStorage::storeNewestCache(ApplicationCacheGroup* group)
     // object will roll them back automatically in case a database operation
     // fails and this method returns early.
     ResourceStorageIDJournal resourceStorageIDJournal;
+    ResourceFileJournal resourceFileJournal;
 
     // Store the newest cache
-    if (!store(group->newestCache(), &resourceStorageIDJournal)) {
+    if (!store(group->newestCache(), &resourceStorageIDJournal, &resourceFileJournal)) {
         checkForMaxSizeReached();
         return false;
     }
@@ -776,6 +1029,7 @@ bool ApplicationCacheStorage::storeNewestCache(ApplicationCacheGroup* group)
     groupStorageIDJournal.commit();
     resourceStorageIDJournal.commit();
     storeCacheTransaction.commit();
+    resourceFileJournal.commit();
     return true;
 }
 
@@ -809,7 +1063,7 @@ static inline void parseHeaders(const String& headers, ResourceResponse& respons
 PassRefPtr<ApplicationCache> ApplicationCacheStorage::loadCache(unsigned storageID)
 {
     SQLiteStatement cacheStatement(m_database, 
-                                   "SELECT url, type, mimeType, textEncodingName, headers, CacheResourceData.data FROM CacheEntries INNER JOIN CacheResources ON CacheEntries.resource=CacheResources.id "
+                                   "SELECT url, type, mimeType, textEncodingName, headers, CacheResourceData.data, CacheResourceData.file FROM CacheEntries INNER JOIN CacheResources ON CacheEntries.resource=CacheResources.id "
                                    "INNER JOIN CacheResourceData ON CacheResourceData.id=CacheResources.data WHERE CacheEntries.cache=?");
     if (cacheStatement.prepare() != SQLResultOk) {
         LOG_ERROR("Could not prepare cache statement, error \"%s\"", m_database.lastErrorMsg());
@@ -826,10 +1080,16 @@ PassRefPtr<ApplicationCache> ApplicationCacheStorage::loadCache(unsigned storage
         
         unsigned type = static_cast<unsigned>(cacheStatement.getColumnInt64(1));
 
-        Vector<char> blob;
-        cacheStatement.getColumnBlobAsVector(5, blob);
-        
-        RefPtr<SharedBuffer> data = SharedBuffer::adoptVector(blob);
+        RefPtr<SharedBuffer> data;
+        String fileName = cacheStatement.getColumnText(6);
+        if (fileName.isEmpty()) {
+            Vector<char> blob;
+            cacheStatement.getColumnBlobAsVector(5, blob);
+            data = SharedBuffer::adoptVector(blob);
+        } else if (!(data = loadResourceFile(fileName))) {
+            LOG_ERROR("Could not load application cache resource file %s", fileName.utf8().data());
+            continue;
+        }
         
         String mimeType = cacheStatement.getColumnText(2);
         String textEncodingName = cacheStatement.getColumnText(3);
@@ -933,6 +1193,8 @@ void ApplicationCacheStorage::remove(ApplicationCache* cache)
 
         cache->group()->clearStorageID();
     }
+
+    removeDeletedResourceFiles();
 }    
 
 void ApplicationCacheStorage::empty()
@@ -945,6 +1207,7 @@ void ApplicationCacheStorage::empty()
     // Clear cache groups, caches and cache resources.
     executeSQLCommand("DELETE FROM CacheGroups");
     executeSQLCommand("DELETE FROM Caches");
+    removeDeletedResourceFiles();
     
     // Clear the storage IDs for the caches in memory.
     // The caches will still work, but cached resources will not be saved to disk 
@@ -1079,6 +1342,7 @@ bool ApplicationCacheStorage::deleteCacheGroup(const String& manifestURL)
     }
 
     deleteTransaction.commit();
+    removeDeletedResourceFiles();
     return true;
 }
 
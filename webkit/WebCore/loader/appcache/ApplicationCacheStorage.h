@@ -18,6 +18,8 @@ class ApplicationCacheHost;
 class ApplicationCacheGroup;
 class ApplicationCacheResource;
 class KURL;
+class ResourceFileJournal;
+class SharedBuffer;
 template <class T>
 class StorageIDJournal;
 
@@ -62,8 +64,20 @@ private:
     typedef StorageIDJournal<ApplicationCacheGroup> GroupStorageIDJournal;
 
     bool store(ApplicationCacheGroup*, GroupStorageIDJournal*);
-    bool store(ApplicationCache*, ResourceStorageIDJournal*);
-    bool store(ApplicationCacheResource*, unsigned cacheStorageID);
+    bool store(ApplicationCache*, ResourceStorageIDJournal*, ResourceFileJournal*);
+    bool store(ApplicationCacheResource*, unsigned cacheStorageID, ResourceFileJournal*);
+    // Sets dataID to the CacheResourceData row holding data, reusing the row
+    // of an earlier identical resource if there is one.
+    bool storeResourceData(SharedBuffer* data, ResourceFileJournal*, unsigned& dataID);
+
+    // Large resource bodies are kept in files beside the database, which the
+    // database's size limit doesn't cover.
+    String resourceFilePath(const String& fileName) const;
+    PassRefPtr<SharedBuffer> loadResourceFile(const String& fileName);
+    int64_t resourceFilesSize();
+    void setDatabaseMaximumSize();
+    // Deletes the files of resource data rows that have been deleted.
+    void removeDeletedResourceFiles();
 
     void loadManifestHostHashes();
     
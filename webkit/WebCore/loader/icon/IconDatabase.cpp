@@ -47,6 +47,10 @@ static const int iconExpirationTime = 60*60*24*4;
 
 static const int updateTimerDelay = 5; 
 
+// Past this many pending changes, they are written without waiting for the
+// sync timer.
+static const unsigned maximumPendingSyncs = 64;
+
 static bool checkIntegrityOnOpen = false;
 
 #ifndef NDEBUG
@@ -744,6 +748,7 @@ IconDatabase::IconDatabase()
     , m_threadTerminationRequested(false)
     , m_removeIconsRequested(false)
     , m_iconURLImportComplete(false)
+    , m_writeRequested(false)
     , m_initialPruningComplete(false)
     , m_client(defaultClient())
     , m_imported(false)
@@ -808,6 +813,10 @@ void IconDatabase::scheduleOrDeferSyncTimer()
 void IconDatabase::syncTimerFired(Timer<IconDatabase>*)
 {
     ASSERT_NOT_SYNC_THREAD();
+    {
+        MutexLocker locker(m_pendingSyncLock);
+        m_writeRequested = true;
+    }
     wakeSyncThread();
 
     // The following is balanced by the call to disableSuddenTermination in the
@@ -1545,7 +1554,14 @@ bool IconDatabase::writeToDatabase()
     Vector<PageURLSnapshot> pageSnapshots;
     {
         MutexLocker locker(m_pendingSyncLock);
-        
+
+        // The sync thread is also woken to read icons, which happens often
+        // while pages load. Leave changes to be written in one transaction
+        // when the sync timer fires, unless a lot of them have built up.
+        if (!m_writeRequested && m_iconsPendingSync.size() + m_pageURLsPendingSync.size() < maximumPendingSyncs)
+            return false;
+        m_writeRequested = false;
+
         iconSnapshots.appendRange(m_iconsPendingSync.begin().values(), m_iconsPendingSync.end().values());
         m_iconsPendingSync.clear();
         
@@ -1553,9 +1569,10 @@ bool IconDatabase::writeToDatabase()
         m_pageURLsPendingSync.clear();
     }
     
-    if (iconSnapshots.size() || pageSnapshots.size())
-        didAnyWork = true;
-        
+    if (iconSnapshots.isEmpty() && pageSnapshots.isEmpty())
+        return false;
+    didAnyWork = true;
+
     SQLiteTransaction syncTransaction(m_syncDB);
     syncTransaction.begin();
     
@@ -1736,6 +1753,10 @@ void* IconDatabase::cleanupSyncThread()
 
     // Sync remaining icons out
     LOG(IconDatabase, "(THREAD) Doing final writeout and closure of sync thread");
+    {
+        MutexLocker locker(m_pendingSyncLock);
+        m_writeRequested = true;
+    }
     writeToDatabase();
     
     // Close the database
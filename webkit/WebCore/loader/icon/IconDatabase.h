@@ -135,6 +135,9 @@ private:
     // Holding m_pendingSyncLock is required when accessing any of the following data structures
     HashMap<String, PageURLSnapshot> m_pageURLsPendingSync;
     HashMap<String, IconSnapshot> m_iconsPendingSync;
+    // Set by the sync timer. Until then, waking the sync thread for reads
+    // leaves pending changes to be written together.
+    bool m_writeRequested;
     
     Mutex m_pendingReadingLock;    
     // Holding m_pendingSyncLock is required when accessing any of the following data structures - when dealing with IconRecord*s, holding m_urlAndIconLock is also required
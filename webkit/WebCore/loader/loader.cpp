@@ -18,6 +18,8 @@
 #include "SecurityOrigin.h"
 #include "SubresourceLoader.h"
 #include <wtf/Assertions.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/MathExtras.h>
 #include <wtf/Vector.h>
 
 #define REQUEST_MANAGEMENT_ENABLED 1
@@ -34,10 +36,22 @@ static const unsigned maxRequestsInFlightForNonHTTPProtocols = 20;
 static const unsigned maxRequestsInFlightPerHost = 10000;
 static const unsigned maxRequestsInFlightForNonHTTPProtocols = 10000;
 #endif
+// However slow the link to a host looks, keep this many of its requests in flight
+static const int minRequestsInFlightPerHost = 2;
+// Weight of each new sample in a host's link estimate
+static const double linkEstimateSampleWeight = 0.25;
+// Throughput is sampled over at least this much time, in seconds, so that
+// one small response arriving in a burst doesn't dominate it
+static const double minThroughputSampleTime = 0.1;
+// How many hosts without requests to remember the links of
+static const unsigned maxLinkEstimates = 64;
 
 Loader::Loader()
     : m_requestTimer(this, &Loader::requestTimerFired)
     , m_isSuspendingPendingRequests(false)
+#if PLATFORM(ANDROID)
+    , m_renderBlockingRequests(0)
+#endif
 {
     m_nonHTTPProtocolHost = Host::create(AtomicString(), maxRequestsInFlightForNonHTTPProtocols);
 #if REQUEST_MANAGEMENT_ENABLED
@@ -96,22 +110,55 @@ Loader::Priority Loader::determinePriority(const CachedResource* resource) const
 #endif
 }
 
+#if PLATFORM(ANDROID)
+// Style sheets always hold up the first paint; scripts only while the
+// parser is waiting on them.
+static bool isRenderBlocking(const CachedResource* resource, DocLoader* docLoader)
+{
+    switch (resource->type()) {
+    case CachedResource::CSSStyleSheet:
+        return true;
+    case CachedResource::Script:
+        return docLoader->doc()->parsing();
+    default:
+        return false;
+    }
+}
+#endif
+
+PassRefPtr<Loader::Host> Loader::hostForName(const AtomicString& hostName)
+{
+    m_hosts.checkConsistency();
+    RefPtr<Host> host = m_hosts.get(hostName.impl());
+    if (!host) {
+        host = Host::create(hostName, maxRequestsInFlightPerHost);
+        LinkEstimateMap::iterator it = m_linkEstimates.find(hostName);
+        if (it != m_linkEstimates.end()) {
+            host->setLinkEstimate(it->second);
+            m_linkEstimates.remove(it);
+        }
+        m_hosts.add(hostName.impl(), host);
+    }
+    return host.release();
+}
+
 void Loader::load(DocLoader* docLoader, CachedResource* resource, bool incremental, SecurityCheckPolicy securityCheck, bool sendResourceLoadCallbacks)
 {
     ASSERT(docLoader);
     Request* request = new Request(docLoader, resource, incremental, securityCheck, sendResourceLoadCallbacks);
 
+#if PLATFORM(ANDROID)
+    if (isRenderBlocking(resource, docLoader)) {
+        request->setIsRenderBlocking();
+        ++m_renderBlockingRequests;
+    }
+#endif
+
     RefPtr<Host> host;
     KURL url(ParsedURLString, resource->url());
-    if (url.protocolInHTTPFamily()) {
-        m_hosts.checkConsistency();
-        AtomicString hostName = url.host();
-        host = m_hosts.get(hostName.impl());
-        if (!host) {
-            host = Host::create(hostName, maxRequestsInFlightPerHost);
-            m_hosts.add(hostName.impl(), host);
-        }
-    } else 
+    if (url.protocolInHTTPFamily())
+        host = hostForName(url.host());
+    else 
         host = m_nonHTTPProtocolHost;
     
     bool hadRequests = host->hasRequests();
@@ -161,11 +208,44 @@ void Loader::servePendingRequests(Priority minimumPriority)
             host->servePendingRequests(minimumPriority);
         else if (!host->processingResource()){
             AtomicString name = host->name();
+            if (host->linkEstimate().roundTripTime) {
+                if (m_linkEstimates.size() >= maxLinkEstimates)
+                    m_linkEstimates.clear();
+                m_linkEstimates.set(name, host->linkEstimate());
+            }
             m_hosts.remove(name.impl());
         }
     }
 }
 
+#if PLATFORM(ANDROID)
+void Loader::raisePriority(CachedResource* resource, Priority priority)
+{
+    if (m_nonHTTPProtocolHost->raisePriority(resource, priority))
+        return;
+    KURL url(ParsedURLString, resource->url());
+    if (!url.protocolInHTTPFamily())
+        return;
+    m_hosts.checkConsistency();
+    RefPtr<Host> host = m_hosts.get(url.host().impl());
+    if (host && host->raisePriority(resource, priority))
+        scheduleServePendingRequests();
+}
+
+static ResourceRequest::Priority loaderPriorityToRequestPriority(Loader::Priority priority)
+{
+    switch (priority) {
+    case Loader::High:
+        return ResourceRequest::PriorityHigh;
+    case Loader::Medium:
+        return ResourceRequest::PriorityMedium;
+    case Loader::Low:
+        return ResourceRequest::PriorityLow;
+    }
+    return ResourceRequest::PriorityLow;
+}
+#endif
+
 void Loader::suspendPendingRequests()
 {
     ASSERT(!m_isSuspendingPendingRequests);
@@ -185,15 +265,7 @@ void Loader::nonCacheRequestInFlight(const KURL& url)
     if (!url.protocolInHTTPFamily())
         return;
     
-    AtomicString hostName = url.host();
-    m_hosts.checkConsistency();
-    RefPtr<Host> host = m_hosts.get(hostName.impl());
-    if (!host) {
-        host = Host::create(hostName, maxRequestsInFlightPerHost);
-        m_hosts.add(hostName.impl(), host);
-    }
-
-    host->nonCacheRequestInFlight();
+    hostForName(url.host())->nonCacheRequestInFlight();
 }
 
 void Loader::nonCacheRequestComplete(const KURL& url)
@@ -241,6 +313,11 @@ Loader::Host::Host(const AtomicString& name, unsigned maxRequestsInFlight)
     , m_maxRequestsInFlight(maxRequestsInFlight)
     , m_numResourcesProcessing(0)
     , m_nonCachedRequestsInFlight(0)
+    , m_requestLimit(maxRequestsInFlight)
+    , m_requestsReceiving(0)
+    , m_receivingStartTime(0)
+    , m_receivingTime(0)
+    , m_bytesReceived(0)
 {
 }
 
@@ -255,6 +332,84 @@ void Loader::Host::addRequest(Request* request, Priority priority)
 {
     m_requestsPending[priority].append(request);
 }
+
+void Loader::Host::deleteRequest(Request* request)
+{
+#if PLATFORM(ANDROID)
+    if (request->isRenderBlocking()) {
+        Loader* loader = cache()->loader();
+        ASSERT(loader->m_renderBlockingRequests);
+        if (!--loader->m_renderBlockingRequests)
+            loader->scheduleServePendingRequests();
+    }
+#endif
+    delete request;
+}
+
+void Loader::Host::setLinkEstimate(const LinkEstimate& estimate)
+{
+    m_linkEstimate = estimate;
+    updateRequestLimit();
+}
+
+static double addSample(double estimate, double sample)
+{
+    return estimate ? estimate + linkEstimateSampleWeight * (sample - estimate) : sample;
+}
+
+void Loader::Host::didStartReceiving(Request* request)
+{
+    // Later parts of a multipart response don't start a new round trip.
+    if (request->responseTime() || !request->startTime())
+        return;
+    double now = currentTime();
+    request->setResponseTime(now);
+    m_linkEstimate.roundTripTime = addSample(m_linkEstimate.roundTripTime, now - request->startTime());
+    if (!m_requestsReceiving++)
+        m_receivingStartTime = now;
+}
+
+void Loader::Host::didStopReceiving(Request* request, bool finished)
+{
+    if (!request->responseTime())
+        return;
+    double now = currentTime();
+    ASSERT(m_requestsReceiving > 0);
+    if (!--m_requestsReceiving)
+        m_receivingTime += now - m_receivingStartTime;
+    if (!finished)
+        return;
+
+    m_linkEstimate.responseSize = addSample(m_linkEstimate.responseSize, request->cachedResource()->encodedSize());
+    double receivingTime = m_receivingTime + (m_requestsReceiving ? now - m_receivingStartTime : 0);
+    if (receivingTime >= minThroughputSampleTime) {
+        m_linkEstimate.bytesPerSecond = addSample(m_linkEstimate.bytesPerSecond, m_bytesReceived / receivingTime);
+        m_bytesReceived = 0;
+        m_receivingTime = 0;
+        m_receivingStartTime = now;
+    }
+    updateRequestLimit();
+}
+
+void Loader::Host::updateRequestLimit()
+{
+    if (m_name.isNull() || !m_linkEstimate.roundTripTime || !m_linkEstimate.bytesPerSecond || !m_linkEstimate.responseSize)
+        return;
+
+    // Keep one response arriving, and enough requests waiting out their
+    // round trips that another is ready when it is done. More than that
+    // would only split the link between responses, and delay the ones the
+    // page is waiting for.
+    double transferTime = m_linkEstimate.responseSize / m_linkEstimate.bytesPerSecond;
+    double limit = 1 + ceil(m_linkEstimate.roundTripTime / transferTime);
+    if (limit >= m_maxRequestsInFlight)
+        m_requestLimit = m_maxRequestsInFlight;
+    else
+        m_requestLimit = std::max(static_cast<int>(limit), minRequestsInFlightPerHost);
+#if REQUEST_DEBUG
+    printf("HOST %s RTT %.3fs %.0f BYTES/S LIMIT %d\n", m_name.string().latin1().data(), m_linkEstimate.roundTripTime, m_linkEstimate.bytesPerSecond, m_requestLimit);
+#endif
+}
     
 void Loader::Host::nonCacheRequestInFlight()
 {
@@ -285,11 +440,47 @@ void Loader::Host::servePendingRequests(Loader::Priority minimumPriority)
 
     bool serveMore = true;
     for (int priority = High; priority >= minimumPriority && serveMore; --priority)
-        servePendingRequests(m_requestsPending[priority], serveMore);
+        servePendingRequests(m_requestsPending[priority], static_cast<Priority>(priority), serveMore);
+}
+
+#if PLATFORM(ANDROID)
+bool Loader::Host::raisePriority(CachedResource* resource, Priority priority)
+{
+    for (int p = Low; p < priority; ++p) {
+        RequestQueue& requestsPending = m_requestsPending[p];
+        RequestQueue::iterator end = requestsPending.end();
+        for (RequestQueue::iterator it = requestsPending.begin(); it != end; ++it) {
+            Request* request = *it;
+            if (request->cachedResource() == resource) {
+                requestsPending.remove(it);
+                m_requestsPending[priority].prepend(request);
+                return true;
+            }
+        }
+    }
+    RequestMap::iterator end = m_requestsLoading.end();
+    for (RequestMap::iterator i = m_requestsLoading.begin(); i != end; ++i) {
+        if (i->second->cachedResource() != resource)
+            continue;
+        if (ResourceHandle* handle = i->first->handle())
+            handle->setPriority(loaderPriorityToRequestPriority(priority),
+                isRenderBlocking(resource, i->second->docLoader()));
+        return false;
+    }
+    return false;
 }
+#endif
 
-void Loader::Host::servePendingRequests(RequestQueue& requestsPending, bool& serveLowerPriority)
+void Loader::Host::servePendingRequests(RequestQueue& requestsPending, Priority priority, bool& serveLowerPriority)
 {
+#if PLATFORM(ANDROID)
+    // Images would take bandwidth from the style sheets and scripts the
+    // first paint is waiting for. The last of those to finish serves the
+    // pending requests again.
+    if (priority == Low && !m_name.isNull() && cache()->loader()->m_renderBlockingRequests)
+        return;
+#endif
+
     while (!requestsPending.isEmpty()) {        
         Request* request = requestsPending.first();
         DocLoader* docLoader = request->docLoader();
@@ -299,7 +490,7 @@ void Loader::Host::servePendingRequests(RequestQueue& requestsPending, bool& ser
         // For non-named hosts - everything but http(s) - we should only enforce the limit if the document isn't done parsing 
         // and we don't know all stylesheets yet.
         bool shouldLimitRequests = !m_name.isNull() || docLoader->doc()->parsing() || !docLoader->doc()->haveStylesheetsLoaded();
-        if (shouldLimitRequests && m_requestsLoading.size() + m_nonCachedRequestsInFlight >= m_maxRequestsInFlight) {
+        if (shouldLimitRequests && m_requestsLoading.size() + m_nonCachedRequestsInFlight >= m_requestLimit) {
             serveLowerPriority = false;
             cache()->loader()->scheduleServePendingRequests();
             return;
@@ -308,6 +499,10 @@ void Loader::Host::servePendingRequests(RequestQueue& requestsPending, bool& ser
         
         ResourceRequest resourceRequest(request->cachedResource()->url());
         resourceRequest.setTargetType(cachedResourceTypeToTargetType(request->cachedResource()->type()));
+#if PLATFORM(ANDROID)
+        resourceRequest.setPriority(loaderPriorityToRequestPriority(priority));
+        resourceRequest.setRenderBlocking(isRenderBlocking(request->cachedResource(), docLoader));
+#endif
         
         if (!request->cachedResource()->accept().isEmpty())
             resourceRequest.setHTTPAccept(request->cachedResource()->accept());
@@ -335,6 +530,7 @@ void Loader::Host::servePendingRequests(RequestQueue& requestsPending, bool& ser
             this, resourceRequest, request->shouldDoSecurityCheck(), request->sendResourceLoadCallbacks());
         if (loader) {
             m_requestsLoading.add(loader.release(), request);
+            request->setStartTime(currentTime());
             request->cachedResource()->setRequestedFromNetworkingLayer();
 #if REQUEST_DEBUG
             printf("HOST %s COUNT %d LOADING %s\n", resourceRequest.url().host().latin1().data(), m_requestsLoading.size(), request->cachedResource()->url().latin1().data());
@@ -344,7 +540,7 @@ void Loader::Host::servePendingRequests(RequestQueue& requestsPending, bool& ser
             docLoader->setLoadInProgress(true);
             request->cachedResource()->error();
             docLoader->setLoadInProgress(false);
-            delete request;
+            deleteRequest(request);
         }
     }
 }
@@ -375,9 +571,13 @@ void Loader::Host::didFinishLoading(SubresourceLoader* loader)
         docLoader->setLoadInProgress(true);
         resource->data(loader->resourceData(), true);
         resource->finish();
+#if ENABLE(DISK_CACHE)
+        cache()->didLoadResourceFromNetwork(docLoader, loader->request(), resource);
+#endif
     }
+    didStopReceiving(request, !resource->errorOccurred());
 
-    delete request;
+    deleteRequest(request);
 
     docLoader->setLoadInProgress(false);
     
@@ -419,6 +619,8 @@ void Loader::Host::didFail(SubresourceLoader* loader, bool cancelled)
     if (resource->resourceToRevalidate())
         cache()->revalidationFailed(resource);
 
+    didStopReceiving(request, false);
+
     if (!cancelled) {
         docLoader->setLoadInProgress(true);
         resource->error();
@@ -428,7 +630,7 @@ void Loader::Host::didFail(SubresourceLoader* loader, bool cancelled)
     if (cancelled || !resource->isPreloaded())
         cache()->remove(resource);
     
-    delete request;
+    deleteRequest(request);
     
     docLoader->checkForPendingPreloads();
 
@@ -449,12 +651,15 @@ void Loader::Host::didReceiveResponse(SubresourceLoader* loader, const ResourceR
     // ASSERT(request);
     if (!request)
         return;
+
+    didStartReceiving(request);
     
     CachedResource* resource = request->cachedResource();
     
     if (resource->isCacheValidator()) {
         if (response.httpStatusCode() == 304) {
             // 304 Not modified / Use local copy
+            didStopReceiving(request, false);
             m_requestsLoading.remove(loader);
             loader->clearClient();
             request->docLoader()->decrementRequestCount();
@@ -465,7 +670,7 @@ void Loader::Host::didReceiveResponse(SubresourceLoader* loader, const ResourceR
             if (request->docLoader()->frame())
                 request->docLoader()->frame()->loader()->checkCompleted();
 
-            delete request;
+            deleteRequest(request);
 
             servePendingRequests();
             return;
@@ -506,6 +711,8 @@ void Loader::Host::didReceiveData(SubresourceLoader* loader, const char* data, i
     if (!request)
         return;
 
+    m_bytesReceived += size;
+
     CachedResource* resource = request->cachedResource();    
     ASSERT(!resource->isCacheValidator());
     
@@ -537,7 +744,7 @@ void Loader::Host::cancelPendingRequests(RequestQueue& requestsPending, DocLoade
         Request* request = *it;
         if (request->docLoader() == docLoader) {
             cache()->remove(request->cachedResource());
-            delete request;
+            deleteRequest(request);
             docLoader->decrementRequestCount();
         } else
             remaining.append(request);
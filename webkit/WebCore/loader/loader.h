@@ -7,6 +7,7 @@
 #include "AtomicStringImpl.h"
 #include "FrameLoaderTypes.h"
 #include "PlatformString.h"
+#include "StringHash.h"
 #include "SubresourceLoaderClient.h"
 #include "Timer.h"
 #include <wtf/Deque.h>
@@ -39,12 +40,32 @@ namespace WebCore {
         void nonCacheRequestInFlight(const KURL&);
         void nonCacheRequestComplete(const KURL&);
 
+#if PLATFORM(ANDROID)
+        // Moves a pending request for the resource ahead of lower priority
+        // ones, or tells the network stack to favor it if already loading.
+        void raisePriority(CachedResource*, Priority);
+#endif
+
     private:
         Priority determinePriority(const CachedResource*) const;
         void scheduleServePendingRequests();
         
         void requestTimerFired(Timer<Loader>*);
 
+        // What a host's recent loads showed about the connection to it. All
+        // values are 0 until measured.
+        struct LinkEstimate {
+            LinkEstimate() : roundTripTime(0), bytesPerSecond(0), responseSize(0) { }
+            // Seconds from handing a request to the networking layer to its response
+            double roundTripTime;
+            // Over all connections, while at least one response was arriving
+            double bytesPerSecond;
+            double responseSize;
+        };
+
+        class Host;
+        PassRefPtr<Host> hostForName(const AtomicString&);
+
         class Host : public RefCounted<Host>, private SubresourceLoaderClient {
         public:
             static PassRefPtr<Host> create(const AtomicString& name, unsigned maxRequestsInFlight) 
@@ -60,19 +81,31 @@ namespace WebCore {
             void servePendingRequests(Priority minimumPriority = Low);
             void cancelRequests(DocLoader*);
             bool hasRequests() const;
+#if PLATFORM(ANDROID)
+            bool raisePriority(CachedResource*, Priority);
+#endif
 
             bool processingResource() const { return m_numResourcesProcessing != 0 || m_nonCachedRequestsInFlight !=0; }
 
+            const LinkEstimate& linkEstimate() const { return m_linkEstimate; }
+            void setLinkEstimate(const LinkEstimate&);
+
         private:
             Host(const AtomicString&, unsigned);
 
+            void didStartReceiving(Request*);
+            void didStopReceiving(Request*, bool finished);
+            // Sets m_requestLimit from m_linkEstimate.
+            void updateRequestLimit();
+            void deleteRequest(Request*);
+
             virtual void didReceiveResponse(SubresourceLoader*, const ResourceResponse&);
             virtual void didReceiveData(SubresourceLoader*, const char*, int);
             virtual void didFinishLoading(SubresourceLoader*);
             virtual void didFail(SubresourceLoader*, const ResourceError&);
             
             typedef Deque<Request*> RequestQueue;
-            void servePendingRequests(RequestQueue& requestsPending, bool& serveLowerPriority);
+            void servePendingRequests(RequestQueue& requestsPending, Priority, bool& serveLowerPriority);
             void didFail(SubresourceLoader*, bool cancelled = false);
             void cancelPendingRequests(RequestQueue& requestsPending, DocLoader*);
             
@@ -83,14 +116,33 @@ namespace WebCore {
             const int m_maxRequestsInFlight;
             int m_numResourcesProcessing;
             int m_nonCachedRequestsInFlight;
+
+            LinkEstimate m_linkEstimate;
+            // At most m_maxRequestsInFlight, lower when the link to the host
+            // is too slow to make use of that many
+            int m_requestLimit;
+            // Loads whose response is arriving, and the bytes and time spent
+            // in that state since the last throughput sample
+            int m_requestsReceiving;
+            double m_receivingStartTime;
+            double m_receivingTime;
+            unsigned m_bytesReceived;
         };
         typedef HashMap<AtomicStringImpl*, RefPtr<Host> > HostMap;
         HostMap m_hosts;
         RefPtr<Host> m_nonHTTPProtocolHost;
+        // Estimates of hosts that have had no requests for a while, for when
+        // they come back
+        typedef HashMap<String, LinkEstimate> LinkEstimateMap;
+        LinkEstimateMap m_linkEstimates;
         
         Timer<Loader> m_requestTimer;
 
         bool m_isSuspendingPendingRequests;
+#if PLATFORM(ANDROID)
+        // Image loads wait while style sheets and blocking scripts load.
+        unsigned m_renderBlockingRequests;
+#endif
     };
 
 }
@@ -8,6 +8,17 @@
 #include "ScriptExecutionContext.h"
 #include <wtf/HashSet.h>
 #include <wtf/StdLibExtras.h>
+#if PLATFORM(ANDROID)
+#include "Document.h"
+#include "PlatformBridge.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MathExtras.h>
+#endif
+#ifdef ANDROID_INSTRUMENT
+#include "StringHash.h"
+#include <wtf/HashMap.h>
+#include <algorithm>
+#endif
 
 using namespace std;
 
@@ -16,6 +27,27 @@ namespace WebCore {
 static const int maxTimerNestingLevel = 5;
 static const double oneMillisecond = 0.001;
 double DOMTimer::s_minTimerInterval = 0.010; // 10 milliseconds
+#if PLATFORM(ANDROID)
+// Timers in a paused WebView run no more often than this, and all of them
+// on the same whole-second boundaries
+static const double pausedTimerInterval = 1.0;
+// Slow repeating timers fire on shared boundaries this far apart, so that
+// a page's clocks and pollers wake the thread once between them. Only
+// timers that repeat at least ten times slower are moved, so none runs
+// more than 10% late.
+static const double timerAlignmentInterval = 0.05;
+static const double minimumAlignedRepeatInterval = 10 * timerAlignmentInterval;
+#endif
+
+#ifdef ANDROID_INSTRUMENT
+typedef HashMap<String, unsigned> TimerSourceMap;
+
+static TimerSourceMap& timerSources()
+{
+    DEFINE_STATIC_LOCAL(TimerSourceMap, sources, ());
+    return sources;
+}
+#endif
 
 static int timerNestingLevel = 0;
 
@@ -27,6 +59,9 @@ DOMTimer::DOMTimer(ScriptExecutionContext* context, ScheduledAction* action, int
 #if !ASSERT_DISABLED
     , m_suspended(false)
 #endif
+#if PLATFORM(ANDROID)
+    , m_lastFireTime(currentTime())
+#endif
 {
     static int lastUsedTimeoutId = 0;
     ++lastUsedTimeoutId;
@@ -64,6 +99,9 @@ int DOMTimer::install(ScriptExecutionContext* context, ScheduledAction* action,
     // The timer is deleted when context is deleted (DOMTimer::contextDestroyed) or explicitly via DOMTimer::removeById(),
     // or if it is a one-time timer and it has fired (DOMTimer::fired).
     DOMTimer* timer = new DOMTimer(context, action, timeout, singleShot);
+#ifdef ANDROID_INSTRUMENT
+    ++timerSources().add(action->sourceURL(), 0).first->second;
+#endif
 
 #if ENABLE(INSPECTOR)
     if (InspectorTimelineAgent* timelineAgent = InspectorTimelineAgent::retrieve(context))
@@ -92,6 +130,20 @@ void DOMTimer::removeById(ScriptExecutionContext* context, int timeoutId)
 void DOMTimer::fired()
 {
     ScriptExecutionContext* context = scriptExecutionContext();
+#if PLATFORM(ANDROID)
+    if (context->isDocument()) {
+        FrameView* view = static_cast<Document*>(context)->view();
+        double now = currentTime();
+        if (view && PlatformBridge::isWebViewPaused(view)
+                && now < m_lastFireTime + pausedTimerInterval) {
+            // Missed fires are dropped rather than replayed, so resuming
+            // runs the action once. Repeating timers keep their interval.
+            start(m_lastFireTime + pausedTimerInterval - now, repeatInterval());
+            return;
+        }
+        m_lastFireTime = now;
+    }
+#endif
     timerNestingLevel = m_nestingLevel;
 
 #if ENABLE(INSPECTOR)
@@ -131,6 +183,44 @@ void DOMTimer::fired()
     timerNestingLevel = 0;
 }
 
+#if PLATFORM(ANDROID)
+double DOMTimer::alignedFireTime(double fireTime) const
+{
+    double alignment = 0;
+    ScriptExecutionContext* context = scriptExecutionContext();
+    if (context && context->isDocument()) {
+        FrameView* view = static_cast<Document*>(context)->view();
+        if (view && PlatformBridge::isWebViewPaused(view))
+            alignment = pausedTimerInterval;
+    }
+    if (!alignment && repeatInterval() >= minimumAlignedRepeatInterval)
+        alignment = timerAlignmentInterval;
+    if (!alignment)
+        return fireTime;
+    return ceil(fireTime / alignment) * alignment;
+}
+#endif
+
+#ifdef ANDROID_INSTRUMENT
+static bool installedMoreTimers(const DOMTimer::TimerSource& a, const DOMTimer::TimerSource& b)
+{
+    return a.second > b.second;
+}
+
+void DOMTimer::takeTimerSources(Vector<TimerSource>& result, size_t maximumCount)
+{
+    result.clear();
+    TimerSourceMap& sources = timerSources();
+    TimerSourceMap::iterator end = sources.end();
+    for (TimerSourceMap::iterator it = sources.begin(); it != end; ++it)
+        result.append(TimerSource(it->first, it->second));
+    sources.clear();
+    std::sort(result.begin(), result.end(), installedMoreTimers);
+    if (result.size() > maximumCount)
+        result.shrink(maximumCount);
+}
+#endif
+
 bool DOMTimer::hasPendingActivity() const
 {
     return isActive();
@@ -6,6 +6,11 @@
 #include "ActiveDOMObject.h"
 #include "Timer.h"
 #include <wtf/OwnPtr.h>
+#ifdef ANDROID_INSTRUMENT
+#include "PlatformString.h"
+#include <wtf/Vector.h>
+#include <utility>
+#endif
 
 namespace WebCore {
 
@@ -34,9 +39,20 @@ namespace WebCore {
         static double minTimerInterval() { return s_minTimerInterval; }
         static void setMinTimerInterval(double value) { s_minTimerInterval = value; }
 
+#ifdef ANDROID_INSTRUMENT
+        // The scripts that installed the most timers since the last call,
+        // most first, with how many each installed. Counting starts again
+        // from zero afterwards.
+        typedef std::pair<String, unsigned> TimerSource;
+        static void takeTimerSources(Vector<TimerSource>&, size_t maximumCount);
+#endif
+
     private:
         DOMTimer(ScriptExecutionContext*, ScheduledAction*, int timeout, bool singleShot);
         virtual void fired();
+#if PLATFORM(ANDROID)
+        virtual double alignedFireTime(double fireTime) const;
+#endif
 
         int m_timeoutId;
         int m_nestingLevel;
@@ -45,6 +61,10 @@ namespace WebCore {
         double m_repeatInterval;
 #if !ASSERT_DISABLED
         bool m_suspended;
+#endif
+#if PLATFORM(ANDROID)
+        // when the action last ran, or when the timer was created
+        double m_lastFireTime;
 #endif
         static double s_minTimerInterval;
     };
@@ -2555,18 +2555,42 @@ bool EventHandler::handleTouchEvent(const PlatformTouchEvent& event)
     for (unsigned i = 0; i < points.size(); ++i) {
         const PlatformTouchPoint& point = points[i];
         IntPoint pagePoint = documentPointForWindowPoint(m_frame, point.pos());
-        HitTestResult result = hitTestResultAtPoint(pagePoint, /*allowShadowContent*/ false);
-        Node* target = result.innerNode();
 
-        // Touch events should not go to text nodes
-        if (target && target->isTextNode())
-            target = target->parentNode();
+        // Increment the platform touch id by 1 to avoid storing a key of 0 in the hashmap.
+        unsigned touchPointTargetKey = point.id() + 1;
+        RefPtr<EventTarget> touchTarget;
+        Document* doc;
+        if (point.state() == PlatformTouchPoint::TouchPressed) {
+            HitTestResult result = hitTestResultAtPoint(pagePoint, /*allowShadowContent*/ false);
+            Node* target = result.innerNode();
+
+            // Touch events should not go to text nodes
+            if (target && target->isTextNode())
+                target = target->parentNode();
+            if (!target)
+                continue;
 
-        Document* doc = target->document();
-        if (!doc)
-            continue;
-        if (!doc->hasListenerType(Document::TOUCH_LISTENER))
-            continue;
+            doc = target->document();
+            if (!doc->hasListenerType(Document::TOUCH_LISTENER))
+                continue;
+
+            m_originatingTouchPointTargets.set(touchPointTargetKey, target);
+            touchTarget = target;
+        } else {
+            // The target should be the original target for this touch, so get it from the hashmap rather than
+            // hit testing every move. A touch that started where nobody listened has no entry. As a release or
+            // cancel ends the touch, we also remove it from the map.
+            if (point.state() == PlatformTouchPoint::TouchReleased || point.state() == PlatformTouchPoint::TouchCancelled)
+                touchTarget = m_originatingTouchPointTargets.take(touchPointTargetKey);
+            else
+                touchTarget = m_originatingTouchPointTargets.get(touchPointTargetKey);
+            if (!touchTarget.get())
+                continue;
+
+            doc = touchTarget->toNode()->document();
+            if (!doc->frame())
+                continue;
+        }
 
         if (m_frame != doc->frame()) {
             // pagePoint should always be relative to the target elements containing frame.
@@ -2576,22 +2600,6 @@ bool EventHandler::handleTouchEvent(const PlatformTouchEvent& event)
         int adjustedPageX = lroundf(pagePoint.x() / m_frame->pageZoomFactor());
         int adjustedPageY = lroundf(pagePoint.y() / m_frame->pageZoomFactor());
 
-        // Increment the platform touch id by 1 to avoid storing a key of 0 in the hashmap.
-        unsigned touchPointTargetKey = point.id() + 1;
-        RefPtr<EventTarget> touchTarget;
-        if (point.state() == PlatformTouchPoint::TouchPressed) {
-            m_originatingTouchPointTargets.set(touchPointTargetKey, target);
-            touchTarget = target;
-        } else if (point.state() == PlatformTouchPoint::TouchReleased || point.state() == PlatformTouchPoint::TouchCancelled) {
-            // The target should be the original target for this touch, so get it from the hashmap. As it's a release or cancel
-            // we also remove it from the map.
-            touchTarget = m_originatingTouchPointTargets.take(touchPointTargetKey);
-        } else
-            touchTarget = m_originatingTouchPointTargets.get(touchPointTargetKey);
-
-        if (!touchTarget.get())
-            continue;
-
         RefPtr<Touch> touch = Touch::create(doc->frame(), touchTarget.get(), point.id(),
                                             point.screenPos().x(), point.screenPos().y(),
                                             adjustedPageX, adjustedPageY);
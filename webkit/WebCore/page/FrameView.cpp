@@ -37,6 +37,10 @@
 #include "TimeCounter.h"
 #endif
 
+#if PLATFORM(ANDROID)
+#include "TraceBuffer.h"
+#endif
+
 #if USE(ACCELERATED_COMPOSITING)
 #include "RenderLayerCompositor.h"
 #endif
@@ -81,6 +85,10 @@ static const double maxDeferredRepaintDelayDuringLoading = 0;
 static const double deferredRepaintDelayIncrementDuringLoading = 0;
 #endif
 
+// How long, in ms, the layout timer waits while the document is parsing
+// and the last layout already filled the viewport.
+static const int belowTheFoldLayoutDelayDuringParsing = 300;
+
 // The maximum number of updateWidgets iterations that should be done before returning.
 static const unsigned maxUpdateWidgetsIterations = 2;
 
@@ -167,6 +175,7 @@ void FrameView::reset()
     m_layoutTimer.stop();
     m_layoutRoot = 0;
     m_delayedLayout = false;
+    m_viewportFilledWhileParsing = false;
     m_doFullRepaint = true;
     m_layoutSchedulingEnabled = true;
     m_midLayout = false;
@@ -496,6 +505,10 @@ void FrameView::layout(bool allowSubtree)
     if (m_midLayout)
         return;
 
+#if PLATFORM(ANDROID)
+    android::TraceBufferAuto trace(android::TraceBuffer::LayoutTrace);
+#endif
+
     m_layoutTimer.stop();
     m_delayedLayout = false;
     m_setNeedsLayoutWasDeferred = false;
@@ -686,8 +699,10 @@ void FrameView::layout(bool allowSubtree)
    
     m_layoutSchedulingEnabled = true;
 
-    if (!subtree && !toRenderView(root)->printing())
+    if (!subtree && !toRenderView(root)->printing()) {
         adjustViewSize();
+        m_viewportFilledWhileParsing = document->parsing() && contentsHeight() > scrollY() + visibleHeight();
+    }
 
     // Now update the positions of all layers.
     beginDeferredRepaints();
@@ -967,6 +982,42 @@ HostWindow* FrameView::hostWindow() const
 
 const unsigned cRepaintRectUnionThreshold = 25;
 
+static inline unsigned long long rectArea(const IntRect& rect)
+{
+    return static_cast<unsigned long long>(rect.width()) * rect.height();
+}
+
+void FrameView::addDeferredRepaintRect(const IntRect& rect)
+{
+    // Fold the rect into one we already have when their union covers at most
+    // a quarter more than the two do separately, so that the runs of small,
+    // adjacent or overlapping rects a layout or an animation frame produces
+    // collapse into a few without spreading over much unchanged content.
+    unsigned long long area = rectArea(rect);
+    unsigned size = m_repaintRects.size();
+    for (unsigned i = 0; i < size; ++i) {
+        IntRect& existing = m_repaintRects[i];
+        if (existing.contains(rect))
+            return;
+        IntRect merged = unionRect(existing, rect);
+        if (rectArea(merged) * 4 <= (rectArea(existing) + area) * 5) {
+            existing = merged;
+            return;
+        }
+    }
+
+    if (size < cRepaintRectUnionThreshold) {
+        m_repaintRects.append(rect);
+        return;
+    }
+
+    IntRect unionedRect = rect;
+    for (unsigned i = 0; i < size; ++i)
+        unionedRect.unite(m_repaintRects[i]);
+    m_repaintRects.clear();
+    m_repaintRects.append(unionedRect);
+}
+
 void FrameView::repaintContentRectangle(const IntRect& r, bool immediate)
 {
     ASSERT(!m_frame->document()->ownerElement());
@@ -982,17 +1033,7 @@ void FrameView::repaintContentRectangle(const IntRect& r, bool immediate)
 #endif
         if (paintRect.isEmpty())
             return;
-        if (m_repaintCount == cRepaintRectUnionThreshold) {
-            IntRect unionedRect;
-            for (unsigned i = 0; i < cRepaintRectUnionThreshold; ++i)
-                unionedRect.unite(m_repaintRects[i]);
-            m_repaintRects.clear();
-            m_repaintRects.append(unionedRect);
-        }
-        if (m_repaintCount < cRepaintRectUnionThreshold)
-            m_repaintRects.append(paintRect);
-        else
-            m_repaintRects[0].unite(paintRect);
+        addDeferredRepaintRect(paintRect);
         m_repaintCount++;
     
         if (!m_deferringRepaints && !m_deferredRepaintTimer.isActive())
@@ -1157,7 +1198,7 @@ void FrameView::scheduleRelayout()
     if (m_frame->settings()->frameSetFlatteningEnabled() && m_frame->ownerRenderer())
         m_frame->ownerRenderer()->setNeedsLayout(true, true);
 
-    int delay = m_frame->document()->minimumLayoutDelay();
+    int delay = relayoutDelay();
     if (m_layoutTimer.isActive() && m_delayedLayout && !delay)
         unscheduleRelayout();
     if (m_layoutTimer.isActive())
@@ -1211,7 +1252,7 @@ void FrameView::scheduleRelayoutOfSubtree(RenderObject* relayoutRoot)
             }
         }
     } else {
-        int delay = m_frame->document()->minimumLayoutDelay();
+        int delay = relayoutDelay();
         m_layoutRoot = relayoutRoot;
         m_delayedLayout = delay != 0;
         m_layoutTimer.startOneShot(delay * 0.001);
@@ -1223,6 +1264,19 @@ bool FrameView::layoutPending() const
     return m_layoutTimer.isActive();
 }
 
+bool FrameView::isDeferringLayoutBelowTheFold() const
+{
+    return m_viewportFilledWhileParsing && m_frame->document()->parsing();
+}
+
+int FrameView::relayoutDelay()
+{
+    int delay = m_frame->document()->minimumLayoutDelay();
+    if (isDeferringLayoutBelowTheFold())
+        delay = max(delay, belowTheFoldLayoutDelayDuringParsing);
+    return delay;
+}
+
 bool FrameView::needsLayout() const
 {
     // This can return true in cases where the document does not have a body yet.
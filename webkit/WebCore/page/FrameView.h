@@ -64,6 +64,12 @@ public:
     void scheduleRelayoutOfSubtree(RenderObject*);
     void unscheduleRelayout();
     bool layoutPending() const;
+    // While the document is being parsed and its content already reaches
+    // below the viewport, the layout timer waits longer, so that content
+    // arriving below the fold is laid out in fewer, larger slices. Layouts
+    // that are forced, such as by scripts asking for offsetTop, still
+    // happen right away.
+    bool isDeferringLayoutBelowTheFold() const;
 
     RenderObject* layoutRoot(bool onlyDuringLayout = false) const;
     int layoutCount() const { return m_layoutCount; }
@@ -214,8 +220,10 @@ private:
     virtual void getTickmarks(Vector<IntRect>&) const;
 
     void deferredRepaintTimerFired(Timer<FrameView>*);
+    void addDeferredRepaintRect(const IntRect&);
     void doDeferredRepaints();
     void updateDeferredRepaintDelay();
+    int relayoutDelay();
     double adjustedDeferredRepaintDelay() const;
 
     bool updateWidgets();
@@ -251,6 +259,7 @@ private:
 
     Timer<FrameView> m_layoutTimer;
     bool m_delayedLayout;
+    bool m_viewportFilledWhileParsing;
     RenderObject* m_layoutRoot;
     
     bool m_layoutSchedulingEnabled;
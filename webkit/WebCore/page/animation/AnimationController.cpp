@@ -19,6 +19,8 @@ namespace WebCore {
 
 static const double cAnimationTimerDelay = 0.025;
 static const double cBeginAnimationUpdateTimeNotSet = -1;
+// Stop waiting for a pending frame after this long, in case it was dropped.
+static const double cMaximumFramePendingTime = 0.1;
 
 AnimationControllerPrivate::AnimationControllerPrivate(Frame* frame)
     : m_animationTimer(this, &AnimationControllerPrivate::animationTimerFired)
@@ -30,6 +32,9 @@ AnimationControllerPrivate::AnimationControllerPrivate(Frame* frame)
     , m_responseWaiters(0)
     , m_lastResponseWaiter(0)
     , m_waitingForResponse(false)
+    , m_framePendingTime(0)
+    , m_skippedTick(false)
+    , m_skippedTicks(0)
 {
 }
 
@@ -158,8 +163,39 @@ void AnimationControllerPrivate::addNodeChangeToDispatch(PassRefPtr<Node> node)
     startUpdateStyleIfNeededDispatcher();
 }
 
+void AnimationControllerPrivate::framePending()
+{
+    if (!m_framePendingTime)
+        m_framePendingTime = currentTime();
+}
+
+void AnimationControllerPrivate::frameDrawn()
+{
+    m_framePendingTime = 0;
+    if (!m_skippedTick)
+        return;
+
+    m_skippedTick = false;
+    m_animationTimer.startOneShot(0);
+}
+
 void AnimationControllerPrivate::animationTimerFired(Timer<AnimationControllerPrivate>*)
 {
+    // The style this tick produces couldn't be drawn before the pending
+    // frame anyway; leave it to frameDrawn().
+    if (m_framePendingTime) {
+        if (currentTime() - m_framePendingTime < cMaximumFramePendingTime) {
+            m_skippedTick = true;
+            ++m_skippedTicks;
+            // Keep ticking in case the frame never gets drawn.
+            if (!m_animationTimer.isActive())
+                m_animationTimer.startOneShot(cAnimationTimerDelay);
+            return;
+        }
+        m_framePendingTime = 0;
+    }
+    m_skippedTick = false;
+
     // Make sure animationUpdateTime is updated, so that it is current even if no
     // styleChange has happened (e.g. accelerated animations)
     setBeginAnimationUpdateTime(cBeginAnimationUpdateTimeNotSet);
@@ -517,6 +553,21 @@ void AnimationController::endAnimationUpdate()
     m_data->endAnimationUpdate();
 }
 
+void AnimationController::framePending()
+{
+    m_data->framePending();
+}
+
+void AnimationController::frameDrawn()
+{
+    m_data->frameDrawn();
+}
+
+unsigned AnimationController::skippedTicks() const
+{
+    return m_data->skippedTicks();
+}
+
 bool AnimationController::supportsAcceleratedAnimationOfProperty(CSSPropertyID property)
 {
 #if USE(ACCELERATED_COMPOSITING)
@@ -42,6 +42,14 @@ public:
 
     void beginAnimationUpdate();
     void endAnimationUpdate();
+
+    // Lets the embedder keep software animations in step with drawing.
+    // Between framePending() and frameDrawn(), animation ticks are skipped
+    // instead of changing style for a frame that can't be shown yet.
+    // frameDrawn() runs a skipped tick straight away.
+    void framePending();
+    void frameDrawn();
+    unsigned skippedTicks() const; // Ticks skipped waiting for a frame
     
     static bool supportsAcceleratedAnimationOfProperty(CSSPropertyID);
 
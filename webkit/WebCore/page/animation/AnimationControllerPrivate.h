@@ -63,6 +63,10 @@ public:
     void addToStartTimeResponseWaitList(AnimationBase*, bool willGetResponse);
     void removeFromStartTimeResponseWaitList(AnimationBase*);    
     void startTimeResponse(double t);
+
+    void framePending();
+    void frameDrawn();
+    unsigned skippedTicks() const { return m_skippedTicks; }
     
 private:
     void styleAvailable();
@@ -92,6 +96,10 @@ private:
     AnimationBase* m_responseWaiters;
     AnimationBase* m_lastResponseWaiter;
     bool m_waitingForResponse;
+
+    double m_framePendingTime; // 0 when no frame is waiting to be drawn
+    bool m_skippedTick;
+    unsigned m_skippedTicks;
 };
 
 } // namespace WebCore
@@ -190,7 +190,20 @@ void FinishArenaPool(ArenaPool *pool)
     FreeArenaList(pool, &pool->first, true);
 }
 
-#ifdef ANDROID_INSTRUMENT
+void FreeArenaFreeList()
+{
+    Arena* a = arena_freelist;
+    while (a) {
+        Arena* next = a->next;
+        CLEAR_ARENA(a);
+        fastFree(a);
+        a = next;
+    }
+    arena_freelist = 0;
+    freelist_count = 0;
+}
+
+#if PLATFORM(ANDROID)
 size_t ReportPoolSize(const ArenaPool* pool)
 {
     size_t total = 0;
@@ -27,6 +27,8 @@ void InitArenaPool(ArenaPool *pool, const char *name,
                    unsigned int size, unsigned int align);
 void FinishArenaPool(ArenaPool *pool);
 void FreeArenaPool(ArenaPool *pool);
+// Frees the arenas that pools gave back for reuse by other pools.
+void FreeArenaFreeList();
 void* ArenaAllocate(ArenaPool *pool, unsigned int nb);
 
 #define ARENA_ALIGN(pool, n) (((uword)(n) + ARENA_ALIGN_MASK) & ~ARENA_ALIGN_MASK)
@@ -88,7 +90,7 @@ void* ArenaAllocate(ArenaPool *pool, unsigned int nb);
          fastFree(a); \
          (a) = 0;
 
-#ifdef ANDROID_INSTRUMENT
+#if PLATFORM(ANDROID)
 size_t ReportPoolSize(const ArenaPool* pool);
 #endif
 
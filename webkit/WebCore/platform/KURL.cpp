@@ -983,6 +983,18 @@ static int copyPathRemovingDots(char* dst, const char* src, int srcStart, int sr
     return dst - bufferPathStart;
 }
 
+// Whether appendEscapingBadChars would copy the characters unchanged.
+static inline bool isCanonicalPath(const char* str, size_t length)
+{
+    const char* end = str + length;
+    for (; str < end; ++str) {
+        unsigned char c = *str;
+        if (isBadChar(c) && c != '%' && c != '?')
+            return false;
+    }
+    return true;
+}
+
 static inline bool hasSlashDotOrDotDot(const char* str)
 {
     const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
@@ -1178,6 +1190,37 @@ void KURL::parse(const char* url, const String* originalString)
             fragmentEnd++;
     }
 
+    // Most http(s) URLs are already canonical. Then the original string
+    // can be kept, and its ranges used as they are.
+    if (originalString && m_protocolInHTTPFamily && static_cast<int>(originalString->length()) == fragmentEnd
+            && hostStart == userStart && hostStart != hostEnd && url[pathStart] == '/'
+            && isCanonicalPath(url + pathStart, fragmentEnd - pathStart) && !hasSlashDotOrDotDot(url)) {
+#if PLATFORM(ANDROID)
+        // The host would lose a trailing '.'.
+        if (url[pathStart - 1] != '.')
+#endif
+        {
+            m_string = *originalString;
+            m_schemeEnd = schemeEnd;
+            m_userStart = userStart;
+            m_userEnd = userStart;
+            m_passwordEnd = userStart;
+            m_hostEnd = hostEnd;
+            m_portEnd = portEnd;
+            m_pathEnd = pathEnd;
+            int i;
+            for (i = pathEnd; i > portEnd; --i) {
+                if (url[i - 1] == '/')
+                    break;
+            }
+            m_pathAfterLastSlash = i;
+            m_queryEnd = queryEnd;
+            m_fragmentEnd = fragmentEnd;
+            m_isValid = true;
+            return;
+        }
+    }
+
     // assemble it all, remembering the real ranges
 
     Vector<char, 4096> buffer(fragmentEnd * 3 + 1);
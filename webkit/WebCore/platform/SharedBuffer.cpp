@@ -5,6 +5,10 @@
 
 #include "PurgeableBuffer.h"
 
+#if HAVE(MMAP)
+#include <sys/mman.h>
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -34,17 +38,26 @@ static inline void freeSegment(char* p)
 
 SharedBuffer::SharedBuffer()
     : m_size(0)
+    , m_mappedRegion(0)
+    , m_mappedRegionLength(0)
+    , m_mappedData(0)
 {
 }
 
 SharedBuffer::SharedBuffer(const char* data, int size)
     : m_size(0)
+    , m_mappedRegion(0)
+    , m_mappedRegionLength(0)
+    , m_mappedData(0)
 {
     append(data, size);
 }
 
 SharedBuffer::SharedBuffer(const unsigned char* data, int size)
     : m_size(0)
+    , m_mappedRegion(0)
+    , m_mappedRegionLength(0)
+    , m_mappedData(0)
 {
     append(reinterpret_cast<const char*>(data), size);
 }
@@ -70,6 +83,31 @@ PassRefPtr<SharedBuffer> SharedBuffer::adoptPurgeableBuffer(PurgeableBuffer* pur
     return buffer.release();
 }
 
+#if HAVE(MMAP)
+PassRefPtr<SharedBuffer> SharedBuffer::adoptMappedRegion(void* region, size_t regionLength, unsigned offset, unsigned size)
+{
+    ASSERT(offset + size <= regionLength);
+    RefPtr<SharedBuffer> buffer = create();
+    buffer->m_mappedRegion = region;
+    buffer->m_mappedRegionLength = regionLength;
+    buffer->m_mappedData = static_cast<const char*>(region) + offset;
+    buffer->m_size = size;
+    return buffer.release();
+}
+#endif
+
+void SharedBuffer::unmapRegion() const
+{
+    if (!m_mappedRegion)
+        return;
+#if HAVE(MMAP)
+    munmap(m_mappedRegion, m_mappedRegionLength);
+#endif
+    m_mappedRegion = 0;
+    m_mappedRegionLength = 0;
+    m_mappedData = 0;
+}
+
 unsigned SharedBuffer::size() const
 {
     if (hasPlatformData())
@@ -88,6 +126,9 @@ const char* SharedBuffer::data() const
     
     if (m_purgeableBuffer)
         return m_purgeableBuffer->data();
+
+    if (m_mappedData)
+        return m_mappedData;
     
     return buffer().data();
 }
@@ -97,6 +138,8 @@ void SharedBuffer::append(const char* data, unsigned length)
     ASSERT(!m_purgeableBuffer);
 
     maybeTransferPlatformData();
+    if (m_mappedData)
+        buffer();
     
     unsigned positionInSegment = offsetInSegment(m_size - m_buffer.size());
     m_size += length;
@@ -142,12 +185,13 @@ void SharedBuffer::clear()
 
     m_buffer.clear();
     m_purgeableBuffer.clear();
+    unmapRegion();
 }
 
 PassRefPtr<SharedBuffer> SharedBuffer::copy() const
 {
     RefPtr<SharedBuffer> clone(adoptRef(new SharedBuffer));
-    if (m_purgeableBuffer || hasPlatformData()) {
+    if (m_purgeableBuffer || m_mappedData || hasPlatformData()) {
         clone->append(data(), size());
         return clone;
     }
@@ -168,6 +212,13 @@ PurgeableBuffer* SharedBuffer::releasePurgeableBuffer()
 
 const Vector<char>& SharedBuffer::buffer() const
 {
+    if (m_mappedData) {
+        ASSERT(m_buffer.isEmpty());
+        m_buffer.append(m_mappedData, m_size);
+        unmapRegion();
+        return m_buffer;
+    }
+
     unsigned bufferSize = m_buffer.size();
     if (m_size > bufferSize) {
         m_buffer.resize(m_size);
@@ -187,7 +238,7 @@ const Vector<char>& SharedBuffer::buffer() const
 
 unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) const
 {
-    if (hasPlatformData() || m_purgeableBuffer) {
+    if (hasPlatformData() || m_purgeableBuffer || m_mappedData) {
         someData = data() + position;
         return size() - position;
     }
@@ -38,6 +38,13 @@ public:
     // The buffer must be in non-purgeable state before adopted to a SharedBuffer. 
     // It will stay that way until released.
     static PassRefPtr<SharedBuffer> adoptPurgeableBuffer(PurgeableBuffer* buffer);
+
+#if HAVE(MMAP)
+    // Takes over a region returned by mmap(), of which the buffer holds the
+    // size bytes starting at offset. The region is unmapped when the buffer
+    // is cleared or its contents are flattened by buffer().
+    static PassRefPtr<SharedBuffer> adoptMappedRegion(void* region, size_t regionLength, unsigned offset, unsigned size);
+#endif
     
 #if PLATFORM(ANDROID)
     virtual
@@ -106,11 +113,17 @@ private:
     void clearPlatformData();
     void maybeTransferPlatformData();
     bool hasPlatformData() const;
+
+    void unmapRegion() const;
     
     unsigned m_size;
     mutable Vector<char> m_buffer;
     mutable Vector<char*> m_segments;
     OwnPtr<PurgeableBuffer> m_purgeableBuffer;
+    // set by adoptMappedRegion(); m_mappedData points into m_mappedRegion
+    mutable void* m_mappedRegion;
+    mutable size_t m_mappedRegionLength;
+    mutable const char* m_mappedData;
 #if PLATFORM(CF)
     SharedBuffer(CFDataRef);
     RetainPtr<CFDataRef> m_cfData;
@@ -259,6 +259,9 @@ void TimerBase::setNextFireTime(double newTime)
 {
     ASSERT(m_thread == currentThread());
 
+    if (newTime)
+        newTime = alignedFireTime(newTime);
+
     // Keep heap valid while changing the next-fire time.
     double oldTime = m_nextFireTime;
     if (oldTime != newTime) {
@@ -32,6 +32,11 @@ public:
 
     static void fireTimersInNestedEventLoop();
 
+protected:
+    // Lets a subclass move the times it fires at, for instance to share
+    // wakeups with other timers. Called with m_repeatInterval already set.
+    virtual double alignedFireTime(double fireTime) const { return fireTime; }
+
 private:
     virtual void fired() = 0;
 
@@ -19,6 +19,12 @@ using namespace std;
 
 namespace WebCore {
 
+// Positions are passed on at most this often, in seconds, however often the
+// providers report them or the requests allow.
+static const double minimumUpdateInterval = 1;
+// and at least this often, when there is a new position
+static const double maximumUpdateInterval = 60;
+
 // GeolocationServiceAndroid is the Android implmentation of Geolocation
 // service. Each object of this class owns an object of type
 // GeolocationServiceBridge, which in turn owns a Java GeolocationService
@@ -39,6 +45,10 @@ GeolocationServiceAndroid::GeolocationServiceAndroid(GeolocationServiceClient* c
     : GeolocationService(client)
     , m_timer(this, &GeolocationServiceAndroid::timerFired)
     , m_javaBridge(0)
+    , m_lastUpdateTime(0)
+    , m_updateInterval(maximumUpdateInterval)
+    , m_wantsHighAccuracy(false)
+    , m_suspended(false)
 {
 }
 
@@ -60,21 +70,21 @@ bool GeolocationServiceAndroid::startUpdating(PositionOptions* options, bool sus
         m_javaBridge.set(new GeolocationServiceBridge(this));
     ASSERT(m_javaBridge);
 
+    ASSERT(options);
+    m_updateInterval = min(m_updateInterval, updateIntervalFor(options));
+
     // On Android, high power == GPS. Set whether to use GPS before we start the
     // implementation.
-    ASSERT(options);
     if (options->enableHighAccuracy())
-        m_javaBridge->setEnableGps(true);
-
-    // We need only start the service when it's first created.
-    if (!haveJavaBridge) {
-        // If the browser is paused, don't start the service. It will be started
-        // when we get the call to resume.
-        // ANDROID
-        // TODO: Upstream to webkit.org. See https://bugs.webkit.org/show_bug.cgi?id=34082
-        if (!suspend)
-            m_javaBridge->start();
-    }
+        m_wantsHighAccuracy = true;
+    if (!haveJavaBridge)
+        m_suspended = suspend;
+    updateGps();
+
+    // We need only start the service when it's first created. If the browser
+    // is paused, it runs without GPS until we get the call to resume.
+    if (!haveJavaBridge)
+        m_javaBridge->start();
 
     return true;
 }
@@ -88,39 +98,80 @@ void GeolocationServiceAndroid::stopUpdating()
     // new position from the system service when a request is first made.
     m_lastPosition = 0;
     m_lastError = 0;
+    m_pendingPosition = 0;
+    m_lastUpdateTime = 0;
+    m_updateInterval = maximumUpdateInterval;
+    m_wantsHighAccuracy = false;
+    m_suspended = false;
     // remove the pending timer
     if (m_timer.isActive())
         m_timer.stop();
 }
 
+// Rather than stopping, fall back to the network provider, which costs
+// little, so that there is a position as soon as the page resumes.
 void GeolocationServiceAndroid::suspend()
 {
-    if (m_javaBridge)
-        m_javaBridge->stop();
+    m_suspended = true;
+    updateGps();
+    if (m_pendingPosition && m_timer.isActive())
+        m_timer.stop();
 }
 
 void GeolocationServiceAndroid::resume()
+{
+    m_suspended = false;
+    updateGps();
+    if (m_pendingPosition)
+        schedulePositionUpdate();
+}
+
+void GeolocationServiceAndroid::updateGps()
 {
     if (m_javaBridge)
-        m_javaBridge->start();
+        m_javaBridge->setEnableGps(m_wantsHighAccuracy && !m_suspended);
 }
 
 // Note that there is no guarantee that subsequent calls to this method offer a
 // more accurate or updated position.
-void GeolocationServiceAndroid::newPositionAvailable(PassRefPtr<Geoposition> position)
+void GeolocationServiceAndroid::newPositionAvailable(PassRefPtr<Geoposition> prpPosition)
 {
+    RefPtr<Geoposition> position = prpPosition;
     ASSERT(position);
-    if (!m_lastPosition
-        || isPositionMovement(m_lastPosition.get(), position.get())
-        || isPositionMoreAccurate(m_lastPosition.get(), position.get())
-        || isPositionMoreTimely(m_lastPosition.get(), position.get())) {
-        m_lastPosition = position;
-        // Remove the last error.
-        m_lastError = 0;
-        positionChanged();
+    if (m_pendingPosition) {
+        if (isPositionBetter(m_pendingPosition.get(), position.get()))
+            m_pendingPosition = position.release();
+        return;
+    }
+    if (!m_lastPosition || isPositionBetter(m_lastPosition.get(), position.get())) {
+        m_pendingPosition = position.release();
+        schedulePositionUpdate();
     }
 }
 
+void GeolocationServiceAndroid::schedulePositionUpdate()
+{
+    ASSERT(m_pendingPosition);
+    if (m_suspended)
+        return;
+    double delay = m_lastUpdateTime + m_updateInterval - WTF::currentTime();
+    if (delay <= 0) {
+        if (m_timer.isActive())
+            m_timer.stop();
+        deliverPendingPosition();
+    } else if (!m_timer.isActive())
+        m_timer.startOneShot(delay);
+}
+
+void GeolocationServiceAndroid::deliverPendingPosition()
+{
+    m_lastPosition = m_pendingPosition.release();
+    // Remove the last error.
+    m_lastError = 0;
+    m_lastUpdateTime = WTF::currentTime();
+    positionChanged();
+}
+
 void GeolocationServiceAndroid::newErrorAvailable(PassRefPtr<PositionError> error)
 {
     ASSERT(error);
@@ -132,8 +183,11 @@ void GeolocationServiceAndroid::newErrorAvailable(PassRefPtr<PositionError> erro
 void GeolocationServiceAndroid::timerFired(Timer<GeolocationServiceAndroid>* timer)
 {
     ASSERT(&m_timer == timer);
-    ASSERT(m_lastPosition || m_lastError);
-    if (m_lastPosition)
+    ASSERT(m_pendingPosition || m_lastPosition || m_lastError);
+    // A new request takes the pending position now rather than waiting.
+    if (m_pendingPosition && !m_suspended)
+        deliverPendingPosition();
+    else if (m_lastPosition)
         positionChanged();
     else if (m_lastError)
         errorOccurred();
@@ -155,6 +209,23 @@ bool GeolocationServiceAndroid::isPositionMovement(Geoposition* position1, Geopo
     return delta > maxAccuracy;
 }
 
+bool GeolocationServiceAndroid::isPositionBetter(Geoposition* position1, Geoposition* position2)
+{
+    return isPositionMovement(position1, position2)
+        || isPositionMoreAccurate(position1, position2)
+        || isPositionMoreTimely(position1, position2);
+}
+
+// A request that accepts positions up to maximumAge old doesn't need them
+// more often than that, but should get one within its timeout.
+double GeolocationServiceAndroid::updateIntervalFor(PositionOptions* options)
+{
+    double interval = options->hasMaximumAge() ? options->maximumAge() / 1000.0 : maximumUpdateInterval;
+    if (options->hasTimeout())
+        interval = min(interval, options->timeout() / 2000.0);
+    return max(minimumUpdateInterval, min(interval, maximumUpdateInterval));
+}
+
 bool GeolocationServiceAndroid::isPositionMoreAccurate(Geoposition* position1, Geoposition* position2)
 {
     ASSERT(position1 && position2);
@@ -44,11 +44,29 @@ private:
     static bool isPositionMovement(Geoposition* position1, Geoposition* position2);
     static bool isPositionMoreAccurate(Geoposition* position1, Geoposition* position2);
     static bool isPositionMoreTimely(Geoposition* position1, Geoposition* position2);
+    static bool isPositionBetter(Geoposition* position1, Geoposition* position2);
+    static double updateIntervalFor(PositionOptions*);
+
+    void updateGps();
+    void schedulePositionUpdate();
+    void deliverPendingPosition();
 
     Timer<GeolocationServiceAndroid> m_timer;
     RefPtr<Geoposition> m_lastPosition;
     RefPtr<PositionError> m_lastError;
     OwnPtr<GeolocationServiceBridge> m_javaBridge;
+    // The best position received since the last one was passed on. The
+    // providers can report several times a second, and both GPS and network
+    // report, so they are coalesced into one update per interval; watchers
+    // all get that update together.
+    RefPtr<Geoposition> m_pendingPosition;
+    double m_lastUpdateTime;
+    // The shortest interval the requests since updating started allow
+    double m_updateInterval;
+    bool m_wantsHighAccuracy;
+    // While the WebView is paused, only the network provider runs, and
+    // positions are held until it resumes.
+    bool m_suspended;
 };
 
 } // namespace WebCore
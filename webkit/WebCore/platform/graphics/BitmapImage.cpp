@@ -68,9 +68,15 @@ void BitmapImage::destroyDecodedData(bool destroyAll)
 
 void BitmapImage::destroyDecodedDataIfNecessary(bool destroyAll)
 {
+#if PLATFORM(ANDROID)
+    // Keep only a few frames of any animation. Past that we hold just the
+    // frames the decoder needs to composite the next one.
+    static const unsigned cLargeAnimationCutoff = 1048576;
+#else
     // Animated images >5MB are considered large enough that we'll only hang on
     // to one frame at a time.
     static const unsigned cLargeAnimationCutoff = 5242880;
+#endif
     if (m_frames.size() * frameBytes(m_size) > cLargeAnimationCutoff)
         destroyDecodedData(destroyAll);
 }
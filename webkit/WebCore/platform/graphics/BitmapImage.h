@@ -125,6 +125,9 @@ public:
 
 #if PLATFORM(ANDROID)
     virtual void setURL(const String& str);
+    // True for an animation that is not running, e.g. because it was paused
+    // while out of view. Drawing it again restarts it.
+    bool isAnimationSuspended() const { return !m_frameTimer && !m_animationFinished && m_frameCount > 1; }
 #endif
 
 #if PLATFORM(GTK)
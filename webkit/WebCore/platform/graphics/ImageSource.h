@@ -59,6 +59,8 @@ struct NativeImageSourcePtr {
     PrivateAndroidImageSourceRec* m_image;
 #ifdef ANDROID_ANIMATED_GIF
     ImageDecoder* m_gifDecoder;
+    // JPEG or PNG decoder that keeps its state while the data streams in
+    ImageDecoder* m_streamDecoder;
 #endif
 };
 typedef const Vector<char>* NativeBytePtr;
@@ -144,6 +146,13 @@ public:
 #if PLATFORM(ANDROID)
     void clearURL();
     void setURL(const String& url);
+    // Chooses the sample size from the largest size the whole image has been
+    // drawn at, in device pixels before the decode scale. Returns true if
+    // the frame's bitmap now has different dimensions.
+    bool setDisplaySize(float width, float height);
+    // Sets the zoom images are decoded for. Returns true if it grew and some
+    // images were decoded smaller, so they should be drawn again.
+    static bool setDecodeScale(float scale);
 #endif
 private:
 #if PLATFORM(ANDROID)
@@ -47,6 +47,9 @@ namespace WebCore {
     class FloatRect;
     class FloatSize;
     class GraphicsContext;
+#if PLATFORM(ANDROID)
+    class PathCache;
+#endif
     class String;
     class StrokeStyleApplier;
 
@@ -78,7 +81,11 @@ namespace WebCore {
         Path(const Path&);
         Path& operator=(const Path&);
 
+#if PLATFORM(ANDROID)
+        void swap(Path& other) { std::swap(m_path, other.m_path); std::swap(m_cache, other.m_cache); }
+#else
         void swap(Path& other) { std::swap(m_path, other.m_path); }
+#endif
 
         bool contains(const FloatPoint&, WindRule rule = RULE_NONZERO) const;
         bool strokeContains(StrokeStyleApplier*, const FloatPoint&) const;
@@ -124,6 +131,12 @@ namespace WebCore {
 
     private:
         PlatformPathPtr m_path;
+#if PLATFORM(ANDROID)
+        void invalidateCache();
+
+        // Geometry derived from m_path, dropped whenever it changes
+        mutable PathCache* m_cache;
+#endif
     };
 
 }
@@ -62,6 +62,10 @@ public:
 
     float widthForGlyph(Glyph) const;
     float platformWidthForGlyph(Glyph) const;
+#if PLATFORM(ANDROID)
+    // Lets GlyphPage::fill record the widths it measures in bulk.
+    void setWidthForGlyph(Glyph glyph, float width) const { m_glyphToWidthMap.setWidthForGlyph(glyph, width); }
+#endif
 
     float spaceWidth() const { return m_spaceWidth; }
     float adjustedSpaceWidth() const { return m_adjustedSpaceWidth; }
@@ -35,6 +35,7 @@ AndroidAnimation::AndroidAnimation(const Animation* animation,
     if (!static_cast<int>(beginTime)) // time not set
         m_beginTime = WTF::currentTime();
 
+    buildTimingTable();
     gDebugAndroidAnimationInstances++;
 }
 
@@ -46,6 +47,7 @@ AndroidAnimation::AndroidAnimation(AndroidAnimation* anim) :
     m_direction(anim->m_direction),
     m_timingFunction(anim->m_timingFunction)
 {
+    memcpy(m_timingTable, anim->m_timingTable, sizeof(m_timingTable));
     gDebugAndroidAnimationInstances++;
 }
 
@@ -54,6 +56,36 @@ AndroidAnimation::~AndroidAnimation()
     gDebugAndroidAnimationInstances--;
 }
 
+void AndroidAnimation::buildTimingTable()
+{
+    if (m_timingFunction.type() == LinearTimingFunction)
+        return;
+
+    UnitBezier bezier(m_timingFunction.x1(),
+                      m_timingFunction.y1(),
+                      m_timingFunction.x2(),
+                      m_timingFunction.y2());
+    // Interpolating between the samples is a larger error than this.
+    const double epsilon = 1.0 / (200.0 * timingTableSegments);
+    for (int i = 0; i <= timingTableSegments; ++i)
+        m_timingTable[i] = bezier.solve(static_cast<double>(i) / timingTableSegments, epsilon);
+}
+
+float AndroidAnimation::timedProgress(float progress) const
+{
+    if (m_timingFunction.type() == LinearTimingFunction)
+        return progress;
+
+    float position = progress * timingTableSegments;
+    if (position <= 0)
+        return m_timingTable[0];
+    int index = static_cast<int>(position);
+    if (index >= timingTableSegments)
+        return m_timingTable[timingTableSegments];
+    float fraction = position - index;
+    return m_timingTable[index] + (m_timingTable[index + 1] - m_timingTable[index]) * fraction;
+}
+
 float AndroidAnimation::currentProgress(double time)
 {
     if (m_beginTime <= 0.000001) // overflow or not correctly set
@@ -86,16 +118,7 @@ bool AndroidAnimation::checkIterationsAndProgress(double time, float* finalProgr
           && (m_iterationCount != Animation::IterationCountInfinite))
         return false;
 
-    if (m_timingFunction.type() != LinearTimingFunction) {
-        UnitBezier bezier(m_timingFunction.x1(),
-                          m_timingFunction.y1(),
-                          m_timingFunction.x2(),
-                          m_timingFunction.y2());
-        if (m_duration > 0)
-            progress = bezier.solve(progress, 1.0f / (200.0f * m_duration));
-    }
-
-    *finalProgress = progress;
+    *finalProgress = timedProgress(progress);
     return true;
 }
 
@@ -133,7 +156,7 @@ void AndroidOpacityAnimation::swapDirection()
 {
     float v = m_toValue;
     m_toValue = m_fromValue;
-    m_fromValue = m_toValue;
+    m_fromValue = v;
 }
 
 bool AndroidOpacityAnimation::evaluate(LayerAndroid* layer, double time)
@@ -35,6 +35,12 @@ class AndroidAnimation : public RefCounted<AndroidAnimation> {
     String name() { return m_name; }
 
   protected:
+    // The timing function's curve sampled at evenly spaced progress values,
+    // so that each frame costs a lookup rather than solving the bezier.
+    static const int timingTableSegments = 64;
+    void buildTimingTable();
+    float timedProgress(float progress) const;
+
     double m_beginTime;
     double m_elapsedTime;
     double m_duration;
@@ -42,6 +48,7 @@ class AndroidAnimation : public RefCounted<AndroidAnimation> {
     int m_currentIteration;
     int m_direction;
     TimingFunction m_timingFunction;
+    float m_timingTable[timingTableSegments + 1];
     String m_name;
 };
 
@@ -3,20 +3,152 @@
 #include "config.h"
 #include "BitmapAllocatorAndroid.h"
 #include "SharedBufferStream.h"
+#include "SkImageDecoder.h"
 #include "SkImageRef_GlobalPool.h"
 #include "SkImageRef_ashmem.h"
+#include "SkThread.h"
 
 // made this up, so we don't waste a file-descriptor on small images, plus
 // we don't want to lose too much on the round-up to a page size (4K)
 #define MIN_ASHMEM_ALLOC_SIZE   (32*1024)
 
+// 0 until the cache capacity is known
+static size_t gDecodedBudget;
 
 static bool should_use_ashmem(const SkBitmap& bm) {
-    return bm.getSize() >= MIN_ASHMEM_ALLOC_SIZE;
+    return !gDecodedBudget && bm.getSize() >= MIN_ASHMEM_ALLOC_SIZE;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Free pixel buffers waiting to be reused. Sizes are rounded up to a size
+// class (4K pages, then eighths of a power of two), so a
+// buffer fits any image that rounds to the same class. Pixel refs can be
+// freed from the UI thread, hence the mutex.
+#define POOL_MAX_BUFFERS    16
+#define POOL_MAX_BYTES      (2*1024*1024)
+#define POOL_PAGE_SIZE      (4*1024)
+
+static SkMutex  gPoolMutex;
+static void*    gPoolBuffers[POOL_MAX_BUFFERS];
+static size_t   gPoolSizes[POOL_MAX_BUFFERS];
+static int      gPoolCount;
+static size_t   gPoolBytes;
+
+static size_t pool_size_class(size_t size) {
+    size = (size + POOL_PAGE_SIZE - 1) & ~(POOL_PAGE_SIZE - 1);
+    if (size <= 16 * POOL_PAGE_SIZE)
+        return size;
+    // round up to an eighth of the next power of two, which loses at most a
+    // quarter of the buffer
+    size_t pow2 = 16 * POOL_PAGE_SIZE;
+    while (pow2 < size)
+        pow2 <<= 1;
+    size_t step = pow2 >> 3;
+    return (size + step - 1) & ~(step - 1);
+}
+
+static void* pool_acquire(size_t size) {
+    {
+        SkAutoMutexAcquire ac(gPoolMutex);
+        for (int i = gPoolCount - 1; i >= 0; i--) {
+            if (gPoolSizes[i] == size) {
+                void* addr = gPoolBuffers[i];
+                gPoolBytes -= size;
+                gPoolCount--;
+                gPoolBuffers[i] = gPoolBuffers[gPoolCount];
+                gPoolSizes[i] = gPoolSizes[gPoolCount];
+                return addr;
+            }
+        }
+    }
+    return sk_malloc_flags(size, 0);
+}
+
+static void pool_release(void* addr, size_t size) {
+    {
+        SkAutoMutexAcquire ac(gPoolMutex);
+        if (size <= POOL_MAX_BYTES / 4 && gPoolCount < POOL_MAX_BUFFERS
+                && gPoolBytes + size <= POOL_MAX_BYTES) {
+            gPoolBuffers[gPoolCount] = addr;
+            gPoolSizes[gPoolCount] = size;
+            gPoolCount++;
+            gPoolBytes += size;
+            return;
+        }
+    }
+    sk_free(addr);
+}
+
+class PooledPixelRef : public SkPixelRef {
+public:
+    PooledPixelRef(void* addr, size_t size, SkColorTable* ctable)
+        : fStorage(addr), fSize(size), fCTable(ctable) {
+        ctable->safeRef();
+    }
+
+    virtual ~PooledPixelRef() {
+        pool_release(fStorage, fSize);
+        fCTable->safeUnref();
+    }
+
+protected:
+    virtual void* onLockPixels(SkColorTable** ct) {
+        *ct = fCTable;
+        return fStorage;
+    }
+
+    virtual void onUnlockPixels() {}
+
+private:
+    void*           fStorage;
+    size_t          fSize;
+    SkColorTable*   fCTable;
+};
+
+class PooledAllocator : public SkBitmap::Allocator {
+public:
+    virtual bool allocPixelRef(SkBitmap* bitmap, SkColorTable* ctable) {
+        size_t size = bitmap->getSize();
+        if (!size)
+            return false;
+        size = pool_size_class(size);
+        void* addr = pool_acquire(size);
+        if (!addr)
+            return false;
+        bitmap->setPixelRef(new PooledPixelRef(addr, size, ctable))->unref();
+        // since we're already allocated, we lockPixels right away
+        bitmap->lockPixels();
+        return true;
+    }
+};
+
+static PooledAllocator gPooledAllocator;
+
+// Decodes into the pool instead of straight from the heap
+class PooledImageRef : public SkImageRef_GlobalPool {
+public:
+    PooledImageRef(SkStream* stream, SkBitmap::Config config, int sampleSize)
+        : SkImageRef_GlobalPool(stream, config, sampleSize) {}
+
+protected:
+    virtual bool onDecode(SkImageDecoder* codec, SkStream* stream,
+                          SkBitmap* bitmap, SkBitmap::Config config,
+                          SkImageDecoder::Mode mode) {
+        if (mode == SkImageDecoder::kDecodePixels_Mode)
+            codec->setAllocator(&gPooledAllocator);
+        bool success = this->INHERITED::onDecode(codec, stream, bitmap,
+                                                 config, mode);
+        codec->setAllocator(NULL);
+        return success;
+    }
+
+private:
+    typedef SkImageRef_GlobalPool INHERITED;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 namespace WebCore {
 
 BitmapAllocatorAndroid::BitmapAllocatorAndroid(SharedBuffer* data,
@@ -39,10 +171,52 @@ bool BitmapAllocatorAndroid::allocPixelRef(SkBitmap* bitmap, SkColorTable*)
         ref = new SkImageRef_ashmem(fStream, bitmap->config(), fSampleSize);
     } else {
 //        SkDebugf("globalpool [%d %d]\n", bitmap->width(), bitmap->height());
-        ref = new SkImageRef_GlobalPool(fStream, bitmap->config(), fSampleSize);
+        ref = new PooledImageRef(fStream, bitmap->config(), fSampleSize);
     }
     bitmap->setPixelRef(ref)->unref();
     return true;
 }
 
+void BitmapAllocatorAndroid::setDecodedBudget(size_t bytes)
+{
+    gDecodedBudget = bytes;
+    SkImageRef_GlobalPool::SetRAMBudget(bytes);
+    // purge down to the new budget now rather than on the next decode
+    if (SkImageRef_GlobalPool::GetRAMUsed() > bytes)
+        SkImageRef_GlobalPool::SetRAMUsed(bytes);
+}
+
+SkBitmap::Allocator* BitmapAllocatorAndroid::pooledAllocator()
+{
+    return &gPooledAllocator;
+}
+
+size_t BitmapAllocatorAndroid::trimPool()
+{
+    SkAutoMutexAcquire ac(gPoolMutex);
+    while (gPoolCount > 0) {
+        gPoolCount--;
+        sk_free(gPoolBuffers[gPoolCount]);
+    }
+    size_t freed = gPoolBytes;
+    gPoolBytes = 0;
+    return freed;
+}
+
+size_t BitmapAllocatorAndroid::purgeDecoded(size_t bytes)
+{
+    // pixels purged below go to the pool if they fit, so only what the
+    // pool held before counts on top of them
+    size_t freed = trimPool();
+    size_t used = SkImageRef_GlobalPool::GetRAMUsed();
+    if (used > bytes) {
+        SkImageRef_GlobalPool::SetRAMUsed(bytes);
+        size_t remaining = SkImageRef_GlobalPool::GetRAMUsed();
+        if (used > remaining)
+            freed += used - remaining;
+        trimPool();
+    }
+    return freed;
+}
+
 }
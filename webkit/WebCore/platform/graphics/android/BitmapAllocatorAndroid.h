@@ -23,6 +23,29 @@ namespace WebCore {
         // overrides
         virtual bool allocPixelRef(SkBitmap*, SkColorTable*);
 
+        /** Caps the decoded pixels held by all images. Once set, every image
+            decodes into the global pool, which purges the least recently
+            drawn pixels past the budget. Until then, large images use
+            ashmem, which only the kernel reclaims.
+         */
+        static void setDecodedBudget(size_t bytes);
+
+        /** Returns an allocator for pixels that come and go with decodes.
+            Freed buffers are kept in a small pool, by size class, and are
+            reused by later decodes instead of going back to the heap.
+         */
+        static SkBitmap::Allocator* pooledAllocator();
+
+        /** Frees every buffer held by the pool, for memory pressure.
+            Returns the number of bytes freed.
+         */
+        static size_t trimPool();
+        /** Purges the least recently drawn pixels until decoded images
+            hold at most bytes, for memory pressure. The pool is trimmed
+            too. Returns the number of bytes freed.
+         */
+        static size_t purgeDecoded(size_t bytes);
+
     private:
         SharedBufferStream* fStream;
         int                 fSampleSize;
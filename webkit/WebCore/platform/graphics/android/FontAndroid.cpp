@@ -17,6 +17,8 @@
 #include "SkTypeface.h"
 #include "SkUtils.h"
 
+#include <wtf/Vector.h>
+
 using namespace android;
 
 namespace WebCore {
@@ -83,6 +85,95 @@ static bool setupForText(SkPaint* paint, GraphicsContext* gc,
     return true;
 }
 
+// Complex text is shaped by skia each time it is measured or hit-tested, and
+// layout measures the same line several times. Keep the results for the
+// most recently used runs, keyed by the text, the font and the direction.
+class ShapedRun {
+public:
+    ShapedRun(const TextRun& run, const FontPlatformData& font)
+        : mFont(font)
+        , mRtl(run.rtl())
+        , mWidth(-1)
+        , mHasClusters(false)
+    {
+        mText.append(run.characters(), run.length());
+    }
+
+    bool matches(const TextRun& run, const FontPlatformData& font) const
+    {
+        return mRtl == run.rtl() && (int)mText.size() == run.length()
+            && mFont == font && !memcmp(mText.data(), run.characters(),
+                                        run.length() * sizeof(UChar));
+    }
+
+    float width(const SkPaint& paint)
+    {
+        if (mWidth < 0)
+            mWidth = SkScalarToFloat(paint.measureText(mText.data(),
+                                                       mText.size() << 1));
+        return mWidth;
+    }
+
+    // The width of each cluster and the index of its first character.
+    int clusters(const SkPaint& paint, const SkScalar** widths,
+                 const int** clusterIndex)
+    {
+        if (!mHasClusters) {
+            int count = mText.size();
+            mWidths.resize(count);
+            mClusterIndex.resize(count);
+            count = paint.getComplexTextWidths(mText.data(), count << 1,
+                                               mWidths.data(),
+                                               mClusterIndex.data());
+            mWidths.shrink(count > 0 ? count : 0);
+            mClusterIndex.shrink(mWidths.size());
+            mHasClusters = true;
+        }
+        *widths = mWidths.data();
+        *clusterIndex = mClusterIndex.data();
+        return mWidths.size();
+    }
+
+private:
+    Vector<UChar>       mText;
+    FontPlatformData    mFont;
+    bool                mRtl;
+    float               mWidth;
+    bool                mHasClusters;
+    Vector<SkScalar>    mWidths;
+    Vector<int>         mClusterIndex;
+};
+
+// Only runs up to a line or so long are kept
+#define SHAPED_RUN_CACHE_SIZE   32
+#define SHAPED_RUN_MAX_LENGTH   512
+
+static ShapedRun* shapedRun(const TextRun& run, const FontPlatformData& font)
+{
+    static Vector<ShapedRun*>* cache = new Vector<ShapedRun*>;
+    if (run.length() > SHAPED_RUN_MAX_LENGTH)
+        return 0;
+    size_t size = cache->size();
+    for (size_t i = 0; i < size; i++) {
+        ShapedRun* shaped = cache->at(i);
+        if (shaped->matches(run, font)) {
+            // move to the front, the end is evicted first
+            if (i) {
+                cache->remove(i);
+                cache->prepend(shaped);
+            }
+            return shaped;
+        }
+    }
+    if (size == SHAPED_RUN_CACHE_SIZE) {
+        delete cache->last();
+        cache->removeLast();
+    }
+    ShapedRun* shaped = new ShapedRun(run, font);
+    cache->prepend(shaped);
+    return shaped;
+}
+
 bool Font::canReturnFallbackFontsForComplexText()
 {
     return false;
@@ -104,10 +195,63 @@ void Font::drawGlyphs(GraphicsContext* gc, const SimpleFontData* font,
     SkScalar                    y = SkFloatToScalar(point.y());
     const GlyphBufferGlyph*     glyphs = glyphBuffer.glyphs(from);
     const GlyphBufferAdvance*   adv = glyphBuffer.advances(from);
+
+    SkCanvas* canvas = gc->platformContext()->mCanvas;
+
+    // Horizontal text (nearly all of it) only needs the x positions, which
+    // halves the position data recorded into the picture.
+    bool horizontal = true;
+    for (int i = 0; i < numGlyphs; i++) {
+        if (adv[i].height()) {
+            horizontal = false;
+            break;
+        }
+    }
+
+    if (horizontal) {
+        SkAutoSTMalloc<32, SkScalar> storage(numGlyphs);
+        SkScalar* xpos = storage.get();
+
+        if (EmojiFont::IsAvailable()) {
+            // set filtering, to make scaled images look nice(r)
+            paint.setFilterBitmap(true);
+
+            int localIndex = 0;
+            int localCount = 0;
+            for (int i = 0; i < numGlyphs; i++) {
+                if (EmojiFont::IsEmojiGlyph(glyphs[i])) {
+                    if (localCount)
+                        canvas->drawPosTextH(&glyphs[localIndex],
+                                             localCount * sizeof(uint16_t),
+                                             &xpos[localIndex], y, paint);
+                    EmojiFont::Draw(canvas, glyphs[i], x, y, paint);
+                    // reset local index/count track for "real" glyphs
+                    localCount = 0;
+                    localIndex = i + 1;
+                } else {
+                    xpos[i] = x;
+                    localCount += 1;
+                }
+                x += SkFloatToScalar(adv[i].width());
+            }
+            // draw the last run of glyphs (if any)
+            if (localCount)
+                canvas->drawPosTextH(&glyphs[localIndex],
+                                     localCount * sizeof(uint16_t),
+                                     &xpos[localIndex], y, paint);
+        } else {
+            for (int i = 0; i < numGlyphs; i++) {
+                xpos[i] = x;
+                x += SkFloatToScalar(adv[i].width());
+            }
+            canvas->drawPosTextH(glyphs, numGlyphs * sizeof(uint16_t), xpos,
+                                 y, paint);
+        }
+        return;
+    }
+
     SkAutoSTMalloc<32, SkPoint> storage(numGlyphs);
     SkPoint*                    pos = storage.get();
-    
-    SkCanvas* canvas = gc->platformContext()->mCanvas;
 
     /*  We need an array of [x,y,x,y,x,y,...], but webkit is giving us
         point.xy + [width, height, width, height, ...], so we have to convert
@@ -202,30 +346,22 @@ void Font::drawComplexText(GraphicsContext* gc, TextRun const& run,
 float Font::floatWidthForComplexText(const TextRun& run, HashSet<const SimpleFontData*>*) const
 {
     SkPaint paint;
+    const FontPlatformData& font = primaryFont()->platformData();
 
-    primaryFont()->platformData().setupPaint(&paint);
+    font.setupPaint(&paint);
 
 //printf("--------- complext measure %d chars\n", run.to() - run.from());
 
+    if (ShapedRun* shaped = shapedRun(run, font))
+        return shaped->width(paint);
+
     SkScalar width = paint.measureText(run.characters(), run.length() << 1);
     return SkScalarToFloat(width);
 }
 
-int Font::offsetForPositionForComplexText(const TextRun& run, int x,
-                                          bool includePartialGlyphs) const
+static int offsetForPosition(const SkScalar widths[], const int clusterIndex[],
+                             int count, int x, int length)
 {
-    SkPaint                         paint;
-    int                             count = run.length();
-    SkAutoSTMalloc<64, SkScalar>    storage(count);
-    SkScalar*                       widths = storage.get();
-    SkAutoSTMalloc<64, int>    storageClusterIndex(count);
-    int*                       clusterIndex = storageClusterIndex.get();
-
-    primaryFont()->platformData().setupPaint(&paint);
-
-    //count = paint.getTextWidths(run.characters(), count << 1, widths);
-    count = paint.getComplexTextWidths(run.characters(), count << 1, widths, clusterIndex);
-
     if (count > 0)
     {
         SkScalar pos = 0;
@@ -236,7 +372,32 @@ int Font::offsetForPositionForComplexText(const TextRun& run, int x,
             pos += widths[i];
         }
     }
-    return run.length();
+    return length;
+}
+
+int Font::offsetForPositionForComplexText(const TextRun& run, int x,
+                                          bool includePartialGlyphs) const
+{
+    SkPaint                         paint;
+    int                             count = run.length();
+
+    const FontPlatformData& font = primaryFont()->platformData();
+    font.setupPaint(&paint);
+
+    const SkScalar* widths;
+    const int* clusterIndex;
+    if (ShapedRun* shaped = shapedRun(run, font))
+        count = shaped->clusters(paint, &widths, &clusterIndex);
+    else {
+        SkAutoSTMalloc<64, SkScalar>    storage(count);
+        SkAutoSTMalloc<64, int>    storageClusterIndex(count);
+        //count = paint.getTextWidths(run.characters(), count << 1, widths);
+        count = paint.getComplexTextWidths(run.characters(), count << 1,
+                                           storage.get(), storageClusterIndex.get());
+        return offsetForPosition(storage.get(), storageClusterIndex.get(),
+                                 count, x, run.length());
+    }
+    return offsetForPosition(widths, clusterIndex, count, x, run.length());
 }
 
 }
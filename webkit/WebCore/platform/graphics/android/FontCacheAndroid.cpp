@@ -9,6 +9,8 @@
 #include "SkPaint.h"
 #include "SkTypeface.h"
 #include "SkUtils.h"
+#include "StringHash.h"
+#include <wtf/HashMap.h>
 
 namespace WebCore {
 
@@ -47,6 +49,18 @@ static char* AtomicStringToUTF8String(const AtomicString& utf16)
     return utf8;
 }
 
+// Typefaces resolved by CreateFromName, one map per SkTypeface::Style. The
+// map owns a reference to each typeface. Families that are not installed
+// resolve to the default typeface and are cached the same way, so a page
+// naming several unknown fonts only resolves each of them once.
+typedef HashMap<String, SkTypeface*, CaseFoldingHash> TypefaceMap;
+
+static TypefaceMap& typefaceCache(int style)
+{
+    static TypefaceMap* caches = new TypefaceMap[4];
+    return caches[style & SkTypeface::kBoldItalic];
+}
+
 FontPlatformData* FontCache::createFontPlatformData(const FontDescription& fontDescription, const AtomicString& family)
 {
     char*       storage = 0;
@@ -75,25 +89,36 @@ FontPlatformData* FontCache::createFontPlatformData(const FontDescription& fontD
         }
         // if we fall out of the loop, its ok for name to still be 0
     }
-    else {    // convert the name to utf8
-        storage = AtomicStringToUTF8String(family);
-        name = storage;
-    }
-    
+
     int style = SkTypeface::kNormal;
     if (fontDescription.weight() >= FontWeightBold)
         style |= SkTypeface::kBold;
     if (fontDescription.italic())
         style |= SkTypeface::kItalic;
 
-    SkTypeface* tf = SkTypeface::CreateFromName(name, (SkTypeface::Style)style);
-    
+    SkTypeface* tf;
+    if (family.length() == 0)
+        tf = SkTypeface::CreateFromName(name, (SkTypeface::Style)style);
+    else {
+        // look up the named family once per style
+        TypefaceMap& cache = typefaceCache(style);
+        TypefaceMap::iterator it = cache.find(family);
+        if (it != cache.end())
+            tf = it->second;
+        else {
+            storage = AtomicStringToUTF8String(family);
+            tf = SkTypeface::CreateFromName(storage, (SkTypeface::Style)style);
+            sk_free(storage);
+            cache.add(family, tf);
+        }
+        tf->ref();
+    }
+
     FontPlatformData* result = new FontPlatformData(tf,
                                                     fontDescription.computedSize(),
                                                     (style & SkTypeface::kBold) && !tf->isBold(),
                                                     (style & SkTypeface::kItalic) && !tf->isItalic());
     tf->unref();
-    sk_free(storage);
     return result;
 }
 
@@ -56,6 +56,19 @@ bool GlyphPage::fill(unsigned offset, unsigned length, UChar* buffer, unsigned b
             allGlyphs |= glyphID;
         }
     }
+
+    // Measure the page's glyphs in one call, so that widthForGlyph does not
+    // have to measure each one separately. Emoji have their own advances.
+    if (allGlyphs) {
+        SkAutoSTMalloc <GlyphPage::size, SkScalar> widthStorage(length);
+        SkScalar* widths = widthStorage.get();
+        paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+        paint.getTextWidths(glyphs, length << 1, widths);
+        for (unsigned i = 0; i < length; i++) {
+            if (glyphs[i] && !EmojiFont::IsEmojiGlyph(glyphs[i]))
+                fontData->setWidthForGlyph(glyphs[i], SkScalarToFloat(widths[i]));
+        }
+    }
     return allGlyphs != 0;
 }
 
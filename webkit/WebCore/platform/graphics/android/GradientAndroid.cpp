@@ -11,6 +11,7 @@
 #include "SkColorShader.h"
 #include "SkGradientShader.h"
 #include "SkPaint.h"
+#include <wtf/Vector.h>
 
 class PlatformGradientRec {
 public:
@@ -35,6 +36,70 @@ static U8CPU F2B(float x)
     return (int)(x * 255);
 }
 
+// Gradients with the same geometry, stops and local matrix can share one
+// shader (and its color cache). This happens often for CSS gradients, which
+// are built per element in the element's own coordinates. The key is the
+// raw bits of everything that goes into the shader.
+typedef Vector<uint32_t, 32> GradientKey;
+
+struct SharedGradient {
+    GradientKey m_key;
+    SkShader*   m_shader;
+};
+
+#define GRADIENT_CACHE_SIZE 16
+
+static void appendKey(GradientKey& key, float value)
+{
+    union { float f; uint32_t u; } bits;
+    bits.f = value;
+    key.append(bits.u);
+}
+
+static Vector<SharedGradient>& gradientCache()
+{
+    static Vector<SharedGradient>* cache = new Vector<SharedGradient>;
+    return *cache;
+}
+
+// Returns an owned reference to the cached shader, or NULL
+static SkShader* findSharedShader(const GradientKey& key)
+{
+    Vector<SharedGradient>& cache = gradientCache();
+    size_t size = cache.size();
+    for (size_t i = 0; i < size; i++) {
+        SharedGradient& shared = cache[i];
+        if (shared.m_key.size() == key.size()
+                && !memcmp(shared.m_key.data(), key.data(),
+                           key.size() * sizeof(uint32_t))) {
+            SkShader* shader = shared.m_shader;
+            shader->ref();
+            // move to the end, the front is evicted first
+            if (i != size - 1) {
+                SharedGradient found = shared;
+                cache.remove(i);
+                cache.append(found);
+            }
+            return shader;
+        }
+    }
+    return 0;
+}
+
+static void addSharedShader(const GradientKey& key, SkShader* shader)
+{
+    Vector<SharedGradient>& cache = gradientCache();
+    if (cache.size() == GRADIENT_CACHE_SIZE) {
+        cache[0].m_shader->unref();
+        cache.remove(0);
+    }
+    SharedGradient shared;
+    shared.m_key = key;
+    shared.m_shader = shader;
+    shader->ref();
+    cache.append(shared);
+}
+
 SkShader* Gradient::getShader(SkShader::TileMode mode)
 {
     if (NULL == m_gradient)
@@ -53,6 +118,35 @@ SkShader* Gradient::getShader(SkShader::TileMode mode)
     SkPoint pts[2] = { m_p0, m_p1 };    // convert to SkPoint
 
     const size_t count = m_stops.size();
+    const AffineTransform& transform = m_gradientSpaceTransformation;
+    GradientKey key;
+    key.append(m_radial);
+    key.append(mode);
+    appendKey(key, m_p0.x());
+    appendKey(key, m_p0.y());
+    appendKey(key, m_p1.x());
+    appendKey(key, m_p1.y());
+    appendKey(key, m_r0);
+    appendKey(key, m_r1);
+    appendKey(key, transform.a());
+    appendKey(key, transform.b());
+    appendKey(key, transform.c());
+    appendKey(key, transform.d());
+    appendKey(key, transform.e());
+    appendKey(key, transform.f());
+    for (Vector<ColorStop>::iterator iter = m_stops.begin(); iter != m_stops.end(); ++iter) {
+        appendKey(key, iter->stop);
+        key.append(SkColorSetARGB(F2B(iter->alpha), F2B(iter->red),
+                                  F2B(iter->green), F2B(iter->blue)));
+    }
+
+    if (SkShader* shared = findSharedShader(key)) {
+        m_gradient->m_shader->safeUnref();
+        m_gradient->m_shader = shared;
+        m_gradient->m_tileMode = mode;
+        return shared;
+    }
+
     SkAutoMalloc    storage(count * (sizeof(SkColor) + sizeof(SkScalar)));
     SkColor*        colors = (SkColor*)storage.get();
     SkScalar*       pos = (SkScalar*)(colors + count);
@@ -84,6 +178,7 @@ SkShader* Gradient::getShader(SkShader::TileMode mode)
     m_gradient->m_tileMode = mode;
     SkMatrix matrix = m_gradientSpaceTransformation;
     s->setLocalMatrix(matrix);
+    addSharedShader(key, s);
 
     return s;
 }
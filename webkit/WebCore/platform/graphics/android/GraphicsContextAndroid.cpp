@@ -27,6 +27,8 @@
 using namespace std;
 
 #define GC2Canvas(ctx)  (ctx)->m_data->mPgc->mCanvas
+// Use this instead of GC2Canvas before changing the canvas' matrix or clip
+#define GC2CanvasForChange(ctx)  (ctx)->m_data->canvasForChange()
 
 namespace WebCore {
 
@@ -35,6 +37,19 @@ static int RoundToInt(float x)
     return (int)roundf(x);
 }
 
+// Draws the rect unless it is entirely outside the clip. The recording canvas
+// does not cull, so this keeps invisible fills out of the picture. Paints
+// that draw outside the rect (shadows, blurs, strokes) are always drawn.
+static void drawFillRect(SkCanvas* canvas, const SkRect& rect,
+                         const SkPaint& paint)
+{
+    if (paint.getStyle() == SkPaint::kFill_Style && !paint.getLooper()
+            && !paint.getMaskFilter()
+            && canvas->quickReject(rect, SkCanvas::kAA_EdgeType))
+        return;
+    canvas->drawRect(rect, paint);
+}
+
 template <typename T> T* deepCopyPtr(const T* src) {
     return src ? new T(*src) : NULL;
 }
@@ -132,10 +147,15 @@ public:
     
     SkDeque mStateStack;
     State*  mState;
+    // GraphicsContext::save() calls that have not been made on the canvas
+    // yet. Most save/restore pairs only wrap draws, so the canvas is only
+    // saved once the matrix or clip is about to change. That keeps the empty
+    // pairs out of the recorded picture.
+    int     mPendingSaves;
     
     GraphicsContextPlatformPrivate(GraphicsContext* cg, PlatformGraphicsContext* pgc)
             : mCG(cg)
-            , mPgc(pgc), mStateStack(sizeof(State)) {
+            , mPgc(pgc), mStateStack(sizeof(State)), mPendingSaves(0) {
         State* state = (State*)mStateStack.push_back();
         new (state) State();
         mState = state;
@@ -162,6 +182,24 @@ public:
         mStateStack.pop_back();
         mState = (State*)mStateStack.back();
     }
+
+    void saveCanvas() {
+        mPendingSaves++;
+    }
+
+    void restoreCanvas() {
+        if (mPendingSaves)
+            mPendingSaves--;
+        else
+            mPgc->mCanvas->restore();
+    }
+
+    SkCanvas* canvasForChange() {
+        SkCanvas* canvas = mPgc->mCanvas;
+        for (; mPendingSaves; mPendingSaves--)
+            canvas->save();
+        return canvas;
+    }
     
     void setFillColor(const Color& c) {
         mState->mFillColor = c.rgb();
@@ -350,13 +388,13 @@ void GraphicsContext::savePlatformState()
     // save our private State
     m_data->save();
     // save our native canvas
-    GC2Canvas(this)->save();
+    m_data->saveCanvas();
 }
 
 void GraphicsContext::restorePlatformState()
 {
     // restore our native canvas
-    GC2Canvas(this)->restore();
+    m_data->restoreCanvas();
     // restore our private State
     m_data->restore();
 }
@@ -384,7 +422,7 @@ void GraphicsContext::drawRect(const IntRect& rect)
 
     if (fillColor().alpha()) {
         m_data->setup_paint_fill(&paint);
-        GC2Canvas(this)->drawRect(r, paint);
+        drawFillRect(GC2Canvas(this), r, paint);
     }
 
     /*  According to GraphicsContext.h, stroking inside drawRect always means
@@ -461,16 +499,12 @@ void GraphicsContext::drawLine(const IntPoint& point1, const IntPoint& point2)
         paint.setStyle(SkPaint::kFill_Style);
         paint.setPathEffect(NULL);
         
-        //  clipping to bounds is not required for correctness, but it does
-        //  allow us to reject the entire array of points if we are completely
-        //  offscreen. This is common in a webpage for android, where most of
-        //  the content is clipped out. If drawPoints took an (optional) bounds
-        //  parameter, that might even be better, as we would *just* use it for
-        //  culling, and not both wacking the canvas' save/restore stack.
-        canvas->save(SkCanvas::kClip_SaveFlag);
-        canvas->clipRect(bounds);
-        canvas->drawPoints(SkCanvas::kPoints_PointMode, count, verts, paint);
-        canvas->restore();
+        //  reject the entire array of points if we are completely offscreen.
+        //  This is common in a webpage for android, where most of the
+        //  content is clipped out. The bounds are only used for culling, so
+        //  we don't record a save/clip/restore around the points.
+        if (!canvas->quickReject(bounds, SkCanvas::kAA_EdgeType))
+            canvas->drawPoints(SkCanvas::kPoints_PointMode, count, verts, paint);
     } else {
         SkPoint pts[2] = { point1, point2 };
         canvas->drawLine(pts[0].fX, pts[0].fY, pts[1].fX, pts[1].fY, paint);
@@ -647,7 +681,7 @@ void GraphicsContext::fillRect(const FloatRect& rect)
                  m_common->state.fillPattern.get(),
                  m_common->state.fillGradient.get());
 
-    GC2Canvas(this)->drawRect(rect, paint);
+    drawFillRect(GC2Canvas(this), rect, paint);
 }
 
 void GraphicsContext::fillRect(const FloatRect& rect, const Color& color, ColorSpace)
@@ -685,7 +719,7 @@ void GraphicsContext::fillRect(const FloatRect& rect, const Color& color, ColorS
          */
         paint.setAntiAlias(false);
 
-        GC2Canvas(this)->drawRect(rect, paint);
+        drawFillRect(GC2Canvas(this), rect, paint);
     }
 }
 
@@ -694,7 +728,7 @@ void GraphicsContext::clip(const FloatRect& rect)
     if (paintingDisabled())
         return;
     
-    GC2Canvas(this)->clipRect(rect);
+    GC2CanvasForChange(this)->clipRect(rect);
 }
 
 void GraphicsContext::clip(const Path& path)
@@ -704,7 +738,7 @@ void GraphicsContext::clip(const Path& path)
     
 //    path.platformPath()->dump(false, "clip path");
 
-    GC2Canvas(this)->clipPath(*path.platformPath());
+    GC2CanvasForChange(this)->clipPath(*path.platformPath());
 }
 
 void GraphicsContext::addInnerRoundedRectClip(const IntRect& rect, int thickness)
@@ -724,7 +758,7 @@ void GraphicsContext::addInnerRoundedRectClip(const IntRect& rect, int thickness
         r.inset(SkIntToScalar(thickness) ,SkIntToScalar(thickness));
         path.addOval(r, SkPath::kCCW_Direction);
     }
-    GC2Canvas(this)->clipPath(path);
+    GC2CanvasForChange(this)->clipPath(path);
 }
 
 void GraphicsContext::canvasClip(const Path& path)
@@ -737,7 +771,7 @@ void GraphicsContext::clipOut(const IntRect& r)
     if (paintingDisabled())
         return;
     
-    GC2Canvas(this)->clipRect(r, SkRegion::kDifference_Op);
+    GC2CanvasForChange(this)->clipRect(r, SkRegion::kDifference_Op);
 }
 
 void GraphicsContext::clipOutEllipseInRect(const IntRect& r)
@@ -748,7 +782,7 @@ void GraphicsContext::clipOutEllipseInRect(const IntRect& r)
     SkPath path;
 
     path.addOval(r, SkPath::kCCW_Direction);
-    GC2Canvas(this)->clipPath(path, SkRegion::kDifference_Op);
+    GC2CanvasForChange(this)->clipPath(path, SkRegion::kDifference_Op);
 }
 
 #if ENABLE(SVG)
@@ -759,7 +793,7 @@ void GraphicsContext::clipPath(WindRule clipRule)
     const SkPath* oldPath = m_data->getPath();
     SkPath path(*oldPath);
     path.setFillType(clipRule == RULE_EVENODD ? SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType);
-    GC2Canvas(this)->clipPath(path);
+    GC2CanvasForChange(this)->clipPath(path);
 }
 #endif
 
@@ -768,7 +802,7 @@ void GraphicsContext::clipOut(const Path& p)
     if (paintingDisabled())
         return;
     
-    GC2Canvas(this)->clipPath(*p.platformPath(), SkRegion::kDifference_Op);
+    GC2CanvasForChange(this)->clipPath(*p.platformPath(), SkRegion::kDifference_Op);
 }
 
 void GraphicsContext::clipToImageBuffer(const FloatRect&, const ImageBuffer*) {
@@ -793,7 +827,7 @@ void GraphicsContext::beginTransparencyLayer(float opacity)
     if (paintingDisabled())
         return;
 
-    SkCanvas* canvas = GC2Canvas(this);
+    SkCanvas* canvas = GC2CanvasForChange(this);
     canvas->saveLayerAlpha(NULL, (int)(opacity * 255), TRANSPARENCY_SAVEFLAGS);
 }
 
@@ -981,28 +1015,28 @@ void GraphicsContext::scale(const FloatSize& size)
 {
     if (paintingDisabled())
         return;
-    GC2Canvas(this)->scale(SkFloatToScalar(size.width()), SkFloatToScalar(size.height()));
+    GC2CanvasForChange(this)->scale(SkFloatToScalar(size.width()), SkFloatToScalar(size.height()));
 }
 
 void GraphicsContext::rotate(float angleInRadians)
 {
     if (paintingDisabled())
         return;
-    GC2Canvas(this)->rotate(SkFloatToScalar(angleInRadians * (180.0f / 3.14159265f)));
+    GC2CanvasForChange(this)->rotate(SkFloatToScalar(angleInRadians * (180.0f / 3.14159265f)));
 }
 
 void GraphicsContext::translate(float x, float y)
 {
     if (paintingDisabled())
         return;
-    GC2Canvas(this)->translate(SkFloatToScalar(x), SkFloatToScalar(y));
+    GC2CanvasForChange(this)->translate(SkFloatToScalar(x), SkFloatToScalar(y));
 }
 
 void GraphicsContext::concatCTM(const AffineTransform& affine)
 {
     if (paintingDisabled())
         return;
-    GC2Canvas(this)->concat(affine);
+    GC2CanvasForChange(this)->concat(affine);
 }
 
 FloatRect GraphicsContext::roundToDevicePixels(const FloatRect& rect)
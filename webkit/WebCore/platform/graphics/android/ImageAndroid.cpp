@@ -14,13 +14,16 @@
 #include "SkBitmapRef.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkGradientShader.h"
 #include "SkImageDecoder.h"
+#include "SkPixelRef.h"
 #include "SkShader.h"
 #include "SkString.h"
 #include "SkTemplates.h"
 #include "SkiaUtils.h"
 
 #include <utils/AssetManager.h>
+#include <wtf/Vector.h>
 
 //#define TRACE_SUBSAMPLED_BITMAPS
 //#define TRACE_SKIPPED_BITMAPS
@@ -87,6 +90,28 @@ void BitmapImage::invalidatePlatformData()
 {
 }
 
+// The pixels must be locked
+static bool readPixel(const SkBitmap& bm, int x, int y, SkPMColor* color)
+{
+    switch (bm.getConfig()) {
+        case SkBitmap::kARGB_8888_Config:
+            *color = *bm.getAddr32(x, y);
+            return true;
+        case SkBitmap::kRGB_565_Config:
+            *color = SkPixel16ToPixel32(*bm.getAddr16(x, y));
+            return true;
+        case SkBitmap::kIndex8_Config: {
+            SkColorTable* ctable = bm.getColorTable();
+            if (!ctable)
+                return false;
+            *color = (*ctable)[*bm.getAddr8(x, y)];
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 void BitmapImage::checkForSolidColor()
 {
     m_checkedForSolidColor = true;
@@ -108,23 +133,8 @@ void BitmapImage::checkForSolidColor()
         }
 
         SkPMColor color;
-        switch (bm.getConfig()) {
-            case SkBitmap::kARGB_8888_Config:
-                color = *bm.getAddr32(0, 0);
-                break;
-            case SkBitmap::kRGB_565_Config:
-                color = SkPixel16ToPixel32(*bm.getAddr16(0, 0));
-                break;
-            case SkBitmap::kIndex8_Config: {
-                SkColorTable* ctable = bm.getColorTable();
-                if (!ctable) {
-                return;
-                }
-                color = (*ctable)[*bm.getAddr8(0, 0)];
-                break;
-            }
-            default:
-                return;  // keep solid == false
+        if (!readPixel(bm, 0, 0, &color)) {
+            return;  // keep solid == false
         }
         m_isSolidColor = true;
         m_solidColor = SkPMColorToWebCoreColor(color);
@@ -161,17 +171,174 @@ static inline void fixPaintForBitmapsThatMaySeam(SkPaint* paint) {
     paint->setAntiAlias(false);
 }
 
+// Tiling a strip one pixel wide (or tall) makes the bitmap shader sample
+// every pixel. A gradient with a stop at each pixel center draws the same
+// thing, and a vertical one is filled a row at a time.
+#define MAX_STRIP_GRADIENT_LENGTH   256
+
+static SkShader* createStripShader(const SkBitmap& bm)
+{
+    bool vertical = bm.width() == 1;
+    int count = vertical ? bm.height() : bm.width();
+    if (count < 2 || count > MAX_STRIP_GRADIENT_LENGTH
+            || (vertical ? bm.width() : bm.height()) != 1)
+        return 0;
+
+    SkAutoLockPixels alp(bm);
+    if (!bm.readyToDraw())
+        return 0;
+
+    SkAutoSTMalloc<32, SkColor> colorStorage(count);
+    SkAutoSTMalloc<32, SkScalar> posStorage(count);
+    SkColor* colors = colorStorage.get();
+    SkScalar* pos = posStorage.get();
+    for (int i = 0; i < count; i++) {
+        SkPMColor c;
+        if (!readPixel(bm, vertical ? 0 : i, vertical ? i : 0, &c))
+            return 0;
+        colors[i] = SkPMColorToWebCoreColor(c).rgb();
+        pos[i] = SkScalarDiv(SkIntToScalar(2 * i + 1), SkIntToScalar(2 * count));
+    }
+    SkPoint pts[2];
+    pts[0].set(0, 0);
+    if (vertical)
+        pts[1].set(0, SkIntToScalar(count));
+    else
+        pts[1].set(SkIntToScalar(count), 0);
+    return SkGradientShader::CreateLinear(pts, colors, pos, count,
+                                          SkShader::kRepeat_TileMode);
+}
+
+// Canvas scripts tend to draw the same sprite at the same size many times a
+// frame, and filtering it to that size is most of what drawBitmapRect costs.
+// Drawing into a <canvas> keeps the last few scaled copies. A copy is only
+// made the second time the same scaling is asked for, so images drawn once
+// at a size cost nothing extra.
+class ScaledBitmapCache {
+public:
+    ScaledBitmapCache() : m_bytes(0) {}
+
+    // The part src of bitmap scaled to width x height, or 0 if there is no
+    // copy for it (yet).
+    const SkBitmap* get(const SkBitmap& bitmap, const SkIRect& src, int width, int height);
+
+private:
+    struct Entry {
+        // reffed while cached, so that another bitmap can't take its place
+        SkPixelRef* pixelRef;
+        size_t pixelRefOffset;
+        SkIRect src;
+        int width;
+        int height;
+        SkBitmap* scaled; // 0 until the scaling is asked for again
+    };
+
+    static const size_t maxEntries = 16;
+    static const size_t maxBytes = 2 * 1024 * 1024;
+
+    void removeFirst();
+
+    WTF::Vector<Entry> m_entries; // the most recently used last
+    size_t m_bytes;
+};
+
+static ScaledBitmapCache& scaledBitmapCache()
+{
+    static ScaledBitmapCache cache;
+    return cache;
+}
+
+static SkBitmap* createScaledBitmap(const SkBitmap& bitmap, const SkIRect& src, int width, int height)
+{
+    SkBitmap* scaled = new SkBitmap;
+    scaled->setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    if (!scaled->allocPixels()) {
+        delete scaled;
+        return 0;
+    }
+    scaled->eraseColor(0);
+    SkCanvas canvas(*scaled);
+    SkPaint paint;
+    paint.setFilterBitmap(true);
+    SkRect dst;
+    dst.set(0, 0, SkIntToScalar(width), SkIntToScalar(height));
+    canvas.drawBitmapRect(bitmap, &src, dst, &paint);
+    return scaled;
+}
+
+const SkBitmap* ScaledBitmapCache::get(const SkBitmap& bitmap, const SkIRect& src, int width, int height)
+{
+    SkPixelRef* pixelRef = bitmap.pixelRef();
+    size_t bytes = width * height * 4;
+    if (!pixelRef || bytes > maxBytes / 4)
+        return 0;
+
+    size_t count = m_entries.size();
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = m_entries[i];
+        if (entry.pixelRef != pixelRef || entry.pixelRefOffset != bitmap.pixelRefOffset()
+                || !(entry.src == src) || entry.width != width || entry.height != height)
+            continue;
+        Entry found = entry;
+        m_entries.remove(i);
+        if (!found.scaled) {
+            found.scaled = createScaledBitmap(bitmap, src, width, height);
+            if (found.scaled)
+                m_bytes += bytes;
+        }
+        m_entries.append(found);
+        while (m_entries.size() > 1 && m_bytes > maxBytes)
+            removeFirst();
+        return found.scaled;
+    }
+
+    pixelRef->ref();
+    Entry entry = { pixelRef, bitmap.pixelRefOffset(), src, width, height, 0 };
+    m_entries.append(entry);
+    while (m_entries.size() > maxEntries)
+        removeFirst();
+    return 0;
+}
+
+void ScaledBitmapCache::removeFirst()
+{
+    Entry& entry = m_entries.first();
+    entry.pixelRef->unref();
+    if (entry.scaled) {
+        m_bytes -= entry.scaled->width() * entry.scaled->height() * 4;
+        delete entry.scaled;
+    }
+    m_entries.remove(0);
+}
+
 void BitmapImage::draw(GraphicsContext* ctxt, const FloatRect& dstRect,
-                   const FloatRect& srcRect, ColorSpace,
+                   const FloatRect& srcRect, ColorSpace styleColorSpace,
                    CompositeOperator compositeOp)
 {
     startAnimation();
 
+    if (mayFillWithSolidColor()) {
+        fillWithSolidColor(ctxt, dstRect, solidColor(), styleColorSpace, compositeOp);
+        return;
+    }
+
     SkBitmapRef* image = this->nativeImageForCurrentFrame();
     if (!image) { // If it's too early we won't have an image yet.
         return;
     }
 
+    SkCanvas*   canvas = ctxt->platformContext()->mCanvas;
+    // Decode no more pixels than the whole image covers on the screen. This
+    // may resize the bitmap, but keeps the same SkBitmapRef.
+    if (srcRect.width() > 0 && srcRect.height() > 0) {
+        const SkMatrix& matrix = canvas->getTotalMatrix();
+        float scaleX = SkScalarToFloat(SkScalarAbs(matrix.getScaleX()));
+        float scaleY = SkScalarToFloat(SkScalarAbs(matrix.getScaleY()));
+        m_source.setDisplaySize(
+            dstRect.width() * scaleX * image->origWidth() / srcRect.width(),
+            dstRect.height() * scaleY * image->origHeight() / srcRect.height());
+    }
+
     // in case we get called with an incomplete bitmap
     const SkBitmap& bitmap = image->bitmap();
     if (bitmap.getPixels() == NULL && bitmap.pixelRef() == NULL) {
@@ -198,13 +365,35 @@ void BitmapImage::draw(GraphicsContext* ctxt, const FloatRect& dstRect,
         return;
     }
 
-    SkCanvas*   canvas = ctxt->platformContext()->mCanvas;
     SkPaint     paint;
 
     ctxt->setupBitmapPaint(&paint);   // need global alpha among other things
     paint.setFilterBitmap(true);
     paint.setXfermodeMode(WebCoreCompositeToSkiaComposite(compositeOp));
     fixPaintForBitmapsThatMaySeam(&paint);
+
+    // Only offscreen contexts, those of <canvas>, draw straight to pixels;
+    // a recorded picture may be drawn at any scale later.
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    if (ctxt->platformContext()->deleteUs() && m_allDataReceived
+            && !(matrix.getType() & ~(SkMatrix::kScale_Mask | SkMatrix::kTranslate_Mask))
+            && matrix.getScaleX() > 0 && matrix.getScaleY() > 0) {
+        SkRect devR;
+        matrix.mapRect(&devR, dstR);
+        int width = SkScalarRound(devR.width());
+        int height = SkScalarRound(devR.height());
+        if (width > 0 && height > 0
+                && (width != srcR.width() || height != srcR.height())) {
+            const SkBitmap* scaled = scaledBitmapCache().get(bitmap, srcR, width, height);
+            if (scaled) {
+                canvas->save(SkCanvas::kMatrix_SaveFlag);
+                canvas->resetMatrix();
+                canvas->drawBitmap(*scaled, devR.fLeft, devR.fTop, &paint);
+                canvas->restore();
+                return;
+            }
+        }
+    }
     canvas->drawBitmapRect(bitmap, &srcR, dstR, &paint);
 
 #ifdef TRACE_SUBSAMPLED_BITMAPS
@@ -271,9 +460,11 @@ void Image::drawPattern(GraphicsContext* ctxt, const FloatRect& srcRect,
     SkPaint     paint;
     ctxt->setupBitmapPaint(&paint);   // need global alpha among other things
 
-    SkShader* shader = SkShader::CreateBitmapShader(bitmap,
-                                                    SkShader::kRepeat_TileMode,
-                                                    SkShader::kRepeat_TileMode);
+    SkShader* shader = createStripShader(bitmap);
+    if (!shader)
+        shader = SkShader::CreateBitmapShader(bitmap,
+                                              SkShader::kRepeat_TileMode,
+                                              SkShader::kRepeat_TileMode);
     paint.setShader(shader)->unref();
     // now paint is the only owner of shader
     paint.setXfermodeMode(WebCoreCompositeToSkiaComposite(compositeOp));
@@ -58,6 +58,68 @@ Image* ImageBuffer::image() const
     return m_image.get();
 }
 
+static bool isOpaqueRow(const SkPMColor* row, int count)
+{
+    SkPMColor opaque = SkPackARGB32(0xFF, 0, 0, 0);
+    SkPMColor all = opaque;
+    for (int x = 0; x < count; x++)
+        all &= row[x];
+    return all == opaque;
+}
+
+static bool isOpaqueRow(const unsigned char* row, int count)
+{
+    unsigned all = 0xFF;
+    for (int x = 0; x < count; x++)
+        all &= row[x * 4 + 3];
+    return all == 0xFF;
+}
+
+// Skia's pixels are premultiplied and image data is not. Dividing by alpha
+// is done with SkUnPreMultiply's table of reciprocals, and skipped for
+// opaque rows, which are the common case for games and photos.
+static void unpremultiplyRow(const SkPMColor* src, unsigned char* dst, int count)
+{
+    if (isOpaqueRow(src, count)) {
+        for (int x = 0; x < count; x++, dst += 4) {
+            SkPMColor c = src[x];
+            dst[0] = SkGetPackedR32(c);
+            dst[1] = SkGetPackedG32(c);
+            dst[2] = SkGetPackedB32(c);
+            dst[3] = 0xFF;
+        }
+        return;
+    }
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    for (int x = 0; x < count; x++, dst += 4) {
+        SkPMColor c = src[x];
+        unsigned a = SkGetPackedA32(c);
+        SkUnPreMultiply::Scale scale = table[a];
+        dst[0] = SkUnPreMultiply::ApplyScale(scale, SkGetPackedR32(c));
+        dst[1] = SkUnPreMultiply::ApplyScale(scale, SkGetPackedG32(c));
+        dst[2] = SkUnPreMultiply::ApplyScale(scale, SkGetPackedB32(c));
+        dst[3] = a;
+    }
+}
+
+static void premultiplyRow(const unsigned char* src, SkPMColor* dst, int count)
+{
+    if (isOpaqueRow(src, count)) {
+        for (int x = 0; x < count; x++, src += 4)
+            dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        return;
+    }
+    for (int x = 0; x < count; x++, src += 4) {
+        unsigned a = src[3];
+        if (!a)
+            dst[x] = 0;
+        else if (a == 0xFF)
+            dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        else
+            dst[x] = SkPreMultiplyARGB(a, src[0], src[1], src[2]);
+    }
+}
+
 PassRefPtr<ImageData> ImageBuffer::getUnmultipliedImageData(const IntRect& rect) const
 {
     GraphicsContext* gc = this->context();
@@ -106,15 +168,7 @@ PassRefPtr<ImageData> ImageBuffer::getUnmultipliedImageData(const IntRect& rect)
     const SkPMColor* srcRows = src.getAddr32(originx, originy);
     unsigned char* destRows = data + desty * destBytesPerRow + destx * 4;
     for (int y = 0; y < numRows; ++y) {
-        for (int x = 0; x < numColumns; x++) {
-            // ugh, it appears they want unpremultiplied pixels
-            SkColor c = SkUnPreMultiply::PMColorToColor(srcRows[x]);
-            int basex = x * 4;
-            destRows[basex + 0] = SkColorGetR(c);
-            destRows[basex + 1] = SkColorGetG(c);
-            destRows[basex + 2] = SkColorGetB(c);
-            destRows[basex + 3] = SkColorGetA(c);
-        }
+        unpremultiplyRow(srcRows, destRows, numColumns);
         srcRows += srcPixelsPerRow;
         destRows += destBytesPerRow;
     }
@@ -166,13 +220,7 @@ void ImageBuffer::putUnmultipliedImageData(ImageData* source, const IntRect& sou
     unsigned char* srcRows = source->data()->data()->data() + originy * srcBytesPerRow + originx * 4;
     SkPMColor* dstRows = dst.getAddr32(destx, desty);
     for (int y = 0; y < numRows; ++y) {
-        for (int x = 0; x < numColumns; x++) {
-            int basex = x * 4;
-            dstRows[x] = SkPackARGB32(srcRows[basex + 3],
-                                      srcRows[basex + 0],
-                                      srcRows[basex + 1],
-                                      srcRows[basex + 2]);
-        }
+        premultiplyRow(srcRows, dstRows, numColumns);
         dstRows += dstPixelsPerRow;
         srcRows += srcBytesPerRow;
     }
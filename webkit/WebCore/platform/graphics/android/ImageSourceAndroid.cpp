@@ -17,6 +17,8 @@
 #ifdef ANDROID_ANIMATED_GIF
     #include "EmojiFont.h"
     #include "GIFImageDecoder.h"
+    #include "JPEGImageDecoder.h"
+    #include "PNGImageDecoder.h"
 
     using namespace android;
 #endif
@@ -62,6 +64,12 @@ SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src);
     };
 #endif
 
+#ifdef ANDROID_ANIMATED_GIF
+// images with fewer pixels than this just wait for all of their data, since
+// the streaming decoder keeps its own 32bit copy of the pixels
+#define MIN_STREAM_DECODE_PIXELS    (128*128)
+#endif
+
 static size_t computeMaxBitmapSizeForCache() {
     return MAX_SIZE_BEFORE_SUBSAMPLE;
 }
@@ -81,20 +89,33 @@ class PrivateAndroidImageSourceRec : public SkBitmapRef {
 public:
     PrivateAndroidImageSourceRec(const SkBitmap& bm, int origWidth,
                                  int origHeight, int sampleSize)
-            : SkBitmapRef(bm), fSampleSize(sampleSize), fAllDataReceived(false) {
+            : SkBitmapRef(bm), fSampleSize(sampleSize),
+              fMinSampleSize(sampleSize), fDisplayWidth(0), fDisplayHeight(0),
+              fAllDataReceived(false) {
         this->setOrigSize(origWidth, origHeight);
     }
 
     int  fSampleSize;
+    int  fMinSampleSize;    // required to fit computeMaxBitmapSizeForCache()
+    // largest size drawn so far, in device pixels
+    float fDisplayWidth;
+    float fDisplayHeight;
+    // kept to allocate pixels at another sample size; 0 if RLE encoded
+    RefPtr<WebCore::SharedBuffer> fData;
     bool fAllDataReceived;
 };
 
+// the zoom to decode for, and whether any image is smaller than its source
+static float gDecodeScale = 1;
+static bool gHasDisplaySampledImages;
+
 namespace WebCore {
 
 ImageSource::ImageSource() {
     m_decoder.m_image = NULL;
 #ifdef ANDROID_ANIMATED_GIF
     m_decoder.m_gifDecoder = 0;
+    m_decoder.m_streamDecoder = 0;
 #endif
 }
 
@@ -102,13 +123,14 @@ ImageSource::~ImageSource() {
     delete m_decoder.m_image;
 #ifdef ANDROID_ANIMATED_GIF
     delete m_decoder.m_gifDecoder;
+    delete m_decoder.m_streamDecoder;
 #endif
 }
 
 bool ImageSource::initialized() const {
     return
 #ifdef ANDROID_ANIMATED_GIF
-        m_decoder.m_gifDecoder ||
+        m_decoder.m_gifDecoder || m_decoder.m_streamDecoder ||
 #endif
         m_decoder.m_image != NULL;
 }
@@ -183,6 +205,23 @@ static bool should_use_animated_gif(int width, int height) {
            width <= 32 && height <= 32;
 #endif
 }
+
+// Returns a decoder that can pick up where it left off on each setData, or
+// 0 if the image is small or the format is decoded some other way.
+static ImageDecoder* create_stream_decoder(const SharedBuffer* data,
+                                           int width, int height) {
+    if (width * height < MIN_STREAM_DECODE_PIXELS ||
+            (size_t) width * height * 4 > computeMaxBitmapSizeForCache())
+        return 0;
+    const unsigned char* contents = (const unsigned char*) data->data();
+    size_t size = data->size();
+    if (size > 2 && contents[0] == 0xFF && contents[1] == 0xD8 &&
+            contents[2] == 0xFF)
+        return new JPEGImageDecoder();
+    if (size > 3 && memcmp(contents, "\x89PNG", 4) == 0)
+        return new PNGImageDecoder();
+    return 0;
+}
 #endif
 
 void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
@@ -207,6 +246,19 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
         // Already tried using GIFImageDecoder so skip the check.
         skipAnimatedGif = true;
     }
+
+    if (m_decoder.m_streamDecoder) {
+        if (!allDataReceived) {
+            // The decoder only parses the bytes it has not seen yet
+            m_decoder.m_streamDecoder->setData(data, false);
+            if (!m_decoder.m_streamDecoder->failed())
+                return;
+        }
+        // Once complete (or if the decoder gave up), decode through our
+        // shared image ref pool so the pixels can be purged.
+        delete m_decoder.m_streamDecoder;
+        m_decoder.m_streamDecoder = 0;
+    }
 #endif
 
     if (NULL == m_decoder.m_image
@@ -255,6 +307,17 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
             delete m_decoder.m_gifDecoder;
             m_decoder.m_gifDecoder = 0;
         }
+
+        if (!allDataReceived) {
+            m_decoder.m_streamDecoder = create_stream_decoder(data, origW, origH);
+            if (m_decoder.m_streamDecoder) {
+                m_decoder.m_streamDecoder->setData(data, false);
+                if (!m_decoder.m_streamDecoder->failed())
+                    return;
+                delete m_decoder.m_streamDecoder;
+                m_decoder.m_streamDecoder = 0;
+            }
+        }
 #endif
 
         int sampleSize = computeSampleSize(tmp);
@@ -286,6 +349,7 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
                 return;
             }
             ref = bm->pixelRef();
+            decoder->fData = data;
         }
 
         // we promise to never change the pixels (makes picture recording fast)
@@ -295,12 +359,78 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
     }
 }
 
+bool ImageSource::setDisplaySize(float width, float height)
+{
+    PrivateAndroidImageSourceRec* decoder = m_decoder.m_image;
+    if (!decoder || !decoder->fAllDataReceived || !decoder->fData)
+        return false;
+
+    width *= gDecodeScale;
+    height *= gDecodeScale;
+    if (width <= decoder->fDisplayWidth && height <= decoder->fDisplayHeight)
+        return false;
+    if (width > decoder->fDisplayWidth)
+        decoder->fDisplayWidth = width;
+    if (height > decoder->fDisplayHeight)
+        decoder->fDisplayHeight = height;
+
+    // the largest power of 2 that still covers every pixel drawn
+    int sampleSize = decoder->fMinSampleSize;
+    while (decoder->origWidth() / (sampleSize << 1) >= decoder->fDisplayWidth
+            && decoder->origHeight() / (sampleSize << 1) >= decoder->fDisplayHeight)
+        sampleSize <<= 1;
+    if (sampleSize == decoder->fSampleSize)
+        return false;
+
+    // The pixels are decoded lazily, so this only costs a bounds decode.
+    // Pictures already recorded keep the old bitmap.
+    SharedBuffer* data = decoder->fData.get();
+    SkMemoryStream stream(data->data(), data->size(), false);
+    SkImageDecoder* codec = SkImageDecoder::Factory(&stream);
+    if (!codec)
+        return false;
+
+    SkAutoTDelete<SkImageDecoder> ad(codec);
+    codec->setPrefConfigTable(gPrefConfigTable);
+    codec->setSampleSize(sampleSize);
+    SkBitmap tmp;
+    if (!codec->decode(&stream, &tmp, SkImageDecoder::kDecodeBounds_Mode))
+        return false;
+
+    BitmapAllocatorAndroid alloc(data, sampleSize);
+    if (!alloc.allocPixelRef(&tmp, NULL))
+        return false;
+    SkPixelRef* ref = tmp.pixelRef();
+    ref->setImmutable();
+    ref->setURI(m_decoder.m_url);
+
+    decoder->bitmap() = tmp;
+    decoder->fSampleSize = sampleSize;
+    if (sampleSize > decoder->fMinSampleSize)
+        gHasDisplaySampledImages = true;
+#ifdef TRACE_SUBSAMPLE_BITMAPS
+    SkDebugf("------- bitmap [%d %d] display [%g %g] sampleSize=%d\n",
+             decoder->origWidth(), decoder->origHeight(),
+             decoder->fDisplayWidth, decoder->fDisplayHeight, sampleSize);
+#endif
+    return true;
+}
+
+bool ImageSource::setDecodeScale(float scale)
+{
+    bool grew = scale > gDecodeScale;
+    gDecodeScale = scale;
+    return grew && gHasDisplaySampledImages;
+}
+
 bool ImageSource::isSizeAvailable()
 {
     return
 #ifdef ANDROID_ANIMATED_GIF
             (m_decoder.m_gifDecoder
                     && m_decoder.m_gifDecoder->isSizeAvailable()) ||
+            (m_decoder.m_streamDecoder
+                    && m_decoder.m_streamDecoder->isSizeAvailable()) ||
 #endif
             m_decoder.m_image != NULL;
 }
@@ -310,6 +440,8 @@ IntSize ImageSource::size() const
 #ifdef ANDROID_ANIMATED_GIF
     if (m_decoder.m_gifDecoder)
         return m_decoder.m_gifDecoder->size();
+    if (m_decoder.m_streamDecoder)
+        return m_decoder.m_streamDecoder->size();
 #endif
     if (m_decoder.m_image) {
         return IntSize(m_decoder.m_image->origWidth(), m_decoder.m_image->origHeight());
@@ -322,7 +454,7 @@ int ImageSource::repetitionCount()
 #ifdef ANDROID_ANIMATED_GIF
     if (m_decoder.m_gifDecoder)
         return m_decoder.m_gifDecoder->repetitionCount();
-    if (!m_decoder.m_image) return 0;
+    if (!m_decoder.m_image && !m_decoder.m_streamDecoder) return 0;
 #endif
     return 1;
     // A property with value 0 means loop forever.
@@ -335,6 +467,8 @@ size_t ImageSource::frameCount() const
         return m_decoder.m_gifDecoder->failed() ? 0
                 : m_decoder.m_gifDecoder->frameCount();
     }
+    if (m_decoder.m_streamDecoder)
+        return m_decoder.m_streamDecoder->failed() ? 0 : 1;
 #endif
     // i.e. 0 frames if we're not decoded, or 1 frame if we are
     return m_decoder.m_image != NULL;
@@ -343,9 +477,10 @@ size_t ImageSource::frameCount() const
 SkBitmapRef* ImageSource::createFrameAtIndex(size_t index)
 {
 #ifdef ANDROID_ANIMATED_GIF
-    if (m_decoder.m_gifDecoder) {
-        RGBA32Buffer* buffer =
-                m_decoder.m_gifDecoder->frameBufferAtIndex(index);
+    ImageDecoder* imageDecoder = m_decoder.m_gifDecoder ?
+            m_decoder.m_gifDecoder : m_decoder.m_streamDecoder;
+    if (imageDecoder) {
+        RGBA32Buffer* buffer = imageDecoder->frameBufferAtIndex(index);
         if (!buffer || buffer->status() == RGBA32Buffer::FrameEmpty)
             return 0;
         SkBitmap& bitmap = buffer->bitmap();
@@ -388,12 +523,13 @@ float ImageSource::frameDurationAtIndex(size_t index)
 bool ImageSource::frameHasAlphaAtIndex(size_t index)
 {
 #ifdef ANDROID_ANIMATED_GIF
-    if (m_decoder.m_gifDecoder) {
-        if (!m_decoder.m_gifDecoder->supportsAlpha())
+    ImageDecoder* imageDecoder = m_decoder.m_gifDecoder ?
+            m_decoder.m_gifDecoder : m_decoder.m_streamDecoder;
+    if (imageDecoder) {
+        if (!imageDecoder->supportsAlpha())
             return false;
 
-        RGBA32Buffer* buffer =
-                m_decoder.m_gifDecoder->frameBufferAtIndex(index);
+        RGBA32Buffer* buffer = imageDecoder->frameBufferAtIndex(index);
         if (!buffer || buffer->status() == RGBA32Buffer::FrameEmpty)
             return false;
 
@@ -419,9 +555,10 @@ bool ImageSource::frameHasAlphaAtIndex(size_t index)
 bool ImageSource::frameIsCompleteAtIndex(size_t index)
 {
 #ifdef ANDROID_ANIMATED_GIF
-    if (m_decoder.m_gifDecoder) {
-        RGBA32Buffer* buffer =
-                m_decoder.m_gifDecoder->frameBufferAtIndex(index);
+    ImageDecoder* imageDecoder = m_decoder.m_gifDecoder ?
+            m_decoder.m_gifDecoder : m_decoder.m_streamDecoder;
+    if (imageDecoder) {
+        RGBA32Buffer* buffer = imageDecoder->frameBufferAtIndex(index);
         return buffer && buffer->status() == RGBA32Buffer::FrameComplete;
     }
 #else
@@ -441,6 +578,8 @@ void ImageSource::clear(bool destroyAll, size_t clearBeforeFrame, SharedBuffer*
     
     delete m_decoder.m_gifDecoder;
     m_decoder.m_gifDecoder = 0;
+    delete m_decoder.m_streamDecoder;
+    m_decoder.m_streamDecoder = 0;
     if (data)
         setData(data, allDataReceived);
 #endif
@@ -459,6 +598,8 @@ String ImageSource::filenameExtension() const
 #ifdef ANDROID_ANIMATED_GIF
     if (m_decoder.m_gifDecoder)
         return m_decoder.m_gifDecoder->filenameExtension();
+    if (m_decoder.m_streamDecoder)
+        return m_decoder.m_streamDecoder->filenameExtension();
 #endif
     return String();
 }
@@ -6,6 +6,7 @@
 
 #include "AndroidAnimation.h"
 #include "DrawExtra.h"
+#include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkDrawFilter.h"
 #include "SkPaint.h"
@@ -43,6 +44,80 @@ class OpacityDrawFilter : public SkDrawFilter {
     int m_previousOpacity;
 };
 
+// Layers bigger than this (in pixels) are drawn from their picture each time
+#define MAX_CACHED_LAYER_AREA (1024 * 1024)
+
+// The layer's picture rendered into a bitmap, at the scale it was last drawn.
+// The WebCore thread only refs and unrefs it when copying layers; the bitmap
+// is only touched when drawing, on the UI thread.
+class LayerContentCache : public SkRefCnt {
+public:
+    LayerContentCache() : m_picture(0), m_scale(0), m_opaque(false) { }
+    virtual ~LayerContentCache() { m_picture->safeUnref(); }
+
+    bool matches(SkPicture* picture, SkScalar scale) const
+    {
+        return picture == m_picture && scale == m_scale;
+    }
+
+    // true if picture was rendered and left no transparent pixels
+    bool isOpaque(SkPicture* picture) const
+    {
+        return picture == m_picture && m_opaque;
+    }
+
+    bool render(SkPicture* picture, SkScalar scale)
+    {
+        int width = SkScalarCeil(picture->width() * scale);
+        int height = SkScalarCeil(picture->height() * scale);
+        if (width <= 0 || height <= 0 || width * height > MAX_CACHED_LAYER_AREA)
+            return false;
+        if (m_bitmap.width() != width || m_bitmap.height() != height) {
+            m_bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+            if (!m_bitmap.allocPixels()) {
+                m_bitmap.reset();
+                return false;
+            }
+        }
+        m_bitmap.eraseColor(0);
+        SkCanvas canvas(m_bitmap);
+        canvas.scale(scale, scale);
+        canvas.drawPicture(*picture);
+        m_opaque = true;
+        for (int y = 0; y < height && m_opaque; y++) {
+            const uint32_t* row = m_bitmap.getAddr32(0, y);
+            for (int x = 0; x < width; x++) {
+                if (SkGetPackedA32(row[x]) != 0xFF) {
+                    m_opaque = false;
+                    break;
+                }
+            }
+        }
+        picture->safeRef();
+        m_picture->safeUnref();
+        m_picture = picture;
+        m_scale = scale;
+        return true;
+    }
+
+    void draw(SkCanvas* canvas, int opacity) const
+    {
+        SkPaint paint;
+        paint.setAlpha(opacity);
+        paint.setFilterBitmap(true);
+        SkScalar inverse = SkScalarInvert(m_scale);
+        SkAutoCanvasRestore restore(canvas, true);
+        canvas->scale(inverse, inverse);
+        canvas->drawBitmap(m_bitmap, 0, 0, &paint);
+    }
+
+private:
+    SkBitmap m_bitmap;
+    SkPicture* m_picture; // what m_bitmap holds
+    SkScalar m_scale;
+    bool m_opaque;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 LayerAndroid::LayerAndroid(bool isRootLayer) : SkLayer(),
@@ -51,6 +126,8 @@ LayerAndroid::LayerAndroid(bool isRootLayer) : SkLayer(),
     m_doRotation(false),
     m_isFixed(false),
     m_recordingPicture(0),
+    m_contentCache(new LayerContentCache()),
+    m_fullyOccluded(false),
     m_extra(0),
     m_uniqueId(++gUniqueId)
 {
@@ -90,6 +167,9 @@ LayerAndroid::LayerAndroid(const LayerAndroid& layer) : SkLayer(layer),
 
     m_recordingPicture = layer.m_recordingPicture;
     SkSafeRef(m_recordingPicture);
+    m_contentCache = layer.m_contentCache;
+    m_contentCache->safeRef();
+    m_fullyOccluded = false;
 
     for (int i = 0; i < layer.countChildren(); i++)
         addChild(new LayerAndroid(*layer.getChild(i)))->unref();
@@ -107,6 +187,8 @@ LayerAndroid::LayerAndroid(SkPicture* picture) : SkLayer(),
     m_doRotation(false),
     m_isFixed(false),
     m_recordingPicture(picture),
+    m_contentCache(0),
+    m_fullyOccluded(false),
     m_extra(0),
     m_uniqueId(-1)
 {
@@ -122,6 +204,7 @@ LayerAndroid::~LayerAndroid()
 {
     removeChildren();
     m_recordingPicture->safeUnref();
+    m_contentCache->safeUnref();
     m_animations.clear();
     gDebugLayerAndroidInstances--;
 }
@@ -249,6 +332,55 @@ const LayerAndroid* LayerAndroid::find(int x, int y) const
     return 0;
 }
 
+void LayerAndroid::computeOcclusion(SkRegion* covered, SkRegion* fixedCovered)
+{
+    SkIRect clip;
+    clip.set(-0x7FFFFFF, -0x7FFFFFF, 0x7FFFFFF, 0x7FFFFFF);
+    occlusionInner(SK_Scalar1, clip, covered, fixedCovered);
+}
+
+void LayerAndroid::occlusionInner(SkScalar opacity, const SkIRect& clip,
+    SkRegion* covered, SkRegion* fixedCovered)
+{
+    opacity = SkScalarMul(opacity, getOpacity());
+    SkMatrix matrix;
+    localToGlobal(&matrix);
+    SkRect local;
+    local.set(0, 0, getSize().width(), getSize().height());
+    SkRect global;
+    matrix.mapRect(&global, local);
+    SkIRect childClip = clip;
+    if (m_haveClip) {
+        SkIRect outer;
+        global.roundOut(&outer);
+        if (!childClip.intersect(outer))
+            childClip.setEmpty();
+    }
+    // children draw after us, so they are in front; the last one is on top
+    for (int i = countChildren() - 1; i >= 0; i--)
+        getChild(i)->occlusionInner(opacity, childClip, covered, fixedCovered);
+    m_occluded = *covered;
+    m_fullyOccluded = false;
+    if (!m_recordingPicture)
+        return;
+    SkIRect outer;
+    global.roundOut(&outer);
+    m_fullyOccluded = covered->contains(outer);
+    if (opacity < SK_Scalar1 || !matrix.rectStaysRect() || !m_contentCache
+            || !m_contentCache->isOpaque(m_recordingPicture))
+        return;
+    local.set(0, 0, m_recordingPicture->width(), m_recordingPicture->height());
+    matrix.mapRect(&global, local);
+    SkIRect inner;
+    inner.set(SkScalarCeil(global.fLeft), SkScalarCeil(global.fTop),
+        SkScalarFloor(global.fRight), SkScalarFloor(global.fBottom));
+    if (!inner.intersect(clip))
+        return;
+    covered->op(inner, SkRegion::kUnion_Op);
+    if (fixedCovered && m_isFixed && !m_animations.size())
+        fixedCovered->op(inner, SkRegion::kUnion_Op);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // The Layer bounds and the renderview bounds are not always indentical.
@@ -329,14 +461,21 @@ void LayerAndroid::onDraw(SkCanvas* canvas, SkScalar opacity) {
     if (!prepareContext())
         return;
 
+    if (m_fullyOccluded)
+        return;
+
     // we just have this save/restore for opacity...
     SkAutoCanvasRestore restore(canvas, true);
 
-    int canvasOpacity = SkScalarRound(opacity * 255);
-    if (canvasOpacity < 255)
-        canvas->setDrawFilter(new OpacityDrawFilter(canvasOpacity));
+    if (!m_occluded.isEmpty())
+        canvas->clipRegion(m_occluded, SkRegion::kDifference_Op);
 
-    canvas->drawPicture(*m_recordingPicture);
+    int canvasOpacity = SkScalarRound(opacity * 255);
+    if (!drawCachedContent(canvas, canvasOpacity)) {
+        if (canvasOpacity < 255)
+            canvas->setDrawFilter(new OpacityDrawFilter(canvasOpacity));
+        canvas->drawPicture(*m_recordingPicture);
+    }
     if (m_extra)
         m_extra->draw(canvas, this);
 
@@ -362,6 +501,34 @@ void LayerAndroid::onDraw(SkCanvas* canvas, SkScalar opacity) {
 #endif
 }
 
+// Draws the layer content from its cached bitmap, rendering the picture into
+// the cache first if it was re-recorded or the zoom changed. Transform and
+// opacity animations leave both alone, so they only recomposite the bitmap.
+bool LayerAndroid::drawCachedContent(SkCanvas* canvas, int opacity)
+{
+    if (!m_contentCache)
+        return false;
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    if (matrix.getType() & SkMatrix::kPerspective_Mask)
+        return false;
+    // cache at the page scale, ignoring the layer's own animated scale
+    SkPoint unit;
+    unit.set(SK_Scalar1, 0);
+    matrix.mapVectors(&unit, 1);
+    SkScalar layerScale = SkScalarAbs(m_scale.fX);
+    if (layerScale == 0)
+        return false;
+    SkScalar scale = SkScalarDiv(unit.length(), layerScale);
+    scale = SkScalarCeil(scale * 4) / SkIntToScalar(4);
+    if (scale <= 0)
+        return false;
+    if (!m_contentCache->matches(m_recordingPicture, scale)
+            && !m_contentCache->render(m_recordingPicture, scale))
+        return false;
+    m_contentCache->draw(canvas, opacity);
+    return true;
+}
+
 SkPicture* LayerAndroid::recordContext()
 {
     if (prepareContext(true))
@@ -8,6 +8,7 @@
 #include "RefPtr.h"
 #include "SkColor.h"
 #include "SkLayer.h"
+#include "SkRegion.h"
 #include "StringHash.h"
 #include <wtf/HashMap.h>
 
@@ -49,6 +50,7 @@ struct SkLength {
 namespace WebCore {
 
 class AndroidAnimation;
+class LayerContentCache;
 
 class LayerAndroid : public SkLayer {
 
@@ -140,6 +142,17 @@ public:
      */
     void updatePositions();
 
+    /** Call this after updatePositions(), with the root matrix set to the
+        device matrix, to find what each layer has in front of it. Walks the
+        tree front to back; each layer remembers the device area covered by
+        opaque layers drawn after it, and skips drawing there.
+
+        covered receives the device area hidden by opaque layers. If
+        fixedCovered is not null, it receives the part of that covered by
+        unanimated fixed layers, which stays put while the page scrolls.
+     */
+    void computeOcclusion(SkRegion* covered, SkRegion* fixedCovered);
+
     void clipArea(SkTDArray<SkRect>* region) const;
     const LayerAndroid* find(int x, int y) const;
     const LayerAndroid* findById(int uniqueID) const;
@@ -161,6 +174,9 @@ private:
     friend class CachedLayer::Debug; // debugging access only
 #endif
     void bounds(SkRect* ) const;
+    bool drawCachedContent(SkCanvas* , int opacity);
+    void occlusionInner(SkScalar opacity, const SkIRect& clip,
+        SkRegion* covered, SkRegion* fixedCovered);
     bool prepareContext(bool force = false);
     void clipInner(SkTDArray<SkRect>* region, const SkRect& local) const;
 
@@ -189,6 +205,11 @@ private:
     SkColor m_backgroundColor;
 
     SkPicture* m_recordingPicture;
+    // rendered m_recordingPicture, shared with copies of this layer so that
+    // animation frames recomposite it instead of replaying the picture
+    LayerContentCache* m_contentCache;
+    SkRegion m_occluded; // device area hidden by opaque layers in front
+    bool m_fullyOccluded;
 
     typedef HashMap<String, RefPtr<AndroidAnimation> > KeyframesMap;
     KeyframesMap m_animations;
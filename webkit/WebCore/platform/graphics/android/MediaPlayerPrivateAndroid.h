@@ -29,7 +29,7 @@ public:
     virtual bool hasAudio() const { return false; }
     virtual bool hasVideo() const { return false; }
 
-    virtual void setVisible(bool);
+    virtual void setVisible(bool visible) { m_isVisible = visible; }
 
     virtual float duration() const { return m_duration; }
 
@@ -58,6 +58,8 @@ public:
 
     virtual void setSize(const IntSize&) { }
 
+    virtual void setAutobuffer(bool autobuffer) { m_autobuffer = autobuffer; }
+
     virtual bool canLoadPoster() const { return false; }
     virtual void setPoster(const String&) { }
     virtual void prepareToPlay();
@@ -79,6 +81,14 @@ protected:
     MediaPlayerPrivate(MediaPlayer *);
     virtual void createJavaPlayerIfNeeded() { }
 
+    // Java players are only created for play(), or for autobuffer, and at
+    // most maxJavaPlayers of them exist at once. Creating one beyond that
+    // releases the least recently used ones that are paused; they are
+    // created again if they are played.
+    void didCreateJavaPlayer();
+    void didUseJavaPlayer();
+    void releaseJavaPlayer();
+
     MediaPlayer* m_player;
     String m_url;
     struct JavaGlue;
@@ -92,13 +102,14 @@ protected:
     MediaPlayer::ReadyState m_readyState;
     MediaPlayer::NetworkState m_networkState;
 
-    SkBitmap* m_poster;  // not owned
+    SkBitmap* m_poster;  // the shared default poster; not owned
     String m_posterUrl;
 
     IntSize m_naturalSize;
     bool m_naturalSizeUnknown;
 
     bool m_isVisible;
+    bool m_autobuffer;
 };
 
 }  // namespace WebCore
@@ -16,28 +16,70 @@
 
 namespace WebCore {
 
+// SkPath already caches its bounds, but hit testing rasterizes the path on
+// every call and the stroke bounds stroke the whole path. SVG asks for both
+// over and over, so keep them until the path changes.
+class PathCache {
+public:
+    PathCache()
+        : m_containsCount(0)
+        , m_hasRegion(false)
+        , m_hasStrokeBounds(false)
+    {
+    }
+
+    // contains()
+    int             m_containsCount;
+    bool            m_hasRegion;
+    WindRule        m_regionRule;
+    SkRegion        m_region;
+
+    // strokeBoundingRect(), keyed by the stroke parameters that change it
+    bool            m_hasStrokeBounds;
+    SkScalar        m_strokeWidth;
+    SkScalar        m_strokeMiter;
+    SkPaint::Cap    m_strokeCap;
+    SkPaint::Join   m_strokeJoin;
+    FloatRect       m_strokeBounds;
+};
+
+// A region is only built for paths hit tested more than once, and only if it
+// stays small.
+#define PATH_REGION_MIN_CONTAINS    2
+#define PATH_REGION_MAX_SIZE        4096
+
 Path::Path()
+    : m_cache(0)
 {
     m_path = new SkPath;
 //    m_path->setFlags(SkPath::kWinding_FillType);
 }
 
 Path::Path(const Path& other)
+    : m_cache(0)
 {
     m_path = new SkPath(*other.m_path);
 }
 
 Path::~Path()
 {
+    delete m_cache;
     delete m_path;
 }
 
 Path& Path::operator=(const Path& other)
 {
+    invalidateCache();
     *m_path = *other.m_path;
     return *this;
 }
 
+void Path::invalidateCache()
+{
+    delete m_cache;
+    m_cache = 0;
+}
+
 bool Path::isEmpty() const
 {
     return m_path->isEmpty();
@@ -58,7 +100,24 @@ bool Path::contains(const FloatPoint& point, WindRule rule) const
     
     int x = (int)floorf(point.x());
     int y = (int)floorf(point.y());
-    clip.setRect(x, y, x + 1, y + 1);
+
+    if (!m_cache)
+        m_cache = new PathCache;
+    if (m_cache->m_hasRegion && m_cache->m_regionRule == rule)
+        return m_cache->m_region.contains(x, y);
+
+    SkIRect bounds;
+    m_path->getBounds().roundOut(&bounds);
+    bool cacheRegion = ++m_cache->m_containsCount >= PATH_REGION_MIN_CONTAINS
+        && bounds.width() <= PATH_REGION_MAX_SIZE
+        && bounds.height() <= PATH_REGION_MAX_SIZE;
+    if (cacheRegion) {
+        // cover the partial pixels on the right and bottom edges as well
+        bounds.fRight++;
+        bounds.fBottom++;
+        clip.setRect(bounds);
+    } else
+        clip.setRect(x, y, x + 1, y + 1);
     
     SkPath::FillType ft = m_path->getFillType();    // save
     m_path->setFillType(rule == RULE_NONZERO ? SkPath::kWinding_FillType : SkPath::kEvenOdd_FillType);
@@ -66,11 +125,19 @@ bool Path::contains(const FloatPoint& point, WindRule rule) const
     bool contains = rgn.setPath(*m_path, clip);
     
     m_path->setFillType(ft);    // restore
+
+    if (cacheRegion) {
+        m_cache->m_region.swap(rgn);
+        m_cache->m_regionRule = rule;
+        m_cache->m_hasRegion = true;
+        return m_cache->m_region.contains(x, y);
+    }
     return contains;
 }
 
 void Path::translate(const FloatSize& size)
 {
+    invalidateCache();
     m_path->offset(SkFloatToScalar(size.width()), SkFloatToScalar(size.height()));
 }
 
@@ -85,22 +152,26 @@ FloatRect Path::boundingRect() const
 
 void Path::moveTo(const FloatPoint& point)
 {
+    invalidateCache();
     m_path->moveTo(SkFloatToScalar(point.x()), SkFloatToScalar(point.y()));
 }
 
 void Path::addLineTo(const FloatPoint& p)
 {
+    invalidateCache();
     m_path->lineTo(SkFloatToScalar(p.x()), SkFloatToScalar(p.y()));
 }
 
 void Path::addQuadCurveTo(const FloatPoint& cp, const FloatPoint& ep)
 {
+    invalidateCache();
     m_path->quadTo( SkFloatToScalar(cp.x()), SkFloatToScalar(cp.y()),
                     SkFloatToScalar(ep.x()), SkFloatToScalar(ep.y()));
 }
 
 void Path::addBezierCurveTo(const FloatPoint& p1, const FloatPoint& p2, const FloatPoint& ep)
 {
+    invalidateCache();
     m_path->cubicTo(SkFloatToScalar(p1.x()), SkFloatToScalar(p1.y()),
                     SkFloatToScalar(p2.x()), SkFloatToScalar(p2.y()),
                     SkFloatToScalar(ep.x()), SkFloatToScalar(ep.y()));
@@ -108,6 +179,7 @@ void Path::addBezierCurveTo(const FloatPoint& p1, const FloatPoint& p2, const Fl
 
 void Path::addArcTo(const FloatPoint& p1, const FloatPoint& p2, float radius)
 {
+    invalidateCache();
     m_path->arcTo(SkFloatToScalar(p1.x()), SkFloatToScalar(p1.y()),
                   SkFloatToScalar(p2.x()), SkFloatToScalar(p2.y()),
                   SkFloatToScalar(radius));
@@ -115,6 +187,7 @@ void Path::addArcTo(const FloatPoint& p1, const FloatPoint& p2, float radius)
 
 void Path::closeSubpath()
 {
+    invalidateCache();
     m_path->close();
 }
 
@@ -131,6 +204,8 @@ static float fast_mod(float angle, float max) {
 
 void Path::addArc(const FloatPoint& p, float r, float sa, float ea,
                   bool clockwise) {
+    invalidateCache();
+
     SkScalar    cx = SkFloatToScalar(p.x());
     SkScalar    cy = SkFloatToScalar(p.y());
     SkScalar    radius = SkFloatToScalar(r);
@@ -181,16 +256,19 @@ void Path::addArc(const FloatPoint& p, float r, float sa, float ea,
 
 void Path::addRect(const FloatRect& rect)
 {
+    invalidateCache();
     m_path->addRect(rect);
 }
 
 void Path::addEllipse(const FloatRect& rect)
 {
+    invalidateCache();
     m_path->addOval(rect);
 }
 
 void Path::clear()
 {
+    invalidateCache();
     m_path->reset();
 }
 
@@ -244,6 +322,7 @@ void Path::apply(void* info, PathApplierFunction function) const
 
 void Path::transform(const AffineTransform& xform)
 {
+    invalidateCache();
     m_path->transform(xform);
 }
 
@@ -307,24 +386,6 @@ String Path::debugString() const
 
 ///////////////////////////////////////////////////////////////////////////////
 
-// Computes the bounding box for the stroke and style currently selected into
-// the given bounding box. This also takes into account the stroke width.
-static FloatRect boundingBoxForCurrentStroke(GraphicsContext* context)
-{
-    const SkPath* path = context->getCurrPath();
-    if (NULL == path) {
-        return FloatRect();
-    }
-
-    SkPaint paint;
-    context->setupStrokePaint(&paint);
-    SkPath fillPath;
-    paint.getFillPath(*path, &fillPath);
-    const SkRect& r = fillPath.getBounds();
-    return FloatRect(SkScalarToFloat(r.fLeft), SkScalarToFloat(r.fTop),
-                     SkScalarToFloat(r.width()), SkScalarToFloat(r.height()));
-}
-    
 static GraphicsContext* scratchContext()
 {
     static ImageBuffer* scratch = 0;
@@ -340,15 +401,41 @@ FloatRect Path::strokeBoundingRect(StrokeStyleApplier* applier)
 {   
     GraphicsContext* scratch = scratchContext();
     scratch->save();
-    scratch->beginPath();
-    scratch->addPath(*this);
     
     if (applier)
         applier->strokeStyle(scratch);
-    
-    FloatRect r = boundingBoxForCurrentStroke(scratch);
+
+    // Computes the bounding box for the stroke and style currently selected
+    // into the scratch context. This also takes into account the stroke width.
+    SkPaint paint;
+    scratch->setupStrokePaint(&paint);
     scratch->restore();
-    return r;
+
+    // A dash only trims the stroke, so don't bother caching those
+    bool cacheable = !paint.getPathEffect();
+    if (cacheable && m_cache && m_cache->m_hasStrokeBounds
+            && m_cache->m_strokeWidth == paint.getStrokeWidth()
+            && m_cache->m_strokeMiter == paint.getStrokeMiter()
+            && m_cache->m_strokeCap == paint.getStrokeCap()
+            && m_cache->m_strokeJoin == paint.getStrokeJoin())
+        return m_cache->m_strokeBounds;
+
+    SkPath fillPath;
+    paint.getFillPath(*m_path, &fillPath);
+    const SkRect& r = fillPath.getBounds();
+    FloatRect bounds(SkScalarToFloat(r.fLeft), SkScalarToFloat(r.fTop),
+                     SkScalarToFloat(r.width()), SkScalarToFloat(r.height()));
+    if (cacheable) {
+        if (!m_cache)
+            m_cache = new PathCache;
+        m_cache->m_hasStrokeBounds = true;
+        m_cache->m_strokeWidth = paint.getStrokeWidth();
+        m_cache->m_strokeMiter = paint.getStrokeMiter();
+        m_cache->m_strokeCap = paint.getStrokeCap();
+        m_cache->m_strokeJoin = paint.getStrokeJoin();
+        m_cache->m_strokeBounds = bounds;
+    }
+    return bounds;
 }
 
 #if ENABLE(SVG)
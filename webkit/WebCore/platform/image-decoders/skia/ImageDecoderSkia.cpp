@@ -3,6 +3,7 @@
 #include "config.h"
 #include "ImageDecoder.h"
 #if PLATFORM(ANDROID)
+#include "BitmapAllocatorAndroid.h"
 #include "SkBitmapRef.h"
 #endif
 
@@ -37,7 +38,12 @@ void RGBA32Buffer::copyBitmapData(const RGBA32Buffer& other)
 
     m_bitmap.reset();
     const NativeImageSkia& otherBitmap = other.m_bitmap;
+#if PLATFORM(ANDROID)
+    otherBitmap.copyTo(&m_bitmap, otherBitmap.config(),
+                       BitmapAllocatorAndroid::pooledAllocator());
+#else
     otherBitmap.copyTo(&m_bitmap, otherBitmap.config());
+#endif
 }
 
 bool RGBA32Buffer::setSize(int newWidth, int newHeight)
@@ -46,8 +52,14 @@ bool RGBA32Buffer::setSize(int newWidth, int newHeight)
     // otherwise.
     ASSERT(width() == 0 && height() == 0);
     m_bitmap.setConfig(SkBitmap::kARGB_8888_Config, newWidth, newHeight);
+#if PLATFORM(ANDROID)
+    // frames of animated images churn, so reuse their buffers
+    if (!m_bitmap.allocPixels(BitmapAllocatorAndroid::pooledAllocator(), 0))
+        return false;
+#else
     if (!m_bitmap.allocPixels())
         return false;
+#endif
 
     // Zero the image.
     zeroFill();
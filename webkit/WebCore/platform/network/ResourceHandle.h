@@ -169,6 +169,8 @@ public:
 #if PLATFORM(ANDROID)
 // TODO: this needs upstreaming.
     void pauseLoad(bool);
+    // priority is a ResourceRequest::Priority
+    void setPriority(int priority, bool renderBlocking);
 #endif
 
     const ResourceRequest& request() const;
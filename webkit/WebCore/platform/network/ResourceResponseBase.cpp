@@ -232,16 +232,32 @@ void ResourceResponseBase::setHTTPHeaderField(const AtomicString& name, const St
     DEFINE_STATIC_LOCAL(const AtomicString, expiresHeader, ("expires"));
     DEFINE_STATIC_LOCAL(const AtomicString, lastModifiedHeader, ("last-modified"));
     DEFINE_STATIC_LOCAL(const AtomicString, pragmaHeader, ("pragma"));
-    if (equalIgnoringCase(name, ageHeader))
-        m_haveParsedAgeHeader = false;
-    else if (equalIgnoringCase(name, cacheControlHeader) || equalIgnoringCase(name, pragmaHeader))
-        m_haveParsedCacheControlHeader = false;
-    else if (equalIgnoringCase(name, dateHeader))
-        m_haveParsedDateHeader = false;
-    else if (equalIgnoringCase(name, expiresHeader))
-        m_haveParsedExpiresHeader = false;
-    else if (equalIgnoringCase(name, lastModifiedHeader))
-        m_haveParsedLastModifiedHeader = false;
+    // Most headers don't affect the parsed values, and the length rules out
+    // nearly all of them without comparing any characters.
+    switch (name.length()) {
+    case 3:
+        if (equalIgnoringCase(name, ageHeader))
+            m_haveParsedAgeHeader = false;
+        break;
+    case 4:
+        if (equalIgnoringCase(name, dateHeader))
+            m_haveParsedDateHeader = false;
+        break;
+    case 6:
+        if (equalIgnoringCase(name, pragmaHeader))
+            m_haveParsedCacheControlHeader = false;
+        break;
+    case 7:
+        if (equalIgnoringCase(name, expiresHeader))
+            m_haveParsedExpiresHeader = false;
+        break;
+    case 13:
+        if (equalIgnoringCase(name, cacheControlHeader))
+            m_haveParsedCacheControlHeader = false;
+        else if (equalIgnoringCase(name, lastModifiedHeader))
+            m_haveParsedLastModifiedHeader = false;
+        break;
+    }
 
     m_httpHeaderFields.set(name, value);
 }
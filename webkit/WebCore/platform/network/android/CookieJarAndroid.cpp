@@ -3,25 +3,75 @@
 #include "config.h"
 
 #include "CookieJar.h"
+#include "CookieJarAndroid.h"
 
 #include "PlatformBridge.h"
+#include "StringHash.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/HashMap.h>
+#include <wtf/StdLibExtras.h>
 
 namespace WebCore {
 
+// The cookies the Java cookie store returned for a URL, kept so that
+// scripts reading document.cookie over and over don't cross JNI each time.
+// Cookies also go away by expiring, which nobody is told about, so an
+// entry is only trusted for a short while.
+struct CachedCookies {
+    String value;
+    double time;
+};
+typedef HashMap<String, CachedCookies> CookieCache;
+
+static const double cookieCacheLifetime = 1; // seconds
+static const unsigned maximumCookieCacheSize = 64;
+
+static CookieCache& cookieCache()
+{
+    DEFINE_STATIC_LOCAL(CookieCache, cache, ());
+    return cache;
+}
+
+static String cachedCookies(const KURL& url)
+{
+    // Which cookies apply doesn't depend on the query or the fragment.
+    String key = url.string().left(url.pathEnd());
+    double now = currentTime();
+
+    CookieCache& cache = cookieCache();
+    CookieCache::iterator it = cache.find(key);
+    if (it != cache.end() && now >= it->second.time && now - it->second.time < cookieCacheLifetime)
+        return it->second.value;
+
+    if (cache.size() >= maximumCookieCacheSize)
+        cache.clear();
+    CachedCookies entry;
+    entry.value = PlatformBridge::cookies(url);
+    entry.time = now;
+    cache.set(key, entry);
+    return entry.value;
+}
+
+void cookiesChanged()
+{
+    cookieCache().clear();
+}
+
 void setCookies(Document*, const KURL& url, const String& value)
 {
     PlatformBridge::setCookies(url, value);
+    cookiesChanged();
 }
 
 String cookies(const Document*, const KURL& url)
 {
-    return PlatformBridge::cookies(url);
+    return cachedCookies(url);
 }
 
 String cookieRequestHeaderFieldValue(const Document*, const KURL& url)
 {
     // FIXME: include HttpOnly cookie.
-    return PlatformBridge::cookies(url);
+    return cachedCookies(url);
 }
 
 bool cookiesEnabled(const Document*)
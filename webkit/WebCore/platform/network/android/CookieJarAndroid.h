@@ -0,0 +1,13 @@
+#ifndef CookieJarAndroid_h
+#define CookieJarAndroid_h
+
+namespace WebCore {
+
+// Drops the cookies cached for document.cookie and request headers. Has to
+// be called on the WebCore thread whenever the Java cookie store changes,
+// for instance when a response sets a cookie.
+void cookiesChanged();
+
+} // namespace WebCore
+
+#endif // CookieJarAndroid_h
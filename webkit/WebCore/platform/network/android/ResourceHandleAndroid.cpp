@@ -76,6 +76,15 @@ void ResourceHandle::pauseLoad(bool pause)
     if (d->m_loader)
         d->m_loader->pauseLoad(pause);
 }
+
+void ResourceHandle::setPriority(int priority, bool renderBlocking)
+{
+    ResourceRequest::Priority requestPriority = static_cast<ResourceRequest::Priority>(priority);
+    d->m_request.setPriority(requestPriority);
+    d->m_request.setRenderBlocking(renderBlocking);
+    if (d->m_loader)
+        d->m_loader->setPriority(requestPriority, renderBlocking);
+}
 #endif
 
 void ResourceHandle::setDefersLoading(bool defers)
@@ -22,6 +22,8 @@ public:
     // ANDROID TODO: This needs to be upstreamed.
     virtual void pauseLoad(bool) = 0;
     // END ANDROID TODO
+    // Reorder the load within the network stack's queue
+    virtual void setPriority(ResourceRequest::Priority, bool renderBlocking) = 0;
 
     // Call to java to find out if this URL is in the cache
     static bool willLoadFromCache(const WebCore::KURL&, int64_t identifier);
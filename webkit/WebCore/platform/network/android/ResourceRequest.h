@@ -10,27 +10,38 @@ namespace WebCore {
 
 class ResourceRequest : public ResourceRequestBase {
 public:
+    // Mirrors Loader::Priority so the network stack can order requests the
+    // way WebCore queues them.
+    enum Priority { PriorityLow, PriorityMedium, PriorityHigh };
+
     ResourceRequest(const String& url)
-        : ResourceRequestBase(KURL(ParsedURLString, url), UseProtocolCachePolicy), m_userGesture(true) { }
+        : ResourceRequestBase(KURL(ParsedURLString, url), UseProtocolCachePolicy), m_userGesture(true), m_priority(PriorityHigh), m_renderBlocking(false) { }
 
-    ResourceRequest(const KURL& url) : ResourceRequestBase(url, UseProtocolCachePolicy) , m_userGesture(true) { }
+    ResourceRequest(const KURL& url) : ResourceRequestBase(url, UseProtocolCachePolicy) , m_userGesture(true), m_priority(PriorityHigh), m_renderBlocking(false) { }
 
     ResourceRequest(const KURL& url, const String& referrer, ResourceRequestCachePolicy policy = UseProtocolCachePolicy)
-        : ResourceRequestBase(url, policy) , m_userGesture(true)
+        : ResourceRequestBase(url, policy) , m_userGesture(true), m_priority(PriorityHigh), m_renderBlocking(false)
     {
         setHTTPReferrer(referrer);
     }
 
-    ResourceRequest() : ResourceRequestBase(KURL(), UseProtocolCachePolicy), m_userGesture(true) { }
+    ResourceRequest() : ResourceRequestBase(KURL(), UseProtocolCachePolicy), m_userGesture(true), m_priority(PriorityHigh), m_renderBlocking(false) { }
 
     void doUpdatePlatformRequest() { }
     void doUpdateResourceRequest() { }
     void setUserGesture(bool userGesture) { m_userGesture = userGesture; }
     bool getUserGesture() const { return m_userGesture; }
+    void setPriority(Priority priority) { m_priority = priority; }
+    Priority priority() const { return m_priority; }
+    // True if the document can not paint until this request completes
+    void setRenderBlocking(bool renderBlocking) { m_renderBlocking = renderBlocking; }
+    bool isRenderBlocking() const { return m_renderBlocking; }
 
 private:
     friend class ResourceRequestBase;
     bool m_userGesture;
+    Priority m_priority;
+    bool m_renderBlocking;
 };
 
 } // namespace WebCore
@@ -57,6 +57,8 @@ bool SQLiteDatabase::open(const String& filename)
 
 void SQLiteDatabase::close()
 {
+    // sqlite3_close() fails while any statement is still prepared.
+    clearStatementCache();
     if (m_db) {
         // FIXME: This is being called on themain thread during JS GC. <rdar://problem/5739818>
         // ASSERT(currentThread() == m_openingThread);
@@ -143,6 +145,45 @@ void SQLiteDatabase::setSynchronous(SynchronousPragma sync)
     executeCommand(String::format("PRAGMA synchronous = %i", sync));
 }
 
+static bool writeAheadLogEnabled = false;
+
+void SQLiteDatabase::setWriteAheadLogEnabled(bool enabled)
+{
+    writeAheadLogEnabled = enabled;
+}
+
+#if SQLITE_VERSION_NUMBER >= 3007000
+// The default of 1000 pages lets the log grow to a few megabytes, and a
+// checkpoint that large stalls the database thread on slow flash.
+static const int writeAheadLogCheckpointPages = 100;
+#endif
+
+bool SQLiteDatabase::useWriteAheadLog()
+{
+    if (!writeAheadLogEnabled || !m_db)
+        return false;
+
+#if SQLITE_VERSION_NUMBER >= 3007000
+    MutexLocker locker(m_authorizerLock);
+    enableAuthorizer(false);
+
+    SQLiteStatement statement(*this, "PRAGMA journal_mode = WAL");
+    bool usingWriteAheadLog = statement.prepareAndStep() == SQLITE_ROW && equalIgnoringCase(statement.getColumnText(0), "wal");
+    statement.finalize();
+    if (usingWriteAheadLog) {
+        // A WAL database stays consistent without syncing on every commit.
+        executeCommand(String::format("PRAGMA synchronous = %i", SyncNormal));
+        sqlite3_wal_autocheckpoint(m_db, writeAheadLogCheckpointPages);
+    } else
+        LOG_ERROR("SQLite database could not switch to write-ahead logging");
+
+    enableAuthorizer(true);
+    return usingWriteAheadLog;
+#else
+    return false;
+#endif
+}
+
 void SQLiteDatabase::setBusyTimeout(int ms)
 {
     if (m_db)
@@ -327,6 +368,73 @@ void SQLiteDatabase::enableAuthorizer(bool enable)
         sqlite3_set_authorizer(m_db, NULL, 0);
 }
 
+static const size_t maximumCachedStatements = 16;
+
+sqlite3_stmt* SQLiteDatabase::takeCachedStatement(const String& query)
+{
+    MutexLocker locker(m_authorizerLock);
+    size_t size = m_statementCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        CachedStatement& entry = m_statementCache[i];
+        if (entry.query != query)
+            continue;
+        // Let a fresh prepare run the authorizer's read-only checks.
+        if (m_authorizer && m_authorizer->isReadOnly() && !entry.preparedReadOnly)
+            return 0;
+        if (m_authorizer)
+            m_authorizer->setLastActions(entry.wasInsert, entry.changedDatabase);
+        sqlite3_stmt* statement = entry.statement;
+        m_statementCache.remove(i);
+        return statement;
+    }
+    return 0;
+}
+
+void SQLiteDatabase::cacheStatement(const String& query, sqlite3_stmt* statement)
+{
+    MutexLocker locker(m_authorizerLock);
+    // Statements prepared with sqlite3_prepare_v2 prepare themselves again
+    // after a schema change, but the ones the cache holds may now be for
+    // tables that are gone, so start over.
+    if (m_authorizer && m_authorizer->lastActionChangedSchema()) {
+        sqlite3_finalize(statement);
+        clearStatementCache();
+        return;
+    }
+
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+
+    size_t size = m_statementCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        if (m_statementCache[i].query == query) {
+            sqlite3_finalize(m_statementCache[i].statement);
+            m_statementCache.remove(i);
+            break;
+        }
+    }
+    if (m_statementCache.size() == maximumCachedStatements) {
+        sqlite3_finalize(m_statementCache[0].statement);
+        m_statementCache.remove(0);
+    }
+
+    CachedStatement entry;
+    entry.query = query;
+    entry.statement = statement;
+    entry.preparedReadOnly = m_authorizer && m_authorizer->isReadOnly();
+    entry.wasInsert = m_authorizer && m_authorizer->lastActionWasInsert();
+    entry.changedDatabase = m_authorizer && m_authorizer->lastActionChangedDatabase();
+    m_statementCache.append(entry);
+}
+
+void SQLiteDatabase::clearStatementCache()
+{
+    size_t size = m_statementCache.size();
+    for (size_t i = 0; i < size; ++i)
+        sqlite3_finalize(m_statementCache[i].statement);
+    m_statementCache.clear();
+}
+
 void SQLiteDatabase::lock()
 {
     m_lockingMutex.lock();
@@ -5,12 +5,14 @@
 
 #include "PlatformString.h"
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 #if COMPILER(MSVC)
 #pragma warning(disable: 4800)
 #endif
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace WebCore {
 
@@ -68,6 +70,15 @@ public:
     // OFF - Calls return immediately after the data has been passed to disk
     enum SynchronousPragma { SyncOff = 0, SyncNormal = 1, SyncFull = 2 };
     void setSynchronous(SynchronousPragma);
+
+    // Write-ahead logging is only used once the embedder enables it; it is
+    // off by default.
+    static void setWriteAheadLogEnabled(bool);
+    // Switches the database to write-ahead logging when that is enabled and
+    // SQLite supports it. Commits then append to the log and only sync it,
+    // and the log is folded back into the database in small checkpoints.
+    // Returns whether the database is now in WAL mode.
+    bool useWriteAheadLog();
     
     int lastError();
     const char* lastErrorMsg();
@@ -84,9 +95,19 @@ public:
     void unlock();
     bool isAutoCommitOn() const;
 
+    // Finalizes the statements kept for SQLiteStatement::prepareCached().
+    void clearStatementCache();
+
 private:
+    friend class SQLiteStatement;
+
     static int authorizerFunction(void*, int, const char*, const char*, const char*, const char*);
 
+    // Returns the cached statement for query, reset and unbound, or 0. The
+    // statement leaves the cache until it is handed back.
+    sqlite3_stmt* takeCachedStatement(const String& query);
+    void cacheStatement(const String& query, sqlite3_stmt*);
+
     void enableAuthorizer(bool enable);
     
     int pageSize();
@@ -102,6 +123,18 @@ private:
 
     Mutex m_lockingMutex;
     ThreadIdentifier m_openingThread;
+
+    // What the authorizer saw when the statement was prepared, so that reusing
+    // it reports the same actions and never bypasses a read-only check.
+    struct CachedStatement {
+        String query;
+        sqlite3_stmt* statement;
+        bool preparedReadOnly;
+        bool wasInsert;
+        bool changedDatabase;
+    };
+    // Least recently used first
+    Vector<CachedStatement> m_statementCache;
     
 }; // class SQLiteDatabase
 
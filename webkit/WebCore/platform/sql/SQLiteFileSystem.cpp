@@ -83,6 +83,10 @@ bool SQLiteFileSystem::deleteEmptyDatabaseDirectory(const String& path)
 
 bool SQLiteFileSystem::deleteDatabaseFile(const String& fileName)
 {
+    // Databases in write-ahead logging mode leave their log and its index
+    // next to the database file.
+    deleteFile(fileName + "-wal");
+    deleteFile(fileName + "-shm");
     return deleteFile(fileName);
 }
 
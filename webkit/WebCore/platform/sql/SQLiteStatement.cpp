@@ -24,6 +24,7 @@ SQLiteStatement::SQLiteStatement(SQLiteDatabase& db, const String& sql)
     : m_database(db)
     , m_query(sql)
     , m_statement(0)
+    , m_cached(false)
 #ifndef NDEBUG
     , m_isPrepared(false)
 #endif
@@ -49,6 +50,20 @@ int SQLiteStatement::prepare()
     return error;
 }
 
+int SQLiteStatement::prepareCached()
+{
+    ASSERT(!m_isPrepared);
+    m_cached = true;
+    m_statement = m_database.takeCachedStatement(m_query);
+    if (!m_statement)
+        return prepare();
+    LOG(SQLDatabase, "SQL - reuse - %s", m_query.ascii().data());
+#ifndef NDEBUG
+    m_isPrepared = true;
+#endif
+    return SQLITE_OK;
+}
+
 int SQLiteStatement::step()
 {
     ASSERT(m_isPrepared);
@@ -70,6 +85,12 @@ int SQLiteStatement::finalize()
 #endif
     if (!m_statement)
         return SQLITE_OK;
+    if (m_cached) {
+        m_cached = false;
+        m_database.cacheStatement(m_query, m_statement);
+        m_statement = 0;
+        return SQLITE_OK;
+    }
     LOG(SQLDatabase, "SQL - finalize - %s", m_query.ascii().data());
     int result = sqlite3_finalize(m_statement);
     m_statement = 0;
@@ -17,6 +17,10 @@ public:
     ~SQLiteStatement();
     
     int prepare();
+    // Like prepare(), but reuses the database's cached statement for the
+    // query when there is one, and hands the statement back to the cache
+    // instead of finalizing it.
+    int prepareCached();
     int bindBlob(int index, const void* blob, int size);
     int bindText(int index, const String&);
     int bindInt64(int index, int64_t);
@@ -69,6 +73,7 @@ private:
     SQLiteDatabase& m_database;
     String m_query;
     sqlite3_stmt* m_statement;
+    bool m_cached;
 #ifndef NDEBUG
     bool m_isPrepared;
 #endif
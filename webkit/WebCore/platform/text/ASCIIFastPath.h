@@ -0,0 +1,65 @@
+#ifndef ASCIIFastPath_h
+#define ASCIIFastPath_h
+
+#include <stdint.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace WebCore {
+
+// Helpers for code that handles runs of characters a machine word at a time.
+
+typedef uintptr_t MachineWord;
+const uintptr_t machineWordAlignmentMask = sizeof(MachineWord) - 1;
+
+inline bool isAlignedToMachineWord(const void* pointer)
+{
+    return !(reinterpret_cast<uintptr_t>(pointer) & machineWordAlignmentMask);
+}
+
+inline bool isAllASCII(MachineWord word)
+{
+    return !(word & static_cast<MachineWord>(0x8080808080808080ULL));
+}
+
+// True if any of the UChars packed into word is below limit, which can be
+// at most 0x8000. Lanes above the first one that is below limit can be
+// reported too, so this is only good for telling whether a word can be
+// skipped.
+inline bool containsCharacterBelow(MachineWord word, UChar limit)
+{
+    const MachineWord lowBits = static_cast<MachineWord>(0x0001000100010001ULL);
+    const MachineWord highBits = static_cast<MachineWord>(0x8000800080008000ULL);
+    return (word - lowBits * limit) & ~word & highBits;
+}
+
+inline void copyASCIIMachineWord(UChar* destination, const unsigned char* source)
+{
+    for (size_t i = 0; i < sizeof(MachineWord); ++i)
+        destination[i] = source[i];
+}
+
+// Widens the ASCII that starts at source, a word at a time where source is
+// aligned. Returns how many bytes were copied.
+inline size_t copyASCII(UChar* destination, const unsigned char* source, const unsigned char* end)
+{
+    const unsigned char* start = source;
+    while (source < end) {
+        if (isAlignedToMachineWord(source)) {
+            while (source + sizeof(MachineWord) <= end && isAllASCII(*reinterpret_cast<const MachineWord*>(source))) {
+                copyASCIIMachineWord(destination, source);
+                source += sizeof(MachineWord);
+                destination += sizeof(MachineWord);
+            }
+            if (source == end)
+                break;
+        }
+        if (*source & 0x80)
+            break;
+        *destination++ = *source++;
+    }
+    return source - start;
+}
+
+} // namespace WebCore
+
+#endif // ASCIIFastPath_h
@@ -75,11 +75,6 @@ PassRefPtr<StringImpl> AtomicString::add(const char* c)
     return adoptRef(*addResult.first);
 }
 
-struct UCharBuffer {
-    const UChar* s;
-    unsigned length;
-};
-
 static inline bool equal(StringImpl* string, const UChar* characters, unsigned length)
 {
     if (string->length() != length)
@@ -113,25 +108,6 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
 #endif
 }
 
-struct UCharBufferTranslator {
-    static unsigned hash(const UCharBuffer& buf)
-    {
-        return StringImpl::computeHash(buf.s, buf.length);
-    }
-
-    static bool equal(StringImpl* const& str, const UCharBuffer& buf)
-    {
-        return WebCore::equal(str, buf.s, buf.length);
-    }
-
-    static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
-    {
-        location = StringImpl::create(buf.s, buf.length).releaseRef(); 
-        location->setHash(hash);
-        location->setInTable();
-    }
-};
-
 struct HashAndCharacters {
     unsigned hash;
     const UChar* characters;
@@ -147,7 +123,9 @@ struct HashAndCharactersTranslator {
 
     static bool equal(StringImpl* const& string, const HashAndCharacters& buffer)
     {
-        return WebCore::equal(string, buffer.characters, buffer.length);
+        // Every string in the table has its hash computed, and comparing it
+        // first keeps collisions from touching the characters.
+        return string->existingHash() == buffer.hash && WebCore::equal(string, buffer.characters, buffer.length);
     }
 
     static void translate(StringImpl*& location, const HashAndCharacters& buffer, unsigned hash)
@@ -166,14 +144,27 @@ PassRefPtr<StringImpl> AtomicString::add(const UChar* s, int length)
     if (length == 0)
         return StringImpl::empty();
     
-    UCharBuffer buf = { s, length }; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<UCharBuffer, UCharBufferTranslator>(buf);
+    HashAndCharacters buffer = { StringImpl::computeHash(s, length), s, length }; 
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<HashAndCharacters, HashAndCharactersTranslator>(buffer);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
     return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
 }
 
+PassRefPtr<StringImpl> AtomicString::add(const UChar* s, unsigned length, unsigned existingHash)
+{
+    ASSERT(s);
+    ASSERT(existingHash);
+
+    if (!length)
+        return StringImpl::empty();
+
+    HashAndCharacters buffer = { existingHash, s, length };
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
+}
+
 PassRefPtr<StringImpl> AtomicString::add(const UChar* s)
 {
     if (!s)
@@ -186,8 +177,8 @@ PassRefPtr<StringImpl> AtomicString::add(const UChar* s)
     if (length == 0)
         return StringImpl::empty();
 
-    UCharBuffer buf = {s, length}; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<UCharBuffer, UCharBufferTranslator>(buf);
+    HashAndCharacters buffer = { StringImpl::computeHash(s, length), s, length }; 
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<HashAndCharacters, HashAndCharactersTranslator>(buffer);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
@@ -208,6 +199,91 @@ PassRefPtr<StringImpl> AtomicString::add(StringImpl* r)
     return result;
 }
 
+struct StaticNameBuffer {
+    unsigned hash;
+    const char* characters;
+    unsigned length;
+};
+
+struct StaticNameTranslator {
+    static unsigned hash(const StaticNameBuffer& buffer)
+    {
+        return buffer.hash;
+    }
+
+    static bool equal(StringImpl* const& string, const StaticNameBuffer& buffer)
+    {
+        if (string->length() != buffer.length)
+            return false;
+        const UChar* characters = string->characters();
+        for (unsigned i = 0; i != buffer.length; ++i) {
+            if (characters[i] != static_cast<unsigned char>(buffer.characters[i]))
+                return false;
+        }
+        return true;
+    }
+
+    static void translate(StringImpl*& location, const StaticNameBuffer& buffer, unsigned hash)
+    {
+        location = StringImpl::create(buffer.characters, buffer.length).releaseRef();
+        location->setHash(hash);
+        location->setInTable();
+    }
+};
+
+// Open addressed, with linear probing; there are about a thousand static
+// names in all the namespaces together. Entries are never removed.
+static const unsigned staticNameTableSize = 2048;
+static const unsigned staticNameTableMask = staticNameTableSize - 1;
+static StringImpl* staticNameTable[staticNameTableSize];
+static unsigned staticNameCount;
+
+AtomicStringImpl* AtomicString::addStatic(const char* characters, unsigned length, unsigned hash)
+{
+    ASSERT(isMainThread());
+    ASSERT(length);
+    ASSERT(hash == StringImpl::computeHash(characters));
+
+    StaticNameBuffer buffer = { hash, characters, length };
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<StaticNameBuffer, StaticNameTranslator>(buffer);
+    StringImpl* name = *addResult.first;
+    // The table holds the reference a new string comes with, so that static
+    // names are never freed.
+    if (!addResult.second)
+        name->ref();
+
+    unsigned i = hash & staticNameTableMask;
+    while (staticNameTable[i]) {
+        if (staticNameTable[i] == name) {
+            // Names like "title" are in several namespaces.
+            name->deref();
+            return static_cast<AtomicStringImpl*>(name);
+        }
+        i = (i + 1) & staticNameTableMask;
+    }
+    // Keep the table at most half full, so that misses stay short.
+    if (staticNameCount < staticNameTableSize / 2) {
+        staticNameTable[i] = name;
+        ++staticNameCount;
+    }
+    return static_cast<AtomicStringImpl*>(name);
+}
+
+AtomicString AtomicString::addName(const UChar* characters, unsigned length)
+{
+    ASSERT(isMainThread());
+    if (!length)
+        return emptyAtom;
+
+    unsigned hash = StringImpl::computeHash(characters, length);
+    for (unsigned i = hash & staticNameTableMask; StringImpl* name = staticNameTable[i]; i = (i + 1) & staticNameTableMask) {
+        if (name->existingHash() == hash && equal(name, characters, length))
+            return static_cast<AtomicStringImpl*>(name);
+    }
+    RefPtr<StringImpl> name = add(characters, length, hash);
+    return static_cast<AtomicStringImpl*>(name.get());
+}
+
 void AtomicString::remove(StringImpl* r)
 {
     stringTable().remove(r);
@@ -42,6 +42,14 @@ public:
     static AtomicStringImpl* find(const JSC::Identifier&);
 #endif
 
+    // Adds a name that is compiled in along with its hash, as make_names.pl
+    // generates them, and keeps it in a fixed table that addName() reads
+    // before the thread's own table. Main thread only.
+    static AtomicStringImpl* addStatic(const char* characters, unsigned length, unsigned hash);
+    // For tag and attribute names from a tokenizer, most of which are
+    // static. Main thread only.
+    static AtomicString addName(const UChar*, unsigned length);
+
     operator const String&() const { return m_string; }
     const String& string() const { return m_string; };
 
@@ -104,6 +112,7 @@ private:
     
     static PassRefPtr<StringImpl> add(const char*);
     static PassRefPtr<StringImpl> add(const UChar*, int length);
+    static PassRefPtr<StringImpl> add(const UChar*, unsigned length, unsigned existingHash);
     static PassRefPtr<StringImpl> add(const UChar*);
     static PassRefPtr<StringImpl> add(StringImpl*);
 #if USE(JSC)
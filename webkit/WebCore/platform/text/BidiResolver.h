@@ -144,6 +144,10 @@ public :
     void commitExplicitEmbedding();
 
     void createBidiRunsForLine(const Iterator& end, bool visualOrder = false, bool hardLineBreak = false);
+    // For lines whose runs the caller has added itself, all at the level of
+    // the current context: ends the line at end without resolving it, and
+    // leaves the status as a hard line break would.
+    void finishLineWithoutReordering(const Iterator& end);
 
     Run* firstRun() const { return m_firstRun; }
     Run* lastRun() const { return m_lastRun; }
@@ -493,6 +497,19 @@ void BidiResolver<Iterator, Run>::reverseRuns(unsigned start, unsigned end)
         m_lastRun = startRun;
 }
 
+template <class Iterator, class Run>
+void BidiResolver<Iterator, Run>::finishLineWithoutReordering(const Iterator& end)
+{
+    ASSERT(m_direction == WTF::Unicode::OtherNeutral);
+
+    current = end;
+    WTF::Unicode::Direction direction = context()->dir();
+    m_status.eor = direction;
+    m_status.last = direction;
+    m_status.lastStrong = direction;
+    m_logicallyLastRun = m_lastRun;
+}
+
 template <class Iterator, class Run>
 void BidiResolver<Iterator, Run>::createBidiRunsForLine(const Iterator& end, bool visualOrder, bool hardLineBreak)
 {
@@ -7,7 +7,7 @@ namespace WebCore {
 
 SegmentedString::SegmentedString(const SegmentedString &other) :
     m_pushedChar1(other.m_pushedChar1), m_pushedChar2(other.m_pushedChar2), m_currentString(other.m_currentString),
-    m_substrings(other.m_substrings), m_composite(other.m_composite)
+    m_substrings(other.m_substrings), m_substringsLength(other.m_substringsLength), m_composite(other.m_composite)
 {
     if (other.m_currentChar == &other.m_pushedChar1)
         m_currentChar = &m_pushedChar1;
@@ -23,6 +23,7 @@ const SegmentedString& SegmentedString::operator=(const SegmentedString &other)
     m_pushedChar2 = other.m_pushedChar2;
     m_currentString = other.m_currentString;
     m_substrings = other.m_substrings;
+    m_substringsLength = other.m_substringsLength;
     m_composite = other.m_composite;
     if (other.m_currentChar == &other.m_pushedChar1)
         m_currentChar = &m_pushedChar1;
@@ -35,18 +36,12 @@ const SegmentedString& SegmentedString::operator=(const SegmentedString &other)
 
 unsigned SegmentedString::length() const
 {
-    unsigned length = m_currentString.m_length;
+    unsigned length = m_currentString.m_length + m_substringsLength;
     if (m_pushedChar1) {
         ++length;
         if (m_pushedChar2)
             ++length;
     }
-    if (m_composite) {
-        Deque<SegmentedSubstring>::const_iterator it = m_substrings.begin();
-        Deque<SegmentedSubstring>::const_iterator e = m_substrings.end();
-        for (; it != e; ++it)
-            length += it->m_length;
-    }
     return length;
 }
 
@@ -68,6 +63,7 @@ void SegmentedString::clear()
     m_currentChar = 0;
     m_currentString.clear();
     m_substrings.clear();
+    m_substringsLength = 0;
     m_composite = false;
 }
 
@@ -78,6 +74,7 @@ void SegmentedString::append(const SegmentedSubstring &s)
             m_currentString = s;
         } else {
             m_substrings.append(s);
+            m_substringsLength += s.m_length;
             m_composite = true;
         }
     }
@@ -92,6 +89,7 @@ void SegmentedString::prepend(const SegmentedSubstring &s)
         else {
             // Shift our m_currentString into our list.
             m_substrings.prepend(m_currentString);
+            m_substringsLength += m_currentString.m_length;
             m_currentString = s;
             m_composite = true;
         }
@@ -130,6 +128,7 @@ void SegmentedString::advanceSubstring()
     if (m_composite) {
         m_currentString = m_substrings.first();
         m_substrings.removeFirst();
+        m_substringsLength -= m_currentString.m_length;
         if (m_substrings.isEmpty())
             m_composite = false;
     } else {
@@ -139,19 +138,25 @@ void SegmentedString::advanceSubstring()
 
 String SegmentedString::toString() const
 {
-    String result;
+    // A single substring can be handed back without copying it.
+    if (!m_pushedChar1 && !m_composite) {
+        String result;
+        m_currentString.appendTo(result);
+        return result;
+    }
+
+    UChar* characters;
+    String result = String::createUninitialized(length(), characters);
     if (m_pushedChar1) {
-        result.append(m_pushedChar1);
+        *characters++ = m_pushedChar1;
         if (m_pushedChar2)
-            result.append(m_pushedChar2);
-    }
-    m_currentString.appendTo(result);
-    if (m_composite) {
-        Deque<SegmentedSubstring>::const_iterator it = m_substrings.begin();
-        Deque<SegmentedSubstring>::const_iterator e = m_substrings.end();
-        for (; it != e; ++it)
-            it->appendTo(result);
+            *characters++ = m_pushedChar2;
     }
+    characters = m_currentString.copyTo(characters);
+    Deque<SegmentedSubstring>::const_iterator it = m_substrings.begin();
+    Deque<SegmentedSubstring>::const_iterator e = m_substrings.end();
+    for (; it != e; ++it)
+        characters = it->copyTo(characters);
     return result;
 }
 
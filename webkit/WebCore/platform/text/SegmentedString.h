@@ -42,6 +42,12 @@ public:
         }
     }
 
+    UChar* copyTo(UChar* destination) const
+    {
+        memcpy(destination, m_current, m_length * sizeof(UChar));
+        return destination + m_length;
+    }
+
 public:
     int m_length;
     const UChar* m_current;
@@ -54,12 +60,12 @@ private:
 class SegmentedString {
 public:
     SegmentedString()
-        : m_pushedChar1(0), m_pushedChar2(0), m_currentChar(0), m_composite(false) {}
+        : m_pushedChar1(0), m_pushedChar2(0), m_currentChar(0), m_substringsLength(0), m_composite(false) {}
     SegmentedString(const UChar* str, int length) : m_pushedChar1(0), m_pushedChar2(0)
-        , m_currentString(str, length), m_currentChar(m_currentString.m_current), m_composite(false) {}
+        , m_currentString(str, length), m_currentChar(m_currentString.m_current), m_substringsLength(0), m_composite(false) {}
     SegmentedString(const String& str)
         : m_pushedChar1(0), m_pushedChar2(0), m_currentString(str)
-        , m_currentChar(m_currentString.m_current), m_composite(false) {}
+        , m_currentChar(m_currentString.m_current), m_substringsLength(0), m_composite(false) {}
     SegmentedString(const SegmentedString&);
 
     const SegmentedString& operator=(const SegmentedString&);
@@ -131,6 +137,25 @@ public:
     }
     
     bool escaped() const { return m_pushedChar1; }
+
+    // For scanning runs of characters in place. Returns the characters from
+    // the current one up to, but not including, the last character of the
+    // current substring; pushed characters make the run empty.
+    const UChar* currentRun(int& length) const
+    {
+        length = m_pushedChar1 || m_currentString.m_length < 1 ? 0 : m_currentString.m_length - 1;
+        return m_currentString.m_current;
+    }
+
+    // Skips count characters of the current run, none of which may be
+    // newlines.
+    void advancePastNonNewlines(int count)
+    {
+        ASSERT(!m_pushedChar1 && count < m_currentString.m_length);
+        m_currentString.m_length -= count;
+        m_currentString.m_current += count;
+        m_currentChar = m_currentString.m_current;
+    }
     
     String toString() const;
 
@@ -151,6 +176,9 @@ private:
     SegmentedSubstring m_currentString;
     const UChar* m_currentChar;
     Deque<SegmentedSubstring> m_substrings;
+    // The number of characters in m_substrings, so that length() doesn't
+    // have to walk them. The tokenizer asks for it at every tag.
+    unsigned m_substringsLength;
     bool m_composite;
 };
 
@@ -658,14 +658,20 @@ String String::fromUTF8(const char* string, size_t size)
 {
     if (!string)
         return String();
-    return UTF8Encoding().decode(string, size);
+    // ASCII reads the same in Latin-1, which saves creating a codec for
+    // short strings like the names a parser hands over.
+    for (size_t i = 0; i < size; ++i) {
+        if (string[i] & 0x80)
+            return UTF8Encoding().decode(string, size);
+    }
+    return String(string, size);
 }
 
 String String::fromUTF8(const char* string)
 {
     if (!string)
         return String();
-    return UTF8Encoding().decode(string, strlen(string));
+    return fromUTF8(string, strlen(string));
 }
 
 String String::fromUTF8WithLatin1Fallback(const char* string, size_t size)
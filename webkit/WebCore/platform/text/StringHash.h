@@ -28,6 +28,11 @@ namespace WebCore {
             if (!a || !b)
                 return false;
 
+            // Both hashes are usually already computed, so this rejects most
+            // collisions without reading either string's characters.
+            if (a->hash() != b->hash())
+                return false;
+
             unsigned aLength = a->length();
             unsigned bLength = b->length();
             if (aLength != bLength)
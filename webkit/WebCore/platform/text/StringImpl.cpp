@@ -1029,8 +1029,14 @@ PassRefPtr<StringImpl> StringImpl::crossThreadString()
         return impl.release();
     }
 
-    // If no shared buffer is available, create a copy.
-    return threadsafeCopy();
+    // If no shared buffer is available, create a copy. A long one gets a
+    // buffer of its own, so that the other thread can pass it on or make a
+    // JS string of it without copying it again.
+    if (m_length < minLengthToShare)
+        return threadsafeCopy();
+    UChar* data = newUCharVector(m_length);
+    memcpy(data, m_data, m_length * sizeof(UChar));
+    return adoptRef(new StringImpl(data, m_length));
 }
 
 StringImpl::SharedUChar* StringImpl::sharedBuffer()
@@ -32,7 +32,6 @@ class StringBuffer;
 struct CStringTranslator;
 struct HashAndCharactersTranslator;
 struct StringHash;
-struct UCharBufferTranslator;
 
 enum TextCaseSensitivity { TextCaseSensitive, TextCaseInsensitive };
 
@@ -41,7 +40,6 @@ typedef bool (*CharacterMatchFunctionPtr)(UChar);
 class StringImpl : public RefCounted<StringImpl> {
     friend struct CStringTranslator;
     friend struct HashAndCharactersTranslator;
-    friend struct UCharBufferTranslator;
 private:
     friend class ThreadGlobalData;
     StringImpl();
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "TextCodecLatin1.h"
 
+#include "ASCIIFastPath.h"
 #include "CString.h"
 #include "PlatformString.h"
 #include "StringBuffer.h"
@@ -99,21 +100,17 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
     UChar* characters;
     String result = String::createUninitialized(length, characters);
 
-    // Convert the string a fast way and simultaneously do an efficient check to see if it's all ASCII.
-    unsigned char ored = 0;
-    for (size_t i = 0; i < length; ++i) {
-        unsigned char c = bytes[i];
-        characters[i] = c;
-        ored |= c;
-    }
-
-    if (!(ored & 0x80))
-        return result;
-
-    // Convert the slightly slower way when there are non-ASCII characters.
-    for (size_t i = 0; i < length; ++i) {
-        unsigned char c = bytes[i];
-        characters[i] = table[c];
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(bytes);
+    const unsigned char* end = source + length;
+    UChar* destination = characters;
+    while (source < end) {
+        size_t asciiLength = copyASCII(destination, source, end);
+        source += asciiLength;
+        destination += asciiLength;
+
+        // Convert the slightly slower way up to the next ASCII character.
+        while (source < end && (*source & 0x80))
+            *destination++ = table[*source++];
     }
 
     return result;
@@ -0,0 +1,239 @@
+
+
+#include "config.h"
+#include "TextCodecUTF8.h"
+
+#include "ASCIIFastPath.h"
+#include "CString.h"
+#include "CharacterNames.h"
+#include "PlatformString.h"
+#include "StringBuffer.h"
+#include <wtf/PassOwnPtr.h>
+
+using namespace std;
+
+namespace WebCore {
+
+void TextCodecUTF8::registerEncodingNames(EncodingNameRegistrar registrar)
+{
+    registrar("UTF-8", "UTF-8");
+
+    registrar("unicode11utf8", "UTF-8");
+    registrar("unicode20utf8", "UTF-8");
+    registrar("xunicode20utf8", "UTF-8");
+}
+
+static PassOwnPtr<TextCodec> newStreamingTextDecoderUTF8(const TextEncoding&, const void*)
+{
+    return new TextCodecUTF8;
+}
+
+void TextCodecUTF8::registerCodecs(TextCodecRegistrar registrar)
+{
+    registrar("UTF-8", newStreamingTextDecoderUTF8, 0);
+}
+
+// Returns the length of the sequence that starts with byte, or 0 if byte
+// can't start one. C0 and C1 could only start overlong sequences, and bytes
+// from F5 up sequences for values above U+10FFFF.
+static inline int sequenceLength(unsigned char byte)
+{
+    if (byte < 0x80)
+        return 1;
+    if (byte < 0xC2)
+        return 0;
+    if (byte < 0xE0)
+        return 2;
+    if (byte < 0xF0)
+        return 3;
+    if (byte < 0xF5)
+        return 4;
+    return 0;
+}
+
+// Returns how many of the available bytes of the sequence of the given
+// length that starts at sequence are valid so far.
+static inline int validPrefixLength(const unsigned char* sequence, int length, int available)
+{
+    if (available < 2)
+        return available;
+
+    // The second byte also rules out overlong sequences, surrogates and
+    // values above U+10FFFF.
+    unsigned char lowerBound = 0x80;
+    unsigned char upperBound = 0xBF;
+    switch (sequence[0]) {
+    case 0xE0:
+        lowerBound = 0xA0;
+        break;
+    case 0xED:
+        upperBound = 0x9F;
+        break;
+    case 0xF0:
+        lowerBound = 0x90;
+        break;
+    case 0xF4:
+        upperBound = 0x8F;
+        break;
+    }
+    if (sequence[1] < lowerBound || sequence[1] > upperBound)
+        return 1;
+
+    int valid = 2;
+    while (valid < length && valid < available && (sequence[valid] & 0xC0) == 0x80)
+        ++valid;
+    return valid;
+}
+
+// Decodes the sequence at the start of [sequence, end), setting character
+// to the value or to -1 if the sequence is invalid. Returns how many bytes
+// were used, or 0 if the bytes are the start of a sequence that is cut off
+// by end.
+static inline int decodeSequence(const unsigned char* sequence, const unsigned char* end, UChar32& character)
+{
+    int length = sequenceLength(sequence[0]);
+    if (length == 1) {
+        character = sequence[0];
+        return 1;
+    }
+    if (!length) {
+        character = -1;
+        return 1;
+    }
+
+    int available = min<ptrdiff_t>(end - sequence, length);
+    int valid = validPrefixLength(sequence, length, available);
+    if (valid < length) {
+        if (valid == available)
+            return 0;
+        character = -1;
+        return valid;
+    }
+
+    switch (length) {
+    case 2:
+        character = ((sequence[0] & 0x1F) << 6) | (sequence[1] & 0x3F);
+        break;
+    case 3:
+        character = ((sequence[0] & 0x0F) << 12) | ((sequence[1] & 0x3F) << 6) | (sequence[2] & 0x3F);
+        break;
+    default:
+        character = ((sequence[0] & 0x07) << 18) | ((sequence[1] & 0x3F) << 12) | ((sequence[2] & 0x3F) << 6) | (sequence[3] & 0x3F);
+        break;
+    }
+    return length;
+}
+
+// Appends character, or the replacement character for an invalid
+// sequence. Returns false if decoding should stop.
+static inline bool appendCharacter(UChar*& destination, UChar32 character, bool stopOnError, bool& sawError)
+{
+    if (character < 0) {
+        sawError = true;
+        if (stopOnError)
+            return false;
+        *destination++ = replacementCharacter;
+    } else if (character < 0x10000)
+        *destination++ = character;
+    else {
+        *destination++ = U16_LEAD(character);
+        *destination++ = U16_TRAIL(character);
+    }
+    return true;
+}
+
+String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool stopOnError, bool& sawError)
+{
+    // Each byte becomes at most one UTF-16 code unit; four byte sequences
+    // become two.
+    StringBuffer buffer(m_partialSequenceSize + length);
+    UChar* destination = buffer.characters();
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(bytes);
+    const unsigned char* end = source + length;
+    bool stopped = false;
+
+    while (m_partialSequenceSize && !stopped) {
+        int count = min<ptrdiff_t>(maximumSequenceLength - m_partialSequenceSize, end - source);
+        memcpy(m_partialSequence + m_partialSequenceSize, source, count);
+        UChar32 character;
+        int used = decodeSequence(m_partialSequence, m_partialSequence + m_partialSequenceSize + count, character);
+        if (!used) {
+            // Still cut off, so all of the input went into it.
+            m_partialSequenceSize += count;
+            source = end;
+            break;
+        }
+        stopped = !appendCharacter(destination, character, stopOnError, sawError);
+        if (used >= m_partialSequenceSize) {
+            source += used - m_partialSequenceSize;
+            m_partialSequenceSize = 0;
+        } else {
+            m_partialSequenceSize -= used;
+            memmove(m_partialSequence, m_partialSequence + used, m_partialSequenceSize);
+        }
+    }
+
+    while (source < end && !stopped) {
+        size_t asciiLength = copyASCII(destination, source, end);
+        source += asciiLength;
+        destination += asciiLength;
+        if (source == end)
+            break;
+
+        UChar32 character;
+        int used = decodeSequence(source, end, character);
+        if (!used) {
+            m_partialSequenceSize = end - source;
+            memcpy(m_partialSequence, source, m_partialSequenceSize);
+            break;
+        }
+        source += used;
+        stopped = !appendCharacter(destination, character, stopOnError, sawError);
+    }
+
+    if (flush && m_partialSequenceSize) {
+        // The input ended in the middle of a sequence.
+        m_partialSequenceSize = 0;
+        if (!stopped)
+            appendCharacter(destination, -1, stopOnError, sawError);
+    }
+
+    buffer.shrink(destination - buffer.characters());
+
+    return String::adopt(buffer);
+}
+
+CString TextCodecUTF8::encode(const UChar* characters, size_t length, UnencodableHandling)
+{
+    // Every character can be encoded; unpaired surrogates become the
+    // replacement character. Each UTF-16 code unit takes at most three bytes.
+    Vector<char> result(length * 3);
+    char* bytes = result.data();
+
+    size_t resultLength = 0;
+    for (size_t i = 0; i < length; ) {
+        UChar32 c;
+        U16_NEXT(characters, i, length, c);
+        if ((c & 0xFFFFF800) == 0xD800)
+            c = replacementCharacter;
+        if (c < 0x80)
+            bytes[resultLength++] = c;
+        else if (c < 0x800) {
+            bytes[resultLength++] = 0xC0 | (c >> 6);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        } else if (c < 0x10000) {
+            bytes[resultLength++] = 0xE0 | (c >> 12);
+            bytes[resultLength++] = 0x80 | ((c >> 6) & 0x3F);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        } else {
+            bytes[resultLength++] = 0xF0 | (c >> 18);
+            bytes[resultLength++] = 0x80 | ((c >> 12) & 0x3F);
+            bytes[resultLength++] = 0x80 | ((c >> 6) & 0x3F);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        }
+    }
+
+    return CString(bytes, resultLength);
+}
+
+} // namespace WebCore
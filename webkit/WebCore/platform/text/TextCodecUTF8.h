@@ -0,0 +1,31 @@
+#ifndef TextCodecUTF8_h
+#define TextCodecUTF8_h
+
+#include "TextCodec.h"
+
+namespace WebCore {
+
+    // Decodes UTF-8 without going through a platform converter, widening
+    // runs of ASCII, most of the text of most pages, a word at a time.
+    class TextCodecUTF8 : public TextCodec {
+    public:
+        static void registerEncodingNames(EncodingNameRegistrar);
+        static void registerCodecs(TextCodecRegistrar);
+
+        TextCodecUTF8() : m_partialSequenceSize(0) { }
+
+        virtual String decode(const char*, size_t length, bool flush, bool stopOnError, bool& sawError);
+        virtual CString encode(const UChar*, size_t length, UnencodableHandling);
+
+    private:
+        static const int maximumSequenceLength = 4;
+
+        // The start of a sequence that was cut off at the end of the last
+        // chunk, with room for the rest of it
+        int m_partialSequenceSize;
+        unsigned char m_partialSequence[maximumSequenceLength];
+    };
+
+} // namespace WebCore
+
+#endif // TextCodecUTF8_h
@@ -213,6 +213,8 @@ namespace WebCore {
 
 #ifdef ANDROID_PLUGINS
         Element* getElement() const { return m_element; }
+        // stop the plugin's timers while it is off-screen or paused
+        void setTimersSuspended(bool suspended);
 #endif
 
         bool start();
@@ -66,6 +66,7 @@
 extern void ANPAudioTrackInterfaceV0_Init(ANPInterface* value);
 extern void ANPBitmapInterfaceV0_Init(ANPInterface* value);
 extern void ANPCanvasInterfaceV0_Init(ANPInterface* value);
+extern void ANPCanvasBatchInterfaceV0_Init(ANPInterface* value);
 extern void ANPEventInterfaceV0_Init(ANPInterface* value);
 extern void ANPLogInterfaceV0_Init(ANPInterface* value);
 extern void ANPMatrixInterfaceV0_Init(ANPInterface* value);
@@ -90,6 +91,7 @@ static const VarProcPair gVarProcs[] = {
     { VARPROCLINE(AudioTrackInterfaceV0)    },
     { VARPROCLINE(BitmapInterfaceV0)        },
     { VARPROCLINE(CanvasInterfaceV0)        },
+    { VARPROCLINE(CanvasBatchInterfaceV0)   },
     { VARPROCLINE(EventInterfaceV0)         },
     { VARPROCLINE(LogInterfaceV0)           },
     { VARPROCLINE(MatrixInterfaceV0)        },
@@ -155,6 +157,11 @@ void PluginView::platformDestroy()
     delete m_window;
 }
 
+void PluginView::setTimersSuspended(bool suspended)
+{
+    m_timerList.setSuspended(suspended);
+}
+
 void PluginView::handleTouchEvent(TouchEvent* event)
 {
     if (!m_window->isAcceptingEvent(kTouch_ANPEventFlag))
@@ -616,7 +623,11 @@ void PluginView::paint(GraphicsContext* context, const IntRect& rect)
         updatePluginWidget();
         m_window->setSurfaceClip(context->platformContext()->mCanvas->getTotalClip().getBounds());
     } else {
-        m_window->inval(rect, false);
+        // The plugin only draws its dirty rects, so mark the part we are
+        // painting (in the plugin's own coordinates) as dirty.
+        IntRect localRect = rect;
+        localRect.move(-frame.x(), -frame.y());
+        m_window->inval(localRect, false);
         context->save();
         context->translate(frame.x(), frame.y());
         m_window->draw(android_gc2canvas(context));
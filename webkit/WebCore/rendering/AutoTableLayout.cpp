@@ -18,6 +18,7 @@ AutoTableLayout::AutoTableLayout(RenderTable* table)
     , m_percentagesDirty(true)
     , m_effWidthDirty(true)
     , m_totalPercent(0)
+    , m_columnCacheGridVersion(0)
 {
 }
 
@@ -90,7 +91,7 @@ void AutoTableLayout::recalcColumn(int effCol)
                         }
                         break;
                     case Percent:
-                        m_hasPercent = true;
+                        l.hasPercent = true;
                         if (w.isPositive() && (!l.width.isPercent() || w.rawValue() > l.width.rawValue()))
                             l.width = w;
                         break;
@@ -108,7 +109,6 @@ void AutoTableLayout::recalcColumn(int effCol)
                         // a min/max width of at least 1px for this column now.
                         l.minWidth = max(l.minWidth, cellHasContent ? 1 : 0);
                         l.maxWidth = max(l.maxWidth, 1);
-                        insertSpanCell(cell);
                     }
                     last = cell;
                 }
@@ -130,6 +130,43 @@ void AutoTableLayout::recalcColumn(int effCol)
     // ### we need to add col elements as well
 }
 
+// Adds the cells spanning from effCol into the following columns to
+// m_spanCells, in the order recalcColumn used to, and returns whether any
+// cell in the column has to recalculate its preferred widths.
+bool AutoTableLayout::collectSpanCells(int effCol)
+{
+    bool hasDirtyCell = false;
+    for (RenderObject* child = m_table->firstChild(); child; child = child->nextSibling()) {
+        if (!child->isTableSection())
+            continue;
+        RenderTableSection* section = toRenderTableSection(child);
+        int numRows = section->numRows();
+        for (int i = 0; i < numRows; i++) {
+            RenderTableSection::CellStruct current = section->cellAt(i, effCol);
+            RenderTableCell* cell = current.cell;
+            if (!cell)
+                continue;
+            if (cell->prefWidthsDirty())
+                hasDirtyCell = true;
+            if (!current.inColSpan && cell->colSpan() > 1 && (!effCol || section->cellAt(i, effCol - 1).cell != cell))
+                insertSpanCell(cell);
+        }
+    }
+    return hasDirtyCell;
+}
+
+// The cached columns can stand in for recalcColumn as long as the grid is
+// the one they were computed from. Column elements and collapsed borders
+// can change a column without marking any of its cells dirty, so tables
+// using them always recalculate every column.
+bool AutoTableLayout::canReuseColumns(int numEffCols) const
+{
+    return m_columnCache.size() == static_cast<unsigned>(numEffCols)
+        && m_columnCacheGridVersion == m_table->gridVersion()
+        && !m_table->hasColElements()
+        && !m_table->collapseBorders();
+}
+
 void AutoTableLayout::fullRecalc()
 {
     m_percentagesDirty = true;
@@ -137,9 +174,26 @@ void AutoTableLayout::fullRecalc()
     m_effWidthDirty = true;
 
     int nEffCols = m_table->numEffCols();
+    bool reuseColumns = canReuseColumns(nEffCols);
     m_layoutStruct.resize(nEffCols);
     m_layoutStruct.fill(Layout());
     m_spanCells.fill(0);
+    m_columnCache.resize(nEffCols);
+    m_columnCacheGridVersion = m_table->gridVersion();
+
+    if (reuseColumns) {
+        // Only the columns holding a cell whose contents or style changed
+        // need to look at their cells again.
+        for (int i = 0; i < nEffCols; i++) {
+            if (collectSpanCells(i)) {
+                recalcColumn(i);
+                m_columnCache[i] = m_layoutStruct[i];
+            } else
+                m_layoutStruct[i] = m_columnCache[i];
+            m_hasPercent |= m_layoutStruct[i].hasPercent;
+        }
+        return;
+    }
 
     RenderObject *child = m_table->firstChild();
     Length grpWidth;
@@ -181,8 +235,12 @@ void AutoTableLayout::fullRecalc()
     }
 
 
-    for (int i = 0; i < nEffCols; i++)
+    for (int i = 0; i < nEffCols; i++) {
+        collectSpanCells(i);
         recalcColumn(i);
+        m_columnCache[i] = m_layoutStruct[i];
+        m_hasPercent |= m_layoutStruct[i].hasPercent;
+    }
 }
 
 static bool shouldScaleColumns(RenderTable* table)
@@ -23,6 +23,8 @@ public:
 protected:
     void fullRecalc();
     void recalcColumn(int effCol);
+    bool canReuseColumns(int numEffCols) const;
+    bool collectSpanCells(int effCol);
 
     void calcPercentages() const;
     int totalPercent() const
@@ -43,7 +45,8 @@ protected:
             , effMinWidth(0)
             , effMaxWidth(0)
             , calcWidth(0)
-            , emptyCellsOnly(true) {}
+            , emptyCellsOnly(true)
+            , hasPercent(false) {}
         Length width;
         Length effWidth;
         int minWidth;
@@ -52,9 +55,15 @@ protected:
         int effMaxWidth;
         int calcWidth;
         bool emptyCellsOnly;
+        bool hasPercent;
     };
 
     Vector<Layout, 4> m_layoutStruct;
+    // Each column as recalcColumn left it, before the spanning cells and
+    // the layout itself adjusted it, for the columns whose cells don't
+    // change to reuse in the next calcPrefWidths.
+    Vector<Layout, 4> m_columnCache;
+    unsigned m_columnCacheGridVersion;
     Vector<RenderTableCell*, 4> m_spanCells;
     bool m_hasPercent : 1;
     mutable bool m_percentagesDirty : 1;
@@ -25,6 +25,8 @@ typedef struct {
 #endif
 
 RenderArena::RenderArena(unsigned arenaSize)
+    : m_liveSize(0)
+    , m_recycledSize(0)
 {
     // Initialize the arena pool
     INIT_ARENA_POOL(&m_pool, "RenderArena", arenaSize);
@@ -48,6 +50,7 @@ void* RenderArena::allocate(size_t size)
     header->arena = this;
     header->size = size;
     header->signature = signature;
+    m_liveSize += size;
     return header + 1;
 #else
     void* result = 0;
@@ -64,6 +67,7 @@ void* RenderArena::allocate(size_t size)
             // Need to move to the next object
             void* next = *((void**)result);
             m_recyclers[index] = next;
+            m_recycledSize -= size;
         }
     }
 
@@ -72,6 +76,7 @@ void* RenderArena::allocate(size_t size)
         ARENA_ALLOCATE(result, &m_pool, size);
     }
 
+    m_liveSize += size;
     return result;
 #endif
 }
@@ -85,10 +90,12 @@ void RenderArena::free(size_t size, void* ptr)
     ASSERT_UNUSED(size, header->size == size);
     ASSERT(header->arena == this);
     header->signature = signatureDead;
+    m_liveSize -= size;
     ::free(header);
 #else
     // Ensure we have correct alignment for pointers.  Important for Tru64
     size = ROUNDUP(size, sizeof(void*));
+    m_liveSize -= size;
 
     // See if it's a size that we recycle
     if (size < gMaxRecycledSize) {
@@ -96,11 +103,17 @@ void RenderArena::free(size_t size, void* ptr)
         void* currentTop = m_recyclers[index];
         m_recyclers[index] = ptr;
         *((void**)ptr) = currentTop;
+        m_recycledSize += size;
     }
 #endif
 }
 
-#ifdef ANDROID_INSTRUMENT
+void RenderArena::releaseFreeArenas()
+{
+    FreeArenaFreeList();
+}
+
+#if PLATFORM(ANDROID)
 size_t RenderArena::reportPoolSize() const
 {
     return ReportPoolSize(&m_pool);
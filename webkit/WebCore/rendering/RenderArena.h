@@ -19,7 +19,19 @@ public:
     void* allocate(size_t);
     void free(size_t, void*);
 
-#ifdef ANDROID_INSTRUMENT
+    // Bytes currently handed out, and bytes that were freed and are kept on
+    // the recyclers for objects of the same size. Freed objects too large
+    // to recycle count in neither; their memory only comes back with the
+    // arena itself.
+    size_t liveSize() const { return m_liveSize; }
+    size_t recycledSize() const { return m_recycledSize; }
+
+    // Gives the arenas that destroyed render arenas left on the shared free
+    // list back to the system, for when memory is short. Arenas still in
+    // use by a document can't be returned, since renderers point into them.
+    static void releaseFreeArenas();
+
+#if PLATFORM(ANDROID)
     size_t reportPoolSize() const;
 #endif
 
@@ -30,6 +42,9 @@ private:
     // The recycler array is sparse with the indices being multiples of 4,
     // i.e., 0, 4, 8, 12, 16, 20, ...
     void* m_recyclers[gMaxRecycledSize >> 2];
+
+    size_t m_liveSize;
+    size_t m_recycledSize;
 };
 
 } // namespace WebCore
@@ -2353,6 +2353,7 @@ void RenderBlock::insertFloatingObject(RenderBox* o)
     newObj->m_renderer = o;
 
     m_floatingObjects->append(newObj);
+    RenderLayer::invalidatePaintPhases();
 }
 
 void RenderBlock::removeFloatingObject(RenderBox* o)
@@ -3108,6 +3109,7 @@ int RenderBlock::addOverhangingFloats(RenderBlock* child, int xoff, int yoff, bo
                     m_floatingObjects->setAutoDelete(true);
                 }
                 m_floatingObjects->append(floatingObj);
+                RenderLayer::invalidatePaintPhases();
             }
         } else if (makeChildPaintOtherFloats && !r->m_shouldPaint && !r->m_renderer->hasSelfPaintingLayer() &&
                    r->m_renderer->isDescendantOf(child) && r->m_renderer->enclosingLayer() == child->enclosingLayer())
@@ -3166,6 +3168,7 @@ void RenderBlock::addIntrudingFloats(RenderBlock* prev, int xoff, int yoff)
                     m_floatingObjects->setAutoDelete(true);
                 }
                 m_floatingObjects->append(floatingObj);
+                RenderLayer::invalidatePaintPhases();
             }
         }
     }
@@ -493,10 +493,65 @@ void RenderBlock::computeVerticalPositionsForLine(RootInlineBox* lineBox, BidiRu
     lineBox->markDirty(false);
 }
 
+// Whether every character from the resolver's position up to end is at
+// level 0 whatever the bidi algorithm makes of it: the paragraph is
+// left-to-right without embeddings, nothing on the line is right-to-left or
+// opens an embedding, and the last strong character was left-to-right so
+// that numbers are too.
+static bool lineIsAllLeftToRight(RenderBlock* block, const InlineBidiResolver& resolver, const InlineIterator& end)
+{
+    BidiContext* context = resolver.context();
+    if (context->level() || context->dir() != LeftToRight || context->override() || context->parent())
+        return false;
+    if (resolver.status().lastStrong != LeftToRight)
+        return false;
+
+    RenderObject* checkedParent = block;
+    for (RenderObject* obj = resolver.position().obj; obj; obj = bidiNext(block, obj)) {
+        if (obj->isText()) {
+            if (!toRenderText(obj)->isAllLeftToRight())
+                return false;
+        } else if (obj->isListMarker()) {
+            if (obj->style()->direction() != LTR)
+                return false;
+        } else if (obj->isRenderInline() && obj->style()->unicodeBidi() != UBNormal)
+            return false;
+
+        if (obj->parent() != checkedParent) {
+            for (RenderObject* parent = obj->parent(); parent && parent != block; parent = parent->parent()) {
+                if (parent->style()->unicodeBidi() != UBNormal)
+                    return false;
+            }
+            checkedParent = obj->parent();
+        }
+
+        if (obj == end.obj)
+            break;
+    }
+    return true;
+}
+
 // collects one line of the paragraph and transforms it to visual order
 void RenderBlock::bidiReorderLine(InlineBidiResolver& resolver, const InlineIterator& end, bool previousLineBrokeCleanly)
 {
-    resolver.createBidiRunsForLine(end, style()->visuallyOrdered(), previousLineBrokeCleanly);
+    if (!lineIsAllLeftToRight(this, resolver, end)) {
+        resolver.createBidiRunsForLine(end, style()->visuallyOrdered(), previousLineBrokeCleanly);
+        return;
+    }
+
+    // With a single level there is nothing to reorder, so the objects make
+    // their runs in logical order.
+    RenderObject* obj = resolver.position().obj;
+    int start = resolver.position().pos;
+    while (obj && obj != end.obj) {
+        appendRunsForObject(start, obj->length(), obj, resolver);
+        start = 0;
+        obj = bidiNext(this, obj);
+    }
+    if (obj && static_cast<int>(end.pos) > start)
+        appendRunsForObject(start, end.pos, obj, resolver);
+
+    resolver.finishLineWithoutReordering(end);
 }
 
 static inline bool isCollapsibleSpace(UChar character, RenderText* renderer)
@@ -1387,7 +1442,8 @@ void RenderBlock::fitBelowFloats(int widthToFit, bool firstLine, int& availableW
 
 static inline unsigned textWidth(RenderText* text, unsigned from, unsigned len, const Font& font, int xPos, bool isFixedPitch, bool collapseWhiteSpace)
 {
-    if (isFixedPitch || (!from && len == text->textLength()))
+    // RenderText keeps the widths of words measured in its own font.
+    if (isFixedPitch || (!from && len == text->textLength()) || &font == &text->style()->font())
         return text->width(from, len, font, xPos);
     return font.width(TextRun(text->characters() + from, len, !collapseWhiteSpace, xPos));
 }
@@ -1603,6 +1659,7 @@ InlineIterator RenderBlock::findNextLineBreak(InlineBidiResolver& resolver, bool
             int strlen = t->textLength();
             int len = strlen - pos;
             const UChar* str = t->characters();
+            const LineBreakOpportunities* breakOpportunities = t->lineBreakOpportunities();
 
             const Font& f = t->style(firstLine)->font();
             bool isFixedPitch = f.isFixedPitch();
@@ -1688,7 +1745,7 @@ InlineIterator RenderBlock::findNextLineBreak(InlineBidiResolver& resolver, bool
                     midWordBreak = w + wrapW + charWidth > width;
                 }
 
-                bool betweenWords = c == '\n' || (currWS != PRE && !atStart && isBreakable(str, pos, strlen, nextBreakable, breakNBSP));
+                bool betweenWords = c == '\n' || (currWS != PRE && !atStart && isBreakable(str, pos, strlen, nextBreakable, breakNBSP, breakOpportunities));
     
                 if (betweenWords || midWordBreak) {
                     bool stoppedIgnoringSpaces = false;
@@ -126,6 +126,9 @@ RenderLayer::RenderLayer(RenderBoxModelObject* renderer)
     , m_hasVisibleDescendant(false)
     , m_3DTransformedDescendantStatusDirty(true)
     , m_has3DTransformedDescendant(false)
+    , m_paintsFloats(true)
+    , m_paintsChildOutlines(true)
+    , m_paintPhaseGeneration(0)
 #if USE(ACCELERATED_COMPOSITING)
     , m_hasCompositingDescendant(false)
     , m_mustOverlapCompositedLayers(false)
@@ -2104,6 +2107,39 @@ void RenderLayer::paint(GraphicsContext* p, const IntRect& damageRect, PaintBeha
         it->first->setOverlapTestResult(false);
 }
 
+unsigned RenderLayer::s_paintPhaseGeneration = 1;
+
+static inline bool mayPaintOutline(RenderObject* renderer)
+{
+    return renderer->style()->outlineWidth() > 0 || renderer->hasOutline();
+}
+
+void RenderLayer::updatePaintPhases()
+{
+    if (m_paintPhaseGeneration == s_paintPhaseGeneration)
+        return;
+    m_paintPhaseGeneration = s_paintPhaseGeneration;
+
+    RenderBoxModelObject* root = renderer();
+    m_paintsFloats = false;
+    // Printing outlines links, and a block paints the outlines of its inline
+    // continuation, which lives outside of it.
+    m_paintsChildOutlines = root->document()->printing() || (root->isRenderBlock() && toRenderBlock(root)->inlineContinuation());
+
+    RenderObject* o = root;
+    while (o && !(m_paintsFloats && m_paintsChildOutlines)) {
+        if (o->isRenderBlock() && toRenderBlock(o)->containsFloats())
+            m_paintsFloats = true;
+        if (o != root && mayPaintOutline(o))
+            m_paintsChildOutlines = true;
+        RenderObject* next = o->firstChild();
+        // Children with self-painting layers paint themselves.
+        if (next && o != root && o->hasLayer() && toRenderBoxModelObject(o)->hasSelfPaintingLayer())
+            next = 0;
+        o = next ? next : o->nextInPreOrderAfterChildren(root);
+    }
+}
+
 static void setClip(GraphicsContext* p, const IntRect& paintDirtyRect, const IntRect& clipRect)
 {
     if (paintDirtyRect == clipRect)
@@ -2290,20 +2326,25 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
                                           forceBlackText, paintingRootForRenderer, 0);
         renderer()->paint(paintInfo, tx, ty);
         if (!selectionOnly) {
-            paintInfo.phase = PaintPhaseFloat;
-            renderer()->paint(paintInfo, tx, ty);
+            updatePaintPhases();
+            if (m_paintsFloats) {
+                paintInfo.phase = PaintPhaseFloat;
+                renderer()->paint(paintInfo, tx, ty);
+            }
             paintInfo.phase = PaintPhaseForeground;
             paintInfo.overlapTestRequests = overlapTestRequests;
             renderer()->paint(paintInfo, tx, ty);
-            paintInfo.phase = PaintPhaseChildOutlines;
-            renderer()->paint(paintInfo, tx, ty);
+            if (m_paintsChildOutlines) {
+                paintInfo.phase = PaintPhaseChildOutlines;
+                renderer()->paint(paintInfo, tx, ty);
+            }
         }
 
         // Now restore our clip.
         restoreClip(p, paintDirtyRect, clipRectToApply);
     }
     
-    if (!outlineRect.isEmpty() && isSelfPaintingLayer()) {
+    if (!outlineRect.isEmpty() && isSelfPaintingLayer() && mayPaintOutline(renderer())) {
         // Paint our own outline
         RenderObject::PaintInfo paintInfo(p, outlineRect, PaintPhaseSelfOutline, false, paintingRootForRenderer, 0);
         setClip(p, paintDirtyRect, outlineRect);
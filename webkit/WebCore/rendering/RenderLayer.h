@@ -157,6 +157,16 @@ public:
     bool isNormalFlowOnly() const { return m_isNormalFlowOnly; }
     bool isSelfPaintingLayer() const;
 
+    // The float and child outline phases walk everything the layer paints,
+    // so layers remember whether those phases can paint anything. What they
+    // remember is dropped whenever any renderer's style changes or any block
+    // takes in a float.
+    static void invalidatePaintPhases()
+    {
+        if (!++s_paintPhaseGeneration)
+            ++s_paintPhaseGeneration;
+    }
+
     bool requiresSlowRepaints() const;
 
     bool isTransparent() const;
@@ -454,6 +464,8 @@ private:
                             const HitTestingTransformState* containerTransformState) const;
     
     bool hitTestContents(const HitTestRequest&, HitTestResult&, const IntRect& layerBounds, const IntPoint& hitTestPoint, HitTestFilter) const;
+
+    void updatePaintPhases();
     
     void computeScrollDimensions(bool* needHBar = 0, bool* needVBar = 0);
 
@@ -601,6 +613,12 @@ protected:
     bool m_3DTransformedDescendantStatusDirty : 1;
     bool m_has3DTransformedDescendant : 1;  // Set on a stacking context layer that has 3D descendants anywhere
                                             // in a preserves3D hierarchy. Hint to do 3D-aware hit testing.
+
+    bool m_paintsFloats : 1;
+    bool m_paintsChildOutlines : 1;
+    // The s_paintPhaseGeneration the two bits above were computed in, or 0.
+    unsigned m_paintPhaseGeneration;
+    static unsigned s_paintPhaseGeneration;
 #if USE(ACCELERATED_COMPOSITING)
     bool m_hasCompositingDescendant : 1;
     bool m_mustOverlapCompositedLayers : 1;
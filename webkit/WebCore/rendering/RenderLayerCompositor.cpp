@@ -26,6 +26,15 @@
 #include <wtf/CurrentTime.h>
 #endif
 
+#if LOG_COMPOSITING_REASONS
+#if PLATFORM(ANDROID)
+#include <cutils/log.h>
+#define REASONLOG(...) android_printLog(ANDROID_LOG_DEBUG, "RenderLayerCompositor", __VA_ARGS__)
+#else
+#define REASONLOG(...) fprintf(stderr, __VA_ARGS__)
+#endif
+#endif
+
 #ifndef NDEBUG
 #include "CString.h"
 #include "RenderTreeAsText.h"
@@ -40,6 +49,14 @@ namespace WebCore {
 
 using namespace HTMLNames;
 
+#if PLATFORM(ANDROID)
+// Each composited layer is recorded into its own picture and drawn on its
+// own, so past these limits the layers cost more memory and drawing time
+// than painting their content into the page would.
+static const unsigned maxCompositedLayers = 32;
+static const int maxCompositedAreaInViewports = 4;
+#endif
+
 struct CompositingState {
     CompositingState(RenderLayer* compAncestor)
         : m_compositingAncestor(compAncestor)
@@ -73,6 +90,11 @@ RenderLayerCompositor::RenderLayerCompositor(RenderView* renderView)
     , m_compositing(false)
     , m_rootLayerAttached(false)
     , m_compositingLayersNeedRebuild(false)
+#if PLATFORM(ANDROID)
+    , m_compositingBudgetExceeded(false)
+    , m_compositedLayerCount(0)
+    , m_compositedLayerArea(0)
+#endif
 #if PROFILE_LAYER_REBUILD
     , m_rootLayerUpdateCount(0)
 #endif // PROFILE_LAYER_REBUILD
@@ -176,11 +198,31 @@ void RenderLayerCompositor::updateCompositingLayers(CompositingUpdateType update
         // FIXME: we could maybe do this and the hierarchy udpate in one pass, but the parenting logic would be more complex.
         CompositingState compState(updateRoot);
         bool layersChanged = false;
+#if PLATFORM(ANDROID)
+        m_compositedLayerCount = 0;
+        m_compositedLayerArea = 0;
+#endif
         if (m_compositingConsultsOverlap) {
             OverlapMap overlapTestRequestMap;
             computeCompositingRequirements(updateRoot, &overlapTestRequestMap, compState, layersChanged);
         } else
             computeCompositingRequirements(updateRoot, 0, compState, layersChanged);
+
+#if PLATFORM(ANDROID)
+        // Only a pass over the whole tree counts all the composited layers.
+        if (updateRoot == rootRenderLayer() && !m_compositingBudgetExceeded && exceedsCompositingBudget()) {
+#if LOG_COMPOSITING_REASONS
+            REASONLOG("%u composited layers covering %.0f pixels exceed the budget\n", m_compositedLayerCount, m_compositedLayerArea);
+#endif
+            m_compositingBudgetExceeded = true;
+            CompositingState budgetState(updateRoot);
+            if (m_compositingConsultsOverlap) {
+                OverlapMap overlapTestRequestMap;
+                computeCompositingRequirements(updateRoot, &overlapTestRequestMap, budgetState, layersChanged);
+            } else
+                computeCompositingRequirements(updateRoot, 0, budgetState, layersChanged);
+        }
+#endif
         
         needHierarchyUpdate |= layersChanged;
     }
@@ -481,8 +523,10 @@ void RenderLayerCompositor::computeCompositingRequirements(RenderLayer* layer, O
     const bool willBeComposited = needsToBeComposited(layer);
 
 #if ENABLE(COMPOSITED_FIXED_ELEMENTS)
-    // If we are a fixed layer, signal it to our siblings
-    if (layer->isFixed())
+    // If we are a composited fixed layer, signal it to our siblings. A fixed
+    // layer painted into its ancestor's layer doesn't need anything drawn
+    // above it to be composited.
+    if (willBeComposited && layer->isFixed())
         compositingState.m_fixedSibling = true;
 
     if (!willBeComposited && compositingState.m_fixedSibling)
@@ -524,7 +568,7 @@ void RenderLayerCompositor::computeCompositingRequirements(RenderLayer* layer, O
             // subsequent siblings as we do for the normal flow
             // and positive z-order.
             for (size_t j = 0; j < listSize; ++j) {
-                if ((negZOrderList->at(j))->isFixed()) {
+                if ((negZOrderList->at(j))->isFixed() && requiresCompositingLayer(negZOrderList->at(j))) {
                     childState.m_fixedSibling = true;
                     break;
                 }
@@ -598,6 +642,22 @@ void RenderLayerCompositor::computeCompositingRequirements(RenderLayer* layer, O
     // but that's ok here.
     layer->setHasCompositingDescendant(childState.m_subtreeIsCompositing);
 
+#if PLATFORM(ANDROID)
+    if (!layer->isRootLayer() && needsToBeComposited(layer)) {
+        if (!haveComputedBounds) {
+            absBounds = layer->renderer()->localToAbsoluteQuad(FloatRect(layer->localBoundingBox())).enclosingBoundingBox();
+            haveComputedBounds = true;
+        }
+        ++m_compositedLayerCount;
+        m_compositedLayerArea += static_cast<double>(absBounds.width()) * absBounds.height();
+    }
+#endif
+
+#if LOG_COMPOSITING_REASONS
+    if (needsToBeComposited(layer))
+        REASONLOG("layer %p (%s) composited: %s\n", layer, layer->renderer()->renderName(), reasonForCompositing(layer));
+#endif
+
     // Update backing now, so that we can use isComposited() reliably during tree traversal in rebuildCompositingLayerTree().
     if (updateBacking(layer, CompositingChangeRepaintNow))
         layersChanged = true;
@@ -962,6 +1022,10 @@ bool RenderLayerCompositor::needsToBeComposited(const RenderLayer* layer) const
 #if PLATFORM(ANDROID)
 bool RenderLayerCompositor::requiresCompositingForMobileSites(const RenderLayer* layer) const
 {
+    // Past the budget, the page paints everything itself.
+    if (m_compositingBudgetExceeded)
+        return false;
+
     // First, check if we are in an iframe, and if so bail out
     if (m_renderView->document()->frame()->tree()->parent())
         return false;
@@ -997,6 +1061,48 @@ bool RenderLayerCompositor::requiresCompositingForMobileSites(const RenderLayer*
 }
 #endif
 
+#if PLATFORM(ANDROID)
+bool RenderLayerCompositor::exceedsCompositingBudget() const
+{
+    if (m_compositedLayerCount > maxCompositedLayers)
+        return true;
+    FrameView* view = m_renderView->frameView();
+    double viewportArea = static_cast<double>(view->visibleWidth()) * view->visibleHeight();
+    return viewportArea && m_compositedLayerArea > maxCompositedAreaInViewports * viewportArea;
+}
+#endif
+
+#if LOG_COMPOSITING_REASONS
+const char* RenderLayerCompositor::reasonForCompositing(const RenderLayer* layer) const
+{
+    RenderObject* renderer = layer->renderer();
+    if (layer->isRootLayer())
+        return "root";
+    if (requiresCompositingForTransform(renderer))
+        return "transform";
+    if (requiresCompositingForAnimation(renderer))
+        return "animation";
+#if PLATFORM(ANDROID)
+    if (requiresCompositingForMobileSites(layer))
+        return "fixed position on a mobile site";
+#else
+    if (requiresCompositingForVideo(renderer))
+        return "video";
+    if (requiresCompositingForCanvas(renderer))
+        return "canvas";
+    if (requiresCompositingForPlugin(renderer))
+        return "plugin";
+#endif
+    if (renderer->style()->backfaceVisibility() == BackfaceVisibilityHidden)
+        return "backface-visibility";
+    if (clipsCompositingDescendants(layer))
+        return "clips composited descendants";
+    if (layer->mustOverlapCompositedLayers())
+        return "draws above composited content";
+    return "inside a composited fixed layer";
+}
+#endif
+
 // Note: this specifies whether the RL needs a compositing layer for intrinsic reasons.
 // Use needsToBeComposited() to determine if a RL actually needs a compositing layer.
 // static
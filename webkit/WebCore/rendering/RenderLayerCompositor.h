@@ -9,6 +9,8 @@
 namespace WebCore {
 
 #define PROFILE_LAYER_REBUILD 0
+// Logs each layer that gets composited, and why.
+#define LOG_COMPOSITING_REASONS 0
 
 class GraphicsLayer;
 #if ENABLE(VIDEO)
@@ -161,6 +163,11 @@ private:
 #if PLATFORM(ANDROID)
     // Whether we are on a mobile site
     bool requiresCompositingForMobileSites(const RenderLayer* layer) const;
+    bool exceedsCompositingBudget() const;
+#endif
+
+#if LOG_COMPOSITING_REASONS
+    const char* reasonForCompositing(const RenderLayer*) const;
 #endif
 
 private:
@@ -173,6 +180,13 @@ private:
     bool m_compositing;
     bool m_rootLayerAttached;
     bool m_compositingLayersNeedRebuild;
+#if PLATFORM(ANDROID)
+    // Once a document composites more than the budget allows, it gives up
+    // on the layers it only wanted for speed.
+    bool m_compositingBudgetExceeded;
+    unsigned m_compositedLayerCount;
+    double m_compositedLayerArea;
+#endif
     
 #if PROFILE_LAYER_REBUILD
     int m_rootLayerUpdateCount;
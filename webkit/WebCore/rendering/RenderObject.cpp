@@ -1544,6 +1544,11 @@ void RenderObject::setStyle(PassRefPtr<RenderStyle> style)
     RefPtr<RenderStyle> oldStyle = m_style.release();
     m_style = style;
 
+    // Outlines, and layers that start or stop painting themselves, change
+    // what the layers' float and outline phases have to paint.
+    if (diff >= StyleDifferenceRepaintLayer || m_style->outlineWidth() > 0)
+        RenderLayer::invalidatePaintPhases();
+
     updateFillImages(oldStyle ? oldStyle->backgroundLayers() : 0, m_style ? m_style->backgroundLayers() : 0);
     updateFillImages(oldStyle ? oldStyle->maskLayers() : 0, m_style ? m_style->maskLayers() : 0);
 
@@ -2309,7 +2314,25 @@ bool RenderObject::willRenderImage(CachedImage*)
 
     // If we're not in a window (i.e., we're dormant from being put in the b/f cache or in a background tab)
     // then we don't want to render either.
-    return !document()->inPageCache() && !document()->view()->isOffscreen();
+    if (document()->inPageCache() || document()->view()->isOffscreen())
+        return false;
+
+#if PLATFORM(ANDROID)
+    // The recorded picture covers the whole page, so an animation keeps
+    // decoding and repainting after it scrolls away. Pause main frame images
+    // more than a screen from the visible rect; WebViewCore repaints them
+    // when they scroll back.
+    if (!document()->ownerElement()) {
+        IntRect visibleRect = document()->view()->visibleContentRect();
+        if (!visibleRect.isEmpty()) {
+            visibleRect.inflateX(visibleRect.width());
+            visibleRect.inflateY(visibleRect.height());
+            if (!visibleRect.intersects(absoluteClippedOverflowRect()))
+                return false;
+        }
+    }
+#endif
+    return true;
 }
 
 int RenderObject::maximalOutlineSize(PaintPhase p) const
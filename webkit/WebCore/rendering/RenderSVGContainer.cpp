@@ -11,14 +11,32 @@
 #include "SVGResourceFilter.h"
 #include "SVGStyledElement.h"
 
+#if PLATFORM(ANDROID)
+#include "PlatformGraphicsContext.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#endif
+
 namespace WebCore {
 
 RenderSVGContainer::RenderSVGContainer(SVGStyledElement* node)
     : RenderSVGModelObject(node)
     , m_drawsContents(true)
+#if PLATFORM(ANDROID)
+    , m_canCachePicture(false)
+    , m_cachedPicture(0)
+#endif
 {
 }
 
+#if PLATFORM(ANDROID)
+RenderSVGContainer::~RenderSVGContainer()
+{
+    if (m_cachedPicture)
+        m_cachedPicture->unref();
+}
+#endif
+
 bool RenderSVGContainer::drawsContents() const
 {
     return m_drawsContents;
@@ -34,6 +52,11 @@ void RenderSVGContainer::layout()
     ASSERT(needsLayout());
     ASSERT(!view()->layoutStateEnabled()); // RenderSVGRoot disables layoutState for the SVG rendering tree.
 
+#if PLATFORM(ANDROID)
+    // Something in the container needs layout, and may not repaint.
+    invalidateCachedPicture();
+#endif
+
     calcViewport(); // Allow RenderSVGViewportContainer to update its viewport
 
     LayoutRepainter repainter(*this, checkForRepaintDuringLayout() || selfWillPaint());
@@ -83,8 +106,10 @@ void RenderSVGContainer::paint(PaintInfo& paintInfo, int, int)
 
     if (continueRendering) {
         childPaintInfo.paintingRoot = paintingRootForChildren(childPaintInfo);
-        for (RenderObject* child = firstChild(); child; child = child->nextSibling())
-            child->paint(childPaintInfo, 0, 0);
+#if PLATFORM(ANDROID)
+        if (!paintChildrenFromCache(childPaintInfo, boundingBox))
+#endif
+        paintChildren(childPaintInfo);
     }
 
     if (paintInfo.phase == PaintPhaseForeground)
@@ -102,6 +127,85 @@ void RenderSVGContainer::paint(PaintInfo& paintInfo, int, int)
         paintOutline(paintInfo.context, paintRectInParent.x(), paintRectInParent.y(), paintRectInParent.width(), paintRectInParent.height(), style());
 }
 
+void RenderSVGContainer::paintChildren(PaintInfo& paintInfo)
+{
+    for (RenderObject* child = firstChild(); child; child = child->nextSibling())
+        child->paint(paintInfo, 0, 0);
+}
+
+#if PLATFORM(ANDROID)
+// Maps and charts tend to animate a few elements over a large static drawing.
+// Once a container has painted twice with nothing in it changing, its
+// children are recorded into a picture that later paints replay. Any layout
+// or repaint inside the container drops the picture, so only the containers
+// on the way up from a changing element paint their children again; the
+// pictures of the static containers next to it are replayed into theirs.
+bool RenderSVGContainer::paintChildrenFromCache(PaintInfo& paintInfo, const FloatRect& boundingBox)
+{
+    // Only plain foreground paints draw everything the same way each time.
+    if (paintInfo.phase != PaintPhaseForeground || paintInfo.paintingRoot || paintInfo.forceBlackText)
+        return false;
+
+    if (!m_cachedPicture) {
+        if (!m_canCachePicture) {
+            m_canCachePicture = true;
+            return false;
+        }
+        IntRect bounds = enclosingIntRect(boundingBox);
+        bounds.inflate(1);
+        // foreignObject content may hold widgets, which are positioned as
+        // they paint.
+        if (bounds.isEmpty() || containsForeignObject())
+            return false;
+
+        m_cachedPicture = new SkPicture;
+        m_cachedPictureBounds = bounds;
+        SkCanvas* canvas = m_cachedPicture->beginRecording(bounds.width(), bounds.height());
+        canvas->translate(SkIntToScalar(-bounds.x()), SkIntToScalar(-bounds.y()));
+        PlatformGraphicsContext platformContext(canvas, 0);
+        GraphicsContext context(&platformContext);
+        // The picture has to hold all of the children, not just the part
+        // being painted now.
+        PaintInfo recordInfo(paintInfo);
+        recordInfo.context = &context;
+        recordInfo.rect = bounds;
+        paintChildren(recordInfo);
+        m_cachedPicture->endRecording();
+    }
+
+    SkCanvas* canvas = paintInfo.context->platformContext()->mCanvas;
+    canvas->save(SkCanvas::kMatrix_SaveFlag);
+    canvas->translate(SkIntToScalar(m_cachedPictureBounds.x()), SkIntToScalar(m_cachedPictureBounds.y()));
+    canvas->drawPicture(*m_cachedPicture);
+    canvas->restore();
+    return true;
+}
+
+void RenderSVGContainer::invalidateCachedPicture()
+{
+    m_canCachePicture = false;
+    if (m_cachedPicture) {
+        m_cachedPicture->unref();
+        m_cachedPicture = 0;
+    }
+}
+
+bool RenderSVGContainer::containsForeignObject() const
+{
+    for (RenderObject* object = firstChild(); object; object = object->nextInPreOrder(const_cast<RenderSVGContainer*>(this))) {
+        if (object->isSVGForeignObject())
+            return true;
+    }
+    return false;
+}
+
+void RenderSVGContainer::computeRectForRepaint(RenderBoxModelObject* repaintContainer, IntRect& repaintRect, bool fixed)
+{
+    invalidateCachedPicture();
+    RenderSVGModelObject::computeRectForRepaint(repaintContainer, repaintRect, fixed);
+}
+#endif
+
 // addFocusRingRects is called from paintOutline and needs to be in the same coordinates as the paintOuline call
 void RenderSVGContainer::addFocusRingRects(Vector<IntRect>& rects, int, int)
 {
@@ -7,6 +7,10 @@
 
 #include "RenderSVGModelObject.h"
 
+#if PLATFORM(ANDROID)
+class SkPicture;
+#endif
+
 namespace WebCore {
 
 class SVGElement;
@@ -14,6 +18,9 @@ class SVGElement;
 class RenderSVGContainer : public RenderSVGModelObject {
 public:
     RenderSVGContainer(SVGStyledElement*);
+#if PLATFORM(ANDROID)
+    virtual ~RenderSVGContainer();
+#endif
 
     const RenderObjectChildList* children() const { return &m_children; }
     RenderObjectChildList* children() { return &m_children; }
@@ -24,6 +31,11 @@ public:
 
     virtual void paint(PaintInfo&, int parentX, int parentY);
 
+#if PLATFORM(ANDROID)
+    // Every repaint inside the container maps its rect through here.
+    virtual void computeRectForRepaint(RenderBoxModelObject* repaintContainer, IntRect&, bool fixed = false);
+#endif
+
 protected:
     virtual RenderObjectChildList* virtualChildren() { return children(); }
     virtual const RenderObjectChildList* virtualChildren() const { return children(); }
@@ -52,8 +64,24 @@ protected:
     bool selfWillPaint() const;
 
 private:
+    void paintChildren(PaintInfo&);
+
+#if PLATFORM(ANDROID)
+    // Replays, recording first if needed, a picture of the children. Returns
+    // false if the children have to be painted directly.
+    bool paintChildrenFromCache(PaintInfo&, const FloatRect& boundingBox);
+    void invalidateCachedPicture();
+    bool containsForeignObject() const;
+#endif
+
     RenderObjectChildList m_children;
     bool m_drawsContents : 1;
+#if PLATFORM(ANDROID)
+    // Set by a paint after the last change, so that the next one records
+    bool m_canCachePicture : 1;
+    SkPicture* m_cachedPicture;
+    IntRect m_cachedPictureBounds;
+#endif
 };
   
 inline RenderSVGContainer* toRenderSVGContainer(RenderObject* object)
@@ -30,6 +30,7 @@ RenderTable::RenderTable(Node* node)
     , m_head(0)
     , m_foot(0)
     , m_firstBody(0)
+    , m_gridVersion(0)
     , m_currentBorder(0)
     , m_hasColElements(false)
     , m_needsSectionRecalc(0)
@@ -604,6 +605,7 @@ void RenderTable::splitColumn(int pos, int firstSpan)
     }
 
     m_columnPos.grow(numEffCols() + 1);
+    ++m_gridVersion;
     setNeedsLayoutAndPrefWidthsRecalc();
 }
 
@@ -622,6 +624,7 @@ void RenderTable::appendColumn(int span)
     }
 
     m_columnPos.grow(numEffCols() + 1);
+    ++m_gridVersion;
     setNeedsLayoutAndPrefWidthsRecalc();
 }
 
@@ -734,6 +737,7 @@ void RenderTable::recalcSections() const
 
     ASSERT(selfNeedsLayout());
 
+    ++m_gridVersion;
     m_needsSectionRecalc = false;
 }
 
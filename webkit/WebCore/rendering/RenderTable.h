@@ -91,6 +91,12 @@ public:
     }
 
     RenderTableCol* colElement(int col, bool* startEdge = 0, bool* endEdge = 0) const;
+    bool hasColElements() const { return m_hasColElements; }
+
+    // Changes whenever the sections rebuild their cell grids or columns are
+    // split or added, so that the table layout can tell whether the widths
+    // it remembers per column still belong to the same cells.
+    unsigned gridVersion() const { return m_gridVersion; }
 
     bool needsSectionRecalc() const { return m_needsSectionRecalc; }
     void setNeedsSectionRecalc()
@@ -165,6 +171,8 @@ private:
     mutable RenderTableSection* m_foot;
     mutable RenderTableSection* m_firstBody;
 
+    mutable unsigned m_gridVersion;
+
     OwnPtr<TableLayout> m_tableLayout;
 
     const CollapsedBorderValue* m_currentBorder;
@@ -19,6 +19,7 @@
 #include "VisiblePosition.h"
 #include "break_lines.h"
 #include <wtf/AlwaysInline.h>
+#include <wtf/HashMap.h>
 
 using namespace std;
 using namespace WTF;
@@ -26,12 +27,57 @@ using namespace Unicode;
 
 namespace WebCore {
 
+// Widths of words measured in the text's own font, kept so that breaking
+// lines and computing preferred widths don't measure the same words again
+// in every layout. They stay valid for as long as the text and the style
+// they were measured in, which the cache keeps a reference to so that a
+// new style can't be mistaken for it.
+struct RenderText::WordWidthCache : Noncopyable {
+    // Keyed by start << 32 | length; lengths are never 0.
+    typedef HashMap<unsigned long long, int> WidthMap;
+
+    RefPtr<RenderStyle> style;
+    WidthMap widths;
+};
+
+// Short texts are mostly measured whole, which the preferred widths
+// already cover. Longer runs are rarely measured twice at the same offset,
+// and a text broken into very many words would cost a lot of memory.
+static const unsigned minCachedTextLength = 64;
+static const int maxCachedWordLength = 64;
+static const unsigned maxCachedWordCount = 1024;
+
 // FIXME: Move to StringImpl.h eventually.
 static inline bool charactersAreAllASCII(StringImpl* text)
 {
     return charactersAreAllASCII(text->characters(), text->length());
 }
 
+static bool charactersAreAllLeftToRight(StringImpl* text, bool isAllASCII)
+{
+    if (isAllASCII)
+        return true;
+
+    const UChar* characters = text->characters();
+    unsigned length = text->length();
+    for (unsigned i = 0; i < length; ++i) {
+        switch (direction(characters[i])) {
+        case RightToLeft:
+        case RightToLeftArabic:
+        case ArabicNumber:
+        case LeftToRightEmbedding:
+        case LeftToRightOverride:
+        case RightToLeftEmbedding:
+        case RightToLeftOverride:
+        case PopDirectionalFormat:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
 RenderText::RenderText(Node* node, PassRefPtr<StringImpl> str)
      : RenderObject(node)
      , m_minWidth(-1)
@@ -45,6 +91,7 @@ RenderText::RenderText(Node* node, PassRefPtr<StringImpl> str)
      , m_linesDirty(false)
      , m_containsReversedText(false)
      , m_isAllASCII(charactersAreAllASCII(m_text.get()))
+     , m_isAllLeftToRight(charactersAreAllLeftToRight(m_text.get(), m_isAllASCII))
      , m_knownNotToUseFallbackFonts(false)
 {
     ASSERT(m_text);
@@ -57,16 +104,12 @@ RenderText::RenderText(Node* node, PassRefPtr<StringImpl> str)
     view()->frameView()->setIsVisuallyNonEmpty();
 }
 
-#ifndef NDEBUG
-
 RenderText::~RenderText()
 {
     ASSERT(!m_firstTextBox);
     ASSERT(!m_lastTextBox);
 }
 
-#endif
-
 const char* RenderText::renderName() const
 {
     return "RenderText";
@@ -437,7 +480,40 @@ ALWAYS_INLINE int RenderText::widthFromCache(const Font& f, int start, int len,
         return w;
     }
 
-    return f.width(TextRun(text()->characters() + start, len, allowTabs(), xPos), fallbackFonts);
+    return measuredWordWidth(f, start, len, xPos, fallbackFonts);
+}
+
+int RenderText::measuredWordWidth(const Font& f, int start, int len, int xPos, HashSet<const SimpleFontData*>* fallbackFonts) const
+{
+    // With tabs the width depends on where the word starts.
+    if (textLength() < minCachedTextLength || len > maxCachedWordLength || allowTabs() || &f != &style()->font())
+        return f.width(TextRun(text()->characters() + start, len, allowTabs(), xPos), fallbackFonts);
+
+    if (!m_wordWidthCache)
+        m_wordWidthCache.set(new WordWidthCache);
+    if (m_wordWidthCache->style != style()) {
+        m_wordWidthCache->style = style();
+        m_wordWidthCache->widths.clear();
+    }
+
+    unsigned long long key = static_cast<unsigned long long>(start) << 32 | len;
+    WordWidthCache::WidthMap::iterator it = m_wordWidthCache->widths.find(key);
+    if (it != m_wordWidthCache->widths.end())
+        return it->second;
+
+    // Only widths that didn't need fallback fonts are kept, so that a hit
+    // never has fonts to report.
+    HashSet<const SimpleFontData*> wordFallbackFonts;
+    int w = f.width(TextRun(text()->characters() + start, len, false, xPos), &wordFallbackFonts);
+    if (!wordFallbackFonts.isEmpty()) {
+        if (fallbackFonts) {
+            HashSet<const SimpleFontData*>::iterator end = wordFallbackFonts.end();
+            for (HashSet<const SimpleFontData*>::iterator font = wordFallbackFonts.begin(); font != end; ++font)
+                fallbackFonts->add(*font);
+        }
+    } else if (m_wordWidthCache->widths.size() < maxCachedWordCount)
+        m_wordWidthCache->widths.add(key, w);
+    return w;
 }
 
 void RenderText::trimmedPrefWidths(int leadWidth,
@@ -580,6 +656,7 @@ void RenderText::calcPrefWidths(int leadWidth, HashSet<const SimpleFontData*>& f
     int wordSpacing = style()->wordSpacing();
     int len = textLength();
     const UChar* txt = characters();
+    const LineBreakOpportunities* breakOpportunities = lineBreakOpportunities();
     bool needsWordSpacing = false;
     bool ignoringSpaces = false;
     bool isSpace = false;
@@ -635,7 +712,7 @@ void RenderText::calcPrefWidths(int leadWidth, HashSet<const SimpleFontData*>& f
             continue;
         }
 
-        bool hasBreak = breakAll || isBreakable(txt, i, len, nextBreakable, breakNBSP);
+        bool hasBreak = breakAll || isBreakable(txt, i, len, nextBreakable, breakNBSP, breakOpportunities);
         bool betweenWords = true;
         int j = i;
         while (c != '\n' && !isSpaceAccordingToStyle(c, style()) && c != '\t' && c != softHyphen) {
@@ -643,7 +720,7 @@ void RenderText::calcPrefWidths(int leadWidth, HashSet<const SimpleFontData*>& f
             if (j == len)
                 break;
             c = txt[j];
-            if (isBreakable(txt, j, len, nextBreakable, breakNBSP))
+            if (isBreakable(txt, j, len, nextBreakable, breakNBSP, breakOpportunities))
                 break;
             if (breakAll) {
                 betweenWords = false;
@@ -982,6 +1059,18 @@ void RenderText::setTextInternal(PassRefPtr<StringImpl> text)
     ASSERT(!isBR() || (textLength() == 1 && (*m_text)[0] == '\n'));
 
     m_isAllASCII = charactersAreAllASCII(m_text.get());
+    m_isAllLeftToRight = charactersAreAllLeftToRight(m_text.get(), m_isAllASCII);
+    m_wordWidthCache.clear();
+    m_lineBreakOpportunities.clear();
+}
+
+const LineBreakOpportunities* RenderText::lineBreakOpportunities() const
+{
+    if (m_isAllASCII)
+        return 0;
+    if (!m_lineBreakOpportunities)
+        m_lineBreakOpportunities.set(new LineBreakOpportunities(characters(), textLength()));
+    return m_lineBreakOpportunities.get();
 }
 
 void RenderText::setText(PassRefPtr<StringImpl> text, bool force)
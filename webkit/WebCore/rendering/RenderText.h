@@ -8,14 +8,13 @@
 namespace WebCore {
 
 class InlineTextBox;
+class LineBreakOpportunities;
 class StringImpl;
 
 class RenderText : public RenderObject {
 public:
     RenderText(Node*, PassRefPtr<StringImpl>);
-#ifndef NDEBUG
     virtual ~RenderText();
-#endif
 
     virtual const char* renderName() const;
 
@@ -93,6 +92,9 @@ public:
     virtual int nextOffset(int current) const;
 
     bool containsReversedText() const { return m_containsReversedText; }
+    // Whether the text has no right-to-left characters, Arabic numbers or
+    // explicit embedding controls, so that it can't be reordered on its own.
+    bool isAllLeftToRight() const { return m_isAllLeftToRight; }
 
     InlineTextBox* findNextInlineTextBox(int offset, int& pos) const;
 
@@ -102,6 +104,10 @@ public:
 
     virtual void calcPrefWidths(int leadWidth);
     bool isAllCollapsibleWhitespace();
+
+    // 0 if the text has no characters the line breaking algorithm has to
+    // be asked about
+    const LineBreakOpportunities* lineBreakOpportunities() const;
     
 protected:
     virtual void styleWillChange(StyleDifference, const RenderStyle*) { }
@@ -127,12 +133,17 @@ private:
     void deleteTextBoxes();
     bool containsOnlyWhitespace(unsigned from, unsigned len) const;
     int widthFromCache(const Font&, int start, int len, int xPos, HashSet<const SimpleFontData*>* fallbackFonts) const;
+    int measuredWordWidth(const Font&, int start, int len, int xPos, HashSet<const SimpleFontData*>* fallbackFonts) const;
     bool isAllASCII() const { return m_isAllASCII; }
 
     int m_minWidth; // here to minimize padding in 64-bit.
 
     RefPtr<StringImpl> m_text;
 
+    struct WordWidthCache;
+    mutable OwnPtr<WordWidthCache> m_wordWidthCache;
+    mutable OwnPtr<LineBreakOpportunities> m_lineBreakOpportunities;
+
     InlineTextBox* m_firstTextBox;
     InlineTextBox* m_lastTextBox;
 
@@ -151,6 +162,7 @@ private:
                            // or removed).
     bool m_containsReversedText : 1;
     bool m_isAllASCII : 1;
+    bool m_isAllLeftToRight : 1;
     mutable bool m_knownNotToUseFallbackFonts : 1;
 };
 
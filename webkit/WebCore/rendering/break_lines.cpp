@@ -80,7 +80,28 @@ static inline TextBreakLocatorRef lineBreakLocator()
 }
 #endif
 
-int nextBreakablePosition(const UChar* str, int pos, int len, bool treatNoBreakSpaceAsBreak)
+LineBreakOpportunities::LineBreakOpportunities(const UChar* str, int length)
+    : m_bits((length + 32) / 32)
+    , m_length(length)
+{
+    m_bits.fill(0);
+    TextBreakIterator* breakIterator = lineBreakIterator(str, length);
+    if (!breakIterator)
+        return;
+    for (int i = textBreakFirst(breakIterator); i != TextBreakDone; i = textBreakNext(breakIterator))
+        m_bits[i / 32] |= 1u << (i % 32);
+}
+
+int LineBreakOpportunities::following(int position) const
+{
+    for (int i = position + 1; i <= m_length; ++i) {
+        if (m_bits[i / 32] & (1u << (i % 32)))
+            return i;
+    }
+    return TextBreakDone;
+}
+
+int nextBreakablePosition(const UChar* str, int pos, int len, bool treatNoBreakSpaceAsBreak, const LineBreakOpportunities* opportunities)
 {
 #if !PLATFORM(MAC) || !defined(BUILDING_ON_TIGER)
     TextBreakIterator* breakIterator = 0;
@@ -96,19 +117,23 @@ int nextBreakablePosition(const UChar* str, int pos, int len, bool treatNoBreakS
 
         if (needsLineBreakIterator(ch) || needsLineBreakIterator(lastCh)) {
             if (nextBreak < i && i) {
+                if (opportunities)
+                    nextBreak = opportunities->following(i - 1);
+                else {
 #if !PLATFORM(MAC) || !defined(BUILDING_ON_TIGER)
-                if (!breakIterator)
-                    breakIterator = lineBreakIterator(str, len);
-                if (breakIterator)
-                    nextBreak = textBreakFollowing(breakIterator, i - 1);
+                    if (!breakIterator)
+                        breakIterator = lineBreakIterator(str, len);
+                    if (breakIterator)
+                        nextBreak = textBreakFollowing(breakIterator, i - 1);
 #else
-                static TextBreakLocatorRef breakLocator = lineBreakLocator();
-                if (breakLocator) {
-                    UniCharArrayOffset nextUCBreak;
-                    if (UCFindTextBreak(breakLocator, kUCTextBreakLineMask, 0, str, len, i, &nextUCBreak) == 0)
-                        nextBreak = nextUCBreak;
-                }
+                    static TextBreakLocatorRef breakLocator = lineBreakLocator();
+                    if (breakLocator) {
+                        UniCharArrayOffset nextUCBreak;
+                        if (UCFindTextBreak(breakLocator, kUCTextBreakLineMask, 0, str, len, i, &nextUCBreak) == 0)
+                            nextBreak = nextUCBreak;
+                    }
 #endif
+                }
             }
             if (i == nextBreak && !isBreakableSpace(lastCh, treatNoBreakSpaceAsBreak))
                 return i;
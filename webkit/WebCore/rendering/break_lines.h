@@ -3,16 +3,34 @@
 #ifndef break_lines_h
 #define break_lines_h
 
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
 #include <wtf/unicode/Unicode.h>
 
 namespace WebCore {
 
-    int nextBreakablePosition(const UChar*, int pos, int len, bool breakNBSP = false);
+    // The positions the Unicode line breaking algorithm allows a break
+    // before, found in one pass over the text. Asking the break iterator
+    // one position at a time is slow for CJK and Thai text, so RenderText
+    // keeps these for as long as its text doesn't change.
+    class LineBreakOpportunities : public Noncopyable {
+    public:
+        LineBreakOpportunities(const UChar*, int length);
 
-    inline bool isBreakable(const UChar* str, int pos, int len, int& nextBreakable, bool breakNBSP = false)
+        // The first opportunity after position, or TextBreakDone
+        int following(int position) const;
+
+    private:
+        Vector<unsigned> m_bits;
+        int m_length;
+    };
+
+    int nextBreakablePosition(const UChar*, int pos, int len, bool breakNBSP = false, const LineBreakOpportunities* = 0);
+
+    inline bool isBreakable(const UChar* str, int pos, int len, int& nextBreakable, bool breakNBSP = false, const LineBreakOpportunities* opportunities = 0)
     {
         if (pos > nextBreakable)
-            nextBreakable = nextBreakablePosition(str, pos, len, breakNBSP);
+            nextBreakable = nextBreakablePosition(str, pos, len, breakNBSP, opportunities);
         return pos == nextBreakable;
     }
 
@@ -480,6 +480,7 @@ bool Database::performOpenAndVerify(ExceptionCode& e)
     ASSERT(m_databaseAuthorizer);
     m_sqliteDatabase.setAuthorizer(m_databaseAuthorizer);
     m_sqliteDatabase.setBusyTimeout(maxSqliteBusyWaitTime);
+    m_sqliteDatabase.useWriteAheadLog();
 
     String currentVersion;
     {
@@ -19,6 +19,7 @@ void DatabaseAuthorizer::reset()
 {
     m_lastActionWasInsert = false;
     m_lastActionChangedDatabase = false;
+    m_lastActionChangedSchema = false;
     m_readOnly = false;
 }
 
@@ -90,6 +91,7 @@ int DatabaseAuthorizer::createTable(const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     m_lastActionChangedDatabase = true;
     return denyBasedOnTableName(tableName);
 }
@@ -102,6 +104,7 @@ int DatabaseAuthorizer::createTempTable(const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -110,6 +113,7 @@ int DatabaseAuthorizer::dropTable(const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -121,6 +125,7 @@ int DatabaseAuthorizer::dropTempTable(const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -129,6 +134,7 @@ int DatabaseAuthorizer::allowAlterTable(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     m_lastActionChangedDatabase = true;
     return denyBasedOnTableName(tableName);
 }
@@ -138,6 +144,7 @@ int DatabaseAuthorizer::createIndex(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     m_lastActionChangedDatabase = true;
     return denyBasedOnTableName(tableName);
 }
@@ -150,6 +157,7 @@ int DatabaseAuthorizer::createTempIndex(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -158,6 +166,7 @@ int DatabaseAuthorizer::dropIndex(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -169,6 +178,7 @@ int DatabaseAuthorizer::dropTempIndex(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -177,6 +187,7 @@ int DatabaseAuthorizer::createTrigger(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     m_lastActionChangedDatabase = true;
     return denyBasedOnTableName(tableName);
 }
@@ -189,6 +200,7 @@ int DatabaseAuthorizer::createTempTrigger(const String&, const String& tableName
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -197,6 +209,7 @@ int DatabaseAuthorizer::dropTrigger(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
@@ -208,12 +221,17 @@ int DatabaseAuthorizer::dropTempTrigger(const String&, const String& tableName)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return denyBasedOnTableName(tableName);
 }
 
 int DatabaseAuthorizer::createView(const String&)
 {
-    return (m_readOnly && m_securityEnabled ? SQLAuthDeny : SQLAuthAllow);
+    if (m_readOnly && m_securityEnabled)
+        return SQLAuthDeny;
+
+    m_lastActionChangedSchema = true;
+    return SQLAuthAllow;
 }
 
 int DatabaseAuthorizer::createTempView(const String&)
@@ -221,12 +239,20 @@ int DatabaseAuthorizer::createTempView(const String&)
     // SQLITE_CREATE_TEMP_VIEW results in a UPDATE operation, which is not
     // allowed in read-only transactions or private browsing, so we might as
     // well disallow SQLITE_CREATE_TEMP_VIEW in these cases
-    return (m_readOnly && m_securityEnabled ? SQLAuthDeny : SQLAuthAllow);
+    if (m_readOnly && m_securityEnabled)
+        return SQLAuthDeny;
+
+    m_lastActionChangedSchema = true;
+    return SQLAuthAllow;
 }
 
 int DatabaseAuthorizer::dropView(const String&)
 {
-    return (m_readOnly && m_securityEnabled ? SQLAuthDeny : SQLAuthAllow);
+    if (m_readOnly && m_securityEnabled)
+        return SQLAuthDeny;
+
+    m_lastActionChangedSchema = true;
+    return SQLAuthAllow;
 }
 
 int DatabaseAuthorizer::dropTempView(const String&)
@@ -234,7 +260,11 @@ int DatabaseAuthorizer::dropTempView(const String&)
     // SQLITE_DROP_TEMP_VIEW results in a DELETE operation, which is not
     // allowed in read-only transactions or private browsing, so we might as
     // well disallow SQLITE_DROP_TEMP_VIEW in these cases
-    return (m_readOnly && m_securityEnabled ? SQLAuthDeny : SQLAuthAllow);
+    if (m_readOnly && m_securityEnabled)
+        return SQLAuthDeny;
+
+    m_lastActionChangedSchema = true;
+    return SQLAuthAllow;
 }
 
 int DatabaseAuthorizer::createVTable(const String&, const String&)
@@ -242,6 +272,7 @@ int DatabaseAuthorizer::createVTable(const String&, const String&)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     m_lastActionChangedDatabase = true;
     return m_securityEnabled ? SQLAuthDeny : SQLAuthAllow;
 }
@@ -251,6 +282,7 @@ int DatabaseAuthorizer::dropVTable(const String&, const String&)
     if (m_readOnly && m_securityEnabled)
         return SQLAuthDeny;
 
+    m_lastActionChangedSchema = true;
     return m_securityEnabled ? SQLAuthDeny : SQLAuthAllow;
 }
 
@@ -339,6 +371,12 @@ void DatabaseAuthorizer::setReadOnly()
     m_readOnly = true;
 }
 
+void DatabaseAuthorizer::setLastActions(bool wasInsert, bool changedDatabase)
+{
+    m_lastActionWasInsert = wasInsert;
+    m_lastActionChangedDatabase = changedDatabase;
+}
+
 int DatabaseAuthorizer::denyBasedOnTableName(const String& tableName)
 {
     if (!m_securityEnabled)
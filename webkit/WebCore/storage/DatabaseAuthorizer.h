@@ -62,11 +62,17 @@ public:
     void disable();
     void enable();
     void setReadOnly();
+    bool isReadOnly() const { return m_readOnly; }
 
     void reset();
 
     bool lastActionWasInsert() const { return m_lastActionWasInsert; }
     bool lastActionChangedDatabase() const { return m_lastActionChangedDatabase; }
+    bool lastActionChangedSchema() const { return m_lastActionChangedSchema; }
+
+    // A statement reused from the statement cache isn't prepared again, so
+    // the actions seen when it was prepared have to be restored.
+    void setLastActions(bool wasInsert, bool changedDatabase);
 
 private:
     DatabaseAuthorizer();
@@ -76,6 +82,7 @@ private:
     bool m_securityEnabled : 1;
     bool m_lastActionWasInsert : 1;
     bool m_lastActionChangedDatabase : 1;
+    bool m_lastActionChangedSchema : 1;
     bool m_readOnly : 1;
 
     HashSet<String, CaseFoldingHash> m_whitelistedFunctions;
@@ -6,6 +6,7 @@
 
 #include "Database.h"
 #include "Logging.h"
+#include <wtf/CurrentTime.h>
 
 namespace WebCore {
 
@@ -33,6 +34,7 @@ void DatabaseTaskSynchronizer::taskCompleted()
 DatabaseTask::DatabaseTask(Database* database, DatabaseTaskSynchronizer* synchronizer)
     : m_database(database)
     , m_synchronizer(synchronizer)
+    , m_creationTime(currentTime())
 #ifndef NDEBUG
     , m_complete(false)
 #endif
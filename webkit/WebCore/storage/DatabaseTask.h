@@ -47,6 +47,9 @@ public:
     void performTask();
 
     Database* database() const { return m_database; }
+    // Tasks are scheduled as soon as they are created, so this is also when
+    // the task was queued.
+    double creationTime() const { return m_creationTime; }
 
 protected:
     DatabaseTask(Database*, DatabaseTaskSynchronizer*);
@@ -56,6 +59,7 @@ private:
 
     Database* m_database;
     DatabaseTaskSynchronizer* m_synchronizer;
+    double m_creationTime;
 
 #ifndef NDEBUG
      virtual const char* debugTaskName() const = 0;
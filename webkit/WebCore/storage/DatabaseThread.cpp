@@ -11,14 +11,27 @@
 #include "Logging.h"
 #include "SQLTransactionClient.h"
 #include "SQLTransactionCoordinator.h"
+#include <wtf/CurrentTime.h>
+
+#if PLATFORM(ANDROID)
+#include <sys/resource.h>
+#endif
 
 namespace WebCore {
 
+#if PLATFORM(ANDROID)
+// ANDROID_PRIORITY_BACKGROUND
+static const int databaseThreadNiceness = 10;
+#endif
+
 DatabaseThread::DatabaseThread()
     : m_threadID(0)
     , m_transactionClient(new SQLTransactionClient())
     , m_transactionCoordinator(new SQLTransactionCoordinator())
     , m_cleanupSync(0)
+    , m_tasksPerformed(0)
+    , m_totalQueueTime(0)
+    , m_longestQueueTime(0)
 {
     m_selfRef = this;
 }
@@ -68,12 +81,28 @@ void* DatabaseThread::databaseThread()
         LOG(StorageAPI, "Started DatabaseThread %p", this);
     }
 
+#if PLATFORM(ANDROID)
+    // Each document has its own database thread, and a few of them writing
+    // to flash at once shouldn't starve the main thread. On Linux this only
+    // affects the calling thread. Background niceness also gets a lower
+    // I/O priority from the scheduler.
+    setpriority(PRIO_PROCESS, 0, databaseThreadNiceness);
+#endif
+
     AutodrainedPool pool;
     while (OwnPtr<DatabaseTask> task = m_queue.waitForMessage()) {
+        double queueTime = currentTime() - task->creationTime();
+        ++m_tasksPerformed;
+        m_totalQueueTime += queueTime;
+        if (queueTime > m_longestQueueTime)
+            m_longestQueueTime = queueTime;
         task->performTask();
         pool.cycle();
     }
 
+    LOG(StorageAPI, "DatabaseThread %p ran %u tasks, which waited %.1fms on average and at most %.1fms", this, m_tasksPerformed,
+        m_tasksPerformed ? m_totalQueueTime * 1000 / m_tasksPerformed : 0.0, m_longestQueueTime * 1000);
+
     // Clean up the list of all pending transactions on this database thread
     m_transactionCoordinator->shutdown();
 
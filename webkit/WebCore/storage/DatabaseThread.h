@@ -61,6 +61,11 @@ private:
     OwnPtr<SQLTransactionClient> m_transactionClient;
     OwnPtr<SQLTransactionCoordinator> m_transactionCoordinator;
     DatabaseTaskSynchronizer* m_cleanupSync;
+
+    // How long tasks sat in the queue before running, in seconds
+    unsigned m_tasksPerformed;
+    double m_totalQueueTime;
+    double m_longestQueueTime;
 };
 
 } // namespace WebCore
@@ -162,7 +162,13 @@ unsigned long long DatabaseTracker::getMaxSizeForDatabase(const Database* databa
     // plus the current usage of the given database
     Locker<OriginQuotaManager> locker(originQuotaManager());
     SecurityOrigin* origin = database->securityOrigin();
-    return quotaForOrigin(origin) - originQuotaManager().diskUsage(origin) + SQLiteFileSystem::getDatabaseFileSize(database->fileName());
+    unsigned long long usage = originQuotaManager().diskUsage(origin);
+    // diskUsage() has just brought the database's size up to date, so only
+    // stat the file if the quota manager doesn't know it.
+    unsigned long long databaseSize;
+    if (!originQuotaManager().databaseSize(database, databaseSize))
+        databaseSize = SQLiteFileSystem::getDatabaseFileSize(database->fileName());
+    return quotaForOrigin(origin) - usage + databaseSize;
 }
 
 String DatabaseTracker::originPath(SecurityOrigin* origin) const
@@ -94,6 +94,15 @@ unsigned long long OriginQuotaManager::diskUsage(SecurityOrigin* origin) const
     return usageRecord->diskUsage();
 }
 
+bool OriginQuotaManager::databaseSize(const Database* database, unsigned long long& size) const
+{
+    ASSERT(database);
+    ASSERT(m_usageRecordGuardLocked);
+
+    OriginUsageRecord* usageRecord = m_usageMap.get(database->securityOrigin());
+    return usageRecord && usageRecord->databaseSize(database->stringIdentifier(), size);
+}
+
 }
 
 #endif // ENABLE(DATABASE)
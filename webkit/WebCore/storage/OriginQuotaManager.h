@@ -30,6 +30,9 @@ public:
 
     void markDatabase(Database*); // Mark dirtiness of a specific database.
     unsigned long long diskUsage(SecurityOrigin*) const;
+    // The database's share of the last diskUsage() of its origin, if that is
+    // still current.
+    bool databaseSize(const Database*, unsigned long long& size) const;
 
 private:
     mutable Mutex m_usageRecordGuard;
@@ -9,7 +9,7 @@
 namespace WebCore {
 
 OriginUsageRecord::OriginUsageRecord()
-    : m_cachedDiskUsageIsValid(false)
+    : m_diskUsage(0)
 {
 }
 
@@ -21,17 +21,20 @@ void OriginUsageRecord::addDatabase(const String& identifier, const String& full
 
     m_databaseMap.set(identifier, DatabaseEntry(fullPath));
     m_unknownSet.add(identifier);
-
-    m_cachedDiskUsageIsValid = false;
 }
 
 void OriginUsageRecord::removeDatabase(const String& identifier)
 {
     ASSERT(m_databaseMap.contains(identifier));
 
-    m_databaseMap.remove(identifier);
+    HashMap<String, DatabaseEntry>::iterator it = m_databaseMap.find(identifier);
+    if (it == m_databaseMap.end())
+        return;
+    // The last known size is the one that was counted.
+    ASSERT(m_diskUsage >= it->second.size);
+    m_diskUsage -= it->second.size;
+    m_databaseMap.remove(it);
     m_unknownSet.remove(identifier);
-    m_cachedDiskUsageIsValid = false;
 }
 
 void OriginUsageRecord::markDatabase(const String& identifier)
@@ -40,37 +43,40 @@ void OriginUsageRecord::markDatabase(const String& identifier)
     ASSERT_ARG(identifier, identifier.impl()->refCount() == 1);
 
     m_unknownSet.add(identifier);
-    m_cachedDiskUsageIsValid = false;
 }
 
 unsigned long long OriginUsageRecord::diskUsage()
 {
-    // Use the last cached usage value if we have it.
-    if (m_cachedDiskUsageIsValid)
-        return m_cachedDiskUsage;
-
-    // stat() for the sizes known to be dirty.
+    // stat() only the databases whose sizes are known to be dirty, and move
+    // the total by how much each one changed.
     HashSet<String>::iterator iUnknown = m_unknownSet.begin();
     HashSet<String>::iterator endUnknown = m_unknownSet.end();
     for (; iUnknown != endUnknown; ++iUnknown) {
-        const String& path = m_databaseMap.get(*iUnknown).filename;
+        HashMap<String, DatabaseEntry>::iterator it = m_databaseMap.find(*iUnknown);
+        ASSERT(it != m_databaseMap.end());
+        const String& path = it->second.filename;
         ASSERT(!path.isEmpty());
 
         // When we can't determine the file size, we'll just have to assume the file is missing/inaccessible.
         long long size = SQLiteFileSystem::getDatabaseFileSize(path);
-        m_databaseMap.set(*iUnknown, DatabaseEntry(path, size));
+        ASSERT(m_diskUsage >= it->second.size);
+        m_diskUsage = m_diskUsage - it->second.size + size;
+        it->second.size = size;
     }
     m_unknownSet.clear();
 
-    // Recalculate the cached usage value.
-    m_cachedDiskUsage = 0;
-    HashMap<String, DatabaseEntry>::iterator iDatabase = m_databaseMap.begin();
-    HashMap<String, DatabaseEntry>::iterator endDatabase = m_databaseMap.end();
-    for (; iDatabase != endDatabase; ++iDatabase)
-        m_cachedDiskUsage += iDatabase->second.size;
+    return m_diskUsage;
+}
 
-    m_cachedDiskUsageIsValid = true;
-    return m_cachedDiskUsage;
+bool OriginUsageRecord::databaseSize(const String& identifier, unsigned long long& size) const
+{
+    if (m_unknownSet.contains(identifier))
+        return false;
+    HashMap<String, DatabaseEntry>::const_iterator it = m_databaseMap.find(identifier);
+    if (it == m_databaseMap.end())
+        return false;
+    size = it->second.size;
+    return true;
 }
 
 }
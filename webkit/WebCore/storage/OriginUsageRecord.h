@@ -21,21 +21,24 @@ public:
     void addDatabase(const String& identifier, const String& fullPath);
     void removeDatabase(const String& identifier);
     void markDatabase(const String& identifier); // Size may have changed, and will need to be recalculated.
+    // Only stats the databases marked since the last call.
     unsigned long long diskUsage();
+    // The size diskUsage() last counted for the database. Returns false if
+    // the database isn't tracked or has been marked since.
+    bool databaseSize(const String& identifier, unsigned long long& size) const;
 
 private:
     struct DatabaseEntry {
-        DatabaseEntry() { }
-        DatabaseEntry(const String& filename) : filename(filename) { }
-        DatabaseEntry(const String& filename, unsigned long long size) : filename(filename), size(size) { }
+        DatabaseEntry() : size(0) { }
+        DatabaseEntry(const String& filename) : filename(filename), size(0) { }
         String filename;
-        unsigned long long size; // This member remains uninitialized until disk usage is calculated.
+        unsigned long long size; // Zero until the size has first been calculated.
     };
     HashMap<String, DatabaseEntry> m_databaseMap;
     HashSet<String> m_unknownSet;
 
-    unsigned long long m_cachedDiskUsage;
-    bool m_cachedDiskUsageIsValid;
+    // The sum of the sizes in m_databaseMap
+    unsigned long long m_diskUsage;
 };
 
 } // namespace WebCore
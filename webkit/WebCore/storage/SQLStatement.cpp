@@ -50,7 +50,7 @@ bool SQLStatement::execute(Database* db)
     SQLiteDatabase* database = &db->m_sqliteDatabase;
 
     SQLiteStatement statement(*database, m_statement);
-    int result = statement.prepare();
+    int result = statement.prepareCached();
 
     if (result != SQLResultOk) {
         LOG(StorageAPI, "Unable to verify correctness of statement %s - error %i (%s)", m_statement.ascii().data(), result, database->lastErrorMsg());
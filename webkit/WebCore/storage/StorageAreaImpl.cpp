@@ -104,6 +104,11 @@ String StorageAreaImpl::key(unsigned index) const
 String StorageAreaImpl::getItem(const String& key) const
 {
     ASSERT(!m_isShutdown);
+    // A page's first script usually reads a key or two; don't make it wait
+    // for the rest of the origin's items.
+    String value;
+    if (m_storageAreaSync && m_storageAreaSync->waitForImportedItem(key, value))
+        return value;
     blockUntilImportComplete();
 
     return m_storageMap->getItem(key);
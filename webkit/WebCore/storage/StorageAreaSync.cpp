@@ -10,6 +10,7 @@
 #include "HTMLElement.h"
 #include "SecurityOrigin.h"
 #include "SQLiteStatement.h"
+#include "SQLiteTransaction.h"
 #include "StorageAreaImpl.h"
 #include "StorageSyncManager.h"
 #include "SuddenTermination.h"
@@ -160,6 +161,8 @@ void StorageAreaSync::performImport()
         return;
     }
 
+    m_database.useWriteAheadLog();
+
     if (!m_database.executeCommand("CREATE TABLE IF NOT EXISTS ItemTable (key TEXT UNIQUE ON CONFLICT REPLACE, value TEXT NOT NULL ON CONFLICT FAIL)")) {
         LOG_ERROR("Failed to create table ItemTable for local storage");
         markImported();
@@ -173,12 +176,23 @@ void StorageAreaSync::performImport()
         return;
     }
 
-    HashMap<String, String> itemMap;
+    // Rows are published in batches so that a getItem() waiting for one
+    // key can return as soon as it has been read.
+    static const size_t importBatchSize = 32;
+    Vector<std::pair<String, String> > batch;
+    batch.reserveCapacity(importBatchSize);
 
     int result = query.step();
     while (result == SQLResultRow) {
-        itemMap.set(query.getColumnText(0), query.getColumnText(1));
+        batch.append(std::make_pair(query.getColumnText(0), query.getColumnText(1)));
         result = query.step();
+        if (batch.size() == importBatchSize || result != SQLResultRow) {
+            MutexLocker locker(m_importLock);
+            for (size_t i = 0; i < batch.size(); ++i)
+                m_importedItems.set(batch[i].first, batch[i].second);
+            batch.clear();
+            m_importCondition.broadcast();
+        }
     }
 
     if (result != SQLResultDone) {
@@ -187,8 +201,10 @@ void StorageAreaSync::performImport()
         return;
     }
 
-    HashMap<String, String>::iterator it = itemMap.begin();
-    HashMap<String, String>::iterator end = itemMap.end();
+    // The main thread only reads m_importedItems under the lock and never
+    // touches the storage area's map before the import completes.
+    HashMap<String, String>::iterator it = m_importedItems.begin();
+    HashMap<String, String>::iterator end = m_importedItems.end();
 
     for (; it != end; ++it)
         m_storageArea->importItem(it->first, it->second);
@@ -200,16 +216,17 @@ void StorageAreaSync::markImported()
 {
     MutexLocker locker(m_importLock);
     m_importComplete = true;
-    m_importCondition.signal();
+    m_importedItems.clear();
+    m_importCondition.broadcast();
 }
 
-// FIXME: In the future, we should allow use of StorageAreas while it's importing (when safe to do so).
+// FIXME: In the future, we should allow more use of StorageAreas while it's importing (when safe to do so).
 // Blocking everything until the import is complete is by far the simplest and safest thing to do, but
 // there is certainly room for safe optimization: Key/length will never be able to make use of such an
-// optimization (since the order of iteration can change as items are being added). Get can return any
-// item currently in the map. Get/remove can work whether or not it's in the map, but we'll need a list
-// of items the import should not overwrite. Clear can also work, but it'll need to kill the import
-// job first.
+// optimization (since the order of iteration can change as items are being added). Get already returns
+// items as soon as they have been read, see waitForImportedItem(). Remove can work whether or not the
+// item has been read, but we'll need a list of items the import should not overwrite. Clear can also
+// work, but it'll need to kill the import job first.
 void StorageAreaSync::blockUntilImportComplete()
 {
     ASSERT(isMainThread());
@@ -224,6 +241,28 @@ void StorageAreaSync::blockUntilImportComplete()
     m_storageArea = 0;
 }
 
+bool StorageAreaSync::waitForImportedItem(const String& key, String& value)
+{
+    ASSERT(isMainThread());
+
+    if (!m_storageArea)
+        return false;
+
+    // Nothing can have been written yet, as every write waits for the whole
+    // import, so the stored value is the current one.
+    MutexLocker locker(m_importLock);
+    while (!m_importComplete) {
+        HashMap<String, String>::iterator it = m_importedItems.find(key);
+        if (it != m_importedItems.end()) {
+            // The import thread owns the strings in the map.
+            value = it->second.threadsafeCopy();
+            return true;
+        }
+        m_importCondition.wait(m_importLock);
+    }
+    return false;
+}
+
 void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items)
 {
     ASSERT(!isMainThread());
@@ -231,6 +270,12 @@ void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items
     if (!m_database.isOpen())
         return;
 
+    // Write everything in one transaction so that the batch costs one
+    // journal sync rather than one per item. It is rolled back if we
+    // return before committing.
+    SQLiteTransaction transaction(m_database);
+    transaction.begin();
+
     // If the clear flag is set, then we clear all items out before we write any new ones in.
     if (clearItems) {
         SQLiteStatement clear(m_database, "DELETE FROM ItemTable");
@@ -278,6 +323,8 @@ void StorageAreaSync::sync(bool clearItems, const HashMap<String, String>& items
 
         query.reset();
     }
+
+    transaction.commit();
 }
 
 void StorageAreaSync::performSync()
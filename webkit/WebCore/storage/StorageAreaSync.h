@@ -24,6 +24,10 @@ namespace WebCore {
 
         void scheduleFinalSync();
         void blockUntilImportComplete();
+        // Waits only until the import has read key or finished. Returns true
+        // with the stored value in the first case, and false once the
+        // storage area holds every item.
+        bool waitForImportedItem(const String& key, String& value);
 
         void scheduleItemForSync(const String& key, const String& value);
         void scheduleClear();
@@ -65,6 +69,8 @@ namespace WebCore {
         mutable Mutex m_importLock;
         mutable ThreadCondition m_importCondition;
         mutable bool m_importComplete;
+        // The rows read so far while the import runs
+        HashMap<String, String> m_importedItems;
         void markImported();
     };
 
@@ -13,9 +13,7 @@ PassRefPtr<StorageMap> StorageMap::create(unsigned quota)
 }
 
 StorageMap::StorageMap(unsigned quota)
-    : m_iterator(m_map.end())
-    , m_iteratorIndex(UINT_MAX)
-    , m_quotaSize(quota)  // quota measured in bytes
+    : m_quotaSize(quota)  // quota measured in bytes
     , m_currentLength(0)
 {
 }
@@ -24,37 +22,21 @@ PassRefPtr<StorageMap> StorageMap::copy()
 {
     RefPtr<StorageMap> newMap = create(m_quotaSize);
     newMap->m_map = m_map;
+    newMap->m_keys = m_keys;
     newMap->m_currentLength = m_currentLength;
     return newMap.release();
 }
 
-void StorageMap::invalidateIterator()
+void StorageMap::removeKeyAt(unsigned index)
 {
-    m_iterator = m_map.end();
-    m_iteratorIndex = UINT_MAX;
-}
-
-void StorageMap::setIteratorToIndex(unsigned index)
-{
-    // FIXME: Once we have bidirectional iterators for HashMap we can be more intelligent about this.
-    // The requested index will be closest to begin(), our current iterator, or end(), and we
-    // can take the shortest route.
-    // Until that mechanism is available, we'll always increment our iterator from begin() or current.
-
-    if (m_iteratorIndex == index)
-        return;
-
-    if (index < m_iteratorIndex) {
-        m_iteratorIndex = 0;
-        m_iterator = m_map.begin();
-        ASSERT(m_iterator != m_map.end());
-    }
-
-    while (m_iteratorIndex < index) {
-        ++m_iteratorIndex;
-        ++m_iterator;
-        ASSERT(m_iterator != m_map.end());
+    unsigned lastIndex = m_keys.size() - 1;
+    if (index != lastIndex) {
+        m_keys[index] = m_keys[lastIndex];
+        HashMap<String, Item>::iterator moved = m_map.find(m_keys[index]);
+        ASSERT(moved != m_map.end());
+        moved->second.index = index;
     }
+    m_keys.removeLast();
 }
 
 unsigned StorageMap::length() const
@@ -67,13 +49,12 @@ String StorageMap::key(unsigned index)
     if (index >= length())
         return String();
 
-    setIteratorToIndex(index);
-    return m_iterator->first;
+    return m_keys[index];
 }
 
 String StorageMap::getItem(const String& key) const
 {
-    return m_map.get(key);
+    return m_map.get(key).value;
 }
 
 PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& value, String& oldValue, bool& quotaException)
@@ -94,7 +75,8 @@ PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& valu
     bool overflow = newLength + value.length() < newLength;
     newLength += value.length();
 
-    oldValue = m_map.get(key);
+    HashMap<String, Item>::iterator it = m_map.find(key);
+    oldValue = it == m_map.end() ? String() : it->second.value;
     overflow |= newLength - oldValue.length() > newLength;
     newLength -= oldValue.length();
 
@@ -110,11 +92,12 @@ PassRefPtr<StorageMap> StorageMap::setItem(const String& key, const String& valu
     }
     m_currentLength = newLength;
 
-    pair<HashMap<String, String>::iterator, bool> addResult = m_map.add(key, value);
-    if (!addResult.second)
-        addResult.first->second = value;
-
-    invalidateIterator();
+    if (it != m_map.end())
+        it->second.value = value;
+    else {
+        m_map.set(key, Item(value, m_keys.size()));
+        m_keys.append(key);
+    }
 
     return 0;
 }
@@ -129,12 +112,18 @@ PassRefPtr<StorageMap> StorageMap::removeItem(const String& key, String& oldValu
         return newStorage.release();
     }
 
-    oldValue = m_map.take(key);
-    if (!oldValue.isNull()) {
-        invalidateIterator();
-        ASSERT(m_currentLength - key.length() <= m_currentLength);
-        m_currentLength -= key.length();
+    HashMap<String, Item>::iterator it = m_map.find(key);
+    if (it == m_map.end()) {
+        oldValue = String();
+        return 0;
     }
+
+    oldValue = it->second.value;
+    removeKeyAt(it->second.index);
+    m_map.remove(it);
+
+    ASSERT(m_currentLength - key.length() <= m_currentLength);
+    m_currentLength -= key.length();
     ASSERT(m_currentLength - oldValue.length() <= m_currentLength);
     m_currentLength -= oldValue.length();
 
@@ -150,8 +139,10 @@ void StorageMap::importItem(const String& key, const String& value)
 {
     // Be sure to copy the keys/values as items imported on a background thread are destined
     // to cross a thread boundary
-    pair<HashMap<String, String>::iterator, bool> result = m_map.add(key.threadsafeCopy(), value.threadsafeCopy());
+    String keyCopy = key.threadsafeCopy();
+    pair<HashMap<String, Item>::iterator, bool> result = m_map.add(keyCopy, Item(value.threadsafeCopy(), m_keys.size()));
     ASSERT(result.second);  // True if the key didn't exist previously.
+    m_keys.append(keyCopy);
 
     ASSERT(m_currentLength + key.length() >= m_currentLength);
     m_currentLength += key.length();
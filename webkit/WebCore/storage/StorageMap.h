@@ -11,6 +11,7 @@
 #include <wtf/HashMap.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
@@ -36,12 +37,22 @@ namespace WebCore {
     private:
         StorageMap(unsigned quota);
         PassRefPtr<StorageMap> copy();
-        void invalidateIterator();
-        void setIteratorToIndex(unsigned);
-
-        HashMap<String, String> m_map;
-        HashMap<String, String>::iterator m_iterator;
-        unsigned m_iteratorIndex;
+        void removeKeyAt(unsigned index);
+
+        struct Item {
+            Item() : index(0) { }
+            Item(const String& value, unsigned index) : value(value), index(index) { }
+
+            String value;
+            // Position of the item's key in m_keys
+            unsigned index;
+        };
+
+        HashMap<String, Item> m_map;
+        // The keys in the order key() returns them, so that scripts walking
+        // the storage by index don't walk the map for every key. Removing a
+        // key moves the last one into its place.
+        Vector<String> m_keys;
 
         unsigned m_quotaSize;  // Measured in bytes.
         unsigned m_currentLength;  // Measured in UChars.
@@ -28,6 +28,8 @@ WebSocketChannel::WebSocketChannel(ScriptExecutionContext* context, WebSocketCha
     , m_client(client)
     , m_handshake(url, protocol, context)
     , m_buffer(0)
+    , m_bufferCapacity(0)
+    , m_bufferStart(0)
     , m_bufferSize(0)
 {
 }
@@ -110,16 +112,26 @@ void WebSocketChannel::didReceiveData(SocketStreamHandle* handle, const char* da
     LOG(Network, "WebSocketChannel %p didReceiveData %d", this, len);
     RefPtr<WebSocketChannel> protect(this); // The client can close the channel, potentially removing the last reference.
     ASSERT(handle == m_handle);
-    if (!appendToBuffer(data, len)) {
+    if (!m_client) {
         handle->close();
         return;
     }
-    if (!m_client) {
+    // Once connected, frames that arrive whole are parsed straight from the
+    // socket's data; only the start of a partial frame is kept.
+    if (!m_bufferSize && m_handshake.mode() == WebSocketHandshake::Connected) {
+        int processed = processFrames(data, len);
+        if (processed < 0 || processed == len)
+            return;
+        if (!appendToBuffer(data + processed, len - processed))
+            handle->close();
+        return;
+    }
+    if (!appendToBuffer(data, len)) {
         handle->close();
         return;
     }
     if (m_handshake.mode() == WebSocketHandshake::Incomplete) {
-        int headerLength = m_handshake.readServerHandshake(m_buffer, m_bufferSize);
+        int headerLength = m_handshake.readServerHandshake(m_buffer + m_bufferStart, m_bufferSize);
         if (headerLength <= 0)
             return;
         switch (m_handshake.mode()) {
@@ -143,16 +155,38 @@ void WebSocketChannel::didReceiveData(SocketStreamHandle* handle, const char* da
             return;
         }
         skipBuffer(headerLength);
-        if (!m_buffer)
+        if (!m_bufferSize)
             return;
         LOG(Network, "remaining in read buf %ul", m_bufferSize);
     }
     if (m_handshake.mode() != WebSocketHandshake::Connected)
         return;
 
-    const char* nextFrame = m_buffer;
-    const char* p = m_buffer;
-    const char* end = p + m_bufferSize;
+    int processed = processFrames(m_buffer + m_bufferStart, m_bufferSize);
+    if (processed > 0)
+        skipBuffer(processed);
+}
+
+void WebSocketChannel::didFail(SocketStreamHandle* handle, const SocketStreamError&)
+{
+    LOG(Network, "WebSocketChannel %p didFail", this);
+    ASSERT(handle == m_handle || !m_handle);
+    handle->close();
+}
+
+void WebSocketChannel::didReceiveAuthenticationChallenge(SocketStreamHandle*, const AuthenticationChallenge&)
+{
+}
+
+void WebSocketChannel::didCancelAuthenticationChallenge(SocketStreamHandle*, const AuthenticationChallenge&)
+{
+}
+
+int WebSocketChannel::processFrames(const char* data, int len)
+{
+    const char* nextFrame = data;
+    const char* p = data;
+    const char* end = p + len;
     while (p < end) {
         unsigned char frameByte = static_cast<unsigned char>(*p++);
         if ((frameByte & 0x80) == 0x80) {
@@ -160,8 +194,10 @@ void WebSocketChannel::didReceiveData(SocketStreamHandle* handle, const char* da
             while (p < end) {
                 if (length > std::numeric_limits<int>::max() / 128) {
                     LOG(Network, "frame length overflow %d", length);
-                    handle->close();
-                    return;
+                    // A message handler may have closed the channel already.
+                    if (m_handle)
+                        m_handle->close();
+                    return -1;
                 }
                 char msgByte = *p;
                 length = length * 128 + (msgByte & 0x7f);
@@ -169,50 +205,52 @@ void WebSocketChannel::didReceiveData(SocketStreamHandle* handle, const char* da
                 if (!(msgByte & 0x80))
                     break;
             }
-            if (p + length < end) {
+            if (length <= end - p) {
                 p += length;
                 nextFrame = p;
             } else
                 break;
         } else {
             const char* msgStart = p;
-            while (p < end && *p != '\xff')
-                ++p;
-            if (p < end && *p == '\xff') {
-                if (frameByte == 0x00)
-                    m_client->didReceiveMessage(String::fromUTF8(msgStart, p - msgStart));
-                ++p;
-                nextFrame = p;
-            }
+            p = static_cast<const char*>(memchr(p, '\xff', end - p));
+            if (!p)
+                break;
+            // The message is decoded straight out of the frame.
+            if (frameByte == 0x00 && m_client)
+                m_client->didReceiveMessage(String::fromUTF8(msgStart, p - msgStart));
+            ++p;
+            nextFrame = p;
         }
     }
-    skipBuffer(nextFrame - m_buffer);
-}
-
-void WebSocketChannel::didFail(SocketStreamHandle* handle, const SocketStreamError&)
-{
-    LOG(Network, "WebSocketChannel %p didFail", this);
-    ASSERT(handle == m_handle || !m_handle);
-    handle->close();
-}
-
-void WebSocketChannel::didReceiveAuthenticationChallenge(SocketStreamHandle*, const AuthenticationChallenge&)
-{
-}
-
-void WebSocketChannel::didCancelAuthenticationChallenge(SocketStreamHandle*, const AuthenticationChallenge&)
-{
+    return nextFrame - data;
 }
 
 bool WebSocketChannel::appendToBuffer(const char* data, int len)
 {
+    if (m_bufferStart + m_bufferSize + len <= m_bufferCapacity) {
+        memcpy(m_buffer + m_bufferStart + m_bufferSize, data, len);
+        m_bufferSize += len;
+        return true;
+    }
+    if (m_bufferSize + len <= m_bufferCapacity) {
+        memmove(m_buffer, m_buffer + m_bufferStart, m_bufferSize);
+        m_bufferStart = 0;
+        memcpy(m_buffer + m_bufferSize, data, len);
+        m_bufferSize += len;
+        return true;
+    }
+    // Grow geometrically so that a large frame arriving a packet at a time
+    // isn't copied again for every packet.
+    int capacity = std::max(m_bufferSize + len, m_bufferCapacity * 2);
     char* newBuffer = 0;
-    if (tryFastMalloc(m_bufferSize + len).getValue(newBuffer)) {
+    if (tryFastMalloc(capacity).getValue(newBuffer)) {
         if (m_buffer)
-            memcpy(newBuffer, m_buffer, m_bufferSize);
+            memcpy(newBuffer, m_buffer + m_bufferStart, m_bufferSize);
         memcpy(newBuffer + m_bufferSize, data, len);
         fastFree(m_buffer);
         m_buffer = newBuffer;
+        m_bufferCapacity = capacity;
+        m_bufferStart = 0;
         m_bufferSize += len;
         return true;
     }
@@ -227,9 +265,11 @@ void WebSocketChannel::skipBuffer(int len)
     if (!m_bufferSize) {
         fastFree(m_buffer);
         m_buffer = 0;
+        m_bufferCapacity = 0;
+        m_bufferStart = 0;
         return;
     }
-    memmove(m_buffer, m_buffer + len, m_bufferSize);
+    m_bufferStart += len;
 }
 
 }  // namespace WebCore
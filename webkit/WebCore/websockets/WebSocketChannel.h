@@ -46,6 +46,9 @@ namespace WebCore {
     private:
         WebSocketChannel(ScriptExecutionContext*, WebSocketChannelClient*, const KURL&, const String& protocol);
 
+        // Dispatches the complete frames at the start of data, and returns
+        // how many bytes they took, or -1 if the connection was closed.
+        int processFrames(const char* data, int len);
         bool appendToBuffer(const char* data, int len);
         void skipBuffer(int len);
 
@@ -53,7 +56,10 @@ namespace WebCore {
         WebSocketChannelClient* m_client;
         WebSocketHandshake m_handshake;
         RefPtr<SocketStreamHandle> m_handle;
+        // Unprocessed data is the m_bufferSize bytes at m_bufferStart.
         char* m_buffer;
+        int m_bufferCapacity;
+        int m_bufferStart;
         int m_bufferSize;
     };
 
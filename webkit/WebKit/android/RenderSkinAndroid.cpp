@@ -8,7 +8,11 @@
 #include "RenderSkinCombo.h"
 #include "RenderSkinMediaButton.h"
 #include "RenderSkinRadio.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
 #include "SkImageDecoder.h"
+#include "SkNinePatch.h"
+#include "SkRect.h"
 
 #include "utils/AssetManager.h"
 #include "utils/Asset.h"
@@ -48,4 +52,57 @@ bool RenderSkinAndroid::DecodeBitmap(android::AssetManager* am, const char* file
     return success;
 }
 
+// Enough for the controls of a long form in a few states. Each entry is at
+// most kMaxStretchedArea * 4 bytes.
+static const int kStretchedCacheSize = 16;
+static const int kMaxStretchedArea = 128 * 128;
+
+struct StretchedEntry {
+    const SkBitmap* asset;
+    bool isNinePatch;
+    SkIRect margin;
+    SkBitmap bitmap;
+};
+
+static StretchedEntry gStretched[kStretchedCacheSize];
+// The entry to replace next; entries are replaced in turn
+static int gNextStretched;
+
+const SkBitmap* RenderSkinAndroid::StretchedBitmap(const SkBitmap& asset, const SkIRect* margin, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width * height > kMaxStretchedArea)
+        return 0;
+
+    for (int i = 0; i < kStretchedCacheSize; i++) {
+        const StretchedEntry& entry = gStretched[i];
+        if (entry.asset == &asset && entry.bitmap.width() == width && entry.bitmap.height() == height
+                && entry.isNinePatch == !!margin && (!margin || entry.margin == *margin))
+            return &entry.bitmap;
+    }
+
+    StretchedEntry& entry = gStretched[gNextStretched];
+    gNextStretched = (gNextStretched + 1) % kStretchedCacheSize;
+    entry.asset = 0;
+    entry.bitmap.reset();
+    entry.bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    if (!entry.bitmap.allocPixels())
+        return 0;
+    entry.bitmap.eraseARGB(0, 0, 0, 0);
+
+    SkCanvas canvas(entry.bitmap);
+    SkRect bounds;
+    bounds.set(0, 0, SkIntToScalar(width), SkIntToScalar(height));
+    if (margin) {
+        SkNinePatch::DrawNine(&canvas, bounds, asset, *margin);
+        entry.margin = *margin;
+    } else {
+        SkPaint paint;
+        paint.setFlags(SkPaint::kFilterBitmap_Flag);
+        canvas.drawBitmapRect(asset, 0, bounds, &paint);
+    }
+    entry.asset = &asset;
+    entry.isNinePatch = margin != 0;
+    return &entry.bitmap;
+}
+
 } // namespace WebCore
@@ -10,6 +10,7 @@ namespace android {
 }
 
 class SkBitmap;
+struct SkIRect;
 
 namespace WebCore {
 class Node;
@@ -42,6 +43,14 @@ public:
      */
     static bool DecodeBitmap(android::AssetManager* am, const char* fileName, SkBitmap* bitmap);
 
+    /* StretchedBitmap returns the asset drawn at width by height, as a nine-patch with the
+     * given margin or scaled with filtering if margin is 0. Results are kept for the
+     * assets and sizes drawn most recently, so that a page full of identical controls
+     * records a blit for each one instead of a stretch. It returns 0 if the size is too
+     * large to keep, in which case the caller should draw the asset itself.
+     */
+    static const SkBitmap* StretchedBitmap(const SkBitmap& asset, const SkIRect* margin, int width, int height);
+
     /*  draw() tells the skin to draw itself, and returns true if the skin needs
      *  a redraw to animations, false otherwise
      */
@@ -90,6 +90,10 @@ void RenderSkinButton::Draw(SkCanvas* canvas, const IntRect& r, RenderSkinAndroi
         margin.set(10, 9, 10, 14);
     }
     // Draw to the canvas.
+    if (const SkBitmap* stretched = RenderSkinAndroid::StretchedBitmap(gButton[newState], &margin, r.width(), r.height())) {
+        canvas->drawBitmap(*stretched, bounds.fLeft, bounds.fTop);
+        return;
+    }
     SkNinePatch::DrawNine(canvas, bounds, gButton[newState], margin);
 }
 
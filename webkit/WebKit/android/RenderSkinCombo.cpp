@@ -119,10 +119,14 @@ bool RenderSkinCombo::Draw(SkCanvas* canvas, Node* element, int x, int y, int wi
         bounds.fBottom -= SkIntToScalar(style->borderBottomWidth());
         drawBorder = NoBorder;
     }
-    if (oldHeight > stretchMargin[resolution] + stretchTop[resolution] + 1)
-        SkNinePatch::DrawNine(canvas, bounds, bitmaps[state][drawBorder], margin[resolution][drawBorder]);
+    const SkIRect& patchMargin = oldHeight > stretchMargin[resolution] + stretchTop[resolution] + 1
+        ? margin[resolution][drawBorder] : margin_small[resolution][drawBorder];
+    const SkBitmap& asset = bitmaps[state][drawBorder];
+    if (const SkBitmap* stretched = RenderSkinAndroid::StretchedBitmap(asset, &patchMargin,
+            SkScalarRound(bounds.width()), SkScalarRound(bounds.height())))
+        canvas->drawBitmap(*stretched, bounds.fLeft, bounds.fTop);
     else
-    	SkNinePatch::DrawNine(canvas, bounds, bitmaps[state][drawBorder], margin_small[resolution][drawBorder]);
+        SkNinePatch::DrawNine(canvas, bounds, asset, patchMargin);
     return false;
 }
 
@@ -60,17 +60,23 @@ void RenderSkinRadio::Draw(SkCanvas* canvas, Node* element, const IntRect& ir,
     }
     SkScalar width = r.width();
     SkScalar scale = SkScalarDiv(width, SIZE);
-    saveScaleCount = canvas->save();
-    canvas->translate(r.fLeft, r.fTop);
-    canvas->scale(scale, scale);
 
     bool checked = false;
     if (InputElement* inputElement = toInputElement(static_cast<Element*>(element))) {
         checked = inputElement->isChecked();
     }
 
-    canvas->drawBitmap(s_bitmap[checked + 2*(!isCheckBox)],
-            0, 0, &paint);
+    const SkBitmap& asset = s_bitmap[checked + 2*(!isCheckBox)];
+    if (const SkBitmap* scaled = RenderSkinAndroid::StretchedBitmap(asset, 0, ir.width(),
+            SkScalarRound(SkScalarMul(SkIntToScalar(asset.height()), scale)))) {
+        canvas->drawBitmap(*scaled, r.fLeft, r.fTop, &paint);
+        return;
+    }
+
+    saveScaleCount = canvas->save();
+    canvas->translate(r.fLeft, r.fTop);
+    canvas->scale(scale, scale);
+    canvas->drawBitmap(asset, 0, 0, &paint);
     canvas->restoreToCount(saveScaleCount);
 }
 
@@ -7,13 +7,18 @@
 
 #include "CString.h"
 #include "Cache.h"
+#include "DOMTimer.h"
 #include "KURL.h"
 #include "Node.h"
+#include "PlatformString.h"
+#include "StringBuilder.h"
 #include "SystemTime.h"
 #include "StyleBase.h"
 #include <utils/Log.h>
 #include <wtf/CurrentTime.h>
+#include <wtf/Vector.h>
 
+#include <pthread.h>
 #include <sys/time.h>
 #include <time.h>
 
@@ -114,6 +119,7 @@ static const char* timeCounterNames[] = {
     "Java callback (frame bridge)",
     "parsing (may include calcStyle or Java callback)", 
     "layout", 
+    "plugin timers",
     "native 1 (frame bridge)",
     "native 2 (resource load)", 
     "native 3 (shared timer)", 
@@ -123,6 +129,116 @@ static const char* timeCounterNames[] = {
     "draw content (webview ui)",
 };
 
+// Histogram buckets are powers of two: bucket 0 holds 0ms samples, bucket n
+// holds [2^(n-1), 2^n) ms and the last bucket collects everything longer.
+static const int kHistogramBuckets = 17;
+static uint32_t sHistogram[TimeCounter::TotalTimeCounterCount][kHistogramBuckets];
+static uint32_t sMaxTime[TimeCounter::TotalTimeCounterCount];
+
+struct CounterSummary {
+    uint32_t time;
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t max;
+};
+
+struct PageReport {
+    String url;
+    int totalTime;
+    int threadTime;
+    size_t arenaSize;
+    size_t arenaLiveSize;
+    CounterSummary counters[TimeCounter::TotalTimeCounterCount];
+};
+
+// completed loads are appended on the WebCore thread but snapshot() is called
+// from the UI thread
+static const size_t kMaxPageReports = 8;
+static Vector<PageReport>* sPageReports;
+static pthread_mutex_t sPageReportsLock = PTHREAD_MUTEX_INITIALIZER;
+
+void TimeCounter::addSample(enum Type type, uint32_t elapsed)
+{
+    int bucket = 0;
+    for (uint32_t v = elapsed; v && bucket < kHistogramBuckets - 1; v >>= 1)
+        bucket++;
+    sHistogram[type][bucket]++;
+    if (elapsed > sMaxTime[type])
+        sMaxTime[type] = elapsed;
+}
+
+// returns the upper bound of the bucket holding the pct'th percentile sample
+static uint32_t percentile(TimeCounter::Type type, uint32_t samples, int pct)
+{
+    if (!samples)
+        return 0;
+    uint32_t target = (samples * pct + 99) / 100;
+    uint32_t seen = 0;
+    for (int bucket = 0; bucket < kHistogramBuckets; bucket++) {
+        seen += sHistogram[type][bucket];
+        if (seen >= target) {
+            uint32_t upper = bucket ? (1u << bucket) - 1 : 0;
+            return upper < sMaxTime[type] ? upper : sMaxTime[type];
+        }
+    }
+    return sMaxTime[type];
+}
+
+static void summarize(TimeCounter::Type type, uint32_t time, uint32_t count,
+    CounterSummary* summary)
+{
+    uint32_t samples = 0;
+    for (int bucket = 0; bucket < kHistogramBuckets; bucket++)
+        samples += sHistogram[type][bucket];
+    summary->time = time;
+    summary->count = count;
+    summary->p50 = percentile(type, samples, 50);
+    summary->p95 = percentile(type, samples, 95);
+    summary->max = sMaxTime[type];
+}
+
+static void appendJSONString(StringBuilder& json, const String& string)
+{
+    json.append('"');
+    for (unsigned i = 0; i < string.length(); i++) {
+        UChar c = string[i];
+        if (c == '"' || c == '\\') {
+            json.append('\\');
+            json.append(c);
+        } else if (c < 0x20)
+            json.append(String::format("\\u%04x", c));
+        else
+            json.append(c);
+    }
+    json.append('"');
+}
+
+static void appendPageReport(StringBuilder& json, const PageReport& page,
+    bool loading)
+{
+    json.append("{\"url\":");
+    appendJSONString(json, page.url);
+    json.append(String::format(",\"loading\":%s,\"totalTime\":%d,"
+        "\"threadTime\":%d,\"arenaSize\":%u,\"arenaLiveSize\":%u,"
+        "\"counters\":[", loading ? "true" : "false", page.totalTime,
+        page.threadTime, page.arenaSize, page.arenaLiveSize));
+    bool first = true;
+    for (int type = 0; type < TimeCounter::TotalTimeCounterCount; type++) {
+        const CounterSummary& c = page.counters[type];
+        if (!c.time && !c.count)
+            continue;
+        if (!first)
+            json.append(',');
+        first = false;
+        json.append("{\"name\":");
+        appendJSONString(json, timeCounterNames[type]);
+        json.append(String::format(",\"time\":%u,\"count\":%u,\"p50\":%u,"
+            "\"p95\":%u,\"max\":%u}", c.time, c.count, c.p50, c.p95, c.max));
+    }
+    json.append("]}");
+}
+
 void TimeCounter::record(enum Type type, const char* functionName)
 {
     recordNoCounter(type, functionName);
@@ -134,28 +250,47 @@ void TimeCounter::recordNoCounter(enum Type type, const char* functionName)
     uint32_t time = sEndWebCoreThreadTime = getThreadMsec();
     uint32_t elapsed = time - sStartTime[type];
     sTotalTimeUsed[type] += elapsed;
+    addSample(type, elapsed);
     if (elapsed > 1000)
         LOGW("***** %s() used %d ms\n", functionName, elapsed);
 }
 
-void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize)
+void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize, size_t arenaLiveSize)
 {
     String urlString = url;
     int totalTime = static_cast<int>((currentTime() - sStartTotalTime) * 1000);
     int threadTime = getThreadMsec() - sStartThreadTime;
     LOGD("*-* Total load time: %d ms, thread time: %d ms for %s\n",
         totalTime, threadTime, urlString.utf8().data());
+    PageReport page;
+    page.url = urlString;
+    page.totalTime = totalTime;
+    page.threadTime = threadTime;
+    page.arenaSize = arenaSize;
+    page.arenaLiveSize = arenaLiveSize;
     for (Type type = (Type) 0; type < TotalTimeCounterCount; type 
             = (Type) (type + 1)) {
+        CounterSummary& summary = page.counters[type];
+        summarize(type, sTotalTimeUsed[type], sCounter[type], &summary);
         char scratch[256];
         int index = sprintf(scratch, "*-* Total %s time: %d ms", 
             timeCounterNames[type], sTotalTimeUsed[type]);
         if (sCounter[type] > 0)
-            sprintf(&scratch[index], " called %d times", sCounter[type]);
+            index += sprintf(&scratch[index], " called %d times", sCounter[type]);
+        if (summary.max > 0)
+            sprintf(&scratch[index], " (p50 %d p95 %d max %d ms)", summary.p50,
+                summary.p95, summary.max);
         LOGD("%s", scratch);
     }
+    pthread_mutex_lock(&sPageReportsLock);
+    if (!sPageReports)
+        sPageReports = new Vector<PageReport>;
+    if (sPageReports->size() >= kMaxPageReports)
+        sPageReports->remove(0);
+    sPageReports->append(page);
+    pthread_mutex_unlock(&sPageReportsLock);
     LOGD("Current cache has %d bytes live and %d bytes dead", live, dead);
-    LOGD("Current render arena takes %d bytes", arenaSize);
+    LOGD("Current render arena takes %d bytes, %d of them live", arenaSize, arenaLiveSize);
 #if USE(JSC)
     JSLock lock(false);
     Heap::Statistics jsHeapStatistics = JSDOMWindow::commonJSGlobalData()->heap.statistics();
@@ -164,6 +299,13 @@ void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize)
 #endif
     LOGD("Current CSS styles use %d bytes", StyleBase::reportStyleSize());
     LOGD("Current DOM nodes use %d bytes", WebCore::Node::reportDOMNodesSize());
+    Vector<DOMTimer::TimerSource> timerSources;
+    DOMTimer::takeTimerSources(timerSources, 5);
+    for (size_t i = 0; i < timerSources.size(); i++) {
+        const String& source = timerSources[i].first;
+        LOGD("*-* %d timers installed by %s", timerSources[i].second,
+            source.isEmpty() ? "unknown script" : source.utf8().data());
+    }
 }
 
 void TimeCounter::reportNow()
@@ -197,11 +339,41 @@ void TimeCounter::reportNow()
 void TimeCounter::reset() {
     bzero(sTotalTimeUsed, sizeof(sTotalTimeUsed));
     bzero(sCounter, sizeof(sCounter));
+    bzero(sHistogram, sizeof(sHistogram));
+    bzero(sMaxTime, sizeof(sMaxTime));
     LOGD("*-* Start browser instrument\n");
     sStartTotalTime = currentTime();
     sStartThreadTime = getThreadMsec();
 }
 
+String TimeCounter::snapshot()
+{
+    StringBuilder json;
+    json.append("{\"pages\":[");
+    pthread_mutex_lock(&sPageReportsLock);
+    if (sPageReports) {
+        for (size_t i = 0; i < sPageReports->size(); i++) {
+            appendPageReport(json, sPageReports->at(i), false);
+            json.append(',');
+        }
+    }
+    pthread_mutex_unlock(&sPageReportsLock);
+    // the counters accumulating since the last reset() belong to the page
+    // that is loading (or has loaded without a report yet)
+    PageReport current;
+    current.totalTime = static_cast<int>((currentTime() - sStartTotalTime) * 1000);
+    current.threadTime = getThreadMsec() - sStartThreadTime;
+    // the arena is only measured when a load completes
+    current.arenaSize = 0;
+    current.arenaLiveSize = 0;
+    for (Type type = (Type) 0; type < TotalTimeCounterCount; type
+            = (Type) (type + 1))
+        summarize(type, sTotalTimeUsed[type], sCounter[type], &current.counters[type]);
+    appendPageReport(json, current, true);
+    json.append("]}");
+    return json.toString();
+}
+
 void TimeCounter::start(enum Type type)
 {
     uint32_t time = getThreadMsec();
@@ -8,6 +8,7 @@
 namespace WebCore {
 
 class KURL;
+class String;
 
 }
 
@@ -30,6 +31,7 @@ public:
         JavaCallbackTimeCounter,
         ParsingTimeCounter,
         LayoutTimeCounter,
+        PluginTimerTimeCounter,
         // file base counters
         NativeCallbackTimeCounter,  // WebCoreFrameBridge.cpp
         ResourceTimeCounter,        // WebCoreResourceLoader.cpp
@@ -43,10 +45,17 @@ public:
 
     static void record(enum Type type, const char* functionName);
     static void recordNoCounter(enum Type type, const char* functionName);
-    static void report(const WebCore::KURL& , int live, int dead, size_t arenaSize);
+    static void report(const WebCore::KURL& , int live, int dead, size_t arenaSize, size_t arenaLiveSize);
     static void reportNow();
     static void reset();
     static void start(enum Type type);
+    // Each timed interval is also dropped into a per-counter histogram so
+    // that reports can show p50/p95/max alongside the running totals.
+    static void addSample(enum Type type, uint32_t elapsed);
+    // The last few completed page loads plus the one in progress, as JSON
+    static WebCore::String snapshot();
+    // milliseconds accumulated for type since the last reset()
+    static uint32_t totalTime(enum Type type) { return sTotalTimeUsed[type]; }
 private:
     static uint32_t sStartWebCoreThreadTime;
     static uint32_t sEndWebCoreThreadTime;
@@ -68,6 +77,7 @@ public:
         TimeCounter::sEndWebCoreThreadTime = time;
         TimeCounter::sTotalTimeUsed[m_type] += time - m_startTime;
         TimeCounter::sCounter[m_type]++;
+        TimeCounter::addSample(m_type, time - m_startTime);
     }
 private:
     TimeCounter::Type m_type;
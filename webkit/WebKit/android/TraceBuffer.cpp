@@ -0,0 +1,103 @@
+
+
+#define LOG_TAG "WebCore"
+
+#include "config.h"
+#include "TraceBuffer.h"
+
+#include <cutils/atomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/Log.h>
+
+namespace android {
+
+struct TraceEvent {
+    uint32_t time;      // microseconds, CLOCK_MONOTONIC
+    uint32_t id;
+    int32_t thread;
+    uint16_t type;
+    uint16_t begin;
+};
+
+// must be a power of two; 4096 events is a few seconds of a busy page
+static const uint32_t kTraceEvents = 4096;
+static TraceEvent sEvents[kTraceEvents];
+static volatile int32_t sNextEvent;
+static volatile int32_t sNextId;
+
+static const char* traceNames[] = {
+    "parse",
+    "calculate style",
+    "layout",
+    "record content",
+    "build nav",
+    "javascript",
+    "java callback",
+    "native callback",
+    "shared timer",
+    "split content",
+    "draw content",
+    "draw extras",
+    "composite layers",
+};
+
+uint32_t TraceBuffer::newId()
+{
+    uint32_t id;
+    do {
+        id = static_cast<uint32_t>(android_atomic_inc(&sNextId)) + 1;
+    } while (!id);
+    return id;
+}
+
+void TraceBuffer::add(enum Type type, bool begin, uint32_t id)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    // writers only race on the slot index; a dump that overlaps a write may
+    // see one torn event, which is acceptable for a diagnostic trace
+    uint32_t index = static_cast<uint32_t>(android_atomic_inc(&sNextEvent));
+    TraceEvent& event = sEvents[index & (kTraceEvents - 1)];
+    event.time = now.tv_sec * 1000000 + now.tv_nsec / 1000;
+    event.id = id;
+    event.thread = gettid();
+    event.type = type;
+    event.begin = begin;
+}
+
+bool TraceBuffer::dump(const char* path)
+{
+    // snapshot the ring first so that slow file I/O does not overlap with
+    // the events being written
+    uint32_t next = static_cast<uint32_t>(sNextEvent);
+    TraceEvent* events = new TraceEvent[kTraceEvents];
+    memcpy(events, sEvents, sizeof(sEvents));
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOGW("Unable to write trace to %s", path);
+        delete[] events;
+        return false;
+    }
+    uint32_t count = next < kTraceEvents ? next : kTraceEvents;
+    for (uint32_t i = next - count; i != next; i++) {
+        const TraceEvent& event = events[i & (kTraceEvents - 1)];
+        if (event.type >= TotalTraceCount)
+            continue;
+        // time, thread, begin or end, name and, if there is one, the id
+        fprintf(file, "%u.%06u %d %c %s", event.time / 1000000,
+            event.time % 1000000, event.thread, event.begin ? 'B' : 'E',
+            traceNames[event.type]);
+        if (event.id)
+            fprintf(file, " #%u", event.id);
+        fputc('\n', file);
+    }
+    fclose(file);
+    delete[] events;
+    return true;
+}
+
+}
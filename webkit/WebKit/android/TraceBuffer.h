@@ -0,0 +1,63 @@
+
+
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <stdint.h>
+
+namespace android {
+
+// A fixed-size ring of begin/end events for the WebCore and UI threads.
+// Unlike TimeCounter it is compiled into every build: recording an event
+// costs a clock read, one atomic increment and a 16 byte store, and the ring
+// is only read when it is dumped (on demand, or by the Java side after an
+// ANR). Events can carry an id from newId() to tie together the stages of
+// one piece of work on different threads, such as a content update from
+// recording to the UI drawing it.
+class TraceBuffer {
+public:
+    enum Type {
+        ParseTrace,
+        CalculateStyleTrace,
+        LayoutTrace,
+        RecordTrace,
+        BuildNavTrace,
+        JavaScriptTrace,
+        JavaCallbackTrace,      // WebCore calling out to Java
+        NativeCallbackTrace,    // Java calling in to WebCore
+        SharedTimerTrace,
+        SplitContentTrace,
+        DrawContentTrace,       // UI thread
+        DrawExtrasTrace,        // UI thread
+        CompositeLayersTrace,   // UI thread
+        TotalTraceCount
+    };
+
+    static void begin(enum Type type, uint32_t id = 0) { add(type, true, id); }
+    static void end(enum Type type, uint32_t id = 0) { add(type, false, id); }
+    // never returns 0, which marks events that aren't tied to anything
+    static uint32_t newId();
+    // Writes the buffered events, oldest first, as text to path. Returns
+    // false if the file could not be written.
+    static bool dump(const char* path);
+private:
+    static void add(enum Type type, bool begin, uint32_t id);
+};
+
+class TraceBufferAuto {
+public:
+    TraceBufferAuto(TraceBuffer::Type type, uint32_t id = 0)
+        : m_type(type), m_id(id) {
+        TraceBuffer::begin(type, id);
+    }
+    ~TraceBufferAuto() {
+        TraceBuffer::end(m_type, m_id);
+    }
+private:
+    TraceBuffer::Type m_type;
+    uint32_t m_id;
+};
+
+}
+
+#endif
@@ -788,11 +788,18 @@ void FrameLoaderClientAndroid::saveViewStateToItem(HistoryItem* item) {
     // store the current scale (only) for the top frame
     if (!m_frame->tree()->parent()) {
         WebViewCore* webViewCore = WebViewCore::getWebViewCore(m_frame->view());
-        bridge->setScale((int)(webViewCore->scale() * 100));
-        bridge->setScreenWidthScale((int)(webViewCore->screenWidthScale() * 100));
+        int scale = (int)(webViewCore->scale() * 100);
+        int screenWidthScale = (int)(webViewCore->screenWidthScale() * 100);
+        // The scales are the only state set here. Everything else notifies
+        // when it is set on the item, so don't flatten the whole tree again
+        // if they have not changed.
+        if (bridge->scale() == scale
+                && bridge->screenWidthScale() == screenWidthScale)
+            return;
+        bridge->setScale(scale);
+        bridge->setScreenWidthScale(screenWidthScale);
+        WebCore::notifyHistoryItemChanged(item);
     }
-
-    WebCore::notifyHistoryItemChanged(item);
 }
 
 void FrameLoaderClientAndroid::restoreViewState() {
@@ -857,6 +864,22 @@ String FrameLoaderClientAndroid::userAgent(const KURL& u) {
     return m_webFrame->userAgentForURL(&u);
 }
 
+// The main frame's content is about to go; keep a picture of it for the
+// history item being left, in case that page has to load again when it is
+// returned to. Reloads and redirects don't leave the item.
+static void saveHistorySnapshot(Frame* frame, WebViewCore* webViewCore) {
+    if (frame->tree()->parent())
+        return;
+    FrameLoadType loadType = frame->loader()->loadType();
+    if (loadType != FrameLoadTypeStandard && !isBackForwardLoadType(loadType))
+        return;
+    HistoryItem* item = frame->loader()->history()->previousItem();
+    // previousItem is only updated for loads that add or move in history
+    if (!item || !frame->document() || item->url() != frame->document()->url())
+        return;
+    webViewCore->saveHistorySnapshot(item);
+}
+
 void FrameLoaderClientAndroid::savePlatformDataToCachedFrame(WebCore::CachedFrame* cachedFrame) {
     CachedFramePlatformDataAndroid* platformData = new CachedFramePlatformDataAndroid(m_frame->settings());
     cachedFrame->setCachedFramePlatformData(platformData);
@@ -867,6 +890,7 @@ void FrameLoaderClientAndroid::transitionToCommittedFromCachedFrame(WebCore::Cac
 #ifdef ANDROID_META_SUPPORT
    platformData->restoreMetadata(m_frame->settings());
 #endif
+   saveHistorySnapshot(m_frame, WebViewCore::getWebViewCore(m_frame->view()));
    m_webFrame->transitionToCommitted(m_frame);
 }
 
@@ -884,6 +908,7 @@ void FrameLoaderClientAndroid::transitionToCommittedForNewPage() {
     // has a 1:1 FrameView and WebFrameView.
     WebViewCore* webViewCore = WebViewCore::getWebViewCore(m_frame->view());
     Retain(webViewCore);
+    saveHistorySnapshot(m_frame, webViewCore);
 
     // Save the old WebFrameView's bounds and apply them to the new WebFrameView
     WebFrameView* oldWebFrameView = static_cast<WebFrameView*> (m_frame->view()->platformWidget());
@@ -904,6 +929,12 @@ void FrameLoaderClientAndroid::transitionToCommittedForNewPage() {
     Release(webViewCore);
 
     m_webFrame->transitionToCommitted(m_frame);
+
+    // Going back or forward to a page that isn't in the page cache loads it
+    // again; show what it looked like until it draws.
+    if (!m_frame->tree()->parent() && isBackForwardLoadType(m_frame->loader()->loadType()))
+        WebViewCore::getWebViewCore(m_frame->view())->restoreHistorySnapshot(
+            m_frame->loader()->history()->currentItem());
 }
 
 bool FrameLoaderClientAndroid::canCachePage() const {
@@ -5,7 +5,14 @@
 
 #if ENABLE(VIDEO)
 
+#include "CachedImage.h"
+#include "CachedResourceClient.h"
+#include "CachedResourceHandle.h"
+#include "DocLoader.h"
+#include "Document.h"
+#include "FrameView.h"
 #include "GraphicsContext.h"
+#include "HTMLMediaElement.h"
 #include "SkiaUtils.h"
 #include "WebCoreJni.h"
 #include "WebViewCore.h"
@@ -14,6 +21,8 @@
 #include <JNIHelp.h>
 #include <JNIUtility.h>
 #include <SkBitmap.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/Vector.h>
 
 using namespace android;
 
@@ -38,18 +47,66 @@ struct MediaPlayerPrivate::JavaGlue
     jmethodID m_loadPoster;
 };
 
+// Each Java player holds a decoder and its buffers, so pages with many
+// media elements only get a few at a time.
+static const size_t maxJavaPlayers = 4;
+
+// The players that have a Java player, least recently used first
+static Vector<MediaPlayerPrivate*>& javaPlayers()
+{
+    DEFINE_STATIC_LOCAL(Vector<MediaPlayerPrivate*>, players, ());
+    return players;
+}
+
 MediaPlayerPrivate::~MediaPlayerPrivate()
 {
-    if (m_glue->m_javaProxy) {
-        JNIEnv* env = JSC::Bindings::getJNIEnv();
-        if (env) {
-            env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_teardown);
-            env->DeleteGlobalRef(m_glue->m_javaProxy);
-        }
-    }
+    releaseJavaPlayer();
     delete m_glue;
 }
 
+void MediaPlayerPrivate::didCreateJavaPlayer()
+{
+    Vector<MediaPlayerPrivate*>& players = javaPlayers();
+    players.append(this);
+    // The new player is last, so it is never released here.
+    size_t index = 0;
+    while (players.size() > maxJavaPlayers && index < players.size() - 1) {
+        if (players[index]->m_paused)
+            players[index]->releaseJavaPlayer();
+        else
+            index++;
+    }
+}
+
+void MediaPlayerPrivate::didUseJavaPlayer()
+{
+    Vector<MediaPlayerPrivate*>& players = javaPlayers();
+    size_t index = players.find(this);
+    if (index == notFound)
+        return;
+    players.remove(index);
+    players.append(this);
+}
+
+void MediaPlayerPrivate::releaseJavaPlayer()
+{
+    if (!m_glue || !m_glue->m_javaProxy)
+        return;
+
+    size_t index = javaPlayers().find(this);
+    if (index != notFound)
+        javaPlayers().remove(index);
+
+    JNIEnv* env = JSC::Bindings::getJNIEnv();
+    if (env) {
+        env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_teardown);
+        env->DeleteGlobalRef(m_glue->m_javaProxy);
+    }
+    m_glue->m_javaProxy = 0;
+    // Playing again starts over, like after onPaused().
+    onPaused();
+}
+
 void MediaPlayerPrivate::registerMediaEngine(MediaEngineRegistrar registrar)
 {
     registrar(create, getSupportedTypes, supportsType);
@@ -66,13 +123,6 @@ void MediaPlayerPrivate::pause()
     checkException(env);
 }
 
-void MediaPlayerPrivate::setVisible(bool visible)
-{
-    m_isVisible = visible;
-    if (m_isVisible)
-        createJavaPlayerIfNeeded();
-}
-
 void MediaPlayerPrivate::seek(float time)
 {
     JNIEnv* env = JSC::Bindings::getJNIEnv();
@@ -118,7 +168,8 @@ MediaPlayerPrivate::MediaPlayerPrivate(MediaPlayer* player)
     m_poster(0),
     m_naturalSize(100, 100),
     m_naturalSizeUnknown(true),
-    m_isVisible(false)
+    m_isVisible(false),
+    m_autobuffer(false)
 {
 }
 
@@ -145,15 +196,37 @@ void MediaPlayerPrivate::onTimeupdate(int position) {
     m_player->timeChanged();
 }
 
-class MediaPlayerVideoPrivate : public MediaPlayerPrivate {
+// Copied from the first poster the Java side supplies for a video without
+// one, so that other such videos don't each need a Java player for it
+static SkBitmap* gDefaultPoster;
+
+// Fits a poster into the target rect: only ever downscaled, with its
+// natural aspect ratio, and centered.
+static IntRect posterRect(const IntSize& posterSize, const IntRect& r)
+{
+    float originalRatio = static_cast<float>(posterSize.width()) / static_cast<float>(posterSize.height());
+    int posterWidth = r.width() > posterSize.width() ? posterSize.width() : r.width();
+    int posterHeight = posterWidth / originalRatio;
+    int posterX = ((r.width() - posterWidth) / 2) + r.x();
+    int posterY = ((r.height() - posterHeight) / 2) + r.y();
+    return IntRect(posterX, posterY, posterWidth, posterHeight);
+}
+
+class MediaPlayerVideoPrivate : public MediaPlayerPrivate, public CachedResourceClient {
 public:
     void load(const String& url) { m_url = url; }
     void play() {
         JNIEnv* env = JSC::Bindings::getJNIEnv();
-        if (!env || !m_url.length() || !m_glue->m_javaProxy)
+        if (!env || !m_url.length())
+            return;
+
+        createJavaPlayerIfNeeded();
+
+        if (!m_glue->m_javaProxy)
             return;
 
         m_paused = false;
+        didUseJavaPlayer();
         jstring jUrl = env->NewString((unsigned short *)m_url.characters(), m_url.length());
         env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_play, jUrl);
         env->DeleteLocalRef(jUrl);
@@ -161,15 +234,33 @@ public:
         checkException(env);
     }
     bool canLoadPoster() const { return true; }
+    // The poster goes through the memory cache like any other image, so it
+    // is loaded and decoded once for the element and the player.
     void setPoster(const String& url) {
+        if (url == m_posterUrl)
+            return;
         m_posterUrl = url;
-        JNIEnv* env = JSC::Bindings::getJNIEnv();
-        if (!env || !m_glue->m_javaProxy || !m_posterUrl.length())
+        if (m_posterImage) {
+            m_posterImage->removeClient(this);
+            m_posterImage = 0;
+        }
+        if (!m_posterUrl.length())
             return;
-        // Send the poster
-        jstring jUrl = env->NewString((unsigned short *)m_posterUrl.characters(), m_posterUrl.length());
-        env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_loadPoster, jUrl);
-        env->DeleteLocalRef(jUrl);
+        Document* document = static_cast<HTMLMediaElement*>(m_player->mediaPlayerClient())->document();
+        CachedImage* image = document ? document->docLoader()->requestImage(m_posterUrl) : 0;
+        if (!image)
+            return;
+        m_posterImage = image;
+        image->addClient(this);
+    }
+    void setVisible(bool visible) {
+        m_isVisible = visible;
+        if (!m_isVisible || m_posterUrl.length())
+            return;
+        if (gDefaultPoster)
+            m_poster = gDefaultPoster;
+        else
+            createJavaPlayerIfNeeded();
     }
     void paint(GraphicsContext* ctxt, const IntRect& r) {
         if (ctxt->paintingDisabled())
@@ -178,35 +269,50 @@ public:
         if (!m_isVisible)
             return;
 
+        if (m_posterImage) {
+            if (!m_posterImage->canRender(1.0f))
+                return;
+            IntRect targetRect = posterRect(m_posterImage->imageSize(1.0f), r);
+            ctxt->drawImage(m_posterImage->image(), DeviceColorSpace, targetRect);
+            return;
+        }
+
         if (!m_poster || (!m_poster->getPixels() && !m_poster->pixelRef()))
             return;
 
         SkCanvas*   canvas = ctxt->platformContext()->mCanvas;
-        // We paint with the following rules in mind:
-        // - only downscale the poster, never upscale
-        // - maintain the natural aspect ratio of the poster
-        // - the poster should be centered in the target rect
-        float originalRatio = static_cast<float>(m_poster->width()) / static_cast<float>(m_poster->height());
-        int posterWidth = r.width() > m_poster->width() ? m_poster->width() : r.width();
-        int posterHeight = posterWidth / originalRatio;
-        int posterX = ((r.width() - posterWidth) / 2) + r.x();
-        int posterY = ((r.height() - posterHeight) / 2) + r.y();
-        IntRect targetRect(posterX, posterY, posterWidth, posterHeight);
+        IntRect targetRect = posterRect(IntSize(m_poster->width(), m_poster->height()), r);
         canvas->drawBitmapRect(*m_poster, 0, targetRect, 0);
     }
 
+    // CachedResourceClient
+    virtual void imageChanged(CachedImage* image, const IntRect*) {
+        if (image != m_posterImage.get())
+            return;
+        if (image->canRender(1.0f))
+            posterSizeKnown(image->imageSize(1.0f));
+        m_player->repaint();
+    }
+    virtual void notifyFinished(CachedResource* resource) {
+        if (resource == m_posterImage.get())
+            imageChanged(m_posterImage.get(), 0);
+    }
+
+    // Only the default poster comes from the Java side.
     void onPosterFetched(SkBitmap* poster) {
-        m_poster = poster;
-        if (m_naturalSizeUnknown) {
-            // We had to fake the size at startup, or else our paint
-            // method would not be called. If we haven't yet received
-            // the onPrepared event, update the intrinsic size to the size
-            // of the poster. That will be overriden when onPrepare comes.
-            // In case of an error, we should report the poster size, rather
-            // than our initial fake value.
-            m_naturalSize = IntSize(poster->width(), poster->height());
-            m_player->sizeChanged();
+        if (!gDefaultPoster) {
+            SkBitmap* copy = new SkBitmap;
+            if (!poster->copyTo(copy, poster->config())) {
+                delete copy;
+                return;
+            }
+            gDefaultPoster = copy;
         }
+        if (m_posterUrl.length())
+            return;
+        m_poster = gDefaultPoster;
+        posterSizeKnown(IntSize(m_poster->width(), m_poster->height()));
+        m_player->repaint();
     }
 
     void onPrepared(int duration, int width, int height) {
@@ -245,6 +351,11 @@ public:
         checkException(env);
     }
 
+    ~MediaPlayerVideoPrivate() {
+        if (m_posterImage)
+            m_posterImage->removeClient(this);
+    }
+
     void createJavaPlayerIfNeeded() {
         // Check if we have been already created.
         if (m_glue->m_javaProxy)
@@ -262,53 +373,73 @@ public:
         jobject obj = NULL;
 
         FrameView* frameView = m_player->frameView();
-        if (!frameView)
+        if (!frameView) {
+            env->DeleteLocalRef(clazz);
             return;
+        }
         WebViewCore* webViewCore =  WebViewCore::getWebViewCore(frameView);
         ASSERT(webViewCore);
 
         // Get the HTML5VideoViewProxy instance
         obj = env->CallStaticObjectMethod(clazz, m_glue->m_getInstance, webViewCore->getJavaObject().get(), this);
         m_glue->m_javaProxy = env->NewGlobalRef(obj);
-        // Send the poster
-        jstring jUrl = 0;
-        if (m_posterUrl.length())
-            jUrl = env->NewString((unsigned short *)m_posterUrl.characters(), m_posterUrl.length());
-        // Sending a NULL jUrl allows the Java side to try to load the default poster.
-        env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_loadPoster, jUrl);
-        if (jUrl)
-            env->DeleteLocalRef(jUrl);
+        // Sending a NULL url makes the Java side load the default poster,
+        // which only videos without a poster of their own use.
+        if (!m_posterUrl.length() && !gDefaultPoster)
+            env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_loadPoster, static_cast<jstring>(0));
 
         // Clean up.
         if (obj)
             env->DeleteLocalRef(obj);
         env->DeleteLocalRef(clazz);
         checkException(env);
+        if (m_glue->m_javaProxy)
+            didCreateJavaPlayer();
     }
 
     float maxTimeSeekable() const {
         return m_duration;
     }
+
+private:
+    void posterSizeKnown(const IntSize& size) {
+        // We had to fake the size at startup, or else our paint
+        // method would not be called. If we haven't yet received
+        // the onPrepared event, update the intrinsic size to the size
+        // of the poster. That will be overriden when onPrepare comes.
+        // In case of an error, we should report the poster size, rather
+        // than our initial fake value.
+        if (!m_naturalSizeUnknown || size == m_naturalSize)
+            return;
+        m_naturalSize = size;
+        m_player->sizeChanged();
+    }
+
+    CachedResourceHandle<CachedImage> m_posterImage;
 };
 
 class MediaPlayerAudioPrivate : public MediaPlayerPrivate {
 public:
     void load(const String& url) {
         m_url = url;
-        JNIEnv* env = JSC::Bindings::getJNIEnv();
-        if (!env || !m_url.length())
+        if (!m_url.length())
             return;
 
-        createJavaPlayerIfNeeded();
-
-        if (!m_glue->m_javaProxy)
+        if (m_autobuffer) {
+            startLoading();
             return;
+        }
 
-        jstring jUrl = env->NewString((unsigned short *)m_url.characters(), m_url.length());
-        // start loading the data asynchronously
-        env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_setDataSource, jUrl);
-        env->DeleteLocalRef(jUrl);
-        checkException(env);
+        // Without autobuffer nothing is fetched until play(), so the
+        // element goes idle and fires suspend.
+        m_networkState = MediaPlayer::Idle;
+        m_player->networkStateChanged();
+    }
+
+    void setAutobuffer(bool autobuffer) {
+        MediaPlayerPrivate::setAutobuffer(autobuffer);
+        if (m_autobuffer && m_url.length())
+            startLoading();
     }
 
     void play() {
@@ -316,12 +447,11 @@ public:
         if (!env || !m_url.length())
             return;
 
-        createJavaPlayerIfNeeded();
-
-        if (!m_glue->m_javaProxy)
+        if (!startLoading())
             return;
 
         m_paused = false;
+        didUseJavaPlayer();
         env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_play);
         checkException(env);
     }
@@ -390,6 +520,36 @@ public:
             env->DeleteLocalRef(obj);
         env->DeleteLocalRef(clazz);
         checkException(env);
+        if (m_glue->m_javaProxy)
+            didCreateJavaPlayer();
+    }
+
+    // Creates the Java player, if there isn't one, and hands it the url,
+    // which starts loading the data asynchronously. Returns false if there
+    // is no Java player.
+    bool startLoading() {
+        if (m_glue->m_javaProxy)
+            return true;
+
+        JNIEnv* env = JSC::Bindings::getJNIEnv();
+        if (!env)
+            return false;
+
+        createJavaPlayerIfNeeded();
+
+        if (!m_glue->m_javaProxy)
+            return false;
+
+        jstring jUrl = env->NewString((unsigned short *)m_url.characters(), m_url.length());
+        env->CallVoidMethod(m_glue->m_javaProxy, m_glue->m_setDataSource, jUrl);
+        env->DeleteLocalRef(jUrl);
+        checkException(env);
+
+        if (m_networkState == MediaPlayer::Idle) {
+            m_networkState = MediaPlayer::Loading;
+            m_player->networkStateChanged();
+        }
+        return true;
     }
 
     void onPrepared(int duration, int width, int height) {
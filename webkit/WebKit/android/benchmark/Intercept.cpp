@@ -7,6 +7,7 @@
 #include "CString.h"
 #include "HTTPParsers.h"
 #include "Intercept.h"
+#include "ResourceError.h"
 #include "ResourceHandle.h"
 #include "ResourceHandleClient.h"
 #include "ResourceRequest.h"
@@ -23,12 +24,89 @@ PassRefPtr<WebCore::ResourceLoaderAndroid> MyResourceLoader::create(
             new MyResourceLoader(handle, url));
 }
 
+static const NetworkArchive* gArchive;
+static const NetworkProfile* gProfile;
+// how often a throttled body is fed to WebCore
+static const double kReplayInterval = 0.05;
+
+void MyResourceLoader::setArchive(const NetworkArchive* archive,
+        const NetworkProfile* profile)
+{
+    gArchive = archive;
+    gProfile = profile;
+}
+
 void MyResourceLoader::handleRequest()
 {
+    if (!m_handle)
+        return;
+    if (gArchive) {
+        if (const ArchivedResource* resource = gArchive->find(m_url)) {
+            loadArchived(resource);
+            return;
+        }
+    }
     if (protocolIs(m_url, "data"))
         loadData(m_url.substring(5)); // 5 for data:
     else if (protocolIs(m_url, "file"))
         loadFile(m_url.substring(7)); // 7 for file://
+    else if (gArchive) {
+        LOGD("Not in archive: %s", m_url.latin1().data());
+        m_handle->client()->didFail(m_handle,
+                ResourceError("", -14, m_url, "Not in archive"));
+    }
+}
+
+void MyResourceLoader::cancel()
+{
+    m_replayTimer.stop();
+    m_handle = 0;
+}
+
+void MyResourceLoader::loadArchived(const ArchivedResource* resource)
+{
+    m_resource = resource;
+    m_sentBytes = 0;
+    m_sentResponse = false;
+    uint32_t latency = gProfile ? gProfile->latency : 0;
+    m_replayTimer.startOneShot(latency * 0.001);
+}
+
+void MyResourceLoader::replayTimerFired(Timer<MyResourceLoader>*)
+{
+    if (!m_handle)
+        return;
+    // the client may cancel us, and drop its reference, from any callback
+    RefPtr<WebCore::ResourceLoaderAndroid> protect(this);
+    ResourceHandleClient* client = m_handle->client();
+    if (!m_sentResponse) {
+        ResourceResponse response;
+        m_resource->fillResponse(&response);
+        m_sentResponse = true;
+        client->didReceiveResponse(m_handle, response);
+        if (!m_handle)
+            return;
+    }
+
+    const Vector<char>& body = m_resource->body;
+    size_t chunk = body.size() - m_sentBytes;
+    if (gProfile && gProfile->bytesPerSecond) {
+        size_t limit = static_cast<size_t>(gProfile->bytesPerSecond * kReplayInterval);
+        if (limit < 1)
+            limit = 1;
+        if (chunk > limit)
+            chunk = limit;
+    }
+    if (chunk) {
+        client->didReceiveData(m_handle, body.data() + m_sentBytes, chunk, 0);
+        m_sentBytes += chunk;
+        if (!m_handle)
+            return;
+    }
+    if (m_sentBytes < body.size())
+        m_replayTimer.startOneShot(kReplayInterval);
+    else
+        client->didFinishLoading(m_handle);
 }
 
 void MyResourceLoader::loadData(const String& data)
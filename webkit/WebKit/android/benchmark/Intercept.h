@@ -4,6 +4,7 @@
 #define INTERCEPT_H
 
 #include "MyJavaVM.h"
+#include "NetworkArchive.h"
 #include "PlatformString.h"
 #include "Timer.h"
 #include "WebCoreFrameBridge.h"
@@ -27,16 +28,33 @@ public:
             ResourceHandle* handle, String url);
     void handleRequest();
 
+    virtual void cancel();
+
+    // Serve requests found in archive instead of failing them, paced by
+    // profile. Neither is owned; pass 0 to go back to files and data urls.
+    static void setArchive(const NetworkArchive* archive,
+            const NetworkProfile* profile);
+
 private:
     MyResourceLoader(ResourceHandle* handle, String url)
         : WebCoreResourceLoader(JSC::Bindings::getJNIEnv(), MY_JOBJECT)
         , m_handle(handle)
-        , m_url(url) {}
+        , m_url(url)
+        , m_resource(0)
+        , m_sentBytes(0)
+        , m_sentResponse(false)
+        , m_replayTimer(this, &MyResourceLoader::replayTimerFired) {}
 
     void loadData(const String&);
     void loadFile(const String&);
+    void loadArchived(const ArchivedResource*);
+    void replayTimerFired(Timer<MyResourceLoader>*);
     ResourceHandle* m_handle;
     String m_url;
+    const ArchivedResource* m_resource;
+    size_t m_sentBytes;
+    bool m_sentResponse;
+    Timer<MyResourceLoader> m_replayTimer;
 };
 
 class MyWebFrame : public WebFrame {
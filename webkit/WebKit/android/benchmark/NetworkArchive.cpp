@@ -0,0 +1,260 @@
+
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include "NetworkArchive.h"
+
+#include "CString.h"
+#include "ResourceResponse.h"
+#include <cutils/properties.h>
+#include <utils/Log.h>
+#include <wtf/CurrentTime.h>
+
+using namespace WebCore;
+
+namespace android {
+
+// The file starts with kArchiveMagic and kArchiveVersion, followed by one
+// record per resource. Numbers are 32 bit, host order; strings are a byte
+// length followed by UTF-8.
+static const uint32_t kArchiveMagic = 0x414e4b57; // "WKNA"
+static const uint32_t kArchiveVersion = 1;
+// guards against reading garbage lengths from a truncated archive
+static const uint32_t kMaxArchiveBody = 32 * 1024 * 1024;
+
+static bool writeNumber(FILE* file, uint32_t value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool writeString(FILE* file, const String& string)
+{
+    CString utf8 = string.utf8();
+    return writeNumber(file, utf8.length())
+        && fwrite(utf8.data(), 1, utf8.length(), file) == utf8.length();
+}
+
+static bool readNumber(FILE* file, uint32_t* value)
+{
+    return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+static bool readString(FILE* file, String* string)
+{
+    uint32_t length;
+    if (!readNumber(file, &length) || length > kMaxArchiveBody)
+        return false;
+    Vector<char> buffer(length);
+    if (length && fread(buffer.data(), 1, length, file) != length)
+        return false;
+    *string = String::fromUTF8(buffer.data(), length);
+    return true;
+}
+
+void ArchivedResource::setResponse(const ResourceResponse& response)
+{
+    url = response.url().string();
+    statusCode = response.httpStatusCode();
+    statusText = response.httpStatusText();
+    mimeType = response.mimeType();
+    encoding = response.textEncodingName();
+    headers.clear();
+    HTTPHeaderMap::const_iterator end = response.httpHeaderFields().end();
+    for (HTTPHeaderMap::const_iterator it = response.httpHeaderFields().begin();
+            it != end; ++it)
+        headers.append(std::make_pair(String(it->first), it->second));
+}
+
+void ArchivedResource::fillResponse(ResourceResponse* response) const
+{
+    response->setURL(KURL(ParsedURLString, url));
+    response->setHTTPStatusCode(statusCode);
+    response->setHTTPStatusText(statusText);
+    response->setMimeType(mimeType);
+    response->setTextEncodingName(encoding);
+    response->setExpectedContentLength(body.size());
+    for (size_t i = 0; i < headers.size(); i++)
+        response->setHTTPHeaderField(headers[i].first, headers[i].second);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NetworkArchive::~NetworkArchive()
+{
+    deleteAllValues(m_resources);
+}
+
+bool NetworkArchive::load(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        LOGE("Could not open archive %s", path);
+        return false;
+    }
+    uint32_t magic, version;
+    if (!readNumber(file, &magic) || magic != kArchiveMagic
+            || !readNumber(file, &version) || version != kArchiveVersion) {
+        LOGE("%s is not a network archive", path);
+        fclose(file);
+        return false;
+    }
+    while (true) {
+        ArchivedResource* resource = new ArchivedResource;
+        uint32_t status, headerCount, bodyLength;
+        bool ok = readString(file, &resource->url)
+            && readNumber(file, &status)
+            && readString(file, &resource->statusText)
+            && readString(file, &resource->mimeType)
+            && readString(file, &resource->encoding)
+            && readNumber(file, &headerCount);
+        for (uint32_t i = 0; ok && i < headerCount; i++) {
+            String name, value;
+            ok = readString(file, &name) && readString(file, &value);
+            if (ok)
+                resource->headers.append(std::make_pair(name, value));
+        }
+        ok = ok && readNumber(file, &resource->startTime)
+            && readNumber(file, &resource->duration)
+            && readNumber(file, &bodyLength) && bodyLength <= kMaxArchiveBody;
+        if (ok) {
+            resource->body.resize(bodyLength);
+            ok = !bodyLength
+                || fread(resource->body.data(), 1, bodyLength, file) == bodyLength;
+        }
+        // a short read is the end of the archive, or a capture that was cut
+        // off mid-record
+        if (!ok) {
+            delete resource;
+            break;
+        }
+        resource->statusCode = status;
+        std::pair<HashMap<String, ArchivedResource*>::iterator, bool> result =
+            m_resources.add(resource->url, resource);
+        if (!result.second) {
+            delete result.first->second;
+            result.first->second = resource;
+        }
+    }
+    fclose(file);
+    LOGD("Loaded %d resources from %s", m_resources.size(), path);
+    return true;
+}
+
+const ArchivedResource* NetworkArchive::find(const String& url) const
+{
+    return m_resources.get(url);
+}
+
+bool NetworkArchive::append(FILE* file, const ArchivedResource& resource)
+{
+    bool ok = writeString(file, resource.url)
+        && writeNumber(file, resource.statusCode)
+        && writeString(file, resource.statusText)
+        && writeString(file, resource.mimeType)
+        && writeString(file, resource.encoding)
+        && writeNumber(file, resource.headers.size());
+    for (size_t i = 0; ok && i < resource.headers.size(); i++)
+        ok = writeString(file, resource.headers[i].first)
+            && writeString(file, resource.headers[i].second);
+    ok = ok && writeNumber(file, resource.startTime)
+        && writeNumber(file, resource.duration)
+        && writeNumber(file, resource.body.size())
+        && fwrite(resource.body.data(), 1, resource.body.size(), file)
+            == resource.body.size();
+    fflush(file);
+    return ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NetworkArchiveRecorder* NetworkArchiveRecorder::get()
+{
+    static bool checked = false;
+    static NetworkArchiveRecorder* recorder = 0;
+    if (checked)
+        return recorder;
+    checked = true;
+    char path[PROPERTY_VALUE_MAX];
+    if (property_get("webcore.archive.capture", path, NULL) <= 0)
+        return 0;
+    FILE* file = fopen(path, "ab");
+    if (!file) {
+        LOGE("Could not open %s to capture into", path);
+        return 0;
+    }
+    // a new file gets the header; otherwise keep appending to the capture
+    if (!ftell(file)) {
+        writeNumber(file, kArchiveMagic);
+        writeNumber(file, kArchiveVersion);
+    }
+    LOGD("Capturing network archive to %s", path);
+    recorder = new NetworkArchiveRecorder(file);
+    return recorder;
+}
+
+NetworkArchiveRecorder::NetworkArchiveRecorder(FILE* file)
+    : m_file(file)
+    , m_startTime(WTF::currentTime())
+{
+}
+
+void NetworkArchiveRecorder::didReceiveResponse(void* key,
+        const ResourceResponse& response)
+{
+    ArchivedResource* resource = m_pending.get(key);
+    if (!resource) {
+        resource = new ArchivedResource;
+        m_pending.set(key, resource);
+    }
+    resource->setResponse(response);
+    resource->startTime = static_cast<uint32_t>(
+        (WTF::currentTime() - m_startTime) * 1000);
+    resource->body.clear();
+}
+
+void NetworkArchiveRecorder::didReceiveData(void* key, const char* data,
+        int length)
+{
+    ArchivedResource* resource = m_pending.get(key);
+    if (resource)
+        resource->body.append(data, length);
+}
+
+void NetworkArchiveRecorder::didFinishLoading(void* key)
+{
+    ArchivedResource* resource = m_pending.take(key);
+    if (!resource)
+        return;
+    uint32_t now = static_cast<uint32_t>(
+        (WTF::currentTime() - m_startTime) * 1000);
+    resource->duration = now - resource->startTime;
+    if (!NetworkArchive::append(m_file, *resource))
+        LOGE("Failed to capture %s", resource->url.utf8().data());
+    delete resource;
+}
+
+void NetworkArchiveRecorder::didFail(void* key)
+{
+    delete m_pending.take(key);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const NetworkProfile gNetworkProfiles[] = {
+    { "none", 0, 0 },
+    { "edge", 400, 30 * 1024 },
+    { "3g", 150, 200 * 1024 },
+    { "wifi", 20, 1280 * 1024 },
+};
+
+const NetworkProfile* NetworkProfile::find(const char* name)
+{
+    for (size_t i = 0; i < sizeof(gNetworkProfiles) / sizeof(gNetworkProfiles[0]); i++) {
+        if (!strcasecmp(name, gNetworkProfiles[i].name))
+            return &gNetworkProfiles[i];
+    }
+    return 0;
+}
+
+}
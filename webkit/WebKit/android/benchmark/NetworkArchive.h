@@ -0,0 +1,85 @@
+
+
+#ifndef NETWORK_ARCHIVE_H
+#define NETWORK_ARCHIVE_H
+
+#include "PlatformString.h"
+#include "StringHash.h"
+#include <stdio.h>
+#include <wtf/HashMap.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+    class ResourceResponse;
+}
+
+namespace android {
+
+// One recorded resource: the response as WebCore saw it, its body, and when
+// it arrived relative to the start of the capture.
+struct ArchivedResource {
+    WebCore::String url;
+    int statusCode;
+    WebCore::String statusText;
+    WebCore::String mimeType;
+    WebCore::String encoding;
+    Vector<std::pair<WebCore::String, WebCore::String> > headers;
+    uint32_t startTime;     // ms after the capture started
+    uint32_t duration;      // ms from response to the last byte
+    Vector<char> body;
+
+    void setResponse(const WebCore::ResourceResponse&);
+    void fillResponse(WebCore::ResourceResponse*) const;
+};
+
+// A file of ArchivedResources. The browser appends to it while capturing
+// (see NetworkArchiveRecorder) and the benchmark loads it to replay pages
+// without the network.
+class NetworkArchive {
+public:
+    ~NetworkArchive();
+
+    bool load(const char* path);
+    // the last capture of url wins; 0 if it was never recorded
+    const ArchivedResource* find(const WebCore::String& url) const;
+
+    static bool append(FILE*, const ArchivedResource&);
+
+private:
+    WTF::HashMap<WebCore::String, ArchivedResource*> m_resources;
+};
+
+// Captures every response that reaches WebCoreResourceLoader when the
+// webcore.archive.capture system property names a file to append to. The
+// loads are keyed by the ResourceHandle that receives them.
+class NetworkArchiveRecorder {
+public:
+    // 0 unless capturing is enabled
+    static NetworkArchiveRecorder* get();
+
+    void didReceiveResponse(void* key, const WebCore::ResourceResponse&);
+    void didReceiveData(void* key, const char* data, int length);
+    void didFinishLoading(void* key);
+    void didFail(void* key);
+
+private:
+    NetworkArchiveRecorder(FILE*);
+
+    FILE* m_file;
+    double m_startTime;
+    WTF::HashMap<void*, ArchivedResource*> m_pending;
+};
+
+// Bandwidth and latency applied to each replayed resource
+struct NetworkProfile {
+    const char* name;
+    uint32_t latency;           // ms before the response
+    uint32_t bytesPerSecond;    // 0 delivers the whole body at once
+
+    // "edge", "3g", "wifi" or "none"; 0 if name is unknown
+    static const NetworkProfile* find(const char* name);
+};
+
+}
+
+#endif
@@ -9,14 +9,23 @@
 
 namespace android {
 extern void benchmark(const char*, int, int ,int);
+extern int benchmarkSuite(const char*, int, int, int, const char*);
+extern bool setBenchmarkArchive(const char*, const char*);
+extern int benchmarkScroll(const char*, int, int, int, const char*);
 }
 
 int main(int argc, char** argv) {
     int width = 800;
     int height = 600;
     int reloadCount = 0;
+    int iterations = 3;
+    const char* manifest = 0;
+    const char* output = 0;
+    const char* archive = 0;
+    const char* profile = 0;
+    int scrollFrames = 0;
     while (true) {
-        int c = getopt(argc, argv, "d:r:");
+        int c = getopt(argc, argv, "d:r:m:i:o:a:p:s:");
         if (c == -1)
             break;
         else if (c == 'd') {
@@ -31,12 +40,41 @@ int main(int argc, char** argv) {
             if (reloadCount < 0)
                 reloadCount = 0;
             LOGD("Reloading %d times", reloadCount);
+        } else if (c == 'm') {
+            // a file of "[name] url" lines, each url usually pointing into a
+            // recorded page archive on the device (file:///sdcard/...)
+            manifest = optarg;
+        } else if (c == 'i') {
+            // warm runs per page, after the one cold run
+            iterations = atoi(optarg);
+            if (iterations < 0)
+                iterations = 0;
+        } else if (c == 'o') {
+            output = optarg;
+        } else if (c == 'a') {
+            // a network archive captured with webcore.archive.capture
+            archive = optarg;
+        } else if (c == 'p') {
+            // none, edge, 3g or wifi
+            profile = optarg;
+        } else if (c == 's') {
+            // frames per scripted scroll or zoom; draws the loaded page the
+            // way the UI thread does instead of timing the load
+            scrollFrames = atoi(optarg);
         }
     }
+    if (archive && !android::setBenchmarkArchive(archive, profile))
+        return 1;
+    if (manifest)
+        return android::benchmarkSuite(manifest, iterations, width, height,
+                                       output);
     if (optind >= argc) {
-        LOGE("Please supply a file to read\n");
+        LOGE("Please supply a file to read, or a manifest with -m\n");
         return 1;
     }
 
+    if (scrollFrames > 0)
+        return android::benchmarkScroll(argv[optind], scrollFrames, width,
+                                        height, output);
     android::benchmark(argv[optind], reloadCount, width, height);
 }
@@ -8,9 +8,11 @@
 #include "Cache.h"
 #include "Connection.h"
 #include "CookieClient.h"
+#include "CookieJarAndroid.h"
 #include "JavaSharedClient.h"
 #include "KeyGeneratorClient.h"
 #include "KURL.h"
+#include "MemoryPressureHandler.h"
 #include "NetworkStateNotifier.h"
 #include "PackageNotifier.h"
 #include "Page.h"
@@ -21,6 +23,7 @@
 #ifdef ANDROID_INSTRUMENT
 #include "TimeCounter.h"
 #endif
+#include "TraceBuffer.h"
 #include "WebCoreJni.h"
 
 #include <JNIHelp.h>
@@ -28,6 +31,7 @@
 #include <SkUtils.h>
 #include <jni.h>
 #include <utils/misc.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/Platform.h>
 #include <wtf/StdLibExtras.h>
 
@@ -78,6 +82,9 @@ public:
     static void SetNetworkOnLine(JNIEnv* env, jobject obj, jboolean online);
     static void SetNetworkType(JNIEnv* env, jobject obj, jstring type, jstring subtype);
     static void SetDeferringTimers(JNIEnv* env, jobject obj, jboolean defer);
+    static void SetTimerSlack(JNIEnv* env, jobject obj, jint slackMillis);
+    static void CookiesChanged(JNIEnv* env, jobject obj);
+    static jint ReleaseMemory(JNIEnv* env, jobject obj, jint bytes);
     static void ServiceFuncPtrQueue(JNIEnv*);
     static void UpdatePluginDirectories(JNIEnv* env, jobject obj, jobjectArray array, jboolean reload);
     static void AddPackageNames(JNIEnv* env, jobject obj, jobject packageNames);
@@ -100,6 +107,11 @@ private:
 };
 
 static void (*sSharedTimerFiredCallback)();
+// Absolute time in ms of the timer posted to Java, or 0 if none is pending
+static long long sSharedTimerFireTime;
+// Deadlines are rounded up to a multiple of this many ms, so timers due
+// close together fire in one sharedTimerFired; 0 or 1 fires on time
+static int sSharedTimerSlack;
 
 JavaBridge::JavaBridge(JNIEnv* env, jobject obj)
 {
@@ -150,14 +162,28 @@ JavaBridge::~JavaBridge()
 void
 JavaBridge::setSharedTimer(long long timemillis)
 {
+    long long now = static_cast<long long>(WTF::currentTime() * 1000);
+    long long fireTime = now + (timemillis > 0 ? timemillis : 0);
+    if (sSharedTimerSlack > 1) {
+        fireTime += sSharedTimerSlack - 1;
+        fireTime -= fireTime % sSharedTimerSlack;
+    }
+    // WebCore reschedules every time its earliest timer changes; most of
+    // those land on the deadline Java already has.
+    if (fireTime == sSharedTimerFireTime)
+        return;
+    sSharedTimerFireTime = fireTime;
     JNIEnv* env = JSC::Bindings::getJNIEnv();
     AutoJObject obj = getRealObject(env, mJavaObject);
-    env->CallVoidMethod(obj.get(), mSetSharedTimer, timemillis);
+    env->CallVoidMethod(obj.get(), mSetSharedTimer, fireTime - now);
 }
 
 void
 JavaBridge::stopSharedTimer()
 {    
+    if (!sSharedTimerFireTime)
+        return;
+    sSharedTimerFireTime = 0;
     JNIEnv* env = JSC::Bindings::getJNIEnv();
     AutoJObject obj = getRealObject(env, mJavaObject);
     env->CallVoidMethod(obj.get(), mStopSharedTimer);
@@ -289,6 +315,7 @@ WebCore::String JavaBridge::getSignedPublicKeyAndChallengeString(unsigned index,
 
 void JavaBridge::Constructor(JNIEnv* env, jobject obj)
 {
+    waitForWarmUp();
     JavaBridge* javaBridge = new JavaBridge(env, obj);
     env->SetIntField(obj, gJavaBridge_ObjectID, (jint)javaBridge);
 }
@@ -306,12 +333,15 @@ void JavaBridge::Finalize(JNIEnv* env, jobject obj)
 // we don't use the java bridge object, as we're just looking at a global
 void JavaBridge::SharedTimerFired(JNIEnv* env, jobject)
 {
+    // Java has no timer pending now, so the callback's reschedule must go out
+    sSharedTimerFireTime = 0;
     if (sSharedTimerFiredCallback)
     {
 #ifdef ANDROID_INSTRUMENT
         TimeCounter::start(TimeCounter::SharedTimerTimeCounter);
 #endif
         SkAutoMemoryUsageProbe  mup("JavaBridge::sharedTimerFired");
+        TraceBufferAuto trace(TraceBuffer::SharedTimerTrace);
         sSharedTimerFiredCallback();
 #ifdef ANDROID_INSTRUMENT
         TimeCounter::record(TimeCounter::SharedTimerTimeCounter, __FUNCTION__);
@@ -324,6 +354,23 @@ void JavaBridge::SetCacheSize(JNIEnv* env, jobject obj, jint bytes)
     WebCore::cache()->setCapacities(0, bytes/2, bytes);
 }
 
+void JavaBridge::SetTimerSlack(JNIEnv* env, jobject obj, jint slackMillis)
+{
+    sSharedTimerSlack = slackMillis;
+}
+
+void JavaBridge::CookiesChanged(JNIEnv* env, jobject obj)
+{
+    WebCore::cookiesChanged();
+}
+
+// Frees at least bytes, or everything that can be rebuilt if bytes is 0, and
+// returns how much was freed
+jint JavaBridge::ReleaseMemory(JNIEnv* env, jobject obj, jint bytes)
+{
+    return MemoryPressureHandler::releaseMemory(bytes > 0 ? bytes : 0);
+}
+
 void JavaBridge::SetNetworkOnLine(JNIEnv* env, jobject obj, jboolean online)
 {
 	WebCore::networkStateNotifier().networkStateChange(online);
@@ -442,6 +489,16 @@ static JNINativeMethod gWebCoreJavaBridgeMethods[] = {
         (void*) JavaBridge::RemovePackageName }
 };
 
+// Older JWebCoreJavaBridge.java always fires timers on time
+static JNINativeMethod gWebCoreJavaBridgeOptionalMethods[] = {
+    { "nativeSetTimerSlack", "(I)V",
+        (void*) JavaBridge::SetTimerSlack },
+    { "nativeCookiesChanged", "()V",
+        (void*) JavaBridge::CookiesChanged },
+    { "nativeReleaseMemory", "(I)I",
+        (void*) JavaBridge::ReleaseMemory }
+};
+
 int register_javabridge(JNIEnv* env)
 {
     jclass javaBridge = env->FindClass("android/webkit/JWebCoreJavaBridge");
@@ -449,6 +506,12 @@ int register_javabridge(JNIEnv* env)
     gJavaBridge_ObjectID = env->GetFieldID(javaBridge, "mNativeBridge", "I");
     LOG_FATAL_IF(gJavaBridge_ObjectID == NULL, "Unable to find android/webkit/JWebCoreJavaBridge.mNativeBridge");
 
+    // One at a time, so that a Java side lacking one still gets the others.
+    for (size_t i = 0; i < NELEM(gWebCoreJavaBridgeOptionalMethods); ++i) {
+        if (env->RegisterNatives(javaBridge, &gWebCoreJavaBridgeOptionalMethods[i], 1) < 0)
+            env->ExceptionClear();
+    }
+
     return jniRegisterNativeMethods(env, "android/webkit/JWebCoreJavaBridge", 
                                     gWebCoreJavaBridgeMethods, NELEM(gWebCoreJavaBridgeMethods));
 }
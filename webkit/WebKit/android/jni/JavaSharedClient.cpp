@@ -3,8 +3,7 @@
 #include "config.h"
 #include "JavaSharedClient.h"
 #include "TimerClient.h"
-#include "SkDeque.h"
-#include "SkThread.h"
+#include <cutils/atomic.h>
 
 namespace android {
     TimerClient* JavaSharedClient::GetTimerClient()
@@ -57,46 +56,66 @@ namespace android {
     struct FuncPtrRec {
         void (*fProc)(void* payload);
         void* fPayload;
+        FuncPtrRec* fNext;
     };
-    
-    static SkMutex gFuncPtrQMutex;
-    static SkDeque gFuncPtrQ(sizeof(FuncPtrRec));
+
+    // Producers push onto this list without locking; the webkit thread
+    // takes the whole list at once, so it is newest first.
+    static FuncPtrRec* volatile gFuncPtrQHead;
+    // 1 while a signalServiceFuncPtrQueue is outstanding, so a burst of
+    // enqueues sends one signal
+    static volatile int32_t gFuncPtrQSignaled;
+
+    static inline bool compareAndSwap(FuncPtrRec* volatile* addr,
+                                      FuncPtrRec* oldValue, FuncPtrRec* newValue)
+    {
+        return !android_atomic_cmpxchg((int32_t) oldValue, (int32_t) newValue,
+                                       (volatile int32_t*) addr);
+    }
 
     void JavaSharedClient::EnqueueFunctionPtr(void (*proc)(void* payload),
                                               void* payload)
     {
-        gFuncPtrQMutex.acquire();
-
-        FuncPtrRec* rec = (FuncPtrRec*)gFuncPtrQ.push_back();
+        FuncPtrRec* rec = new FuncPtrRec;
         rec->fProc = proc;
         rec->fPayload = payload;
-        
-        gFuncPtrQMutex.release();
-        
-        gTimerClient->signalServiceFuncPtrQueue();
+        do {
+            rec->fNext = gFuncPtrQHead;
+        } while (!compareAndSwap(&gFuncPtrQHead, rec->fNext, rec));
+
+        if (!android_atomic_cmpxchg(0, 1, &gFuncPtrQSignaled))
+            gTimerClient->signalServiceFuncPtrQueue();
     }
 
     void JavaSharedClient::ServiceFunctionPtrQueue()
     {
+        // clear the flag before taking the list, so anything pushed after
+        // we take it signals again
+        android_atomic_cmpxchg(1, 0, &gFuncPtrQSignaled);
         for (;;) {
-            void (*proc)(void*) = 0;
-            void* payload = 0;
-            const FuncPtrRec* rec;
-            
-            // we have to copy the proc/payload (if present). we do this so we
-            // don't call the proc inside the mutex (possible deadlock!)
-            gFuncPtrQMutex.acquire();
-            rec = (const FuncPtrRec*)gFuncPtrQ.front();
-            if (rec) {
-                proc = rec->fProc;
-                payload = rec->fPayload;
-                gFuncPtrQ.pop_front();
-            }
-            gFuncPtrQMutex.release();
-            
-            if (!rec)
+            FuncPtrRec* list;
+            do {
+                list = gFuncPtrQHead;
+            } while (list && !compareAndSwap(&gFuncPtrQHead, list, 0));
+            if (!list)
                 break;
-            proc(payload);
+
+            // reverse into the order the functions were enqueued
+            FuncPtrRec* rec = 0;
+            while (list) {
+                FuncPtrRec* next = list->fNext;
+                list->fNext = rec;
+                rec = list;
+                list = next;
+            }
+            while (rec) {
+                void (*proc)(void*) = rec->fProc;
+                void* payload = rec->fPayload;
+                FuncPtrRec* next = rec->fNext;
+                delete rec;
+                rec = next;
+                proc(payload);
+            }
         }
     }
 }
@@ -0,0 +1,124 @@
+#define LOG_TAG "webcoreglue"
+
+#include "config.h"
+#include "MemoryPressureHandler.h"
+
+#include "BitmapAllocatorAndroid.h"
+#include "Cache.h"
+#include "FontCache.h"
+#if USE(JSC)
+#include "GCController.h"
+#endif
+#include "PageCache.h"
+#include "RenderArena.h"
+#include "WebViewCore.h"
+
+#include <malloc.h>
+#include <utils/Log.h>
+#include <wtf/Assertions.h>
+#include <wtf/FastMalloc.h>
+
+namespace android {
+
+// Decoded pixels left after the decoded images stage. Images on screen are
+// decoded again as they are drawn.
+static const size_t decodedImageBudget = 1024 * 1024;
+
+static const char* const stageNames[MemoryPressureHandler::StageCount] = {
+    "dead resources",
+    "decoded images",
+    "fonts",
+    "JavaScript heap",
+    "page cache",
+    "offscreen tiles"
+};
+
+// For the stages whose caches don't count their bytes themselves: what
+// FastMalloc and the system heap have handed out.
+static size_t heapBytesInUse()
+{
+    WTF::FastMallocStatistics statistics = WTF::fastMallocStatistics();
+    size_t freeBytes = statistics.freeSizeInHeap + statistics.freeSizeInCaches;
+    size_t fastMallocBytes = statistics.heapSize > freeBytes ? statistics.heapSize - freeBytes : 0;
+    return fastMallocBytes + mallinfo().uordblks;
+}
+
+static size_t heapBytesFreedSince(size_t bytesInUse)
+{
+    size_t current = heapBytesInUse();
+    return bytesInUse > current ? bytesInUse - current : 0;
+}
+
+static size_t runStage(MemoryPressureHandler::Stage stage)
+{
+    switch (stage) {
+    case MemoryPressureHandler::DeadResourcesStage:
+        return WebCore::cache()->pruneDeadResourcesForMemoryPressure();
+    case MemoryPressureHandler::DecodedImagesStage:
+        return WebCore::BitmapAllocatorAndroid::purgeDecoded(decodedImageBudget);
+    case MemoryPressureHandler::FontsStage: {
+        size_t bytesInUse = heapBytesInUse();
+        // Deleting a font's data also prunes its glyph pages.
+        WebCore::fontCache()->purgeInactiveFontData();
+        return heapBytesFreedSince(bytesInUse);
+    }
+    case MemoryPressureHandler::JavaScriptHeapStage:
+#if USE(JSC)
+        return WebCore::gcController().garbageCollectAndReleaseMemoryNow();
+#else
+        return 0;
+#endif
+    case MemoryPressureHandler::PageCacheStage: {
+        size_t bytesInUse = heapBytesInUse();
+        WebCore::PageCache* pageCache = WebCore::pageCache();
+        int capacity = pageCache->capacity();
+        pageCache->setCapacity(0);
+        pageCache->releaseAutoreleasedPagesNow();
+        pageCache->setCapacity(capacity);
+        // The resources of the dropped pages are dead now, and their render
+        // arenas went to the free list.
+        WebCore::cache()->pruneDeadResourcesForMemoryPressure();
+        WebCore::RenderArena::releaseFreeArenas();
+#if USE(JSC)
+        // Their windows are garbage now too.
+        WebCore::gcController().garbageCollectSoon();
+#endif
+        return heapBytesFreedSince(bytesInUse);
+    }
+    case MemoryPressureHandler::OffscreenTilesStage:
+        return WebViewCore::discardOffscreenTiles();
+    case MemoryPressureHandler::StageCount:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
+size_t MemoryPressureHandler::releaseMemory(size_t bytesWanted, size_t* freed)
+{
+    size_t total = 0;
+    for (int i = 0; i < StageCount; ++i) {
+        Stage stage = static_cast<Stage>(i);
+        size_t stageFreed = 0;
+        if (!bytesWanted || total < bytesWanted) {
+            stageFreed = runStage(stage);
+            LOGD("Memory pressure: %s freed %d bytes", stageName(stage), stageFreed);
+        }
+        if (freed)
+            freed[i] = stageFreed;
+        total += stageFreed;
+    }
+
+    // Hand the pages freed above back to the system now rather than waiting
+    // for the FastMalloc scavenger thread.
+    WTF::releaseFastMallocFreeMemory();
+    return total;
+}
+
+const char* MemoryPressureHandler::stageName(Stage stage)
+{
+    ASSERT(stage >= 0 && stage < StageCount);
+    return stageNames[stage];
+}
+
+} // namespace android
@@ -0,0 +1,35 @@
+#ifndef MemoryPressureHandler_h
+#define MemoryPressureHandler_h
+
+#include <stddef.h>
+
+namespace android {
+
+    // Frees what WebCore can rebuild when the system is short of memory,
+    // in stages ordered from what is cheapest to rebuild to what the user
+    // would notice most. Each stage reports the bytes it freed.
+    class MemoryPressureHandler {
+    public:
+        enum Stage {
+            DeadResourcesStage, // memory cache resources no page uses
+            DecodedImagesStage, // decoded pixels beyond a small budget
+            FontsStage, // inactive font data and its glyph pages
+            JavaScriptHeapStage, // full collection, empty blocks released
+            PageCacheStage, // every page kept for back and forward
+            OffscreenTilesStage, // content tiles that aren't on screen
+            StageCount
+        };
+
+        // Runs the stages in order until at least bytesWanted have been
+        // freed, or all of them if bytesWanted is 0. If freed is given, it
+        // receives StageCount values: the bytes each stage freed, 0 for
+        // those that didn't run. Returns the total. Only call this from the
+        // webkit thread.
+        static size_t releaseMemory(size_t bytesWanted = 0, size_t* freed = 0);
+
+        static const char* stageName(Stage);
+    };
+
+} // namespace android
+
+#endif // MemoryPressureHandler_h
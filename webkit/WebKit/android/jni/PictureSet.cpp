@@ -9,16 +9,32 @@
 #include "PictureSet.h"
 #include "SkBounder.h"
 #include "SkCanvas.h"
+#include "SkDrawFilter.h"
+#include "SkPaint.h"
 #include "SkPicture.h"
 #include "SkRect.h"
 #include "SkRegion.h"
+#include "SkShader.h"
 #include "SkStream.h"
 #include "TimeCounter.h"
 
+#include <wtf/ThreadPool.h>
+
 #define MAX_DRAW_TIME 100
+#define MERGE_DRAW_TIME 20
+#define HOT_INVAL_COUNT 8
+#define MAX_MERGEABLE 8 // cheap unsplit pictures tolerated before merging
 #define MIN_SPLITTABLE 400
+#define TILE_SIZE 256 // in device pixels
+#define MAX_TILES 24 // 3M of RGB565 tiles
+#define MIN_PREFETCH_VELOCITY 100 // device pixels per second
+#define FAST_PREFETCH_VELOCITY 1500
+#define MAX_SCROLL_INTERVAL 250 // msec between frames to count as scrolling
+#define CHECKER_SIZE 8
+#define CHECKER_LIGHT 0xFFE8E8E8
+#define CHECKER_DARK 0xFFD0D0D0
+#define PREVIEW_SIZE (TILE_SIZE / 4) // low resolution tile, in pixels
 
-#if PICTURE_SET_DEBUG
 class MeasureStream : public SkWStream {
 public:
     MeasureStream() : mTotal(0) {}
@@ -28,13 +44,15 @@ public:
     }
     size_t mTotal;
 };
-#endif
 
 namespace android {
 
 PictureSet::PictureSet()
 {
     mWidth = mHeight = 0;
+    mMaxDrawTime = MAX_DRAW_TIME;
+    mMergeDrawTime = MERGE_DRAW_TIME;
+    mHotInvalCount = HOT_INVAL_COUNT;
 }
 
 PictureSet::~PictureSet()
@@ -64,10 +82,28 @@ void PictureSet::add(const SkRegion& area, SkPicture* picture,
     for (Pictures* working = mPictures.begin(); working != last; working++)
         diff.op(working->mArea, SkRegion::kDifference_Op);
     Pictures pictureAndBounds = {area, picture, area.getBounds(),
-        elapsed, split, false, diff.isEmpty() == false, empty};
+        elapsed, 0, split, false, diff.isEmpty() == false, empty};
     mPictures.append(pictureAndBounds);
 }
 
+// A picture recorded for an inval replaces the pictures it covers; carry
+// their history forward, and count the inval against any base picture that
+// is only partly covered, since build() will have to redraw around it.
+uint32_t PictureSet::countInval(const SkRegion& area)
+{
+    uint32_t invalCount = 0;
+    Pictures* last = mPictures.end();
+    for (Pictures* working = mPictures.begin(); working != last; working++) {
+        if (!working->mArea.intersects(area))
+            continue;
+        if (working->mBase && !area.contains(working->mArea))
+            working->mInvalCount++;
+        else if (invalCount <= working->mInvalCount)
+            invalCount = working->mInvalCount + 1;
+    }
+    return invalCount;
+}
+
 bool PictureSet::build()
 {
     bool rebuild = false;
@@ -274,7 +310,7 @@ bool PictureSet::draw(SkCanvas* canvas)
             working->mElapsed, working->mBase ? "true" : "false");
     }
  //   dump(__FUNCTION__);
-    return maxElapsed >= MAX_DRAW_TIME;
+    return maxElapsed >= mMaxDrawTime;
 }
 
 void PictureSet::dump(const char* label) const
@@ -409,6 +445,17 @@ bool PictureSet::emptyPicture(SkPicture* picture) const
     return checker.mEmpty;
 }
 
+size_t PictureSet::flattenedSize() const
+{
+    MeasureStream measure;
+    const Pictures* last = mPictures.end();
+    for (const Pictures* working = mPictures.begin(); working != last; working++) {
+        if (working->mPicture != NULL)
+            working->mPicture->serialize(&measure);
+    }
+    return measure.mTotal;
+}
+
 bool PictureSet::isEmpty() const
 {
     const Pictures* last = mPictures.end();
@@ -458,6 +505,9 @@ void PictureSet::set(const PictureSet& src)
     clear();
     mWidth = src.mWidth;
     mHeight = src.mHeight;
+    mMaxDrawTime = src.mMaxDrawTime;
+    mMergeDrawTime = src.mMergeDrawTime;
+    mHotInvalCount = src.mHotInvalCount;
     const Pictures* last = src.mPictures.end();
     for (const Pictures* working = src.mPictures.begin(); working != last; working++)
         add(working);
@@ -501,6 +551,30 @@ void PictureSet::setPicture(size_t i, SkPicture* p)
     mPictures[i].mEmpty = emptyPicture(p);
 }
 
+bool PictureSet::isHot(const Pictures& pictures) const
+{
+    if (pictures.mSplit || pictures.mInvalCount < mHotInvalCount)
+        return false;
+    const SkIRect& bounds = pictures.mArea.getBounds();
+    return bounds.width() >= MIN_SPLITTABLE << 1
+        || bounds.height() >= MIN_SPLITTABLE << 1;
+}
+
+void PictureSet::setSplitPolicy(uint32_t maxDrawTime, uint32_t mergeDrawTime,
+    uint32_t hotInvalCount)
+{
+    DBG_SET_LOGD("%p maxDrawTime=%d mergeDrawTime=%d hotInvalCount=%d", this,
+        maxDrawTime, mergeDrawTime, hotInvalCount);
+    mMaxDrawTime = maxDrawTime ? maxDrawTime : MAX_DRAW_TIME;
+    mMergeDrawTime = mergeDrawTime < mMaxDrawTime ? mergeDrawTime
+        : mMaxDrawTime;
+    mHotInvalCount = hotInvalCount ? hotInvalCount : HOT_INVAL_COUNT;
+}
+
+// Pictures that are slow to draw are cut into pieces that draw within
+// mMaxDrawTime. Large pictures that keep getting partially redrawn are cut
+// as well, so that the next inval only redraws the pieces it touches.
+// Unsplit pictures that draw in under mMergeDrawTime are merged into one.
 void PictureSet::split(PictureSet* out) const
 {
     dump(__FUNCTION__);
@@ -508,6 +582,9 @@ void PictureSet::split(PictureSet* out) const
     SkIRect totalBounds;
     out->mWidth = mWidth;
     out->mHeight = mHeight;
+    out->mMaxDrawTime = mMaxDrawTime;
+    out->mMergeDrawTime = mMergeDrawTime;
+    out->mHotInvalCount = mHotInvalCount;
     totalBounds.set(0, 0, mWidth, mHeight);
     SkRegion* total = new SkRegion(totalBounds);
     const Pictures* last = mPictures.end();
@@ -515,24 +592,29 @@ void PictureSet::split(PictureSet* out) const
     uint32_t balance = 0;
     int multiUnsplitFastPictures = 0; // > 1 has more than 1
     for (working = mPictures.begin(); working != last; working++) {
-        if (working->mElapsed >= MAX_DRAW_TIME || working->mSplit)
+        if (working->mElapsed >= mMergeDrawTime || working->mSplit
+                || isHot(*working))
             continue;
         if (++multiUnsplitFastPictures > 1)
             break;
     }
     for (working = mPictures.begin(); working != last; working++) {
         uint32_t elapsed = working->mElapsed;
-        if (elapsed < MAX_DRAW_TIME) {
+        bool hot = isHot(*working);
+        if (elapsed < mMaxDrawTime && !hot) {
             bool split = working->mSplit;
+            bool merge = multiUnsplitFastPictures > 1 && !split
+                && elapsed < mMergeDrawTime;
             DBG_SET_LOGD("elapsed=%d working=%p total->getBounds()="
-                "{%d,%d,r=%d,b=%d} split=%s", elapsed, working,
+                "{%d,%d,r=%d,b=%d} split=%s merge=%s", elapsed, working,
                 total->getBounds().fLeft, total->getBounds().fTop,
                 total->getBounds().fRight, total->getBounds().fBottom,
-                split ? "true" : "false");
-            if (multiUnsplitFastPictures <= 1 || split) {
+                split ? "true" : "false", merge ? "true" : "false");
+            if (!merge) {
                 total->op(working->mArea, SkRegion::kDifference_Op);
                 out->add(working->mArea, working->mPicture, elapsed, split,
                     working->mEmpty);
+                out->mPictures.last().mInvalCount = working->mInvalCount;
             } else if (balance < elapsed)
                 balance = elapsed;
             continue;
@@ -551,7 +633,8 @@ void PictureSet::split(PictureSet* out) const
                 width >>= 1;
                 across <<= 1 ;
             }
-            if ((elapsed >>= 1) < MAX_DRAW_TIME)
+            // hot pictures are cut down to MIN_SPLITTABLE regardless of time
+            if ((elapsed >>= 1) < mMaxDrawTime && !hot)
                 break;
         }
         width = bounds.width();
@@ -582,6 +665,20 @@ void PictureSet::split(PictureSet* out) const
     out->dump("split-out");
 }
 
+bool PictureSet::wantsSplit() const
+{
+    int mergeable = 0;
+    const Pictures* last = mPictures.end();
+    for (const Pictures* working = mPictures.begin(); working != last; working++) {
+        if (isHot(*working))
+            return true;
+        if (working->mElapsed < mMergeDrawTime && !working->mSplit
+                && ++mergeable > MAX_MERGEABLE)
+            return true;
+    }
+    return false;
+}
+
 bool PictureSet::validate(const char* funct) const
 {
     bool valid = true;
@@ -643,4 +740,476 @@ bool PictureSet::validate(const char* funct) const
     return valid;
 }
 
+// Draws a quick first look at a tile: no antialiasing or bitmap filtering,
+// and no images, so that nothing waits on an image being decoded.
+class PreviewDrawFilter : public SkDrawFilter {
+public:
+    virtual bool filter(SkCanvas* , SkPaint* paint, Type type)
+    {
+        mFlags = paint->getFlags();
+        if (type == kBitmap_Type)
+            return false;
+        paint->setFlags(mFlags & ~(SkPaint::kAntiAlias_Flag
+            | SkPaint::kFilterBitmap_Flag));
+        return true;
+    }
+    virtual void restore(SkCanvas* , SkPaint* paint, Type )
+    {
+        paint->setFlags(mFlags);
+    }
+private:
+    uint32_t mFlags;
+};
+
+PictureSetTiles::PictureSetTiles()
+    : mContentSource(0)
+    , mRenderScheduled(false)
+    , mReadyCallback(0)
+    , mReadyContext(0)
+    , mConfig(SkBitmap::kNo_Config)
+    , mBackground(SK_ColorWHITE)
+    , mScale(0)
+    , mPendingScale(0)
+    , mLastScrollTime(0)
+    , mFrame(0)
+    , mGeneration(1)
+    , mContentWidth(0)
+    , mContentHeight(0)
+    , mLastOriginX(0)
+    , mLastOriginY(0)
+    , mVelocityX(0)
+    , mVelocityY(0)
+    , mRenderingX(0)
+    , mRenderingY(0)
+    , mRenderingGeneration(0)
+    , mPreview(false)
+    , mQuit(false)
+    , mTookTooLong(false)
+{
+}
+
+PictureSetTiles::~PictureSetTiles()
+{
+    stop();
+    clear();
+}
+
+void PictureSetTiles::clear()
+{
+    MutexLocker locker(mMutex);
+    DBG_SET_LOGD("%p tiles=%d", this, mTiles.size());
+    mTiles.clear();
+    mRequests.clear();
+    mContent.clear();
+    mContentSource->safeUnref();
+    mContentSource = 0;
+    mScale = mPendingScale = 0;
+    mContentWidth = mContentHeight = 0;
+    mLastScrollTime = 0;
+    ++mGeneration;
+}
+
+bool PictureSetTiles::draw(SkCanvas* canvas, PictureSetSnapshot* snapshot,
+    SkColor background, bool* tookTooLong)
+{
+    const PictureSet& content = snapshot->content();
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    if (matrix.getType() & ~(SkMatrix::kTranslate_Mask | SkMatrix::kScale_Mask))
+        return false;
+    SkScalar scale = matrix.getScaleX();
+    if (scale <= 0 || scale != matrix.getScaleY())
+        return false;
+    MutexLocker locker(mMutex);
+    if (scale != mScale) {
+        // while zooming every frame has a new scale; replay the pictures
+        // directly until the scale settles instead of filling throwaway tiles
+        bool settled = scale == mPendingScale;
+        mPendingScale = scale;
+        if (!settled)
+            return false;
+        DBG_SET_LOGD("%p scale=%g (was %g)", this, SkScalarToFloat(scale),
+            SkScalarToFloat(mScale));
+        mScale = scale;
+        mLastScrollTime = 0;
+        ++mGeneration;
+    }
+    if (mContentWidth != content.width()
+            || mContentHeight != content.height()
+            || mBackground != background) {
+        mContentWidth = content.width();
+        mContentHeight = content.height();
+        mBackground = background;
+        ++mGeneration;
+    }
+    SkBitmap::Config config = SkColorGetA(background) == 0xFF ?
+        SkBitmap::kRGB_565_Config : SkBitmap::kARGB_8888_Config;
+    if (mConfig != config) {
+        mTiles.clear();
+        mConfig = config;
+    }
+    // the tile grid is anchored at the content origin in device space
+    int originX = SkScalarRound(matrix.getTranslateX());
+    int originY = SkScalarRound(matrix.getTranslateY());
+    trackScroll(originX, originY);
+    int contentWidth = SkScalarCeil(SkScalarMul(SkIntToScalar(mContentWidth),
+        scale));
+    int contentHeight = SkScalarCeil(SkScalarMul(
+        SkIntToScalar(mContentHeight), scale));
+    SkIRect clip = canvas->getTotalClip().getBounds();
+    clip.offset(-originX, -originY);
+    if (!clip.intersect(0, 0, contentWidth, contentHeight))
+        return true; // nothing visible, only the background
+    int left = clip.fLeft / TILE_SIZE;
+    int top = clip.fTop / TILE_SIZE;
+    int right = (clip.fRight - 1) / TILE_SIZE;
+    int bottom = (clip.fBottom - 1) / TILE_SIZE;
+    if ((right - left + 1) * (bottom - top + 1) > MAX_TILES)
+        return false;
+    ++mFrame;
+    // requests are reprioritized every frame: visible tiles first
+    mRequests.clear();
+    Tile* last = mTiles.end();
+    for (Tile* working = mTiles.begin(); working != last; working++) {
+        working->mQueued = false;
+        if (working->mX >= left && working->mX <= right
+                && working->mY >= top && working->mY <= bottom)
+            working->mLastUsed = mFrame;
+    }
+    SkAutoCanvasRestore restore(canvas, true);
+    canvas->resetMatrix();
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            int deviceX = originX + x * TILE_SIZE;
+            int deviceY = originY + y * TILE_SIZE;
+            Tile* tile = obtain(x, y);
+            if (tile && tile->mGeneration == mGeneration && tile->mPreview) {
+                SkRect dest;
+                dest.set(SkIntToScalar(deviceX), SkIntToScalar(deviceY),
+                    SkIntToScalar(deviceX + TILE_SIZE),
+                    SkIntToScalar(deviceY + TILE_SIZE));
+                SkPaint paint;
+                paint.setFilterBitmap(true);
+                canvas->drawBitmapRect(tile->mBitmap, 0, dest, &paint);
+            } else if (tile && tile->mGeneration == mGeneration) {
+                canvas->drawBitmap(tile->mBitmap, SkIntToScalar(deviceX),
+                    SkIntToScalar(deviceY));
+            } else
+                drawCheckerboard(canvas, deviceX, deviceY);
+            if (tile)
+                queue(tile);
+        }
+    }
+    // prefetch the tiles about to scroll into view
+    int maxX = (contentWidth - 1) / TILE_SIZE;
+    int maxY = (contentHeight - 1) / TILE_SIZE;
+    if (abs(mVelocityY) >= MIN_PREFETCH_VELOCITY) {
+        int ahead = abs(mVelocityY) >= FAST_PREFETCH_VELOCITY ? 2 : 1;
+        int first = mVelocityY > 0 ? bottom + 1 : top - ahead;
+        for (int y = first; y < first + ahead; y++) {
+            if (y < 0 || y > maxY)
+                continue;
+            for (int x = left; x <= right; x++) {
+                if (Tile* tile = obtain(x, y))
+                    queue(tile);
+            }
+        }
+    }
+    if (abs(mVelocityX) >= MIN_PREFETCH_VELOCITY) {
+        int ahead = abs(mVelocityX) >= FAST_PREFETCH_VELOCITY ? 2 : 1;
+        int first = mVelocityX > 0 ? right + 1 : left - ahead;
+        for (int x = first; x < first + ahead; x++) {
+            if (x < 0 || x > maxX)
+                continue;
+            for (int y = top; y <= bottom; y++) {
+                if (Tile* tile = obtain(x, y))
+                    queue(tile);
+            }
+        }
+    }
+    if (mRequests.size()) {
+        if (mContentSource != snapshot) {
+            mContent.set(content);
+            snapshot->safeRef();
+            mContentSource->safeUnref();
+            mContentSource = snapshot;
+        }
+        if (!mRenderScheduled && !mQuit) {
+            mRenderScheduled = true;
+            dispatchToBackground(renderTiles, this, HighBackgroundPriority);
+        }
+    }
+    *tookTooLong |= mTookTooLong;
+    mTookTooLong = false;
+    return true;
+}
+
+size_t PictureSetTiles::discardOffscreen()
+{
+    MutexLocker locker(mMutex);
+    size_t freed = 0;
+    size_t kept = 0;
+    for (size_t index = 0; index < mTiles.size(); index++) {
+        Tile& tile = mTiles[index];
+        if (tile.mLastUsed != mFrame) {
+            freed += tile.mBitmap.getSize();
+            continue;
+        }
+        if (kept != index)
+            mTiles[kept] = tile;
+        kept++;
+    }
+    DBG_SET_LOGD("%p tiles=%d kept=%d", this, mTiles.size(), kept);
+    mTiles.shrink(kept);
+    // the render task draws into the scratch bitmaps without the lock
+    if (!mRenderScheduled) {
+        freed += mScratch.getSize() + mPreviewScratch.getSize();
+        mScratch.reset();
+        mPreviewScratch.reset();
+    }
+    return freed;
+}
+
+void PictureSetTiles::drawCheckerboard(SkCanvas* canvas, int x, int y)
+{
+    if (mChecker.empty()) {
+        mChecker.setConfig(SkBitmap::kRGB_565_Config, CHECKER_SIZE * 2,
+            CHECKER_SIZE * 2);
+        if (!mChecker.allocPixels())
+            return;
+        mChecker.eraseColor(CHECKER_LIGHT);
+        SkCanvas checkerCanvas(mChecker);
+        SkPaint paint;
+        paint.setColor(CHECKER_DARK);
+        SkRect square;
+        square.set(0, 0, SkIntToScalar(CHECKER_SIZE), SkIntToScalar(CHECKER_SIZE));
+        checkerCanvas.drawRect(square, paint);
+        square.offset(SkIntToScalar(CHECKER_SIZE), SkIntToScalar(CHECKER_SIZE));
+        checkerCanvas.drawRect(square, paint);
+    }
+    SkPaint paint;
+    SkShader* shader = SkShader::CreateBitmapShader(mChecker,
+        SkShader::kRepeat_TileMode, SkShader::kRepeat_TileMode);
+    paint.setShader(shader)->safeUnref();
+    SkRect rect;
+    rect.set(SkIntToScalar(x), SkIntToScalar(y),
+        SkIntToScalar(x + TILE_SIZE), SkIntToScalar(y + TILE_SIZE));
+    canvas->drawRect(rect, paint);
+}
+
+PictureSetTiles::Tile* PictureSetTiles::find(int x, int y)
+{
+    Tile* last = mTiles.end();
+    for (Tile* working = mTiles.begin(); working != last; working++) {
+        if (working->mX == x && working->mY == y)
+            return working;
+    }
+    return 0;
+}
+
+void PictureSetTiles::inval(const SkRegion& area)
+{
+    MutexLocker locker(mMutex);
+    if (area.isEmpty() || !mScale)
+        return;
+    SkScalar scale = mScale;
+    Tile* last = mTiles.end();
+    for (Tile* working = mTiles.begin(); working != last; working++) {
+        if (working->mGeneration != mGeneration)
+            continue;
+        SkRect tileBounds;
+        tileBounds.set(SkIntToScalar(working->mX * TILE_SIZE),
+            SkIntToScalar(working->mY * TILE_SIZE),
+            SkIntToScalar((working->mX + 1) * TILE_SIZE),
+            SkIntToScalar((working->mY + 1) * TILE_SIZE));
+        SkRect contentBounds;
+        contentBounds.set(SkScalarDiv(tileBounds.fLeft, scale),
+            SkScalarDiv(tileBounds.fTop, scale),
+            SkScalarDiv(tileBounds.fRight, scale),
+            SkScalarDiv(tileBounds.fBottom, scale));
+        SkIRect bounds;
+        contentBounds.roundOut(&bounds);
+        bounds.inset(-1, -1); // antialiased edges bleed into the neighbor
+        if (area.intersects(bounds)) {
+            DBG_SET_LOGD("%p stale tile (%d,%d)", this, working->mX, working->mY);
+            working->mDirty = true;
+        }
+    }
+}
+
+// Returns the tile at (x, y), reusing the least recently drawn tile once the
+// cache is full. Tiles already used this frame are never reused. A new tile
+// has no pixels until the render task hands it its first bitmap.
+PictureSetTiles::Tile* PictureSetTiles::obtain(int x, int y)
+{
+    Tile* tile = find(x, y);
+    if (!tile) {
+        if (mTiles.size() >= MAX_TILES) {
+            Tile* last = mTiles.end();
+            for (Tile* working = mTiles.begin(); working != last; working++) {
+                if (working->mLastUsed == mFrame)
+                    continue;
+                if (!tile || working->mLastUsed < tile->mLastUsed)
+                    tile = working;
+            }
+            if (!tile)
+                return 0;
+        } else {
+            mTiles.append(Tile());
+            tile = &mTiles.last();
+        }
+        tile->mX = x;
+        tile->mY = y;
+        tile->mGeneration = 0;
+        tile->mDirty = false;
+        tile->mQueued = false;
+        tile->mPreview = false;
+    }
+    tile->mLastUsed = mFrame;
+    return tile;
+}
+
+void PictureSetTiles::queue(Tile* tile)
+{
+    if (tile->mQueued)
+        return;
+    if (tile->mGeneration == mGeneration && !tile->mDirty && !tile->mPreview)
+        return;
+    // the render task already has it, with content at least this new
+    if (mRenderingGeneration == mGeneration && !tile->mDirty
+            && !tile->mPreview
+            && mRenderingX == tile->mX && mRenderingY == tile->mY)
+        return;
+    tile->mQueued = true;
+    Request request = { tile->mX, tile->mY };
+    mRequests.append(request);
+}
+
+bool PictureSetTiles::renderNext()
+{
+    mMutex.lock();
+    if (mQuit || mRequests.isEmpty()) {
+        mRenderScheduled = false;
+        mCondition.signal();
+        mMutex.unlock();
+        return false;
+    }
+    Request request = mRequests[0];
+    mRequests.remove(0);
+    Tile* tile = find(request.mX, request.mY);
+    if (!tile || !tile->mQueued) {
+        mMutex.unlock();
+        return true;
+    }
+    // a tile with no pixels yet gets a cheap preview first; the full
+    // rendering is queued behind the previews of the other requested tiles
+    bool preview = mPreview && tile->mGeneration != mGeneration;
+    tile->mQueued = preview;
+    if (preview)
+        mRequests.append(request);
+    tile->mDirty = false; // invals that arrive while rendering set this again
+    mRenderingX = request.mX;
+    mRenderingY = request.mY;
+    uint32_t generation = mRenderingGeneration = mGeneration;
+    PictureSet content(mContent);
+    SkScalar scale = mScale;
+    SkColor background = mBackground;
+    SkBitmap::Config config = mConfig;
+    mMutex.unlock();
+    SkBitmap& scratch = preview ? mPreviewScratch : mScratch;
+    int size = preview ? PREVIEW_SIZE : TILE_SIZE;
+    if (scratch.config() != config || scratch.width() != size
+            || !scratch.getPixels()) {
+        scratch.setConfig(config, size, size);
+        if (!scratch.allocPixels()) {
+            MutexLocker locker(mMutex);
+            mRenderingGeneration = 0;
+            return true;
+        }
+        if (config == SkBitmap::kRGB_565_Config)
+            scratch.setIsOpaque(true);
+    }
+    DBG_SET_LOGD("%p tile=(%d,%d) scale=%g preview=%d", this, request.mX,
+        request.mY, SkScalarToFloat(scale), preview);
+    scratch.eraseColor(background);
+    SkCanvas canvas(scratch);
+    PreviewDrawFilter previewFilter;
+    if (preview) {
+        SkScalar reduce = SkScalarDiv(SkIntToScalar(PREVIEW_SIZE),
+            SkIntToScalar(TILE_SIZE));
+        canvas.scale(reduce, reduce);
+        canvas.setDrawFilter(&previewFilter);
+    }
+    canvas.translate(SkIntToScalar(-request.mX * TILE_SIZE),
+        SkIntToScalar(-request.mY * TILE_SIZE));
+    canvas.scale(scale, scale);
+    bool tookTooLong = content.draw(&canvas);
+    canvas.setDrawFilter(0);
+    SkRect contentBounds;
+    contentBounds.set(SkScalarDiv(SkIntToScalar(request.mX * TILE_SIZE), scale),
+        SkScalarDiv(SkIntToScalar(request.mY * TILE_SIZE), scale),
+        SkScalarDiv(SkIntToScalar((request.mX + 1) * TILE_SIZE), scale),
+        SkScalarDiv(SkIntToScalar((request.mY + 1) * TILE_SIZE), scale));
+    SkIRect bounds;
+    contentBounds.roundOut(&bounds);
+    mMutex.lock();
+    mRenderingGeneration = 0;
+    tile = find(request.mX, request.mY);
+    bool ready = tile && generation == mGeneration
+        && scratch.config() == mConfig && (!preview || tile->mPreview
+        || tile->mGeneration != generation);
+    if (ready) {
+        tile->mBitmap.swap(scratch);
+        tile->mGeneration = generation;
+        tile->mPreview = preview;
+    }
+    if (!preview)
+        mTookTooLong |= tookTooLong;
+    mMutex.unlock();
+    if (ready && mReadyCallback)
+        mReadyCallback(mReadyContext, bounds);
+    return true;
+}
+
+void PictureSetTiles::setPreview(bool enabled)
+{
+    MutexLocker locker(mMutex);
+    mPreview = enabled;
+}
+
+// Waits for the render task to finish; no ready callbacks follow.
+void PictureSetTiles::stop()
+{
+    MutexLocker locker(mMutex);
+    mQuit = true;
+    while (mRenderScheduled)
+        mCondition.wait(mMutex);
+}
+
+// Renders until no requests are left. The pool's threads never exit, so
+// the ready callback attaching one to the Java VM needs no detach.
+void PictureSetTiles::renderTiles(void* data)
+{
+    PictureSetTiles* tiles = static_cast<PictureSetTiles*>(data);
+    while (tiles->renderNext())
+        ;
+}
+
+// Estimates the scroll velocity from how far the content origin moved
+// between frames; a positive velocity scrolls towards the bottom right.
+void PictureSetTiles::trackScroll(int originX, int originY)
+{
+    SkMSec now = SkTime::GetMSecs();
+    SkMSec elapsed = now - mLastScrollTime;
+    if (mLastScrollTime && elapsed > 0 && elapsed < MAX_SCROLL_INTERVAL) {
+        int velocityX = (mLastOriginX - originX) * 1000 / (int) elapsed;
+        int velocityY = (mLastOriginY - originY) * 1000 / (int) elapsed;
+        mVelocityX = (mVelocityX + velocityX) >> 1;
+        mVelocityY = (mVelocityY + velocityY) >> 1;
+    } else
+        mVelocityX = mVelocityY = 0;
+    mLastScrollTime = now;
+    mLastOriginX = originX;
+    mLastOriginY = originY;
+}
+
 } /* namespace android */
@@ -18,7 +18,12 @@
 #endif
 
 #include "jni.h"
+#include "SkBitmap.h"
+#include "SkColor.h"
+#include "SkRefCnt.h"
 #include "SkRegion.h"
+#include "SkTime.h"
+#include <wtf/Threading.h>
 #include <wtf/Vector.h>
 
 class SkCanvas;
@@ -35,7 +40,9 @@ namespace android {
         void add(const SkRegion& area, SkPicture* picture,
             uint32_t elapsed, bool split) 
         {
+            uint32_t invalCount = countInval(area);
             add(area, picture, elapsed, split, emptyPicture(picture));
+            mPictures.last().mInvalCount = invalCount;
         }
         void add(const SkRegion& area, SkPicture* picture,
             uint32_t elapsed, bool split, bool empty);
@@ -46,6 +53,9 @@ namespace android {
         void checkDimensions(int width, int height, SkRegion* inval);
         void clear();
         bool draw(SkCanvas* );
+        // bytes the pictures take when serialized; walks every picture, so
+        // it is only meant for diagnostics
+        size_t flattenedSize() const;
         static PictureSet* GetNativePictureSet(JNIEnv* env, jobject jpic);
         int height() const { return mHeight; }
         bool isEmpty() const; // returns true if empty or only trivial content
@@ -53,8 +63,16 @@ namespace android {
         void set(const PictureSet& );
         void setDrawTimes(const PictureSet& );
         void setPicture(size_t i, SkPicture* p);
+        // thresholds for split(): pictures slower than maxDrawTime (msec)
+        // or invalidated hotInvalCount times are subdivided, and unsplit
+        // pictures faster than mergeDrawTime are merged together
+        void setSplitPolicy(uint32_t maxDrawTime, uint32_t mergeDrawTime,
+            uint32_t hotInvalCount);
         size_t size() const { return mPictures.size(); }
         void split(PictureSet* result) const;
+        // true if split() would merge or subdivide for reasons other than
+        // draw time, e.g. fragmentation or a frequently invalidated picture
+        bool wantsSplit() const;
         bool upToDate(size_t i) const { return mPictures[i].mPicture != NULL; }
         int width() const { return mWidth; }
         void dump(const char* label) const;
@@ -66,15 +84,123 @@ namespace android {
             SkPicture* mPicture;
             SkIRect mUnsplit;
             uint32_t mElapsed;
+            uint32_t mInvalCount; // times this area has been redrawn
             bool mSplit : 8;
             bool mWroteElapsed : 8;
             bool mBase : 8; // true if nothing is drawn underneath this
             bool mEmpty : 8; // true if the picture only draws white
         };
         void add(const Pictures* temp);
+        uint32_t countInval(const SkRegion& area);
+        bool isHot(const Pictures& ) const;
         WTF::Vector<Pictures> mPictures;
         int mHeight;
         int mWidth;
+        uint32_t mMaxDrawTime;
+        uint32_t mMergeDrawTime;
+        uint32_t mHotInvalCount;
+    };
+
+    // A PictureSet published by the WebCore thread for the UI thread to draw
+    // without copying. Once published its areas and pictures don't change;
+    // only the draw times are written, by the UI thread.
+    class PictureSetSnapshot : public SkRefCnt {
+    public:
+        explicit PictureSetSnapshot(const PictureSet& src, uint32_t traceId = 0)
+            : mContent(src), mTraceId(traceId) {}
+        PictureSet& content() { return mContent; }
+        // the TraceBuffer id of the update that produced this content
+        uint32_t traceId() const { return mTraceId; }
+    private:
+        PictureSet mContent;
+        uint32_t mTraceId;
+    };
+
+    // Rasterizes a PictureSet into fixed-size bitmap tiles, so that the UI
+    // thread only composites bitmaps. Tiles are keyed by the scale they were
+    // rendered at and by the invalidation generation. Stale and missing
+    // tiles, plus the tiles just ahead of the current scroll direction, are
+    // rendered in the background, one at a time; until a tile is ready the UI draws a
+    // checkerboard (or the tile's stale pixels if the scale is unchanged).
+    class PictureSetTiles {
+    public:
+        // called from a background thread when a tile is ready; the bounds
+        // are in content coordinates
+        typedef void (*ReadyCallback)(void* context, const SkIRect& bounds);
+        PictureSetTiles();
+        ~PictureSetTiles();
+        void clear();
+        // draws content through the tiles. Returns false if the canvas
+        // can't be tiled (e.g. rotated, or mid-zoom); in that case the
+        // caller draws the PictureSet directly.
+        bool draw(SkCanvas* , PictureSetSnapshot* content, SkColor background,
+            bool* tookTooLong);
+        // marks tiles intersecting the area (in content coordinates) stale
+        void inval(const SkRegion& area);
+        // while enabled, tiles without pixels are first rendered at low
+        // resolution, without antialiasing or images, then upgraded
+        void setPreview(bool enabled);
+        // frees the tiles that weren't drawn in the last frame, and the
+        // render task's bitmaps while it is idle. Returns the bytes freed.
+        size_t discardOffscreen();
+        void setReadyCallback(ReadyCallback callback, void* context) {
+            mReadyCallback = callback;
+            mReadyContext = context;
+        }
+        void stop();
+    private:
+        struct Tile {
+            SkBitmap mBitmap;
+            int mX; // tile column
+            int mY; // tile row
+            uint32_t mGeneration; // generation the bitmap was rendered at
+            uint32_t mLastUsed; // frame the tile was last drawn
+            bool mDirty; // content under the tile changed since rendering
+            bool mQueued; // waiting for the render task
+            bool mPreview; // mBitmap is a low resolution placeholder
+        };
+        struct Request {
+            int mX;
+            int mY;
+        };
+        void drawCheckerboard(SkCanvas* , int x, int y);
+        Tile* find(int x, int y);
+        Tile* obtain(int x, int y);
+        void queue(Tile* );
+        bool renderNext();
+        static void renderTiles(void* );
+        void trackScroll(int originX, int originY);
+        WTF::Vector<Tile> mTiles;
+        WTF::Vector<Request> mRequests; // visible tiles first, then prefetch
+        PictureSet mContent; // copy for the render task
+        PictureSetSnapshot* mContentSource; // what mContent was copied from
+        SkBitmap mScratch; // render task's target; swapped into a tile
+        SkBitmap mPreviewScratch; // same, for low resolution tiles
+        SkBitmap mChecker;
+        Mutex mMutex; // guards everything shared with the render task
+        ThreadCondition mCondition; // signaled when the render task ends
+        bool mRenderScheduled; // renderTiles is queued or running
+        ReadyCallback mReadyCallback;
+        void* mReadyContext;
+        SkBitmap::Config mConfig;
+        SkColor mBackground;
+        SkScalar mScale;
+        SkScalar mPendingScale; // scale seen last frame, not yet cached
+        SkMSec mLastScrollTime;
+        uint32_t mFrame;
+        uint32_t mGeneration;
+        int mContentWidth;
+        int mContentHeight;
+        int mLastOriginX;
+        int mLastOriginY;
+        int mVelocityX; // device pixels per second, smoothed
+        int mVelocityY;
+        int mRenderingX; // the tile the render task is working on
+        int mRenderingY;
+        uint32_t mRenderingGeneration; // zero when idle
+        bool mPreview;
+        bool mQuit;
+        bool mTookTooLong;
     };
 }
 
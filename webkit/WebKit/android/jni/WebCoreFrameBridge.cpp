@@ -40,6 +40,7 @@
 #include "Page.h"
 #include "PageCache.h"
 #include "PlatformString.h"
+#include "RenderArena.h"
 #include "RenderPart.h"
 #include "RenderSkinAndroid.h"
 #include "RenderTreeAsText.h"
@@ -69,7 +70,9 @@
 #include <utils/misc.h>
 #include <utils/AssetManager.h>
 #include <wtf/CurrentTime.h>
+#include <wtf/FastMalloc.h>
 #include <wtf/Platform.h>
+#include <wtf/SlabAllocator.h>
 
 #if USE(JSC)
 #include "GCController.h"
@@ -87,6 +90,7 @@
 #ifdef ANDROID_INSTRUMENT
 #include "TimeCounter.h"
 #endif
+#include "TraceBuffer.h"
 
 using namespace JSC::Bindings;
 
@@ -343,6 +347,7 @@ WebFrame::startLoadingResource(WebCore::ResourceHandle* loader,
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: startLoadingResource(%p, %s)",
             loader, request.url().string().latin1().data());
 
@@ -473,8 +478,12 @@ WebFrame::startLoadingResource(WebCore::ResourceHandle* loader,
         return NULL;
 
     PassRefPtr<WebCore::ResourceLoaderAndroid> h;
-    if (jLoadListener)
+    if (jLoadListener) {
         h = WebCoreResourceLoader::create(env, jLoadListener);
+        // Main resources and synchronous loads keep the network default
+        if (!mainResource && !synchronous)
+            h->setPriority(request.priority(), request.isRenderBlocking());
+    }
     env->DeleteLocalRef(jLoadListener);
     return h;
 }
@@ -486,6 +495,7 @@ WebFrame::reportError(int errorCode, const WebCore::String& description,
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: reportError(%d, %s)", errorCode, description.ascii().data());
     JNIEnv* env = getJNIEnv();
 
@@ -503,6 +513,7 @@ WebFrame::loadStarted(WebCore::Frame* frame)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     // activeDocumentLoader() can return null.
     DocumentLoader* documentLoader = frame->loader()->activeDocumentLoader();
     if (documentLoader == NULL)
@@ -559,6 +570,7 @@ WebFrame::transitionToCommitted(WebCore::Frame* frame)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     WebCore::FrameLoadType loadType = frame->loader()->loadType();
     bool isMainFrame = (!frame->tree() || !frame->tree()->parent());
@@ -573,6 +585,7 @@ WebFrame::didFinishLoad(WebCore::Frame* frame)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
 
     // activeDocumentLoader() can return null.
@@ -602,6 +615,7 @@ WebFrame::addHistoryItem(WebCore::HistoryItem* item)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: addHistoryItem");
     JNIEnv* env = getJNIEnv();
     WebHistory::AddItem(mJavaFrame->history(env), item);
@@ -613,6 +627,7 @@ WebFrame::removeHistoryItem(int index)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: removeHistoryItem at %d", index);
     JNIEnv* env = getJNIEnv();
     WebHistory::RemoveItem(mJavaFrame->history(env), index);
@@ -624,6 +639,7 @@ WebFrame::updateHistoryIndex(int newIndex)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: updateHistoryIndex to %d", newIndex);
     JNIEnv* env = getJNIEnv();
     WebHistory::UpdateHistoryIndex(mJavaFrame->history(env), newIndex);
@@ -635,6 +651,7 @@ WebFrame::setTitle(const WebCore::String& title)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
 #ifndef NDEBUG
     LOGV("setTitle(%s)", title.ascii().data());
 #endif
@@ -653,6 +670,7 @@ WebFrame::windowObjectCleared(WebCore::Frame* frame)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOGV("::WebCore:: windowObjectCleared");
     JNIEnv* env = getJNIEnv();
 
@@ -666,6 +684,7 @@ WebFrame::setProgress(float newProgress)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     int progress = (int) (100 * newProgress);
     env->CallVoidMethod(mJavaFrame->frame(env).get(), mJavaFrame->mSetProgress, progress);
@@ -684,6 +703,7 @@ WebFrame::didReceiveIcon(WebCore::Image* icon)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     LOG_ASSERT(icon, "DidReceiveIcon called without an image!");
     JNIEnv* env = getJNIEnv();
     jobject bitmap = webcoreImageToJavaBitmap(env, icon);
@@ -701,6 +721,7 @@ WebFrame::didReceiveTouchIconURL(const WebCore::String& url, bool precomposed)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     jstring jUrlStr = env->NewString((unsigned short*)url.characters(),
             url.length());
@@ -716,6 +737,7 @@ WebFrame::updateVisitedHistory(const WebCore::KURL& url, bool reload)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     WebCore::String urlStr(url.string());
     JNIEnv* env = getJNIEnv();
     jstring jUrlStr = env->NewString((unsigned short*)urlStr.characters(), urlStr.length());
@@ -730,6 +752,7 @@ WebFrame::canHandleRequest(const WebCore::ResourceRequest& request)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     // always handle "POST" in place
     if (equalIgnoringCase(request.httpMethod(), "POST"))
         return true;
@@ -759,6 +782,7 @@ WebFrame::createWindow(bool dialog, bool userGesture)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     jobject obj = env->CallObjectMethod(mJavaFrame->frame(env).get(),
             mJavaFrame->mCreateWindow, dialog, userGesture);
@@ -775,6 +799,7 @@ WebFrame::requestFocus() const
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     env->CallVoidMethod(mJavaFrame->frame(env).get(), mJavaFrame->mRequestFocus);
     checkException(env);
@@ -786,6 +811,7 @@ WebFrame::closeWindow(WebViewCore* webViewCore)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     assert(webViewCore);
     JNIEnv* env = getJNIEnv();
     env->CallVoidMethod(mJavaFrame->frame(env).get(), mJavaFrame->mCloseWindow,
@@ -802,6 +828,7 @@ WebFrame::decidePolicyForFormResubmission(WebCore::FramePolicyFunction func)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::JavaCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::JavaCallbackTrace);
     JNIEnv* env = getJNIEnv();
     PolicyFunctionWrapper* p = new PolicyFunctionWrapper;
     p->func = func;
@@ -833,6 +860,7 @@ static void CallPolicyFunction(JNIEnv* env, jobject obj, jint func, jint decisio
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeCallPolicyFunction must take a valid frame pointer!");
     PolicyFunctionWrapper* pFunc = (PolicyFunctionWrapper*)func;
@@ -847,6 +875,7 @@ static void CallPolicyFunction(JNIEnv* env, jobject obj, jint func, jint decisio
 
 static void CreateFrame(JNIEnv* env, jobject obj, jobject javaview, jobject jAssetManager, jobject historyList)
 {
+    waitForWarmUp();
     ScriptController::initializeThreading();
 
 #ifdef ANDROID_INSTRUMENT
@@ -935,6 +964,7 @@ static void DestroyFrame(JNIEnv* env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeDestroyFrame must take a valid frame pointer!");
 
@@ -962,6 +992,7 @@ static void LoadUrl(JNIEnv *env, jobject obj, jstring url, jobject headers)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeLoadUrl must take a valid frame pointer!");
 
@@ -1016,6 +1047,7 @@ static void PostUrl(JNIEnv *env, jobject obj, jstring url, jbyteArray postData)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativePostUrl must take a valid frame pointer!");
 
@@ -1046,6 +1078,7 @@ static void LoadData(JNIEnv *env, jobject obj, jstring baseUrl, jstring data,
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeLoadData must take a valid frame pointer!");
 
@@ -1073,6 +1106,7 @@ static void StopLoading(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeStopLoading must take a valid frame pointer!");
     LOGV("::WebCore:: stopLoading %p", pFrame);
@@ -1086,6 +1120,7 @@ static jstring ExternalRepresentation(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "android_webcore_nativeExternalRepresentation must take a valid frame pointer!");
 
@@ -1102,6 +1137,7 @@ static jstring DocumentAsText(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "android_webcore_nativeDocumentAsText must take a valid frame pointer!");
 
@@ -1121,6 +1157,7 @@ static void Reload(JNIEnv *env, jobject obj, jboolean allowStale)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeReload must take a valid frame pointer!");
 
@@ -1141,6 +1178,7 @@ static void GoBackOrForward(JNIEnv *env, jobject obj, jint pos)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "nativeGoBackOrForward must take a valid frame pointer!");
 
@@ -1157,6 +1195,7 @@ static jobject StringByEvaluatingJavaScriptFromString(JNIEnv *env, jobject obj,
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "stringByEvaluatingJavaScriptFromString must take a valid frame pointer!");
 
@@ -1263,6 +1302,7 @@ static void AddJavascriptInterface(JNIEnv *env, jobject obj, jint nativeFramePoi
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = 0;
     if (nativeFramePointer == 0)
         pFrame = GET_NATIVE_FRAME(env, obj);
@@ -1325,6 +1365,7 @@ static void SetCacheDisabled(JNIEnv *env, jobject obj, jboolean disabled)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::cache()->setDisabled(disabled);
 }
 
@@ -1333,6 +1374,7 @@ static jboolean CacheDisabled(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     return WebCore::cache()->disabled();
 }
 
@@ -1348,6 +1390,13 @@ static void ClearCache(JNIEnv *env, jobject obj)
 #endif  // USE(JSC)           
     LOGD("About to clear cache and current cache has %d bytes live and %d bytes dead", 
             cache()->getLiveSize(), cache()->getDeadSize());
+    WTF::FastMallocStatistics mallocStatistics = WTF::fastMallocStatistics();
+    LOGD("FastMalloc heap is %d bytes with %d bytes free, %d bytes in caches and %d bytes returned",
+            mallocStatistics.heapSize, mallocStatistics.freeSizeInHeap,
+            mallocStatistics.freeSizeInCaches, mallocStatistics.returnedSize);
+    WTF::SlabAllocatorStatistics slabStatistics = WTF::slabAllocatorStatistics();
+    LOGD("Slab allocator has %d live objects using %d of %d bytes",
+            slabStatistics.liveObjects, slabStatistics.liveBytes, slabStatistics.slabBytes);
 #endif  // ANDROID_INSTRUMENT
     if (!WebCore::cache()->disabled()) {
         // Disabling the cache will remove all resources from the cache.  They may
@@ -1363,6 +1412,14 @@ static void ClearCache(JNIEnv *env, jobject obj)
     WebCore::pageCache()->releaseAutoreleasedPagesNow();
     WebCore::pageCache()->setCapacity(pageCapacity);
 
+    // The render arenas of the pages just dropped only went to the arena
+    // free list.
+    WebCore::RenderArena::releaseFreeArenas();
+
+    // Hand the pages freed above back to the system now rather than
+    // waiting for the FastMalloc scavenger thread.
+    WTF::releaseFastMallocFreeMemory();
+
 #if USE(JSC)    
     // force JavaScript to GC when clear cache
     WebCore::gcController().garbageCollectSoon();
@@ -1377,6 +1434,7 @@ static jboolean DocumentHasImages(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "DocumentHasImages must take a valid frame pointer!");
 
@@ -1388,6 +1446,7 @@ static jboolean HasPasswordField(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "HasPasswordField must take a valid frame pointer!");
 
@@ -1419,6 +1478,7 @@ static jobjectArray GetUsernamePassword(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "GetUsernamePassword must take a valid frame pointer!");
     jobjectArray strArray = NULL;
@@ -1465,6 +1525,7 @@ static void SetUsernamePassword(JNIEnv *env, jobject obj,
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "SetUsernamePassword must take a valid frame pointer!");
 
@@ -1505,6 +1566,7 @@ static jobject GetFormTextData(JNIEnv *env, jobject obj)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOG_ASSERT(pFrame, "GetFormTextData must take a valid frame pointer!");
     jobject hashMap = NULL;
@@ -1563,6 +1625,7 @@ static void OrientationChanged(JNIEnv *env, jobject obj, int orientation)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::NativeCallbackTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::NativeCallbackTrace);
     WebCore::Frame* pFrame = GET_NATIVE_FRAME(env, obj);
     LOGV("Sending orientation: %d", orientation);
     pFrame->sendOrientationChangeEvent(orientation);
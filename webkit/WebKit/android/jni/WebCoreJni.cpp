@@ -44,4 +44,17 @@ WebCore::String to_string(JNIEnv* env, jstring str)
     return ret;
 }
 
+WebCore::AtomicString to_atomic_string(JNIEnv* env, jstring str)
+{
+    if (!str || !env)
+        return WebCore::AtomicString();
+    const jchar* s = env->GetStringChars(str, NULL);
+    if (!s)
+        return WebCore::AtomicString();
+    WebCore::AtomicString ret(s, env->GetStringLength(str));
+    env->ReleaseStringChars(str, s);
+    checkException(env);
+    return ret;
+}
+
 }
@@ -3,6 +3,7 @@
 #ifndef ANDROID_WEBKIT_WEBCOREJNI_H
 #define ANDROID_WEBKIT_WEBCOREJNI_H
 
+#include "AtomicString.h"
 #include "PlatformString.h"
 #include <jni.h>
 
@@ -49,6 +50,15 @@ bool checkException(JNIEnv* env);
 // Create a WebCore::String object from a jstring object.
 WebCore::String to_string(JNIEnv* env, jstring str);
 
+// Create a WebCore::AtomicString from a jstring object. Unlike converting the
+// result of to_string, this doesn't allocate a string if one with the same
+// characters is already interned.
+WebCore::AtomicString to_atomic_string(JNIEnv* env, jstring str);
+
+// Blocks until the work JNI_OnLoad started in the background is done. Has to
+// be called before the WebCore thread first uses WebCore.
+void waitForWarmUp();
+
 }
 
 #endif
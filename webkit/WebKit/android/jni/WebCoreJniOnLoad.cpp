@@ -5,6 +5,8 @@
 #include "config.h"
 
 #include "BackForwardList.h"
+#include "Cache.h"
+#include "CString.h"
 #include "ChromeClientAndroid.h"
 #include "ContextMenuClientAndroid.h"
 #include "CookieClient.h"
@@ -15,10 +17,16 @@
 #include "FrameLoaderClientAndroid.h"
 #include "FrameView.h"
 #include "GraphicsContext.h"
+#if USE(ACCELERATED_COMPOSITING)
+#include "GraphicsLayerAndroid.h"
+#endif
 #include "HistoryItem.h"
 #include "InspectorClientAndroid.h"
 #include "IntRect.h"
 #include "JavaSharedClient.h"
+#if USE(ACCELERATED_COMPOSITING)
+#include "LayerAndroid.h"
+#endif
 #include "Page.h"
 #include "PlatformGraphicsContext.h"
 #include "ResourceRequest.h"
@@ -30,9 +38,17 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkImageEncoder.h"
+#include "SkPicture.h"
+#include "SkRegion.h"
+#include "SkTypeface.h"
 #include "SubstituteData.h"
 #include "TimerClient.h"
+#include "TextBreakIteratorInternalICU.h"
 #include "TextEncoding.h"
+#ifdef ANDROID_INSTRUMENT
+#include "TimeCounter.h"
+#endif
+#include "WebCoreJni.h"
 #include "WebCoreViewBridge.h"
 #include "WebFrameView.h"
 #include "WebViewCore.h"
@@ -40,8 +56,18 @@
 #include "benchmark/MyJavaVM.h"
 
 #include <JNIUtility.h>
+#include <algorithm>
+#include <cutils/properties.h>
 #include <jni.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <unicode/ubrk.h>
+#include <unicode/ucnv.h>
 #include <utils/Log.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 namespace android {
 
@@ -76,20 +102,91 @@ static RegistrationMethod gWebCoreRegMethods[] = {
     { "WebCoreResourceLoader", android::register_resource_loader },
     { "WebViewCore", android::register_webviewcore },
     { "WebHistory", android::register_webhistory },
-    { "WebIconDatabase", android::register_webicondatabase },
     { "WebSettings", android::register_websettings },
-#if ENABLE(DATABASE)
-    { "WebStorage", android::register_webstorage },
-#endif
     { "WebView", android::register_webview },
-    { "GeolocationPermissions", android::register_geolocation_permissions },
-    { "MockGeolocation", android::register_mock_geolocation },
 #if ENABLE(VIDEO)
     { "HTML5Audio", android::register_mediaplayer_audio },
     { "HTML5VideoViewProxy", android::register_mediaplayer_video },
 #endif
 };
 
+// Classes whose natives are only called from the WebCore thread once it is
+// running. They are registered in the background so that loading the
+// library doesn't wait for their classes to be loaded.
+static RegistrationMethod gWebCoreDeferredRegMethods[] = {
+    { "WebIconDatabase", android::register_webicondatabase },
+#if ENABLE(DATABASE)
+    { "WebStorage", android::register_webstorage },
+#endif
+    { "GeolocationPermissions", android::register_geolocation_permissions },
+    { "MockGeolocation", android::register_mock_geolocation },
+};
+
+static bool registerMethods(JNIEnv* env, const RegistrationMethod* methods, size_t count)
+{
+    for (const RegistrationMethod* method = methods; method != methods + count; ++method) {
+        if (method->func(env) < 0) {
+            LOGE("%s registration failed!", method->name);
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace android {
+
+static ThreadIdentifier sWarmUpThread;
+
+// Loads the system fonts and the ICU data for the common encodings and for
+// line breaking, which the first page needs and which can be loaded from
+// any thread. Strings, identifiers and qualified names are interned in
+// tables that belong to the thread creating them, so those are still made on
+// the WebCore thread.
+static void prewarm()
+{
+    if (SkTypeface* typeface = SkTypeface::CreateFromName(0, SkTypeface::kNormal))
+        typeface->unref();
+
+    UErrorCode status = U_ZERO_ERROR;
+    UConverter* converter = ucnv_open("windows-1252", &status);
+    if (U_SUCCESS(status))
+        ucnv_close(converter);
+
+    status = U_ZERO_ERROR;
+    UBreakIterator* iterator = ubrk_open(UBRK_LINE, WebCore::currentTextBreakLocaleID(), 0, 0, &status);
+    if (U_SUCCESS(status))
+        ubrk_close(iterator);
+}
+
+static void* warmUp(void*)
+{
+    JavaVM* vm = JSC::Bindings::getJavaVM();
+    JNIEnv* env = 0;
+    if (vm->AttachCurrentThread(&env, 0) != JNI_OK) {
+        LOGE("Could not attach the warm up thread!");
+        return 0;
+    }
+    registerMethods(env, gWebCoreDeferredRegMethods, sizeof(gWebCoreDeferredRegMethods) / sizeof(RegistrationMethod));
+    vm->DetachCurrentThread();
+
+    // Set webcore.prewarm to 0 to leave everything to the first page.
+    char value[PROPERTY_VALUE_MAX];
+    property_get("webcore.prewarm", value, "1");
+    if (strcmp(value, "0"))
+        prewarm();
+    return 0;
+}
+
+void waitForWarmUp()
+{
+    if (!sWarmUpThread)
+        return;
+    waitForThreadCompletion(sWarmUpThread, 0);
+    sWarmUpThread = 0;
+}
+
+}
+
 EXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
 {
     // Save the JavaVM pointer for use globally.
@@ -104,15 +201,13 @@ EXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
     }
     LOG_ASSERT(env, "Could not retrieve the env!");
 
-    const RegistrationMethod* method = gWebCoreRegMethods;
-    const RegistrationMethod* end = method + sizeof(gWebCoreRegMethods)/sizeof(RegistrationMethod);
-    while (method != end) {
-        if (method->func(env) < 0) {
-            LOGE("%s registration failed!", method->name);
-            return result;
-        }
-        method++;
-    }
+    if (!registerMethods(env, gWebCoreRegMethods, sizeof(gWebCoreRegMethods) / sizeof(RegistrationMethod)))
+        return result;
+
+    android::sWarmUpThread = createThread(android::warmUp, 0, "WebCoreWarmUp");
+    if (!android::sWarmUpThread && !registerMethods(env, gWebCoreDeferredRegMethods,
+            sizeof(gWebCoreDeferredRegMethods) / sizeof(RegistrationMethod)))
+        return result;
 
     // Initialize rand() function. The rand() function is used in
     // FileSystemAndroid to create a random temporary filename.
@@ -123,8 +218,11 @@ EXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved)
 
 class MyJavaSharedClient : public TimerClient, public CookieClient {
 public:
-    MyJavaSharedClient() : m_hasTimer(false) {}
-    virtual void setSharedTimer(long long timemillis) { m_hasTimer = true; }
+    MyJavaSharedClient() : m_hasTimer(false), m_fireTime(0) {}
+    virtual void setSharedTimer(long long timemillis) {
+        m_hasTimer = true;
+        m_fireTime = WTF::currentTime() + timemillis * 0.001;
+    }
     virtual void stopSharedTimer() { m_hasTimer = false; }
     virtual void setSharedTimerCallback(void (*f)()) { m_func = f; }
     virtual void signalServiceFuncPtrQueue() {}
@@ -135,6 +233,7 @@ public:
     virtual bool cookiesEnabled() { return false; }
 
     bool m_hasTimer;
+    double m_fireTime;
     void (*m_func)();
 };
 
@@ -145,7 +244,21 @@ static void historyItemChanged(HistoryItem* i) {
 
 namespace android {
 
-EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+// The page, frame and timer client that drive a load without the Java side.
+// WebViewCore, WebFrameView and MyWebFrame are owned by the page and frame.
+struct BenchmarkContext {
+    MyJavaSharedClient client;
+    Page* page;
+    RefPtr<Frame> frame;
+};
+
+static void initializeBenchmark()
+{
+    static bool initialized = false;
+    if (initialized)
+        return;
+    initialized = true;
+
     ScriptController::initializeThreading();
 
     // Setting this allows data: urls to load from a local file.
@@ -156,11 +269,16 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
 
     // The real function is private to libwebcore but we know what it does.
     notifyHistoryItemChanged = historyItemChanged;
+}
+
+static void createBenchmarkContext(BenchmarkContext* context, int width,
+        int height)
+{
+    initializeBenchmark();
 
     // Implement the shared timer callback
-    MyJavaSharedClient client;
-    JavaSharedClient::SetTimerClient(&client);
-    JavaSharedClient::SetCookieClient(&client);
+    JavaSharedClient::SetTimerClient(&context->client);
+    JavaSharedClient::SetCookieClient(&context->client);
 
     // Create the page with all the various clients
     ChromeClientAndroid* chrome = new ChromeClientAndroid;
@@ -173,6 +291,7 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
                           0, // PluginHalterClient
                           0); // GeolocationControllerClient
     editor->setPage(page);
+    context->page = page;
 
     // Create MyWebFrame that intercepts network requests
     MyWebFrame* webFrame = new MyWebFrame(page);
@@ -185,6 +304,7 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     FrameLoaderClientAndroid* loader = new FrameLoaderClientAndroid(webFrame);
     RefPtr<Frame> frame = Frame::create(page, NULL, loader);
     loader->setFrame(frame.get());
+    context->frame = frame;
 
     // Build our View system, resize it to the given dimensions and release our
     // references. Note: We keep a referenec to frameView so we can layout and
@@ -222,6 +342,45 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     s->setPluginsEnabled(false);
     s->setShrinksStandaloneImagesToFit(false);
     s->setUseWideViewport(false);
+}
+
+static void destroyBenchmarkContext(BenchmarkContext* context)
+{
+    // Tear down the world.
+    context->frame->loader()->detachFromParent();
+    context->frame = 0;
+    delete context->page;
+    JavaSharedClient::SetTimerClient(0);
+    JavaSharedClient::SetCookieClient(0);
+}
+
+// MyWebFrame answers every request from a timer, so a load has finished once
+// no timer is left pending.
+static void serviceTimers(MyJavaSharedClient& client)
+{
+    while (client.m_hasTimer) {
+        // sleep rather than spin until the timer is due, so that simulated
+        // network latency does not burn the CPU being measured
+        double delay = client.m_fireTime - WTF::currentTime();
+        if (delay > 0)
+            usleep(static_cast<useconds_t>(delay * 1000000));
+        client.m_func();
+        JavaSharedClient::ServiceFunctionPtrQueue();
+    }
+    JavaSharedClient::ServiceFunctionPtrQueue();
+}
+
+static void layoutAll(Frame* frame)
+{
+    while (frame->view()->needsLayout())
+        frame->view()->layout();
+    JavaSharedClient::ServiceFunctionPtrQueue();
+}
+
+EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+    BenchmarkContext context;
+    createBenchmarkContext(&context, width, height);
+    Frame* frame = context.frame.get();
 
     // Finally, load the actual data
     ResourceRequest req(url);
@@ -230,16 +389,10 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     do {
         // Layout the page and service the timer
         frame->view()->layout();
-        while (client.m_hasTimer) {
-            client.m_func();
-            JavaSharedClient::ServiceFunctionPtrQueue();
-        }
-        JavaSharedClient::ServiceFunctionPtrQueue();
+        serviceTimers(context.client);
 
         // Layout more if needed.
-        while (frame->view()->needsLayout())
-            frame->view()->layout();
-        JavaSharedClient::ServiceFunctionPtrQueue();
+        layoutAll(frame);
 
         if (reloadCount)
             frame->loader()->reload(true);
@@ -259,9 +412,427 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     enc->encodeFile("/sdcard/webcore_test.png", bmp, 100);
     delete enc;
 
-    // Tear down the world.
-    frame->loader()->detachFromParent();
-    delete page;
+    destroyBenchmarkContext(&context);
+}
+
+// Replays every load from the archive at path, paced by the named network
+// profile ("none", "edge", "3g" or "wifi"). Returns false if either is bad.
+EXPORT bool setBenchmarkArchive(const char* path, const char* profileName) {
+    const NetworkProfile* profile = NetworkProfile::find(profileName ? profileName : "none");
+    if (!profile) {
+        LOGE("Unknown network profile %s", profileName);
+        return false;
+    }
+    static NetworkArchive* archive = 0;
+    delete archive;
+    archive = new NetworkArchive;
+    if (!archive->load(path)) {
+        delete archive;
+        archive = 0;
+        MyResourceLoader::setArchive(0, 0);
+        return false;
+    }
+    MyResourceLoader::setArchive(archive, profile);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Suite runner
+
+enum BenchmarkPhase {
+    LoadPhase,      // request to last resource, including parse, style and JS
+    LayoutPhase,    // layout still pending once loading has finished
+    RecordPhase,    // painting the page into an SkPicture
+    DrawPhase,      // playing the picture back into a bitmap
+    BenchmarkPhaseCount
+};
+
+static const char* benchmarkPhaseNames[] = {
+    "load",
+    "layout",
+    "record",
+    "draw",
+};
+
+#ifdef ANDROID_INSTRUMENT
+// TimeCounter totals reported for each run, as name/counter pairs
+static const struct {
+    const char* name;
+    TimeCounter::Type type;
+} benchmarkCounters[] = {
+    { "parse", TimeCounter::ParsingTimeCounter },
+    { "css", TimeCounter::CSSParseTimeCounter },
+    { "style", TimeCounter::CalculateStyleTimeCounter },
+    { "layout", TimeCounter::LayoutTimeCounter },
+    { "javascript", TimeCounter::JavaScriptExecuteTimeCounter },
+};
+#endif
+
+struct BenchmarkRun {
+    bool cold;
+    double phases[BenchmarkPhaseCount];     // milliseconds
+#ifdef ANDROID_INSTRUMENT
+    uint32_t counters[sizeof(benchmarkCounters) / sizeof(benchmarkCounters[0])];
+#endif
+};
+
+struct BenchmarkEntry {
+    String name;
+    String url;
+};
+
+static double elapsedMs(double start)
+{
+    return (WTF::currentTime() - start) * 1000;
+}
+
+static void runBenchmarkPage(Frame* frame, MyJavaSharedClient& client,
+        const String& url, bool cold, int width, int height, BenchmarkRun* run)
+{
+    // dropping every resource from the memory cache makes this a first visit
+    if (cold) {
+        cache()->setDisabled(true);
+        cache()->setDisabled(false);
+    }
+    run->cold = cold;
+#ifdef ANDROID_INSTRUMENT
+    TimeCounter::reset();
+#endif
+
+    double start = WTF::currentTime();
+    frame->loader()->load(ResourceRequest(url), false);
+    frame->view()->layout();
+    serviceTimers(client);
+    run->phases[LoadPhase] = elapsedMs(start);
+
+    start = WTF::currentTime();
+    layoutAll(frame);
+    run->phases[LayoutPhase] = elapsedMs(start);
+
+    start = WTF::currentTime();
+    SkPicture picture;
+    SkCanvas* recordingCanvas = picture.beginRecording(width, height);
+    {
+        PlatformGraphicsContext ctx(recordingCanvas, NULL);
+        GraphicsContext gc(&ctx);
+        frame->view()->paintContents(&gc, IntRect(0, 0, width, height));
+    }
+    picture.endRecording();
+    run->phases[RecordPhase] = elapsedMs(start);
+
+    SkBitmap bmp;
+    bmp.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    bmp.allocPixels();
+    SkCanvas canvas(bmp);
+    start = WTF::currentTime();
+    canvas.drawPicture(picture);
+    run->phases[DrawPhase] = elapsedMs(start);
+
+#ifdef ANDROID_INSTRUMENT
+    for (size_t i = 0; i < sizeof(benchmarkCounters) / sizeof(benchmarkCounters[0]); i++)
+        run->counters[i] = TimeCounter::totalTime(benchmarkCounters[i].type);
+#endif
+}
+
+static bool readBenchmarkManifest(const char* path, Vector<BenchmarkEntry>* entries)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        LOGE("Could not open manifest %s", path);
+        return false;
+    }
+    // each line is "[name] url"; blank lines and lines starting with # are
+    // skipped
+    char line[2048];
+    while (fgets(line, sizeof(line), file)) {
+        String text = String(line).stripWhiteSpace();
+        if (text.isEmpty() || text[0] == '#')
+            continue;
+        BenchmarkEntry entry;
+        int space = text.find(' ');
+        if (space == -1)
+            space = text.find('\t');
+        if (space == -1) {
+            entry.name = text;
+            entry.url = text;
+        } else {
+            entry.name = text.left(space);
+            entry.url = text.substring(space + 1).stripWhiteSpace();
+        }
+        entries->append(entry);
+    }
+    fclose(file);
+    return true;
+}
+
+static void writeJSONString(FILE* out, const String& string)
+{
+    CString utf8 = string.utf8();
+    fputc('"', out);
+    for (const char* c = utf8.data(); *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fprintf(out, "\\%c", *c);
+        else if (static_cast<unsigned char>(*c) < 0x20)
+            fprintf(out, "\\u%04x", *c);
+        else
+            fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static void writeBenchmarkRun(FILE* out, const BenchmarkRun& run)
+{
+    fprintf(out, "{\"cold\":%s", run.cold ? "true" : "false");
+    for (int phase = 0; phase < BenchmarkPhaseCount; phase++)
+        fprintf(out, ",\"%s\":%.2f", benchmarkPhaseNames[phase], run.phases[phase]);
+#ifdef ANDROID_INSTRUMENT
+    fprintf(out, ",\"counters\":{");
+    for (size_t i = 0; i < sizeof(benchmarkCounters) / sizeof(benchmarkCounters[0]); i++)
+        fprintf(out, "%s\"%s\":%u", i ? "," : "", benchmarkCounters[i].name,
+                run.counters[i]);
+    fputc('}', out);
+#endif
+    fputc('}', out);
+}
+
+// Loads every page in the manifest once cold and then iterations times warm,
+// and writes the per-phase timings as JSON to output (stdout if NULL).
+// Returns 0 on success.
+EXPORT int benchmarkSuite(const char* manifest, int iterations, int width,
+        int height, const char* output) {
+    Vector<BenchmarkEntry> entries;
+    if (!readBenchmarkManifest(manifest, &entries))
+        return 1;
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        LOGE("Could not open %s for writing", output);
+        return 1;
+    }
+
+    BenchmarkContext context;
+    createBenchmarkContext(&context, width, height);
+    Frame* frame = context.frame.get();
+
+    fprintf(out, "{\"width\":%d,\"height\":%d,\"iterations\":%d,\"pages\":[",
+            width, height, iterations);
+    for (size_t i = 0; i < entries.size(); i++) {
+        const BenchmarkEntry& entry = entries[i];
+        LOGD("Benchmarking %s", entry.url.utf8().data());
+        fprintf(out, "%s{\"name\":", i ? "," : "");
+        writeJSONString(out, entry.name);
+        fprintf(out, ",\"url\":");
+        writeJSONString(out, entry.url);
+
+        Vector<BenchmarkRun> runs;
+        for (int n = 0; n <= iterations; n++) {
+            BenchmarkRun run;
+            runBenchmarkPage(frame, context.client, entry.url, !n, width,
+                    height, &run);
+            runs.append(run);
+        }
+
+        // medians of the warm runs are what regressions are judged on
+        fprintf(out, ",\"median\":{");
+        for (int phase = 0; phase < BenchmarkPhaseCount; phase++) {
+            Vector<double> values;
+            for (size_t n = 1; n < runs.size(); n++)
+                values.append(runs[n].phases[phase]);
+            if (values.isEmpty())
+                values.append(runs[0].phases[phase]);
+            std::sort(values.begin(), values.end());
+            fprintf(out, "%s\"%s\":%.2f", phase ? "," : "",
+                    benchmarkPhaseNames[phase], values[values.size() / 2]);
+        }
+        fprintf(out, "},\"runs\":[");
+        for (size_t n = 0; n < runs.size(); n++) {
+            if (n)
+                fputc(',', out);
+            writeBenchmarkRun(out, runs[n]);
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "]}\n");
+    if (out != stdout)
+        fclose(out);
+
+    destroyBenchmarkContext(&context);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scroll and zoom runner
+
+// One step of a scripted gesture: the content point at the top left of the
+// view, and the zoom it is drawn at.
+struct ScrollFrame {
+    float x;
+    float y;
+    float scale;
+};
+
+struct ScrollTiming {
+    double frame;       // milliseconds for the whole frame
+    double content;     // drawContent: the picture set and its tiles
+    double composite;   // drawing the layer tree on top
+};
+
+// 60fps; frames over this budget are reported as missed
+static const double kFrameBudgetMs = 1000.0 / 60;
+
+// Fills frames with the gestures the UI draw path is measured on: a scroll
+// from the top of the content to the bottom and back, then a zoom in from
+// 1x to 2x and out again around the top left of the view.
+static void buildScrollScript(int frames, int width, int height,
+        const SkIPoint& contentSize, Vector<ScrollFrame>* script)
+{
+    float maxY = contentSize.fY > height ? contentSize.fY - height : 0;
+    for (int i = 0; i <= frames; i++) {
+        ScrollFrame frame = { 0, maxY * i / frames, 1 };
+        script->append(frame);
+    }
+    for (int i = frames; i >= 0; i--) {
+        ScrollFrame frame = { 0, maxY * i / frames, 1 };
+        script->append(frame);
+    }
+    for (int i = 0; i <= frames; i++) {
+        ScrollFrame frame = { 0, 0, 1 + static_cast<float>(i) / frames };
+        script->append(frame);
+    }
+    for (int i = frames; i >= 0; i--) {
+        ScrollFrame frame = { 0, 0, 1 + static_cast<float>(i) / frames };
+        script->append(frame);
+    }
+}
+
+static double percentileMs(Vector<double> values, int percent)
+{
+    if (values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = (values.size() - 1) * percent / 100;
+    return values[index];
+}
+
+static void writeScrollDistribution(FILE* out, const char* name,
+        const Vector<double>& values)
+{
+    double total = 0;
+    for (size_t i = 0; i < values.size(); i++)
+        total += values[i];
+    fprintf(out, "\"%s\":{\"total\":%.2f,\"p50\":%.2f,\"p95\":%.2f,"
+            "\"max\":%.2f}", name, total, percentileMs(values, 50),
+            percentileMs(values, 95), percentileMs(values, 100));
+}
+
+// Loads url, records it the way WebViewCore does for the UI, and then plays
+// the picture set (and the layer tree, when compositing) into an offscreen
+// bitmap for every frame of a scripted scroll and zoom. Each gesture has
+// frames steps. Writes the frame time distribution, and how much of it was
+// content replay and layer compositing, as JSON to output (stdout if NULL).
+// Returns 0 on success.
+EXPORT int benchmarkScroll(const char* url, int frames, int width, int height,
+        const char* output) {
+    if (frames < 1)
+        frames = 1;
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        LOGE("Could not open %s for writing", output);
+        return 1;
+    }
+
+    BenchmarkContext context;
+    createBenchmarkContext(&context, width, height);
+    Frame* frame = context.frame.get();
+
+    frame->loader()->load(ResourceRequest(url), false);
+    frame->view()->layout();
+    serviceTimers(context.client);
+    layoutAll(frame);
+
+    WebViewCore* core = WebViewCore::getWebViewCore(frame->view());
+    SkRegion inval;
+    SkIPoint contentSize;
+    contentSize.set(width, height);
+    core->recordContent(&inval, &contentSize);
+
+#if USE(ACCELERATED_COMPOSITING)
+    // the UI thread draws its own copy of the tree, as it does here
+    LayerAndroid* rootLayer = 0;
+    GraphicsLayerAndroid* graphicsLayer = core->graphicsRootLayer();
+    if (graphicsLayer && graphicsLayer->contentLayer())
+        rootLayer = new LayerAndroid(*graphicsLayer->contentLayer());
+#endif
+
+    Vector<ScrollFrame> script;
+    buildScrollScript(frames, width, height, contentSize, &script);
+
+    SkBitmap bmp;
+    bmp.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    bmp.allocPixels();
+    SkCanvas canvas(bmp);
+
+    Vector<double> frameTimes;
+    Vector<double> contentTimes;
+    Vector<double> compositeTimes;
+    int missed = 0;
+    for (size_t i = 0; i < script.size(); i++) {
+        const ScrollFrame& step = script[i];
+        ScrollTiming timing;
+        double frameStart = WTF::currentTime();
+        int saveCount = canvas.save();
+        canvas.scale(SkFloatToScalar(step.scale), SkFloatToScalar(step.scale));
+        canvas.translate(SkFloatToScalar(-step.x), SkFloatToScalar(-step.y));
+        core->drawContent(&canvas, SK_ColorWHITE);
+        timing.content = elapsedMs(frameStart);
+
+        double start = WTF::currentTime();
+#if USE(ACCELERATED_COMPOSITING)
+        if (rootLayer) {
+            // the same steps as WebView::drawExtras
+            SkRect visible;
+            visible.set(SkFloatToScalar(step.x), SkFloatToScalar(step.y),
+                SkFloatToScalar(step.x + width / step.scale),
+                SkFloatToScalar(step.y + height / step.scale));
+            rootLayer->updateFixedLayersPositions(visible);
+            rootLayer->updatePositions();
+            SkAutoCanvasRestore restore(&canvas, true);
+            rootLayer->setMatrix(canvas.getTotalMatrix());
+            SkRegion covered;
+            rootLayer->computeOcclusion(&covered, 0);
+            canvas.resetMatrix();
+            rootLayer->draw(&canvas);
+        }
+#endif
+        timing.composite = elapsedMs(start);
+        canvas.restoreToCount(saveCount);
+        timing.frame = elapsedMs(frameStart);
+
+        frameTimes.append(timing.frame);
+        contentTimes.append(timing.content);
+        compositeTimes.append(timing.composite);
+        if (timing.frame > kFrameBudgetMs)
+            missed++;
+    }
+
+    fprintf(out, "{\"url\":");
+    writeJSONString(out, String(url));
+    fprintf(out, ",\"width\":%d,\"height\":%d,\"contentWidth\":%d,"
+            "\"contentHeight\":%d,\"frames\":%d,\"missed\":%d,", width, height,
+            contentSize.fX, contentSize.fY, static_cast<int>(frameTimes.size()), missed);
+    writeScrollDistribution(out, "frame", frameTimes);
+    fputc(',', out);
+    writeScrollDistribution(out, "content", contentTimes);
+    fputc(',', out);
+    writeScrollDistribution(out, "composite", compositeTimes);
+    fprintf(out, "}\n");
+    if (out != stdout)
+        fclose(out);
+
+#if USE(ACCELERATED_COMPOSITING)
+    delete rootLayer;
+#endif
+    destroyBenchmarkContext(&context);
+    return 0;
 }
 
 }  // namespace android
@@ -6,6 +6,7 @@
 #include "WebCoreResourceLoader.h"
 
 #include "CString.h"
+#include "CookieJarAndroid.h"
 #include "ResourceError.h"
 #include "ResourceHandle.h"
 #include "ResourceHandleClient.h"
@@ -16,6 +17,7 @@
 #include "TimeCounter.h"
 #endif
 #include "WebCoreJni.h"
+#include "benchmark/NetworkArchive.h"
 
 #include <JNIHelp.h>
 #include <JNIUtility.h>
@@ -34,10 +36,42 @@ static struct resourceloader_t {
     jmethodID   mDownloadFileMethodID;
     jmethodID   mWillLoadFromCacheMethodID;
     jmethodID   mPauseLoadMethodID;
+    jmethodID   mSetPriorityMethodID; // optional, may be 0
 } gResourceLoader;
 
 // ----------------------------------------------------------------------------
 
+// Names of the headers nearly every response has. They are kept interned so
+// that converting them from Java finds the existing string instead of
+// allocating a new one for each response.
+static const char* const gCommonHeaderNames[] = {
+    "accept-ranges", "age", "cache-control", "connection", "content-encoding",
+    "content-length", "content-type", "date", "etag", "expires",
+    "keep-alive", "last-modified", "location", "pragma", "server",
+    "set-cookie", "transfer-encoding", "vary", "x-powered-by"
+};
+
+static void internCommonHeaderNames()
+{
+    static WebCore::AtomicString* names = 0;
+    if (names)
+        return;
+    names = new WebCore::AtomicString[NELEM(gCommonHeaderNames)];
+    for (size_t index = 0; index < NELEM(gCommonHeaderNames); index++)
+        names[index] = gCommonHeaderNames[index];
+}
+
+static void setResponseHeader(JNIEnv* env, WebCore::ResourceResponse* response, jstring key, jstring val)
+{
+    // Check the length first so that empty values are dropped without
+    // converting either string.
+    if (!env->GetStringLength(val))
+        return;
+    response->setHTTPHeaderField(to_atomic_string(env, key), to_string(env, val));
+}
+
+// ----------------------------------------------------------------------------
+
 #define GET_NATIVE_HANDLE(env, obj) ((WebCore::ResourceHandle*)env->GetIntField(obj, gResourceLoader.mObject))
 #define SET_NATIVE_HANDLE(env, obj, handle) (env->SetIntField(obj, gResourceLoader.mObject, handle))
 
@@ -88,6 +122,17 @@ void WebCoreResourceLoader::pauseLoad(bool pause)
     checkException(env);
 }
 
+void WebCoreResourceLoader::setPriority(WebCore::ResourceRequest::Priority priority,
+        bool renderBlocking)
+{
+    if (!gResourceLoader.mSetPriorityMethodID)
+        return;
+    JNIEnv* env = JSC::Bindings::getJNIEnv();
+    env->CallVoidMethod(mJLoader, gResourceLoader.mSetPriorityMethodID,
+            (jint) priority, renderBlocking);
+    checkException(env);
+}
+
 bool WebCoreResourceLoader::willLoadFromCache(const WebCore::KURL& url, int64_t identifier)
 {
     JNIEnv* env = JSC::Bindings::getJNIEnv();
@@ -113,10 +158,31 @@ void WebCoreResourceLoader::SetResponseHeader(JNIEnv* env, jobject obj, jint nat
     LOG_ASSERT(response, "nativeSetResponseHeader must take a valid response pointer!");
 
     LOG_ASSERT(key, "How did a null value become a key?");
-    if (val) {
-        WebCore::String valStr = to_string(env, val);
-        if (!valStr.isEmpty())
-            response->setHTTPHeaderField(to_string(env, key), valStr);
+    if (val)
+        setResponseHeader(env, response, key, val);
+}
+
+// Sets all of a response's headers in one call. headers holds alternating
+// names and values.
+void WebCoreResourceLoader::SetResponseHeaders(JNIEnv* env, jobject obj,
+        jint nativeResponse, jobjectArray headers)
+{
+#ifdef ANDROID_INSTRUMENT
+    TimeCounterAuto counter(TimeCounter::ResourceTimeCounter);
+#endif
+
+    WebCore::ResourceResponse* response = (WebCore::ResourceResponse*)nativeResponse;
+    LOG_ASSERT(response, "nativeSetResponseHeaders must take a valid response pointer!");
+
+    int count = env->GetArrayLength(headers) & ~1;
+    for (int index = 0; index < count; index += 2) {
+        jstring key = (jstring) env->GetObjectArrayElement(headers, index);
+        jstring val = (jstring) env->GetObjectArrayElement(headers, index + 1);
+        LOG_ASSERT(key, "How did a null value become a key?");
+        if (key && val)
+            setResponseHeader(env, response, key, val);
+        env->DeleteLocalRef(key);
+        env->DeleteLocalRef(val);
     }
 }
 
@@ -164,6 +230,11 @@ void WebCoreResourceLoader::ReceivedResponse(JNIEnv* env, jobject obj, jint nati
 
     WebCore::ResourceResponse* response = (WebCore::ResourceResponse*)nativeResponse;
     LOG_ASSERT(response, "nativeReceivedResponse must take a valid resource pointer!");
+    if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+        recorder->didReceiveResponse(handle, *response);
+    // The Java side has already stored the cookies the response sets.
+    if (!response->httpHeaderField("Set-Cookie").isNull())
+        WebCore::cookiesChanged();
     handle->client()->didReceiveResponse(handle, *response);
     // As the client makes a copy of the response, delete it here.
     delete response;
@@ -188,10 +259,84 @@ void WebCoreResourceLoader::AddData(JNIEnv* env, jobject obj, jbyteArray dataArr
     jbyte * data =  env->GetByteArrayElements(dataArray, NULL);
 
     LOG_ASSERT(handle->client(), "Why do we not have a client?");
+    if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+        recorder->didReceiveData(handle, (const char *)data, length);
     handle->client()->didReceiveData(handle, (const char *)data, length, length);
     env->ReleaseByteArrayElements(dataArray, data, JNI_ABORT);    
 }
 
+// Same as AddData, for data already in a direct ByteBuffer. The bytes are
+// handed to the client where they are, instead of being copied out of a Java
+// array first.
+void WebCoreResourceLoader::AddDirectData(JNIEnv* env, jobject obj,
+        jobject buffer, jint length)
+{
+#ifdef ANDROID_INSTRUMENT
+    TimeCounterAuto counter(TimeCounter::ResourceTimeCounter);
+#endif
+    LOGV("webcore_resourceloader direct data(%d)", length);
+
+    WebCore::ResourceHandle* handle = GET_NATIVE_HANDLE(env, obj);
+    LOG_ASSERT(handle, "nativeAddDirectData must take a valid handle!");
+    // ResourceLoader::didFail() can set handle to be NULL, we need to check
+    if (!handle)
+        return;
+
+    const char* data = static_cast<const char*>(
+        env->GetDirectBufferAddress(buffer));
+    LOG_ASSERT(data, "nativeAddDirectData needs a direct buffer!");
+    if (!data || length > env->GetDirectBufferCapacity(buffer))
+        return;
+
+    SkAutoMemoryUsageProbe  mup("android_webcore_resourceloader_nativeAddDirectData");
+
+    LOG_ASSERT(handle->client(), "Why do we not have a client?");
+    if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+        recorder->didReceiveData(handle, data, length);
+    handle->client()->didReceiveData(handle, data, length, length);
+}
+
+// Delivers data to several loaders in one call. The chunks are packed one
+// after another in dataArray, with lengths[i] bytes for loaders[i].
+void WebCoreResourceLoader::AddDataBatch(JNIEnv* env, jclass,
+        jobjectArray loaders, jbyteArray dataArray, jintArray lengths)
+{
+#ifdef ANDROID_INSTRUMENT
+    TimeCounterAuto counter(TimeCounter::ResourceTimeCounter);
+#endif
+    int count = env->GetArrayLength(loaders);
+    LOG_ASSERT(count == env->GetArrayLength(lengths),
+        "nativeAddDataBatch needs a length for each loader!");
+    LOGV("webcore_resourceloader batch(%d)", count);
+
+    SkAutoMemoryUsageProbe  mup("android_webcore_resourceloader_nativeAddDataBatch");
+
+    jint* sizes = env->GetIntArrayElements(lengths, NULL);
+    jbyte* data = env->GetByteArrayElements(dataArray, NULL);
+    jsize available = env->GetArrayLength(dataArray);
+    jsize offset = 0;
+    for (int index = 0; index < count; index++) {
+        jint length = sizes[index];
+        if (length < 0 || length > available - offset)
+            break;
+        jobject obj = env->GetObjectArrayElement(loaders, index);
+        // Delivering earlier chunks can cancel later loaders, which clears
+        // their handles, so look each one up just before using it.
+        WebCore::ResourceHandle* handle = obj ? GET_NATIVE_HANDLE(env, obj) : 0;
+        if (handle) {
+            LOG_ASSERT(handle->client(), "Why do we not have a client?");
+            if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+                recorder->didReceiveData(handle, (const char *)data + offset, length);
+            handle->client()->didReceiveData(handle,
+                (const char *)data + offset, length, length);
+        }
+        env->DeleteLocalRef(obj);
+        offset += length;
+    }
+    env->ReleaseByteArrayElements(dataArray, data, JNI_ABORT);
+    env->ReleaseIntArrayElements(lengths, sizes, JNI_ABORT);
+}
+
 void WebCoreResourceLoader::Finished(JNIEnv* env, jobject obj)
 {
 #ifdef ANDROID_INSTRUMENT
@@ -205,6 +350,8 @@ void WebCoreResourceLoader::Finished(JNIEnv* env, jobject obj)
         return;
 
     LOG_ASSERT(handle->client(), "Why do we not have a client?");
+    if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+        recorder->didFinishLoading(handle);
     handle->client()->didFinishLoading(handle);
 }
 
@@ -242,6 +389,8 @@ jstring WebCoreResourceLoader::RedirectedToUrl(JNIEnv* env, jobject obj,
         r.setHTTPBody(0);
         r.setHTTPContentType("");
     }
+    if (!response->httpHeaderField("Set-Cookie").isNull())
+        WebCore::cookiesChanged();
     handle->client()->willSendRequest(handle, r, *response);
     delete response;
     WebCore::String s = url.string();
@@ -261,6 +410,8 @@ void WebCoreResourceLoader::Error(JNIEnv* env, jobject obj, jint id, jstring des
     if (!handle)
         return;
 
+    if (NetworkArchiveRecorder* recorder = NetworkArchiveRecorder::get())
+        recorder->didFail(handle);
     handle->client()->didFail(handle, WebCore::ResourceError("", id,
                 to_string(env, failingUrl), to_string(env, description)));
 }
@@ -285,6 +436,16 @@ static JNINativeMethod gResourceloaderMethods[] = {
         (void*) WebCoreResourceLoader::Error }
 };
 
+// Older LoadListener.java only has the unbatched, byte array calls
+static JNINativeMethod gResourceloaderOptionalMethods[] = {
+    { "nativeAddDirectData", "(Ljava/nio/ByteBuffer;I)V",
+        (void*) WebCoreResourceLoader::AddDirectData },
+    { "nativeSetResponseHeaders", "(I[Ljava/lang/String;)V",
+        (void*) WebCoreResourceLoader::SetResponseHeaders },
+    { "nativeAddDataBatch", "([Landroid/webkit/LoadListener;[B[I)V",
+        (void*) WebCoreResourceLoader::AddDataBatch }
+};
+
 int register_resource_loader(JNIEnv* env)
 {
     jclass resourceLoader = env->FindClass("android/webkit/LoadListener");
@@ -311,11 +472,27 @@ int register_resource_loader(JNIEnv* env)
     LOG_FATAL_IF(gResourceLoader.mPauseLoadMethodID == NULL,
         "Could not find method pauseLoad on LoadListener");
 
+    // Older LoadListener.java can not reorder requests
+    gResourceLoader.mSetPriorityMethodID =
+        env->GetMethodID(resourceLoader, "setPriority", "(IZ)V");
+    if (!gResourceLoader.mSetPriorityMethodID)
+        env->ExceptionClear();
+
     gResourceLoader.mWillLoadFromCacheMethodID = 
         env->GetStaticMethodID(resourceLoader, "willLoadFromCache", "(Ljava/lang/String;J)Z");
     LOG_FATAL_IF(gResourceLoader.mWillLoadFromCacheMethodID == NULL, 
         "Could not find static method willLoadFromCache on LoadListener");
 
+    internCommonHeaderNames();
+
+    // RegisterNatives stops at the first missing method, so register these
+    // one at a time
+    for (size_t index = 0; index < NELEM(gResourceloaderOptionalMethods); index++) {
+        if (env->RegisterNatives(resourceLoader,
+                &gResourceloaderOptionalMethods[index], 1) < 0)
+            env->ExceptionClear();
+    }
+
     return jniRegisterNativeMethods(env, "android/webkit/LoadListener", 
                      gResourceloaderMethods, NELEM(gResourceloaderMethods));
 }
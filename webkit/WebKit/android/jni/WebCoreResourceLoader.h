@@ -28,6 +28,12 @@ public:
 
     virtual void pauseLoad(bool);
 
+    /**
+    * Call to java to reorder the load in the network queue. Does nothing
+    * if LoadListener does not support priorities.
+    */
+    virtual void setPriority(WebCore::ResourceRequest::Priority, bool renderBlocking);
+
     /**
     * Call to java to find out if this URL is in the cache
     */
@@ -35,10 +41,14 @@ public:
 
     // Native jni functions
     static void SetResponseHeader(JNIEnv*, jobject, jint, jstring, jstring);
+    static void SetResponseHeaders(JNIEnv*, jobject, jint, jobjectArray);
     static jint CreateResponse(JNIEnv*, jobject, jstring, jint, jstring,
             jstring, jlong, jstring);
     static void ReceivedResponse(JNIEnv*, jobject, jint);
     static void AddData(JNIEnv*, jobject, jbyteArray, jint);
+    static void AddDirectData(JNIEnv*, jobject, jobject, jint);
+    static void AddDataBatch(JNIEnv*, jclass, jobjectArray, jbyteArray,
+            jintArray);
     static void Finished(JNIEnv*, jobject);
     static jstring RedirectedToUrl(JNIEnv*, jobject, jstring, jstring, jint);
     static void Error(JNIEnv*, jobject, jint, jstring, jstring);
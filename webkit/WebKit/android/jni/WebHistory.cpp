@@ -15,6 +15,7 @@
 #include "HistoryItem.h"
 #include "IconDatabase.h"
 #include "Page.h"
+#include "StringHash.h"
 #include "TextEncoding.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreJni.h"
@@ -24,15 +25,33 @@
 #include "JNIUtility.h"
 #include <SkUtils.h>
 #include <utils/misc.h>
+#include <wtf/HashMap.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/Platform.h>
 
 namespace android {
 
+// Data written by Flatten starts with HISTORY_MAGIC and HISTORY_VERSION. The
+// original format has no header and starts with a string length, which is
+// never this large, so both can be inflated.
+#define HISTORY_MAGIC   0xFFFF4857
+#define HISTORY_VERSION 2
+#define HISTORY_HEADER_SIZE ((int)(sizeof(unsigned) * 2))
+// 6 empty strings + no document state + children count + 2 scales as one
+// byte varints, and 1 char for isTargetItem.
+#define HISTORY_COMPACT_MIN_SIZE 11
+
+// Strings already written to (or read from) one flattened tree. Each later
+// copy is written as its index.
+typedef WTF::HashMap<WebCore::String, unsigned> StringTable;
+typedef WTF::Vector<WebCore::String> StringList;
+
 // Forward declarations
-static void write_item(WTF::Vector<char>& v, WebCore::HistoryItem* item);
-static void write_children_recursive(WTF::Vector<char>& v, WebCore::HistoryItem* parent);
+static void write_item(WTF::Vector<char>& v, StringTable& strings, WebCore::HistoryItem* item);
+static void write_children_recursive(WTF::Vector<char>& v, StringTable& strings, WebCore::HistoryItem* parent);
 static bool read_item_recursive(WebCore::HistoryItem* child, const char** pData, int length);
+static bool read_compact_item_recursive(WebCore::HistoryItem* child,
+        const char** pData, const char* end, StringList& strings);
 
 // Field ids for WebHistoryItems
 struct WebHistoryItemFields {
@@ -154,7 +173,21 @@ static void WebHistoryInflate(JNIEnv* env, jobject obj, jint frame, jbyteArray d
     // ptr's value. We can't pass &bytes since we have to send bytes to
     // ReleaseByteArrayElements unchanged.
     const char* ptr = reinterpret_cast<const char*>(bytes);
-    read_item_recursive(newItem.get(), &ptr, (int)size);
+    unsigned magic = 0;
+    if (size >= HISTORY_HEADER_SIZE)
+        memcpy(&magic, ptr, sizeof(unsigned));
+    if (magic == HISTORY_MAGIC) {
+        unsigned version;
+        memcpy(&version, ptr + sizeof(unsigned), sizeof(unsigned));
+        if (version == HISTORY_VERSION) {
+            StringList strings;
+            const char* end = ptr + size;
+            ptr += HISTORY_HEADER_SIZE;
+            read_compact_item_recursive(newItem.get(), &ptr, end, strings);
+        } else
+            LOGW("Unknown history version %d", version);
+    } else
+        read_item_recursive(newItem.get(), &ptr, (int)size);
     env->ReleaseByteArrayElements(data, const_cast<jbyte*>(bytes), JNI_ABORT);
     bridge->setActive();
 
@@ -175,14 +208,17 @@ jbyteArray WebHistory::Flatten(JNIEnv* env, WTF::Vector<char>& v, WebCore::Histo
     if (!item)
         return NULL;
 
-    // Reserve a vector of chars with an initial size of HISTORY_MIN_SIZE.
-    v.reserveCapacity(HISTORY_MIN_SIZE);
+    // Reserve a vector of chars for the header and the smallest item.
+    v.reserveCapacity(HISTORY_HEADER_SIZE + HISTORY_COMPACT_MIN_SIZE);
+    const unsigned header[2] = { HISTORY_MAGIC, HISTORY_VERSION };
+    v.append((const char*)header, HISTORY_HEADER_SIZE);
 
     // Write the top-level history item and then write all the children
     // recursively.
     LOG_ASSERT(item->bridge(), "Why don't we have a bridge object here?");
-    write_item(v, item);
-    write_children_recursive(v, item);
+    StringTable strings;
+    write_item(v, strings, item);
+    write_children_recursive(v, strings, item);
 
     // Try to create a new java byte array.
     jbyteArray b = env->NewByteArray(v.size());
@@ -335,79 +371,94 @@ void WebHistory::UpdateHistoryIndex(const AutoJObject& list, int newIndex)
         list.env()->CallVoidMethod(list.get(), gWebBackForwardList.mSetCurrentIndex, newIndex);
 }
 
-static void write_string(WTF::Vector<char>& v, const WebCore::String& str)
+static void write_varint(WTF::Vector<char>& v, unsigned value)
 {
-    unsigned strLen = str.length();
-    // Only do work if the string has data.
-    if (strLen) {
-        // Determine how much to grow the vector. Use the worst case for utf8 to
-        // avoid reading the string twice. Add sizeof(unsigned) to hold the
-        // string length in utf8.
-        unsigned vectorLen = v.size() + sizeof(unsigned);
-        unsigned length = (strLen << 2) + vectorLen;
-        // Grow the vector. This will change the value of v.size() but we
-        // remember the original size above.
-        v.grow(length);
-        // Grab the position to write to.
-        char* data = v.begin() + vectorLen;
-        // Write the actual string
-        int l = SkUTF16_ToUTF8(str.characters(), strLen, data);
-        LOGV("Writing string       %d %.*s", l, l, data);
-        // Go back and write the utf8 length. Subtract sizeof(unsigned) from
-        // data to get the position to write the length.
-        memcpy(data - sizeof(unsigned), (char*)&l, sizeof(unsigned));
-        // Shrink the internal state of the vector so we match what was
-        // actually written.
-        v.shrink(vectorLen + l);
-    } else
-        v.append((char*)&strLen, sizeof(unsigned));
+    while (value >= 0x80) {
+        v.append((char)(value | 0x80));
+        value >>= 7;
+    }
+    v.append((char)value);
+}
+
+// Writes the utf8 length and then the utf8 bytes.
+static void write_utf8(WTF::Vector<char>& v, const WebCore::String& str,
+        unsigned tag)
+{
+    size_t l = SkUTF16_ToUTF8(str.characters(), str.length());
+    write_varint(v, (l << 1) | tag);
+    size_t pos = v.size();
+    v.grow(pos + l);
+    SkUTF16_ToUTF8(str.characters(), str.length(), v.begin() + pos);
+    LOGV("Writing string       %d %.*s", l, l, v.begin() + pos);
+}
+
+// 0 is the empty string. An odd value is the index of a string written
+// earlier, and any other value is the length of the utf8 that follows.
+static void write_string(WTF::Vector<char>& v, StringTable& strings,
+        const WebCore::String& str)
+{
+    if (str.isEmpty()) {
+        write_varint(v, 0);
+        return;
+    }
+    StringTable::iterator i = strings.find(str);
+    if (i != strings.end()) {
+        write_varint(v, (i->second << 1) | 1);
+        return;
+    }
+    strings.add(str, strings.size());
+    write_utf8(v, str, 0);
 }
 
-static void write_item(WTF::Vector<char>& v, WebCore::HistoryItem* item)
+static void write_item(WTF::Vector<char>& v, StringTable& strings,
+        WebCore::HistoryItem* item)
 {
     // Original url
-    write_string(v, item->originalURLString());
+    write_string(v, strings, item->originalURLString());
 
     // Url
-    write_string(v, item->urlString());
+    write_string(v, strings, item->urlString());
 
     // Title
-    write_string(v, item->title());
+    write_string(v, strings, item->title());
 
     // Form content type
-    write_string(v, item->formContentType());
+    write_string(v, strings, item->formContentType());
 
-    // Form data
+    // Form data, never shared since it is rarely repeated
     const WebCore::FormData* formData = item->formData();
-    if (formData) {
-        write_string(v, formData->flattenToString());
+    WebCore::String flattenedForm;
+    if (formData)
+        flattenedForm = formData->flattenToString();
+    if (!flattenedForm.isEmpty()) {
+        write_utf8(v, flattenedForm, 0);
         // save the identifier as it is not included in the flatten data
         int64_t id = formData->identifier();
         v.append((char*)&id, sizeof(int64_t));
     } else
-        write_string(v, WebCore::String()); // Empty constructor does not allocate a buffer.
+        write_varint(v, 0);
 
     // Target
-    write_string(v, item->target());
+    write_string(v, strings, item->target());
 
     AndroidWebHistoryBridge* bridge = item->bridge();
     LOG_ASSERT(bridge, "We should have a bridge here!");
     // Screen scale
     const int scale = bridge->scale();
     LOGV("Writing scale %d", scale);
-    v.append((char*)&scale, sizeof(int));
+    write_varint(v, scale);
     const int screenWidthScale = bridge->screenWidthScale();
     LOGV("Writing screen width scale %d", screenWidthScale);
-    v.append((char*)&screenWidthScale, sizeof(int));
+    write_varint(v, screenWidthScale);
 
     // Document state
     const WTF::Vector<WebCore::String>& docState = item->documentState();
     WTF::Vector<WebCore::String>::const_iterator end = docState.end();
     unsigned stateSize = docState.size();
     LOGV("Writing docState     %d", stateSize);
-    v.append((char*)&stateSize, sizeof(unsigned));
+    write_varint(v, stateSize);
     for (WTF::Vector<WebCore::String>::const_iterator i = docState.begin(); i != end; ++i) {
-        write_string(v, *i);
+        write_string(v, strings, *i);
     }
 
     // Is target item
@@ -417,10 +468,11 @@ static void write_item(WTF::Vector<char>& v, WebCore::HistoryItem* item)
     // Children count
     unsigned childCount = item->children().size();
     LOGV("Writing childCount   %d", childCount);
-    v.append((char*)&childCount, sizeof(unsigned));
+    write_varint(v, childCount);
 }
 
-static void write_children_recursive(WTF::Vector<char>& v, WebCore::HistoryItem* parent)
+static void write_children_recursive(WTF::Vector<char>& v, StringTable& strings,
+        WebCore::HistoryItem* parent)
 {
     const WebCore::HistoryItemVector& children = parent->children();
     WebCore::HistoryItemVector::const_iterator end = children.end();
@@ -443,11 +495,163 @@ static void write_children_recursive(WTF::Vector<char>& v, WebCore::HistoryItem*
                     "Somehow this item has an incorrect parent");
             bridge->setParent(parentBridge);
         }
-        write_item(v, item);
-        write_children_recursive(v, item);
+        write_item(v, strings, item);
+        write_children_recursive(v, strings, item);
+    }
+}
+
+static bool read_varint(const char** pData, const char* end, unsigned* value)
+{
+    unsigned result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*pData >= end)
+            return false;
+        unsigned char c = (unsigned char) *(*pData)++;
+        result |= (unsigned)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_string(const char** pData, const char* end,
+        StringList& strings, WebCore::String* str)
+{
+    unsigned code;
+    if (!read_varint(pData, end, &code))
+        return false;
+    if (!code) {
+        *str = WebCore::String();
+        return true;
+    }
+    if (code & 1) {
+        unsigned index = code >> 1;
+        if (index >= strings.size())
+            return false;
+        *str = strings[index];
+        return true;
+    }
+    unsigned l = code >> 1;
+    if ((unsigned)(end - *pData) < l)
+        return false;
+    LOGV("String          %d %.*s", l, l, *pData);
+    *str = WebCore::UTF8Encoding().decode(*pData, l);
+    *pData += l;
+    strings.append(*str);
+    return true;
+}
+
+static bool read_compact_item_recursive(WebCore::HistoryItem* newItem,
+        const char** pData, const char* end, StringList& strings)
+{
+    if (end - *pData < HISTORY_COMPACT_MIN_SIZE)
+        return false;
+
+    WebCore::String str;
+    if (!read_string(pData, end, strings, &str))
+        return false;
+    if (!str.isNull())
+        newItem->setOriginalURLString(str);
+    if (!read_string(pData, end, strings, &str))
+        return false;
+    if (!str.isNull())
+        newItem->setURLString(str);
+    if (!read_string(pData, end, strings, &str))
+        return false;
+    if (!str.isNull())
+        newItem->setTitle(str);
+
+    WebCore::String formContentType;
+    if (!read_string(pData, end, strings, &formContentType))
+        return false;
+
+    // Read the form data, which is raw bytes rather than a shared string
+    unsigned code;
+    if (!read_varint(pData, end, &code) || (code & 1))
+        return false;
+    unsigned l = code >> 1;
+    if (l) {
+        if ((unsigned)(end - *pData) < l + sizeof(int64_t))
+            return false;
+        RefPtr<WebCore::FormData> formData = WebCore::FormData::create(*pData, l);
+        *pData += l;
+        int64_t id;
+        memcpy(&id, *pData, sizeof(int64_t));
+        *pData += sizeof(int64_t);
+        if (id)
+            formData->setIdentifier(id);
+        WebCore::ResourceRequest r;
+        r.setHTTPMethod("POST");
+        r.setHTTPContentType(formContentType);
+        r.setHTTPBody(formData);
+        newItem->setFormInfoFromRequest(r);
+    }
+
+    if (!read_string(pData, end, strings, &str))
+        return false;
+    if (!str.isNull())
+        newItem->setTarget(str);
+
+    AndroidWebHistoryBridge* bridge = newItem->bridge();
+    LOG_ASSERT(bridge, "There should be a bridge object during inflate");
+    unsigned scale, screenWidthScale;
+    if (!read_varint(pData, end, &scale)
+            || !read_varint(pData, end, &screenWidthScale))
+        return false;
+    LOGV("Screen scale    %d %d", scale, screenWidthScale);
+    bridge->setScale(scale);
+    bridge->setScreenWidthScale(screenWidthScale);
+
+    unsigned stateSize;
+    if (!read_varint(pData, end, &stateSize))
+        return false;
+    LOGV("Document state  %d", stateSize);
+    if (stateSize) {
+        // each string takes at least one byte
+        if ((unsigned)(end - *pData) < stateSize)
+            return false;
+        WTF::Vector<WebCore::String> docState;
+        docState.reserveCapacity(stateSize);
+        while (stateSize--) {
+            if (!read_string(pData, end, strings, &str))
+                return false;
+            docState.append(str);
+        }
+        newItem->setDocumentState(docState);
     }
+
+    // Read is target item. A value that is not 0 or 1 is a failure.
+    if (*pData >= end)
+        return false;
+    unsigned char c = (unsigned char) *(*pData)++;
+    if (c > 1)
+        return false;
+    LOGV("Target item     %d", c);
+    newItem->setIsTargetItem((bool)c);
+
+    unsigned childCount;
+    if (!read_varint(pData, end, &childCount))
+        return false;
+    LOGV("Child count     %d", childCount);
+    if ((unsigned)(end - *pData) < childCount * HISTORY_COMPACT_MIN_SIZE)
+        return false;
+    while (childCount--) {
+        WTF::PassRefPtr<WebCore::HistoryItem> child = WebCore::HistoryItem::create();
+        // Set a bridge that will not call into java.
+        child->setBridge(new WebHistoryItem(static_cast<WebHistoryItem*>(bridge)));
+        if (!read_compact_item_recursive(child.get(), pData, end, strings)) {
+            child.clear();
+            return false;
+        }
+        child->bridge()->setActive();
+        newItem->addChildItem(child);
+    }
+    return true;
 }
 
+// Reads the original, headerless format
 static bool read_item_recursive(WebCore::HistoryItem* newItem,
         const char** pData, int length)
 {
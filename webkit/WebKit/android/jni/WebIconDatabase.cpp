@@ -13,6 +13,7 @@
 #include "IntRect.h"
 #include "JavaSharedClient.h"
 #include "KURL.h"
+#include "SharedBuffer.h"
 #include "WebCoreJni.h"
 
 #include <JNIHelp.h>
@@ -22,21 +23,69 @@
 #include <SkTemplates.h>
 #include <pthread.h>
 #include <utils/misc.h>
+#include <wtf/HashMap.h>
 #include <wtf/Platform.h>
+#include <wtf/RefPtr.h>
 
 namespace android {
 
+// Icons decoded for Java, keyed by the icon data they were decoded from so
+// that a changed icon is decoded again. Entries hold a reference to their
+// data, so its address isn't reused for other data while it is a key.
+struct DecodedIcon {
+    RefPtr<WebCore::SharedBuffer> data;
+    SkBitmap bitmap;
+    unsigned lastUse;
+};
+typedef HashMap<WebCore::SharedBuffer*, DecodedIcon> DecodedIconMap;
+
+static const unsigned maxDecodedIcons = 64;
+static DecodedIconMap gDecodedIcons;
+static unsigned gDecodedIconUseCount;
+static android::Mutex gDecodedIconsMutex;
+
+static bool decodedIcon(WebCore::SharedBuffer* buffer, SkBitmap* bitmap)
+{
+    android::Mutex::Autolock lock(gDecodedIconsMutex);
+    DecodedIconMap::iterator it = gDecodedIcons.find(buffer);
+    if (it != gDecodedIcons.end()) {
+        it->second.lastUse = ++gDecodedIconUseCount;
+        *bitmap = it->second.bitmap;
+        return true;
+    }
+
+    if (!SkImageDecoder::DecodeMemory(buffer->data(), buffer->size(), bitmap,
+                                      SkBitmap::kNo_Config,
+                                      SkImageDecoder::kDecodePixels_Mode))
+        return false;
+
+    if (gDecodedIcons.size() >= maxDecodedIcons) {
+        DecodedIconMap::iterator oldest = gDecodedIcons.begin();
+        DecodedIconMap::iterator end = gDecodedIcons.end();
+        for (it = oldest; it != end; ++it) {
+            if (it->second.lastUse < oldest->second.lastUse)
+                oldest = it;
+        }
+        gDecodedIcons.remove(oldest);
+    }
+    DecodedIcon entry;
+    entry.data = buffer;
+    entry.bitmap = *bitmap;
+    entry.lastUse = ++gDecodedIconUseCount;
+    gDecodedIcons.set(buffer, entry);
+    return true;
+}
+
 jobject webcoreImageToJavaBitmap(JNIEnv* env, WebCore::Image* icon)
 {
     if (!icon)
         return NULL;
     SkBitmap bm;
     WebCore::SharedBuffer* buffer = icon->data();
-    if (!buffer || !SkImageDecoder::DecodeMemory(buffer->data(), buffer->size(),
-                                                 &bm, SkBitmap::kNo_Config,
-                                            SkImageDecoder::kDecodePixels_Mode))
+    if (!buffer || !decodedIcon(buffer, &bm))
         return NULL;
 
+    // The Java bitmap is immutable, so it can share the cached pixels.
     return GraphicsJNI::createBitmap(env, new SkBitmap(bm), false, NULL);
 }
 
@@ -7,7 +7,9 @@
 
 #include "ApplicationCacheStorage.h"
 #include "CString.h"
+#include "CrossOriginPreflightResultCache.h"
 #include "DatabaseTracker.h"
+#include "DiskCache.h"
 #include "DocLoader.h"
 #include "Document.h"
 #include "EditorClientAndroid.h"
@@ -24,9 +26,15 @@
 #include "Settings.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreJni.h"
+#include "WebViewCore.h"
 #if USE(V8)
 #include "WorkerContextExecutionProxy.h"
 #endif
+#if USE(JSC)
+#include "JSDOMWindow.h"
+#include <runtime/Collector.h>
+#include <runtime/JSLock.h>
+#endif
 
 #include <JNIHelp.h>
 #include <utils/misc.h>
@@ -97,6 +105,25 @@ struct FieldIds {
         mShrinksStandaloneImagesToFit = env->GetFieldID(clazz, "mShrinksStandaloneImagesToFit", "Z");
         mUseDoubleTree = env->GetFieldID(clazz, "mUseDoubleTree", "Z");
         mPageCacheCapacity = env->GetFieldID(clazz, "mPageCacheCapacity", "I");
+        // Tuning knobs for the picture set; older WebSettings.java may not
+        // declare them, in which case the native defaults are kept.
+        mPictureSetMaxDrawTime = getOptionalFieldID(env, clazz,
+                "mPictureSetMaxDrawTime", "I");
+        mPictureSetMergeDrawTime = getOptionalFieldID(env, clazz,
+                "mPictureSetMergeDrawTime", "I");
+        mPictureSetHotInvalCount = getOptionalFieldID(env, clazz,
+                "mPictureSetHotInvalCount", "I");
+        mLowResFirstPaint = getOptionalFieldID(env, clazz,
+                "mLowResFirstPaint", "Z");
+        mNavBuildBudget = getOptionalFieldID(env, clazz,
+                "mNavBuildBudget", "I");
+        // JavaScript heap sizing, see JSC::Heap::Policy
+        mJSHeapTargetSize = getOptionalFieldID(env, clazz,
+                "mJSHeapTargetSize", "I");
+        mJSHeapGrowthPercent = getOptionalFieldID(env, clazz,
+                "mJSHeapGrowthPercent", "I");
+        mJSHeapShrinkPercent = getOptionalFieldID(env, clazz,
+                "mJSHeapShrinkPercent", "I");
 
         LOG_ASSERT(mLayoutAlgorithm, "Could not find field mLayoutAlgorithm");
         LOG_ASSERT(mTextSize, "Could not find field mTextSize");
@@ -143,6 +170,14 @@ struct FieldIds {
         mTextSizeValue = env->GetFieldID(c, "value", "I");
     }
 
+    static jfieldID getOptionalFieldID(JNIEnv* env, jclass clazz,
+            const char* name, const char* signature) {
+        jfieldID field = env->GetFieldID(clazz, name, signature);
+        if (!field)
+            env->ExceptionClear();
+        return field;
+    }
+
     // Field ids
     jfieldID mLayoutAlgorithm;
     jfieldID mTextSize;
@@ -178,6 +213,14 @@ struct FieldIds {
     jfieldID mShrinksStandaloneImagesToFit;
     jfieldID mUseDoubleTree;
     jfieldID mPageCacheCapacity;
+    jfieldID mPictureSetMaxDrawTime;
+    jfieldID mPictureSetMergeDrawTime;
+    jfieldID mPictureSetHotInvalCount;
+    jfieldID mLowResFirstPaint;
+    jfieldID mNavBuildBudget;
+    jfieldID mJSHeapTargetSize;
+    jfieldID mJSHeapGrowthPercent;
+    jfieldID mJSHeapShrinkPercent;
     // Ordinal() method and value field for enums
     jmethodID mOrdinal;
     jfieldID  mTextSizeValue;
@@ -380,6 +423,32 @@ public:
             }
         }
 #endif
+#if ENABLE(DISK_CACHE)
+        str = (jstring)env->GetObjectField(obj, gFieldIds->mDatabasePath);
+        if (str) {
+            WebCore::String path = to_string(env, str);
+            if (path.length() && WebCore::diskCache().cacheDirectory().isNull())
+                WebCore::diskCache().setCacheDirectory(
+                        WebCore::pathByAppendingComponent(path, "resourcecache"));
+        }
+#endif
+#if ENABLE(DATABASE) || ENABLE(DOM_STORAGE)
+        str = (jstring)env->GetObjectField(obj, gFieldIds->mDatabasePath);
+        if (str) {
+            WebCore::String path = to_string(env, str);
+            if (path.length()) {
+                WebCore::CrossOriginPreflightResultCache::shared().setDatabasePath(path);
+                // The database is created when the cache is first used. If the
+                // file doesn't exist, we create it and set its permissions. The
+                // filename must match that in CrossOriginPreflightResultCache.cpp.
+                WebCore::String filename = WebCore::SQLiteFileSystem::appendDatabaseFileNameToPath(
+                        path, "CrossOriginPreflightResults.db");
+                int fd = open(filename.utf8().data(), O_CREAT | O_EXCL, permissionFlags660);
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+#endif
 
         flag = env->GetBooleanField(obj, gFieldIds->mGeolocationEnabled);
         GeolocationPermissions::setAlwaysDeny(!flag);
@@ -405,7 +474,49 @@ public:
             WebCore::pageCache()->setCapacity(size);
         } else
             s->setUsesPageCache(false);
+
+        WebViewCore* viewImpl = WebViewCore::getWebViewCore(pFrame->view());
+        if (viewImpl && gFieldIds->mPictureSetMaxDrawTime
+                && gFieldIds->mPictureSetMergeDrawTime
+                && gFieldIds->mPictureSetHotInvalCount) {
+            viewImpl->setSplitPolicy(
+                env->GetIntField(obj, gFieldIds->mPictureSetMaxDrawTime),
+                env->GetIntField(obj, gFieldIds->mPictureSetMergeDrawTime),
+                env->GetIntField(obj, gFieldIds->mPictureSetHotInvalCount));
+        }
+        if (viewImpl && gFieldIds->mLowResFirstPaint) {
+            viewImpl->setLowResFirstPaint(
+                env->GetBooleanField(obj, gFieldIds->mLowResFirstPaint));
+        }
+        if (viewImpl && gFieldIds->mNavBuildBudget) {
+            viewImpl->setNavBuildBudget(
+                env->GetIntField(obj, gFieldIds->mNavBuildBudget));
+        }
+#if USE(JSC)
+        syncHeapPolicy(env, obj);
+#endif
+    }
+
+#if USE(JSC)
+    static void syncHeapPolicy(JNIEnv* env, jobject obj)
+    {
+        JSC::JSLock lock(JSC::SilenceAssertionsOnly);
+        JSC::Heap& heap = WebCore::JSDOMWindow::commonJSGlobalData()->heap;
+        JSC::Heap::Policy policy = heap.policy();
+        // negative values keep the current setting
+        int value;
+        if (gFieldIds->mJSHeapTargetSize
+                && (value = env->GetIntField(obj, gFieldIds->mJSHeapTargetSize)) >= 0)
+            policy.targetSize = static_cast<size_t>(value) * 1024; // KB
+        if (gFieldIds->mJSHeapGrowthPercent
+                && (value = env->GetIntField(obj, gFieldIds->mJSHeapGrowthPercent)) >= 0)
+            policy.growthPercent = value;
+        if (gFieldIds->mJSHeapShrinkPercent
+                && (value = env->GetIntField(obj, gFieldIds->mJSHeapShrinkPercent)) >= 0)
+            policy.shrinkPercent = value;
+        heap.setPolicy(policy);
     }
+#endif
 };
 
 //-------------------------------------------------------------
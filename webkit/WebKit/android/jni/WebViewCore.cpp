@@ -5,13 +5,18 @@
 #include "config.h"
 #include "WebViewCore.h"
 
+#include "AnimationController.h"
 #include "AtomicString.h"
+#include "BitmapImage.h"
+#include "Cache.h"
+#include "CachedImage.h"
 #include "CachedNode.h"
 #include "CachedRoot.h"
 #include "Chrome.h"
 #include "ChromeClientAndroid.h"
 #include "Color.h"
 #include "DatabaseTracker.h"
+#include "DocLoader.h"
 #include "Document.h"
 #include "DOMWindow.h"
 #include "Element.h"
@@ -31,6 +36,7 @@
 #include "GraphicsJNI.h"
 #include "HTMLAnchorElement.h"
 #include "HTMLAreaElement.h"
+#include "HTMLCollection.h"
 #include "HTMLElement.h"
 #include "HTMLImageElement.h"
 #include "HTMLInputElement.h"
@@ -43,8 +49,11 @@
 #include "HTMLTextAreaElement.h"
 #include "HistoryItem.h"
 #include "HitTestResult.h"
+#include "ImageSource.h"
 #include "InlineTextBox.h"
 #include "KeyboardCodes.h"
+#include "loader.h"
+#include "MemoryPressureHandler.h"
 #include "Navigator.h"
 #include "Node.h"
 #include "NodeList.h"
@@ -71,6 +80,7 @@
 #include "SkTDArray.h"
 #include "SkTypes.h"
 #include "SkCanvas.h"
+#include "SkDevice.h"
 #include "SkPicture.h"
 #include "SkUtils.h"
 #include "StringImpl.h"
@@ -112,6 +122,8 @@ FILE* gRenderTreeFile = 0;
 #include "TimeCounter.h"
 #endif
 
+#include "TraceBuffer.h"
+
 #if USE(ACCELERATED_COMPOSITING)
 #include "GraphicsLayerAndroid.h"
 #include "RenderLayerCompositor.h"
@@ -119,6 +131,13 @@ FILE* gRenderTreeFile = 0;
 
 #define PICT_RECORD_FLAGS   SkPicture::kUsePathBoundsForClip_RecordingFlag
 
+// invals farther apart than this (in wasted pixels) are recorded separately
+#define MIN_SEPARATE_RECORD_AREA (256 * 256)
+#define MAX_SEPARATE_RECORDS 8
+
+// inval regions with more rects than this are collapsed to their bounds
+#define MAX_INVAL_RECTS 32
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace android {
@@ -141,6 +160,13 @@ bool WebViewCore::isInstance(WebViewCore* inst) {
     return gInstanceList.find(inst) >= 0;
 }
 
+size_t WebViewCore::discardOffscreenTiles() {
+    size_t freed = 0;
+    for (int i = 0; i < gInstanceList.count(); i++)
+        freed += gInstanceList[i]->m_contentTiles.discardOffscreen();
+    return freed;
+}
+
 jobject WebViewCore::getApplicationContext() {
 
     // check to see if there is a valid webviewcore object
@@ -259,11 +285,18 @@ static jmethodID GetJMethod(JNIEnv* env, jclass clazz, const char name[], const
 
 Mutex WebViewCore::gFrameCacheMutex;
 Mutex WebViewCore::gButtonMutex;
-Mutex WebViewCore::gCursorBoundsMutex;
+ReadWriteLock WebViewCore::gCursorBoundsLock;
 Mutex WebViewCore::m_contentMutex;
 
 WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* mainframe)
-        : m_pluginInvalTimer(this, &WebViewCore::pluginInvalTimerFired)
+        : m_textfieldCheckTimer(this, &WebViewCore::textfieldCheckTimerFired)
+        , m_pluginInvalTimer(this, &WebViewCore::pluginInvalTimerFired)
+        , m_contentDrawTimer(this, &WebViewCore::contentDrawTimerFired)
+        , m_navCacheTimer(this, &WebViewCore::navCacheTimerFired)
+        , m_scrollSyncTimer(this, &WebViewCore::scrollSyncTimerFired)
+#if ENABLE(TOUCH_EVENTS)
+        , m_touchMoveTimer(this, &WebViewCore::touchMoveTimerFired)
+#endif
 {
     m_mainFrame = mainframe;
 
@@ -271,7 +304,11 @@ WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* m
     m_moveGeneration = 0;
     m_lastGeneration = 0;
     m_touchGeneration = 0;
+    m_hasPendingScrollSync = false;
+    m_pendingScrollMoved = false;
+    m_pendingScrollGeneration = 0;
     m_blockTextfieldUpdates = false;
+    m_textfieldCheckNode = 0;
     // just initial values. These should be set by client
     m_maxXScroll = 320/4;
     m_maxYScroll = 240/4;
@@ -281,8 +318,25 @@ WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* m
     m_screenWidthScale = 1;
 #if ENABLE(TOUCH_EVENTS)
     m_forwardingTouchEvents = false;
+    m_touchMoveDispatched = false;
+    m_touchMovePrevented = false;
+    m_hasPendingTouchMove = false;
+    m_pendingTouchMoveMetaState = 0;
 #endif
     m_isPaused = false;
+    m_contentSnapshot = 0;
+    m_contentTraceId = 0;
+    m_drawnContentTraceId = 0;
+    m_historySnapshotBytes = 0;
+    m_showingHistorySnapshot = false;
+    m_tilesPreview = false;
+    m_lowResFirstPaint = false;
+    m_navBuildBudget = 0;
+    m_lastContentDraw = 0;
+    m_invalCount = m_invalMergedCount = m_invalCoalescedCount = 0;
+    m_occlusionScaleX = m_occlusionScaleY = 0;
+    m_occlusionWidth = m_occlusionHeight = 0;
+    m_contentTiles.setReadyCallback(contentTileReady, this);
 
     LOG_ASSERT(m_mainFrame, "Uh oh, somehow a frameview was made without an initial frame!");
 
@@ -347,6 +401,7 @@ WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* m
 WebViewCore::~WebViewCore()
 {
     WebViewCore::removeInstance(this);
+    m_contentTiles.stop();
 
     // Release the focused view
     Release(m_popupReply);
@@ -359,6 +414,9 @@ WebViewCore::~WebViewCore()
     delete m_javaGlue;
     delete m_frameCacheKit;
     delete m_navPictureKit;
+    m_contentSnapshot->safeUnref();
+    for (size_t index = 0; index < m_historySnapshots.size(); index++)
+        m_historySnapshots[index].content->unref();
 }
 
 WebViewCore* WebViewCore::getWebViewCore(const WebCore::FrameView* view)
@@ -480,6 +538,63 @@ void WebViewCore::recordPicture(SkPicture* picture)
     gButtonMutex.unlock();
 }
 
+static int64_t rectArea(const SkIRect& rect)
+{
+    return static_cast<int64_t>(rect.width()) * rect.height();
+}
+
+// Collapse an inval region into its bounds when it has too many rects to be
+// worth tracking, or when the bounds add little area to what it covers.
+static bool coalesceInval(SkRegion* region)
+{
+    if (!region->isComplex())
+        return false;
+    int count = 0;
+    int64_t area = 0;
+    for (SkRegion::Iterator iter(*region); !iter.done(); iter.next()) {
+        if (++count > MAX_INVAL_RECTS)
+            break;
+        area += rectArea(iter.rect());
+    }
+    const SkIRect& bounds = region->getBounds();
+    if (count <= MAX_INVAL_RECTS && area * 4 < rectArea(bounds) * 3)
+        return false;
+    region->setRect(bounds);
+    return true;
+}
+
+// Break the inval region into the rectangles worth recording separately.
+// Rectangles are merged while their union wastes little area, so that a
+// caret blinking at the top of the page and a counter ticking at the bottom
+// record two small pictures instead of one as tall as the page.
+static void splitInval(const SkRegion& inval, WTF::Vector<SkIRect>* rects)
+{
+    for (SkRegion::Iterator iter(inval); !iter.done(); iter.next()) {
+        SkIRect rect = iter.rect();
+        bool merged;
+        do {
+            merged = false;
+            for (size_t index = 0; index < rects->size(); index++) {
+                const SkIRect& existing = rects->at(index);
+                SkIRect test(rect);
+                test.join(existing);
+                if (rectArea(test) > rectArea(rect) + rectArea(existing)
+                        + MIN_SEPARATE_RECORD_AREA)
+                    continue;
+                rect = test;
+                rects->remove(index);
+                merged = true;
+                break;
+            }
+        } while (merged);
+        rects->append(rect);
+    }
+    if (rects->size() > MAX_SEPARATE_RECORDS) {
+        rects->clear();
+        rects->append(inval.getBounds());
+    }
+}
+
 void WebViewCore::recordPictureSet(PictureSet* content)
 {
     // if there is no document yet, just return
@@ -507,6 +622,7 @@ void WebViewCore::recordPictureSet(PictureSet* content)
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::WebViewCoreRecordTimeCounter);
 #endif
+    TraceBufferAuto trace(TraceBuffer::RecordTrace, m_contentTraceId);
 
     // if the webkit page dimensions changed, discard the pictureset and redraw.
     WebCore::FrameView* view = m_mainFrame->view();
@@ -590,20 +706,37 @@ void WebViewCore::recordPictureSet(PictureSet* content)
     // to improve scrolling performance
     // if (!content->reuseSubdivided(m_addInval)) {
 	{
-        const SkIRect& inval = m_addInval.getBounds();
-        SkPicture* picture = rebuildPicture(inval);
-        DBG_SET_LOGD("{%d,%d,w=%d,h=%d}", inval.fLeft,
-            inval.fTop, inval.width(), inval.height());
-        content->add(m_addInval, picture, 0, false);
-        picture->safeUnref();
+        WTF::Vector<SkIRect> rects;
+        splitInval(m_addInval, &rects);
+        for (size_t index = 0; index < rects.size(); index++) {
+            const SkIRect& inval = rects[index];
+            SkPicture* picture = rebuildPicture(inval);
+            DBG_SET_LOGD("[%d] {%d,%d,w=%d,h=%d}", index, inval.fLeft,
+                inval.fTop, inval.width(), inval.height());
+            if (rects.size() == 1)
+                content->add(m_addInval, picture, 0, false);
+            else
+                content->add(SkRegion(inval), picture, 0, false);
+            picture->safeUnref();
+        }
     }
     // Remove any pictures already in the set that are obscured by the new one,
     // and check to see if any already split pieces need to be redrawn.
     if (content->build())
         rebuildPictureSet(content);
     } // WebViewCoreRecordTimeCounter
-    WebCore::Node* oldFocusNode = currentFocus();
     m_frameCacheOutOfDate = true;
+    // Rebuild the nav cache after the recorded content has gone to the UI,
+    // so that building it doesn't delay the paint; later records coalesce.
+    if (!m_navCacheTimer.isActive())
+        m_navCacheTimer.startOneShot(0);
+}
+
+void WebViewCore::navCacheTimerFired(WebCore::Timer<WebViewCore>*)
+{
+    if (!m_frameCacheOutOfDate)
+        return; // already rebuilt for some other reason
+    WebCore::Node* oldFocusNode = currentFocus();
     WebCore::IntRect oldBounds;
     int oldSelStart = 0;
     int oldSelEnd = 0;
@@ -712,7 +845,7 @@ void WebViewCore::updateCursorBounds(const CachedRoot* root,
     LOG_ASSERT(root, "updateCursorBounds: root cannot be null");
     LOG_ASSERT(cachedNode, "updateCursorBounds: cachedNode cannot be null");
     LOG_ASSERT(cachedFrame, "updateCursorBounds: cachedFrame cannot be null");
-    gCursorBoundsMutex.lock();
+    gCursorBoundsLock.writeLock();
     m_hasCursorBounds = !cachedNode->isHidden();
     // If m_hasCursorBounds is false, we never look at the other
     // values, so do not bother setting them.
@@ -727,7 +860,7 @@ void WebViewCore::updateCursorBounds(const CachedRoot* root,
         root->getSimulatedMousePosition(&m_cursorLocation);
         m_cursorNode = cachedNode->nodePointer();
     }
-    gCursorBoundsMutex.unlock();
+    gCursorBoundsLock.unlock();
 }
 
 void WebViewCore::clearContent()
@@ -735,11 +868,129 @@ void WebViewCore::clearContent()
     DBG_SET_LOG("");
     m_contentMutex.lock();
     m_content.clear();
+    m_tilesInval.setEmpty();
+    m_tilesPreview = m_lowResFirstPaint;
+    // a history snapshot stays up until the new page records something
+    if (!m_showingHistorySnapshot)
+        m_tilesCleared = true;
     m_contentMutex.unlock();
+    if (!m_showingHistorySnapshot)
+        publishContent(PictureSet());
     m_addInval.setEmpty();
     m_rebuildInval.setEmpty();
 }
 
+// Enough for a few pages of back and forward; what a snapshot costs is
+// mostly the images it draws.
+static const size_t HISTORY_SNAPSHOT_COUNT = 4;
+static const size_t HISTORY_SNAPSHOT_BYTES = 1024 * 1024;
+
+void WebViewCore::saveHistorySnapshot(WebCore::HistoryItem* item)
+{
+    // m_content belongs to the page replacing the published snapshot
+    if (!item || m_showingHistorySnapshot)
+        return;
+    for (size_t index = 0; index < m_historySnapshots.size(); index++) {
+        if (m_historySnapshots[index].item == item) {
+            removeHistorySnapshot(index);
+            break;
+        }
+    }
+    int width = m_screenWidth;
+    int height = m_screenHeight;
+    m_contentMutex.lock();
+    PictureSet content(m_content);
+    m_contentMutex.unlock();
+    if (content.isEmpty() || width <= 0 || height <= 0)
+        return;
+
+    // Record again only what was on screen, moved to the origin, so that the
+    // snapshot doesn't keep the pictures of the whole page alive and shows
+    // the right part of the page before its scroll position is restored.
+    const WebCore::IntPoint& scroll = item->scrollPoint();
+    SkPicture* picture = new SkPicture();
+    SkCanvas* canvas = picture->beginRecording(width, height, PICT_RECORD_FLAGS);
+    canvas->translate(SkIntToScalar(-scroll.x()), SkIntToScalar(-scroll.y()));
+    SkRect visible;
+    visible.set(SkIntToScalar(scroll.x()), SkIntToScalar(scroll.y()),
+        SkIntToScalar(scroll.x() + width), SkIntToScalar(scroll.y() + height));
+    canvas->clipRect(visible);
+    content.draw(canvas);
+    picture->endRecording();
+    PictureSet visibleContent;
+    SkRegion area;
+    visibleContent.checkDimensions(width, height, &area);
+    visibleContent.add(area, picture, 0, false);
+    picture->unref();
+
+    size_t bytes = visibleContent.flattenedSize();
+    DBG_SET_LOGD("item=%p {%d,%d,w=%d,h=%d} bytes=%d", item, scroll.x(),
+        scroll.y(), width, height, bytes);
+    if (bytes > HISTORY_SNAPSHOT_BYTES)
+        return;
+    HistorySnapshot snapshot = { item, new PictureSetSnapshot(visibleContent),
+        bytes };
+    m_historySnapshots.append(snapshot);
+    m_historySnapshotBytes += bytes;
+    while (m_historySnapshots.size() > HISTORY_SNAPSHOT_COUNT
+            || m_historySnapshotBytes > HISTORY_SNAPSHOT_BYTES)
+        removeHistorySnapshot(0);
+}
+
+void WebViewCore::restoreHistorySnapshot(WebCore::HistoryItem* item)
+{
+    for (size_t index = 0; index < m_historySnapshots.size(); index++) {
+        if (m_historySnapshots[index].item != item)
+            continue;
+        PictureSetSnapshot* snapshot = m_historySnapshots[index].content;
+        DBG_SET_LOGD("item=%p snapshot=%p", item, snapshot);
+        // published as is; the new page's first recording replaces it
+        snapshot->ref();
+        m_contentMutex.lock();
+        PictureSetSnapshot* old = m_contentSnapshot;
+        m_contentSnapshot = snapshot;
+        m_tilesInval.setEmpty();
+        m_tilesCleared = true;
+        m_contentMutex.unlock();
+        old->safeUnref();
+        m_showingHistorySnapshot = true;
+        const PictureSet& content = snapshot->content();
+        viewInvalidate(WebCore::IntRect(0, 0, content.width(), content.height()));
+        return;
+    }
+}
+
+void WebViewCore::removeHistorySnapshot(size_t index)
+{
+    m_historySnapshotBytes -= m_historySnapshots[index].bytes;
+    m_historySnapshots[index].content->unref();
+    m_historySnapshots.remove(index);
+}
+
+// Returns the last published content with a reference the caller releases.
+// Only the pointer swap is done under m_contentMutex, so the UI never waits
+// on a copy or on the WebCore thread recording.
+PictureSetSnapshot* WebViewCore::acquireContent()
+{
+    m_contentMutex.lock();
+    PictureSetSnapshot* snapshot = m_contentSnapshot;
+    snapshot->safeRef();
+    m_contentMutex.unlock();
+    return snapshot;
+}
+
+// called from the WebCore thread after recording or splitting m_content
+void WebViewCore::publishContent(const PictureSet& content)
+{
+    PictureSetSnapshot* snapshot = new PictureSetSnapshot(content,
+        m_contentTraceId);
+    m_contentMutex.lock();
+    PictureSetSnapshot* old = m_contentSnapshot;
+    m_contentSnapshot = snapshot;
+    m_contentMutex.unlock();
+    old->safeUnref();
+}
+
 void WebViewCore::copyContentToPicture(SkPicture* picture)
 {
     DBG_SET_LOG("start");
@@ -761,22 +1012,64 @@ bool WebViewCore::drawContent(SkCanvas* canvas, SkColor color)
 #endif
     DBG_SET_LOG("start");
     m_contentMutex.lock();
-    PictureSet copyContent = PictureSet(m_content);
+    PictureSetSnapshot* snapshot = m_contentSnapshot;
+    snapshot->safeRef();
+    SkRegion tilesInval(m_tilesInval);
+    bool tilesCleared = m_tilesCleared;
+    bool tilesPreview = m_tilesPreview;
+    m_tilesInval.setEmpty();
+    m_tilesCleared = false;
     m_contentMutex.unlock();
+    if (!snapshot) {
+        canvas->drawColor(color);
+        return false;
+    }
+    m_drawnContentTraceId = snapshot->traceId();
+    TraceBufferAuto trace(TraceBuffer::DrawContentTrace, m_drawnContentTraceId);
+    PictureSet& content = snapshot->content();
+    if (tilesCleared)
+        m_contentTiles.clear();
+    m_contentTiles.setPreview(tilesPreview);
+    m_contentTiles.inval(tilesInval);
     int sc = canvas->save(SkCanvas::kClip_SaveFlag);
     SkRect clip;
-    clip.set(0, 0, copyContent.width(), copyContent.height());
+    clip.set(0, 0, content.width(), content.height());
     canvas->clipRect(clip, SkRegion::kDifference_Op);
     canvas->drawColor(color);
     canvas->restoreToCount(sc);
-    bool tookTooLong = copyContent.draw(canvas);
-    m_contentMutex.lock();
-    m_content.setDrawTimes(copyContent);
-    m_contentMutex.unlock();
+    sc = canvas->save(SkCanvas::kClip_SaveFlag);
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    SkDevice* device = canvas->getDevice();
+    if (!m_contentOcclusion.isEmpty() && device
+            && matrix.getScaleX() == m_occlusionScaleX
+            && matrix.getScaleY() == m_occlusionScaleY
+            && device->width() == m_occlusionWidth
+            && device->height() == m_occlusionHeight)
+        canvas->clipRegion(m_contentOcclusion, SkRegion::kDifference_Op);
+    bool tookTooLong = false;
+    if (!m_contentTiles.draw(canvas, snapshot, color, &tookTooLong)) {
+        tookTooLong = content.draw(canvas);
+        m_contentMutex.lock();
+        m_content.setDrawTimes(content);
+        m_contentMutex.unlock();
+    }
+    canvas->restoreToCount(sc);
+    tookTooLong |= content.wantsSplit();
+    snapshot->unref();
     DBG_SET_LOG("end");
     return tookTooLong;
 }
 
+void WebViewCore::setContentOcclusion(const SkRegion& occlusion,
+    SkScalar scaleX, SkScalar scaleY, int width, int height)
+{
+    m_contentOcclusion = occlusion;
+    m_occlusionScaleX = scaleX;
+    m_occlusionScaleY = scaleY;
+    m_occlusionWidth = width;
+    m_occlusionHeight = height;
+}
+
 bool WebViewCore::focusBoundsChanged()
 {
     bool result = m_focusBoundsChanged;
@@ -788,12 +1081,14 @@ bool WebViewCore::pictureReady()
 {
     bool done;
     m_contentMutex.lock();
-    PictureSet copyContent = PictureSet(m_content);
     done = m_progressDone;
     m_contentMutex.unlock();
+    PictureSetSnapshot* snapshot = acquireContent();
+    bool empty = !snapshot || snapshot->content().isEmpty();
+    snapshot->safeUnref();
     DBG_NAV_LOGD("done=%s empty=%s", done ? "true" : "false",
-        copyContent.isEmpty() ? "true" : "false");
-    return done || !copyContent.isEmpty();
+        empty ? "true" : "false");
+    return done || !empty;
 }
 
 SkPicture* WebViewCore::rebuildPicture(const SkIRect& inval)
@@ -843,17 +1138,55 @@ void WebViewCore::rebuildPictureSet(PictureSet* pictureSet)
     pictureSet->validate(__FUNCTION__);
 }
 
+// Animation ticks wait while a frame is on its way to the UI thread, so that
+// style doesn't change for frames that are never shown.
+static void setAnimationFramePending(WebCore::Frame* mainFrame)
+{
+    for (WebCore::Frame* frame = mainFrame; frame; frame = frame->tree()->traverseNext())
+        frame->animation()->framePending();
+}
+
+static void animationFrameDrawn(WebCore::Frame* mainFrame)
+{
+    for (WebCore::Frame* frame = mainFrame; frame; frame = frame->tree()->traverseNext())
+        frame->animation()->frameDrawn();
+}
+
+#if PICTURE_SET_DEBUG
+static unsigned animationSkippedTicks(WebCore::Frame* mainFrame)
+{
+    unsigned skipped = 0;
+    for (WebCore::Frame* frame = mainFrame; frame; frame = frame->tree()->traverseNext())
+        skipped += frame->animation()->skippedTicks();
+    return skipped;
+}
+#endif
+
 bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
 {
     DBG_SET_LOG("start");
+    // Leave m_addInval to accumulate; Resume records it all at once
+    if (m_isPaused) {
+        DBG_SET_LOG("paused");
+        flushPluginSurfaces();
+        animationFrameDrawn(m_mainFrame);
+        return false;
+    }
+    m_contentTraceId = TraceBuffer::newId();
     float progress = (float) m_mainFrame->page()->progress()->estimatedProgress();
     m_contentMutex.lock();
     PictureSet contentCopy(m_content);
     m_progressDone = progress <= 0.0f || progress >= 1.0f;
+    // once the page has loaded, new tiles are drawn at full quality
+    if (m_progressDone)
+        m_tilesPreview = false;
     m_contentMutex.unlock();
     recordPictureSet(&contentCopy);
+    // the layout above may have moved surface plugins; tell Java once
+    flushPluginSurfaces();
     if (!m_progressDone && contentCopy.isEmpty()) {
         DBG_SET_LOGD("empty (progress=%g)", progress);
+        animationFrameDrawn(m_mainFrame);
         return false;
     }
     region->set(m_addInval);
@@ -861,20 +1194,35 @@ bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
     region->op(m_rebuildInval, SkRegion::kUnion_Op);
     m_rebuildInval.setEmpty();
     m_contentMutex.lock();
+    if (m_showingHistorySnapshot) {
+        // all of the history snapshot is replaced, not just what was recorded
+        const PictureSet& shown = m_contentSnapshot->content();
+        region->op(0, 0, shown.width(), shown.height(), SkRegion::kUnion_Op);
+        m_tilesCleared = true;
+        m_showingHistorySnapshot = false;
+    }
     contentCopy.setDrawTimes(m_content);
     m_content.set(contentCopy);
+    m_tilesInval.op(*region, SkRegion::kUnion_Op);
     point->fX = m_content.width();
     point->fY = m_content.height();
     m_contentMutex.unlock();
+    publishContent(contentCopy);
     DBG_SET_LOGD("region={%d,%d,r=%d,b=%d}", region->getBounds().fLeft,
         region->getBounds().fTop, region->getBounds().fRight,
         region->getBounds().fBottom);
+    animationFrameDrawn(m_mainFrame);
+    DBG_SET_LOGD("invals=%d merged=%d coalesced=%d skippedTicks=%u",
+        m_invalCount, m_invalMergedCount, m_invalCoalescedCount,
+        animationSkippedTicks(m_mainFrame));
     DBG_SET_LOG("end");
     return true;
 }
 
 void WebViewCore::splitContent()
 {
+    m_contentTraceId = TraceBuffer::newId();
+    TraceBufferAuto trace(TraceBuffer::SplitContentTrace, m_contentTraceId);
     bool layoutSuceeded = layoutIfNeededRecursive(m_mainFrame);
     LOG_ASSERT(layoutSuceeded, "Can never be called recursively");
     PictureSet tempPictureSet;
@@ -885,6 +1233,18 @@ void WebViewCore::splitContent()
     m_contentMutex.lock();
     m_content.set(tempPictureSet);
     m_contentMutex.unlock();
+    // the UI is drawing a history snapshot, not m_content
+    if (m_showingHistorySnapshot)
+        return;
+    publishContent(tempPictureSet);
+}
+
+void WebViewCore::setSplitPolicy(uint32_t maxDrawTime, uint32_t mergeDrawTime,
+    uint32_t hotInvalCount)
+{
+    m_contentMutex.lock();
+    m_content.setSplitPolicy(maxDrawTime, mergeDrawTime, hotInvalCount);
+    m_contentMutex.unlock();
 }
 
 void WebViewCore::scrollTo(int x, int y, bool animate)
@@ -950,8 +1310,17 @@ void WebViewCore::setUIRootLayer(const LayerAndroid* layer)
 
 #endif // USE(ACCELERATED_COMPOSITING)
 
+// called from the PictureSetTiles render thread
+void WebViewCore::contentTileReady(void* context, const SkIRect& bounds)
+{
+    WebViewCore* viewImpl = static_cast<WebViewCore*>(context);
+    viewImpl->viewInvalidate(WebCore::IntRect(bounds.fLeft, bounds.fTop,
+        bounds.width(), bounds.height()));
+}
+
 void WebViewCore::contentDraw()
 {
+    setAnimationFramePending(m_mainFrame);
     JNIEnv* env = JSC::Bindings::getJNIEnv();
     env->CallVoidMethod(m_javaGlue->object(env).get(), m_javaGlue->m_contentDraw);
     checkException(env);
@@ -964,11 +1333,51 @@ void WebViewCore::contentInvalidate(const WebCore::IntRect &r)
     if (!rect.intersect(0, 0, INT_MAX, INT_MAX))
         return;
     m_addInval.op(rect, SkRegion::kUnion_Op);
+    m_invalCount++;
+    if (coalesceInval(&m_addInval))
+        m_invalCoalescedCount++;
     DBG_SET_LOGD("m_addInval={%d,%d,r=%d,b=%d}",
         m_addInval.getBounds().fLeft, m_addInval.getBounds().fTop,
         m_addInval.getBounds().fRight, m_addInval.getBounds().fBottom);
     if (!m_skipContentDraw)
-        contentDraw();
+        scheduleContentDraw();
+}
+
+// Script can invalidate thousands of times a second; tell Java at most once
+// per frame interval, and let the rest accumulate in m_addInval.
+void WebViewCore::scheduleContentDraw()
+{
+    const double CONTENT_DRAW_INTERVAL = 1.0 / 60;
+
+    if (m_contentDrawTimer.isActive()) {
+        m_invalMergedCount++;
+        return;
+    }
+    double now = WTF::currentTime();
+    double wait = m_lastContentDraw + CONTENT_DRAW_INTERVAL - now;
+    if (wait > 0) {
+        m_contentDrawTimer.startOneShot(wait);
+        return;
+    }
+    m_lastContentDraw = now;
+    contentDraw();
+}
+
+void WebViewCore::contentDrawTimerFired(WebCore::Timer<WebViewCore>*)
+{
+    m_lastContentDraw = WTF::currentTime();
+    contentDraw();
+}
+
+void WebViewCore::invalidateCounts(int* invals, int* merged,
+    int* coalesced) const
+{
+    if (invals)
+        *invals = m_invalCount;
+    if (merged)
+        *merged = m_invalMergedCount;
+    if (coalesced)
+        *coalesced = m_invalCoalescedCount;
 }
 
 void WebViewCore::offInvalidate(const WebCore::IntRect &r)
@@ -1120,6 +1529,9 @@ void WebViewCore::doMaxScroll(CacheBuilder::Direction dir)
     this->scrollBy(dx, dy, true);
 }
 
+// How often the rest of WebCore hears about a scroll in progress, in seconds
+static const double scrollSyncInterval = 0.25;
+
 void WebViewCore::setScrollOffset(int moveGeneration, int dx, int dy)
 {
     DBG_NAV_LOGD("{%d,%d} m_scrollOffset=(%d,%d)", dx, dy,
@@ -1132,21 +1544,101 @@ void WebViewCore::setScrollOffset(int moveGeneration, int dx, int dy)
         // testing work correctly.
         m_mainFrame->view()->platformWidget()->setLocation(m_scrollOffsetX,
                 m_scrollOffsetY);
+        m_pendingScrollMoved = true;
+    }
+    m_hasPendingScrollSync = true;
+    m_pendingScrollGeneration = moveGeneration;
+    // Fixed layers follow the scroll in WebView::drawExtras, so nothing
+    // drawn waits for this.
+    if (!m_scrollSyncTimer.isActive())
+        m_scrollSyncTimer.startOneShot(scrollSyncInterval);
+}
+
+// Any step that finds the timer idle starts it, so the end of a fling is
+// synced within an interval.
+void WebViewCore::scrollSyncTimerFired(WebCore::Timer<WebViewCore>*)
+{
+    flushScrollOffset();
+}
+
+// Brings WebCore up to the newest scroll offset before anything that
+// depends on it, such as input the page may handle.
+void WebViewCore::flushScrollOffset()
+{
+    m_scrollSyncTimer.stop();
+    if (!m_hasPendingScrollSync)
+        return;
+    m_hasPendingScrollSync = false;
+    if (m_pendingScrollMoved) {
+        m_pendingScrollMoved = false;
         m_mainFrame->eventHandler()->sendScrollEvent();
 
         // update the currently visible screen
         sendPluginVisibleScreen();
+        raiseVisibleImagePriority();
+        resumeVisibleAnimations();
     }
-    gCursorBoundsMutex.lock();
+    int moveGeneration = m_pendingScrollGeneration;
+    gCursorBoundsLock.readLock();
     bool hasCursorBounds = m_hasCursorBounds;
     Frame* frame = (Frame*) m_cursorFrame;
     IntPoint location = m_cursorLocation;
-    gCursorBoundsMutex.unlock();
+    gCursorBoundsLock.unlock();
     if (!hasCursorBounds)
         return;
     moveMouseIfLatest(moveGeneration, frame, location.x(), location.y());
 }
 
+void WebViewCore::raiseVisibleImagePriority()
+{
+    WebCore::Document* doc = m_mainFrame->document();
+    if (!doc || !doc->docLoader()->requestCount())
+        return;
+    WebCore::IntRect visibleRect(m_scrollOffsetX, m_scrollOffsetY,
+        m_screenWidth, m_screenHeight);
+    WebCore::Loader* loader = WebCore::cache()->loader();
+    RefPtr<WebCore::HTMLCollection> images = doc->images();
+    for (WebCore::Node* node = images->firstItem(); node;
+            node = images->nextItem()) {
+        WebCore::HTMLImageElement* image =
+            static_cast<WebCore::HTMLImageElement*>(node);
+        WebCore::CachedImage* cachedImage = image->cachedImage();
+        WebCore::RenderObject* renderer = image->renderer();
+        if (!cachedImage || cachedImage->isLoaded() || !renderer)
+            continue;
+        if (!visibleRect.intersects(renderer->absoluteBoundingBoxRect()))
+            continue;
+        DBG_NAV_LOGD("raise %s", cachedImage->url().latin1().data());
+        loader->raisePriority(cachedImage, WebCore::Loader::High);
+    }
+}
+
+void WebViewCore::resumeVisibleAnimations()
+{
+    WebCore::Document* doc = m_mainFrame->document();
+    if (!doc)
+        return;
+    WebCore::IntRect visibleRect(m_scrollOffsetX, m_scrollOffsetY,
+        m_screenWidth, m_screenHeight);
+    RefPtr<WebCore::HTMLCollection> images = doc->images();
+    for (WebCore::Node* node = images->firstItem(); node;
+            node = images->nextItem()) {
+        WebCore::HTMLImageElement* image =
+            static_cast<WebCore::HTMLImageElement*>(node);
+        WebCore::CachedImage* cachedImage = image->cachedImage();
+        WebCore::RenderObject* renderer = image->renderer();
+        if (!cachedImage || !cachedImage->isLoaded() || !renderer
+                || !cachedImage->image()->isBitmapImage())
+            continue;
+        WebCore::BitmapImage* bitmapImage =
+            static_cast<WebCore::BitmapImage*>(cachedImage->image());
+        if (!bitmapImage->isAnimationSuspended())
+            continue;
+        if (visibleRect.intersects(renderer->absoluteBoundingBoxRect()))
+            renderer->repaint();
+    }
+}
+
 void WebViewCore::setGlobalBounds(int x, int y, int h, int v)
 {
     DBG_NAV_LOGD("{%d,%d}", x, y);
@@ -1174,10 +1666,22 @@ void WebViewCore::setSizeScreenWidthAndScale(int width, int height,
             m_screenWidthScale = realScreenWidth * scale / screenWidth;
         else
             m_screenWidthScale = m_scale;
+        // redraw images that were decoded for a smaller zoom
+        if (WebCore::ImageSource::setDecodeScale(m_scale)) {
+            WebCore::FrameView* view = m_mainFrame->view();
+            contentInvalidate(WebCore::IntRect(0, 0, view->contentsWidth(),
+                view->contentsHeight()));
+        }
     }
     m_maxXScroll = screenWidth >> 2;
     m_maxYScroll = (screenWidth * height / width) >> 2;
-    if (ow != width || (!ignoreHeight && oh != height) || osw != screenWidth) {
+    // Layout only reads the screen width when it wraps text to fit it, so
+    // when a zoom leaves the view size alone there is nothing to reflow
+    // under the other layout algorithms.
+    WebCore::Settings* settings = m_mainFrame->settings();
+    bool textWrapWidthChanged = osw != screenWidth && settings
+        && settings->layoutAlgorithm() == WebCore::Settings::kLayoutFitColumnToScreen;
+    if (ow != width || (!ignoreHeight && oh != height) || textWrapWidthChanged) {
         WebCore::RenderObject *r = m_mainFrame->contentRenderer();
         DBG_NAV_LOGD("renderer=%p view=(w=%d,h=%d)", r,
             realScreenWidth, screenHeight);
@@ -1293,6 +1797,22 @@ void WebViewCore::dumpNavTree()
 #endif
 }
 
+void WebViewCore::measureContent(size_t* pictures, size_t* bytes)
+{
+    m_contentMutex.lock();
+    *pictures = m_content.size();
+    *bytes = m_content.flattenedSize();
+    m_contentMutex.unlock();
+}
+
+void WebViewCore::measureNavCache(int* nodes, size_t* bytes)
+{
+    *nodes = 0;
+    *bytes = 0;
+    if (m_frameCacheKit)
+        m_frameCacheKit->measure(nodes, bytes);
+}
+
 WebCore::HTMLAnchorElement* WebViewCore::retrieveAnchorElement(WebCore::Frame* frame, WebCore::Node* node)
 {
     if (!CacheBuilder::validNode(m_mainFrame, frame, node))
@@ -1341,12 +1861,12 @@ WebCore::String WebViewCore::requestLabel(WebCore::Frame* frame,
 
 void WebViewCore::updateCacheOnNodeChange()
 {
-    gCursorBoundsMutex.lock();
+    gCursorBoundsLock.readLock();
     bool hasCursorBounds = m_hasCursorBounds;
     Frame* frame = (Frame*) m_cursorFrame;
     Node* node = (Node*) m_cursorNode;
     IntRect bounds = m_cursorHitBounds;
-    gCursorBoundsMutex.unlock();
+    gCursorBoundsLock.unlock();
     if (!hasCursorBounds || !node)
         return;
     if (CacheBuilder::validNode(m_mainFrame, frame, node)) {
@@ -1376,6 +1896,8 @@ void WebViewCore::updateFrameCache()
 #ifdef ANDROID_INSTRUMENT
     TimeCounterAuto counter(TimeCounter::WebViewCoreBuildNavTimeCounter);
 #endif
+    // tied to the recording whose layout the cache describes
+    TraceBufferAuto trace(TraceBuffer::BuildNavTrace, m_contentTraceId);
     m_frameCacheOutOfDate = false;
 #if DEBUG_NAV_UI
     m_now = SkTime::GetMSecs();
@@ -1390,6 +1912,7 @@ void WebViewCore::updateFrameCache()
     CacheBuilder& builder = cacheBuilder();
     WebCore::Settings* settings = m_mainFrame->page()->settings();
     builder.allowAllTextDetection();
+    builder.setBuildBudget(m_navBuildBudget);
 #ifdef ANDROID_META_SUPPORT
     if (settings) {
         if (!settings->formatDetectionAddress())
@@ -1520,6 +2043,14 @@ void WebViewCore::notifyPluginsOnFrameLoad(const Frame* frame) {
     }
 }
 
+void WebViewCore::flushPluginSurfaces()
+{
+    PluginWidgetAndroid** iter = m_plugins.begin();
+    PluginWidgetAndroid** stop = m_plugins.end();
+    for (; iter < stop; ++iter)
+        (*iter)->flushSurfaceUpdate();
+}
+
 void WebViewCore::sendPluginVisibleScreen()
 {
     /* We may want to cache the previous values and only send the notification
@@ -1576,11 +2107,11 @@ static PluginView* nodeIsPlugin(Node* node) {
 }
 
 Node* WebViewCore::cursorNodeIsPlugin() {
-    gCursorBoundsMutex.lock();
+    gCursorBoundsLock.readLock();
     bool hasCursorBounds = m_hasCursorBounds;
     Frame* frame = (Frame*) m_cursorFrame;
     Node* node = (Node*) m_cursorNode;
-    gCursorBoundsMutex.unlock();
+    gCursorBoundsLock.unlock();
     if (hasCursorBounds && CacheBuilder::validNode(m_mainFrame, frame, node)
             && nodeIsPlugin(node)) {
         return node;
@@ -1669,6 +2200,7 @@ void WebViewCore::setSelection(int start, int end)
 
 void WebViewCore::deleteSelection(int start, int end, int textGeneration)
 {
+    checkTextfield();
     setSelection(start, end);
     if (start == end)
         return;
@@ -1692,6 +2224,7 @@ void WebViewCore::replaceTextfieldText(int oldStart,
         int oldEnd, const WebCore::String& replace, int start, int end,
         int textGeneration)
 {
+    checkTextfield();
     WebCore::Node* focus = currentFocus();
     if (!focus)
         return;
@@ -1735,6 +2268,36 @@ void WebViewCore::passToJs(int generation, const WebCore::String& current,
     m_blockTextfieldUpdates = false;
     m_textGeneration = generation;
     setFocusControllerActive(focus->document()->frame(), true);
+    m_textfieldCheckNode = focus;
+    m_textfieldCheckText = current;
+    if (!m_textfieldCheckTimer.isActive())
+        m_textfieldCheckTimer.startOneShot(0);
+}
+
+void WebViewCore::textfieldCheckTimerFired(WebCore::Timer<WebViewCore>*)
+{
+    checkTextfield();
+}
+
+// If the text changed differently than the UI expected during the keys
+// since the last check, update the UI text field.
+void WebViewCore::checkTextfield()
+{
+    if (!m_textfieldCheckNode)
+        return;
+    m_textfieldCheckTimer.stop();
+    WebCore::Node* checkNode = m_textfieldCheckNode;
+    WebCore::String current = m_textfieldCheckText;
+    m_textfieldCheckNode = 0;
+    m_textfieldCheckText = WebCore::String();
+    WebCore::Node* focus = currentFocus();
+    if (focus != checkNode) {
+        DBG_NAV_LOG("focus changed");
+        return;
+    }
+    WebCore::RenderObject* renderer = focus->renderer();
+    if (!renderer || (!renderer->isTextField() && !renderer->isTextArea()))
+        return;
     WebCore::RenderTextControl* renderText =
         static_cast<WebCore::RenderTextControl*>(renderer);
     WebCore::String test = renderText->text();
@@ -1742,7 +2305,6 @@ void WebViewCore::passToJs(int generation, const WebCore::String& current,
         DBG_NAV_LOG("test == current");
         return;
     }
-    // If the text changed during the key event, update the UI text field.
     updateTextfield(focus, false, test);
 }
 
@@ -1977,6 +2539,7 @@ void WebViewCore::listBoxRequest(WebCoreReply* reply, const uint16_t** labels, s
 
 bool WebViewCore::key(const PlatformKeyboardEvent& event)
 {
+    flushScrollOffset();
     WebCore::EventHandler* eventHandler = m_mainFrame->eventHandler();
     WebCore::Node* focusNode = currentFocus();
     if (focusNode)
@@ -1988,6 +2551,7 @@ bool WebViewCore::key(const PlatformKeyboardEvent& event)
 
 // For when the user clicks the trackball
 void WebViewCore::click(WebCore::Frame* frame, WebCore::Node* node) {
+    flushScrollOffset();
     if (!node) {
         WebCore::IntPoint pt = m_mousePos;
         pt.move(m_scrollOffsetX, m_scrollOffsetY);
@@ -2020,16 +2584,49 @@ GraphicsLayerAndroid* WebViewCore::graphicsRootLayer() const
 }
 #endif
 
-bool WebViewCore::handleTouchEvent(int action, int x, int y, int metaState)
+#if ENABLE(TOUCH_EVENTS)
+bool WebViewCore::dispatchTouchEvent(WebCore::TouchEventType type,
+    WebCore::PlatformTouchPoint::State touchState, const WebCore::IntPoint& pt,
+    int metaState)
 {
-    bool preventDefault = false;
-
 #if USE(ACCELERATED_COMPOSITING)
     GraphicsLayerAndroid* rootLayer = graphicsRootLayer();
     if (rootLayer)
       rootLayer->pauseDisplay(true);
 #endif
 
+    WebCore::PlatformTouchEvent te(pt, type, touchState, metaState);
+    bool preventDefault = m_mainFrame->eventHandler()->handleTouchEvent(te);
+
+#if USE(ACCELERATED_COMPOSITING)
+    if (rootLayer)
+      rootLayer->pauseDisplay(false);
+#endif
+    return preventDefault;
+}
+
+void WebViewCore::flushTouchMove()
+{
+    if (!m_hasPendingTouchMove)
+        return;
+    m_hasPendingTouchMove = false;
+    m_touchMoveTimer.stop();
+    if (dispatchTouchEvent(WebCore::TouchMove,
+            WebCore::PlatformTouchPoint::TouchMoved, m_pendingTouchMovePoint,
+            m_pendingTouchMoveMetaState))
+        m_touchMovePrevented = true;
+}
+
+void WebViewCore::touchMoveTimerFired(WebCore::Timer<WebViewCore>*)
+{
+    flushTouchMove();
+}
+#endif
+
+bool WebViewCore::handleTouchEvent(int action, int x, int y, int metaState)
+{
+    bool preventDefault = false;
+
 #if ENABLE(TOUCH_EVENTS) // Android
     WebCore::TouchEventType type = WebCore::TouchStart;
     WebCore::PlatformTouchPoint::State touchState = WebCore::PlatformTouchPoint::TouchPressed;
@@ -2064,6 +2661,11 @@ bool WebViewCore::handleTouchEvent(int action, int x, int y, int metaState)
         return 0;
     }
 
+    // A touch that starts during a fling stops it; let the page see where
+    // it stopped first.
+    if (type == WebCore::TouchStart)
+        flushScrollOffset();
+
     // Track previous touch and if stationary set the state.
     WebCore::IntPoint pt(x - m_scrollOffsetX, y - m_scrollOffsetY);
 
@@ -2075,13 +2677,26 @@ bool WebViewCore::handleTouchEvent(int action, int x, int y, int metaState)
 
     m_lastTouchPoint = pt;
 
-    WebCore::PlatformTouchEvent te(pt, type, touchState, metaState);
-    preventDefault = m_mainFrame->eventHandler()->handleTouchEvent(te);
-#endif
+    if (type == WebCore::TouchMove && m_touchMoveDispatched) {
+        m_pendingTouchMovePoint = pt;
+        m_pendingTouchMoveMetaState = metaState;
+        m_hasPendingTouchMove = true;
+        if (!m_touchMoveTimer.isActive())
+            m_touchMoveTimer.startOneShot(0);
+        return m_touchMovePrevented;
+    }
 
-#if USE(ACCELERATED_COMPOSITING)
-    if (rootLayer)
-      rootLayer->pauseDisplay(false);
+    // the DOM sees the last position before the touch ends or changes
+    flushTouchMove();
+    if (type == WebCore::TouchStart) {
+        m_touchMoveDispatched = false;
+        m_touchMovePrevented = false;
+    }
+    preventDefault = dispatchTouchEvent(type, touchState, pt, metaState);
+    if (type == WebCore::TouchMove) {
+        m_touchMoveDispatched = true;
+        m_touchMovePrevented = preventDefault;
+    }
 #endif
     return preventDefault;
 }
@@ -2109,6 +2724,7 @@ void WebViewCore::touchUp(int touchGeneration,
 // Common code for both clicking with the trackball and touchUp
 bool WebViewCore::handleMouseClick(WebCore::Frame* framePtr, WebCore::Node* nodePtr)
 {
+    flushScrollOffset();
     bool valid = framePtr == NULL
             || CacheBuilder::validNode(m_mainFrame, framePtr, nodePtr);
     WebFrame* webFrame = WebFrame::getWebFrame(m_mainFrame);
@@ -2969,6 +3585,14 @@ static void DumpV8Counters(JNIEnv*, jobject)
 #endif
 }
 
+// Called on demand, and by the Java side when it detects that the WebCore
+// thread has stopped responding, to capture what the thread was doing.
+static jboolean DumpTrace(JNIEnv* env, jobject, jstring path)
+{
+    WebCore::String pathString = to_string(env, path);
+    return TraceBuffer::dump(pathString.utf8().data());
+}
+
 static void SetJsFlags(JNIEnv *env, jobject obj, jstring flags)
 {
 #if USE(V8)
@@ -3065,6 +3689,7 @@ static void Pause(JNIEnv* env, jobject obj)
         Geolocation* geolocation = frame->domWindow()->navigator()->optionalGeolocation();
         if (geolocation)
             geolocation->suspend();
+        frame->animation()->suspendAnimations(frame->document());
     }
 
     ANPEvent event;
@@ -3082,6 +3707,7 @@ static void Resume(JNIEnv* env, jobject obj)
         Geolocation* geolocation = frame->domWindow()->navigator()->optionalGeolocation();
         if (geolocation)
             geolocation->resume();
+        frame->animation()->resumeAnimations(frame->document());
     }
 
     ANPEvent event;
@@ -3089,7 +3715,10 @@ static void Resume(JNIEnv* env, jobject obj)
     event.data.lifecycle.action = kResume_ANPLifecycleAction;
     GET_NATIVE_VIEW(env, obj)->sendPluginEvent(event);
 
-    GET_NATIVE_VIEW(env, obj)->setIsPaused(false);
+    WebViewCore* viewImpl = GET_NATIVE_VIEW(env, obj);
+    viewImpl->setIsPaused(false);
+    // catch up on everything invalidated while paused in one recording
+    viewImpl->contentDraw();
 }
 
 static void FreeMemory(JNIEnv* env, jobject obj)
@@ -3098,6 +3727,7 @@ static void FreeMemory(JNIEnv* env, jobject obj)
     SkANP::InitEvent(&event, kLifecycle_ANPEventType);
     event.data.lifecycle.action = kFreeMemory_ANPLifecycleAction;
     GET_NATIVE_VIEW(env, obj)->sendPluginEvent(event);
+    MemoryPressureHandler::releaseMemory();
 }
 
 static void ProvideVisitedHistory(JNIEnv *env, jobject obj, jobject hist)
@@ -3242,6 +3872,12 @@ static JNINativeMethod gJavaWebViewCoreMethods[] = {
         (void*) ValidNodeAndBounds },
 };
 
+// Older WebViewCore.java does not declare these
+static JNINativeMethod gJavaWebViewCoreOptionalMethods[] = {
+    { "nativeDumpTrace", "(Ljava/lang/String;)Z",
+        (void*) DumpTrace },
+};
+
 int register_webviewcore(JNIEnv* env)
 {
     jclass widget = env->FindClass("android/webkit/WebViewCore");
@@ -3289,6 +3925,11 @@ int register_webviewcore(JNIEnv* env)
     LOG_ASSERT(gWebViewCoreStaticMethods.m_supportsMimeType == NULL,
         "Could not find static method supportsMimeType from WebViewCore");
 
+    for (size_t index = 0; index < NELEM(gJavaWebViewCoreOptionalMethods); index++) {
+        if (env->RegisterNatives(widget, &gJavaWebViewCoreOptionalMethods[index], 1) < 0)
+            env->ExceptionClear();
+    }
+
     return jniRegisterNativeMethods(env, "android/webkit/WebViewCore",
             gJavaWebViewCoreMethods, NELEM(gJavaWebViewCoreMethods));
 }
@@ -9,6 +9,7 @@
 #include "CachedHistory.h"
 #include "PictureSet.h"
 #include "PlatformGraphicsContext.h"
+#include "PlatformTouchEvent.h"
 #include "SkColor.h"
 #include "SkTDArray.h"
 #include "SkRegion.h"
@@ -18,11 +19,13 @@
 #include <jni.h>
 #include <ui/KeycodeLabels.h>
 #include <ui/PixelFormat.h>
+#include <wtf/RefPtr.h>
 
 namespace WebCore {
     class AtomicString;
     class Color;
     class FrameView;
+    class HistoryItem;
     class HTMLAnchorElement;
     class HTMLSelectElement;
     class RenderPart;
@@ -129,6 +132,13 @@ namespace android {
          */
         void offInvalidate(const WebCore::IntRect &rect);
 
+        /**
+         * Counts of content invalidates received, of those merged into an
+         * already scheduled contentDraw, and of inval regions collapsed to
+         * their bounds. Any argument may be null.
+         */
+        void invalidateCounts(int* invals, int* merged, int* coalesced) const;
+
         /**
          * Called by webcore when the progress indicator is done
          * used to rebuild and display any changes in focus
@@ -340,6 +350,10 @@ namespace android {
         void dumpDomTree(bool);
         void dumpRenderTree(bool);
         void dumpNavTree();
+        // the recorded picture set: pictures and their serialized bytes
+        void measureContent(size_t* pictures, size_t* bytes);
+        // the nav cache built by webcore: nodes and the bytes holding them
+        void measureNavCache(int* nodes, size_t* bytes);
 
         /*  We maintain a list of active plugins. The list is edited by the
             pluginview itself. The list is used to service invals to the plugin
@@ -351,6 +365,8 @@ namespace android {
         bool isPlugin(PluginWidgetAndroid*) const;
         void invalPlugin(PluginWidgetAndroid*);
         void drawPlugins();
+        // send surface plugin moves deferred during layout to Java
+        void flushPluginSurfaces();
 
         // send the current screen size/zoom to all of the plugins in our list
         void sendPluginVisibleScreen();
@@ -417,11 +433,25 @@ namespace android {
         // reset the picture set to empty
         void clearContent();
 
+        // Keep a picture of what is visible of the page, scrolled to the
+        // item's scroll point, so that going back or forward to item shows
+        // it at once if the page has to load again.
+        void saveHistorySnapshot(WebCore::HistoryItem* );
+        // Show the picture saved for item, if any, until the page it loads
+        // records content of its own.
+        void restoreHistorySnapshot(WebCore::HistoryItem* );
+
         // flatten the picture set to a picture
         void copyContentToPicture(SkPicture* );
 
         // draw the picture set with the specified background color
         bool drawContent(SkCanvas* , SkColor );
+        // TraceBuffer id of the content drawContent last drew (UI thread)
+        uint32_t drawnContentTraceId() const { return m_drawnContentTraceId; }
+        // device area hidden by opaque fixed layers, skipped by drawContent
+        // while the canvas scale and size match the ones given here
+        void setContentOcclusion(const SkRegion& , SkScalar scaleX,
+            SkScalar scaleY, int width, int height);
         bool focusBoundsChanged();
         bool pictureReady();
 
@@ -438,6 +468,13 @@ namespace android {
 
         // utility to split slow parts of the picture set
         void splitContent();
+        // tune when splitContent() subdivides or merges pictures
+        void setSplitPolicy(uint32_t maxDrawTime, uint32_t mergeDrawTime,
+            uint32_t hotInvalCount);
+        // show low resolution tiles while a page loads
+        void setLowResFirstPaint(bool enabled) { m_lowResFirstPaint = enabled; }
+        // limit, in ms, on nav cache builds before text detection is skipped
+        void setNavBuildBudget(int ms) { m_navBuildBudget = ms; }
 
         // these members are shared with webview.cpp
         static Mutex gFrameCacheMutex;
@@ -454,7 +491,9 @@ namespace android {
         void* m_cursorFrame;
         IntPoint m_cursorLocation;
         void* m_cursorNode;
-        static Mutex gCursorBoundsMutex;
+        // Written only by the WebCore thread in updateCursorBounds(); the
+        // UI thread and the WebCore thread's readers share it.
+        static ReadWriteLock gCursorBoundsLock;
         // These two fields go together: we use the mutex to protect access to
         // m_buttons, so that we, and webview.cpp can look/modify the m_buttons
         // field safely from our respective threads
@@ -473,6 +512,11 @@ namespace android {
         // Then check the old buttons to see if any are no longer needed.
         void updateButtonList(WTF::Vector<Container>* buttons);
         void reset(bool fromConstructor);
+        // Ask the loader to favor images that are still loading in the
+        // visible part of the main frame.
+        void raiseVisibleImagePriority();
+        // Repaint animated images brought back into view while paused
+        void resumeVisibleAnimations();
 
         void listBoxRequest(WebCoreReply* reply, const uint16_t** labels,
                 size_t count, const int enabled[], size_t enabledCount,
@@ -488,12 +532,49 @@ namespace android {
         int m_lastFocusedSelStart;
         int m_lastFocusedSelEnd;
         static Mutex m_contentMutex; // protects ui/core thread pictureset access
-        PictureSet m_content; // the set of pictures to draw (accessed by UI too)
+        PictureSet m_content; // the set of pictures being recorded
+        // the last recorded m_content, for the UI to draw; the pointer is
+        // only swapped or referenced while holding m_contentMutex
+        PictureSetSnapshot* m_contentSnapshot;
+        PictureSetTiles m_contentTiles; // rasterized m_content (UI thread only)
+        // TraceBuffer id of the content update being recorded or split
+        uint32_t m_contentTraceId;
+        uint32_t m_drawnContentTraceId; // UI thread only
+        SkRegion m_tilesInval; // recorded since the UI last drew its tiles
+        bool m_tilesCleared; // content was reset since the UI last drew
+        bool m_tilesPreview; // the UI should preview tiles at low resolution
+        bool m_lowResFirstPaint;
+        int m_navBuildBudget;
+        SkRegion m_contentOcclusion; // see setContentOcclusion (UI thread only)
+        SkScalar m_occlusionScaleX;
+        SkScalar m_occlusionScaleY;
+        int m_occlusionWidth;
+        int m_occlusionHeight;
+        // pictures of pages left recently, bounded by count and by their
+        // serialized size; the most recent is last
+        struct HistorySnapshot {
+            RefPtr<WebCore::HistoryItem> item;
+            PictureSetSnapshot* content;
+            size_t bytes;
+        };
+        WTF::Vector<HistorySnapshot> m_historySnapshots;
+        size_t m_historySnapshotBytes;
+        void removeHistorySnapshot(size_t index);
+        // a history snapshot is published and no content recorded since
+        bool m_showingHistorySnapshot;
         SkRegion m_addInval; // the accumulated inval region (not yet drawn)
         SkRegion m_rebuildInval; // the accumulated region for rebuilt pictures
         // Used in passToJS to avoid updating the UI text field until after the
         // key event has been processed.
         bool m_blockTextfieldUpdates;
+        // passToJs compares the field with the UI's text once the keys queued
+        // behind it have been handled, instead of after every key, so a burst
+        // of typing reads the field's text (and sends it back) only once.
+        WebCore::Timer<WebViewCore> m_textfieldCheckTimer;
+        void textfieldCheckTimerFired(WebCore::Timer<WebViewCore>*);
+        void checkTextfield();
+        WebCore::Node* m_textfieldCheckNode; // only compared, never followed
+        WebCore::String m_textfieldCheckText; // the UI's text after the key
         bool m_focusBoundsChanged;
         bool m_skipContentDraw;
         // Passed in with key events to know when they were generated.  Store it
@@ -526,6 +607,31 @@ namespace android {
             this->drawPlugins();
         }
 
+        // batches contentInvalidate into at most one contentDraw per tick
+        WebCore::Timer<WebViewCore> m_contentDrawTimer;
+        void contentDrawTimerFired(WebCore::Timer<WebViewCore>*);
+        // rebuilds the nav cache, if needed, after content is recorded
+        WebCore::Timer<WebViewCore> m_navCacheTimer;
+        void navCacheTimerFired(WebCore::Timer<WebViewCore>*);
+        // The UI thread owns the scroll position and reports every step of
+        // a scroll or fling. Only the visible rect follows each step; the
+        // scroll event, plugin, image and cursor updates follow the newest
+        // offset at most once per scrollSyncInterval, and once it stops.
+        WebCore::Timer<WebViewCore> m_scrollSyncTimer;
+        void scrollSyncTimerFired(WebCore::Timer<WebViewCore>*);
+        void flushScrollOffset();
+        bool m_hasPendingScrollSync;
+        bool m_pendingScrollMoved;
+        int m_pendingScrollGeneration;
+        void scheduleContentDraw();
+        double m_lastContentDraw;
+        int m_invalCount;
+        int m_invalMergedCount;
+        int m_invalCoalescedCount;
+
+        static void contentTileReady(void* context, const SkIRect& bounds);
+        PictureSetSnapshot* acquireContent();
+        void publishContent(const PictureSet& );
         void doMaxScroll(CacheBuilder::Direction dir);
         SkPicture* rebuildPicture(const SkIRect& inval);
         void rebuildPictureSet(PictureSet* );
@@ -536,6 +642,22 @@ namespace android {
 #if ENABLE(TOUCH_EVENTS)
         bool m_forwardingTouchEvents;
         IntPoint m_lastTouchPoint;
+        bool dispatchTouchEvent(WebCore::TouchEventType ,
+            WebCore::PlatformTouchPoint::State , const WebCore::IntPoint& ,
+            int metaState);
+        // The first move of a gesture is dispatched at once, as its result
+        // decides whether the UI scrolls. Later moves only keep the newest
+        // position, which m_touchMoveTimer dispatches once the moves queued
+        // behind it have been handled; meanwhile Java is answered with what
+        // the gesture's earlier moves returned.
+        WebCore::Timer<WebViewCore> m_touchMoveTimer;
+        void touchMoveTimerFired(WebCore::Timer<WebViewCore>*);
+        void flushTouchMove();
+        bool m_touchMoveDispatched;
+        bool m_touchMovePrevented;
+        bool m_hasPendingTouchMove;
+        WebCore::IntPoint m_pendingTouchMovePoint;
+        int m_pendingTouchMoveMetaState;
 #endif
 
 #if DEBUG_NAV_UI
@@ -556,6 +678,10 @@ namespace android {
         // application context, otherwise NULL is returned.
         static jobject getApplicationContext();
 
+        // call only from webkit thread; frees the content tiles of every
+        // instance that are offscreen, and returns the bytes freed
+        static size_t discardOffscreenTiles();
+
         // Check whether a media mimeType is supported in Android media framework.
         static bool supportsMimeType(const WebCore::String& mimeType);
     };
@@ -38,6 +38,8 @@
 #include "WebCoreFrameBridge.h"
 #include "WebCoreViewBridge.h"
 #include "Widget.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/VectorSizeProfile.h>
 #include <wtf/unicode/Unicode.h>
 
 #ifdef DUMP_NAV_CACHE_USING_PRINTF
@@ -50,6 +52,7 @@
 #define MINIMUM_FOCUSABLE_WIDTH 3
 #define MINIMUM_FOCUSABLE_HEIGHT 3
 #define MAXIMUM_FOCUS_RING_COUNT 32
+#define MAX_NOTHING_DETECTED 4096
 
 namespace android {
 
@@ -725,11 +728,22 @@ void CacheBuilder::Debug::wideString(const String& str) {
 CacheBuilder::CacheBuilder()
 {
     mAllowableTypes = ALL_CACHEDNODE_BITS;
+    mLastBuilt = NULL;
+    mLastBuiltVersion = 0;
+    mLastBuiltTypes = ALL_CACHEDNODE_BITS;
+    bzero(&mBuildStats, sizeof(mBuildStats));
+    mBuildStart = 0;
+    mBuildBudget = 0;
 #ifdef DUMP_NAV_CACHE_USING_PRINTF
     gNavCacheLogFile = NULL;
 #endif
 }
 
+CacheBuilder::~CacheBuilder()
+{
+    delete mLastBuilt;
+}
+
 void CacheBuilder::adjustForColumns(const ClipColumnTracker& track, 
     CachedNode* node, IntRect* bounds)
 {
@@ -818,9 +832,19 @@ bool CacheBuilder::AnyIsClick(Node* node)
 void CacheBuilder::buildCache(CachedRoot* root)
 {
     Frame* frame = FrameAnd(this);
+    bzero(&mBuildStats, sizeof(mBuildStats));
+    mBuildStart = WTF::currentTime();
     BuildFrame(frame, frame, root, (CachedFrame*) root);
     root->finishInit(); // set up frame parent pointers, child pointers
     setData((CachedFrame*) root);
+    mBuildStats.mBuildTime = (WTF::currentTime() - mBuildStart) * 1000;
+    root->measure(&mBuildStats.mNodes, &mBuildStats.mMemory);
+    root->setPartial(mBuildStats.mPartial);
+    DBG_NAV_LOGD("frames=%d reused=%d nodes=%d text=%d detect=%gms"
+        " build=%gms memory=%d partial=%s", mBuildStats.mFrames,
+        mBuildStats.mReusedFrames, mBuildStats.mNodes, mBuildStats.mTextNodes,
+        mBuildStats.mDetectionTime, mBuildStats.mBuildTime,
+        (int) mBuildStats.mMemory, mBuildStats.mPartial ? "true" : "false");
 }
 
 static Node* ParentWithChildren(Node* node)
@@ -893,7 +917,11 @@ static void AddLayer(CachedFrame* frame, size_t index, const IntPoint& location,
 void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
     CachedRoot* cachedRoot, CachedFrame* cachedFrame)
 {
-    WTF::Vector<FocusTracker> tracker(1); // sentinel
+    mBuildStats.mFrames++;
+    // The trackers grow with the nesting depth of the DOM, which rarely
+    // exceeds a dozen levels, so keep them off the heap.
+    WTF::Vector<FocusTracker, 16> tracker(1); // sentinel
+    PROFILE_VECTOR_SIZE(tracker);
     {
         FocusTracker* baseTracker = tracker.data();
         bzero(baseTracker, sizeof(FocusTracker));
@@ -901,9 +929,11 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
     }
     WTF::Vector<LayerTracker> layerTracker(1); // sentinel
     bzero(layerTracker.data(), sizeof(LayerTracker));
-    WTF::Vector<ClipColumnTracker> clipTracker(1); // sentinel
+    WTF::Vector<ClipColumnTracker, 16> clipTracker(1); // sentinel
+    PROFILE_VECTOR_SIZE(clipTracker);
     bzero(clipTracker.data(), sizeof(ClipColumnTracker));
-    WTF::Vector<TabIndexTracker> tabIndexTracker(1); // sentinel
+    WTF::Vector<TabIndexTracker, 16> tabIndexTracker(1); // sentinel
+    PROFILE_VECTOR_SIZE(tabIndexTracker);
     bzero(tabIndexTracker.data(), sizeof(TabIndexTracker));
 #if DUMP_NAV_CACHE
     char* frameNamePtr = cachedFrame->mDebug.mFrameName;
@@ -984,7 +1014,19 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
 #endif
             cachedFrame->add(cachedNode);
             CachedFrame* childPtr = cachedFrame->lastChild();
+            CacheBuilder* childBuilder = Builder(child);
+            childBuilder->mAllowableTypes = mAllowableTypes;
+            if (childBuilder->reuseFrame(child, cachedRoot, childFrameIndex,
+                    childPtr)) {
+                mBuildStats.mReusedFrames++;
+                continue;
+            }
             BuildFrame(root, child, cachedRoot, childPtr);
+            // a frame missing some detected text must not be copied later
+            if (mBuildStats.mPartial)
+                childBuilder->forgetFrame();
+            else
+                childBuilder->saveFrame(child, *childPtr);
             continue;
         }
         int tabIndex = node->tabIndex();
@@ -1117,9 +1159,21 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
         if (node->isTextNode() && mAllowableTypes != NORMAL_CACHEDNODE_BITS) {
             if (last->mSomeParentTakesFocus) // don't look at text inside focusable node
                 continue;
+            if (mBuildStats.mPartial)
+                continue;
             CachedNodeType checkType;
-            if (isFocusableText(&walk, more, node, &checkType, 
-                    &exported) == false)
+            double detectStart = WTF::currentTime();
+            bool focusable = isFocusableText(&walk, more, node, &checkType,
+                &exported);
+            double detectEnd = WTF::currentTime();
+            mBuildStats.mTextNodes++;
+            mBuildStats.mDetectionTime += (detectEnd - detectStart) * 1000;
+            if (mBuildBudget && (detectEnd - mBuildStart) * 1000 > mBuildBudget) {
+                LOGW("nav cache build passed its %dms budget; text detection"
+                    " skipped for the rest of the page", mBuildBudget);
+                mBuildStats.mPartial = true;
+            }
+            if (focusable == false)
                 continue;
         #if DUMP_NAV_CACHE
             { 
@@ -1133,6 +1187,7 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
             type = checkType;
             // !!! test ! is the following line correctly needed for frames to work?
             cachedNode.init(node);
+            cachedNode.mCursorRing.swap(mRingScratch);
             const ClipColumnTracker& clipTrack = clipTracker.last();
             const IntRect& clip = clipTrack.mHasClip ? clipTrack.mBounds :
                 IntRect(0, 0, INT_MAX, INT_MAX);
@@ -1232,6 +1287,7 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
         computeCursorRings = true;
     keepNode:
         cachedNode.init(node);
+        cachedNode.mCursorRing.swap(mRingScratch);
         if (computeCursorRings == false) {
             cachedNode.setBounds(bounds);
             cachedNode.mCursorRing.append(bounds);
@@ -1305,6 +1361,10 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
             node, nodeIndex, (Node*) cachedNode.parentGroup());
 #endif
         cachedFrame->add(cachedNode);
+        // the frame's copy holds the rings at their exact size; keep the
+        // working storage for the next node
+        cachedNode.mCursorRing.swap(mRingScratch);
+        mRingScratch.shrink(0);
         {
             int lastIndex = cachedFrame->size() - 1;
             if (node == focused) {
@@ -1331,6 +1391,65 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
     }
 }
 
+// Combines everything a frame's nav cache depends on, for the frame and its
+// subframes: the document, DOM mutations, layouts, position and size. Returns
+// zero if the cache can't be reused, e.g. because it holds the focus, which
+// the builder records in the root as it goes.
+unsigned CacheBuilder::FrameVersion(Frame* frame)
+{
+    unsigned version = 1;
+    for (Frame* test = frame; test; test = test->tree()->traverseNext(frame)) {
+        Document* doc = test->document();
+        FrameView* view = test->view();
+        if (!doc || !view || doc->focusedNode())
+            return 0;
+        int x, y;
+        GetGlobalOffset(test, &x, &y);
+        unsigned values[] = { reinterpret_cast<unsigned>(doc),
+            doc->domTreeVersion(), view->layoutCount(),
+            x, y, view->contentsWidth(), view->contentsHeight() };
+        for (size_t index = 0; index < sizeof(values) / sizeof(values[0]); index++)
+            version = version * 31 + values[index];
+    }
+    return version ? version : 1;
+}
+
+// Replaces result with the cache built for frame last time, if nothing it
+// depends on has changed since.
+bool CacheBuilder::reuseFrame(Frame* frame, const CachedRoot* cachedRoot,
+    int childFrameIndex, CachedFrame* result) const
+{
+    if (!mLastBuilt || mLastBuiltTypes != mAllowableTypes)
+        return false;
+    unsigned version = FrameVersion(frame);
+    if (!version || version != mLastBuiltVersion)
+        return false;
+    DBG_NAV_LOGD("frame=%p nodes=%d", frame, mLastBuilt->size());
+    *result = *mLastBuilt;
+    result->reuse(cachedRoot, childFrameIndex);
+    return true;
+}
+
+void CacheBuilder::forgetFrame()
+{
+    delete mLastBuilt;
+    mLastBuilt = NULL;
+}
+
+void CacheBuilder::saveFrame(Frame* frame, const CachedFrame& built)
+{
+    mLastBuiltVersion = FrameVersion(frame);
+    mLastBuiltTypes = mAllowableTypes;
+    if (!mLastBuiltVersion) {
+        delete mLastBuilt;
+        mLastBuilt = NULL;
+        return;
+    }
+    if (!mLastBuilt)
+        mLastBuilt = new CachedFrame();
+    *mLastBuilt = built;
+}
+
 bool CacheBuilder::CleanUpContainedNodes(CachedRoot* cachedRoot,
     CachedFrame* cachedFrame, const FocusTracker* last, int lastChildIndex)
 {
@@ -2611,6 +2730,20 @@ bool CacheBuilder::IsDomainChar(UChar ch)
     return (body[ch >> 5] & 1 << (ch & 0x1f)) != 0;
 }
 
+// Identifies what detection sees of a text node: its characters, how they
+// are broken into lines, and which kinds of text are being detected.
+unsigned CacheBuilder::TextDetectionKey(StringImpl* string,
+    InlineTextBox* first, CachedNodeBits types)
+{
+    unsigned key = string->hash() + types;
+    for (InlineTextBox* box = first; box; box = box->nextTextBox())
+        key = (key * 31 + box->start()) * 31 + box->len();
+    // zero and all ones are reserved by HashSet<unsigned>
+    if (!key || key == (unsigned) -1)
+        key = 1;
+    return key;
+}
+
 bool CacheBuilder::isFocusableText(NodeWalk* walk, bool more, Node* node, 
     CachedNodeType* type, String* exported) const
 {
@@ -2635,10 +2768,17 @@ bool CacheBuilder::isFocusableText(NodeWalk* walk, bool more, Node* node,
     FoundState state = FOUND_NONE;
     RenderText* renderer = (RenderText*) node->renderer();
     bool foundBetter = false;
+    bool foundPartial = false;
     InlineTextBox* baseInline = walk->mLastInline != NULL ? walk->mLastInline :
         renderer->firstTextBox();
     if (baseInline == NULL)
         return false;
+    unsigned detectionKey = 0;
+    if (more == false) {
+        detectionKey = TextDetectionKey(string, baseInline, mAllowableTypes);
+        if (mNothingDetected.contains(detectionKey))
+            return false;
+    }
     int start = walk->mEnd;
     InlineTextBox* saveInline;
     int baseStart, firstStart = start;
@@ -2687,6 +2827,7 @@ bool CacheBuilder::isFocusableText(NodeWalk* walk, bool more, Node* node,
                 if (wasInitialized != findState.mInitialized)
                     firstStart = start;
                 if (state == FOUND_PARTIAL) {
+                    foundPartial = true;
                     lastPartialNode = node;
                     lastPartialEnd = findState.mEndResult + start;
                     lastPartialMore = firstPartial && 
@@ -2795,6 +2936,13 @@ tryNextCheckType:
         string = textNode->dataImpl();
         baseChars = string->characters();
     }
+    // A node is only remembered if no match started in it; a partial match
+    // depends on the nodes that follow, which may change independently.
+    if (detectionKey && !foundBetter && !foundPartial) {
+        if (mNothingDetected.size() >= MAX_NOTHING_DETECTED)
+            mNothingDetected.clear();
+        mNothingDetected.add(detectionKey);
+    }
     if (foundBetter) {
         CachedNodeType temp = *type;
         switch (temp) {
@@ -2975,7 +3123,8 @@ bool CacheBuilder::AddPartRect(IntRect& bounds, int x, int y,
 bool CacheBuilder::ConstructPartRects(Node* node, const IntRect& bounds, 
     IntRect* focusBounds, int x, int y, WTF::Vector<IntRect>* result)
 {
-    WTF::Vector<ClipColumnTracker> clipTracker(1);
+    WTF::Vector<ClipColumnTracker, 16> clipTracker(1);
+    PROFILE_VECTOR_SIZE(clipTracker);
     ClipColumnTracker* baseTracker = clipTracker.data(); // sentinel
     bzero(baseTracker, sizeof(ClipColumnTracker));
     if (node->hasChildNodes() && node->hasTagName(HTMLNames::buttonTag) == false
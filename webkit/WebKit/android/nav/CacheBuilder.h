@@ -8,6 +8,7 @@
 #include "IntRect.h"
 #include "PlatformString.h"
 #include "TextDirection.h"
+#include "wtf/HashSet.h"
 #include "wtf/Vector.h"
 
 #define NAVIGATION_MAX_PHONE_LENGTH 24
@@ -54,9 +55,22 @@ public:
         FOUND_PARTIAL,
         FOUND_COMPLETE
     };
+    // What the last buildCache() built and what it cost
+    struct BuildStats {
+        int mFrames; // frames walked, including the main frame
+        int mReusedFrames; // subframes copied from the previous build
+        int mNodes; // cached nodes in the whole tree
+        int mTextNodes; // text nodes checked for addresses, email, phones
+        double mDetectionTime; // ms spent in text detection
+        double mBuildTime; // ms spent in the whole build
+        size_t mMemory; // bytes held by the cached tree
+        bool mPartial; // text detection was cut off by the budget
+    };
     CacheBuilder();
+    ~CacheBuilder();
     void allowAllTextDetection() { mAllowableTypes = ALL_CACHEDNODE_BITS; }
     void buildCache(CachedRoot* root);
+    const BuildStats& buildStats() const { return mBuildStats; }
     static bool ConstructPartRects(Node* node, const IntRect& bounds, 
         IntRect* focusBounds, int x, int y, WTF::Vector<IntRect>* result);
     Node* currentFocus() const;
@@ -69,6 +83,9 @@ public:
     static FoundState FindAddress(const UChar* , unsigned length, int* start,
         int* end, bool caseInsensitive);
     static IntRect getAreaRect(const HTMLAreaElement* area);
+    // Past this many ms into a build, text detection is skipped for the
+    // rest of it; 0 means no limit.
+    void setBuildBudget(int ms) { mBuildBudget = ms; }
     static void GetGlobalOffset(Frame* , int* x, int * y);
     static void GetGlobalOffset(Node* , int* x, int * y);
     static bool validNode(Frame* startFrame, void* framePtr, void* nodePtr);
@@ -194,6 +211,11 @@ private:
         CachedRoot* cachedRoot, CachedFrame* cachedFrame);
     bool CleanUpContainedNodes(CachedRoot* cachedRoot, CachedFrame* cachedFrame, 
         const FocusTracker* last, int lastChildIndex);
+    static unsigned FrameVersion(Frame* );
+    bool reuseFrame(Frame* , const CachedRoot* , int childFrameIndex,
+        CachedFrame* result) const;
+    void saveFrame(Frame* , const CachedFrame& );
+    void forgetFrame();
     static bool ConstructTextRect(Text* textNode,
         InlineTextBox* textBox, int start, int relEnd, int x, int y, 
         IntRect* focusBounds, const IntRect& clip, WTF::Vector<IntRect>* result);
@@ -216,6 +238,8 @@ private:
     bool isFocusableText(NodeWalk* , bool oldMore, Node* , CachedNodeType* type,
         String* exported) const; //returns true if it is focusable
     static bool IsMailboxChar(UChar ch);
+    static unsigned TextDetectionKey(StringImpl* , InlineTextBox* first,
+        CachedNodeBits types);
     static bool IsRealNode(Frame* , Node* );
     int overlap(int left, int right); // returns distance scale factor as 16.16 scalar
     bool setData(CachedFrame* );
@@ -226,6 +250,20 @@ private:
     Node* tryFocus(Direction direction);
     Node* trySegment(Direction direction, int mainStart, int mainEnd);
     CachedNodeBits mAllowableTypes;
+    // the last nav cache built for this (sub)frame, kept while the frame's
+    // DOM and layout are unchanged so the next build can copy it
+    CachedFrame* mLastBuilt;
+    unsigned mLastBuiltVersion;
+    CachedNodeBits mLastBuiltTypes;
+    // keys of text nodes that contained nothing to detect on their own, and
+    // so can be skipped while their text and line breaks stay the same
+    mutable WTF::HashSet<unsigned> mNothingDetected;
+    // Rings are collected here, then copied into the frame at their exact
+    // size, instead of each node growing and dropping its own vector.
+    WTF::Vector<IntRect> mRingScratch;
+    BuildStats mBuildStats;
+    double mBuildStart; // seconds, when the current build began
+    int mBuildBudget;
 #if DUMP_NAV_CACHE
 public:
     class Debug {
@@ -359,6 +359,122 @@ CachedNode* CachedFrame::find(WebCore::Node* node) // !!! probably debugging onl
 }
 #endif
 
+// frames with fewer nodes than this are scanned linearly
+#define NODE_GRID_MIN_NODES 64
+#define NODE_GRID_NODES_PER_CELL 4
+#define NODE_GRID_MIN_CELL 32
+#define NODE_GRID_MAX_CELLS 4096
+#define NODE_GRID_MAX_NODE_CELLS 64 // larger nodes are always tested
+
+static WebCore::IntRect nodeHull(const CachedNode* node)
+{
+    WebCore::IntRect hull = node->hitBounds(NULL);
+    for (size_t part = 0; part < node->navableRects(); part++)
+        hull.unite(node->ring(NULL, part));
+    return hull;
+}
+
+void CachedFrame::buildNodeGrid() const
+{
+    NodeGrid& grid = mNodeGrid;
+    grid.mBuilt = true;
+    grid.mBounds = WebCore::IntRect();
+    int count = mCachedNodes.size();
+    for (int index = 1; index < count; index++) {
+        const CachedNode* node = &mCachedNodes[index];
+        if (!node->isInLayer())
+            grid.mBounds.unite(nodeHull(node));
+    }
+    int64_t area = static_cast<int64_t>(grid.mBounds.width())
+        * grid.mBounds.height();
+    int cellSize = NODE_GRID_MIN_CELL;
+    while (static_cast<int64_t>(cellSize) * cellSize * count
+            < area * NODE_GRID_NODES_PER_CELL)
+        cellSize <<= 1;
+    while (((grid.mBounds.width() + cellSize - 1) / cellSize)
+            * ((grid.mBounds.height() + cellSize - 1) / cellSize)
+            > NODE_GRID_MAX_CELLS)
+        cellSize <<= 1;
+    grid.mCellSize = cellSize;
+    grid.mColumns = (grid.mBounds.width() + cellSize - 1) / cellSize;
+    grid.mRows = (grid.mBounds.height() + cellSize - 1) / cellSize;
+    int cells = grid.mColumns * grid.mRows;
+    grid.mCellStart.fill(0, cells + 1);
+    grid.mCells.clear();
+    grid.mGridAlways.clear();
+    // count, then fill, so each cell's indices stay in node order
+    for (int pass = 0; pass < 2; pass++) {
+        WTF::Vector<int> next;
+        if (pass) {
+            for (int cell = 0; cell < cells; cell++)
+                grid.mCellStart[cell + 1] += grid.mCellStart[cell];
+            grid.mCells.resize(grid.mCellStart[cells]);
+            next.append(grid.mCellStart.data(), cells);
+        }
+        for (int index = 1; index < count; index++) {
+            const CachedNode* node = &mCachedNodes[index];
+            WebCore::IntRect hull;
+            if (!node->isInLayer())
+                hull = nodeHull(node);
+            if (hull.isEmpty() && !node->isInLayer())
+                continue;
+            hull.move(-grid.mBounds.x(), -grid.mBounds.y());
+            int left = hull.x() / cellSize;
+            int top = hull.y() / cellSize;
+            int right = (hull.right() - 1) / cellSize;
+            int bottom = (hull.bottom() - 1) / cellSize;
+            if (node->isInLayer() || (right - left + 1) * (bottom - top + 1)
+                    > NODE_GRID_MAX_NODE_CELLS) {
+                if (pass)
+                    grid.mGridAlways.append(index);
+                continue;
+            }
+            for (int y = top; y <= bottom; y++) {
+                for (int x = left; x <= right; x++) {
+                    int cell = y * grid.mColumns + x;
+                    if (pass)
+                        grid.mCells[next[cell]++] = index;
+                    else
+                        grid.mCellStart[cell + 1]++;
+                }
+            }
+        }
+    }
+}
+
+// Fills indices, in ascending order, with the nodes that may intersect rect.
+// Returns false if the frame is small enough to be scanned instead.
+bool CachedFrame::nodesAt(const WebCore::IntRect& rect,
+    WTF::Vector<int>* indices) const
+{
+    if (mCachedNodes.size() < NODE_GRID_MIN_NODES)
+        return false;
+    if (!mNodeGrid.mBuilt)
+        buildNodeGrid();
+    const NodeGrid& grid = mNodeGrid;
+    indices->append(grid.mGridAlways.data(), grid.mGridAlways.size());
+    WebCore::IntRect area = rect;
+    area.intersect(grid.mBounds);
+    if (!area.isEmpty()) {
+        area.move(-grid.mBounds.x(), -grid.mBounds.y());
+        int left = area.x() / grid.mCellSize;
+        int top = area.y() / grid.mCellSize;
+        int right = (area.right() - 1) / grid.mCellSize;
+        int bottom = (area.bottom() - 1) / grid.mCellSize;
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                int cell = y * grid.mColumns + x;
+                indices->append(grid.mCells.data() + grid.mCellStart[cell],
+                    grid.mCellStart[cell + 1] - grid.mCellStart[cell]);
+            }
+        }
+    }
+    std::sort(indices->begin(), indices->end());
+    indices->shrink(std::unique(indices->begin(), indices->end())
+        - indices->begin());
+    return true;
+}
+
 const CachedNode* CachedFrame::findBestAt(const WebCore::IntRect& rect,
     int* best, bool* inside, const CachedNode** directHit,
     const CachedFrame** directHitFramePtr,
@@ -370,7 +486,11 @@ const CachedNode* CachedFrame::findBestAt(const WebCore::IntRect& rect,
     WebCore::IntPoint center = WebCore::IntPoint(rect.x() + (rectWidth >> 1),
         rect.y() + (rect.height() >> 1));
     mRoot->setupScrolledBounds();
-    for (const CachedNode* test = mCachedNodes.begin(); test != mCachedNodes.end(); test++) {
+    WTF::Vector<int> candidates;
+    bool useGrid = nodesAt(rect, &candidates);
+    size_t count = useGrid ? candidates.size() : mCachedNodes.size();
+    for (size_t index = 0; index < count; index++) {
+        const CachedNode* test = &mCachedNodes[useGrid ? candidates[index] : index];
         if (test->disabled())
             continue;
         size_t parts = test->navableRects();
@@ -487,8 +607,11 @@ const CachedNode* CachedFrame::findBestHitAt(const WebCore::IntRect& rect,
         if (NULL != frameResult)
             return frameResult;
     }
-    for (const CachedNode* test = mCachedNodes.end() - 1;
-            test != mCachedNodes.begin() - 1; test--) {
+    WTF::Vector<int> candidates;
+    bool useGrid = nodesAt(rect, &candidates);
+    size_t count = useGrid ? candidates.size() : mCachedNodes.size();
+    for (size_t index = count; index-- > 0; ) {
+        const CachedNode* test = &mCachedNodes[useGrid ? candidates[index] : index];
         if (test->disabled())
             continue;
         WebCore::IntRect testRect = test->hitBounds(this);
@@ -894,6 +1017,17 @@ void CachedFrame::init(const CachedRoot* root, int childFrameIndex,
     mIndexInParent = childFrameIndex;
 }
 
+void CachedFrame::reuse(const CachedRoot* root, int childFrameIndex)
+{
+    mRoot = root;
+    mParent = NULL; // set up by finishInit()
+    mIndexInParent = childFrameIndex;
+    for (CachedFrame* frame = mCachedFrames.begin(); frame != mCachedFrames.end();
+            frame++)
+        frame->reuse(root, frame->mIndexInParent);
+    resetLayers();
+}
+
 #if USE(ACCELERATED_COMPOSITING)
 const CachedLayer* CachedFrame::layer(const CachedNode* node) const
 {
@@ -917,6 +1051,25 @@ WebCore::IntRect CachedFrame::localBounds(const CachedNode* node,
 #endif
 }
 
+void CachedFrame::measure(int* nodes, size_t* bytes) const
+{
+    *nodes += mCachedNodes.size();
+    *bytes += mCachedNodes.capacity() * sizeof(CachedNode)
+        + mCachedFrames.capacity() * sizeof(CachedFrame)
+        + mCachedTextInputs.capacity() * sizeof(CachedInput)
+#if USE(ACCELERATED_COMPOSITING)
+        + mCachedLayers.capacity() * sizeof(CachedLayer)
+#endif
+        + (mNodeGrid.mCellStart.capacity() + mNodeGrid.mCells.capacity()
+        + mNodeGrid.mGridAlways.capacity()) * sizeof(int);
+    for (const CachedNode* node = mCachedNodes.begin();
+            node != mCachedNodes.end(); node++)
+        *bytes += node->heapSize();
+    for (const CachedFrame* child = mCachedFrames.begin();
+            child != mCachedFrames.end(); child++)
+        child->measure(nodes, bytes);
+}
+
 int CachedFrame::minWorkingHorizontal() const
 {
     return history()->minWorkingHorizontal();
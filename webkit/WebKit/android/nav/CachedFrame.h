@@ -85,6 +85,8 @@ public:
     void hideCursor();
     int indexInParent() const { return mIndexInParent; }
     void init(const CachedRoot* root, int index, WebCore::Frame* frame);
+    // adopts a copy of this frame's cache from an earlier build
+    void reuse(const CachedRoot* root, int index);
     const CachedFrame* lastChild() const { return &mCachedFrames.last(); }
 #if USE(ACCELERATED_COMPOSITING)
     const CachedLayer* lastLayer() const { return &mCachedLayers.last(); }
@@ -95,6 +97,8 @@ public:
     const CachedLayer* layer(const CachedNode* ) const;
     size_t layerCount() const { return mCachedLayers.size(); }
 #endif
+    // adds the nodes and bytes held by this frame and its subframes
+    void measure(int* nodes, size_t* bytes) const;
     WebCore::IntRect localBounds(const CachedNode* ,
         const WebCore::IntRect& ) const;
     const CachedFrame* parent() const { return mParent; }
@@ -193,6 +197,8 @@ private: // since computing these is complicated, protect them so that the
         BestData* ) const;
     const CachedNode* frameUp(const CachedNode* test, const CachedNode* limit, 
         BestData* ) const;
+    bool nodesAt(const WebCore::IntRect& , WTF::Vector<int>* indices) const;
+    void buildNodeGrid() const;
     int minWorkingHorizontal() const;
     int minWorkingVertical() const;
     int maxWorkingHorizontal() const;
@@ -208,6 +214,22 @@ private: // since computing these is complicated, protect them so that the
 #if USE(ACCELERATED_COMPOSITING)
     WTF::Vector<CachedLayer> mCachedLayers;
 #endif
+    // Uniform grid of node indices, built on the first hit test of a frame
+    // with many nodes. Each cell lists, in order, the nodes whose rings or
+    // hit bounds touch it; mGridAlways lists nodes in layers (which move)
+    // and nodes too big to bucket.
+    struct NodeGrid {
+        NodeGrid() : mBuilt(false) {}
+        WebCore::IntRect mBounds;
+        int mCellSize;
+        int mColumns;
+        int mRows;
+        WTF::Vector<int> mCellStart; // mColumns * mRows + 1 offsets
+        WTF::Vector<int> mCells;
+        WTF::Vector<int> mGridAlways;
+        bool mBuilt;
+    };
+    mutable NodeGrid mNodeGrid;
     void* mFrame; // WebCore::Frame*, used only to compare pointers
     CachedFrame* mParent;
     int mCursorIndex;
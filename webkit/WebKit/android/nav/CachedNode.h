@@ -80,6 +80,9 @@ public:
     const WebCore::String& getExport() const { return mExport; }
     bool hasCursorRing() const { return mHasCursorRing; }
     bool hasMouseOver() const { return mHasMouseOver; }
+    // bytes allocated outside the node for its rings and exported text
+    size_t heapSize() const { return mCursorRing.capacity()
+        * sizeof(WebCore::IntRect) + mExport.length() * sizeof(UChar); }
     void hideCursor(CachedFrame* );
     WebCore::IntRect hitBounds(const CachedFrame* ) const;
     int index() const { return mIndex; }
@@ -153,18 +156,15 @@ public:
     bool wantsKeyEvents() const { return isTextInput() || isPlugin(); }
 private:
     friend class CacheBuilder;
-    WebCore::String mExport;
+    // Fields read for every node by the navigation and hit test loops come
+    // first, so that a node is usually rejected after touching one cache
+    // line; the rest are only read once a node is a candidate.
     WebCore::IntRect mBounds;
-    WebCore::IntRect mHitBounds;
-    WebCore::IntRect mOriginalAbsoluteBounds;
-    WTF::Vector<WebCore::IntRect> mCursorRing;
-    void* mNode; // WebCore::Node*, only used to match pointers
-    void* mParentGroup; // WebCore::Node*, only used to match pointers
-    int mDataIndex; // child frame if a frame; input data index; or -1
     int mIndex; // index of itself, to find first in array (document)
-    int mNavableRects; // FIXME: could be bitfield once I limit max number of rects
     int mParentIndex;
-    int mTabIndex;
+    int mDataIndex; // child frame if a frame; input data index; or -1
+    int mNavableRects; // FIXME: could be bitfield once I limit max number of rects
+    void* mParentGroup; // WebCore::Node*, only used to match pointers
     mutable Condition mCondition : 5; // why the node was not chosen on the first pass
     CachedNodeType mType : 4;
     bool mClippedOut : 1;
@@ -182,6 +182,12 @@ private:
     bool mLast : 1;             // true if this is the last node in a group
     bool mUseBounds : 1;
     bool mUseHitBounds : 1;
+    int mTabIndex;
+    void* mNode; // WebCore::Node*, only used to match pointers
+    WebCore::IntRect mHitBounds;
+    WebCore::IntRect mOriginalAbsoluteBounds;
+    WTF::Vector<WebCore::IntRect> mCursorRing;
+    WebCore::String mExport;
 #ifdef BROWSER_DEBUG
 public:
     WebCore::Node* webCoreNode() const { return (WebCore::Node*) mNode; }
@@ -1281,6 +1281,7 @@ void CachedRoot::reset()
     mRootLayer = 0;
     mSelectionStart = mSelectionEnd = -1;
     mScrollOnly = false;
+    mPartial = false;
 }
 
 bool CachedRoot::scrollDelta(WebCore::IntRect& newOutset, Direction direction, int* delta)
@@ -41,6 +41,8 @@ public:
     int getAndResetSelectionEnd();
     int getAndResetSelectionStart();
     int getBlockLeftEdge(int x, int y, float scale) const;
+    // true if the build ran out of time before detecting all text links
+    bool isPartial() const { return mPartial; }
     void getSimulatedMousePosition(WebCore::IntPoint* ) const;
     void init(WebCore::Frame* , CachedHistory* );
     bool innerDown(const CachedNode* , BestData* ) const;
@@ -72,6 +74,7 @@ public:
     void setFocusBounds(const WebCore::IntRect& r) { mFocusBounds = r; }
     void setTextGeneration(int textGeneration) { mTextGeneration = textGeneration; }
     void setMaxScroll(int x, int y) { mMaxXScroll = x; mMaxYScroll = y; }
+    void setPartial(bool partial) { mPartial = partial; }
     void setPicture(SkPicture* picture) { mPicture = picture; }
     void setRootLayer(WebCore::LayerAndroid* layer) { mRootLayer = layer; }
     void setScrollOnly(bool state) { mScrollOnly = state; }
@@ -98,6 +101,7 @@ private:
     mutable const CachedNode* mCursor;
     mutable SkRegion mBaseUncovered;
     bool mScrollOnly;
+    bool mPartial;
 #if DUMP_NAV_CACHE
 public:
     class Debug {
@@ -51,6 +51,9 @@ GlyphSet::GlyphSet(const SkPaint& paint, const UChar* lower, const UChar* upper,
     SkPaint clonePaint(paint);
     clonePaint.setTextEncoding(SkPaint::kUTF16_TextEncoding);
     mTypeface = paint.getTypeface();
+    mTypefaceID = SkTypeface::UniqueID(mTypeface);
+    mQuery.append(lower, byteLength >> 1);
+    mQuery.append(upper, byteLength >> 1);
     //mCount = clonePaint.textToGlyphs(lower, byteLength, NULL);
     mBufSize = byteLength;
     if (mBufSize > MAX_STORAGE_COUNT) {
@@ -78,18 +81,14 @@ GlyphSet::~GlyphSet() {
     // part of mLowerGlyphs
 }
 
-GlyphSet::GlyphSet& GlyphSet::operator=(GlyphSet& src) {
-    mTypeface = src.mTypeface;
-    mCount = src.mCount;
-    mBufSize = src.mBufSize;
-    if (mBufSize > MAX_STORAGE_COUNT) {
-        mLowerGlyphs = new uint16_t[2*mBufSize];
-    } else {
-        mLowerGlyphs = &mStorage[0];
-    }
-    memcpy(mLowerGlyphs, src.mLowerGlyphs, 2*mBufSize*sizeof(uint16_t));
-    mUpperGlyphs = mLowerGlyphs + mBufSize;
-    return *this;
+bool GlyphSet::isFor(const SkTypeface* typeface, const UChar* lower,
+        const UChar* upper, size_t byteLength) const {
+    size_t length = byteLength >> 1;
+    if (SkTypeface::UniqueID(typeface) != mTypefaceID
+            || mQuery.size() != 2 * length)
+        return false;
+    return !memcmp(mQuery.data(), lower, length * sizeof(UChar))
+            && !memcmp(mQuery.data() + length, upper, length * sizeof(UChar));
 }
 
 bool GlyphSet::characterMatches(uint16_t c, int index) {
@@ -97,6 +96,25 @@ bool GlyphSet::characterMatches(uint16_t c, int index) {
     return c == mLowerGlyphs[index] || c == mUpperGlyphs[index];
 }
 
+// FindIndex methods
+////////////////////////////////////////////////////////////////////////////////
+
+// Every match of a query begins with a match of any prefix of it, so a query
+// that extends the last one can only match within the runs that one did.
+bool FindIndex::extendsQuery(const UChar* lower, size_t length) const {
+    size_t queryLength = mQuery.size();
+    if (!queryLength || queryLength > length)
+        return false;
+    return !memcmp(mQuery.data(), lower, queryLength * sizeof(UChar));
+}
+
+void FindIndex::setQuery(const UChar* lower, size_t length,
+        const WTF::Vector<int>& runs) {
+    mQuery.clear();
+    mQuery.append(lower, length);
+    mQueryRuns = runs;
+}
+
 // FindCanvas methods
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -113,6 +131,9 @@ FindCanvas::FindCanvas(int width, int height, const UChar* lower,
     mWorkingIndex = 0;
     mWorkingCanvas = 0;
     mWorkingPicture = 0;
+    mRecordIndex = 0;
+    mCurrentRun = -1;
+    mMatchRunStart = -1;
 }
 
 FindCanvas::~FindCanvas() {
@@ -120,6 +141,8 @@ FindCanvas::~FindCanvas() {
     /* Just in case getAndClear was not called. */
     delete mMatches;
     mWorkingPicture->safeUnref();
+    for (GlyphSet** ptr = mGlyphSets.begin(); ptr != mGlyphSets.end(); ptr++)
+        (*ptr)->unref();
 }
 
 // Each version of addMatch returns a rectangle for a match.
@@ -237,11 +260,13 @@ void FindCanvas::drawText(const void* text, size_t byteLength, SkScalar x,
      
      SkPaint clonePaint(paint);
      clonePaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+     recordRun(FindTextRun::NORMAL, glyphBuf, 2*mCount, &x, 1, y, clonePaint);
      findHelper(glyphBuf, 2*mCount, clonePaint, &x, y, &FindCanvas::addMatchNormal);
      delete glyphBuf;
      return;
    }
 
+    recordRun(FindTextRun::NORMAL, text, byteLength, &x, 1, y, paint);
     findHelper(text, byteLength, paint, &x, y, &FindCanvas::addMatchNormal);
 }
 
@@ -250,6 +275,8 @@ void FindCanvas::drawPosText(const void* text, size_t byteLength,
     // Pass in the first y coordinate for y so that we can check to see whether
     // it is lower than the last draw call (to check if we are continuing to
     // another line).
+    recordRun(FindTextRun::POS, text, byteLength, (const SkScalar*) pos,
+        (byteLength >> 1) * 2, pos[0].fY, paint);
     findHelper(text, byteLength, paint, (const SkScalar*) pos, pos[0].fY,
             &FindCanvas::addMatchPos);
 }
@@ -257,6 +284,8 @@ void FindCanvas::drawPosText(const void* text, size_t byteLength,
 void FindCanvas::drawPosTextH(const void* text, size_t byteLength,
                               const SkScalar xpos[], SkScalar constY,
                               const SkPaint& paint) {
+    recordRun(FindTextRun::POS_H, text, byteLength, xpos, byteLength >> 1,
+        constY, paint);
     findHelper(text, byteLength, paint, xpos, constY,
             &FindCanvas::addMatchPosH);
 }
@@ -309,6 +338,7 @@ void FindCanvas::findHelper(const void* text, size_t byteLength,
                     // We already know that it is not clipped out because we
                     // checked for that before saving the working region.
                     insertMatchInfo(mWorkingRegion);
+                    markMatchRuns();
 
                     resetWorkingCanvas();
                     mWorkingIndex = 0;
@@ -335,10 +365,13 @@ void FindCanvas::findHelper(const void* text, size_t byteLength,
         if (glyphSet->characterMatches(chars[index], j)) {
             // The jth character in the search text matches the indexth position
             // in the drawn text, so increase j.
+            if (j == 0)
+                mMatchRunStart = mCurrentRun;
             j++;
             if (j != count) {
                 continue;
             }
+            markMatchRuns();
             // The last count characters match, so we found the entire
             // search string.
             int remaining = count - mWorkingIndex;
@@ -445,6 +478,60 @@ void FindCanvas::findHelper(const void* text, size_t byteLength,
     mWorkingIndex = 0;
 }
 
+void FindCanvas::markMatchRuns() {
+    if (mCurrentRun < 0)
+        return;
+    int run = mMatchRunStart < 0 ? mCurrentRun : mMatchRunStart;
+    if (mTouchedRuns.size() && mTouchedRuns.last() >= run)
+        run = mTouchedRuns.last() + 1;
+    for ( ; run <= mCurrentRun; run++)
+        mTouchedRuns.append(run);
+}
+
+void FindCanvas::recordRun(FindTextRun::Kind kind, const void* text,
+        size_t byteLength, const SkScalar positions[], int positionCount,
+        SkScalar y, const SkPaint& paint) {
+    if (!mRecordIndex)
+        return;
+    FindTextRun* run = new FindTextRun;
+    run->mPaint = paint;
+    run->mMatrix = getTotalMatrix();
+    run->mClip = getTotalClip();
+    run->mGlyphs.append((const uint16_t*) text, byteLength >> 1);
+    run->mPositions.append(positions, positionCount);
+    run->mY = y;
+    run->mKind = kind;
+    run->mLayerId = mLayerId;
+    mCurrentRun = mRecordIndex->runCount();
+    mRecordIndex->appendRun(run);
+}
+
+void FindCanvas::search(const FindIndex& index, const WTF::Vector<int>* runs) {
+    int runCount = index.runCount();
+    int count = runs ? runs->size() : runCount;
+    int next = 0;
+    for (int i = 0; i < count; i++) {
+        int start = runs ? (*runs)[i] : i;
+        if (start < next)
+            continue; // already searched as part of a partial match
+        mCurrentRun = start;
+        do {
+            const FindTextRun& run = index.run(mCurrentRun);
+            setMatrix(run.mMatrix);
+            clipRegion(run.mClip, SkRegion::kReplace_Op);
+            mLayerId = run.mLayerId;
+            SkRect (FindCanvas::*addMatch)(int, const SkPaint&, int,
+                const uint16_t*, const SkScalar[], SkScalar) = run.mKind == FindTextRun::POS ?
+                &FindCanvas::addMatchPos : run.mKind == FindTextRun::POS_H ?
+                &FindCanvas::addMatchPosH : &FindCanvas::addMatchNormal;
+            findHelper(run.mGlyphs.data(), run.mGlyphs.size() << 1,
+                run.mPaint, run.mPositions.data(), run.mY, addMatch);
+        } while (mWorkingIndex && ++mCurrentRun < runCount);
+        next = mCurrentRun + 1;
+    }
+    mCurrentRun = -1;
+}
+
 SkCanvas* FindCanvas::getWorkingCanvas() {
     if (!mWorkingPicture) {
         mWorkingPicture = new SkPicture;
@@ -453,18 +540,43 @@ SkCanvas* FindCanvas::getWorkingCanvas() {
     return mWorkingCanvas;
 }
 
+// The glyph sets most recently used by any FindCanvas, least recent first.
+// Typing a query, finding it again after the page changes, and searching each
+// layer all convert the same query for the same typefaces. Find only runs on
+// the UI thread, so the cache is not locked.
+#define MAX_SHARED_GLYPH_SETS 16
+static SkTDArray<GlyphSet*> gSharedGlyphSets;
+
 GlyphSet* FindCanvas::getGlyphs(const SkPaint& paint) {
     SkTypeface* typeface = paint.getTypeface();
-    GlyphSet* end = mGlyphSets.end();
-    for (GlyphSet* ptr = mGlyphSets.begin();ptr != end; ptr++) {
-        if (ptr->getTypeface() == typeface) {
-            return ptr;
+    GlyphSet** end = mGlyphSets.end();
+    for (GlyphSet** ptr = mGlyphSets.begin();ptr != end; ptr++) {
+        if ((*ptr)->getTypeface() == typeface) {
+            return *ptr;
         }
     }
 
-    GlyphSet set(paint, mLowerText, mUpperText, mLength);
+    GlyphSet* set = 0;
+    for (int index = gSharedGlyphSets.count(); --index >= 0; ) {
+        GlyphSet* shared = gSharedGlyphSets[index];
+        if (shared->isFor(typeface, mLowerText, mUpperText, mLength)) {
+            set = shared;
+            gSharedGlyphSets.remove(index);
+            break;
+        }
+    }
+    if (!set) {
+        set = new GlyphSet(paint, mLowerText, mUpperText, mLength);
+        if (gSharedGlyphSets.count() >= MAX_SHARED_GLYPH_SETS) {
+            gSharedGlyphSets[0]->unref();
+            gSharedGlyphSets.remove(0);
+        }
+    }
+    // the cache keeps its reference, now as the most recently used set
+    *gSharedGlyphSets.append() = set;
+    set->ref();
     *mGlyphSets.append() = set;
-    return &(mGlyphSets.top());
+    return set;
 }
 
 void FindCanvas::insertMatchInfo(const SkRegion& region) {
@@ -10,6 +10,7 @@
 #include "SkPicture.h"
 #include "SkRegion.h"
 #include "SkTDArray.h"
+#include "SkTypeface.h"
 #include "icu/unicode/umachine.h"
 #include "wtf/Vector.h"
 
@@ -41,12 +42,13 @@ private:
 
 // A class containing a typeface for reference, the length in glyphs, and
 // the upper and lower case representations of the search string.
-class GlyphSet {
+// GlyphSets are shared by all FindCanvases through a small cache of the most
+// recently used ones; see FindCanvas::getGlyphs.
+class GlyphSet : public SkRefCnt {
 public:
     GlyphSet(const SkPaint& paint, const UChar* lower, const UChar* upper,
             size_t byteLength);
-    ~GlyphSet();
-    GlyphSet& operator=(GlyphSet& src);
+    virtual ~GlyphSet();
 
     // Return true iff c matches one of our glyph arrays at index
     bool characterMatches(uint16_t c, int index);
@@ -55,12 +57,18 @@ public:
 
     const SkTypeface* getTypeface() const { return mTypeface; }
 
-private:
-    // Disallow copy constructor
-    GlyphSet(GlyphSet& src) { }
+    // Return true if this set was built for the same typeface and query
+    bool isFor(const SkTypeface* typeface, const UChar* lower,
+            const UChar* upper, size_t byteLength) const;
 
+private:
     // mTypeface is used for comparison only
     const SkTypeface* mTypeface;
+    // The typeface pointer only identifies the typeface while a canvas is
+    // playing back a picture; the shared cache matches on its unique ID.
+    uint32_t    mTypefaceID;
+    // The lower case query followed by the upper case one
+    WTF::Vector<UChar> mQuery;
     // mLowerGlyphs points to all of our storage space: the lower set followed
     // by the upper set.  mUpperGlyphs is purely a convenience pointer to the
     // start of the upper case glyphs.
@@ -84,6 +92,47 @@ private:
     uint16_t    mStorage[2*MAX_STORAGE_COUNT];
 };
 
+// A text draw captured from a picture, in glyphs, along with the matrix, clip
+// and layer it was drawn with, so that it can be searched again without
+// playing back the picture.
+class FindTextRun {
+public:
+    enum Kind {
+        NORMAL, // mPositions holds the x origin
+        POS, // mPositions holds an x, y pair per glyph
+        POS_H // mPositions holds an x per glyph
+    };
+    SkPaint mPaint;
+    SkMatrix mMatrix;
+    SkRegion mClip;
+    WTF::Vector<uint16_t> mGlyphs;
+    WTF::Vector<SkScalar> mPositions;
+    SkScalar mY;
+    Kind mKind;
+    int mLayerId;
+};
+
+// The text runs of the root picture and its layers, captured by the first
+// search and reused by the following ones until the content changes. It also
+// remembers which runs held the matches of the last query, so that a query
+// extending it only needs to look at those runs.
+class FindIndex {
+public:
+    FindIndex() {}
+    ~FindIndex() { deleteAllValues(mRuns); }
+    void appendRun(FindTextRun* run) { mRuns.append(run); }
+    bool extendsQuery(const UChar* lower, size_t length) const;
+    const WTF::Vector<int>& queryRuns() const { return mQueryRuns; }
+    const FindTextRun& run(int index) const { return *mRuns[index]; }
+    int runCount() const { return mRuns.size(); }
+    void setQuery(const UChar* lower, size_t length,
+        const WTF::Vector<int>& runs);
+private:
+    WTF::Vector<FindTextRun*> mRuns;
+    WTF::Vector<UChar> mQuery;
+    WTF::Vector<int> mQueryRuns;
+};
+
 class FindBounder : public SkBounder {
 public:
     FindBounder() {}
@@ -119,7 +168,15 @@ public:
 
     void drawLayers(LayerAndroid* );
     int found() const { return mNumFound; }
+    // Search the captured runs instead of a picture. If runs is not NULL,
+    // only those runs, and the ones a partial match continues into, are
+    // searched.
+    void search(const FindIndex& , const WTF::Vector<int>* runs);
     void setLayerId(int layerId) { mLayerId = layerId; }
+    // Capture each text draw into index while searching it
+    void setRecordIndex(FindIndex* index) { mRecordIndex = index; }
+    // Runs that held a match, in ascending order
+    const WTF::Vector<int>& touchedRuns() const { return mTouchedRuns; }
 
     // This method detaches our array of matches and passes ownership to
     // the caller, who is then responsible for deleting them.
@@ -166,6 +223,14 @@ private:
     // Store all the accumulated info about a match in our vector.
     void insertMatchInfo(const SkRegion& region);
 
+    // Note that the runs from mMatchRunStart to mCurrentRun held a match.
+    void markMatchRuns();
+
+    // Add a text draw to mRecordIndex, if set, and make it the current run.
+    void recordRun(FindTextRun::Kind kind, const void* text,
+        size_t byteLength, const SkScalar positions[], int positionCount,
+        SkScalar y, const SkPaint& paint);
+
     // Throw away our cumulative information about our working SkCanvas.  After
     // this call, next call to getWorkingCanvas will create a new one.
     void resetWorkingCanvas();
@@ -179,35 +244,46 @@ private:
     FindBounder             mBounder;
     int                     mNumFound;
     SkScalar                mOutset;
-    SkTDArray<GlyphSet>     mGlyphSets;
+    SkTDArray<GlyphSet*>    mGlyphSets;
 
     SkPicture*              mWorkingPicture;
     SkCanvas*               mWorkingCanvas;
     SkRegion                mWorkingRegion;
     int                     mWorkingIndex;
     int                     mLayerId;
+
+    FindIndex*              mRecordIndex;
+    WTF::Vector<int>        mTouchedRuns;
+    int                     mCurrentRun;
+    int                     mMatchRunStart;
 };
 
 class FindOnPage : public DrawExtra {
 public:
     FindOnPage() {
         m_matches = 0;
+        m_index = 0;
         m_hasCurrentLocation = false;
         m_isFindPaintSetUp = false;
     }
-    virtual ~FindOnPage() { delete m_matches; }
+    virtual ~FindOnPage() { delete m_matches; delete m_index; }
     void clearCurrentLocation() { m_hasCurrentLocation = false; }
+    // Called when the content the index was captured from goes away
+    void clearIndex() { delete m_index; m_index = 0; }
     IntRect currentMatchBounds() const;
     int currentMatchIndex() const { return m_findIndex; }
     bool currentMatchIsInLayer() const;
     virtual void draw(SkCanvas* , LayerAndroid* );
     void findNext(bool forward);
+    FindIndex* index() const { return m_index; }
+    void setIndex(FindIndex* index) { delete m_index; m_index = index; }
     void setMatches(WTF::Vector<MatchInfo>* matches);
 private:
     void drawMatch(const SkRegion& region, SkCanvas* canvas, bool focused);
     void setUpFindPaint();
     void storeCurrentMatchLocation();
     WTF::Vector<MatchInfo>* m_matches;
+    FindIndex* m_index;
     // Stores the location of the current match.
     SkIPoint m_currentMatchLocation;
     // Tells whether the value in m_currentMatchLocation is valid.
@@ -20,6 +20,7 @@
 #include "SkUtils.h"
 #include "TextRun.h"
 #include "TimeCounter.h"
+#include "wtf/Vector.h"
 
 #ifdef DEBUG_NAV_UI
 #include "CString.h"
@@ -1136,6 +1137,191 @@ public:
     CommonCheck& mBounder;
 };
 
+// The glyph boxes of a picture, captured in one playback, so that dragging a
+// selection end finds the closest glyph without playing the picture back
+// again. Boxes are bucketed into horizontal bands by their centers; the
+// lookup visits bands outward from the point and returns what FirstCheck
+// would have found for the same area.
+#define SNAPSHOT_BAND_HEIGHT 64
+#define SNAPSHOT_MAX_GLYPHS 65536
+
+class TextSnapshot {
+public:
+    TextSnapshot(const SkPicture* picture);
+    ~TextSnapshot() { mPicture->unref(); }
+    bool closest(int x, int y, const SkIRect& area, SkIRect* bounds,
+        int* base) const;
+    const SkPicture* picture() const { return mPicture; }
+private:
+    struct Glyph {
+        SkIRect mRect; // as passed to the bounder
+        int mTop; // line top and bottom, from the font metrics
+        int mBottom;
+        int mBase;
+    };
+    friend class SnapshotCheck;
+    void add(const SkIRect& rect, int top, int bottom, int base);
+    void buildBands();
+    const SkPicture* mPicture;
+    WTF::Vector<Glyph> mGlyphs; // in drawing order
+    WTF::Vector<int> mBandStart; // first entry in mBandGlyphs for each band
+    WTF::Vector<int> mBandGlyphs; // glyph indices, ascending in each band
+    int mMinCenter; // smallest top + bottom of any glyph
+    bool mOverflow; // too many glyphs to keep; hit test by playback instead
+};
+
+class SnapshotCheck : public CommonCheck {
+public:
+    SnapshotCheck(int width, int height, TextSnapshot* snapshot)
+        : INHERITED(width, height)
+        , mSnapshot(snapshot)
+    {
+    }
+
+    virtual bool onIRectGlyph(const SkIRect& rect,
+        const SkBounder::GlyphRec& )
+    {
+        mSnapshot->add(rect, top(), bottom(), base());
+        return false;
+    }
+
+private:
+    TextSnapshot* mSnapshot;
+    typedef CommonCheck INHERITED;
+};
+
+TextSnapshot::TextSnapshot(const SkPicture* picture)
+    : mPicture(picture)
+    , mMinCenter(0)
+    , mOverflow(false)
+{
+    mPicture->ref();
+    SkIRect area;
+    area.set(0, 0, picture->width(), picture->height());
+    SnapshotCheck check(area.width(), area.height(), this);
+    TextCanvas checker(&check, area);
+    checker.drawPicture(const_cast<SkPicture&>(*picture));
+    if (mOverflow)
+        mGlyphs.clear();
+    else
+        buildBands();
+}
+
+void TextSnapshot::add(const SkIRect& rect, int top, int bottom, int base)
+{
+    if (mOverflow || mGlyphs.size() >= SNAPSHOT_MAX_GLYPHS) {
+        mOverflow = true;
+        return;
+    }
+    Glyph glyph;
+    glyph.mRect = rect;
+    glyph.mTop = top;
+    glyph.mBottom = bottom;
+    glyph.mBase = base;
+    mGlyphs.append(glyph);
+}
+
+void TextSnapshot::buildBands()
+{
+    int count = mGlyphs.size();
+    if (!count)
+        return;
+    int minCenter = INT_MAX;
+    int maxCenter = INT_MIN;
+    for (int index = 0; index < count; index++) {
+        int center = mGlyphs[index].mTop + mGlyphs[index].mBottom;
+        minCenter = std::min(minCenter, center);
+        maxCenter = std::max(maxCenter, center);
+    }
+    mMinCenter = minCenter;
+    // centers are doubled, so a band spans twice its height in them
+    int bands = (maxCenter - minCenter) / (SNAPSHOT_BAND_HEIGHT << 1) + 1;
+    mBandStart.fill(0, bands + 1);
+    for (int index = 0; index < count; index++) {
+        int band = (mGlyphs[index].mTop + mGlyphs[index].mBottom - minCenter)
+            / (SNAPSHOT_BAND_HEIGHT << 1);
+        mBandStart[band + 1]++;
+    }
+    for (int band = 0; band < bands; band++)
+        mBandStart[band + 1] += mBandStart[band];
+    mBandGlyphs.resize(count);
+    WTF::Vector<int> next;
+    next.append(mBandStart.data(), bands);
+    for (int index = 0; index < count; index++) {
+        int band = (mGlyphs[index].mTop + mGlyphs[index].mBottom - minCenter)
+            / (SNAPSHOT_BAND_HEIGHT << 1);
+        mBandGlyphs[next[band]++] = index;
+    }
+}
+
+// Returns false if the picture had too many glyphs to capture. Otherwise
+// sets bounds and base as FirstCheck would for a playback clipped to area:
+// the nearest glyph by its center, the first drawn winning ties.
+bool TextSnapshot::closest(int x, int y, const SkIRect& area,
+    SkIRect* bounds, int* base) const
+{
+    if (mOverflow)
+        return false;
+    bounds->set(area.fLeft, area.fTop, area.fLeft, area.fTop);
+    *base = area.fTop;
+    int bands = mBandStart.size() - 1;
+    if (bands <= 0)
+        return true;
+    int bandSpan = SNAPSHOT_BAND_HEIGHT << 1;
+    int focusCenter = y << 1;
+    int focusBand = (focusCenter - mMinCenter) / bandSpan;
+    if (focusCenter < mMinCenter)
+        focusBand = 0;
+    else if (focusBand >= bands)
+        focusBand = bands - 1;
+    int bestDistance = INT_MAX;
+    int bestIndex = -1;
+    for (int step = 0; step < bands; step++) {
+        bool searched = false;
+        for (int side = 0; side < 2; side++) {
+            if (step == 0 && side)
+                break;
+            int band = side ? focusBand + step : focusBand - step;
+            if (band < 0 || band >= bands)
+                continue;
+            int low = mMinCenter + band * bandSpan;
+            int high = low + bandSpan - 1;
+            int gap = focusCenter < low ? low - focusCenter
+                : focusCenter > high ? focusCenter - high : 0;
+            if (bestIndex >= 0 && (int64_t) gap * gap > bestDistance)
+                continue;
+            searched = true;
+            for (int entry = mBandStart[band]; entry < mBandStart[band + 1];
+                    entry++) {
+                int index = mBandGlyphs[entry];
+                const Glyph& glyph = mGlyphs[index];
+                // the bounder only sees the part of a glyph inside the clip
+                SkIRect rect;
+                if (!rect.intersect(glyph.mRect, area))
+                    continue;
+                int dx = rect.fLeft + rect.fRight - (x << 1);
+                int dy = glyph.mTop + glyph.mBottom - focusCenter;
+                int distance = dx * dx + dy * dy;
+                if (distance < bestDistance || (distance == bestDistance
+                        && index < bestIndex)) {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+        }
+        if (!searched && bestIndex >= 0)
+            break;
+    }
+    if (bestIndex >= 0) {
+        const Glyph& best = mGlyphs[bestIndex];
+        SkIRect rect;
+        rect.intersect(best.mRect, area);
+        bounds->set(rect.fLeft, best.mTop, rect.fRight, best.mBottom);
+        *base = best.mBase;
+    }
+    return true;
+}
+
 static bool buildSelection(const SkPicture& picture, const SkIRect& area,
         const SkIRect& selStart, int startBase,
         const SkIRect& selEnd, int endBase, SkRegion* region)
@@ -1305,6 +1491,7 @@ static WebCore::String text(const SkPicture& picture, const SkIRect& area,
 
 SelectText::SelectText()
 {
+    m_snapshot = 0;
     reset();
     SkPaint paint;
 
@@ -1382,6 +1569,11 @@ SelectText::SelectText()
     m_picture = 0;
 }
 
+SelectText::~SelectText()
+{
+    delete m_snapshot;
+}
+
 void SelectText::draw(SkCanvas* canvas, LayerAndroid* layer)
 {
     // Gmail makes layers appear dynamically the page scrolls. The picture
@@ -1483,10 +1675,11 @@ void SelectText::extendSelection(const SkPicture* picture, int x, int y)
         DBG_NAV_LOGD("selStart clip=(%d,%d,%d,%d)", clipRect.fLeft,
             clipRect.fTop, clipRect.fRight, clipRect.fBottom);
         m_picture = picture;
-        FirstCheck center(m_original.fX, m_original.fY, clipRect);
 #ifndef MTK_SHAPE_ENGINE_SUPPORT
-        m_selStart = m_selEnd = findClosest(center, *picture, clipRect, &base);
+        m_selStart = m_selEnd = findClosestGlyph(picture, m_original.fX,
+            m_original.fY, clipRect, &base);
 #else
+        FirstCheck center(m_original.fX, m_original.fY, clipRect);
         mStartCluster = mEndCluster = findClosestCluster(center, *picture, clipRect, &base);
         m_selStart = mStartCluster.startRect;
         m_selEnd = mStartCluster.endRect;
@@ -1506,10 +1699,8 @@ void SelectText::extendSelection(const SkPicture* picture, int x, int y)
     }
     DBG_NAV_LOGD("extend clip=(%d,%d,%d,%d)", clipRect.fLeft,
         clipRect.fTop, clipRect.fRight, clipRect.fBottom);
-    FirstCheck extension(x, y, clipRect);
-
 #ifndef MTK_SHAPE_ENGINE_SUPPORT
-    SkIRect found = findClosest(extension, *picture, clipRect, &base);
+    SkIRect found = findClosestGlyph(picture, x, y, clipRect, &base);
     DBG_NAV_LOGD("pic=%p x=%d y=%d m_startSelection=%s %s=(%d, %d, %d, %d)"
         " m_extendSelection=%s",
         picture, x, y, m_startSelection ? "true" : "false",
@@ -1524,6 +1715,7 @@ void SelectText::extendSelection(const SkPicture* picture, int x, int y)
         m_selEnd = found;
     }
 #else
+    FirstCheck extension(x, y, clipRect);
     Cluster found = findClosestCluster(extension, *picture, clipRect, &base);
     if (m_hitTopLeft) {
         m_startBase = base;
@@ -1557,6 +1749,22 @@ const String SelectText::getSelection()
     return result;
 }
 
+// Finds the glyph closest to x, y in the snapshot of picture, capturing one
+// if the picture is not the one last captured.
+SkIRect SelectText::findClosestGlyph(const SkPicture* picture, int x, int y,
+    const SkIRect& area, int* base)
+{
+    if (!m_snapshot || m_snapshot->picture() != picture) {
+        delete m_snapshot;
+        m_snapshot = new TextSnapshot(picture);
+    }
+    SkIRect found;
+    if (m_snapshot->closest(x, y, area, &found, base))
+        return found;
+    FirstCheck center(x, y, area);
+    return findClosest(center, *picture, area, base);
+}
+
 void SelectText::getSelectionArrow(SkPath* path)
 {
     const int arrow[] = {
@@ -1613,10 +1821,9 @@ void SelectText::moveSelection(const SkPicture* picture, int x, int y)
     clipRect.join(m_selEnd);
     if (!m_extendSelection)
         m_picture = picture;
-    FirstCheck center(x, y, clipRect);
     int base;
 #ifndef MTK_SHAPE_ENGINE_SUPPORT
-    SkIRect found = findClosest(center, *picture, clipRect, &base);
+    SkIRect found = findClosestGlyph(picture, x, y, clipRect, &base);
     if (m_hitTopLeft || !m_extendSelection) {
         m_startBase = base;
         m_selStart = found;
@@ -1626,6 +1833,7 @@ void SelectText::moveSelection(const SkPicture* picture, int x, int y)
         m_selEnd = found;
     }
 #else
+    FirstCheck center(x, y, clipRect);
     Cluster found = findClosestCluster(center, *picture, clipRect, &base);
     if (m_hitTopLeft || !m_extendSelection) {
         m_startBase = base;
@@ -1648,6 +1856,8 @@ void SelectText::moveSelection(const SkPicture* picture, int x, int y)
 void SelectText::reset()
 {
     DBG_NAV_LOG("m_extendSelection=false");
+    delete m_snapshot;
+    m_snapshot = 0;
     m_selStart.setEmpty();
     m_selEnd.setEmpty();
     m_extendSelection = false;
@@ -1674,6 +1884,9 @@ int SelectText::selectionY() const
 
 bool SelectText::startSelection(int x, int y)
 {
+    // the picture may have been recorded again since the last drag
+    delete m_snapshot;
+    m_snapshot = 0;
     m_original.fX = x;
     m_original.fY = y;
     if (m_selStart.isEmpty()) {
@@ -22,10 +22,12 @@ struct Cluster{
 };
 
 class CachedRoot;
+class TextSnapshot;
 
 class SelectText : public DrawExtra {
 public:
     SelectText();
+    virtual ~SelectText();
     virtual void draw(SkCanvas* , LayerAndroid* );
     void extendSelection(const SkPicture* , int x, int y);
     const String getSelection();
@@ -47,6 +49,8 @@ public:
 private:
     void drawSelectionPointer(SkCanvas* );
     void drawSelectionRegion(SkCanvas* );
+    SkIRect findClosestGlyph(const SkPicture* , int x, int y,
+        const SkIRect& area, int* base);
     static void getSelectionArrow(SkPath* );
     void getSelectionCaret(SkPath* );
     bool hitCorner(int cx, int cy, int x, int y) const;
@@ -61,6 +65,7 @@ private:
     SkPicture m_startControl;
     SkPicture m_endControl;
     const SkPicture* m_picture;
+    TextSnapshot* m_snapshot; // glyph boxes of the picture last hit tested
     bool m_drawPointer;
     bool m_extendSelection; // false when trackball is moving pointer
     bool m_flipped;
@@ -24,11 +24,14 @@
 #include "PlatformString.h"
 #include "SelectText.h"
 #include "SkCanvas.h"
+#include "SkDevice.h"
 #include "SkDumpCanvas.h"
 #include "SkPicture.h"
 #include "SkRect.h"
+#include "SkRegion.h"
 #include "SkTime.h"
 #include "TimeCounter.h"
+#include "TraceBuffer.h"
 #include "WebCoreJni.h"
 #include "WebViewCore.h"
 #include "android_graphics.h"
@@ -39,6 +42,9 @@
 
 #define GET_NATIVE_VIEW(env, obj) ((WebView*)env->GetIntField(obj, gWebViewField))
 
+// covers the blurred shadow FindOnPage draws around a match
+#define FIND_MATCH_INVAL_OUTSET 4
+
 #include <JNIUtility.h>
 #include <JNIHelp.h>
 #include <jni.h>
@@ -154,6 +160,7 @@ WebView(JNIEnv* env, jobject javaWebView, int viewImpl) :
     m_lastDx = 0;
     m_lastDxTime = 0;
     m_ringAnimationEnd = 0;
+    m_ringInvalKnown = false;
     m_rootLayer = 0;
 }
 
@@ -185,7 +192,7 @@ void clearCursor()
     DBG_NAV_LOG("");
     m_viewImpl->m_hasCursorBounds = false;
     root->clearCursor();
-    viewInvalidate();
+    invalidateCursorRing(root);
 }
 
 // leaves the cursor where it is, but suppresses drawing it
@@ -197,7 +204,7 @@ void hideCursor()
     DBG_NAV_LOG("");
     m_viewImpl->m_hasCursorBounds = false;
     root->hideCursor();
-    viewInvalidate();
+    invalidateCursorRing(root);
 }
 
 void clearTextEntry()
@@ -375,6 +382,9 @@ void drawCursorPostamble()
 
 void drawExtras(SkCanvas* canvas, int extras)
 {
+    // drawn over the content drawContent drew just before on this thread
+    uint32_t traceId = m_viewImpl->drawnContentTraceId();
+    TraceBufferAuto trace(TraceBuffer::DrawExtrasTrace, traceId);
     CachedRoot* root = getFrameCache(AllowNewer);
     if (!root) {
         DBG_NAV_LOG("!root");
@@ -392,9 +402,14 @@ void drawExtras(SkCanvas* canvas, int extras)
             extra = &m_selectText;
             break;
         case DrawExtrasCursorRing:
+            m_ringInval = WebCore::IntRect();
+            m_ringInvalKnown = true;
             if (drawCursorPreamble(root) && m_ring.setup()) {
-                if (!m_ring.m_isButton)
+                if (!m_ring.m_isButton) {
                     extra = &m_ring;
+                    m_ringInval = m_ring.m_bounds;
+                    m_ringInvalKnown = !m_ring.m_node->isInLayer();
+                }
                 drawCursorPostamble();
             }
             break;
@@ -416,8 +431,20 @@ void drawExtras(SkCanvas* canvas, int extras)
     // We have to set the canvas' matrix on the root layer
     // (to have fixed layers work as intended)
     SkAutoCanvasRestore restore(canvas, true);
-    m_rootLayer->setMatrix(canvas->getTotalMatrix());
+    const SkMatrix& matrix = canvas->getTotalMatrix();
+    m_rootLayer->setMatrix(matrix);
+    // find what opaque layers hide, so neither the layers beneath nor the
+    // next frame's page content draw there
+    SkRegion covered;
+    SkRegion fixedCovered;
+    m_rootLayer->computeOcclusion(&covered, &fixedCovered);
+    SkDevice* device = canvas->getDevice();
+    if (device) {
+        m_viewImpl->setContentOcclusion(fixedCovered, matrix.getScaleX(),
+            matrix.getScaleY(), device->width(), device->height());
+    }
     canvas->resetMatrix();
+    TraceBufferAuto compositeTrace(TraceBuffer::CompositeLayersTrace, traceId);
     m_rootLayer->draw(canvas);
 #endif
 }
@@ -458,10 +485,10 @@ void cursorRingBounds(WebCore::IntRect* bounds)
 
 void fixCursor()
 {
-    m_viewImpl->gCursorBoundsMutex.lock();
+    m_viewImpl->gCursorBoundsLock.readLock();
     bool hasCursorBounds = m_viewImpl->m_hasCursorBounds;
     IntRect bounds = m_viewImpl->m_cursorBounds;
-    m_viewImpl->gCursorBoundsMutex.unlock();
+    m_viewImpl->gCursorBoundsLock.unlock();
     if (!hasCursorBounds)
         return;
 
@@ -553,6 +580,7 @@ CachedRoot* getFrameCache(FrameCachePermission allowNewer)
     m_viewImpl->gFrameCacheMutex.lock();
     delete m_frameCacheUI;
     delete m_navPictureUI;
+    m_findOnPage.clearIndex();
     m_viewImpl->m_updatedFrameCache = false;
     m_frameCacheUI = m_viewImpl->m_frameCacheKit;
     m_navPictureUI = m_viewImpl->m_navPictureKit;
@@ -735,7 +763,7 @@ bool moveCursor(int keyCode, int count, bool ignoreScroll)
         bool disableFocusController = cachedNode != root->currentFocus()
                 && cachedNode->wantsKeyEvents();
         sendMoveMouseIfLatest(disableFocusController);
-        viewInvalidate();
+        invalidateCursorRing(root);
     } else {
         int docHeight = root->documentHeight();
         int docWidth = root->documentWidth();
@@ -810,7 +838,10 @@ void selectBestAt(const WebCore::IntRect& rect)
                 const_cast<CachedNode*>(node));
     }
     sendMoveMouseIfLatest(false);
-    viewInvalidate();
+    if (root)
+        invalidateCursorRing(root);
+    else
+        viewInvalidate();
 }
 
 WebCore::IntRect getNavBounds()
@@ -927,7 +958,11 @@ void setFollowedLink(bool followed)
 {
     if ((m_ring.m_followedLink = followed) != false) {
         m_ringAnimationEnd = SkTime::GetMSecs() + 500;
-        viewInvalidate();
+        CachedRoot* root = getFrameCache(DontAllowNewer);
+        if (root)
+            invalidateCursorRing(root);
+        else
+            viewInvalidate();
     }
 }
 
@@ -1075,14 +1110,35 @@ void sendMotionUp(
 
 void findNext(bool forward)
 {
+    bool inLayer = m_findOnPage.currentMatchIsInLayer();
+    WebCore::IntRect inval = m_findOnPage.currentMatchBounds();
     m_findOnPage.findNext(forward);
     if (!m_findOnPage.currentMatchIsInLayer())
         scrollRectOnScreen(m_findOnPage.currentMatchBounds());
-    viewInvalidate();
+    else
+        inLayer = true;
+    if (inLayer) {
+        viewInvalidate();
+        return;
+    }
+    // only the old and new current matches change how they are drawn
+    inval.unite(m_findOnPage.currentMatchBounds());
+    inval.inflate(FIND_MATCH_INVAL_OUTSET);
+    viewInvalidateRect(inval.x(), inval.y(), inval.right(), inval.bottom());
 }
 
 // With this call, WebView takes ownership of matches, and is responsible for
 // deleting it.
+FindIndex* findIndex() const
+{
+    return m_findOnPage.index();
+}
+
+void setFindIndex(FindIndex* index)
+{
+    m_findOnPage.setIndex(index);
+}
+
 void setMatches(WTF::Vector<MatchInfo>* matches)
 {
     m_findOnPage.setMatches(matches);
@@ -1153,10 +1209,45 @@ void viewInvalidate()
 void viewInvalidateRect(int l, int t, int r, int b)
 {
     JNIEnv* env = JSC::Bindings::getJNIEnv();
-    env->CallVoidMethod(m_javaGlue.object(env).get(), m_javaGlue.m_viewInvalidateRect, l, r, t, b);
+    env->CallVoidMethod(m_javaGlue.object(env).get(), m_javaGlue.m_viewInvalidateRect, l, t, r, b);
     checkException(env);
 }
 
+// Returns the content area the ring for the current cursor would cover, or
+// false if that can't be known without laying out the layers.
+bool cursorRingBounds(const CachedRoot* root, WebCore::IntRect* bounds)
+{
+    const CachedFrame* frame;
+    const CachedNode* node = root->currentCursor(&frame);
+    *bounds = WebCore::IntRect();
+    if (!node)
+        return true;
+    if (node->isInLayer())
+        return false;
+    *bounds = node->bounds(frame);
+    bounds->unite(node->hitBounds(frame));
+    bounds->unite(node->cursorRingBounds(frame));
+    bounds->inflate(SkScalarCeil(CURSOR_RING_OUTER_DIAMETER));
+    return true;
+}
+
+// Invalidates where the cursor ring was last drawn and where it will be
+// drawn next, rather than the whole view.
+void invalidateCursorRing(const CachedRoot* root)
+{
+    WebCore::IntRect bounds;
+    if (!m_ringInvalKnown || !cursorRingBounds(root, &bounds)) {
+        viewInvalidate();
+        return;
+    }
+    bounds.unite(m_ringInval);
+    // views assume that inval bounds coordinates are non-negative
+    bounds.intersect(WebCore::IntRect(0, 0, INT_MAX, INT_MAX));
+    if (bounds.isEmpty())
+        return;
+    viewInvalidateRect(bounds.x(), bounds.y(), bounds.right(), bounds.bottom());
+}
+
 void postInvalidateDelayed(int64_t delay, const WebCore::IntRect& bounds)
 {
     JNIEnv* env = JSC::Bindings::getJNIEnv();
@@ -1179,6 +1270,8 @@ void setRootLayer(LayerAndroid* layer)
 {
     delete m_rootLayer;
     m_rootLayer = layer;
+    m_findOnPage.clearIndex();
+    m_viewImpl->setContentOcclusion(SkRegion(), 0, 0, 0, 0);
     CachedRoot* root = getFrameCache(DontAllowNewer);
     if (!root)
         return;
@@ -1193,6 +1286,8 @@ private: // local state for WebView
     int m_generation; // associate unique ID with sent kit focus to match with ui
     SkPicture* m_navPictureUI;
     SkMSec m_ringAnimationEnd;
+    WebCore::IntRect m_ringInval; // content area of the last drawn ring
+    bool m_ringInvalKnown; // false if the last ring was drawn in a layer
     // Corresponds to the same-named boolean on the java side.
     bool m_heightCanMeasure;
     int m_lastDx;
@@ -1629,6 +1724,18 @@ static void nativeInstrumentReport(JNIEnv *env, jobject obj)
 #endif
 }
 
+// Returns the instrumentation counters, with per-page histograms, as a JSON
+// string, or null if this build is not instrumented.
+static jstring nativeInstrumentSnapshot(JNIEnv *env, jobject obj)
+{
+#ifdef ANDROID_INSTRUMENT
+    WebCore::String snapshot = TimeCounter::snapshot();
+    return env->NewString((jchar*) snapshot.characters(), snapshot.length());
+#else
+    return 0;
+#endif
+}
+
 static void nativeSelectBestAt(JNIEnv *env, jobject obj, jobject jrect)
 {
     WebView* view = GET_NATIVE_VIEW(env, obj);
@@ -1790,7 +1897,20 @@ static int nativeFindAll(JNIEnv *env, jobject obj, jstring findLower,
     SkBitmap bitmap;
     bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
     canvas.setBitmapDevice(bitmap);
-    root->draw(canvas);
+    // The first search captures the page's text runs; later ones search
+    // those, and a query that extends the last one only its matching runs.
+    FindIndex* index = view->findIndex();
+    if (index) {
+        canvas.search(*index, index->extendsQuery(
+            (const UChar*) findLowerChars, length) ? &index->queryRuns() : 0);
+    } else {
+        index = new FindIndex;
+        canvas.setRecordIndex(index);
+        root->draw(canvas);
+        view->setFindIndex(index);
+    }
+    index->setQuery((const UChar*) findLowerChars, length,
+        canvas.touchedRuns());
     WTF::Vector<MatchInfo>* matches = canvas.detachMatches();
     // With setMatches, the WebView takes ownership of matches
     view->setMatches(matches);
@@ -2158,6 +2278,12 @@ static JNINativeMethod gJavaWebViewMethods[] = {
         (void*) nativeGetBlockLeftEdge },
 };
 
+// Older WebView.java does not declare these
+static JNINativeMethod gJavaWebViewOptionalMethods[] = {
+    { "nativeInstrumentSnapshot", "()Ljava/lang/String;",
+        (void*) nativeInstrumentSnapshot },
+};
+
 int register_webview(JNIEnv* env)
 {
     jclass clazz = env->FindClass("android/webkit/WebView");
@@ -2165,6 +2291,11 @@ int register_webview(JNIEnv* env)
     gWebViewField = env->GetFieldID(clazz, "mNativeClass", "I");
     LOG_ASSERT(gWebViewField, "Unable to find android/webkit/WebView.mNativeClass");
 
+    for (size_t index = 0; index < NELEM(gJavaWebViewOptionalMethods); index++) {
+        if (env->RegisterNatives(clazz, &gJavaWebViewOptionalMethods[index], 1) < 0)
+            env->ExceptionClear();
+    }
+
     return jniRegisterNativeMethods(env, "android/webkit/WebView", gJavaWebViewMethods, NELEM(gJavaWebViewMethods));
 }
 
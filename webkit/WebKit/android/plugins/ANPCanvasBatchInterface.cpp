@@ -0,0 +1,162 @@
+// must include config.h first for webkit to fiddle with new/delete
+#include "config.h"
+#include "SkANP.h"
+
+// Ops can only be culled against the clip when the paint cannot draw outside
+// of the op's own bounds.
+static bool canQuickReject(const SkPaint& paint) {
+    return paint.getStyle() == SkPaint::kFill_Style && !paint.getMaskFilter()
+            && !paint.getPathEffect() && !paint.getLooper();
+}
+
+static void anp_drawOps(ANPCanvas* canvas, const ANPDrawOp ops[],
+                        int32_t count, const ANPPaint* paint) {
+    SkCanvas* skcanvas = canvas->skcanvas;
+    SkPaint defaultPaint;
+    const SkPaint& p = paint ? *static_cast<const SkPaint*>(paint) : defaultPaint;
+    const bool cull = canQuickReject(p);
+
+    // sprites are usually drawn from a handful of sheets, so only rewrap the
+    // ANPBitmap when it differs from the previous op's
+    SkBitmap bm;
+    const ANPBitmap* lastBitmap = NULL;
+
+    for (int32_t n = 0; n < count; n++) {
+        const ANPDrawOp& op = ops[n];
+        switch (op.type) {
+            case kRect_ANPDrawOp: {
+                SkRect r;
+                SkANP::SetRect(&r, op.data.rect);
+                if (cull && skcanvas->quickReject(r, SkCanvas::kAA_EdgeType))
+                    break;
+                skcanvas->drawRect(r, p);
+                break;
+            }
+            case kBitmap_ANPDrawOp: {
+                const ANPBitmap* bitmap = op.data.bitmap.bitmap;
+                if (!bitmap)
+                    break;
+                SkScalar x = SkFloatToScalar(op.data.bitmap.x);
+                SkScalar y = SkFloatToScalar(op.data.bitmap.y);
+                if (cull) {
+                    SkRect r;
+                    r.set(x, y, x + SkIntToScalar(bitmap->width),
+                          y + SkIntToScalar(bitmap->height));
+                    if (skcanvas->quickReject(r, SkCanvas::kAA_EdgeType))
+                        break;
+                }
+                if (bitmap != lastBitmap) {
+                    SkANP::SetBitmap(&bm, *bitmap);
+                    lastBitmap = bitmap;
+                }
+                skcanvas->drawBitmap(bm, x, y, paint);
+                break;
+            }
+            case kBitmapRect_ANPDrawOp: {
+                const ANPBitmap* bitmap = op.data.bitmapRect.bitmap;
+                if (!bitmap)
+                    break;
+                SkRect dst;
+                SkANP::SetRect(&dst, op.data.bitmapRect.dst);
+                if (cull && skcanvas->quickReject(dst, SkCanvas::kAA_EdgeType))
+                    break;
+                if (bitmap != lastBitmap) {
+                    SkANP::SetBitmap(&bm, *bitmap);
+                    lastBitmap = bitmap;
+                }
+                SkIRect src, *srcPtr = NULL;
+                const ANPRectI& s = op.data.bitmapRect.src;
+                if (s.left < s.right && s.top < s.bottom)
+                    srcPtr = SkANP::SetRect(&src, s);
+                skcanvas->drawBitmapRect(bm, srcPtr, dst, paint);
+                break;
+            }
+            case kText_ANPDrawOp:
+                skcanvas->drawText(op.data.text.text, op.data.text.byteLength,
+                                   SkFloatToScalar(op.data.text.x),
+                                   SkFloatToScalar(op.data.text.y), p);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static ANPDrawBatch* anp_newBatch() {
+    return new ANPDrawBatch;
+}
+
+static void anp_deleteBatch(ANPDrawBatch* batch) {
+    delete batch;
+}
+
+static void anp_resetBatch(ANPDrawBatch* batch) {
+    batch->ops.rewind();
+}
+
+static int32_t anp_countOps(const ANPDrawBatch* batch) {
+    return batch->ops.count();
+}
+
+static void anp_addRect(ANPDrawBatch* batch, const ANPRectF* rect) {
+    ANPDrawOp* op = batch->ops.append();
+    op->type = kRect_ANPDrawOp;
+    op->data.rect = *rect;
+}
+
+static void anp_addBitmap(ANPDrawBatch* batch, const ANPBitmap* bitmap,
+                          float x, float y) {
+    ANPDrawOp* op = batch->ops.append();
+    op->type = kBitmap_ANPDrawOp;
+    op->data.bitmap.bitmap = bitmap;
+    op->data.bitmap.x = x;
+    op->data.bitmap.y = y;
+}
+
+static void anp_addBitmapRect(ANPDrawBatch* batch, const ANPBitmap* bitmap,
+                              const ANPRectI* src, const ANPRectF* dst) {
+    ANPDrawOp* op = batch->ops.append();
+    op->type = kBitmapRect_ANPDrawOp;
+    op->data.bitmapRect.bitmap = bitmap;
+    if (src) {
+        op->data.bitmapRect.src = *src;
+    } else {
+        op->data.bitmapRect.src.left = op->data.bitmapRect.src.top = 0;
+        op->data.bitmapRect.src.right = op->data.bitmapRect.src.bottom = 0;
+    }
+    op->data.bitmapRect.dst = *dst;
+}
+
+static void anp_addText(ANPDrawBatch* batch, const void* text,
+                        uint32_t byteLength, float x, float y) {
+    ANPDrawOp* op = batch->ops.append();
+    op->type = kText_ANPDrawOp;
+    op->data.text.text = text;
+    op->data.text.byteLength = byteLength;
+    op->data.text.x = x;
+    op->data.text.y = y;
+}
+
+static void anp_drawBatch(ANPCanvas* canvas, const ANPDrawBatch* batch,
+                          const ANPPaint* paint) {
+    anp_drawOps(canvas, batch->ops.begin(), batch->ops.count(), paint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define ASSIGN(obj, name)   (obj)->name = anp_##name
+
+void ANPCanvasBatchInterfaceV0_Init(ANPInterface* value) {
+    ANPCanvasBatchInterfaceV0* i = reinterpret_cast<ANPCanvasBatchInterfaceV0*>(value);
+
+    ASSIGN(i, drawOps);
+    ASSIGN(i, newBatch);
+    ASSIGN(i, deleteBatch);
+    ASSIGN(i, resetBatch);
+    ASSIGN(i, countOps);
+    ASSIGN(i, addRect);
+    ASSIGN(i, addBitmap);
+    ASSIGN(i, addBitmapRect);
+    ASSIGN(i, addText);
+    ASSIGN(i, drawBatch);
+}
@@ -3,28 +3,44 @@
 #include "config.h"
 #include "PluginTimer.h"
 
+#include "CurrentTime.h"
+#ifdef ANDROID_INSTRUMENT
+#define LOG_TAG "webkitPlugin"
+#include "TimeCounter.h"
+#include "utils/Log.h"
+#endif
+
 namespace WebCore {
 
     static uint32 gTimerID;
 
-    PluginTimer::PluginTimer(PluginTimer** list, NPP instance, bool repeat,
+    // Plugins typically ask for several 10-33ms repeating timers. Rather than
+    // letting each one drift on its own schedule (and wake the thread once per
+    // timer), every plugin timer expires on a multiple of this shared tick so
+    // that all that are due are serviced by the same shared timer callback.
+    static const double kPluginTimerTick = 0.016;   // seconds
+
+    PluginTimer::PluginTimer(PluginTimerList* owner, NPP instance,
+                             uint32 interval, bool repeat,
                              void (*timerFunc)(NPP npp, uint32 timerID))
-                : m_list(list),
+                : m_owner(owner),
                   m_instance(instance),
                   m_timerFunc(timerFunc),
+                  m_interval(interval * 0.001),    // milliseconds to seconds
                   m_repeat(repeat),
-                  m_unscheduled(false)
+                  m_unscheduled(false),
+                  m_inFired(false)
     {
         m_timerID = ++gTimerID;
 
-        m_next = *list;
+        m_next = owner->m_list;
         if (m_next) {
             m_next->m_prev = this;
         }
         m_prev = 0;
-        *list = this;
+        owner->m_list = this;
     }
-    
+
     PluginTimer::~PluginTimer()
     {
         if (m_next) {
@@ -33,19 +49,47 @@ namespace WebCore {
         if (m_prev) {
             m_prev->m_next = m_next;
         } else {
-            *m_list = m_next;
+            m_owner->m_list = m_next;
         }
     }
-        
+
+    void PluginTimer::startAligned()
+    {
+        // round the deadline to the nearest tick, but never fire sooner than
+        // one tick from now so a zero interval cannot spin the thread
+        double now = currentTime();
+        double ticks = static_cast<double>(static_cast<int64_t>(
+                (now + m_interval) / kPluginTimerTick + 0.5));
+        double deadline = ticks * kPluginTimerTick;
+        double delay = deadline - now;
+        if (delay < kPluginTimerTick)
+            delay += kPluginTimerTick;
+        startOneShot(delay);
+    }
+
     void PluginTimer::fired()
     {
-        if (!m_unscheduled)
+        if (!m_unscheduled) {
+#ifdef ANDROID_INSTRUMENT
+            android::TimeCounterAuto counter(
+                    android::TimeCounter::PluginTimerTimeCounter);
+            uint32_t startTime = android::getThreadMsec();
+#endif
+            m_inFired = true;
             m_timerFunc(m_instance, m_timerID);
+            m_inFired = false;
+#ifdef ANDROID_INSTRUMENT
+            m_owner->m_firedCount++;
+            m_owner->m_firedTime += android::getThreadMsec() - startTime;
+#endif
+        }
 
         if (!m_repeat || m_unscheduled)
             delete this;
+        else if (!m_owner->m_suspended)
+            startAligned();
     }
-    
+
     // may return null if timerID is not found
     PluginTimer* PluginTimer::Find(PluginTimer* list, uint32 timerID)
     {
@@ -60,9 +104,12 @@ namespace WebCore {
     }
 
     ///////////////////////////////////////////////////////////////////////////
-    
+
     PluginTimerList::~PluginTimerList()
     {
+#ifdef ANDROID_INSTRUMENT
+        report();
+#endif
         while (m_list) {
             delete m_list;
         }
@@ -70,18 +117,17 @@ namespace WebCore {
 
     uint32 PluginTimerList::schedule(NPP instance, uint32 interval, bool repeat,
                                      void (*proc)(NPP npp, uint32 timerID))
-    {        
-        PluginTimer* timer = new PluginTimer(&m_list, instance, repeat, proc);
-        
-        double dinterval = interval * 0.001;    // milliseconds to seconds
-        if (repeat) {
-            timer->startRepeating(dinterval);
-        } else {
-            timer->startOneShot(dinterval);
-        }
+    {
+        PluginTimer* timer = new PluginTimer(this, instance, interval, repeat,
+                                             proc);
+#ifdef ANDROID_INSTRUMENT
+        m_instance = instance;
+#endif
+        if (!m_suspended)
+            timer->startAligned();
         return timer->timerID();
     }
-    
+
     void PluginTimerList::unschedule(NPP instance, uint32 timerID)
     {
         // Although it looks like simply deleting the timer would work here
@@ -90,8 +136,45 @@ namespace WebCore {
         // (when we execute the timerFunc callback). Deleting the object
         // we are in would then be a rather bad move...
         PluginTimer* timer = PluginTimer::Find(m_list, timerID);
-        if (timer)
+        if (!timer)
+            return;
+        // ...but a suspended timer will not fire again to clean itself up
+        if (m_suspended && !timer->m_inFired)
+            delete timer;
+        else
             timer->unschedule();
     }
-    
+
+    void PluginTimerList::setSuspended(bool suspended)
+    {
+        if (m_suspended == suspended)
+            return;
+        m_suspended = suspended;
+#ifdef ANDROID_INSTRUMENT
+        if (suspended)
+            report();
+#endif
+        PluginTimer* timer = m_list;
+        while (timer) {
+            PluginTimer* next = timer->next();
+            if (suspended)
+                timer->stop();
+            else if (timer->m_unscheduled)
+                delete timer;
+            else if (!timer->m_inFired)
+                timer->startAligned();
+            timer = next;
+        }
+    }
+
+#ifdef ANDROID_INSTRUMENT
+    void PluginTimerList::report() const
+    {
+        if (!m_firedCount)
+            return;
+        LOGD("plugin %p: %d timer callbacks, %d ms", m_instance, m_firedCount,
+             m_firedTime);
+    }
+#endif
+
 } // namespace WebCore
@@ -12,8 +12,8 @@ namespace WebCore {
 
     class PluginTimer : public TimerBase {
     public:
-        PluginTimer(PluginTimer** list, NPP instance, bool repeat,
-                    void (*proc)(NPP npp, uint32 timerID));
+        PluginTimer(PluginTimerList* owner, NPP instance, uint32 interval,
+                    bool repeat, void (*proc)(NPP npp, uint32 timerID));
         virtual ~PluginTimer();
     
         uint32 timerID() const { return m_timerID; }
@@ -29,27 +29,51 @@ namespace WebCore {
         PluginTimer* next() const { return m_next; }
         friend class PluginTimerList;
 
-        PluginTimer**   m_list;
+        // (re)arm the timer so that it expires on the shared plugin tick
+        void startAligned();
+
+        PluginTimerList* m_owner;
         PluginTimer*    m_prev;
         PluginTimer*    m_next;
         NPP             m_instance;
         void            (*m_timerFunc)(NPP, uint32);
         uint32          m_timerID;
+        double          m_interval;     // seconds
         bool            m_repeat;
         bool            m_unscheduled;
+        bool            m_inFired;
     };
     
     class PluginTimerList {
     public:
-        PluginTimerList() : m_list(0) {}
+        PluginTimerList() : m_list(0), m_suspended(false)
+#ifdef ANDROID_INSTRUMENT
+            , m_instance(0), m_firedCount(0), m_firedTime(0)
+#endif
+            {}
         ~PluginTimerList();
         
         uint32 schedule(NPP instance, uint32 interval, bool repeat,
                         void (*proc)(NPP npp, uint32 timerID));
         void unschedule(NPP instance, uint32 timerID);
+
+        // Stops every timer while the plugin is off-screen or the view is
+        // paused. Timers scheduled while suspended start on resume.
+        void setSuspended(bool suspended);
+        bool isSuspended() const { return m_suspended; }
         
     private:
+        friend class PluginTimer;
+
         PluginTimer* m_list;
+        bool         m_suspended;
+#ifdef ANDROID_INSTRUMENT
+        void report() const;
+
+        NPP          m_instance;
+        uint32       m_firedCount;
+        uint32       m_firedTime;   // thread milliseconds
+#endif
     };
 
 } // namespace WebCore
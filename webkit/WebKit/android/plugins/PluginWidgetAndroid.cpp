@@ -48,6 +48,9 @@ PluginWidgetAndroid::PluginWidgetAndroid(WebCore::PluginView* view)
     m_embeddedViewAttached = false;
     m_acceptEvents = false;
     m_isSurfaceClippedOut = false;
+    m_surfaceUpdatePending = false;
+    m_surfaceRect.setEmpty();
+    m_isPaused = false;
 }
 
 PluginWidgetAndroid::~PluginWidgetAndroid() {
@@ -150,6 +153,10 @@ void PluginWidgetAndroid::inval(const WebCore::IntRect& rect,
     }
 }
 
+// Dirty regions with this many rects or fewer are drawn rect by rect, if
+// that covers no more than half of their bounds.
+#define MAX_DIRTY_DRAW_RECTS    4
+
 void PluginWidgetAndroid::draw(SkCanvas* canvas) {
     if (NULL == m_flipPixelRef || !m_flipPixelRef->isDirty()) {
         return;
@@ -159,25 +166,47 @@ void PluginWidgetAndroid::draw(SkCanvas* canvas) {
     const SkBitmap& bitmap = update.bitmap();
     const SkRegion& dirty = update.dirty();
 
+    // A plugin that updates a couple of small areas should not have to draw,
+    // and we should not have to record, everything between them.
+    SkIRect rects[MAX_DIRTY_DRAW_RECTS];
+    int rectCount = 0;
+    if (dirty.isComplex()) {
+        const SkIRect& bounds = dirty.getBounds();
+        int64_t area = 0;
+        SkRegion::Iterator iter(dirty);
+        for (; !iter.done() && rectCount < MAX_DIRTY_DRAW_RECTS; iter.next()) {
+            rects[rectCount++] = iter.rect();
+            area += (int64_t) iter.rect().width() * iter.rect().height();
+        }
+        if (!iter.done()
+                || area * 2 > (int64_t) bounds.width() * bounds.height())
+            rectCount = 0;
+    }
+    if (!rectCount)
+        rects[rectCount++] = dirty.getBounds();
+
     ANPEvent    event;
     SkANP::InitEvent(&event, kDraw_ANPEventType);
 
     event.data.draw.model = m_drawingModel;
-    SkANP::SetRect(&event.data.draw.clip, dirty.getBounds());
 
     switch (m_drawingModel) {
         case kBitmap_ANPDrawingModel: {
             WebCore::PluginPackage* pkg = m_pluginView->plugin();
             NPP instance = m_pluginView->instance();
 
-            if (SkANP::SetBitmap(&event.data.draw.data.bitmap,
-                                 bitmap) &&
-                    pkg->pluginFuncs()->event(instance, &event)) {
-
-                if (canvas && m_pluginWindow) {
-                    SkBitmap bm(bitmap);
-                    bm.setPixelRef(m_flipPixelRef);
-                    canvas->drawBitmap(bm, 0, 0);
+            if (!SkANP::SetBitmap(&event.data.draw.data.bitmap, bitmap))
+                break;
+
+            SkBitmap bm(bitmap);
+            bm.setPixelRef(m_flipPixelRef);
+            for (int i = 0; i < rectCount; i++) {
+                SkANP::SetRect(&event.data.draw.clip, rects[i]);
+                if (pkg->pluginFuncs()->event(instance, &event) &&
+                        canvas && m_pluginWindow) {
+                    SkRect dst;
+                    dst.set(rects[i]);
+                    canvas->drawBitmapRect(bm, &rects[i], dst);
                 }
             }
             break;
@@ -234,24 +263,51 @@ void PluginWidgetAndroid::layoutSurface(bool pluginBoundsChanged) {
             JNIEnv* env = JSC::Bindings::getJNIEnv();
             m_embeddedView = env->NewGlobalRef(tempObj);
             m_embeddedViewAttached = true;
+            m_surfaceRect.set(m_pluginWindow->x, m_pluginWindow->y,
+                              m_pluginWindow->x + m_pluginWindow->width,
+                              m_pluginWindow->y + m_pluginWindow->height);
         }
     // if the view is unattached but visible then attach it
     } else if (m_embeddedView && !m_embeddedViewAttached && displayPlugin && !m_isFullScreen) {
-        m_core->updateSurface(m_embeddedView, m_pluginWindow->x, m_pluginWindow->y,
-                              m_pluginWindow->width, m_pluginWindow->height);
+        sendSurfaceRect();
         m_embeddedViewAttached = true;
     // if the view is attached but invisible then remove it
     } else if (m_embeddedView && m_embeddedViewAttached && !displayPlugin) {
         m_core->destroySurface(m_embeddedView);
         m_embeddedViewAttached = false;
-    // if the plugin's bounds have changed and it's visible then update it
+        m_surfaceUpdatePending = false;
+        m_surfaceRect.setEmpty();
+    // if the plugin's bounds have changed and it's visible then update it. A
+    // single layout can move the plugin several times, so the update is held
+    // until WebViewCore flushes it once the frame has been recorded.
     } else if (pluginBoundsChanged && displayPlugin && !m_isFullScreen) {
-        m_core->updateSurface(m_embeddedView, m_pluginWindow->x, m_pluginWindow->y,
-                              m_pluginWindow->width, m_pluginWindow->height);
-
+        m_surfaceUpdatePending = true;
     }
 }
 
+void PluginWidgetAndroid::flushSurfaceUpdate() {
+    if (!m_surfaceUpdatePending)
+        return;
+    m_surfaceUpdatePending = false;
+    if (!m_embeddedView || !m_embeddedViewAttached || m_isFullScreen
+            || !m_pluginWindow)
+        return;
+    sendSurfaceRect();
+}
+
+void PluginWidgetAndroid::sendSurfaceRect() {
+    SkIRect rect;
+    rect.set(m_pluginWindow->x, m_pluginWindow->y,
+             m_pluginWindow->x + m_pluginWindow->width,
+             m_pluginWindow->y + m_pluginWindow->height);
+    // the Java view only needs to hear about real moves or resizes
+    if (m_embeddedViewAttached && rect == m_surfaceRect)
+        return;
+    m_surfaceRect = rect;
+    m_core->updateSurface(m_embeddedView, m_pluginWindow->x, m_pluginWindow->y,
+                          m_pluginWindow->width, m_pluginWindow->height);
+}
+
 int16 PluginWidgetAndroid::sendEvent(const ANPEvent& evt) {
     if (!m_acceptEvents)
         return 0;
@@ -289,6 +345,25 @@ int16 PluginWidgetAndroid::sendEvent(const ANPEvent& evt) {
             m_hasFocus = false;
         }
 
+        // a plugin that cannot be seen has no use for its timers, so hold
+        // them until it is back on screen and the view is running again
+        if (evt.eventType == kLifecycle_ANPEventType) {
+            switch (evt.data.lifecycle.action) {
+                case kPause_ANPLifecycleAction:
+                    m_isPaused = true;
+                    break;
+                case kResume_ANPLifecycleAction:
+                    m_isPaused = false;
+                    break;
+                case kOnScreen_ANPLifecycleAction:
+                case kOffScreen_ANPLifecycleAction:
+                    break;
+                default:
+                    return result;
+            }
+            m_pluginView->setTimersSuspended(m_isPaused || !m_visible);
+        }
+
         return result;
     }
     return 0;
@@ -518,6 +593,10 @@ void PluginWidgetAndroid::exitFullScreen(bool pluginInitiated) {
     // add the embedded view back
     m_core->updateSurface(m_embeddedView, m_pluginWindow->x, m_pluginWindow->y,
                           m_pluginWindow->width, m_pluginWindow->height);
+    m_surfaceRect.set(m_pluginWindow->x, m_pluginWindow->y,
+                      m_pluginWindow->x + m_pluginWindow->width,
+                      m_pluginWindow->y + m_pluginWindow->height);
+    m_surfaceUpdatePending = false;
 
     // send event to notify plugin of full screen change
     ANPEvent event;
@@ -125,6 +125,11 @@ struct PluginWidgetAndroid {
      */
     void layoutSurface(bool pluginBoundsChanged = false);
 
+    /** Called by WebViewCore once per recorded frame to send any surface
+        position or size change that layoutSurface has deferred.
+     */
+    void flushSurfaceUpdate();
+
     /** send the surface the currently visible portion of the plugin. This is not
         the portion of the plugin visible on the screen but rather the portion of
         the plugin that is not obscured by other HTML content.
@@ -138,6 +143,7 @@ struct PluginWidgetAndroid {
 private:
     void computeVisiblePluginRect();
     void scrollToVisiblePluginRect();
+    void sendSurfaceRect();
 
     WebCore::PluginView*    m_pluginView;
     android::WebViewCore*   m_core;
@@ -151,11 +157,14 @@ private:
     bool                    m_hasFocus;
     bool                    m_isFullScreen;
     bool                    m_visible;
+    bool                    m_isPaused;
     float                   m_zoomLevel;
     jobject                 m_embeddedView;
     bool                    m_embeddedViewAttached;
     bool                    m_acceptEvents;
     bool                    m_isSurfaceClippedOut;
+    bool                    m_surfaceUpdatePending;
+    SkIRect                 m_surfaceRect; // last rect sent to the Java view
 
     /* We limit the number of rectangles to minimize storage and ensure adequate
        speed.
@@ -8,6 +8,7 @@
 #include "SkMatrix.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkTDArray.h"
 #include "SkTypeface.h"
 
 struct ANPMatrix : SkMatrix {
@@ -41,6 +42,10 @@ struct ANPCanvas {
     }
 };
 
+struct ANPDrawBatch {
+    SkTDArray<ANPDrawOp> ops;
+};
+
 class SkANP {
 public:
     static SkRect* SetRect(SkRect* dst, const ANPRectF& src);
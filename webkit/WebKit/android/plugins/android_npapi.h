@@ -52,6 +52,7 @@ struct ANPRectI {
 };
 
 struct ANPCanvas;
+struct ANPDrawBatch;
 struct ANPMatrix;
 struct ANPPaint;
 struct ANPPath;
@@ -82,6 +83,7 @@ typedef uint32_t ANPMatrixFlag;
 #define kSurfaceInterfaceV0_ANPGetValue     ((NPNVariable)1009)
 #define kSystemInterfaceV0_ANPGetValue      ((NPNVariable)1010)
 #define kEventInterfaceV0_ANPGetValue       ((NPNVariable)1011)
+#define kCanvasBatchInterfaceV0_ANPGetValue ((NPNVariable)1012)
 
 #define kSupportedDrawingModel_ANPGetValue  ((NPNVariable)2000)
 
@@ -551,6 +553,76 @@ struct ANPCanvasInterfaceV0 : ANPInterface {
                                   const ANPPaint*);
 };
 
+enum ANPDrawOpTypes {
+    kRect_ANPDrawOp         = 0,
+    kBitmap_ANPDrawOp       = 1,
+    kBitmapRect_ANPDrawOp   = 2,
+    kText_ANPDrawOp         = 3,
+};
+typedef int32_t ANPDrawOpType;
+
+/** A single primitive in a batch. Every op in a batch is drawn with the paint
+    passed when the batch is submitted; bitmap and text pointers must remain
+    valid until then.
+ */
+struct ANPDrawOp {
+    ANPDrawOpType   type;
+    union {
+        ANPRectF    rect;
+        struct {
+            const ANPBitmap* bitmap;
+            float   x;
+            float   y;
+        } bitmap;
+        struct {
+            const ANPBitmap* bitmap;
+            ANPRectI src;   // an empty src draws the entire bitmap
+            ANPRectF dst;
+        } bitmapRect;
+        struct {
+            const void* text;
+            uint32_t byteLength;
+            float   x;
+            float   y;
+        } text;
+    } data;
+};
+
+/** Lets a plugin hand many small primitives (e.g. sprites) to the browser in
+    one call instead of one canvas call per primitive. Ops may either be
+    submitted directly as an array, or appended to a reusable ANPDrawBatch and
+    then drawn together.
+ */
+struct ANPCanvasBatchInterfaceV0 : ANPInterface {
+    /** Draw count ops onto the canvas, all sharing the same paint. Ops that
+        fall entirely outside the canvas' clip are skipped.
+     */
+    void        (*drawOps)(ANPCanvas*, const ANPDrawOp ops[], int32_t count,
+                           const ANPPaint*);
+
+    /** Return a new, empty recording batch. Like ANPCanvas it is not tied to
+        any plugin instance, but must only be used from one thread at a time.
+     */
+    ANPDrawBatch* (*newBatch)();
+    void        (*deleteBatch)(ANPDrawBatch*);
+    /** Remove every op from the batch, keeping its storage for reuse.
+     */
+    void        (*resetBatch)(ANPDrawBatch*);
+    int32_t     (*countOps)(const ANPDrawBatch*);
+
+    void        (*addRect)(ANPDrawBatch*, const ANPRectF*);
+    void        (*addBitmap)(ANPDrawBatch*, const ANPBitmap*, float x, float y);
+    void        (*addBitmapRect)(ANPDrawBatch*, const ANPBitmap*,
+                                 const ANPRectI* src, const ANPRectF* dst);
+    void        (*addText)(ANPDrawBatch*, const void* text, uint32_t byteLength,
+                           float x, float y);
+
+    /** Draw every op recorded in the batch, as if by drawOps. The batch is
+        left unchanged so that it may be drawn again.
+     */
+    void        (*drawBatch)(ANPCanvas*, const ANPDrawBatch*, const ANPPaint*);
+};
+
 struct ANPWindowInterfaceV0 : ANPInterface {
     /** Registers a set of rectangles that the plugin would like to keep on
         screen. The rectangles are listed in order of priority with the highest
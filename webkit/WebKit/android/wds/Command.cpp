@@ -5,14 +5,26 @@
 
 #include "AndroidLog.h"
 #include "CString.h"
+#include "Cache.h"
 #include "Command.h"
 #include "Connection.h"
 #include "DebugServer.h"
+#include "Document.h"
 #include "Frame.h"
+#include "FrameTree.h"
+#include "RenderArena.h"
 #include "RenderTreeAsText.h"
 #include "RenderView.h"
 #include "WebViewCore.h"
+#include <stdarg.h>
 #include <utils/Log.h>
+#include <wtf/HashMap.h>
+
+#if USE(JSC)
+#include "JSDOMWindow.h"
+#include <algorithm>
+#include <runtime/JSLock.h>
+#endif
 
 #if ENABLE(WDS)
 
@@ -50,6 +62,207 @@ static bool callDumpDomTree(const Frame* frame, const Connection* conn) {
     return true;
 }
 
+// The memory commands write one "category.key: value" line per figure, so
+// the output can be diffed or grepped between runs. Sizes are in bytes.
+static void writeLine(const Connection* conn, const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (length < 0)
+        return;
+    if (length >= static_cast<int>(sizeof(buf)))
+        length = sizeof(buf) - 1;
+    conn->write(buf, length);
+}
+
+static bool callDumpDomMemory(const Frame* frame, const Connection* conn) {
+    int documents = 0;
+    int elements = 0;
+    int textNodes = 0;
+    int otherNodes = 0;
+    for (Frame* f = const_cast<Frame*>(frame); f; f = f->tree()->traverseNext()) {
+        Document* doc = f->document();
+        if (!doc)
+            continue;
+        documents++;
+        for (Node* node = doc; node; node = node->traverseNextNode()) {
+            if (node->isElementNode())
+                elements++;
+            else if (node->isTextNode())
+                textNodes++;
+            else
+                otherNodes++;
+        }
+    }
+    writeLine(conn, "dom.documents: %d\n", documents);
+    writeLine(conn, "dom.elements: %d\n", elements);
+    writeLine(conn, "dom.text: %d\n", textNodes);
+    writeLine(conn, "dom.other: %d\n", otherNodes);
+    return true;
+}
+
+static bool callDumpRenderArenaMemory(const Frame* frame, const Connection* conn) {
+    int index = 0;
+    size_t total = 0;
+    size_t live = 0;
+    size_t recycled = 0;
+    // renderName() returns literals, so the names can be keyed by pointer
+    HashMap<const char*, int> renderers;
+    for (Frame* f = const_cast<Frame*>(frame); f; f = f->tree()->traverseNext()) {
+        Document* doc = f->document();
+        RenderArena* arena = doc ? doc->renderArena() : 0;
+        // each pool size also counts the arenas on the shared free list
+        size_t size = arena ? arena->reportPoolSize() : 0;
+        writeLine(conn, "arena.frame%d: %u\n", index, size);
+        if (arena) {
+            writeLine(conn, "arena.frame%d.live: %u\n", index, arena->liveSize());
+            writeLine(conn, "arena.frame%d.recycled: %u\n", index, arena->recycledSize());
+            live += arena->liveSize();
+            recycled += arena->recycledSize();
+        }
+        for (RenderObject* r = doc ? doc->renderer() : 0; r; r = r->nextInPreOrder()) {
+            std::pair<HashMap<const char*, int>::iterator, bool> result = renderers.add(r->renderName(), 1);
+            if (!result.second)
+                ++result.first->second;
+        }
+        index++;
+        total += size;
+    }
+    writeLine(conn, "arena.total: %u\n", total);
+    writeLine(conn, "arena.live: %u\n", live);
+    writeLine(conn, "arena.recycled: %u\n", recycled);
+    HashMap<const char*, int>::const_iterator end = renderers.end();
+    for (HashMap<const char*, int>::const_iterator it = renderers.begin(); it != end; ++it)
+        writeLine(conn, "arena.renderers.%s: %d\n", it->first, it->second);
+    return true;
+}
+
+static void writeCacheStatistic(const Connection* conn, const char* name,
+        const Cache::TypeStatistic& stat) {
+    writeLine(conn, "cache.%s.count: %d\n", name, stat.count);
+    writeLine(conn, "cache.%s.size: %d\n", name, stat.size);
+    writeLine(conn, "cache.%s.live: %d\n", name, stat.liveSize);
+    writeLine(conn, "cache.%s.decoded: %d\n", name, stat.decodedSize);
+}
+
+static bool callDumpCacheMemory(const Frame*, const Connection* conn) {
+    Cache* memoryCache = cache();
+    writeLine(conn, "cache.live: %u\n", memoryCache->getLiveSize());
+    writeLine(conn, "cache.dead: %u\n", memoryCache->getDeadSize());
+    Cache::Statistics stats = memoryCache->getStatistics();
+    writeCacheStatistic(conn, "images", stats.images);
+    writeCacheStatistic(conn, "css", stats.cssStyleSheets);
+    writeCacheStatistic(conn, "scripts", stats.scripts);
+#if ENABLE(XSLT)
+    writeCacheStatistic(conn, "xsl", stats.xslStyleSheets);
+#endif
+    writeCacheStatistic(conn, "fonts", stats.fonts);
+    return true;
+}
+
+static bool callDumpImageMemory(const Frame*, const Connection* conn) {
+    Cache::Statistics stats = cache()->getStatistics();
+    writeLine(conn, "images.count: %d\n", stats.images.count);
+    writeLine(conn, "images.encoded: %d\n", stats.images.size - stats.images.decodedSize);
+    writeLine(conn, "images.decoded: %d\n", stats.images.decodedSize);
+    return true;
+}
+
+static bool callDumpJavaScriptMemory(const Frame*, const Connection* conn) {
+#if USE(JSC)
+    JSC::JSLock lock(false);
+    JSC::Heap& heap = JSDOMWindow::commonJSGlobalData()->heap;
+    JSC::Heap::Statistics stats = heap.statistics();
+    writeLine(conn, "js.objects: %u\n", heap.objectCount());
+    writeLine(conn, "js.globals: %u\n", heap.globalObjectCount());
+    writeLine(conn, "js.heap: %u\n", stats.size);
+    writeLine(conn, "js.free: %u\n", stats.free);
+    return true;
+#else
+    conn->write("js: not available\n");
+    return true;
+#endif
+}
+
+#if USE(JSC)
+typedef std::pair<JSC::CallIdentifier, JSC::SamplingProfiler::Counts> ProfileEntry;
+
+static bool compareProfileEntries(const ProfileEntry& a, const ProfileEntry& b) {
+    if (a.second.self != b.second.self)
+        return a.second.self > b.second.self;
+    return a.second.total > b.second.total;
+}
+#endif
+
+static bool callStartJavaScriptProfiler(const Frame*, const Connection* conn) {
+#if USE(JSC)
+    JSC::JSLock lock(false);
+    JSC::SamplingProfiler& profiler = JSDOMWindow::commonJSGlobalData()->samplingProfiler;
+    profiler.start();
+    writeLine(conn, "profile.interval: %u\n", profiler.sampleInterval());
+#else
+    conn->write("profile: not available\n");
+#endif
+    return true;
+}
+
+// Stops the sampling profiler and writes one line per function, the
+// functions that were sampled most often first:
+//   profile.<name> <url>:<line>: <self samples> <total samples>
+static bool callStopJavaScriptProfiler(const Frame*, const Connection* conn) {
+#if USE(JSC)
+    JSC::JSLock lock(false);
+    JSC::SamplingProfiler& profiler = JSDOMWindow::commonJSGlobalData()->samplingProfiler;
+    profiler.stop();
+    writeLine(conn, "profile.samples: %u\n", profiler.sampleCount());
+
+    Vector<ProfileEntry> entries;
+    JSC::SamplingProfiler::CountMap::const_iterator end = profiler.counts().end();
+    for (JSC::SamplingProfiler::CountMap::const_iterator it = profiler.counts().begin(); it != end; ++it)
+        entries.append(*it);
+    std::sort(entries.begin(), entries.end(), compareProfileEntries);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const JSC::CallIdentifier& identifier = entries[i].first;
+        writeLine(conn, "profile.%s %s:%u: %u %u\n",
+                identifier.m_name.UTF8String().c_str(),
+                identifier.m_url.UTF8String().c_str(), identifier.m_lineNumber,
+                entries[i].second.self, entries[i].second.total);
+    }
+#else
+    conn->write("profile: not available\n");
+#endif
+    return true;
+}
+
+static bool callDumpPictureMemory(const Frame* frame, const Connection* conn) {
+    size_t pictures, bytes;
+    WebViewCore::getWebViewCore(frame->view())->measureContent(&pictures, &bytes);
+    writeLine(conn, "pictures.count: %u\n", pictures);
+    writeLine(conn, "pictures.bytes: %u\n", bytes);
+    return true;
+}
+
+static bool callDumpNavCacheMemory(const Frame* frame, const Connection* conn) {
+    int nodes;
+    size_t bytes;
+    WebViewCore::getWebViewCore(frame->view())->measureNavCache(&nodes, &bytes);
+    writeLine(conn, "nav.nodes: %d\n", nodes);
+    writeLine(conn, "nav.bytes: %u\n", bytes);
+    return true;
+}
+
+static bool callDumpAllMemory(const Frame* frame, const Connection* conn) {
+    return callDumpDomMemory(frame, conn)
+        && callDumpRenderArenaMemory(frame, conn)
+        && callDumpCacheMemory(frame, conn)
+        && callDumpImageMemory(frame, conn)
+        && callDumpJavaScriptMemory(frame, conn)
+        && callDumpPictureMemory(frame, conn)
+        && callDumpNavCacheMemory(frame, conn);
+}
+
 class WebCoreHandler : public Handler {
 public:
     virtual void post(TargetThreadFunction func, void* v) const {
@@ -105,6 +318,26 @@ void Command::Init() {
                 callDumpDomTree, s_webcoreHandler));
     s_commands->append(new Command("DDRT", "Dump Render Tree",
                 callDumpRenderTree, s_webcoreHandler));
+    s_commands->append(new Command("DMEM", "Dump Memory",
+                callDumpAllMemory, s_webcoreHandler));
+    s_commands->append(new Command("MDOM", "Dump DOM Node Counts",
+                callDumpDomMemory, s_webcoreHandler));
+    s_commands->append(new Command("MARN", "Dump Render Arena Memory",
+                callDumpRenderArenaMemory, s_webcoreHandler));
+    s_commands->append(new Command("MCAC", "Dump Memory Cache",
+                callDumpCacheMemory, s_webcoreHandler));
+    s_commands->append(new Command("MIMG", "Dump Image Memory",
+                callDumpImageMemory, s_webcoreHandler));
+    s_commands->append(new Command("MJSH", "Dump JavaScript Heap",
+                callDumpJavaScriptMemory, s_webcoreHandler));
+    s_commands->append(new Command("MPIC", "Dump Picture Set Memory",
+                callDumpPictureMemory, s_webcoreHandler));
+    s_commands->append(new Command("MNAV", "Dump Nav Cache Memory",
+                callDumpNavCacheMemory, s_webcoreHandler));
+    s_commands->append(new Command("PJSS", "Start JavaScript Sampling Profiler",
+                callStartJavaScriptProfiler, s_webcoreHandler));
+    s_commands->append(new Command("PJSE", "Stop JavaScript Sampling Profiler",
+                callStopJavaScriptProfiler, s_webcoreHandler));
 }
 
 Command* Command::Find(const Connection* conn) {